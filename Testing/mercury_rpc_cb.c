@@ -88,6 +88,10 @@ struct hg_test_bulk_args {
     hg_size_t transfer_size;
     hg_size_t origin_offset;
     hg_size_t target_offset;
+    hg_size_t chunk_bytes;
+    hg_size_t chunk_size;
+    hg_uint64_t chunk_mask; /* Chunks already completed */
+    hg_bool_t pipelined;
 };
 
 /********************/
@@ -100,6 +104,9 @@ hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info);
 static hg_return_t
 hg_test_bulk_bind_transfer_cb(const struct hg_cb_info *hg_cb_info);
 
+static void
+hg_test_bulk_chunk_cb(void *arg, hg_size_t offset, hg_size_t size);
+
 static hg_return_t
 hg_test_perf_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info);
 
@@ -191,19 +198,58 @@ done:
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_rpc_open, handle)
 {
-    rpc_open_in_t in_struct;
+    rpc_open_in_t in_struct, peek_struct;
+    rpc_open_in_view_t view_struct;
     rpc_open_out_t out_struct;
+    const void *payload;
+    hg_size_t payload_size;
     hg_const_string_t path;
     rpc_handle_t rpc_handle;
     int event_id;
     int open_ret;
     hg_return_t ret = HG_SUCCESS;
 
+    /* Peek at path before decoding the whole input */
+    ret = MERCURY_PEEK_INPUT(handle, rpc_open_in_t, path, &peek_struct);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Get_input_prefix() failed (%s)",
+        HG_Error_to_string(ret));
+
     /* Get input buffer */
     ret = HG_Get_input(handle, &in_struct);
     HG_TEST_CHECK_HG_ERROR(
         done, ret, "HG_Get_input() failed (%s)", HG_Error_to_string(ret));
 
+    HG_TEST_CHECK_ERROR(strcmp(peek_struct.path, in_struct.path) != 0, done,
+        ret, HG_FAULT, "Peeked path (%s) does not match input path (%s)",
+        peek_struct.path, in_struct.path);
+
+    ret = MERCURY_FREE_PEEK_INPUT(handle, rpc_open_in_t, path, &peek_struct);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Free_input_prefix() failed (%s)",
+        HG_Error_to_string(ret));
+
+    /* Decode path again as a view, it must point into the input payload */
+    ret = HG_Get_input_prefix(handle, hg_proc_rpc_open_in_view_t, &view_struct);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Get_input_prefix() failed (%s)",
+        HG_Error_to_string(ret));
+
+    ret = HG_Get_input_payload(handle, &payload, &payload_size);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Get_input_payload() failed (%s)",
+        HG_Error_to_string(ret));
+
+    HG_TEST_CHECK_ERROR(view_struct.path.data < (const char *) payload ||
+                            view_struct.path.data + view_struct.path.len >=
+                                (const char *) payload + payload_size,
+        done, ret, HG_FAULT, "Path view does not point into input payload");
+    HG_TEST_CHECK_ERROR(view_struct.path.len != strlen(in_struct.path) ||
+                            strcmp(view_struct.path.data, in_struct.path) != 0,
+        done, ret, HG_FAULT, "Path view (%s) does not match input path (%s)",
+        view_struct.path.data, in_struct.path);
+
+    ret = HG_Free_input_prefix(
+        handle, hg_proc_rpc_open_in_view_t, &view_struct);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Free_input_prefix() failed (%s)",
+        HG_Error_to_string(ret));
+
     /* Get parameters */
     path = in_struct.path;
     rpc_handle = in_struct.handle;
@@ -266,6 +312,21 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+/* Not executed from the test thread pool so that the error is returned to HG,
+ * which then responds with it */
+hg_return_t
+hg_test_rpc_error_cb(hg_handle_t handle)
+{
+    hg_return_t ret;
+
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return HG_PROTOCOL_ERROR;
+}
+
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_overflow, handle)
 {
@@ -302,6 +363,83 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_overflow_in, handle)
+{
+    overflow_in_t in_struct;
+    size_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Get input buffer */
+    ret = HG_Get_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Get_input() failed (%s)", HG_Error_to_string(ret));
+
+    /* Check string */
+    for (i = 0; i < in_struct.string_len; i++)
+        if (in_struct.string[i] != 'h')
+            break;
+    HG_TEST_CHECK_ERROR_NORET(i != in_struct.string_len ||
+                                  in_struct.string[i] != '\0',
+        free, "Received string is not valid");
+
+    /* Send response back */
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    HG_TEST_CHECK_HG_ERROR(
+        free, ret, "HG_Respond() failed (%s)", HG_Error_to_string(ret));
+
+free:
+    ret = HG_Free_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Free_input() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_overflow_no_size, handle)
+{
+    perf_rpc_lat_in_t in_struct;
+    overflow_no_size_out_t out_struct;
+    hg_uint32_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Get input buffer */
+    ret = HG_Get_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Get_input() failed (%s)", HG_Error_to_string(ret));
+
+    /* Check buffer, origin reports the result */
+    for (i = 0; i < in_struct.buf_size; i++)
+        if (((char *) in_struct.buf)[i] != (char) i)
+            break;
+    out_struct.ret = (i == in_struct.buf_size) ? HG_SUCCESS : HG_FAULT;
+    HG_TEST_CHECK_ERROR_DONE(out_struct.ret != HG_SUCCESS,
+        "Received buffer is not valid at offset %u", i);
+
+    /* Send response back */
+    ret = HG_Respond(handle, NULL, NULL, &out_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        free, ret, "HG_Respond() failed (%s)", HG_Error_to_string(ret));
+
+free:
+    ret = HG_Free_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Free_input() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_cancel_rpc, handle)
 {
@@ -356,6 +494,9 @@ HG_TEST_RPC_CB(hg_test_bulk_write, handle)
     bulk_args->origin_offset = in_struct.origin_offset;
     bulk_args->target_offset = in_struct.target_offset;
     bulk_args->fildes = fildes;
+    bulk_args->chunk_bytes = 0;
+    bulk_args->chunk_mask = 0;
+    bulk_args->pipelined = HG_FALSE;
 
     ret = HG_Bulk_ref_incr(origin_bulk_handle);
     HG_TEST_CHECK_HG_ERROR(
@@ -438,6 +579,9 @@ HG_TEST_RPC_CB(hg_test_bulk_bind_write, handle)
     bulk_args->origin_offset = in_struct.origin_offset;
     bulk_args->target_offset = in_struct.target_offset;
     bulk_args->fildes = fildes;
+    bulk_args->chunk_bytes = 0;
+    bulk_args->chunk_mask = 0;
+    bulk_args->pipelined = HG_FALSE;
 
     /* Create a new block handle to read the data */
     ret = HG_Bulk_create(hg_info->hg_class, 1, NULL,
@@ -468,6 +612,120 @@ error:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_bulk_pipeline_write, handle)
+{
+    const struct hg_info *hg_info = NULL;
+    hg_bulk_t origin_bulk_handle = HG_BULK_NULL;
+    hg_bulk_t local_bulk_handle = HG_BULK_NULL;
+    struct hg_test_bulk_args *bulk_args = NULL;
+    struct hg_bulk_pipeline_info pipeline_info;
+    bulk_write_in_t in_struct;
+    hg_return_t ret = HG_SUCCESS;
+
+    bulk_args =
+        (struct hg_test_bulk_args *) malloc(sizeof(struct hg_test_bulk_args));
+    HG_TEST_CHECK_ERROR(bulk_args == NULL, error, ret, HG_NOMEM_ERROR,
+        "Could not allocate bulk_args");
+
+    /* Keep handle to pass to callback */
+    bulk_args->handle = handle;
+
+    /* Get info from handle */
+    hg_info = HG_Get_info(handle);
+
+    /* Get input parameters and data */
+    ret = HG_Get_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Get_input() failed (%s)", HG_Error_to_string(ret));
+
+    /* Get parameters */
+    origin_bulk_handle = in_struct.bulk_handle;
+
+    bulk_args->nbytes = HG_Bulk_get_size(origin_bulk_handle);
+    bulk_args->transfer_size = in_struct.transfer_size;
+    bulk_args->origin_offset = in_struct.origin_offset;
+    bulk_args->target_offset = in_struct.target_offset;
+    bulk_args->fildes = in_struct.fildes;
+    bulk_args->chunk_bytes = 0;
+    bulk_args->chunk_mask = 0;
+    bulk_args->pipelined = HG_TRUE;
+
+    ret = HG_Bulk_ref_incr(origin_bulk_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Bulk_ref_incr() failed (%s)", HG_Error_to_string(ret));
+
+    /* Free input */
+    ret = HG_Free_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Free_input() failed (%s)", HG_Error_to_string(ret));
+
+    /* Create a new block handle to read the data */
+    ret = HG_Bulk_create(hg_info->hg_class, 1, NULL,
+        (hg_size_t *) &bulk_args->nbytes, HG_BULK_READWRITE,
+        &local_bulk_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Pull bulk data in chunks, chunk size does not divide transfer size */
+    bulk_args->chunk_size = bulk_args->transfer_size / 8 + 1;
+    pipeline_info.chunk_size = bulk_args->chunk_size;
+    pipeline_info.max_in_flight = 2;
+    pipeline_info.chunk_cb = hg_test_bulk_chunk_cb;
+    pipeline_info.chunk_arg = bulk_args;
+    HG_TEST_LOG_DEBUG("Requesting transfer_size=%zu, origin_offset=%zu, "
+                      "target_offset=%zu, chunk_size=%zu",
+        bulk_args->transfer_size, bulk_args->origin_offset,
+        bulk_args->target_offset, pipeline_info.chunk_size);
+    ret = HG_Bulk_transfer_pipeline(hg_info->context, hg_test_bulk_transfer_cb,
+        bulk_args, HG_BULK_PULL, hg_info->addr, hg_info->context_id,
+        origin_bulk_handle, bulk_args->origin_offset, local_bulk_handle,
+        bulk_args->target_offset, bulk_args->transfer_size, &pipeline_info,
+        HG_OP_ID_IGNORE);
+    HG_TEST_CHECK_HG_ERROR(error, ret,
+        "HG_Bulk_transfer_pipeline() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+
+error:
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_test_bulk_chunk_cb(void *arg, hg_size_t offset, hg_size_t size)
+{
+    struct hg_test_bulk_args *bulk_args = (struct hg_test_bulk_args *) arg;
+    hg_size_t index = offset / bulk_args->chunk_size;
+    hg_size_t expected_size = 0;
+
+    HG_TEST_LOG_DEBUG("Chunk completed, offset=%zu, size=%zu", offset, size);
+
+    /* Only the last chunk may be smaller than chunk_size */
+    if (offset < bulk_args->transfer_size)
+        expected_size = bulk_args->transfer_size - offset;
+    if (expected_size > bulk_args->chunk_size)
+        expected_size = bulk_args->chunk_size;
+
+    /* Chunks may complete out of order but must not overlap or leave gaps,
+     * bytes of invalid chunks are not counted */
+    if (offset % bulk_args->chunk_size != 0 || expected_size == 0 ||
+        size != expected_size || index >= 64 ||
+        (bulk_args->chunk_mask & ((hg_uint64_t) 1 << index))) {
+        HG_TEST_LOG_ERROR(
+            "Unexpected chunk, offset=%zu, size=%zu", offset, size);
+        return;
+    }
+
+    /* Chunks of a same transfer are completed by a same progress context */
+    bulk_args->chunk_mask |= (hg_uint64_t) 1 << index;
+    bulk_args->chunk_bytes += size;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
@@ -500,6 +758,14 @@ hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
         bulk_args->origin_offset - bulk_args->target_offset,
         bulk_args->transfer_size, 1);
 
+    /* All chunks must have been reported */
+    if (bulk_args->pipelined &&
+        bulk_args->chunk_bytes != bulk_args->transfer_size) {
+        HG_TEST_LOG_ERROR("Chunks completed %zu bytes, was expecting %zu",
+            bulk_args->chunk_bytes, bulk_args->transfer_size);
+        write_ret = 0;
+    }
+
     /* Fill output structure */
     out_struct.ret = write_ret;
 
@@ -902,10 +1168,13 @@ HG_TEST_THREAD_CB(hg_test_rpc_null)
 HG_TEST_THREAD_CB(hg_test_rpc_open)
 HG_TEST_THREAD_CB(hg_test_rpc_open_no_resp)
 HG_TEST_THREAD_CB(hg_test_overflow)
+HG_TEST_THREAD_CB(hg_test_overflow_in)
+HG_TEST_THREAD_CB(hg_test_overflow_no_size)
 HG_TEST_THREAD_CB(hg_test_cancel_rpc)
 
 HG_TEST_THREAD_CB(hg_test_bulk_write)
 HG_TEST_THREAD_CB(hg_test_bulk_bind_write)
+HG_TEST_THREAD_CB(hg_test_bulk_pipeline_write)
 
 HG_TEST_THREAD_CB(hg_test_perf_rpc)
 HG_TEST_THREAD_CB(hg_test_perf_rpc_lat)
@@ -21,8 +21,14 @@ hg_test_rpc_open_cb(hg_handle_t handle);
 hg_return_t
 hg_test_rpc_open_no_resp_cb(hg_handle_t handle);
 hg_return_t
+hg_test_rpc_error_cb(hg_handle_t handle);
+hg_return_t
 hg_test_overflow_cb(hg_handle_t handle);
 hg_return_t
+hg_test_overflow_in_cb(hg_handle_t handle);
+hg_return_t
+hg_test_overflow_no_size_cb(hg_handle_t handle);
+hg_return_t
 hg_test_cancel_rpc_cb(hg_handle_t handle);
 
 /**
@@ -32,6 +38,8 @@ hg_return_t
 hg_test_bulk_write_cb(hg_handle_t handle);
 hg_return_t
 hg_test_bulk_bind_write_cb(hg_handle_t handle);
+hg_return_t
+hg_test_bulk_pipeline_write_cb(hg_handle_t handle);
 
 /**
  * test_perf
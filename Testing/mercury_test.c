@@ -23,6 +23,16 @@
 /* Local Macros */
 /****************/
 
+/* Max bulk operations cached per context (-O option) */
+#define HG_TEST_BULK_OP_POOL_SIZE (256)
+
+/* Max addrs cached and failed lookup lifetime in ms (-N option) */
+#define HG_TEST_ADDR_CACHE_SIZE    (64)
+#define HG_TEST_ADDR_CACHE_NEG_TTL (1000)
+
+/* Threads used by targets to execute RPCs that enable dispatch */
+#define HG_TEST_DISPATCH_POOL_SIZE (2)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -79,12 +89,17 @@ extern const struct na_test_opt na_test_opt_g[];
 hg_id_t hg_test_rpc_null_id_g = 0;
 hg_id_t hg_test_rpc_open_id_g = 0;
 hg_id_t hg_test_rpc_open_id_no_resp_g = 0;
+hg_id_t hg_test_rpc_dispatch_id_g = 0;
+hg_id_t hg_test_rpc_dispatch_error_id_g = 0;
 hg_id_t hg_test_overflow_id_g = 0;
+hg_id_t hg_test_overflow_in_id_g = 0;
+hg_id_t hg_test_overflow_no_size_id_g = 0;
 hg_id_t hg_test_cancel_rpc_id_g = 0;
 
 /* test_bulk */
 hg_id_t hg_test_bulk_write_id_g = 0;
 hg_id_t hg_test_bulk_bind_write_id_g = 0;
+hg_id_t hg_test_bulk_pipeline_write_id_g = 0;
 
 /* test_perf */
 hg_id_t hg_test_perf_rpc_id_g = 0;
@@ -136,6 +151,21 @@ hg_test_parse_options(int argc, char *argv[], struct hg_test_info *hg_test_info)
             case 'm': /* memory */
                 hg_test_info->auto_sm = HG_TRUE;
                 break;
+            case 'R': /* registration cache */
+                hg_test_info->bulk_cache = HG_TRUE;
+                break;
+            case 'O': /* bulk operation pool */
+                hg_test_info->bulk_op_pool = HG_TRUE;
+                break;
+            case 'N': /* addr cache */
+                hg_test_info->addr_cache = HG_TRUE;
+                break;
+            case 'U': /* handle pool */
+                hg_test_info->handle_pool = HG_TRUE;
+                break;
+            case 'A': /* bulk buffer allocator */
+                hg_test_info->bulk_alloc = HG_TRUE;
+                break;
             case 't': /* number of threads */
                 hg_test_info->thread_count =
                     (unsigned int) atoi(na_test_opt_arg_g);
@@ -284,12 +314,35 @@ hg_test_register(hg_class_t *hg_class)
         MERCURY_REGISTER(hg_class, "hg_test_rpc_open_no_resp", rpc_open_in_t,
             rpc_open_out_t, hg_test_rpc_open_no_resp_cb);
 
+    hg_test_rpc_dispatch_id_g = MERCURY_REGISTER(hg_class,
+        "hg_test_rpc_dispatch", rpc_open_in_t, rpc_open_out_t,
+        hg_test_rpc_open_cb);
+    hg_test_rpc_dispatch_error_id_g = MERCURY_REGISTER(hg_class,
+        "hg_test_rpc_dispatch_error", void, void, hg_test_rpc_error_cb);
+
     /* Disable response */
     HG_Registered_disable_response(
         hg_class, hg_test_rpc_open_id_no_resp_g, HG_TRUE);
 
+    /* Execute from dispatch pool */
+    HG_Registered_enable_dispatch(hg_class, hg_test_rpc_dispatch_id_g, HG_TRUE);
+    HG_Registered_enable_dispatch(
+        hg_class, hg_test_rpc_dispatch_error_id_g, HG_TRUE);
+
     hg_test_overflow_id_g = MERCURY_REGISTER(hg_class, "hg_test_overflow", void,
         overflow_out_t, hg_test_overflow_cb);
+    hg_test_overflow_in_id_g = MERCURY_REGISTER(hg_class,
+        "hg_test_overflow_in", overflow_in_t, void, hg_test_overflow_in_cb);
+    hg_test_overflow_no_size_id_g =
+        MERCURY_REGISTER(hg_class, "hg_test_overflow_no_size",
+            perf_rpc_lat_in_t, overflow_no_size_out_t,
+            hg_test_overflow_no_size_cb);
+    /* Procs of overflow RPCs are called with HG_SIZE, the one of
+     * perf_rpc_lat_in_t rejects it */
+    HG_Registered_enable_size_pass(hg_class, hg_test_overflow_id_g, HG_TRUE);
+    HG_Registered_enable_size_pass(hg_class, hg_test_overflow_in_id_g, HG_TRUE);
+    HG_Registered_enable_size_pass(
+        hg_class, hg_test_overflow_no_size_id_g, HG_TRUE);
     hg_test_cancel_rpc_id_g = MERCURY_REGISTER(
         hg_class, "hg_test_cancel_rpc", void, void, hg_test_cancel_rpc_cb);
 
@@ -299,6 +352,9 @@ hg_test_register(hg_class_t *hg_class)
     hg_test_bulk_bind_write_id_g =
         MERCURY_REGISTER(hg_class, "hg_test_bulk_bind_write", bulk_write_in_t,
             bulk_bind_write_out_t, hg_test_bulk_bind_write_cb);
+    hg_test_bulk_pipeline_write_id_g =
+        MERCURY_REGISTER(hg_class, "hg_test_bulk_pipeline_write",
+            bulk_write_in_t, bulk_write_out_t, hg_test_bulk_pipeline_write_cb);
 
     /* test_perf */
     hg_test_perf_rpc_id_g = MERCURY_REGISTER(
@@ -367,6 +423,8 @@ HG_Test_init(int argc, char *argv[], struct hg_test_info *hg_test_info)
     /* Set progress mode */
     if (hg_test_info->na_test_info.busy_wait)
         hg_init_info.na_init_info.progress_mode = NA_NO_BLOCK;
+    else if (hg_test_info->na_test_info.spin_wait)
+        hg_init_info.na_init_info.progress_mode = NA_ADAPTIVE_SPIN;
 
         /* Set stats */
 #ifdef HG_HAS_COLLECT_STATS
@@ -382,6 +440,28 @@ HG_Test_init(int argc, char *argv[], struct hg_test_info *hg_test_info)
     if (hg_test_info->auto_sm)
         hg_init_info.auto_sm = HG_TRUE;
 
+    /* Set registration cache */
+    if (hg_test_info->bulk_cache)
+        hg_init_info.bulk_cache_size = HG_TEST_BULK_CACHE_SIZE;
+    if (hg_test_info->bulk_op_pool)
+        hg_init_info.bulk_op_pool_size = HG_TEST_BULK_OP_POOL_SIZE;
+
+    /* Set handle pool */
+    if (hg_test_info->handle_pool)
+        hg_init_info.handle_pool_size = HG_TEST_HANDLE_POOL_SIZE;
+
+    /* Set addr cache, batch lookups use one thread per test thread */
+    if (hg_test_info->addr_cache) {
+        hg_init_info.addr_cache_size = HG_TEST_ADDR_CACHE_SIZE;
+        hg_init_info.addr_cache_neg_ttl = HG_TEST_ADDR_CACHE_NEG_TTL;
+        hg_init_info.addr_lookup_pool_size = hg_test_info->thread_count;
+    }
+
+    /* Set dispatch pool on targets */
+    if (hg_test_info->na_test_info.listen ||
+        hg_test_info->na_test_info.self_send)
+        hg_init_info.dispatch_pool_size = HG_TEST_DISPATCH_POOL_SIZE;
+
     /* Assign NA class */
     hg_init_info.na_class = hg_test_info->na_test_info.na_class;
 
@@ -55,6 +55,11 @@ struct hg_test_info {
 #endif
     unsigned int thread_count;
     hg_bool_t auto_sm;
+    hg_bool_t bulk_cache;
+    hg_bool_t bulk_op_pool;
+    hg_bool_t bulk_alloc;
+    hg_bool_t addr_cache;
+    hg_bool_t handle_pool;
 };
 
 struct hg_test_context_info {
@@ -65,6 +70,12 @@ struct hg_test_context_info {
 /* Public Macros */
 /*****************/
 
+/* Max size of unused registrations kept in cache (-R option) */
+#define HG_TEST_BULK_CACHE_SIZE (256 * 1024 * 1024)
+
+/* Max handles cached per context (-U option) */
+#define HG_TEST_HANDLE_POOL_SIZE (64)
+
 /* Default error macro */
 #ifdef HG_HAS_VERBOSE_ERROR
 #    include <mercury_log.h>
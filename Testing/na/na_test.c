@@ -98,6 +98,7 @@ na_test_usage(const char *execname)
     printf("    -k, --key           Pass auth key\n");
     printf("    -l, --loop          Number of loops (default: 1)\n");
     printf("    -b, --busy          Busy wait\n");
+    printf("    -B, --spin          Spin before blocking\n");
     printf("    -V, --verbose       Print verbose output\n");
 }
 
@@ -161,6 +162,9 @@ na_test_parse_options(int argc, char *argv[], struct na_test_info *na_test_info)
             case 'b': /* busy */
                 na_test_info->busy_wait = NA_TRUE;
                 break;
+            case 'B': /* spin */
+                na_test_info->spin_wait = NA_TRUE;
+                break;
             case 'C': /* number of contexts */
                 na_test_info->max_contexts =
                     (na_uint8_t) atoi(na_test_opt_arg_g);
@@ -418,6 +422,9 @@ NA_Test_init(int argc, char *argv[], struct na_test_info *na_test_info)
     if (na_test_info->busy_wait) {
         na_init_info.progress_mode = NA_NO_BLOCK;
         printf("# Initializing NA in busy wait mode\n");
+    } else if (na_test_info->spin_wait) {
+        na_init_info.progress_mode = NA_ADAPTIVE_SPIN;
+        printf("# Initializing NA in adaptive spin mode\n");
     }
     na_init_info.auth_key = na_test_info->key;
     na_init_info.max_contexts = na_test_info->max_contexts;
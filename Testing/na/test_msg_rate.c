@@ -0,0 +1,502 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "na_test.h"
+
+#include "mercury_time.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define BENCHMARK_NAME "Many-client unexpected message rate"
+
+#define NA_TEST_TAG_MSG  1
+#define NA_TEST_TAG_DONE 111
+
+#define NDIGITS 2
+#define NWIDTH  20
+
+#define MSG_SIZE    64     /* Size of messages (including header) */
+#define MSG_COUNT   100000 /* Messages per loop, split across clients */
+#define MAX_CLIENTS 128    /* Max number of client processes */
+#define SEND_WINDOW 16     /* Sends in flight per client */
+#define RECV_COUNT  256    /* Unexpected recvs posted by the server */
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct na_test_rate_info;
+
+struct na_test_rate_op {
+    na_op_id_t op_id;
+    void *buf;
+    void *buf_data;
+    struct na_test_rate_info *na_test_rate_info;
+    struct na_test_rate_op *next; /* Next free / completed op */
+};
+
+struct na_test_rate_info {
+    na_class_t *na_class;
+    na_context_t *context;
+    struct na_test_rate_op *ops;
+    struct na_test_rate_op *completed; /* Ops to repost / reuse */
+    unsigned long msg_count;           /* Messages received */
+    unsigned int done_count;           /* Clients done */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static int
+na_test_rate_op_cb(const struct na_cb_info *na_cb_info);
+
+static na_return_t
+na_test_rate_progress(
+    struct na_test_rate_info *na_test_rate_info, unsigned int timeout);
+
+static na_return_t
+na_test_rate_ops_create(struct na_test_rate_info *na_test_rate_info,
+    unsigned int count, na_size_t buf_size);
+
+static void
+na_test_rate_ops_destroy(
+    struct na_test_rate_info *na_test_rate_info, unsigned int count);
+
+static na_return_t
+na_test_rate_post_recv(struct na_test_rate_info *na_test_rate_info,
+    struct na_test_rate_op *na_test_rate_op);
+
+static int
+na_test_rate_client(const struct na_test_info *na_test_info,
+    const char *server_name, unsigned int msg_count);
+
+static na_return_t
+na_test_rate_measure(struct na_test_rate_info *na_test_rate_info,
+    const struct na_test_info *na_test_info, const char *server_name,
+    unsigned int client_count);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+static int
+na_test_rate_op_cb(const struct na_cb_info *na_cb_info)
+{
+    struct na_test_rate_op *na_test_rate_op =
+        (struct na_test_rate_op *) na_cb_info->arg;
+    struct na_test_rate_info *na_test_rate_info =
+        na_test_rate_op->na_test_rate_info;
+
+    if (na_cb_info->ret == NA_CANCELED)
+        return NA_SUCCESS;
+    if (na_cb_info->ret != NA_SUCCESS) {
+        NA_LOG_ERROR(
+            "Operation failed (%s)", NA_Error_to_string(na_cb_info->ret));
+        return NA_SUCCESS;
+    }
+
+    if (na_cb_info->type == NA_CB_RECV_UNEXPECTED) {
+        if (na_cb_info->info.recv_unexpected.tag == NA_TEST_TAG_DONE)
+            na_test_rate_info->done_count++;
+        else
+            na_test_rate_info->msg_count++;
+        NA_Addr_free(na_test_rate_info->na_class,
+            na_cb_info->info.recv_unexpected.source);
+    }
+
+    /* Op can only be reposted once the callback has returned */
+    na_test_rate_op->next = na_test_rate_info->completed;
+    na_test_rate_info->completed = na_test_rate_op;
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_rate_progress(
+    struct na_test_rate_info *na_test_rate_info, unsigned int timeout)
+{
+    unsigned int actual_count = 0;
+    na_return_t ret;
+
+    ret = NA_Trigger(
+        na_test_rate_info->context, 0, RECV_COUNT, NULL, &actual_count);
+    if (ret == NA_SUCCESS && actual_count > 0)
+        return NA_SUCCESS;
+
+    /* Only block if safe to */
+    if (!NA_Poll_try_wait(
+            na_test_rate_info->na_class, na_test_rate_info->context))
+        timeout = 0;
+
+    return NA_Progress(
+        na_test_rate_info->na_class, na_test_rate_info->context, timeout);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_rate_ops_create(struct na_test_rate_info *na_test_rate_info,
+    unsigned int count, na_size_t buf_size)
+{
+    unsigned int i;
+
+    na_test_rate_info->ops = (struct na_test_rate_op *) calloc(
+        count, sizeof(struct na_test_rate_op));
+    if (!na_test_rate_info->ops)
+        return NA_NOMEM;
+    na_test_rate_info->completed = NULL;
+
+    for (i = 0; i < count; i++) {
+        struct na_test_rate_op *na_test_rate_op = &na_test_rate_info->ops[i];
+
+        na_test_rate_op->na_test_rate_info = na_test_rate_info;
+        na_test_rate_op->op_id = NA_Op_create(na_test_rate_info->na_class);
+        na_test_rate_op->buf = NA_Msg_buf_alloc(
+            na_test_rate_info->na_class, buf_size, &na_test_rate_op->buf_data);
+        if (!na_test_rate_op->buf)
+            return NA_NOMEM;
+        memset(na_test_rate_op->buf, 0, buf_size);
+        na_test_rate_op->next = na_test_rate_info->completed;
+        na_test_rate_info->completed = na_test_rate_op;
+    }
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_test_rate_ops_destroy(
+    struct na_test_rate_info *na_test_rate_info, unsigned int count)
+{
+    unsigned int i;
+
+    if (!na_test_rate_info->ops)
+        return;
+
+    for (i = 0; i < count; i++) {
+        struct na_test_rate_op *na_test_rate_op = &na_test_rate_info->ops[i];
+
+        if (na_test_rate_op->buf)
+            NA_Msg_buf_free(na_test_rate_info->na_class, na_test_rate_op->buf,
+                na_test_rate_op->buf_data);
+        if (na_test_rate_op->op_id)
+            NA_Op_destroy(na_test_rate_info->na_class, na_test_rate_op->op_id);
+    }
+    free(na_test_rate_info->ops);
+    na_test_rate_info->ops = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_rate_post_recv(struct na_test_rate_info *na_test_rate_info,
+    struct na_test_rate_op *na_test_rate_op)
+{
+    na_return_t ret;
+
+    ret = NA_Msg_recv_unexpected(na_test_rate_info->na_class,
+        na_test_rate_info->context, na_test_rate_op_cb, na_test_rate_op,
+        na_test_rate_op->buf,
+        NA_Msg_get_max_unexpected_size(na_test_rate_info->na_class),
+        na_test_rate_op->buf_data, &na_test_rate_op->op_id);
+    if (ret != NA_SUCCESS)
+        NA_LOG_ERROR(
+            "NA_Msg_recv_unexpected() failed (%s)", NA_Error_to_string(ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+na_test_rate_client(const struct na_test_info *na_test_info,
+    const char *server_name, unsigned int msg_count)
+{
+    struct na_test_rate_info na_test_rate_info = {0};
+    char info_string[NA_TEST_MAX_ADDR_NAME];
+    na_addr_t server_addr = NA_ADDR_NULL;
+    unsigned int sent = 0, i;
+    na_return_t ret;
+
+    if (na_test_info->comm)
+        sprintf(info_string, "%s+%s", na_test_info->comm,
+            na_test_info->protocol);
+    else
+        sprintf(info_string, "%s", na_test_info->protocol);
+
+    na_test_rate_info.na_class = NA_Initialize(info_string, NA_FALSE);
+    if (!na_test_rate_info.na_class) {
+        NA_LOG_ERROR("Could not initialize NA");
+        return EXIT_FAILURE;
+    }
+    na_test_rate_info.context = NA_Context_create(na_test_rate_info.na_class);
+    if (!na_test_rate_info.context) {
+        NA_LOG_ERROR("Could not create context");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    ret = NA_Addr_lookup(na_test_rate_info.na_class, server_name, &server_addr);
+    if (ret != NA_SUCCESS) {
+        NA_LOG_ERROR("NA_Addr_lookup(%s) failed (%s)", server_name,
+            NA_Error_to_string(ret));
+        goto done;
+    }
+
+    ret = na_test_rate_ops_create(&na_test_rate_info, SEND_WINDOW, MSG_SIZE);
+    if (ret != NA_SUCCESS)
+        goto done;
+    for (i = 0; i < SEND_WINDOW; i++) {
+        struct na_test_rate_op *na_test_rate_op = &na_test_rate_info.ops[i];
+        na_size_t j;
+
+        NA_Msg_init_unexpected(
+            na_test_rate_info.na_class, na_test_rate_op->buf, MSG_SIZE);
+        for (j = NA_Msg_get_unexpected_header_size(na_test_rate_info.na_class);
+             j < MSG_SIZE; j++)
+            ((char *) na_test_rate_op->buf)[j] = (char) j;
+    }
+
+    /* Stream messages, last one tells the server that we are done */
+    while (sent <= msg_count) {
+        while (na_test_rate_info.completed && sent <= msg_count) {
+            struct na_test_rate_op *na_test_rate_op =
+                na_test_rate_info.completed;
+
+            na_test_rate_info.completed = na_test_rate_op->next;
+            ret = NA_Msg_send_unexpected(na_test_rate_info.na_class,
+                na_test_rate_info.context, na_test_rate_op_cb,
+                na_test_rate_op, na_test_rate_op->buf, MSG_SIZE,
+                na_test_rate_op->buf_data, server_addr, 0,
+                (sent < msg_count) ? NA_TEST_TAG_MSG : NA_TEST_TAG_DONE,
+                &na_test_rate_op->op_id);
+            if (ret == NA_AGAIN) {
+                /* Server is not keeping up, make progress and try again */
+                na_test_rate_op->next = na_test_rate_info.completed;
+                na_test_rate_info.completed = na_test_rate_op;
+                break;
+            } else if (ret != NA_SUCCESS) {
+                NA_LOG_ERROR("NA_Msg_send_unexpected() failed (%s)",
+                    NA_Error_to_string(ret));
+                goto done;
+            }
+            sent++;
+        }
+        if (sent <= msg_count) {
+            ret = na_test_rate_progress(&na_test_rate_info,
+                (ret == NA_AGAIN) ? 0 : NA_MAX_IDLE_TIME);
+            if (ret != NA_SUCCESS && ret != NA_TIMEOUT)
+                goto done;
+            ret = NA_SUCCESS;
+        }
+    }
+
+    /* Wait for all sends to complete */
+    for (;;) {
+        struct na_test_rate_op *na_test_rate_op;
+
+        for (i = 0, na_test_rate_op = na_test_rate_info.completed;
+             na_test_rate_op; na_test_rate_op = na_test_rate_op->next)
+            i++;
+        if (i == SEND_WINDOW)
+            break;
+        ret = na_test_rate_progress(&na_test_rate_info, NA_MAX_IDLE_TIME);
+        if (ret != NA_SUCCESS && ret != NA_TIMEOUT)
+            goto done;
+        ret = NA_SUCCESS;
+    }
+
+done:
+    na_test_rate_ops_destroy(&na_test_rate_info, SEND_WINDOW);
+    if (server_addr != NA_ADDR_NULL)
+        NA_Addr_free(na_test_rate_info.na_class, server_addr);
+    if (na_test_rate_info.context)
+        NA_Context_destroy(
+            na_test_rate_info.na_class, na_test_rate_info.context);
+    NA_Finalize(na_test_rate_info.na_class);
+
+    return (ret == NA_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_rate_measure(struct na_test_rate_info *na_test_rate_info,
+    const struct na_test_info *na_test_info, const char *server_name,
+    unsigned int client_count)
+{
+    unsigned int msg_count =
+        (unsigned int) na_test_info->loop * MSG_COUNT / client_count;
+    unsigned int exited = 0, i;
+    hg_time_t t1, t2;
+    double time_read;
+    na_return_t ret = NA_SUCCESS;
+
+    na_test_rate_info->msg_count = 0;
+    na_test_rate_info->done_count = 0;
+
+    hg_time_get_current(&t1);
+
+    for (i = 0; i < client_count; i++) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            NA_LOG_ERROR("fork() failed");
+            ret = NA_PROTOCOL_ERROR;
+            client_count = i;
+            goto done;
+        } else if (pid == 0)
+            _exit(na_test_rate_client(na_test_info, server_name, msg_count));
+    }
+
+    while (na_test_rate_info->done_count < client_count) {
+        /* Repost recvs */
+        while (na_test_rate_info->completed) {
+            struct na_test_rate_op *na_test_rate_op =
+                na_test_rate_info->completed;
+
+            na_test_rate_info->completed = na_test_rate_op->next;
+            ret = na_test_rate_post_recv(na_test_rate_info, na_test_rate_op);
+            if (ret != NA_SUCCESS)
+                goto done;
+        }
+
+        ret = na_test_rate_progress(na_test_rate_info, 1000);
+        if (ret == NA_TIMEOUT) {
+            int status = 0;
+
+            /* Make sure that no client has failed */
+            if (waitpid(-1, &status, WNOHANG) > 0) {
+                exited++;
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+                    NA_LOG_ERROR("Client failed");
+                    ret = NA_PROTOCOL_ERROR;
+                    goto done;
+                }
+            }
+        } else if (ret != NA_SUCCESS)
+            goto done;
+    }
+    ret = NA_SUCCESS;
+
+    hg_time_get_current(&t2);
+    time_read = hg_time_to_double(hg_time_subtract(t2, t1));
+
+    fprintf(stdout, "%-*u%*lu%*.*f\n", 10, client_count, NWIDTH,
+        na_test_rate_info->msg_count, NWIDTH, NDIGITS,
+        (double) na_test_rate_info->msg_count / time_read / 1e6);
+    fflush(stdout);
+
+done:
+    for (i = exited; i < client_count; i++) {
+        int status = 0;
+
+        if (wait(&status) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS)
+            ret = NA_PROTOCOL_ERROR;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct na_test_info na_test_info = {0};
+    struct na_test_rate_info na_test_rate_info = {0};
+    char server_name[NA_TEST_MAX_ADDR_NAME];
+    na_size_t server_name_len = NA_TEST_MAX_ADDR_NAME;
+    na_addr_t self_addr = NA_ADDR_NULL;
+    unsigned int client_count, i;
+    na_return_t na_ret;
+    int ret = EXIT_SUCCESS;
+
+    /* Initialize the interface */
+    na_test_info.listen = NA_TRUE;
+    na_ret = NA_Test_init(argc, argv, &na_test_info);
+    if (na_ret != NA_SUCCESS) {
+        NA_LOG_ERROR("NA_Test_init() failed");
+        return EXIT_FAILURE;
+    }
+    na_test_rate_info.na_class = na_test_info.na_class;
+    na_test_rate_info.context = NA_Context_create(na_test_rate_info.na_class);
+
+    na_ret = NA_Addr_self(na_test_rate_info.na_class, &self_addr);
+    if (na_ret == NA_SUCCESS)
+        na_ret = NA_Addr_to_string(na_test_rate_info.na_class, server_name,
+            &server_name_len, self_addr);
+    if (na_ret != NA_SUCCESS) {
+        NA_LOG_ERROR("Could not get self address string");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    na_ret = na_test_rate_ops_create(&na_test_rate_info, RECV_COUNT,
+        NA_Msg_get_max_unexpected_size(na_test_rate_info.na_class));
+    if (na_ret != NA_SUCCESS) {
+        NA_LOG_ERROR("Could not create recv operations");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    fprintf(stdout, "# %s\n", BENCHMARK_NAME);
+    fprintf(stdout,
+        "# %d message(s) of %d byte(s) from 1 to %d client(s), %d in flight "
+        "per client\n",
+        na_test_info.loop * MSG_COUNT, MSG_SIZE, MAX_CLIENTS, SEND_WINDOW);
+    fprintf(stdout, "%-*s%*s%*s\n", 10, "# Clients", NWIDTH, "Messages",
+        NWIDTH, "Rate (MMsg/s)");
+    fflush(stdout);
+
+    for (client_count = 1; client_count <= MAX_CLIENTS; client_count *= 2) {
+        na_ret = na_test_rate_measure(
+            &na_test_rate_info, &na_test_info, server_name, client_count);
+        if (na_ret != NA_SUCCESS) {
+            NA_LOG_ERROR("na_test_rate_measure() failed");
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    /* Cancel posted recvs */
+    for (i = 0; i < RECV_COUNT; i++) {
+        struct na_test_rate_op *na_test_rate_op;
+
+        for (na_test_rate_op = na_test_rate_info.completed; na_test_rate_op;
+             na_test_rate_op = na_test_rate_op->next)
+            if (na_test_rate_op == &na_test_rate_info.ops[i])
+                break;
+        if (!na_test_rate_op)
+            NA_Cancel(na_test_rate_info.na_class, na_test_rate_info.context,
+                na_test_rate_info.ops[i].op_id);
+    }
+    while (NA_Trigger(na_test_rate_info.context, 0, RECV_COUNT, NULL, NULL) ==
+           NA_SUCCESS)
+        continue;
+
+done:
+    na_test_rate_ops_destroy(&na_test_rate_info, RECV_COUNT);
+    if (self_addr != NA_ADDR_NULL)
+        NA_Addr_free(na_test_rate_info.na_class, self_addr);
+    if (na_test_rate_info.context)
+        NA_Context_destroy(
+            na_test_rate_info.na_class, na_test_rate_info.context);
+    NA_Test_finalize(&na_test_info);
+
+    return ret;
+}
@@ -42,6 +42,7 @@ hg_test_bulk_forward_cb(const struct hg_cb_info *callback_info);
 
 extern hg_id_t hg_test_bulk_write_id_g;
 extern hg_id_t hg_test_bulk_bind_write_id_g;
+extern hg_id_t hg_test_bulk_pipeline_write_id_g;
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
@@ -117,8 +118,8 @@ done:
 static hg_return_t
 hg_test_bulk_contig(hg_class_t *hg_class, hg_context_t *context,
     hg_request_class_t *request_class, hg_bool_t bind_addr,
-    hg_addr_t target_addr, hg_size_t transfer_size, hg_size_t origin_offset,
-    hg_size_t target_offset)
+    hg_bool_t pipeline, hg_addr_t target_addr, hg_size_t transfer_size,
+    hg_size_t origin_offset, hg_size_t target_offset)
 {
     hg_request_t *request = NULL;
     hg_handle_t handle;
@@ -130,7 +131,8 @@ hg_test_bulk_contig(hg_class_t *hg_class, hg_context_t *context,
     void *buf_ptrs[2];
     hg_size_t buf_sizes[2];
     hg_size_t bulk_size = BUFSIZE;
-    hg_id_t rpc_id = hg_test_bulk_write_id_g;
+    hg_id_t rpc_id = (pipeline) ? hg_test_bulk_pipeline_write_id_g
+                                : hg_test_bulk_write_id_g;
     hg_cb_t forward_cb = hg_test_bulk_forward_cb;
     size_t i;
 
@@ -222,9 +224,9 @@ done:
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_bulk_seg(hg_class_t *hg_class, hg_context_t *context,
-    hg_request_class_t *request_class, hg_addr_t target_addr,
-    hg_size_t transfer_size, hg_size_t origin_offset, hg_size_t target_offset,
-    hg_uint32_t origin_segment_count)
+    hg_request_class_t *request_class, hg_bool_t pipeline,
+    hg_addr_t target_addr, hg_size_t transfer_size, hg_size_t origin_offset,
+    hg_size_t target_offset, hg_uint32_t origin_segment_count)
 {
     hg_request_t *request = NULL;
     hg_handle_t handle;
@@ -235,6 +237,8 @@ hg_test_bulk_seg(hg_class_t *hg_class, hg_context_t *context,
     void **buf_ptrs;
     hg_size_t *buf_sizes;
     hg_size_t bulk_size = BUFSIZE;
+    hg_id_t rpc_id = (pipeline) ? hg_test_bulk_pipeline_write_id_g
+                                : hg_test_bulk_write_id_g;
     size_t i;
 
     HG_TEST_CHECK_ERROR(origin_offset + transfer_size > bulk_size, done, ret,
@@ -264,7 +268,7 @@ hg_test_bulk_seg(hg_class_t *hg_class, hg_context_t *context,
 
     request = hg_request_create(request_class);
 
-    ret = HG_Create(context, target_addr, hg_test_bulk_write_id_g, &handle);
+    ret = HG_Create(context, target_addr, rpc_id, &handle);
     HG_TEST_CHECK_HG_ERROR(
         done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
 
@@ -286,8 +290,7 @@ hg_test_bulk_seg(hg_class_t *hg_class, hg_context_t *context,
         bulk_write_in_struct.target_offset);
 
     /* Forward call to remote addr and get a new request */
-    HG_TEST_LOG_DEBUG(
-        "Forwarding call with op id: %u...", hg_test_bulk_write_id_g);
+    HG_TEST_LOG_DEBUG("Forwarding call with op id: %u...", rpc_id);
     forward_cb_args.request = request;
     forward_cb_args.expected_bytes = transfer_size;
     forward_cb_args.ret = HG_SUCCESS;
@@ -403,6 +406,127 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_bulk_cache_check(
+    hg_class_t *hg_class, void *buf, hg_size_t size, hg_bool_t expect_hit)
+{
+    hg_bulk_t bulk_handle = HG_BULK_NULL;
+    hg_uint64_t hits, misses, prev_hits, prev_misses;
+    hg_return_t ret;
+
+    ret = HG_Bulk_cache_get_stats(hg_class, &prev_hits, &prev_misses);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_cache_get_stats() failed (%s)",
+        HG_Error_to_string(ret));
+
+    ret = HG_Bulk_create(
+        hg_class, 1, &buf, &size, HG_BULK_READ_ONLY, &bulk_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Bulk_free(bulk_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Bulk_free() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Bulk_cache_get_stats(hg_class, &hits, &misses);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_cache_get_stats() failed (%s)",
+        HG_Error_to_string(ret));
+
+    HG_TEST_CHECK_ERROR(hits != prev_hits + (expect_hit ? 1 : 0) ||
+                            misses != prev_misses + (expect_hit ? 0 : 1),
+        done, ret, HG_FAULT, "Expected registration cache %s",
+        expect_hit ? "hit" : "miss");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_bulk_cache(hg_class_t *hg_class)
+{
+    /* Two regions fit in the cache, a third one evicts the LRU one */
+    hg_size_t region_size = HG_TEST_BULK_CACHE_SIZE / 2;
+    hg_bulk_t bulk_handle = HG_BULK_NULL;
+    hg_return_t ret, cleanup_ret;
+    char *buf, *a, *b, *c;
+
+    /* Overlapping regions of a single allocation, registrations are only
+     * reused on exact matches */
+    buf = malloc(region_size + 2);
+    HG_TEST_CHECK_ERROR(buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate buffer");
+    a = buf;
+    b = buf + 1;
+    c = buf + 2;
+
+    /* Hit */
+    ret = hg_test_bulk_cache_check(hg_class, a, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "First registration of A not a miss");
+    ret = hg_test_bulk_cache_check(hg_class, a, region_size, HG_TRUE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "Second registration of A not a hit");
+
+    /* LRU eviction: C evicts A, then A evicts C (B was used last) */
+    ret = hg_test_bulk_cache_check(hg_class, b, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "Registration of B not a miss");
+    ret = hg_test_bulk_cache_check(hg_class, c, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "Registration of C not a miss");
+    ret = hg_test_bulk_cache_check(hg_class, b, region_size, HG_TRUE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "B was evicted instead of A");
+    ret = hg_test_bulk_cache_check(hg_class, a, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "A was not evicted");
+    ret = hg_test_bulk_cache_check(hg_class, c, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "C was not evicted");
+
+    /* Invalidate: only A overlaps [buf, buf + 1), B was evicted by C */
+    ret = HG_Bulk_cache_invalidate(hg_class, buf, 1);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "HG_Bulk_cache_invalidate() failed (%s)",
+        HG_Error_to_string(ret));
+    ret = hg_test_bulk_cache_check(hg_class, c, region_size, HG_TRUE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "C was invalidated");
+    ret = hg_test_bulk_cache_check(hg_class, a, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "A was not invalidated");
+
+    /* Invalidate registration in use, dropped on HG_Bulk_free() */
+    ret = HG_Bulk_create(hg_class, 1, (void **) &a, &region_size,
+        HG_BULK_READ_ONLY, &bulk_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+    ret = HG_Bulk_cache_invalidate(hg_class, a, region_size);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "HG_Bulk_cache_invalidate() failed (%s)",
+        HG_Error_to_string(ret));
+    ret = HG_Bulk_free(bulk_handle);
+    bulk_handle = HG_BULK_NULL;
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Bulk_free() failed (%s)", HG_Error_to_string(ret));
+    ret = hg_test_bulk_cache_check(hg_class, a, region_size, HG_FALSE);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "A in use was not invalidated");
+
+    /* Drop remaining registrations before freeing memory */
+    ret = HG_Bulk_cache_invalidate(hg_class, buf, region_size + 2);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "HG_Bulk_cache_invalidate() failed (%s)",
+        HG_Error_to_string(ret));
+
+    free(buf);
+
+done:
+    return ret;
+
+error:
+    if (bulk_handle != HG_BULK_NULL) {
+        cleanup_ret = HG_Bulk_free(bulk_handle);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Bulk_free() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+    cleanup_ret = HG_Bulk_cache_invalidate(hg_class, buf, region_size + 2);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Bulk_cache_invalidate() failed (%s)",
+        HG_Error_to_string(cleanup_ret));
+    free(buf);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 int
 main(int argc, char *argv[])
@@ -419,14 +543,15 @@ main(int argc, char *argv[])
     /* Simple RPC bulk test */
     HG_TEST("contiguous RPC bulk (size BUFSIZE, offsets 0, 0)");
     hg_ret = hg_test_bulk_contig(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE, 0, 0);
+        hg_test_info.request_class, 0, 0, hg_test_info.target_addr, BUFSIZE, 0,
+        0);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "contiguous RPC bulk failed");
     HG_PASSED();
 
     HG_TEST("contiguous RPC bulk (size BUFSIZE/4, offsets BUFSIZE/2 + 1, 0)");
     hg_ret = hg_test_bulk_contig(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 4,
+        hg_test_info.request_class, 0, 0, hg_test_info.target_addr, BUFSIZE / 4,
         BUFSIZE / 2 + 1, 0);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "contiguous RPC bulk failed");
@@ -435,7 +560,7 @@ main(int argc, char *argv[])
     HG_TEST("contiguous RPC bulk (size BUFSIZE/8, offsets BUFSIZE/2 + 1, "
             "BUFSIZE/4)");
     hg_ret = hg_test_bulk_contig(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 8,
+        hg_test_info.request_class, 0, 0, hg_test_info.target_addr, BUFSIZE / 8,
         BUFSIZE / 2 + 1, BUFSIZE / 4);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "contiguous RPC bulk failed");
@@ -465,7 +590,7 @@ main(int argc, char *argv[])
 
     HG_TEST("segmented RPC bulk (size BUFSIZE, offsets 0, 0)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE, 0, 0,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE, 0, 0,
         16);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "segmented RPC bulk failed");
@@ -473,7 +598,7 @@ main(int argc, char *argv[])
 
     HG_TEST("segmented RPC bulk (size BUFSIZE/4, offsets BUFSIZE/2 + 1, 0)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE / 4,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 4,
         BUFSIZE / 2 + 1, 0, 16);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "segmented RPC bulk failed");
@@ -482,16 +607,42 @@ main(int argc, char *argv[])
     HG_TEST("segmented RPC bulk (size BUFSIZE/8, offsets BUFSIZE/2 + 1, "
             "BUFSIZE/4)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE / 8,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 8,
         BUFSIZE / 2 + 1, BUFSIZE / 4, 16);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "segmented RPC bulk failed");
     HG_PASSED();
 
+    HG_TEST("pipelined contiguous RPC bulk (size BUFSIZE, offsets 0, 0)");
+    hg_ret = hg_test_bulk_contig(hg_test_info.hg_class, hg_test_info.context,
+        hg_test_info.request_class, 0, 1, hg_test_info.target_addr, BUFSIZE, 0,
+        0);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "pipelined contiguous RPC bulk failed");
+    HG_PASSED();
+
+    HG_TEST("pipelined contiguous RPC bulk (size BUFSIZE/8, offsets "
+            "BUFSIZE/2 + 1, BUFSIZE/4)");
+    hg_ret = hg_test_bulk_contig(hg_test_info.hg_class, hg_test_info.context,
+        hg_test_info.request_class, 0, 1, hg_test_info.target_addr, BUFSIZE / 8,
+        BUFSIZE / 2 + 1, BUFSIZE / 4);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "pipelined contiguous RPC bulk failed");
+    HG_PASSED();
+
+    HG_TEST("pipelined segmented RPC bulk (size BUFSIZE/4, offsets "
+            "BUFSIZE/2 + 1, 0)");
+    hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
+        hg_test_info.request_class, 1, hg_test_info.target_addr, BUFSIZE / 4,
+        BUFSIZE / 2 + 1, 0, 16);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "pipelined segmented RPC bulk failed");
+    HG_PASSED();
+
 #ifndef HG_HAS_XDR
     HG_TEST("over-segmented RPC bulk (size BUFSIZE, offsets 0, 0)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE, 0, 0,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE, 0, 0,
         1024);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "over-segmented RPC bulk failed");
@@ -500,7 +651,7 @@ main(int argc, char *argv[])
     HG_TEST(
         "over-segmented RPC bulk (size BUFSIZE/4, offsets BUFSIZE/2 + 1, 0)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE / 4,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 4,
         BUFSIZE / 2 + 1, 0, 1024);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "over-segmented RPC bulk failed");
@@ -509,7 +660,7 @@ main(int argc, char *argv[])
     HG_TEST("over-segmented RPC bulk (size BUFSIZE/8, offsets BUFSIZE/2 + 1, "
             "BUFSIZE/4)");
     hg_ret = hg_test_bulk_seg(hg_test_info.hg_class, hg_test_info.context,
-        hg_test_info.request_class, hg_test_info.target_addr, BUFSIZE / 8,
+        hg_test_info.request_class, 0, hg_test_info.target_addr, BUFSIZE / 8,
         BUFSIZE / 2 + 1, BUFSIZE / 4, 1024);
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "over-segmented RPC bulk failed");
@@ -519,13 +670,22 @@ main(int argc, char *argv[])
     if (strcmp(HG_Class_get_name(hg_test_info.hg_class), "ofi") == 0) {
         HG_TEST("bind contiguous RPC bulk (size BUFSIZE, offsets 0, 0)");
         hg_ret = hg_test_bulk_contig(hg_test_info.hg_class,
-            hg_test_info.context, hg_test_info.request_class, 1,
+            hg_test_info.context, hg_test_info.request_class, 1, 0,
             hg_test_info.target_addr, BUFSIZE, 0, 0);
         HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
             "bind contiguous RPC bulk failed");
         HG_PASSED();
     }
 
+    /* Registration cache test (-R option) */
+    if (hg_test_info.bulk_cache) {
+        HG_TEST("registration cache");
+        hg_ret = hg_test_bulk_cache(hg_test_info.hg_class);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "registration cache test failed");
+        HG_PASSED();
+    }
+
 done:
     if (ret != EXIT_SUCCESS)
         HG_FAILED();
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+#include "mercury_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define BENCHMARK_NAME "Bulk segment latency (local push)"
+#define STRING(s)      #s
+#define XSTRING(s)     STRING(s)
+#define VERSION_NAME                                                           \
+    XSTRING(HG_VERSION_MAJOR)                                                  \
+    "." XSTRING(HG_VERSION_MINOR) "." XSTRING(HG_VERSION_PATCH)
+
+#define SKIP 20
+
+#define NDIGITS      2
+#define NWIDTH       20
+#define SEGMENT_SIZE 64
+#define MAX_SEGMENTS 1024
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static hg_return_t
+hg_test_bulk_seg_cb(const struct hg_cb_info *callback_info);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_bulk_seg_cb(const struct hg_cb_info *callback_info)
+{
+    hg_request_t *request = (hg_request_t *) callback_info->arg;
+
+    hg_request_complete(request);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+measure_bulk_seg_transfer(
+    struct hg_test_info *hg_test_info, hg_uint32_t segment_count)
+{
+    hg_size_t total_size = (hg_size_t) segment_count * SEGMENT_SIZE;
+    size_t loop = (size_t) hg_test_info->na_test_info.loop * 100;
+    char *seg_buf = NULL, *contig_buf = NULL;
+    void **seg_ptrs = NULL;
+    hg_size_t *seg_sizes = NULL;
+    hg_bulk_t seg_handle = HG_BULK_NULL, contig_handle = HG_BULK_NULL;
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    hg_request_t *request = NULL;
+    double time_transfer = 0;
+    hg_return_t ret = HG_SUCCESS;
+    size_t i;
+
+    /* Prepare buffers */
+    seg_buf = malloc(total_size);
+    HG_TEST_CHECK_ERROR(seg_buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate segment buf");
+    contig_buf = malloc(total_size);
+    HG_TEST_CHECK_ERROR(contig_buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate contiguous buf");
+    for (i = 0; i < total_size; i++)
+        contig_buf[i] = (char) i;
+
+    seg_ptrs = malloc(segment_count * sizeof(void *));
+    HG_TEST_CHECK_ERROR(seg_ptrs == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate segment pointers");
+    seg_sizes = malloc(segment_count * sizeof(hg_size_t));
+    HG_TEST_CHECK_ERROR(seg_sizes == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate segment sizes");
+    for (i = 0; i < segment_count; i++) {
+        seg_ptrs[i] = seg_buf + i * SEGMENT_SIZE;
+        seg_sizes[i] = SEGMENT_SIZE;
+    }
+
+    /* Register memory */
+    ret = HG_Bulk_create(hg_test_info->hg_class, segment_count, seg_ptrs,
+        seg_sizes, HG_BULK_READWRITE, &seg_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Bulk_create(hg_test_info->hg_class, 1, (void **) &contig_buf,
+        &total_size, HG_BULK_READ_ONLY, &contig_handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Addr_self(hg_test_info->hg_class, &self_addr);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Addr_self() failed (%s)", HG_Error_to_string(ret));
+
+    request = hg_request_create(hg_test_info->request_class);
+
+    /* Push contiguous buffer into segments, one segment per NA operation */
+    for (i = 0; i < SKIP + loop; i++) {
+        hg_time_t t1, t2;
+
+        hg_time_get_current(&t1);
+
+        ret = HG_Bulk_transfer(hg_test_info->context, hg_test_bulk_seg_cb,
+            request, HG_BULK_PUSH, self_addr, seg_handle, 0, contig_handle, 0,
+            total_size, HG_OP_ID_IGNORE);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_transfer() failed (%s)",
+            HG_Error_to_string(ret));
+
+        hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+        hg_time_get_current(&t2);
+        if (i >= SKIP)
+            time_transfer += hg_time_to_double(hg_time_subtract(t2, t1));
+
+        hg_request_reset(request);
+    }
+
+#ifdef HG_TEST_HAS_VERIFY_DATA
+    for (i = 0; i < total_size; i++)
+        HG_TEST_CHECK_ERROR(seg_buf[i] != (char) i, done, ret, HG_FAULT,
+            "Error detected in bulk transfer, seg_buf[%zu] = %d, "
+            "was expecting %d!",
+            i, seg_buf[i], (char) i);
+#endif
+
+    fprintf(stdout, "%-*u%*.*f\n", 10, segment_count, NWIDTH, NDIGITS,
+        time_transfer * 1e6 / (double) loop);
+
+done:
+    if (request)
+        hg_request_destroy(request);
+    if (self_addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_test_info->hg_class, self_addr);
+    if (contig_handle != HG_BULK_NULL)
+        HG_Bulk_free(contig_handle);
+    if (seg_handle != HG_BULK_NULL)
+        HG_Bulk_free(seg_handle);
+    free(seg_sizes);
+    free(seg_ptrs);
+    free(contig_buf);
+    free(seg_buf);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_info hg_test_info = {0};
+    hg_uint32_t segment_count;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+    hg_ret = HG_Test_init(argc, argv, &hg_test_info);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "HG_Test_init() failed");
+
+    if (hg_test_info.na_test_info.mpi_comm_rank == 0) {
+        fprintf(stdout, "# %s v%s\n", BENCHMARK_NAME, VERSION_NAME);
+        fprintf(stdout,
+            "# Loop %d times from %d to %d segment(s) of %d byte(s)\n",
+            hg_test_info.na_test_info.loop * 100, 1, MAX_SEGMENTS,
+            SEGMENT_SIZE);
+        fprintf(
+            stdout, "%-*s%*s\n", 10, "# Segments", NWIDTH, "Latency (us)");
+        fflush(stdout);
+
+        for (segment_count = 1; segment_count <= MAX_SEGMENTS;
+             segment_count *= 2) {
+            hg_ret = measure_bulk_seg_transfer(&hg_test_info, segment_count);
+            HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+                "measure_bulk_seg_transfer() failed");
+        }
+
+        if (hg_test_info.bulk_op_pool) {
+            hg_uint64_t hits = 0, misses = 0;
+
+            hg_ret = HG_Bulk_op_pool_get_stats(
+                hg_test_info.context, &hits, &misses);
+            HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+                "HG_Bulk_op_pool_get_stats() failed");
+            fprintf(stdout,
+                "# Bulk operation pool: %llu hit(s), %llu miss(es)\n",
+                (unsigned long long) hits, (unsigned long long) misses);
+        }
+    }
+
+done:
+    hg_ret = HG_Test_finalize(&hg_test_info);
+    HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
+
+    return ret;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+#include "mercury_thread.h"
+#include "mercury_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define BENCHMARK_NAME "RPC function map lookup rate"
+#define STRING(s)      #s
+#define XSTRING(s)     STRING(s)
+#define VERSION_NAME                                                           \
+    XSTRING(HG_VERSION_MAJOR)                                                  \
+    "." XSTRING(HG_VERSION_MINOR) "." XSTRING(HG_VERSION_PATCH)
+
+#define NDIGITS 2
+#define NWIDTH  20
+#define NUM_IDS 64
+#define LOOKUPS 100000
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_test_func_map_thread {
+    hg_class_t *hg_class;
+    const hg_id_t *ids;
+    size_t lookups;
+    double time;
+    hg_return_t ret;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static HG_THREAD_RETURN_TYPE
+hg_test_func_map_thread_cb(void *arg);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_test_func_map_thread_cb(void *arg)
+{
+    struct hg_test_func_map_thread *args =
+        (struct hg_test_func_map_thread *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+    hg_time_t t1, t2;
+    size_t i;
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < args->lookups; i++) {
+        hg_bool_t flag = HG_FALSE;
+
+        args->ret =
+            HG_Registered(args->hg_class, args->ids[i % NUM_IDS], &flag);
+        if (args->ret != HG_SUCCESS || !flag) {
+            HG_TEST_LOG_ERROR("HG_Registered() failed (%s)",
+                HG_Error_to_string(args->ret));
+            args->ret = HG_FAULT;
+            break;
+        }
+    }
+    hg_time_get_current(&t2);
+    args->time = hg_time_to_double(hg_time_subtract(t2, t1));
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+measure_func_map_lookup(struct hg_test_info *hg_test_info,
+    const hg_id_t *ids, unsigned int thread_count)
+{
+    size_t lookups = (size_t) hg_test_info->na_test_info.loop * LOOKUPS;
+    struct hg_test_func_map_thread *args = NULL;
+    hg_thread_t *threads = NULL;
+    double time_max = 0;
+    unsigned int i, started = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    args = calloc(thread_count, sizeof(*args));
+    HG_TEST_CHECK_ERROR(args == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate thread args");
+    threads = malloc(thread_count * sizeof(*threads));
+    HG_TEST_CHECK_ERROR(threads == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate threads");
+
+    for (i = 0; i < thread_count; i++) {
+        args[i].hg_class = hg_test_info->hg_class;
+        args[i].ids = ids;
+        args[i].lookups = lookups;
+        HG_TEST_CHECK_ERROR(
+            hg_thread_create(&threads[i], hg_test_func_map_thread_cb,
+                &args[i]) != HG_UTIL_SUCCESS,
+            done, ret, HG_FAULT, "Could not create thread");
+        started++;
+    }
+
+done:
+    for (i = 0; i < started; i++) {
+        hg_thread_join(threads[i]);
+        if (args[i].ret != HG_SUCCESS)
+            ret = args[i].ret;
+        if (args[i].time > time_max)
+            time_max = args[i].time;
+    }
+
+    if (ret == HG_SUCCESS)
+        fprintf(stdout, "%-*u%*.*f\n", 10, thread_count, NWIDTH, NDIGITS,
+            (double) (lookups * thread_count) / (time_max * 1e6));
+
+    free(threads);
+    free(args);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_info hg_test_info = {0};
+    hg_id_t ids[NUM_IDS];
+    unsigned int i, registered = 0, thread_count;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+    hg_ret = HG_Test_init(argc, argv, &hg_test_info);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "HG_Test_init() failed");
+
+    /* Populate function map beyond the default test RPCs */
+    for (i = 0; i < NUM_IDS; i++) {
+        char name[32];
+
+        sprintf(name, "hg_test_func_map_%u", i);
+        ids[i] =
+            HG_Register_name(hg_test_info.hg_class, name, NULL, NULL, NULL);
+        HG_TEST_CHECK_ERROR(ids[i] == 0, done, ret, EXIT_FAILURE,
+            "HG_Register_name() failed");
+        registered++;
+    }
+
+    if (hg_test_info.na_test_info.mpi_comm_rank == 0) {
+        fprintf(stdout, "# %s v%s\n", BENCHMARK_NAME, VERSION_NAME);
+        fprintf(stdout,
+            "# %d lookup(s) per thread over %d RPC IDs, up to %u thread(s)\n",
+            hg_test_info.na_test_info.loop * LOOKUPS, NUM_IDS,
+            hg_test_info.thread_count);
+        fprintf(stdout, "%-*s%*s\n", 10, "# Threads", NWIDTH,
+            "Lookups (M/s)");
+        fflush(stdout);
+
+        for (thread_count = 1; thread_count <= hg_test_info.thread_count;
+             thread_count *= 2) {
+            hg_ret = measure_func_map_lookup(&hg_test_info, ids, thread_count);
+            HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+                "measure_func_map_lookup() failed");
+        }
+    }
+
+done:
+    for (i = 0; i < registered; i++)
+        HG_Deregister(hg_test_info.hg_class, ids[i]);
+
+    hg_ret = HG_Test_finalize(&hg_test_info);
+    HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
+
+    return ret;
+}
@@ -18,6 +18,7 @@
 
 MERCURY_GEN_PROC(
     overflow_out_t, ((hg_string_t)(string))((hg_uint64_t)(string_len)))
+MERCURY_GEN_PROC(overflow_no_size_out_t, ((hg_int32_t)(ret)))
 #else
 /* Define overflow_out_t */
 typedef struct {
@@ -42,6 +43,29 @@ hg_proc_overflow_out_t(hg_proc_t proc, void *data)
 
     return ret;
 }
+
+/* Define overflow_no_size_out_t */
+typedef struct {
+    hg_int32_t ret;
+} overflow_no_size_out_t;
+
+/* Define hg_proc_overflow_no_size_out_t */
+static HG_INLINE hg_return_t
+hg_proc_overflow_no_size_out_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    overflow_no_size_out_t *struct_data = (overflow_no_size_out_t *) data;
+
+    ret = hg_proc_hg_int32_t(proc, &struct_data->ret);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
 #endif
 
+/* Same struct is used as input to test overflow of input parameters */
+typedef overflow_out_t overflow_in_t;
+#define hg_proc_overflow_in_t hg_proc_overflow_out_t
+
 #endif /* TEST_OVERFLOW_H */
@@ -12,11 +12,19 @@
 #include "mercury_test.h"
 
 #include "mercury_mem.h"
+#include "mercury_time.h"
 
 /****************/
 /* Local Macros */
 /****************/
 
+#define NENTRIES     1024 /* Number of entries in nested struct */
+#define ENTRY_SIZE   1024 /* Size of entry data */
+#define NITERATIONS  100  /* Number of encodings measured */
+#define NFLAT        1000000 /* Number of flat struct encodings measured */
+#define NWIDTH       20
+#define NDIGITS      2
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -32,6 +40,24 @@ typedef struct {
     hg_const_string_t string;
 } hg_test_proc_string_t;
 
+typedef struct {
+    hg_uint64_t id;
+    hg_const_string_t name;
+    hg_bytes_view_t data;
+} hg_test_proc_entry_t;
+
+typedef struct {
+    hg_uint32_t count;
+    hg_test_proc_entry_t *entries;
+} hg_test_proc_nested_t;
+
+#ifdef HG_HAS_BOOST
+/* Only has fixed-width fields, encoded with a single copy */
+MERCURY_GEN_PROC(hg_test_proc_flat_t,
+    ((hg_uint64_t)(obj_id))((hg_uint64_t)(offset))((hg_uint64_t)(length))(
+        (hg_uint32_t)(flags)))
+#endif
+
 /********************/
 /* Local Prototypes */
 /********************/
@@ -74,6 +100,86 @@ hg_proc_hg_test_proc_string_t(hg_proc_t proc, void *data)
     return ret;
 }
 
+static hg_return_t
+hg_proc_hg_test_proc_entry_t(hg_proc_t proc, void *data)
+{
+    hg_test_proc_entry_t *struct_data = (hg_test_proc_entry_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->id);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->name);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_hg_bytes_view_t(proc, &struct_data->data);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
+
+static hg_return_t
+hg_proc_hg_test_proc_nested_t(hg_proc_t proc, void *data)
+{
+    hg_test_proc_nested_t *struct_data = (hg_test_proc_nested_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+    hg_uint32_t i;
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->count);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    if (hg_proc_get_op(proc) == HG_DECODE) {
+        struct_data->entries = (hg_test_proc_entry_t *) malloc(
+            struct_data->count * sizeof(hg_test_proc_entry_t));
+        if (struct_data->entries == NULL)
+            return HG_NOMEM;
+    }
+
+    for (i = 0; i < struct_data->count; i++) {
+        ret = hg_proc_hg_test_proc_entry_t(proc, &struct_data->entries[i]);
+        if (ret != HG_SUCCESS)
+            return ret;
+    }
+
+    if (hg_proc_get_op(proc) == HG_FREE) {
+        free(struct_data->entries);
+        struct_data->entries = NULL;
+    }
+
+    return ret;
+}
+
+#ifdef HG_HAS_BOOST
+static hg_return_t
+hg_proc_hg_test_proc_flat_fields_t(hg_proc_t proc, void *data)
+{
+    hg_test_proc_flat_t *struct_data = (hg_test_proc_flat_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->obj_id);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->offset);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->length);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->flags);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
+#endif
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -228,10 +334,297 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_proc_size(
+    hg_return_t (*proc_cb)(hg_proc_t proc, void *data), void *data)
+{
+    hg_proc_t proc = HG_PROC_NULL;
+    void *buf = NULL;
+    size_t buf_size = (size_t) hg_mem_get_page_size();
+    hg_size_t encoded_size;
+    hg_return_t ret;
+
+    ret = hg_proc_create((hg_class_t *) 1, HG_CRC32, &proc);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Cannot create HG proc");
+
+    buf = malloc(buf_size);
+    HG_TEST_CHECK_ERROR(
+        buf == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate buf");
+
+    /* Compute size */
+    ret = hg_proc_reset(proc, NULL, 0, HG_SIZE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = proc_cb(proc, data);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not compute size");
+
+    encoded_size = hg_proc_get_size_used(proc);
+
+    /* Encode and compare */
+    ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = proc_cb(proc, data);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+    HG_TEST_CHECK_ERROR(encoded_size != hg_proc_get_size_used(proc), done,
+        ret, HG_PROTOCOL_ERROR, "Computed size (%zu) != encoded size (%zu)",
+        encoded_size, hg_proc_get_size_used(proc));
+
+done:
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    free(buf);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_proc_nested(hg_test_proc_nested_t *in)
+{
+    hg_proc_t proc = HG_PROC_NULL;
+    hg_test_proc_nested_t out = {0, NULL};
+    void *buf = NULL;
+    hg_size_t buf_size;
+    hg_uint32_t i;
+    hg_return_t ret;
+
+    ret = hg_proc_create((hg_class_t *) 1, HG_CRC32, &proc);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Cannot create HG proc");
+
+    /* Allocate buffer of exact encoded size */
+    ret = hg_proc_reset(proc, NULL, 0, HG_SIZE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = hg_proc_hg_test_proc_nested_t(proc, in);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not compute size");
+
+    buf_size = hg_proc_get_size_used(proc);
+    buf = malloc(buf_size);
+    HG_TEST_CHECK_ERROR(
+        buf == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate buf");
+
+    /* Encode in a single pass */
+    ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = hg_proc_hg_test_proc_nested_t(proc, in);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+    HG_TEST_CHECK_ERROR(hg_proc_get_extra_buf(proc) != NULL ||
+                            hg_proc_get_size_used(proc) != buf_size,
+        done, ret, HG_PROTOCOL_ERROR, "Encoding did not fit computed size");
+
+    /* Decode */
+    ret = hg_proc_reset(proc, buf, buf_size, HG_DECODE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = hg_proc_hg_test_proc_nested_t(proc, &out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not decode");
+
+    HG_TEST_CHECK_ERROR(out.count != in->count, done, ret, HG_PROTOCOL_ERROR,
+        "Encoded and decoded counts do not match");
+    for (i = 0; i < in->count; i++)
+        HG_TEST_CHECK_ERROR(out.entries[i].id != in->entries[i].id ||
+                                strcmp(out.entries[i].name,
+                                    in->entries[i].name) != 0 ||
+                                out.entries[i].data.size !=
+                                    in->entries[i].data.size,
+            done, ret, HG_PROTOCOL_ERROR,
+            "Encoded and decoded entries do not match");
+
+    ret = hg_test_proc_free(hg_proc_hg_test_proc_nested_t, &out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_free() failed");
+
+done:
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    free(buf);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_proc_encode_perf(hg_test_proc_nested_t *in, hg_bool_t size_first)
+{
+    hg_proc_t proc = HG_PROC_NULL;
+    void *buf = NULL;
+    size_t buf_size = (size_t) hg_mem_get_page_size();
+    hg_size_t encoded_size = 0;
+    hg_time_t t1, t2;
+    double time_read;
+    unsigned int i;
+    hg_return_t ret;
+
+    ret = hg_proc_create((hg_class_t *) 1, HG_CRC32, &proc);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Cannot create HG proc");
+
+    buf = malloc(buf_size);
+    HG_TEST_CHECK_ERROR(
+        buf == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate buf");
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < NITERATIONS; i++) {
+        if (size_first) {
+            ret = hg_proc_reset(proc, NULL, 0, HG_SIZE);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+            ret = hg_proc_hg_test_proc_nested_t(proc, in);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "Could not compute size");
+
+            encoded_size = hg_proc_get_size_used(proc);
+        }
+
+        /* Previous extra buffer is freed on reset */
+        ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+        if (encoded_size > buf_size) {
+            ret = hg_proc_set_size(proc, encoded_size);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "Could not set proc size");
+        }
+
+        ret = hg_proc_hg_test_proc_nested_t(proc, in);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+        ret = hg_proc_flush(proc);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Error in proc flush");
+    }
+    hg_time_get_current(&t2);
+    time_read = hg_time_to_double(hg_time_subtract(t2, t1));
+
+    fprintf(stdout, "%-*s%*.*f%*.*f\n", 16,
+        (size_first) ? "size first" : "grow", NWIDTH, NDIGITS,
+        time_read * 1e6 / NITERATIONS, NWIDTH, NDIGITS,
+        (double) (hg_proc_get_size_used(proc) * NITERATIONS) /
+            (time_read * 1024 * 1024));
+
+done:
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    free(buf);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_BOOST
+static hg_return_t
+hg_test_proc_flat(void)
+{
+    hg_test_proc_flat_t in = {1, 2, 3, 4}, out = {0, 0, 0, 0};
+    hg_proc_t proc = HG_PROC_NULL;
+    char flat_buf[64], fields_buf[64];
+    hg_size_t flat_size;
+    hg_return_t ret;
+
+    /* Fields are packed */
+    HG_TEST_CHECK_ERROR(hg_proc_hg_test_proc_flat_t_size != 28, done, ret,
+        HG_PROTOCOL_ERROR, "Invalid flat size (%d)",
+        (int) hg_proc_hg_test_proc_flat_t_size);
+
+    ret = hg_test_proc_size(hg_proc_hg_test_proc_flat_t, &in);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_size() failed");
+
+    ret = hg_test_proc_generic(hg_proc_hg_test_proc_flat_t, &in, &out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_generic() failed");
+
+    HG_TEST_CHECK_ERROR(in.obj_id != out.obj_id || in.offset != out.offset ||
+                            in.length != out.length || in.flags != out.flags,
+        done, ret, HG_PROTOCOL_ERROR,
+        "Encoded and decoded structs do not match");
+
+    /* Wire layout must match encoding fields one by one */
+    ret = hg_proc_create((hg_class_t *) 1, HG_CRC32, &proc);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Cannot create HG proc");
+
+    ret = hg_proc_reset(proc, flat_buf, sizeof(flat_buf), HG_ENCODE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = hg_proc_hg_test_proc_flat_t(proc, &in);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+    flat_size = hg_proc_get_size_used(proc);
+
+    ret = hg_proc_reset(proc, fields_buf, sizeof(fields_buf), HG_ENCODE);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+    ret = hg_proc_hg_test_proc_flat_fields_t(proc, &in);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+    HG_TEST_CHECK_ERROR(flat_size != hg_proc_get_size_used(proc) ||
+                            memcmp(flat_buf, fields_buf, flat_size) != 0,
+        done, ret, HG_PROTOCOL_ERROR,
+        "Flat and per-field encodings do not match");
+
+done:
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_proc_flat_perf(
+    hg_return_t (*proc_cb)(hg_proc_t proc, void *data), const char *name)
+{
+    hg_test_proc_flat_t in = {1, 2, 3, 4}, out;
+    hg_proc_t proc = HG_PROC_NULL;
+    char buf[64];
+    hg_time_t t1, t2;
+    double time_read;
+    unsigned int i;
+    hg_return_t ret;
+
+    ret = hg_proc_create((hg_class_t *) 1, HG_CRC32, &proc);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Cannot create HG proc");
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < NFLAT; i++) {
+        in.offset = i;
+
+        ret = hg_proc_reset(proc, buf, sizeof(buf), HG_ENCODE);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+        ret = proc_cb(proc, &in);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode");
+
+        ret = hg_proc_reset(proc, buf, sizeof(buf), HG_DECODE);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+        ret = proc_cb(proc, &out);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Could not decode");
+    }
+    hg_time_get_current(&t2);
+    time_read = hg_time_to_double(hg_time_subtract(t2, t1));
+
+    HG_TEST_CHECK_ERROR(out.offset != NFLAT - 1, done, ret, HG_PROTOCOL_ERROR,
+        "Encoded and decoded structs do not match");
+
+    fprintf(stdout, "%-*s%*.*f\n", 16, name, NWIDTH, NDIGITS,
+        time_read * 1e9 / NFLAT);
+
+done:
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+
+    return ret;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 int
 main(void)
 {
+    hg_test_proc_uint_t uint_in = {1, 2, 3, 4};
+    hg_test_proc_string_t string_in = {"Hello"};
+    hg_test_proc_nested_t nested = {0, NULL};
+    void *data = NULL;
+    hg_uint32_t i;
     hg_return_t hg_ret;
     int ret = EXIT_SUCCESS;
 
@@ -249,9 +642,75 @@ main(void)
         "string proc test failed");
     HG_PASSED();
 
+    /* size proc test */
+    HG_TEST("size proc");
+    hg_ret = hg_test_proc_size(hg_proc_hg_test_proc_uint_t, &uint_in);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "size proc test failed");
+    hg_ret = hg_test_proc_size(hg_proc_hg_test_proc_string_t, &string_in);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "size proc test failed");
+    HG_PASSED();
+
+    /* Build nested struct */
+    data = malloc(ENTRY_SIZE);
+    nested.entries = (hg_test_proc_entry_t *) malloc(
+        NENTRIES * sizeof(hg_test_proc_entry_t));
+    HG_TEST_CHECK_ERROR(data == NULL || nested.entries == NULL, done, ret,
+        EXIT_FAILURE, "Could not allocate nested struct");
+    memset(data, 'a', ENTRY_SIZE);
+    nested.count = NENTRIES;
+    for (i = 0; i < NENTRIES; i++) {
+        nested.entries[i].id = i;
+        nested.entries[i].name = "entry";
+        nested.entries[i].data.data = data;
+        nested.entries[i].data.size = ENTRY_SIZE;
+    }
+
+    /* nested proc test */
+    HG_TEST("nested proc");
+    hg_ret = hg_test_proc_nested(&nested);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "nested proc test failed");
+    HG_PASSED();
+
+    /* Encoding of large nested struct */
+    fprintf(stdout, "# %u entries of %d bytes, %d iterations\n", NENTRIES,
+        ENTRY_SIZE, NITERATIONS);
+    fprintf(stdout, "%-*s%*s%*s\n", 16, "# Method", NWIDTH, "Time (us)", NWIDTH,
+        "Bandwidth (MB/s)");
+    hg_ret = hg_test_proc_encode_perf(&nested, HG_FALSE);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "encode perf test failed");
+    hg_ret = hg_test_proc_encode_perf(&nested, HG_TRUE);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "encode perf test failed");
+
+#ifdef HG_HAS_BOOST
+    /* flat proc test */
+    HG_TEST("flat proc");
+    hg_ret = hg_test_proc_flat();
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "flat proc test failed");
+    HG_PASSED();
+
+    /* Encoding / decoding of flat struct */
+    fprintf(stdout, "# %d encode / decode of flat struct\n", NFLAT);
+    fprintf(stdout, "%-*s%*s\n", 16, "# Method", NWIDTH, "Time (ns)");
+    hg_ret = hg_test_proc_flat_perf(hg_proc_hg_test_proc_flat_fields_t,
+        "per field");
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "flat perf test failed");
+    hg_ret = hg_test_proc_flat_perf(hg_proc_hg_test_proc_flat_t, "flat");
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "flat perf test failed");
+#endif
+
 done:
     if (ret != EXIT_SUCCESS)
         HG_FAILED();
+    free(nested.entries);
+    free(data);
 
     return ret;
 }
@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+
+#include "mercury_progress_group.h"
+#include "mercury_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define FIRST_ID  (1)
+#define NCONTEXTS (4)
+#define NRPCS     (64)
+
+#define HG_TEST_PROGRESS_GROUP_RPC "hg_test_progress_group"
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Target side of the test, RPCs are handled by the group contexts */
+struct hg_test_progress_group {
+    hg_class_t *hg_class;
+    hg_progress_group_t *group;
+    hg_atomic_int32_t handled;   /* RPCs handled by group contexts */
+    hg_atomic_int32_t misrouted; /* RPCs handled by other contexts */
+};
+
+struct forward_cb_args {
+    unsigned int completed;
+    hg_return_t ret;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static hg_return_t
+hg_test_progress_group_rpc_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_test_progress_group_forward_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_test_progress_group(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id,
+    struct hg_test_progress_group *test, unsigned long flags);
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_group_rpc_cb(hg_handle_t handle)
+{
+    const struct hg_info *hg_info = HG_Get_info(handle);
+    struct hg_test_progress_group *test =
+        (struct hg_test_progress_group *) HG_Registered_data(
+            hg_info->hg_class, hg_info->id);
+    hg_uint8_t context_id = HG_Context_get_id(hg_info->context);
+    hg_return_t ret;
+
+    /* RPC must be handled by one of the contexts of the group */
+    if (context_id >= FIRST_ID && context_id < FIRST_ID + NCONTEXTS &&
+        HG_Progress_group_get_context(test->group, context_id - FIRST_ID) ==
+            hg_info->context)
+        hg_atomic_incr32(&test->handled);
+    else
+        hg_atomic_incr32(&test->misrouted);
+
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Respond() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    HG_Destroy(handle);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_group_forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_cb_args *args =
+        (struct forward_cb_args *) callback_info->arg;
+
+    if (callback_info->ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Error in HG callback (%s)",
+            HG_Error_to_string(callback_info->ret));
+        args->ret = callback_info->ret;
+    }
+    args->completed++;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_group(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id,
+    struct hg_test_progress_group *test, unsigned long flags)
+{
+    struct forward_cb_args forward_cb_args = {0, HG_SUCCESS};
+    unsigned int triggered = 0;
+    hg_time_t t1, t2;
+    hg_return_t ret, cleanup_ret;
+    hg_uint64_t key;
+    unsigned int i;
+
+    hg_atomic_set32(&test->handled, 0);
+    hg_atomic_set32(&test->misrouted, 0);
+
+    test->group =
+        HG_Progress_group_create(test->hg_class, FIRST_ID, NCONTEXTS, flags);
+    HG_TEST_CHECK_ERROR(test->group == NULL, done, ret, HG_FAULT,
+        "HG_Progress_group_create() failed");
+
+    HG_TEST_CHECK_ERROR(HG_Progress_group_get_count(test->group) != NCONTEXTS,
+        error, ret, HG_FAULT, "Group does not have %d contexts", NCONTEXTS);
+    HG_TEST_CHECK_ERROR(
+        HG_Progress_group_get_first_id(test->group) != FIRST_ID, error, ret,
+        HG_FAULT, "First ID of group is not %d", FIRST_ID);
+    for (i = 0; i < NCONTEXTS; i++) {
+        hg_context_t *group_context =
+            HG_Progress_group_get_context(test->group, i);
+
+        HG_TEST_CHECK_ERROR(group_context == NULL, error, ret, HG_FAULT,
+            "No context at index %u of group", i);
+        HG_TEST_CHECK_ERROR(HG_Context_get_id(group_context) != FIRST_ID + i,
+            error, ret, HG_FAULT, "Context %u of group has wrong ID", i);
+    }
+    HG_TEST_CHECK_ERROR(
+        HG_Progress_group_get_context(test->group, NCONTEXTS) != NULL, error,
+        ret, HG_FAULT, "Out of range context index accepted");
+
+    /* Progress threads trigger their own contexts if not shared */
+    if (!(flags & HG_PROGRESS_GROUP_SHARED_TRIGGER)) {
+        ret = HG_Progress_group_trigger(test->group, 0, 1, &triggered);
+        HG_TEST_CHECK_ERROR(ret != HG_INVALID_ARG, error, ret, HG_FAULT,
+            "HG_Progress_group_trigger() accepted group without shared "
+            "trigger");
+    }
+
+    /* Spread RPCs over the contexts of the group */
+    for (key = 0; key < NRPCS; key++) {
+        hg_handle_t handle;
+
+        ret = HG_Create(context, addr, rpc_id, &handle);
+        HG_TEST_CHECK_HG_ERROR(
+            error, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+        ret = HG_Set_target_id_hash(handle, key, FIRST_ID, NCONTEXTS);
+        if (ret == HG_SUCCESS)
+            ret = HG_Forward(
+                handle, hg_test_progress_group_forward_cb, &forward_cb_args,
+                NULL);
+        cleanup_ret = HG_Destroy(handle);
+        HG_TEST_CHECK_HG_ERROR(error, ret, "Could not forward RPC (%s)",
+            HG_Error_to_string(ret));
+        HG_TEST_CHECK_HG_ERROR(error, cleanup_ret, "HG_Destroy() failed (%s)",
+            HG_Error_to_string(cleanup_ret));
+    }
+
+    /* Origin context and shared trigger of group are progressed together */
+    hg_time_get_current(&t1);
+    while (forward_cb_args.completed < NRPCS) {
+        unsigned int actual_count = 0;
+
+        ret = HG_Progress(context, 10);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, error, ret,
+            ret, "HG_Progress() failed (%s)", HG_Error_to_string(ret));
+
+        do {
+            ret = HG_Trigger(context, 0, 1, &actual_count);
+        } while ((ret == HG_SUCCESS) && actual_count);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, error, ret,
+            ret, "HG_Trigger() failed (%s)", HG_Error_to_string(ret));
+
+        if (flags & HG_PROGRESS_GROUP_SHARED_TRIGGER) {
+            ret = HG_Progress_group_trigger(
+                test->group, 0, NRPCS, &actual_count);
+            HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, error,
+                ret, ret, "HG_Progress_group_trigger() failed (%s)",
+                HG_Error_to_string(ret));
+            if (ret == HG_SUCCESS)
+                triggered += actual_count;
+        }
+
+        hg_time_get_current(&t2);
+        HG_TEST_CHECK_ERROR(
+            hg_time_to_double(hg_time_subtract(t2, t1)) * 1000.0 >
+                HG_MAX_IDLE_TIME,
+            error, ret, HG_TIMEOUT, "Only %u/%d RPCs completed",
+            forward_cb_args.completed, NRPCS);
+    }
+    ret = forward_cb_args.ret;
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "Error in HG callback (%s)", HG_Error_to_string(ret));
+
+    HG_TEST_CHECK_ERROR(hg_atomic_get32(&test->misrouted) != 0, error, ret,
+        HG_FAULT, "%d RPCs not handled by a context of the group",
+        hg_atomic_get32(&test->misrouted));
+    HG_TEST_CHECK_ERROR(hg_atomic_get32(&test->handled) != NRPCS, error, ret,
+        HG_FAULT, "Only %d/%d RPCs handled", hg_atomic_get32(&test->handled),
+        NRPCS);
+
+    /* Handlers only run through the shared trigger */
+    HG_TEST_CHECK_ERROR((flags & HG_PROGRESS_GROUP_SHARED_TRIGGER) &&
+                            triggered < NRPCS,
+        error, ret, HG_FAULT, "Only %u/%d callbacks triggered by group",
+        triggered, NRPCS);
+
+    ret = HG_Progress_group_destroy(test->group);
+    test->group = NULL;
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Progress_group_destroy() failed (%s)",
+        HG_Error_to_string(ret));
+
+done:
+    return ret;
+
+error:
+    cleanup_ret = HG_Progress_group_destroy(test->group);
+    test->group = NULL;
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Progress_group_destroy() failed (%s)",
+        HG_Error_to_string(cleanup_ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_info hg_test_info = {0};
+    struct hg_test_progress_group test;
+    struct hg_init_info hg_init_info;
+    char info_string[NA_TEST_MAX_ADDR_NAME];
+    char addr_string[NA_TEST_MAX_ADDR_NAME];
+    hg_size_t addr_string_len = NA_TEST_MAX_ADDR_NAME;
+    hg_addr_t self_addr = HG_ADDR_NULL, target_addr = HG_ADDR_NULL;
+    hg_id_t rpc_id;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+    memset(&test, 0, sizeof(test));
+    memset(&hg_init_info, 0, sizeof(hg_init_info));
+
+    /* Test class is the origin, no separate server is needed */
+    hg_test_info.na_test_info.self_send = NA_TRUE;
+    hg_ret = HG_Test_init(argc, argv, &hg_test_info);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "HG_Test_init() failed");
+
+    /* Target class of the group uses the same plugin and protocol */
+    snprintf(info_string, NA_TEST_MAX_ADDR_NAME, "%s+%s",
+        HG_Class_get_name(hg_test_info.hg_class),
+        HG_Class_get_protocol(hg_test_info.hg_class));
+    hg_init_info.na_init_info.max_contexts = FIRST_ID + NCONTEXTS;
+    test.hg_class = HG_Init_opt(info_string, HG_TRUE, &hg_init_info);
+    HG_TEST_CHECK_ERROR(test.hg_class == NULL, done, ret, EXIT_FAILURE,
+        "HG_Init_opt() failed");
+
+    rpc_id = HG_Register_name(test.hg_class, HG_TEST_PROGRESS_GROUP_RPC, NULL,
+        NULL, hg_test_progress_group_rpc_cb);
+    hg_ret = HG_Register_data(test.hg_class, rpc_id, &test, NULL);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Register_data() failed (%s)", HG_Error_to_string(hg_ret));
+    HG_Register_name(
+        hg_test_info.hg_class, HG_TEST_PROGRESS_GROUP_RPC, NULL, NULL, NULL);
+
+    /* Look up target from the origin class */
+    hg_ret = HG_Addr_self(test.hg_class, &self_addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_self() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Addr_to_string(
+        test.hg_class, addr_string, &addr_string_len, self_addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_to_string() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret =
+        HG_Addr_lookup2(hg_test_info.hg_class, addr_string, &target_addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_lookup2() failed (%s)", HG_Error_to_string(hg_ret));
+
+    HG_TEST("progress group");
+    hg_ret = hg_test_progress_group(
+        hg_test_info.context, target_addr, rpc_id, &test, 0);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "progress group test failed");
+    HG_PASSED();
+
+    HG_TEST("progress group with shared trigger");
+    hg_ret = hg_test_progress_group(hg_test_info.context, target_addr, rpc_id,
+        &test, HG_PROGRESS_GROUP_SHARED_TRIGGER);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "progress group with shared trigger test failed");
+    HG_PASSED();
+
+done:
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+
+    if (target_addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_test_info.hg_class, target_addr);
+    if (self_addr != HG_ADDR_NULL)
+        HG_Addr_free(test.hg_class, self_addr);
+    if (test.hg_class)
+        HG_Finalize(test.hg_class);
+
+    hg_ret = HG_Test_finalize(&hg_test_info);
+    HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
+
+    return ret;
+}
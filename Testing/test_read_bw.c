@@ -82,6 +82,7 @@ measure_bulk_transfer(
 {
     bulk_write_in_t in_struct;
     char *bulk_buf;
+    void *buf_data = NULL;
     void **buf_ptrs;
     size_t *buf_sizes;
     hg_bulk_t bulk_handle = HG_BULK_NULL;
@@ -99,8 +100,12 @@ measure_bulk_transfer(
     hg_return_t ret = HG_SUCCESS;
     size_t i;
 
-    /* Prepare bulk_buf */
-    bulk_buf = malloc(nbytes);
+    /* Prepare bulk_buf (memory that can be shared with local peers is used
+     * when requested) */
+    if (hg_test_info->bulk_alloc)
+        bulk_buf = HG_Bulk_buf_alloc(hg_test_info->hg_class, nbytes, &buf_data);
+    else
+        bulk_buf = malloc(nbytes);
     HG_TEST_CHECK_ERROR(bulk_buf == NULL, done, ret, HG_NOMEM_ERROR,
         "Could not allocate bulk buf");
     for (i = 0; i < nbytes; i++)
@@ -228,7 +233,11 @@ measure_bulk_transfer(
     }
 
 done:
-    free(bulk_buf);
+    if (buf_data)
+        (void) HG_Bulk_buf_free(
+            hg_test_info->hg_class, bulk_buf, nbytes, buf_data);
+    else
+        free(bulk_buf);
     free(handles);
     return ret;
 }
@@ -18,6 +18,10 @@
 /****************/
 
 #define NINFLIGHT (HG_TEST_MAX_HANDLES)
+#define NSTATS    (16)
+#define NLOOKUPS  (64)
+#define NKEYS     (64)
+#define NBATCH    (8)
 
 /************************************/
 /* Local Type and Struct Definition */
@@ -26,6 +30,7 @@
 struct forward_cb_args {
     hg_request_t *request;
     rpc_handle_t *rpc_handle;
+    hg_return_t ret;
 };
 
 struct lookup_cb_args {
@@ -33,6 +38,11 @@ struct lookup_cb_args {
     hg_addr_t *addr_ptr;
 };
 
+struct lookup_batch_cb_args {
+    hg_request_t *request;
+    hg_return_t ret;
+};
+
 /********************/
 /* Local Prototypes */
 /********************/
@@ -44,21 +54,36 @@ hg_test_rpc_forward_cb(const struct hg_cb_info *callback_info);
 static hg_return_t
 hg_test_rpc_forward_no_resp_cb(const struct hg_cb_info *callback_info);
 static hg_return_t
+hg_test_rpc_forward_error_cb(const struct hg_cb_info *callback_info);
+static hg_return_t
 hg_test_rpc_lookup_cb(const struct hg_cb_info *callback_info);
 static hg_return_t
+hg_test_rpc_lookup_batch_cb(const struct hg_cb_info *callback_info);
+static hg_return_t
 hg_test_rpc_forward_reset_cb(const struct hg_cb_info *callback_info);
 #ifndef HG_HAS_XDR
 static hg_return_t
 hg_test_rpc_forward_overflow_cb(const struct hg_cb_info *callback_info);
+static hg_return_t
+hg_test_rpc_forward_overflow_in_cb(const struct hg_cb_info *callback_info);
+static hg_return_t
+hg_test_rpc_forward_overflow_no_size_cb(const struct hg_cb_info *callback_info);
 #endif
 
 static hg_return_t
 hg_test_rpc(hg_context_t *context, hg_request_class_t *request_class,
     hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
 static hg_return_t
+hg_test_rpc_error(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_return_t expected_ret);
+static hg_return_t
 hg_test_rpc_lookup(hg_context_t *context, hg_request_class_t *request_class,
     const char *target_name, hg_id_t rpc_id, hg_cb_t callback);
 static hg_return_t
+hg_test_rpc_lookup_batch(hg_context_t *context,
+    hg_request_class_t *request_class, const char *target_name,
+    hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
 hg_test_rpc_reset(hg_context_t *context, hg_request_class_t *request_class,
     hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
 static hg_return_t
@@ -67,10 +92,30 @@ hg_test_rpc_mask(hg_context_t *context, hg_request_class_t *request_class,
 static hg_return_t
 hg_test_rpc_multiple(hg_context_t *context, hg_request_class_t *request_class,
     hg_addr_t addr, hg_uint8_t target_id, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_rpc_target_hash(hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_uint8_t first_id,
+    unsigned int count, hg_bool_t forward, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_rpc_stats(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback, hg_bool_t self_send);
+static hg_return_t
+hg_test_handle_pool(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_trigger_batch(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
 #ifndef HG_HAS_XDR
 static hg_return_t
 hg_test_overflow(hg_context_t *context, hg_request_class_t *request_class,
     hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_overflow_in(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_overflow_no_size(hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback);
 #endif
 static hg_return_t
 hg_test_cancel_rpc(hg_context_t *context, hg_request_class_t *request_class,
@@ -83,7 +128,11 @@ hg_test_cancel_rpc(hg_context_t *context, hg_request_class_t *request_class,
 extern hg_id_t hg_test_rpc_null_id_g;
 extern hg_id_t hg_test_rpc_open_id_g;
 extern hg_id_t hg_test_rpc_open_id_no_resp_g;
+extern hg_id_t hg_test_rpc_dispatch_id_g;
+extern hg_id_t hg_test_rpc_dispatch_error_id_g;
 extern hg_id_t hg_test_overflow_id_g;
+extern hg_id_t hg_test_overflow_in_id_g;
+extern hg_id_t hg_test_overflow_no_size_id_g;
 extern hg_id_t hg_test_cancel_rpc_id_g;
 
 /*---------------------------------------------------------------------------*/
@@ -160,6 +209,20 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_forward_error_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_cb_args *args =
+        (struct forward_cb_args *) callback_info->arg;
+
+    /* Error is expected, it is checked once the request completes */
+    args->ret = callback_info->ret;
+    hg_request_complete(args->request);
+
+    return HG_SUCCESS;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_lookup_cb(const struct hg_cb_info *callback_info)
@@ -174,6 +237,20 @@ hg_test_rpc_lookup_cb(const struct hg_cb_info *callback_info)
     return HG_SUCCESS;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_lookup_batch_cb(const struct hg_cb_info *callback_info)
+{
+    struct lookup_batch_cb_args *args =
+        (struct lookup_batch_cb_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+
+    hg_request_complete(args->request);
+
+    return HG_SUCCESS;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_forward_reset_cb(const struct hg_cb_info *callback_info)
@@ -228,6 +305,58 @@ done:
     hg_request_complete(request);
     return ret;
 }
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_forward_overflow_in_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_cb_args *args =
+        (struct forward_cb_args *) callback_info->arg;
+    hg_return_t ret = callback_info->ret;
+
+    HG_TEST_CHECK_ERROR_NORET(callback_info->ret != HG_SUCCESS, done,
+        "Error in HG callback (%s)", HG_Error_to_string(callback_info->ret));
+
+done:
+    args->ret = ret;
+    hg_request_complete(args->request);
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_forward_overflow_no_size_cb(const struct hg_cb_info *callback_info)
+{
+    hg_handle_t handle = callback_info->info.forward.handle;
+    struct forward_cb_args *args =
+        (struct forward_cb_args *) callback_info->arg;
+    overflow_no_size_out_t out_struct;
+    hg_return_t ret = callback_info->ret;
+
+    HG_TEST_CHECK_ERROR_NORET(callback_info->ret != HG_SUCCESS, done,
+        "Error in HG callback (%s)", HG_Error_to_string(callback_info->ret));
+
+    /* Get output */
+    ret = HG_Get_output(handle, &out_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Get_output() failed (%s)", HG_Error_to_string(ret));
+
+    /* Target reports whether it received the expected buffer */
+    ret = (hg_return_t) out_struct.ret;
+    HG_TEST_CHECK_ERROR_NORET(ret != HG_SUCCESS, free,
+        "Target received invalid buffer (%s)", HG_Error_to_string(ret));
+
+free:
+    if (HG_Free_output(handle, &out_struct) != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("HG_Free_output() failed");
+        ret = HG_FAULT;
+    }
+
+done:
+    args->ret = ret;
+    hg_request_complete(args->request);
+    return HG_SUCCESS;
+}
 #endif
 
 /*---------------------------------------------------------------------------*/
@@ -344,6 +473,50 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_error(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_return_t expected_ret)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    struct forward_cb_args forward_cb_args;
+
+    request = hg_request_create(request_class);
+
+    /* Create RPC request */
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Forward call to remote addr, RPC callback fails on target */
+    HG_TEST_LOG_DEBUG("Forwarding RPC, op id: %u...", rpc_id);
+    forward_cb_args.request = request;
+    forward_cb_args.ret = HG_SUCCESS;
+    ret = HG_Forward(
+        handle, hg_test_rpc_forward_error_cb, &forward_cb_args, NULL);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+
+    /* Target must have responded with the error of the RPC callback */
+    HG_TEST_CHECK_ERROR(forward_cb_args.ret != expected_ret, done, ret,
+        HG_FAULT, "Response returned %s instead of %s",
+        HG_Error_to_string(forward_cb_args.ret),
+        HG_Error_to_string(expected_ret));
+
+done:
+    cleanup_ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    hg_request_destroy(request);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_lookup(hg_context_t *context, hg_request_class_t *request_class,
@@ -428,6 +601,77 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_lookup_batch(hg_context_t *context,
+    hg_request_class_t *request_class, const char *target_name,
+    hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_class_t *hg_class = HG_Context_get_class(context);
+    hg_request_t *request = NULL;
+    const char *names[NLOOKUPS];
+    hg_addr_t addrs[NLOOKUPS];
+    struct lookup_batch_cb_args lookup_batch_args;
+    unsigned int flag = 0;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    int i, j;
+
+    for (i = 0; i < NLOOKUPS; i++) {
+        names[i] = target_name;
+        addrs[i] = HG_ADDR_NULL;
+    }
+
+    /* Look up the same name repeatedly, twice so that the second batch is
+     * served from the addr cache if enabled */
+    for (j = 0; j < 2; j++) {
+        request = hg_request_create(request_class);
+
+        lookup_batch_args.request = request;
+        lookup_batch_args.ret = HG_OTHER_ERROR;
+        ret = HG_Addr_lookup_batch(context, hg_test_rpc_lookup_batch_cb,
+            &lookup_batch_args, names, addrs, NLOOKUPS, HG_OP_ID_IGNORE);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Addr_lookup_batch() failed (%s)",
+            HG_Error_to_string(ret));
+
+        hg_request_wait(request, HG_MAX_IDLE_TIME, &flag);
+        HG_TEST_CHECK_ERROR(
+            flag == 0, done, ret, HG_TIMEOUT, "Operation did not complete");
+        ret = lookup_batch_args.ret;
+        HG_TEST_CHECK_HG_ERROR(done, ret, "Batch lookup failed (%s)",
+            HG_Error_to_string(ret));
+
+        for (i = 0; i < NLOOKUPS; i++)
+            HG_TEST_CHECK_ERROR(addrs[i] == HG_ADDR_NULL, done, ret,
+                HG_FAULT, "NULL addr for lookup %d", i);
+
+        /* Use one of the addrs */
+        ret = hg_test_rpc(
+            context, request_class, addrs[NLOOKUPS - 1], rpc_id, callback);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "hg_test_rpc() failed (%s)", HG_Error_to_string(ret));
+
+        for (i = 0; i < NLOOKUPS; i++) {
+            ret = HG_Addr_free(hg_class, addrs[i]);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Addr_free() failed (%s)",
+                HG_Error_to_string(ret));
+            addrs[i] = HG_ADDR_NULL;
+        }
+
+        hg_request_destroy(request);
+        request = NULL;
+    }
+
+done:
+    for (i = 0; i < NLOOKUPS; i++) {
+        cleanup_ret = HG_Addr_free(hg_class, addrs[i]);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Addr_free() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+    hg_request_destroy(request);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_reset(hg_context_t *context, hg_request_class_t *request_class,
@@ -656,6 +900,371 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_target_hash(hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_uint8_t first_id,
+    unsigned int count, hg_bool_t forward, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_request_t *request = NULL;
+    hg_bool_t hit[256];
+    hg_return_t ret, cleanup_ret;
+    hg_uint64_t key;
+    unsigned int i;
+
+    memset(hit, 0, sizeof(hit));
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Target IDs must not overflow */
+    ret = HG_Set_target_id_hash(handle, 0, first_id, 0);
+    HG_TEST_CHECK_ERROR(ret != HG_INVALID_ARG, error, ret, HG_FAULT,
+        "HG_Set_target_id_hash() accepted count of 0");
+    ret = HG_Set_target_id_hash(handle, 0, 255, 2);
+    HG_TEST_CHECK_ERROR(ret != HG_INVALID_ARG, error, ret, HG_FAULT,
+        "HG_Set_target_id_hash() accepted out of range target IDs");
+    ret = HG_Set_target_id_hash(handle, 0, 1, 256);
+    HG_TEST_CHECK_ERROR(ret != HG_INVALID_ARG, error, ret, HG_FAULT,
+        "HG_Set_target_id_hash() accepted out of range target IDs");
+
+    /* All 256 context IDs can be hashed across */
+    ret = HG_Set_target_id_hash(handle, 0, 0, 256);
+    HG_TEST_CHECK_HG_ERROR(error, ret, "HG_Set_target_id_hash() failed (%s)",
+        HG_Error_to_string(ret));
+
+    for (key = 0; key < NKEYS; key++) {
+        hg_uint8_t target_id;
+
+        ret = HG_Set_target_id_hash(handle, key, first_id, count);
+        HG_TEST_CHECK_HG_ERROR(error, ret,
+            "HG_Set_target_id_hash() failed (%s)", HG_Error_to_string(ret));
+        target_id = HG_Get_info(handle)->context_id;
+        HG_TEST_CHECK_ERROR(
+            target_id < first_id || target_id >= first_id + count, error, ret,
+            HG_FAULT, "Target ID %u not in [%u, %u)", target_id, first_id,
+            first_id + count);
+
+        /* Same key must always be routed to the same target */
+        ret = HG_Set_target_id_hash(handle, key, first_id, count);
+        HG_TEST_CHECK_HG_ERROR(error, ret,
+            "HG_Set_target_id_hash() failed (%s)", HG_Error_to_string(ret));
+        HG_TEST_CHECK_ERROR(HG_Get_info(handle)->context_id != target_id,
+            error, ret, HG_FAULT, "Target ID changed for key %u",
+            (unsigned int) key);
+
+        hit[target_id] = HG_TRUE;
+
+        if (forward) {
+            rpc_open_in_t rpc_open_in_struct;
+            rpc_handle_t rpc_open_handle;
+            struct forward_cb_args forward_cb_args;
+            unsigned int flag = 0;
+
+            request = hg_request_create(request_class);
+
+            rpc_open_handle.cookie = (hg_uint64_t) key;
+            rpc_open_in_struct.path = HG_TEST_TEMP_DIRECTORY "/test.h5";
+            rpc_open_in_struct.handle = rpc_open_handle;
+
+            forward_cb_args.request = request;
+            forward_cb_args.rpc_handle = &rpc_open_handle;
+            ret = HG_Forward(
+                handle, callback, &forward_cb_args, &rpc_open_in_struct);
+            HG_TEST_CHECK_HG_ERROR(error, ret, "HG_Forward() failed (%s)",
+                HG_Error_to_string(ret));
+
+            hg_request_wait(request, HG_MAX_IDLE_TIME, &flag);
+            HG_TEST_CHECK_ERROR(flag == 0, error, ret, HG_TIMEOUT,
+                "Operation did not complete");
+
+            hg_request_destroy(request);
+            request = NULL;
+        }
+    }
+
+    /* Keys must be spread over all the targets */
+    for (i = first_id; i < (unsigned int) first_id + count; i++)
+        HG_TEST_CHECK_ERROR(!hit[i], error, ret, HG_FAULT,
+            "No key routed to target ID %u", i);
+
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    return ret;
+
+error:
+    if (request)
+        hg_request_destroy(request);
+    cleanup_ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_stats(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback, hg_bool_t self_send)
+{
+    hg_class_t *hg_class = HG_Context_get_class(context);
+    struct hg_stats stats;
+    hg_return_t ret, cleanup_ret;
+    int i;
+
+    ret = HG_Stats_reset(hg_class, 0);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Stats_reset() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Stats_enable(hg_class, HG_TRUE);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Stats_enable() failed (%s)", HG_Error_to_string(ret));
+
+    for (i = 0; i < NSTATS; i++) {
+        ret = hg_test_rpc(context, request_class, addr, rpc_id, callback);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_rpc() failed (%s)",
+            HG_Error_to_string(ret));
+    }
+
+    ret = HG_Stats_get(hg_class, rpc_id, &stats);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Stats_get() failed (%s)", HG_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(stats.forward_count != NSTATS, done, ret, HG_FAULT,
+        "Forward count is %lu, expected %d",
+        (unsigned long) stats.forward_count, NSTATS);
+
+    /* RPCs forwarded to self are counted but not timed */
+    if (!self_send) {
+        const struct hg_stats_hist *hist = &stats.latency[HG_STATS_RESPONSE];
+
+        HG_TEST_CHECK_ERROR(
+            stats.bytes_out == 0, done, ret, HG_FAULT, "No bytes counted");
+        HG_TEST_CHECK_ERROR(stats.latency[HG_STATS_FORWARD].count != NSTATS ||
+                                hist->count != NSTATS,
+            done, ret, HG_FAULT, "Unexpected latency sample count");
+        HG_TEST_CHECK_ERROR(HG_Stats_percentile(hist, 50.0) >
+                                    HG_Stats_percentile(hist, 99.0) ||
+                                HG_Stats_percentile(hist, 100.0) != hist->max,
+            done, ret, HG_FAULT, "Inconsistent latency percentiles");
+    }
+
+    ret = HG_Stats_reset(hg_class, rpc_id);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Stats_reset() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Stats_get(hg_class, rpc_id, &stats);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Stats_get() failed (%s)", HG_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(stats.forward_count != 0 ||
+                            stats.latency[HG_STATS_FORWARD].count != 0,
+        done, ret, HG_FAULT, "Stats were not reset");
+
+done:
+    cleanup_ret = HG_Stats_enable(hg_class, HG_FALSE);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Stats_enable() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_handle_pool(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_handle_t handles[HG_TEST_HANDLE_POOL_SIZE + 1];
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_uint64_t hits, misses, prev_hits, prev_misses;
+    hg_return_t ret, cleanup_ret;
+    unsigned int count = 0, i;
+
+    ret = HG_Context_get_handle_pool_stats(context, NULL, &prev_misses);
+    HG_TEST_CHECK_HG_ERROR(done, ret,
+        "HG_Context_get_handle_pool_stats() failed (%s)",
+        HG_Error_to_string(ret));
+
+    /* Drain pool, a miss means that it is empty */
+    do {
+        ret = HG_Create(context, addr, rpc_id, &handles[count]);
+        HG_TEST_CHECK_HG_ERROR(
+            error, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+        count++;
+
+        ret = HG_Context_get_handle_pool_stats(context, NULL, &misses);
+        HG_TEST_CHECK_HG_ERROR(error, ret,
+            "HG_Context_get_handle_pool_stats() failed (%s)",
+            HG_Error_to_string(ret));
+    } while (misses == prev_misses && count < HG_TEST_HANDLE_POOL_SIZE + 1);
+    HG_TEST_CHECK_ERROR(misses == prev_misses, error, ret, HG_FAULT,
+        "Handle pool holds more than %d handles", HG_TEST_HANDLE_POOL_SIZE);
+
+    ret = HG_Context_get_handle_pool_stats(context, &prev_hits, &prev_misses);
+    HG_TEST_CHECK_HG_ERROR(error, ret,
+        "HG_Context_get_handle_pool_stats() failed (%s)",
+        HG_Error_to_string(ret));
+
+    /* Destroyed handle is the only one cached and must be re-used */
+    count--;
+    ret = HG_Destroy(handles[count]);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(handle != handles[count], error, ret, HG_FAULT,
+        "Handle was not re-used from pool");
+
+    ret = HG_Context_get_handle_pool_stats(context, &hits, &misses);
+    HG_TEST_CHECK_HG_ERROR(error, ret,
+        "HG_Context_get_handle_pool_stats() failed (%s)",
+        HG_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(hits != prev_hits + 1 || misses != prev_misses, error,
+        ret, HG_FAULT,
+        "Expected 1 hit and no miss, got %lu hit(s) and %lu miss(es)",
+        (unsigned long) (hits - prev_hits),
+        (unsigned long) (misses - prev_misses));
+
+    ret = HG_Destroy(handle);
+    handle = HG_HANDLE_NULL;
+    HG_TEST_CHECK_HG_ERROR(
+        error, ret, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    /* Handles used to forward RPCs must also be re-used */
+    for (i = 0; i < NSTATS; i++) {
+        ret = hg_test_rpc(context, request_class, addr, rpc_id, callback);
+        HG_TEST_CHECK_HG_ERROR(error, ret, "hg_test_rpc() failed (%s)",
+            HG_Error_to_string(ret));
+    }
+
+    ret = HG_Context_get_handle_pool_stats(context, &hits, &misses);
+    HG_TEST_CHECK_HG_ERROR(error, ret,
+        "HG_Context_get_handle_pool_stats() failed (%s)",
+        HG_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(hits != prev_hits + 1 + NSTATS || misses != prev_misses,
+        error, ret, HG_FAULT, "Forwarded handles were not re-used");
+
+error:
+    for (i = 0; i < count; i++) {
+        cleanup_ret = HG_Destroy(handles[i]);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+    if (handle != HG_HANDLE_NULL) {
+        cleanup_ret = HG_Destroy(handle);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_trigger_batch(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handles[NBATCH];
+    hg_completion_t completions[NBATCH];
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    struct forward_cb_args forward_cb_args;
+    hg_const_string_t rpc_open_path = HG_TEST_TEMP_DIRECTORY "/test.h5";
+    rpc_handle_t rpc_open_handle;
+    rpc_open_in_t rpc_open_in_struct;
+    unsigned int handle_count = 0, completed, actual_count, i;
+
+    ret = HG_Trigger_completion(HG_COMPLETION_NULL);
+    HG_TEST_CHECK_ERROR(ret != HG_INVALID_ARG, done, ret, HG_FAULT,
+        "HG_Trigger_completion() with NULL completion did not fail");
+    ret = HG_SUCCESS;
+
+    /* Each forward callback increments the same request */
+    request = hg_request_create(request_class);
+    forward_cb_args.request = request;
+    forward_cb_args.rpc_handle = &rpc_open_handle;
+
+    /* Fill input structure */
+    rpc_open_handle.cookie = 100;
+    rpc_open_in_struct.path = rpc_open_path;
+    rpc_open_in_struct.handle = rpc_open_handle;
+
+    for (handle_count = 0; handle_count < NBATCH; handle_count++) {
+        ret = HG_Create(context, addr, rpc_id, &handles[handle_count]);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+    }
+
+    /* Completions are dequeued but only executed on HG_Trigger_completion() */
+    for (i = 0; i < NBATCH; i++) {
+        ret = HG_Forward(
+            handles[i], callback, &forward_cb_args, &rpc_open_in_struct);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+    }
+
+    do {
+        ret = HG_Progress(context, 100);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, done, ret,
+            ret, "HG_Progress() failed (%s)", HG_Error_to_string(ret));
+
+        completed = (unsigned int) hg_atomic_get32(&request->completed);
+        ret = HG_Trigger_batch(context, 0, NBATCH, completions, &actual_count);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, done, ret,
+            ret, "HG_Trigger_batch() failed (%s)", HG_Error_to_string(ret));
+        ret = HG_SUCCESS;
+        HG_TEST_CHECK_ERROR(actual_count > NBATCH, done, ret, HG_FAULT,
+            "Dequeued %u completions, expected at most %d", actual_count,
+            NBATCH);
+        HG_TEST_CHECK_ERROR(
+            (unsigned int) hg_atomic_get32(&request->completed) != completed,
+            done, ret, HG_FAULT,
+            "Callbacks were executed by HG_Trigger_batch()");
+
+        for (i = 0; i < actual_count; i++) {
+            ret = HG_Trigger_completion(completions[i]);
+            HG_TEST_CHECK_HG_ERROR(done, ret,
+                "HG_Trigger_completion() failed (%s)", HG_Error_to_string(ret));
+        }
+    } while (hg_atomic_get32(&request->completed) < NBATCH);
+
+    /* Without completion array, callbacks are executed inline */
+    hg_request_reset(request);
+    ret =
+        HG_Forward(handles[0], callback, &forward_cb_args, &rpc_open_in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+
+    do {
+        ret = HG_Progress(context, 100);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, done, ret,
+            ret, "HG_Progress() failed (%s)", HG_Error_to_string(ret));
+
+        ret = HG_Trigger_batch(context, 0, NBATCH, NULL, &actual_count);
+        HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, done, ret,
+            ret, "HG_Trigger_batch() failed (%s)", HG_Error_to_string(ret));
+        ret = HG_SUCCESS;
+    } while (hg_atomic_get32(&request->completed) < 1);
+
+done:
+    for (i = 0; i < handle_count; i++) {
+        cleanup_ret = HG_Destroy(handles[i]);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+
+    if (request)
+        hg_request_destroy(request);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 #ifndef HG_HAS_XDR
 static hg_return_t
@@ -690,6 +1299,144 @@ done:
 
     return ret;
 }
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_overflow_in(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_class_t *hg_class = HG_Context_get_class(context);
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_bulk_t extra_bulk = HG_BULK_NULL;
+    struct forward_cb_args forward_cb_args;
+    overflow_in_t in_struct;
+    hg_size_t string_len = HG_Class_get_input_eager_size(hg_class) * 2;
+    hg_size_t extra_buf_size = string_len * 2;
+    void *extra_buf = NULL;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    int i;
+
+    request = hg_request_create(request_class);
+
+    in_struct.string = (hg_string_t) malloc(string_len + 1);
+    HG_TEST_CHECK_ERROR(in_struct.string == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate string");
+    memset(in_struct.string, 'h', string_len);
+    in_struct.string[string_len] = '\0';
+    in_struct.string_len = string_len;
+
+    /* Register extra buffer once, input is directly encoded into it */
+    extra_buf = malloc(extra_buf_size);
+    HG_TEST_CHECK_ERROR(extra_buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate extra buffer");
+
+    ret = HG_Bulk_create(hg_class, 1, &extra_buf, &extra_buf_size,
+        HG_BULK_READ_ONLY, &extra_bulk);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Bulk_create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Create RPC request */
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Set_input_extra_bulk(handle, extra_bulk);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Set_input_extra_bulk() failed (%s)",
+        HG_Error_to_string(ret));
+
+    /* Forward multiple times to make sure extra buffer can be re-used */
+    forward_cb_args.request = request;
+    for (i = 0; i < 2; i++) {
+        hg_request_reset(request);
+
+        HG_TEST_LOG_DEBUG("Forwarding RPC, op id: %u...", rpc_id);
+        ret = HG_Forward(handle, callback, &forward_cb_args, &in_struct);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+
+        hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+
+        ret = forward_cb_args.ret;
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "Error in HG callback (%s)", HG_Error_to_string(ret));
+    }
+
+done:
+    cleanup_ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    cleanup_ret = HG_Bulk_free(extra_bulk);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Bulk_free() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    free(extra_buf);
+    free(in_struct.string);
+    hg_request_destroy(request);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_overflow_no_size(hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback)
+{
+    hg_class_t *hg_class = HG_Context_get_class(context);
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    struct forward_cb_args forward_cb_args;
+    perf_rpc_lat_in_t in_struct;
+    hg_size_t buf_size = HG_Class_get_input_eager_size(hg_class) * 2;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    hg_size_t j;
+    int i;
+
+    request = hg_request_create(request_class);
+
+    /* Proc of that RPC returns an error on HG_SIZE */
+    in_struct.buf_size = (hg_uint32_t) buf_size;
+    in_struct.buf = malloc(buf_size);
+    HG_TEST_CHECK_ERROR(in_struct.buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate buffer");
+    for (j = 0; j < buf_size; j++)
+        ((char *) in_struct.buf)[j] = (char) j;
+
+    /* Create RPC request */
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    /* First forward overflows and enables the size pass, next ones must fall
+     * back to growing the buffer while encoding */
+    forward_cb_args.request = request;
+    for (i = 0; i < 3; i++) {
+        hg_request_reset(request);
+
+        HG_TEST_LOG_DEBUG("Forwarding RPC, op id: %u...", rpc_id);
+        ret = HG_Forward(handle, callback, &forward_cb_args, &in_struct);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+
+        hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+
+        ret = forward_cb_args.ret;
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "Error in HG callback (%s)", HG_Error_to_string(ret));
+    }
+
+done:
+    cleanup_ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    free(in_struct.buf);
+    hg_request_destroy(request);
+
+    return ret;
+}
 #endif
 
 /*---------------------------------------------------------------------------*/
@@ -738,6 +1485,7 @@ main(int argc, char *argv[])
 {
     struct hg_test_info hg_test_info = {0};
     hg_return_t hg_ret;
+    hg_bool_t enabled = HG_FALSE;
     hg_id_t inv_id;
     int ret = EXIT_SUCCESS;
 
@@ -781,6 +1529,14 @@ main(int argc, char *argv[])
             "lookup test failed");
         HG_PASSED();
 
+        HG_TEST("batch lookup RPC");
+        hg_ret = hg_test_rpc_lookup_batch(hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.na_test_info.target_name,
+            hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "batch lookup test failed");
+        HG_PASSED();
+
         request = hg_request_create(hg_test_info.request_class);
 
         /* Look up target addr using target name info */
@@ -830,6 +1586,29 @@ main(int argc, char *argv[])
         "no response RPC test failed");
     HG_PASSED();
 
+    /* RPC test with callback executed from dispatch pool */
+    HG_TEST("dispatched RPC");
+    hg_ret = HG_Registered_enabled_dispatch(
+        hg_test_info.hg_class, hg_test_rpc_dispatch_id_g, &enabled);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS || !enabled, done, ret,
+        EXIT_FAILURE, "HG_Registered_enabled_dispatch() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    hg_ret = hg_test_rpc(hg_test_info.context, hg_test_info.request_class,
+        hg_test_info.target_addr, hg_test_rpc_dispatch_id_g,
+        hg_test_rpc_forward_cb);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "dispatched RPC test failed");
+    HG_PASSED();
+
+    /* RPC test with dispatched callback that fails */
+    HG_TEST("dispatched RPC error");
+    hg_ret = hg_test_rpc_error(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_dispatch_error_id_g, HG_PROTOCOL_ERROR);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "dispatched RPC error test failed");
+    HG_PASSED();
+
     /* RPC test with unregistered ID */
     inv_id =
         MERCURY_REGISTER(hg_test_info.hg_class, "unreg_id", void, void, NULL);
@@ -894,6 +1673,51 @@ main(int argc, char *argv[])
         HG_PASSED();
     }
 
+    /* Hashed target ID test, routes to secondary contexts (IDs 1 and up) */
+    HG_TEST("hashed target ID RPCs");
+    if (hg_test_info.na_test_info.max_contexts > 1)
+        hg_ret = hg_test_rpc_target_hash(hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.target_addr, 1,
+            (unsigned int) hg_test_info.na_test_info.max_contexts - 1, HG_TRUE,
+            hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    else
+        hg_ret = hg_test_rpc_target_hash(hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.target_addr, 1, 3,
+            HG_FALSE, hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "hashed target ID test failed");
+    HG_PASSED();
+
+    /* Handle pool test (-U option) */
+    if (hg_test_info.handle_pool) {
+        HG_TEST("handle pool");
+        hg_ret = hg_test_handle_pool(hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.target_addr,
+            hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "handle pool test failed");
+        HG_PASSED();
+    }
+
+    /* Batched trigger test */
+    HG_TEST("batched trigger");
+    hg_ret = hg_test_trigger_batch(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "batched trigger test failed");
+    HG_PASSED();
+
+    /* RPC stats test */
+    HG_TEST("RPC stats");
+    hg_ret = hg_test_rpc_stats(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb,
+        (hg_bool_t) hg_test_info.na_test_info.self_send);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "RPC stats test failed");
+    HG_PASSED();
+
 #ifndef HG_HAS_XDR
     /* Overflow RPC test */
     HG_TEST("overflow RPC");
@@ -903,6 +1727,24 @@ main(int argc, char *argv[])
     HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
         "overflow RPC test failed");
     HG_PASSED();
+
+    /* Overflow RPC test with input encoded into registered buffer */
+    HG_TEST("overflow RPC (extra bulk)");
+    hg_ret = hg_test_overflow_in(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_overflow_in_id_g, hg_test_rpc_forward_overflow_in_cb);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "overflow RPC (extra bulk) test failed");
+    HG_PASSED();
+
+    /* Overflow RPC test with proc that rejects HG_SIZE */
+    HG_TEST("overflow RPC (no size pass)");
+    hg_ret = hg_test_overflow_no_size(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_overflow_no_size_id_g, hg_test_rpc_forward_overflow_no_size_cb);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "overflow RPC (no size pass) test failed");
+    HG_PASSED();
 #endif
 
     /* Cancel RPC test (self cancelation is not supported) */
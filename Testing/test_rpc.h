@@ -38,6 +38,8 @@ MERCURY_GEN_STRUCT_PROC(rpc_handle_t, ((hg_uint64_t)(cookie)))
  */
 MERCURY_GEN_PROC(
     rpc_open_in_t, ((hg_const_string_t)(path))((rpc_handle_t)(handle)))
+MERCURY_GEN_PROC(rpc_open_in_view_t,
+    ((hg_const_string_view_t)(path))((rpc_handle_t)(handle)))
 MERCURY_GEN_PROC(rpc_open_out_t, ((hg_int32_t)(ret))((hg_int32_t)(event_id)))
 #else
 /* Dummy function that needs to be shipped (already defined) */
@@ -81,6 +83,39 @@ hg_proc_rpc_open_in_t(hg_proc_t proc, void *data)
     return ret;
 }
 
+/* Define hg_proc_rpc_open_in_t_peek_path */
+static HG_INLINE hg_return_t
+hg_proc_rpc_open_in_t_peek_path(hg_proc_t proc, void *data)
+{
+    rpc_open_in_t *struct_data = (rpc_open_in_t *) data;
+
+    return hg_proc_hg_const_string_t(proc, &struct_data->path);
+}
+
+/* Define rpc_open_in_view_t */
+typedef struct {
+    hg_const_string_view_t path;
+    rpc_handle_t handle;
+} rpc_open_in_view_t;
+
+/* Define hg_proc_rpc_open_in_view_t */
+static HG_INLINE hg_return_t
+hg_proc_rpc_open_in_view_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    rpc_open_in_view_t *struct_data = (rpc_open_in_view_t *) data;
+
+    ret = hg_proc_hg_const_string_view_t(proc, &struct_data->path);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_rpc_handle_t(proc, &struct_data->handle);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
+
 /* Define rpc_open_out_t */
 typedef struct {
     hg_int32_t ret;
@@ -268,6 +268,18 @@ main(int argc, char *argv[])
         fprintf(stdout, "\n");
     }
 
+    if (hg_test_info.na_test_info.spin_wait &&
+        hg_test_info.na_test_info.mpi_comm_rank == 0) {
+        hg_uint64_t spin_count = 0, block_count = 0;
+
+        hg_ret = HG_Context_get_progress_stats(
+            hg_test_info.context, &spin_count, &block_count);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "HG_Context_get_progress_stats() failed");
+        fprintf(stdout, "# Progress: %llu spin(s), %llu block(s)\n",
+            (unsigned long long) spin_count, (unsigned long long) block_count);
+    }
+
 done:
     hg_ret = HG_Test_finalize(&hg_test_info);
     HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
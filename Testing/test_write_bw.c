@@ -79,6 +79,7 @@ measure_bulk_transfer(
 {
     bulk_write_in_t in_struct;
     char *bulk_buf;
+    void *buf_data = NULL;
     void **buf_ptrs;
     size_t *buf_sizes;
     hg_bulk_t bulk_handle = HG_BULK_NULL;
@@ -96,8 +97,12 @@ measure_bulk_transfer(
     hg_return_t ret = HG_SUCCESS;
     size_t i;
 
-    /* Prepare bulk_buf */
-    bulk_buf = malloc(nbytes);
+    /* Prepare bulk_buf (memory that can be shared with local peers is used
+     * when requested) */
+    if (hg_test_info->bulk_alloc)
+        bulk_buf = HG_Bulk_buf_alloc(hg_test_info->hg_class, nbytes, &buf_data);
+    else
+        bulk_buf = malloc(nbytes);
     HG_TEST_CHECK_ERROR(bulk_buf == NULL, done, ret, HG_NOMEM_ERROR,
         "Could not allocate bulk buf");
     for (i = 0; i < nbytes; i++)
@@ -122,7 +127,8 @@ measure_bulk_transfer(
     args.op_count = nhandles;
     args.request = request;
 
-    /* Register memory */
+    /* Register memory (when the registration cache is used, the handle is
+     * instead re-created for every transfer to measure cache lookups) */
     ret = HG_Bulk_create(hg_test_info->hg_class, 1, buf_ptrs,
         (hg_size_t *) buf_sizes, HG_BULK_READ_ONLY, &bulk_handle);
     HG_TEST_CHECK_HG_ERROR(
@@ -162,6 +168,18 @@ again:
 
         hg_time_get_current(&t1);
 
+        if (hg_test_info->bulk_cache) {
+            ret = HG_Bulk_free(bulk_handle);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_free() failed (%s)",
+                HG_Error_to_string(ret));
+
+            ret = HG_Bulk_create(hg_test_info->hg_class, 1, buf_ptrs,
+                (hg_size_t *) buf_sizes, HG_BULK_READ_ONLY, &bulk_handle);
+            HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_create() failed (%s)",
+                HG_Error_to_string(ret));
+            in_struct.bulk_handle = bulk_handle;
+        }
+
         for (j = 0; j < nhandles; j++) {
             /* Assign handles to multiple targets */
             if (hg_test_info->na_test_info.max_contexts > 1) {
@@ -220,6 +238,11 @@ again:
     HG_TEST_CHECK_HG_ERROR(
         done, ret, "HG_Bulk_free() failed (%s)", HG_Error_to_string(ret));
 
+    /* Buffer is about to be freed, drop its cached registration */
+    ret = HG_Bulk_cache_invalidate(hg_test_info->hg_class, bulk_buf, nbytes);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Bulk_cache_invalidate() failed (%s)",
+        HG_Error_to_string(ret));
+
     /* Complete */
     hg_request_destroy(request);
     for (i = 0; i < nhandles; i++) {
@@ -229,7 +252,11 @@ again:
     }
 
 done:
-    free(bulk_buf);
+    if (buf_data)
+        (void) HG_Bulk_buf_free(
+            hg_test_info->hg_class, bulk_buf, nbytes, buf_data);
+    else
+        free(bulk_buf);
     free(handles);
     return ret;
 }
@@ -274,6 +301,17 @@ main(int argc, char *argv[])
             fprintf(stdout, "\n");
     }
 
+    if (hg_test_info.bulk_cache &&
+        hg_test_info.na_test_info.mpi_comm_rank == 0) {
+        hg_uint64_t hits = 0, misses = 0;
+
+        hg_ret = HG_Bulk_cache_get_stats(hg_test_info.hg_class, &hits, &misses);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "HG_Bulk_cache_get_stats() failed");
+        fprintf(stdout, "# Registration cache: %llu hit(s), %llu miss(es)\n",
+            (unsigned long long) hits, (unsigned long long) misses);
+    }
+
 done:
     hg_ret = HG_Test_finalize(&hg_test_info);
     HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
@@ -0,0 +1,85 @@
+#include "mercury_crc32c.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUF_SIZE 4096
+
+/* Check value of CRC32C for "123456789" */
+#define CHECK_VALUE 0xE3069283
+
+int
+main(int argc, char *argv[])
+{
+    unsigned char *src = NULL, *dst = NULL;
+    hg_util_uint32_t crc, crc_sw;
+    size_t offset, size, i;
+    int ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    printf("Using %s implementation\n", hg_crc32c_impl_name());
+
+    /* Known values */
+    if (hg_crc32c_update(0, "123456789", 9) != CHECK_VALUE ||
+        hg_crc32c_update_sw(0, "123456789", 9) != CHECK_VALUE ||
+        hg_crc32c_update(0, NULL, 0) != 0) {
+        fprintf(stderr, "Error: invalid check value\n");
+        return EXIT_FAILURE;
+    }
+
+    src = (unsigned char *) malloc(BUF_SIZE);
+    dst = (unsigned char *) malloc(BUF_SIZE);
+    if (src == NULL || dst == NULL) {
+        fprintf(stderr, "Error: could not allocate buffers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < BUF_SIZE; i++)
+        src[i] = (unsigned char) (i * 31 + (i >> 8));
+
+    /* All implementations and paths agree for unaligned buffers of any size,
+     * and chaining gives the same result as a single update */
+    for (offset = 0; offset < 8; offset++) {
+        for (size = 0; size + offset <= 256; size++) {
+            crc_sw = hg_crc32c_update_sw(0, src + offset, size);
+            crc = hg_crc32c_update(0, src + offset, size);
+            if (crc != crc_sw) {
+                fprintf(stderr, "Error: CRC mismatch (offset %zu, size %zu)\n",
+                    offset, size);
+                ret = EXIT_FAILURE;
+                goto done;
+            }
+
+            memset(dst, 0, BUF_SIZE);
+            crc = hg_crc32c_copy(0, dst + offset, src + offset, size / 2);
+            crc = hg_crc32c_copy(crc, dst + offset + size / 2,
+                src + offset + size / 2, size - size / 2);
+            if (crc != crc_sw ||
+                memcmp(dst + offset, src + offset, size) != 0) {
+                fprintf(stderr, "Error: copy mismatch (offset %zu, size %zu)\n",
+                    offset, size);
+                ret = EXIT_FAILURE;
+                goto done;
+            }
+        }
+    }
+
+    /* Single bit errors are detected */
+    crc = hg_crc32c_update(0, src, BUF_SIZE);
+    src[BUF_SIZE / 2] ^= 1;
+    if (hg_crc32c_update(0, src, BUF_SIZE) == crc) {
+        fprintf(stderr, "Error: bit flip not detected\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    free(src);
+    free(dst);
+    return ret;
+}
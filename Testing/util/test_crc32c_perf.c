@@ -0,0 +1,108 @@
+#include "mercury_crc32c.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HG_TEST_MIN_SIZE 8
+#define HG_TEST_MAX_SIZE (1 << 20)
+#define HG_TEST_BYTES    (1 << 28) /* Bytes processed per measurement */
+
+/* Encoding paths compared */
+typedef enum {
+    HG_TEST_COPY_SW,   /* memcpy then portable CRC */
+    HG_TEST_COPY_BEST, /* memcpy then best CRC */
+    HG_TEST_FUSED,     /* copy and CRC in a single pass */
+    HG_TEST_COPY_ONLY, /* memcpy without CRC */
+    HG_TEST_PATH_MAX
+} hg_test_path_t;
+
+static const char *hg_test_path_names[HG_TEST_PATH_MAX] = {
+    "memcpy+sw", "memcpy+crc", "fused", "memcpy"};
+
+static double
+run_path(hg_test_path_t path, unsigned char *dst, const unsigned char *src,
+    size_t size, hg_util_uint32_t *crc)
+{
+    size_t n_iter = HG_TEST_BYTES / size, i;
+    hg_time_t t1, t2;
+
+    *crc = 0;
+    hg_time_get_current(&t1);
+    for (i = 0; i < n_iter; i++) {
+        switch (path) {
+            case HG_TEST_COPY_SW:
+                memcpy(dst, src, size);
+                *crc = hg_crc32c_update_sw(*crc, dst, size);
+                break;
+            case HG_TEST_COPY_BEST:
+                memcpy(dst, src, size);
+                *crc = hg_crc32c_update(*crc, dst, size);
+                break;
+            case HG_TEST_FUSED:
+                *crc = hg_crc32c_copy(*crc, dst, src, size);
+                break;
+            case HG_TEST_COPY_ONLY:
+            default:
+                memcpy(dst, src, size);
+                *crc += dst[i % size];
+                break;
+        }
+    }
+    hg_time_get_current(&t2);
+
+    /* GB/s */
+    return (double) (n_iter * size) /
+           (hg_time_to_double(hg_time_subtract(t2, t1)) * 1e9);
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned char *src = NULL, *dst = NULL;
+    size_t max_size = HG_TEST_MAX_SIZE, size, i;
+    int ret = EXIT_SUCCESS;
+
+    if (argc > 1)
+        max_size = (size_t) strtoul(argv[1], NULL, 10);
+
+    src = (unsigned char *) malloc(max_size);
+    dst = (unsigned char *) malloc(max_size);
+    if (src == NULL || dst == NULL) {
+        fprintf(stderr, "Error: could not allocate buffers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < max_size; i++)
+        src[i] = (unsigned char) i;
+
+    printf("# CRC32C using %s, throughput in GB/s\n", hg_crc32c_impl_name());
+    printf("%-10s", "# Size");
+    for (i = 0; i < HG_TEST_PATH_MAX; i++)
+        printf(" %-12s", hg_test_path_names[i]);
+    printf("\n");
+    for (size = HG_TEST_MIN_SIZE; size <= max_size; size *= 8) {
+        hg_util_uint32_t crcs[HG_TEST_PATH_MAX];
+
+        printf("%-10zu", size);
+        for (i = 0; i < HG_TEST_PATH_MAX; i++)
+            printf(" %-12.2f",
+                run_path((hg_test_path_t) i, dst, src, size, &crcs[i]));
+        printf("\n");
+
+        if (crcs[HG_TEST_COPY_SW] != crcs[HG_TEST_COPY_BEST] ||
+            crcs[HG_TEST_COPY_SW] != crcs[HG_TEST_FUSED]) {
+            fprintf(stderr, "Error: CRC mismatch for size %zu\n", size);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+done:
+    free(src);
+    free(dst);
+    return ret;
+}
@@ -0,0 +1,130 @@
+#include "mercury_hash_map.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_ENTRIES 10000
+
+static int
+int_equal(hg_hash_map_key_t vlocation1, hg_hash_map_key_t vlocation2)
+{
+    return *((int *) vlocation1) == *((int *) vlocation2);
+}
+
+static unsigned int
+int_hash(hg_hash_map_key_t vlocation)
+{
+    return *((unsigned int *) vlocation);
+}
+
+static void
+int_hash_value_free(hg_hash_map_value_t value)
+{
+    free((int *) value);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int
+main(int argc, char *argv[])
+{
+    hg_hash_map_t *hash_map = NULL;
+    hg_hash_map_iter_t hash_map_iter;
+    int *keys = NULL;
+    int *value;
+    unsigned int count;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    (void) argc;
+    (void) argv;
+
+    hash_map = hg_hash_map_new(int_hash, int_equal);
+    if (hash_map == NULL) {
+        fprintf(stderr, "Error: could not create hash map\n");
+        return EXIT_FAILURE;
+    }
+    hg_hash_map_register_free_functions(hash_map, NULL, int_hash_value_free);
+
+    /* Keys are owned by the test, values by the map */
+    keys = (int *) malloc(NUM_ENTRIES * sizeof(int));
+    if (keys == NULL) {
+        fprintf(stderr, "Error: could not allocate keys\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < NUM_ENTRIES; i++) {
+        keys[i] = i;
+        value = (int *) malloc(sizeof(int));
+        *value = i * 10;
+        hg_hash_map_insert(hash_map, &keys[i], value);
+    }
+
+    if (NUM_ENTRIES != hg_hash_map_num_entries(hash_map)) {
+        fprintf(stderr, "Error: was expecting %d entries, got %u\n",
+            NUM_ENTRIES, hg_hash_map_num_entries(hash_map));
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Overwrite */
+    value = (int *) malloc(sizeof(int));
+    *value = -1;
+    hg_hash_map_insert(hash_map, &keys[0], value);
+    if (NUM_ENTRIES != hg_hash_map_num_entries(hash_map) ||
+        *((int *) hg_hash_map_lookup(hash_map, &keys[0])) != -1) {
+        fprintf(stderr, "Error: overwrite failed\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Remove even keys */
+    for (i = 0; i < NUM_ENTRIES; i += 2)
+        if (!hg_hash_map_remove(hash_map, &keys[i])) {
+            fprintf(stderr, "Error: could not remove key %d\n", i);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    if (hg_hash_map_remove(hash_map, &keys[0])) {
+        fprintf(stderr, "Error: removed key 0 twice\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    for (i = 0; i < NUM_ENTRIES; i++) {
+        value = (int *) hg_hash_map_lookup(hash_map, &keys[i]);
+        if ((i % 2 == 0 && value != HG_HASH_MAP_NULL) ||
+            (i % 2 == 1 && (value == HG_HASH_MAP_NULL || *value != i * 10))) {
+            fprintf(stderr, "Error: lookup of key %d failed\n", i);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+    count = 0;
+    hg_hash_map_iterate(hash_map, &hash_map_iter);
+    while (hg_hash_map_iter_has_more(&hash_map_iter)) {
+        value = (int *) hg_hash_map_iter_next(&hash_map_iter);
+        if (value == HG_HASH_MAP_NULL || (*value / 10) % 2 != 1) {
+            fprintf(stderr, "Error: unexpected value during iteration\n");
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        count++;
+    }
+    if (count != NUM_ENTRIES / 2 ||
+        count != hg_hash_map_num_entries(hash_map)) {
+        fprintf(stderr, "Error: iterated over %u entries, expected %d\n",
+            count, NUM_ENTRIES / 2);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    hg_hash_map_free(hash_map);
+    free(keys);
+
+    return ret;
+}
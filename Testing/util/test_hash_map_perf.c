@@ -0,0 +1,207 @@
+#include "mercury_hash_map.h"
+#include "mercury_hash_table.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HG_TEST_MIN_ENTRIES 1000
+#define HG_TEST_MAX_ENTRIES 10000000
+#define HG_TEST_MIN_LOOKUPS 1000000
+
+/* Keys are stored inline as pointer-sized integers */
+#define KEY(x) ((void *) (uintptr_t) (x))
+
+struct hg_test_bench {
+    uintptr_t *keys;   /* Present keys (even) */
+    uintptr_t *misses; /* Absent keys (odd) */
+    size_t *order;     /* Random lookup order */
+    size_t n_entries;
+    size_t n_lookups;
+};
+
+static unsigned int
+key_hash(void *key)
+{
+    uint64_t k = (uint64_t) (uintptr_t) key;
+
+    return (unsigned int) (k ^ (k >> 32));
+}
+
+static int
+key_equal(void *key1, void *key2)
+{
+    return key1 == key2;
+}
+
+static uint64_t
+splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static double
+mops(size_t n_ops, hg_time_t t1, hg_time_t t2)
+{
+    return (double) n_ops / (hg_time_to_double(hg_time_subtract(t2, t1)) * 1e6);
+}
+
+static int
+run_hash_table(struct hg_test_bench *bench, double *results)
+{
+    hg_hash_table_t *hash_table;
+    hg_time_t t1, t2;
+    size_t i, found = 0;
+
+    hash_table = hg_hash_table_new(key_hash, key_equal);
+    if (!hash_table)
+        return -1;
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_entries; i++)
+        if (!hg_hash_table_insert(
+                hash_table, KEY(bench->keys[i]), KEY(bench->keys[i])))
+            goto error;
+    hg_time_get_current(&t2);
+    results[0] = mops(bench->n_entries, t1, t2);
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_lookups; i++)
+        found += hg_hash_table_lookup(hash_table,
+                     KEY(bench->keys[bench->order[i]])) != NULL;
+    hg_time_get_current(&t2);
+    results[1] = mops(bench->n_lookups, t1, t2);
+    if (found != bench->n_lookups)
+        goto error;
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_lookups; i++)
+        found += hg_hash_table_lookup(hash_table,
+                     KEY(bench->misses[bench->order[i]])) != NULL;
+    hg_time_get_current(&t2);
+    results[2] = mops(bench->n_lookups, t1, t2);
+    if (found != bench->n_lookups)
+        goto error;
+
+    hg_hash_table_free(hash_table);
+    return 0;
+
+error:
+    hg_hash_table_free(hash_table);
+    return -1;
+}
+
+static int
+run_hash_map(struct hg_test_bench *bench, double *results)
+{
+    hg_hash_map_t *hash_map;
+    hg_time_t t1, t2;
+    size_t i, found = 0;
+
+    hash_map = hg_hash_map_new(key_hash, key_equal);
+    if (!hash_map)
+        return -1;
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_entries; i++)
+        if (!hg_hash_map_insert(
+                hash_map, KEY(bench->keys[i]), KEY(bench->keys[i])))
+            goto error;
+    hg_time_get_current(&t2);
+    results[0] = mops(bench->n_entries, t1, t2);
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_lookups; i++)
+        found += hg_hash_map_lookup(
+                     hash_map, KEY(bench->keys[bench->order[i]])) != NULL;
+    hg_time_get_current(&t2);
+    results[1] = mops(bench->n_lookups, t1, t2);
+    if (found != bench->n_lookups)
+        goto error;
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_lookups; i++)
+        found += hg_hash_map_lookup(hash_map,
+                     KEY(bench->misses[bench->order[i]])) != NULL;
+    hg_time_get_current(&t2);
+    results[2] = mops(bench->n_lookups, t1, t2);
+    if (found != bench->n_lookups)
+        goto error;
+
+    hg_hash_map_free(hash_map);
+    return 0;
+
+error:
+    hg_hash_map_free(hash_map);
+    return -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_bench bench;
+    size_t max_entries = HG_TEST_MAX_ENTRIES, i;
+    int ret = EXIT_SUCCESS;
+
+    if (argc > 1)
+        max_entries = (size_t) strtoul(argv[1], NULL, 10);
+
+    bench.keys = (uintptr_t *) malloc(max_entries * sizeof(uintptr_t));
+    bench.misses = (uintptr_t *) malloc(max_entries * sizeof(uintptr_t));
+    bench.order = (size_t *) malloc(
+        ((max_entries < HG_TEST_MIN_LOOKUPS) ? HG_TEST_MIN_LOOKUPS
+                                             : max_entries) *
+        sizeof(size_t));
+    if (!bench.keys || !bench.misses || !bench.order) {
+        fprintf(stderr, "Error: could not allocate keys\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < max_entries; i++) {
+        uintptr_t key = (uintptr_t) splitmix64(i);
+
+        bench.keys[i] = key & ~(uintptr_t) 1;
+        bench.misses[i] = key | 1;
+    }
+
+    printf("# Random pointer-sized keys, throughput in MOPS\n");
+    printf("%-10s %-8s %-12s %-12s %-12s\n", "# Entries", "Table", "insert",
+        "lookup-hit", "lookup-miss");
+    for (bench.n_entries = HG_TEST_MIN_ENTRIES; bench.n_entries <= max_entries;
+         bench.n_entries *= 10) {
+        double chained[3], open[3];
+
+        bench.n_lookups = (bench.n_entries < HG_TEST_MIN_LOOKUPS)
+                              ? HG_TEST_MIN_LOOKUPS
+                              : bench.n_entries;
+
+        /* Look up keys in an order unrelated to insertion order so that
+         * chained entries allocated back to back do not favor prefetching */
+        for (i = 0; i < bench.n_lookups; i++)
+            bench.order[i] = (size_t) (splitmix64(~i) % bench.n_entries);
+
+        if (run_hash_table(&bench, chained) < 0 ||
+            run_hash_map(&bench, open) < 0) {
+            fprintf(stderr, "Error: benchmark failed for %zu entries\n",
+                bench.n_entries);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        printf("%-10zu %-8s %-12.2f %-12.2f %-12.2f\n", bench.n_entries,
+            "chained", chained[0], chained[1], chained[2]);
+        printf("%-10zu %-8s %-12.2f %-12.2f %-12.2f\n", bench.n_entries,
+            "open", open[0], open[1], open[2]);
+    }
+
+done:
+    free(bench.keys);
+    free(bench.misses);
+    free(bench.order);
+    return ret;
+}
@@ -0,0 +1,164 @@
+#include "mercury_mpmc_queue.h"
+#include "mercury_thread.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HG_TEST_NUM_ENTRIES 10000 /* Spans several segments */
+#define HG_TEST_NUM_THREADS 4
+#define HG_TEST_BATCH_SIZE  16
+
+struct hg_test_args {
+    struct hg_mpmc_queue *queue;
+    int *entries;
+    hg_atomic_int32_t popped;
+    hg_atomic_int64_t sum;
+};
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_push(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_test_args *args = (struct hg_test_args *) arg;
+    int i;
+
+    for (i = 0; i < HG_TEST_NUM_ENTRIES; i++) {
+        if (hg_mpmc_queue_push(args->queue, &args->entries[i]) < 0) {
+            fprintf(stderr, "Error: could not push entry\n");
+            break;
+        }
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_pop(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_test_args *args = (struct hg_test_args *) arg;
+    void *entries[HG_TEST_BATCH_SIZE];
+
+    while (hg_atomic_get32(&args->popped) <
+           HG_TEST_NUM_ENTRIES * HG_TEST_NUM_THREADS) {
+        unsigned int count, i;
+
+        count =
+            hg_mpmc_queue_pop_batch(args->queue, entries, HG_TEST_BATCH_SIZE);
+        for (i = 0; i < count; i++) {
+            int *entry = (int *) entries[i];
+            hg_util_int64_t sum;
+
+            do {
+                sum = hg_atomic_get64(&args->sum);
+            } while (!hg_atomic_cas64(&args->sum, sum, sum + *entry));
+            hg_atomic_incr32(&args->popped);
+        }
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+int
+main(void)
+{
+    struct hg_test_args args;
+    hg_thread_t producers[HG_TEST_NUM_THREADS];
+    hg_thread_t consumers[HG_TEST_NUM_THREADS];
+    void *entries[HG_TEST_BATCH_SIZE];
+    hg_util_int64_t expected_sum = 0;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    args.entries = malloc(HG_TEST_NUM_ENTRIES * sizeof(int));
+    if (!args.entries) {
+        fprintf(stderr, "Error: could not allocate entries\n");
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < HG_TEST_NUM_ENTRIES; i++) {
+        args.entries[i] = i;
+        expected_sum += i;
+    }
+    expected_sum *= HG_TEST_NUM_THREADS;
+    hg_atomic_init32(&args.popped, 0);
+    hg_atomic_init64(&args.sum, 0);
+
+    args.queue = hg_mpmc_queue_alloc();
+    if (!args.queue) {
+        fprintf(stderr, "Error: could not allocate queue\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    if (hg_mpmc_queue_pop(args.queue) != NULL) {
+        fprintf(stderr, "Error: queue should be empty\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Single thread, entries must come out in FIFO order */
+    for (i = 0; i < HG_TEST_NUM_ENTRIES; i++)
+        hg_mpmc_queue_push(args.queue, &args.entries[i]);
+    if (hg_mpmc_queue_count(args.queue) != HG_TEST_NUM_ENTRIES) {
+        fprintf(stderr, "Error: expected %d entries, got %u\n",
+            HG_TEST_NUM_ENTRIES, hg_mpmc_queue_count(args.queue));
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < HG_TEST_NUM_ENTRIES;) {
+        unsigned int count, j;
+
+        count = hg_mpmc_queue_pop_batch(
+            args.queue, entries, (i % 2) ? 1 : HG_TEST_BATCH_SIZE);
+        if (count == 0) {
+            fprintf(stderr, "Error: queue should not be empty\n");
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        for (j = 0; j < count; j++, i++) {
+            if (*(int *) entries[j] != i) {
+                fprintf(stderr,
+                    "Error: values do not match, expected %d, got %d\n", i,
+                    *(int *) entries[j]);
+                ret = EXIT_FAILURE;
+                goto done;
+            }
+        }
+    }
+    if (!hg_mpmc_queue_is_empty(args.queue)) {
+        fprintf(stderr, "Error: queue should be empty\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Concurrent producers and consumers */
+    for (i = 0; i < HG_TEST_NUM_THREADS; i++) {
+        hg_thread_create(&producers[i], thread_cb_push, &args);
+        hg_thread_create(&consumers[i], thread_cb_pop, &args);
+    }
+    for (i = 0; i < HG_TEST_NUM_THREADS; i++) {
+        hg_thread_join(producers[i]);
+        hg_thread_join(consumers[i]);
+    }
+
+    if (hg_atomic_get64(&args.sum) != expected_sum) {
+        fprintf(stderr, "Error: sum does not match, expected %lld, got %lld\n",
+            (long long) expected_sum, (long long) hg_atomic_get64(&args.sum));
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (!hg_mpmc_queue_is_empty(args.queue)) {
+        fprintf(stderr, "Error: queue should be empty\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    hg_mpmc_queue_free(args.queue);
+    free(args.entries);
+    return ret;
+}
@@ -0,0 +1,130 @@
+#include "mercury_atomic_queue.h"
+#include "mercury_mpmc_queue.h"
+#include "mercury_thread.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HG_TEST_MAX_THREADS       64
+#define HG_TEST_OPS_PER_THREAD    100000
+#define HG_TEST_ATOMIC_QUEUE_SIZE 1024
+
+struct hg_test_bench {
+    struct hg_atomic_queue *atomic_queue;
+    struct hg_mpmc_queue *mpmc_queue;
+    hg_atomic_int32_t ready;
+    hg_atomic_int32_t go;
+    int n_ops;
+};
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_atomic_queue(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_test_bench *bench = (struct hg_test_bench *) arg;
+    int i;
+
+    hg_atomic_incr32(&bench->ready);
+    while (!hg_atomic_get32(&bench->go))
+        cpu_spinwait();
+
+    for (i = 0; i < bench->n_ops; i++) {
+        while (hg_atomic_queue_push(bench->atomic_queue, bench) < 0)
+            cpu_spinwait();
+        while (hg_atomic_queue_pop_mc(bench->atomic_queue) == NULL)
+            cpu_spinwait();
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_mpmc_queue(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_test_bench *bench = (struct hg_test_bench *) arg;
+    int i;
+
+    hg_atomic_incr32(&bench->ready);
+    while (!hg_atomic_get32(&bench->go))
+        cpu_spinwait();
+
+    for (i = 0; i < bench->n_ops; i++) {
+        while (hg_mpmc_queue_push(bench->mpmc_queue, bench) < 0)
+            cpu_spinwait();
+        while (hg_mpmc_queue_pop(bench->mpmc_queue) == NULL)
+            cpu_spinwait();
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static double
+run_bench(struct hg_test_bench *bench, hg_thread_func_t f, int n_threads)
+{
+    hg_thread_t threads[HG_TEST_MAX_THREADS];
+    hg_time_t t1, t2;
+    int i;
+
+    hg_atomic_init32(&bench->ready, 0);
+    hg_atomic_init32(&bench->go, 0);
+
+    for (i = 0; i < n_threads; i++)
+        hg_thread_create(&threads[i], f, bench);
+    while (hg_atomic_get32(&bench->ready) != n_threads)
+        cpu_spinwait();
+
+    hg_time_get_current(&t1);
+    hg_atomic_set32(&bench->go, 1);
+    for (i = 0; i < n_threads; i++)
+        hg_thread_join(threads[i]);
+    hg_time_get_current(&t2);
+
+    /* Push + pop per op */
+    return (2.0 * (double) bench->n_ops * (double) n_threads) /
+           (hg_time_to_double(hg_time_subtract(t2, t1)) * 1e6);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_bench bench;
+    int max_threads = HG_TEST_MAX_THREADS;
+    int ret = EXIT_SUCCESS;
+    int n_threads;
+
+    bench.n_ops = (argc > 1) ? atoi(argv[1]) : HG_TEST_OPS_PER_THREAD;
+    if (argc > 2) {
+        max_threads = atoi(argv[2]);
+        if (max_threads > HG_TEST_MAX_THREADS)
+            max_threads = HG_TEST_MAX_THREADS;
+    }
+
+    bench.atomic_queue = hg_atomic_queue_alloc(HG_TEST_ATOMIC_QUEUE_SIZE);
+    bench.mpmc_queue = hg_mpmc_queue_alloc();
+    if (!bench.atomic_queue || !bench.mpmc_queue) {
+        fprintf(stderr, "Error: could not allocate queues\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    printf("# %d push/pop pairs per thread, throughput in MOPS\n", bench.n_ops);
+    printf("%-10s %-15s %-15s\n", "# Threads", "atomic_queue", "mpmc_queue");
+    for (n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+        double atomic_mops =
+            run_bench(&bench, thread_cb_atomic_queue, n_threads);
+        double mpmc_mops = run_bench(&bench, thread_cb_mpmc_queue, n_threads);
+
+        printf("%-10d %-15.2f %-15.2f\n", n_threads, atomic_mops, mpmc_mops);
+    }
+
+done:
+    hg_atomic_queue_free(bench.atomic_queue);
+    hg_mpmc_queue_free(bench.mpmc_queue);
+    return ret;
+}
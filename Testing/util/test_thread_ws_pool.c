@@ -0,0 +1,90 @@
+#include "mercury_atomic.h"
+#include "mercury_thread_ws_pool.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define POOL_NUM_POSTS 256
+
+struct hg_test_work {
+    struct hg_thread_work work;  /* Work posted from main thread */
+    struct hg_thread_work child; /* Work posted from a worker */
+};
+
+static hg_thread_ws_pool_t *thread_pool;
+static hg_atomic_int32_t ncalls;
+static hg_atomic_int32_t nerrors;
+
+static HG_THREAD_RETURN_TYPE
+child_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    (void) args;
+
+    hg_atomic_incr32(&ncalls);
+
+    return ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+parent_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    struct hg_test_work *test_work = (struct hg_test_work *) args;
+
+    hg_atomic_incr32(&ncalls);
+
+    /* Post more work from within the pool */
+    test_work->child.func = child_func;
+    test_work->child.args = NULL;
+    if (hg_thread_ws_pool_post(thread_pool, &test_work->child) !=
+        HG_UTIL_SUCCESS)
+        hg_atomic_incr32(&nerrors);
+
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_work work[POOL_NUM_POSTS];
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    (void) argc;
+    (void) argv;
+    hg_atomic_init32(&ncalls, 0);
+    hg_atomic_init32(&nerrors, 0);
+
+    if (hg_thread_ws_pool_init(HG_TEST_NUM_THREADS_DEFAULT, &thread_pool) !=
+        HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Could not create thread pool\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < POOL_NUM_POSTS; i++) {
+        work[i].work.func = parent_func;
+        work[i].work.args = &work[i];
+        if (hg_thread_ws_pool_post(thread_pool, &work[i].work) !=
+            HG_UTIL_SUCCESS) {
+            fprintf(stderr, "Could not post work\n");
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    /* Pending work must be executed before destroy returns */
+    hg_thread_ws_pool_destroy(thread_pool);
+
+    if (hg_atomic_get32(&nerrors) != 0 ||
+        hg_atomic_get32(&ncalls) != 2 * POOL_NUM_POSTS) {
+        fprintf(stderr,
+            "Did not execute all the operations posted (%d/%d, %d errors)\n",
+            hg_atomic_get32(&ncalls), 2 * POOL_NUM_POSTS,
+            hg_atomic_get32(&nerrors));
+        ret = EXIT_FAILURE;
+    }
+
+    return ret;
+}
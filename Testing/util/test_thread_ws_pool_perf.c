@@ -0,0 +1,130 @@
+#include "mercury_atomic.h"
+#include "mercury_thread.h"
+#include "mercury_thread_pool.h"
+#include "mercury_thread_ws_pool.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HG_TEST_MAX_THREADS  32
+#define HG_TEST_OPS          200000
+#define HG_TEST_HANDLER_WORK 200
+
+struct hg_test_bench {
+    struct hg_thread_work *work;
+    hg_atomic_int32_t completed;
+    int n_ops;
+    int handler_work;
+};
+
+static HG_THREAD_RETURN_TYPE
+handler(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_test_bench *bench = (struct hg_test_bench *) arg;
+    volatile int sink = 0;
+    int i;
+
+    /* Emulate a short RPC handler */
+    for (i = 0; i < bench->handler_work; i++)
+        sink += i;
+
+    hg_atomic_incr32(&bench->completed);
+
+    return thread_ret;
+}
+
+static double
+run_bench_pool(struct hg_test_bench *bench, unsigned int n_threads)
+{
+    hg_thread_pool_t *pool;
+    hg_time_t t1, t2;
+    int i;
+
+    if (hg_thread_pool_init(n_threads, &pool) != HG_UTIL_SUCCESS)
+        return 0;
+    hg_atomic_init32(&bench->completed, 0);
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_ops; i++)
+        hg_thread_pool_post(pool, &bench->work[i]);
+    while (hg_atomic_get32(&bench->completed) != bench->n_ops)
+        hg_thread_yield();
+    hg_time_get_current(&t2);
+
+    hg_thread_pool_destroy(pool);
+
+    return (double) bench->n_ops /
+           (hg_time_to_double(hg_time_subtract(t2, t1)) * 1e6);
+}
+
+static double
+run_bench_ws_pool(struct hg_test_bench *bench, unsigned int n_threads)
+{
+    hg_thread_ws_pool_t *pool;
+    hg_time_t t1, t2;
+    int i;
+
+    if (hg_thread_ws_pool_init(n_threads, &pool) != HG_UTIL_SUCCESS)
+        return 0;
+    hg_atomic_init32(&bench->completed, 0);
+
+    hg_time_get_current(&t1);
+    for (i = 0; i < bench->n_ops; i++)
+        hg_thread_ws_pool_post(pool, &bench->work[i]);
+    while (hg_atomic_get32(&bench->completed) != bench->n_ops)
+        hg_thread_yield();
+    hg_time_get_current(&t2);
+
+    hg_thread_ws_pool_destroy(pool);
+
+    return (double) bench->n_ops /
+           (hg_time_to_double(hg_time_subtract(t2, t1)) * 1e6);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_bench bench;
+    unsigned int max_threads = HG_TEST_MAX_THREADS;
+    unsigned int n_threads;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    bench.n_ops = (argc > 1) ? atoi(argv[1]) : HG_TEST_OPS;
+    bench.handler_work = (argc > 2) ? atoi(argv[2]) : HG_TEST_HANDLER_WORK;
+    if (argc > 3) {
+        max_threads = (unsigned int) atoi(argv[3]);
+        if (max_threads > HG_TEST_MAX_THREADS)
+            max_threads = HG_TEST_MAX_THREADS;
+    }
+
+    bench.work = (struct hg_thread_work *) malloc(
+        (size_t) bench.n_ops * sizeof(struct hg_thread_work));
+    if (!bench.work) {
+        fprintf(stderr, "Error: could not allocate work\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < bench.n_ops; i++) {
+        bench.work[i].func = handler;
+        bench.work[i].args = &bench;
+    }
+
+    printf("# %d handlers (%d loop iterations each), throughput in MOPS\n",
+        bench.n_ops, bench.handler_work);
+    printf("%-10s %-15s %-15s\n", "# Workers", "thread_pool", "thread_ws_pool");
+    for (n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+        double pool_mops = run_bench_pool(&bench, n_threads);
+        double ws_pool_mops = run_bench_ws_pool(&bench, n_threads);
+
+        printf("%-10u %-15.2f %-15.2f\n", n_threads, pool_mops, ws_pool_mops);
+    }
+
+done:
+    free(bench.work);
+    return ret;
+}
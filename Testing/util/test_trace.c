@@ -0,0 +1,174 @@
+#include "mercury_thread.h"
+#include "mercury_time.h"
+#include "mercury_trace.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_THREADS     4
+#define NUM_EVENTS      1000
+#define BUFFER_SIZE     1024
+#define NUM_EVENTS_PERF 1000000
+#define TRACE_FILE      "hg_test_trace.bin"
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_record(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    hg_util_uint64_t id = *(hg_util_uint64_t *) arg;
+    unsigned int i;
+
+    for (i = 0; i < NUM_EVENTS; i++)
+        HG_TRACE((hg_trace_type_t) (i % HG_TRACE_TYPE_MAX), id, i);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+/* Read dump back and check that each thread buffer contains the expected
+ * events in order */
+static int
+check_dump(const char *path, unsigned int n_buffers, unsigned int n_events,
+    hg_util_uint64_t lost_events)
+{
+    struct hg_trace_file_header header;
+    struct hg_trace_event *events = NULL;
+    FILE *file = NULL;
+    unsigned int i;
+    int ret = EXIT_SUCCESS;
+
+    events = (struct hg_trace_event *) malloc(
+        n_events * sizeof(struct hg_trace_event));
+    file = fopen(path, "rb");
+    if (events == NULL || file == NULL) {
+        fprintf(stderr, "Error: could not open dump\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, HG_TRACE_MAGIC, sizeof(HG_TRACE_MAGIC)) != 0 ||
+        header.version != HG_TRACE_VERSION ||
+        header.n_buffers != n_buffers || header.lost_events != lost_events) {
+        fprintf(stderr,
+            "Error: invalid header (%u buffers, %llu lost events)\n",
+            header.n_buffers, (unsigned long long) header.lost_events);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    for (i = 0; i < n_buffers; i++) {
+        struct hg_trace_buffer_header buffer_header;
+        hg_util_uint64_t j, first;
+
+        if (fread(&buffer_header, sizeof(buffer_header), 1, file) != 1 ||
+            buffer_header.n_events != n_events ||
+            fread(events, sizeof(struct hg_trace_event), n_events, file) !=
+                n_events) {
+            fprintf(stderr, "Error: invalid buffer %u\n", i);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+
+        /* Only the most recent events are kept */
+        first = events[0].arg;
+        for (j = 0; j < n_events; j++) {
+            if (events[j].arg != first + j ||
+                events[j].type != (first + j) % HG_TRACE_TYPE_MAX ||
+                events[j].id != events[0].id ||
+                (j > 0 && events[j].time < events[j - 1].time)) {
+                fprintf(stderr, "Error: invalid event %llu of buffer %u\n",
+                    (unsigned long long) j, i);
+                ret = EXIT_FAILURE;
+                goto done;
+            }
+        }
+    }
+
+done:
+    if (file != NULL)
+        fclose(file);
+    free(events);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    hg_thread_t threads[NUM_THREADS];
+    hg_util_uint64_t ids[NUM_THREADS];
+    hg_time_t t1, t2;
+    unsigned int i;
+    int ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    /* Nothing is recorded while disabled */
+    HG_TRACE(HG_TRACE_CORE_CREATE, 0, 0);
+    if (HG_TRACE_ENABLED()) {
+        fprintf(stderr, "Error: tracing enabled by default\n");
+        return EXIT_FAILURE;
+    }
+
+    if (hg_trace_enable(1) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not enable tracing\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Threads record more events than buffers can hold */
+    hg_trace_set_buffer_size(NUM_EVENTS / 2);
+    for (i = 0; i < NUM_THREADS; i++) {
+        ids[i] = hg_trace_id_gen();
+        if (ids[i] == 0 || (i > 0 && ids[i] == ids[i - 1])) {
+            fprintf(stderr, "Error: invalid correlation ID\n");
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        hg_thread_create(&threads[i], thread_cb_record, &ids[i]);
+    }
+    for (i = 0; i < NUM_THREADS; i++)
+        hg_thread_join(threads[i]);
+
+    /* Buffer size is rounded up to the next power of 2, the oldest slot is
+     * never dumped as it could be in the process of being overwritten */
+    if (hg_trace_dump(TRACE_FILE) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not dump trace\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    ret = check_dump(TRACE_FILE, NUM_THREADS, 511,
+        (hg_util_uint64_t) NUM_THREADS * (NUM_EVENTS - 511));
+    if (ret != EXIT_SUCCESS)
+        goto done;
+    hg_trace_finalize();
+
+    /* Measure recording cost */
+    hg_trace_enable(1);
+    hg_trace_set_buffer_size(BUFFER_SIZE);
+    hg_time_get_current(&t1);
+    for (i = 0; i < NUM_EVENTS_PERF; i++)
+        HG_TRACE((hg_trace_type_t) (i % HG_TRACE_TYPE_MAX), 1, i);
+    hg_time_get_current(&t2);
+    printf("Recorded %d events, %.1f ns per event\n", NUM_EVENTS_PERF,
+        hg_time_to_double(hg_time_subtract(t2, t1)) * 1e9 / NUM_EVENTS_PERF);
+
+    /* Disabled tracing does not record events */
+    hg_trace_enable(0);
+    HG_TRACE(HG_TRACE_CORE_FORWARD, 0, 0);
+    if (hg_trace_dump(TRACE_FILE) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not dump trace\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    ret = check_dump(TRACE_FILE, 1, BUFFER_SIZE - 1,
+        (hg_util_uint64_t) NUM_EVENTS_PERF - BUFFER_SIZE + 1);
+
+done:
+    hg_trace_finalize();
+    remove(TRACE_FILE);
+    return ret;
+}
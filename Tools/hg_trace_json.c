@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Convert trace dumps written by hg_trace_dump() (e.g. through HG_TRACE_FILE)
+ * to the Chrome trace event JSON format, which can be loaded in Perfetto or
+ * chrome://tracing. Dumps of several processes can be merged into one trace,
+ * events are then placed on a common time line, which is only meaningful if
+ * processes ran on the same node. Each event is shown as an instant event and
+ * events that share a correlation ID are grouped into an async span per
+ * process (RPC or bulk transfer). */
+
+#include "mercury_hash_map.h"
+#include "mercury_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define USAGE "Usage: %s [-o <output.json>] <trace file> [<trace file> ...]\n"
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Events of one thread */
+struct hg_trace_json_buffer {
+    struct hg_trace_buffer_header header;
+    struct hg_trace_event *events;
+};
+
+/* Content of one dump */
+struct hg_trace_json_file {
+    struct hg_trace_file_header header;
+    struct hg_trace_json_buffer *buffers;
+};
+
+/* Span of events sharing a correlation ID */
+struct hg_trace_json_span {
+    hg_util_uint64_t id; /* Correlation ID (key) */
+    hg_util_uint64_t first;
+    hg_util_uint64_t last;
+    hg_util_uint64_t tid;
+    hg_trace_type_t type; /* Type of first event */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static unsigned int
+hg_trace_json_id_hash(hg_hash_map_key_t key);
+
+static int
+hg_trace_json_id_equal(hg_hash_map_key_t key1, hg_hash_map_key_t key2);
+
+static int
+hg_trace_json_read(const char *path, struct hg_trace_json_file *file);
+
+static void
+hg_trace_json_free(struct hg_trace_json_file *file);
+
+static int
+hg_trace_json_write(FILE *out, struct hg_trace_json_file *file,
+    hg_util_uint64_t time_base, int *first_record);
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+hg_trace_json_id_hash(hg_hash_map_key_t key)
+{
+    hg_util_uint64_t id = *(hg_util_uint64_t *) key;
+
+    return (unsigned int) (id ^ (id >> 32));
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_trace_json_id_equal(hg_hash_map_key_t key1, hg_hash_map_key_t key2)
+{
+    return *(hg_util_uint64_t *) key1 == *(hg_util_uint64_t *) key2;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_trace_json_read(const char *path, struct hg_trace_json_file *file)
+{
+    FILE *stream = NULL;
+    hg_util_uint32_t i;
+    int ret = EXIT_SUCCESS;
+
+    memset(file, 0, sizeof(*file));
+
+    stream = fopen(path, "rb");
+    if (stream == NULL) {
+        fprintf(stderr, "Error: could not open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (fread(&file->header, sizeof(file->header), 1, stream) != 1 ||
+        memcmp(file->header.magic, HG_TRACE_MAGIC, sizeof(HG_TRACE_MAGIC)) !=
+            0) {
+        fprintf(stderr, "Error: %s is not a trace file\n", path);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (file->header.version != HG_TRACE_VERSION) {
+        fprintf(stderr, "Error: %s has unsupported version %u\n", path,
+            file->header.version);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    file->buffers = (struct hg_trace_json_buffer *) calloc(
+        file->header.n_buffers, sizeof(struct hg_trace_json_buffer));
+    if (file->buffers == NULL && file->header.n_buffers > 0) {
+        fprintf(stderr, "Error: could not allocate buffers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    for (i = 0; i < file->header.n_buffers; i++) {
+        struct hg_trace_json_buffer *buffer = &file->buffers[i];
+        size_t n_events;
+
+        if (fread(&buffer->header, sizeof(buffer->header), 1, stream) != 1) {
+            fprintf(stderr, "Error: %s is truncated\n", path);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        n_events = (size_t) buffer->header.n_events;
+        if (n_events == 0)
+            continue;
+
+        buffer->events = (struct hg_trace_event *) malloc(
+            n_events * sizeof(struct hg_trace_event));
+        if (buffer->events == NULL) {
+            fprintf(stderr, "Error: could not allocate events\n");
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        if (fread(buffer->events, sizeof(struct hg_trace_event), n_events,
+                stream) != n_events) {
+            fprintf(stderr, "Error: %s is truncated\n", path);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+done:
+    fclose(stream);
+    if (ret != EXIT_SUCCESS)
+        hg_trace_json_free(file);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_trace_json_free(struct hg_trace_json_file *file)
+{
+    hg_util_uint32_t i;
+
+    if (file->buffers == NULL)
+        return;
+
+    for (i = 0; i < file->header.n_buffers; i++)
+        free(file->buffers[i].events);
+    free(file->buffers);
+    file->buffers = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_trace_json_write(FILE *out, struct hg_trace_json_file *file,
+    hg_util_uint64_t time_base, int *first_record)
+{
+    hg_util_uint64_t pid = file->header.pid;
+    hg_hash_map_t *spans = NULL;
+    hg_hash_map_iter_t iter;
+    hg_util_uint32_t i;
+    int ret = EXIT_SUCCESS;
+
+    spans = hg_hash_map_new(hg_trace_json_id_hash, hg_trace_json_id_equal);
+    if (spans == NULL) {
+        fprintf(stderr, "Error: could not create span map\n");
+        return EXIT_FAILURE;
+    }
+    hg_hash_map_register_free_functions(spans, NULL, free);
+
+    fprintf(out,
+        "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%llu,"
+        "\"args\":{\"name\":\"mercury %llu\"}}",
+        *first_record ? "" : ",\n", (unsigned long long) pid,
+        (unsigned long long) pid);
+    *first_record = 0;
+
+    for (i = 0; i < file->header.n_buffers; i++) {
+        struct hg_trace_json_buffer *buffer = &file->buffers[i];
+        hg_util_uint64_t j;
+
+        fprintf(out,
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%llu,"
+            "\"tid\":%llu,\"args\":{\"name\":\"thread %llu\"}}",
+            (unsigned long long) pid, (unsigned long long) buffer->header.tid,
+            (unsigned long long) buffer->header.tid);
+
+        for (j = 0; j < buffer->header.n_events; j++) {
+            struct hg_trace_event *event = &buffer->events[j];
+            const char *name =
+                hg_trace_type_name((hg_trace_type_t) event->type);
+            struct hg_trace_json_span *span;
+
+            if (name == NULL)
+                continue;
+
+            fprintf(out,
+                ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                "\"ts\":%.3f,\"pid\":%llu,\"tid\":%llu,"
+                "\"args\":{\"id\":\"0x%llx\",\"arg\":%llu}}",
+                name, (event->type >= HG_TRACE_NA_SEND) ? "na" : "hg",
+                (double) (event->time - time_base) / 1000.0,
+                (unsigned long long) pid,
+                (unsigned long long) buffer->header.tid,
+                (unsigned long long) event->id,
+                (unsigned long long) event->arg);
+
+            /* NA events are correlated by callback argument, which is reused
+             * across operations, so only HG events form spans */
+            if (event->id == 0 || event->type >= HG_TRACE_NA_SEND)
+                continue;
+
+            span = (struct hg_trace_json_span *) hg_hash_map_lookup(
+                spans, &event->id);
+            if (span == NULL) {
+                span = (struct hg_trace_json_span *) malloc(sizeof(*span));
+                if (span == NULL) {
+                    fprintf(stderr, "Error: could not allocate span\n");
+                    ret = EXIT_FAILURE;
+                    goto done;
+                }
+                span->id = event->id;
+                span->first = span->last = event->time;
+                span->tid = buffer->header.tid;
+                span->type = (hg_trace_type_t) event->type;
+                if (!hg_hash_map_insert(spans, &span->id, span)) {
+                    fprintf(stderr, "Error: could not insert span\n");
+                    free(span);
+                    ret = EXIT_FAILURE;
+                    goto done;
+                }
+            } else if (event->time < span->first) {
+                span->first = event->time;
+                span->tid = buffer->header.tid;
+                span->type = (hg_trace_type_t) event->type;
+            } else if (event->time > span->last)
+                span->last = event->time;
+        }
+    }
+
+    /* Spans are bound to the process, origin and target of an RPC show up
+     * as two spans with the same ID */
+    hg_hash_map_iterate(spans, &iter);
+    while (hg_hash_map_iter_has_more(&iter)) {
+        struct hg_trace_json_span *span =
+            (struct hg_trace_json_span *) hg_hash_map_iter_next(&iter);
+        const char *cat =
+            (span->type >= HG_TRACE_BULK_TRANSFER) ? "bulk" : "rpc";
+
+        fprintf(out,
+            ",\n{\"name\":\"%s 0x%llx\",\"cat\":\"%s\",\"ph\":\"b\","
+            "\"id\":\"0x%llx\",\"ts\":%.3f,\"pid\":%llu,\"tid\":%llu},"
+            "\n{\"name\":\"%s 0x%llx\",\"cat\":\"%s\",\"ph\":\"e\","
+            "\"id\":\"0x%llx\",\"ts\":%.3f,\"pid\":%llu,\"tid\":%llu}",
+            cat, (unsigned long long) span->id, cat,
+            (unsigned long long) span->id,
+            (double) (span->first - time_base) / 1000.0,
+            (unsigned long long) pid, (unsigned long long) span->tid, cat,
+            (unsigned long long) span->id, cat, (unsigned long long) span->id,
+            (double) (span->last - time_base) / 1000.0,
+            (unsigned long long) pid, (unsigned long long) span->tid);
+    }
+
+done:
+    hg_hash_map_free(spans);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_trace_json_file *files = NULL;
+    hg_util_uint64_t time_base = (hg_util_uint64_t) -1, lost_events = 0;
+    const char *output = NULL;
+    FILE *out = stdout;
+    int first_record = 1, n_files, i, arg = 1;
+    int ret = EXIT_SUCCESS;
+
+    if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+        output = argv[2];
+        arg = 3;
+    }
+    n_files = argc - arg;
+    if (n_files <= 0) {
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    files = (struct hg_trace_json_file *) calloc(
+        (size_t) n_files, sizeof(struct hg_trace_json_file));
+    if (files == NULL) {
+        fprintf(stderr, "Error: could not allocate files\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Load all dumps first to place events on a common time line */
+    for (i = 0; i < n_files; i++) {
+        hg_util_uint32_t j;
+
+        ret = hg_trace_json_read(argv[arg + i], &files[i]);
+        if (ret != EXIT_SUCCESS)
+            goto done;
+        lost_events += files[i].header.lost_events;
+
+        for (j = 0; j < files[i].header.n_buffers; j++)
+            if (files[i].buffers[j].header.n_events > 0 &&
+                files[i].buffers[j].events[0].time < time_base)
+                time_base = files[i].buffers[j].events[0].time;
+    }
+    if (lost_events > 0)
+        fprintf(stderr,
+            "Warning: %llu event(s) were overwritten before being dumped, "
+            "consider increasing the buffer size\n",
+            (unsigned long long) lost_events);
+
+    if (output) {
+        out = fopen(output, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Error: could not open %s\n", output);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (i = 0; i < n_files; i++) {
+        ret = hg_trace_json_write(out, &files[i], time_base, &first_record);
+        if (ret != EXIT_SUCCESS)
+            goto done;
+    }
+    fprintf(out, "\n]}\n");
+
+done:
+    if (out != stdout && out != NULL && fclose(out) != 0)
+        ret = EXIT_FAILURE;
+    for (i = 0; i < n_files; i++)
+        hg_trace_json_free(&files[i]);
+    free(files);
+
+    return ret;
+}
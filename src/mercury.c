@@ -11,12 +11,15 @@
 #include "mercury.h"
 #include "mercury_bulk.h"
 #include "mercury_error.h"
+#include "mercury_private.h"
 #include "mercury_proc.h"
 #include "mercury_proc_bulk.h"
 
+#include "mercury_atomic.h"
 #include "mercury_hash_string.h"
 #include "mercury_mem.h"
 #include "mercury_thread_spin.h"
+#include "mercury_thread_ws_pool.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -28,6 +31,14 @@
 
 #define HG_POST_LIMIT_DEFAULT 256
 
+/* Chunk size of the arena that input is decoded into */
+#define HG_INPUT_ARENA_CHUNK_SIZE 4096
+
+/* States of the encoded size pass of a proc (see hg_set_struct()) */
+#define HG_PROC_PRESIZE_OFF         0 /* Parameters fit, no size pass */
+#define HG_PROC_PRESIZE_ON          1 /* Compute size before encoding */
+#define HG_PROC_PRESIZE_UNSUPPORTED 2 /* Proc does not support HG_SIZE */
+
 #define HG_CONTEXT_CLASS(context)                                              \
     ((struct hg_private_class *) (context->hg_class))
 
@@ -40,6 +51,8 @@ struct hg_private_class {
     struct hg_class hg_class; /* Must remain as first field */
     hg_return_t (*handle_create)(hg_handle_t, void *); /* handle_create */
     void *handle_create_arg;                           /* handle_create arg */
+    hg_thread_ws_pool_t *dispatch_pool;                /* RPC dispatch pool */
+    unsigned int bulk_op_pool_size;                    /* Bulk op pool size */
     hg_thread_spin_t register_lock;                    /* Register lock */
 };
 
@@ -50,7 +63,11 @@ struct hg_proc_info {
     hg_proc_cb_t out_proc_cb;      /* Output proc callback */
     void *data;                    /* User data */
     void (*free_callback)(void *); /* User data free callback */
+    hg_atomic_int32_t in_presize;  /* Input size pass state */
+    hg_atomic_int32_t out_presize; /* Output size pass state */
     hg_bool_t no_response;         /* RPC response not expected */
+    hg_bool_t dispatch;            /* Execute RPC callback in dispatch pool */
+    hg_bool_t size_pass;           /* Procs support HG_SIZE */
 };
 
 /* HG handle */
@@ -61,16 +78,20 @@ struct hg_private_handle {
     hg_cb_t respond_cb;         /* Respond callback */
     hg_return_t (*extra_bulk_transfer_cb)(
         hg_core_handle_t);        /* Bulk transfer callback */
-    void *forward_arg;            /* Forward callback args */
-    void *respond_arg;            /* Respond callback args */
-    void *in_extra_buf;           /* Extra input buffer */
-    void *out_extra_buf;          /* Extra output buffer */
-    hg_proc_t in_proc;            /* Proc for input */
-    hg_proc_t out_proc;           /* Proc for output */
-    hg_bulk_t in_extra_bulk;      /* Extra input bulk handle */
-    hg_bulk_t out_extra_bulk;     /* Extra output bulk handle */
-    hg_size_t in_extra_buf_size;  /* Extra input buffer size */
-    hg_size_t out_extra_buf_size; /* Extra output buffer size */
+    void *forward_arg;                   /* Forward callback args */
+    void *respond_arg;                   /* Respond callback args */
+    void *in_extra_buf;                  /* Extra input buffer */
+    void *out_extra_buf;                 /* Extra output buffer */
+    hg_proc_t in_proc;                   /* Proc for input */
+    hg_proc_t out_proc;                  /* Proc for output */
+    hg_bulk_t in_extra_bulk;             /* Extra input bulk handle */
+    hg_bulk_t out_extra_bulk;            /* Extra output bulk handle */
+    hg_bulk_t in_user_bulk;              /* User extra input bulk handle */
+    hg_bulk_t out_user_bulk;             /* User extra output bulk handle */
+    hg_size_t in_extra_buf_size;         /* Extra input buffer size */
+    hg_size_t out_extra_buf_size;        /* Extra output buffer size */
+    unsigned int in_arena_refs;          /* Decoded inputs using arena */
+    struct hg_thread_work dispatch_work; /* Work for dispatch pool */
 };
 
 /* HG op id */
@@ -116,6 +137,12 @@ hg_handle_free(void *arg);
 static hg_return_t
 hg_handle_create_cb(hg_core_handle_t core_handle, void *arg);
 
+/**
+ * Recycle handle callback.
+ */
+static void
+hg_handle_recycle_cb(hg_core_handle_t core_handle, void *arg);
+
 /**
  * More data callback.
  */
@@ -135,6 +162,12 @@ hg_more_data_free_cb(hg_core_handle_t core_handle);
 static HG_INLINE hg_return_t
 hg_core_rpc_cb(hg_core_handle_t core_handle);
 
+/**
+ * Execute RPC callback from dispatch pool.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_dispatch_rpc_cb(void *arg);
+
 /**
  * Core lookup callback.
  */
@@ -142,26 +175,30 @@ static HG_INLINE hg_return_t
 hg_core_addr_lookup_cb(const struct hg_core_cb_info *callback_info);
 
 /**
- * Decode and get input/output structure.
+ * Decode and get input/output structure. If prefix_cb is not NULL, it is used
+ * in place of the registered proc to only decode leading fields.
  */
 static hg_return_t
 hg_get_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr);
+    const struct hg_proc_info *hg_proc_info, hg_op_t op,
+    hg_proc_cb_t prefix_cb, void *struct_ptr);
 
 /**
  * Set and encode input/output structure.
  */
 static hg_return_t
 hg_set_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr,
+    struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr,
     hg_size_t *payload_size, hg_bool_t *more_data);
 
 /**
- * Free allocated members from input/output structure.
+ * Free allocated members from input/output structure. prefix_cb must be the
+ * same as the one passed to hg_get_struct().
  */
 static hg_return_t
 hg_free_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr);
+    const struct hg_proc_info *hg_proc_info, hg_op_t op,
+    hg_proc_cb_t prefix_cb, void *struct_ptr);
 
 /**
  * Get extra user payload using bulk transfer.
@@ -244,6 +281,11 @@ hg_handle_create(struct hg_private_class *hg_class)
         hg_proc_create((hg_class_t *) hg_class, HG_CRC32, &hg_handle->in_proc);
     HG_CHECK_HG_ERROR(error, ret, "Cannot create HG proc");
 
+    /* Input is decoded into an arena that is reused by the handle, chunks are
+     * only allocated once input procs allocate memory */
+    ret = hg_proc_set_arena(hg_handle->in_proc, HG_INPUT_ARENA_CHUNK_SIZE);
+    HG_CHECK_HG_ERROR(error, ret, "Cannot set HG proc arena");
+
     ret =
         hg_proc_create((hg_class_t *) hg_class, HG_CRC32, &hg_handle->out_proc);
     HG_CHECK_HG_ERROR(error, ret, "Cannot create HG proc");
@@ -266,6 +308,8 @@ hg_handle_free(void *arg)
 
     if (hg_handle->handle.data_free_callback)
         hg_handle->handle.data_free_callback(hg_handle->handle.data);
+    HG_Bulk_free(hg_handle->in_user_bulk);
+    HG_Bulk_free(hg_handle->out_user_bulk);
     if (hg_handle->in_proc != HG_PROC_NULL)
         hg_proc_free(hg_handle->in_proc);
     if (hg_handle->out_proc != HG_PROC_NULL)
@@ -282,28 +326,63 @@ hg_handle_create_cb(hg_core_handle_t core_handle, void *arg)
     struct hg_private_handle *hg_handle;
     hg_return_t ret = HG_SUCCESS;
 
-    hg_handle = hg_handle_create(HG_CONTEXT_CLASS(hg_context));
-    HG_CHECK_ERROR(
-        hg_handle == NULL, error, ret, HG_NOMEM, "Could not create HG handle");
+    /* Private data is kept when core handle is recycled from pool */
+    hg_handle = (struct hg_private_handle *) HG_Core_get_data(core_handle);
+    if (!hg_handle) {
+        hg_handle = hg_handle_create(HG_CONTEXT_CLASS(hg_context));
+        HG_CHECK_ERROR(hg_handle == NULL, done, ret, HG_NOMEM,
+            "Could not create HG handle");
 
-    hg_handle->handle.core_handle = core_handle;
-    hg_handle->handle.info.context = hg_context;
+        hg_handle->handle.core_handle = core_handle;
 
-    HG_Core_set_data(core_handle, hg_handle, hg_handle_free);
+        /* Private data is now released along with core handle */
+        HG_Core_set_data(core_handle, hg_handle, hg_handle_free);
+    }
+    hg_handle->handle.info.context = hg_context;
 
     /* Call handle create if defined */
     if (HG_CONTEXT_CLASS(hg_context)->handle_create) {
         ret = HG_CONTEXT_CLASS(hg_context)
                   ->handle_create((hg_handle_t) hg_handle,
                       HG_CONTEXT_CLASS(hg_context)->handle_create_arg);
-        HG_CHECK_HG_ERROR(error, ret, "Error in handle create callback");
+        HG_CHECK_HG_ERROR(done, ret, "Error in handle create callback");
     }
 
+done:
     return ret;
+}
 
-error:
-    hg_handle_free(hg_handle);
-    return ret;
+/*---------------------------------------------------------------------------*/
+static void
+hg_handle_recycle_cb(hg_core_handle_t core_handle, void *arg)
+{
+    struct hg_private_handle *hg_handle =
+        (struct hg_private_handle *) HG_Core_get_data(core_handle);
+
+    (void) arg;
+
+    if (!hg_handle)
+        return;
+
+    /* Free user data, procs and header are kept for re-use */
+    if (hg_handle->handle.data_free_callback)
+        hg_handle->handle.data_free_callback(hg_handle->handle.data);
+    hg_handle->handle.data = NULL;
+    hg_handle->handle.data_free_callback = NULL;
+
+    hg_handle->handle.info.addr = HG_ADDR_NULL;
+    hg_handle->handle.info.id = 0;
+    hg_handle->handle.info.context_id = 0;
+    hg_handle->forward_cb = NULL;
+    hg_handle->forward_arg = NULL;
+    hg_handle->respond_cb = NULL;
+    hg_handle->respond_arg = NULL;
+    hg_handle->extra_bulk_transfer_cb = NULL;
+    HG_Bulk_free(hg_handle->in_user_bulk);
+    hg_handle->in_user_bulk = HG_BULK_NULL;
+    HG_Bulk_free(hg_handle->out_user_bulk);
+    hg_handle->out_user_bulk = HG_BULK_NULL;
+    hg_header_reset(&hg_handle->hg_header, HG_UNDEF);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -378,6 +457,22 @@ hg_core_rpc_cb(hg_core_handle_t core_handle)
     HG_CHECK_ERROR(hg_proc_info->rpc_cb == NULL, error, ret, HG_INVALID_ARG,
         "No RPC callback registered");
 
+    if (hg_proc_info->dispatch) {
+        struct hg_private_class *private_class =
+            (struct hg_private_class *) hg_handle->handle.info.hg_class;
+
+        /* Hand off RPC callback to pool, handle refcount was already
+         * incremented by HG core so that it remains valid until responded */
+        if (private_class->dispatch_pool) {
+            hg_handle->dispatch_work.func = hg_dispatch_rpc_cb;
+            hg_handle->dispatch_work.args = hg_handle;
+            if (hg_thread_ws_pool_post(private_class->dispatch_pool,
+                    &hg_handle->dispatch_work) == HG_UTIL_SUCCESS)
+                return ret;
+        }
+        /* Fallback to inline execution */
+    }
+
     ret = hg_proc_info->rpc_cb((hg_handle_t) hg_handle);
 
     return ret;
@@ -389,6 +484,31 @@ error:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_dispatch_rpc_cb(void *arg)
+{
+    struct hg_private_handle *hg_handle = (struct hg_private_handle *) arg;
+    const struct hg_proc_info *hg_proc_info =
+        (const struct hg_proc_info *) HG_Core_get_rpc_data(
+            hg_handle->handle.core_handle);
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    hg_return_t ret;
+
+    ret = hg_proc_info->rpc_cb((hg_handle_t) hg_handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Error while executing RPC callback (%s)",
+            HG_Error_to_string(ret));
+
+        /* Respond in case of error, as done for inline RPC callbacks */
+        ret = hg_core_respond_error(hg_handle->handle.core_handle, ret);
+        HG_CHECK_HG_ERROR(done, ret, "Could not respond");
+    }
+
+done:
+    return thread_ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_return_t
 hg_core_addr_lookup_cb(const struct hg_core_cb_info *callback_info)
@@ -412,7 +532,8 @@ hg_core_addr_lookup_cb(const struct hg_core_cb_info *callback_info)
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_get_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr)
+    const struct hg_proc_info *hg_proc_info, hg_op_t op,
+    hg_proc_cb_t prefix_cb, void *struct_ptr)
 {
     hg_proc_t proc = HG_PROC_NULL;
     hg_proc_cb_t proc_cb = NULL;
@@ -468,6 +589,8 @@ hg_get_struct(struct hg_private_handle *hg_handle,
         default:
             HG_GOTO_ERROR(done, ret, HG_INVALID_ARG, "Invalid HG op");
     }
+    if (prefix_cb)
+        proc_cb = prefix_cb;
     HG_CHECK_ERROR(proc_cb == NULL, done, ret, HG_FAULT,
         "No proc set, proc must be set in HG_Register()");
 
@@ -497,20 +620,26 @@ hg_get_struct(struct hg_private_handle *hg_handle,
     ret = proc_cb(proc, struct_ptr);
     HG_CHECK_HG_ERROR(done, ret, "Could not decode parameters");
 
-    /* Flush proc */
-    ret = hg_proc_flush(proc);
-    HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
+    /* Checksum covers the whole payload and cannot be verified if only a
+     * prefix was decoded */
+    if (!prefix_cb) {
+        /* Flush proc */
+        ret = hg_proc_flush(proc);
+        HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
 
 #ifdef HG_HAS_CHECKSUMS
-    /* Compare checksum with header hash */
-    ret = hg_proc_checksum_verify(
-        proc, &hg_header_hash->payload, sizeof(hg_header_hash->payload));
-    HG_CHECK_HG_ERROR(done, ret, "Error in proc checksum verify");
+        /* Compare checksum with header hash */
+        ret = hg_proc_checksum_verify(
+            proc, &hg_header_hash->payload, sizeof(hg_header_hash->payload));
+        HG_CHECK_HG_ERROR(done, ret, "Error in proc checksum verify");
 #endif
+    }
 
     /* Increment ref count on handle so that it remains valid until free_struct
      * is called */
     HG_Core_ref_incr(hg_handle->handle.core_handle);
+    if (op == HG_INPUT)
+        hg_handle->in_arena_refs++;
 
 done:
     return ret;
@@ -519,19 +648,22 @@ done:
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_set_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr,
+    struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr,
     hg_size_t *payload_size, hg_bool_t *more_data)
 {
     hg_proc_t proc = HG_PROC_NULL;
     hg_proc_cb_t proc_cb = NULL;
     void *buf, **extra_buf;
     hg_size_t buf_size, *extra_buf_size;
-    hg_bulk_t *extra_bulk;
+    hg_bulk_t *extra_bulk, user_bulk;
+    void *user_buf = NULL;
     struct hg_header *hg_header = &hg_handle->hg_header;
 #ifdef HG_HAS_CHECKSUMS
     struct hg_header_hash *hg_header_hash = NULL;
 #endif
     hg_size_t header_offset = hg_header_get_size(op);
+    hg_atomic_int32_t *presize;
+    hg_size_t encoded_size = 0;
     hg_return_t ret = HG_SUCCESS;
 
     switch (op) {
@@ -541,6 +673,7 @@ hg_set_struct(struct hg_private_handle *hg_handle,
             /* Set input proc */
             proc = hg_handle->in_proc;
             proc_cb = hg_proc_info->in_proc_cb;
+            presize = &hg_proc_info->in_presize;
 #ifdef HG_HAS_CHECKSUMS
             hg_header_hash = &hg_header->msg.input.hash;
 #endif
@@ -552,6 +685,7 @@ hg_set_struct(struct hg_private_handle *hg_handle,
             extra_buf = &hg_handle->in_extra_buf;
             extra_buf_size = &hg_handle->in_extra_buf_size;
             extra_bulk = &hg_handle->in_extra_bulk;
+            user_bulk = hg_handle->in_user_bulk;
             break;
         case HG_OUTPUT:
             /* Cannot respond if no_response flag set */
@@ -564,6 +698,7 @@ hg_set_struct(struct hg_private_handle *hg_handle,
             /* Set output proc */
             proc = hg_handle->out_proc;
             proc_cb = hg_proc_info->out_proc_cb;
+            presize = &hg_proc_info->out_presize;
 #ifdef HG_HAS_CHECKSUMS
             hg_header_hash = &hg_header->msg.output.hash;
 #endif
@@ -575,6 +710,7 @@ hg_set_struct(struct hg_private_handle *hg_handle,
             extra_buf = &hg_handle->out_extra_buf;
             extra_buf_size = &hg_handle->out_extra_buf_size;
             extra_bulk = &hg_handle->out_extra_bulk;
+            user_bulk = hg_handle->out_user_bulk;
             break;
         default:
             HG_GOTO_ERROR(done, ret, HG_INVALID_ARG, "Invalid HG op");
@@ -592,10 +728,48 @@ hg_set_struct(struct hg_private_handle *hg_handle,
     buf = (char *) buf + header_offset;
     buf_size -= header_offset;
 
+    /* Parameters of that RPC did not fit into the buffer before, compute
+     * their encoded size first so that the extra buffer is allocated once
+     * instead of being grown while encoding */
+    if (hg_proc_info->size_pass &&
+        hg_atomic_get32(presize) == HG_PROC_PRESIZE_ON) {
+        ret = hg_proc_reset(proc, NULL, 0, HG_SIZE);
+        HG_CHECK_HG_ERROR(done, ret, "Could not reset proc");
+
+        ret = proc_cb(proc, struct_ptr);
+        if (likely(ret == HG_SUCCESS))
+            encoded_size = hg_proc_get_size_used(proc);
+        else {
+            /* Proc does not support HG_SIZE, grow buffer while encoding */
+            HG_LOG_DEBUG("Proc does not support HG_SIZE (%s)",
+                HG_Error_to_string(ret));
+            hg_atomic_set32(presize, HG_PROC_PRESIZE_UNSUPPORTED);
+            ret = HG_SUCCESS;
+        }
+    }
+
     /* Reset proc */
     ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not reset proc");
 
+    /* Let parameters overflow directly into user registered buffer */
+    if (user_bulk != HG_BULK_NULL) {
+        hg_size_t user_buf_size = 0;
+        hg_uint32_t count = 0;
+
+        ret = HG_Bulk_access(user_bulk, 0, HG_Bulk_get_size(user_bulk),
+            HG_BULK_READWRITE, 1, &user_buf, &user_buf_size, &count);
+        HG_CHECK_HG_ERROR(done, ret, "Could not access user bulk handle");
+
+        ret = hg_proc_set_user_extra_buf(proc, user_buf, user_buf_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not set user extra buffer");
+    }
+
+    if (encoded_size > buf_size) {
+        ret = hg_proc_set_size(proc, encoded_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not allocate extra buffer");
+    }
+
     /* Encode parameters */
     ret = proc_cb(proc, struct_ptr);
     HG_CHECK_HG_ERROR(done, ret, "Could not encode parameters");
@@ -618,23 +792,35 @@ hg_set_struct(struct hg_private_handle *hg_handle,
      * it to retrieve the data.
      */
     if (hg_proc_get_extra_buf(proc)) {
+        hg_size_t used_size = hg_proc_get_size_used(proc);
+
         /* Potentially free previous payload if handle was not reset */
         hg_free_extra_payload(hg_handle);
 #ifdef HG_HAS_XDR
         HG_GOTO_ERROR(done, ret, HG_OVERFLOW,
             "Arguments overflow is not supported with XDR");
 #endif
-        /* Create a bulk descriptor only of the size that is used */
-        *extra_buf = hg_proc_get_extra_buf(proc);
-        *extra_buf_size = hg_proc_get_size_used(proc);
-
-        /* Prevent buffer from being freed when proc_reset is called */
-        hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
-
-        /* Create bulk descriptor */
-        ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
-            extra_buf_size, HG_BULK_READ_ONLY, extra_bulk);
-        HG_CHECK_HG_ERROR(done, ret, "Could not create bulk data handle");
+        /* Compute encoded size first on next calls if procs support it */
+        if (hg_proc_info->size_pass)
+            hg_atomic_cas32(presize, HG_PROC_PRESIZE_OFF, HG_PROC_PRESIZE_ON);
+
+        if (hg_proc_get_extra_buf(proc) == user_buf) {
+            /* Data was encoded into user registered buffer, no copy, no
+             * registration needed, the user bulk handle is sent as is */
+            extra_bulk = &user_bulk;
+        } else {
+            /* Create a bulk descriptor only of the size that is used */
+            *extra_buf = hg_proc_get_extra_buf(proc);
+            *extra_buf_size = used_size;
+
+            /* Prevent buffer from being freed when proc_reset is called */
+            hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
+
+            /* Create bulk descriptor */
+            ret = hg_bulk_create_uncached(hg_handle->handle.info.hg_class, 1,
+                extra_buf, extra_buf_size, HG_BULK_READ_ONLY, extra_bulk);
+            HG_CHECK_HG_ERROR(done, ret, "Could not create bulk data handle");
+        }
 
         /* Reset proc */
         ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
@@ -646,6 +832,10 @@ hg_set_struct(struct hg_private_handle *hg_handle,
         ret = hg_proc_hg_bulk_t(proc, extra_bulk);
         HG_CHECK_HG_ERROR(done, ret, "Could not process extra bulk handle");
 
+        /* Encode size actually used, bulk handle may be larger */
+        ret = hg_proc_hg_size_t(proc, &used_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not process extra size");
+
         ret = hg_proc_flush(proc);
         HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
 
@@ -676,7 +866,8 @@ done:
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_free_struct(struct hg_private_handle *hg_handle,
-    const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr)
+    const struct hg_proc_info *hg_proc_info, hg_op_t op,
+    hg_proc_cb_t prefix_cb, void *struct_ptr)
 {
     void *buf = NULL;
     hg_size_t buf_size = 0;
@@ -713,6 +904,8 @@ hg_free_struct(struct hg_private_handle *hg_handle,
         default:
             HG_GOTO_ERROR(done, ret, HG_INVALID_ARG, "Invalid HG op");
     }
+    if (prefix_cb)
+        proc_cb = prefix_cb;
     HG_CHECK_ERROR(proc_cb == NULL, done, ret, HG_FAULT,
         "No proc set, proc must be set in HG_Register()");
 
@@ -730,6 +923,10 @@ hg_free_struct(struct hg_private_handle *hg_handle,
     ret = proc_cb(proc, struct_ptr);
     HG_CHECK_HG_ERROR(done, ret, "Could not free allocated parameters");
 
+    /* Release arena at once when no other decoded input refers to it */
+    if (op == HG_INPUT && --hg_handle->in_arena_refs == 0)
+        hg_proc_arena_reset(proc);
+
     /* Decrement ref count or free */
     ret = HG_Core_destroy(hg_handle->handle.core_handle);
     HG_CHECK_HG_ERROR(done, ret, "Could not decrement handle ref count");
@@ -798,17 +995,22 @@ hg_get_extra_payload(struct hg_private_handle *hg_handle, hg_op_t op,
     ret = hg_proc_hg_bulk_t(proc, extra_bulk);
     HG_CHECK_HG_ERROR(done, ret, "Could not process extra bulk handle");
 
+    /* Decode size of data that was encoded */
+    ret = hg_proc_hg_size_t(proc, extra_buf_size);
+    HG_CHECK_HG_ERROR(done, ret, "Could not process extra size");
+    HG_CHECK_ERROR(*extra_buf_size > HG_Bulk_get_size(*extra_bulk), done, ret,
+        HG_OVERFLOW, "Extra size exceeds size of extra bulk handle");
+
     ret = hg_proc_flush(proc);
     HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
 
     /* Create a new local handle to read the data */
-    *extra_buf_size = HG_Bulk_get_size(*extra_bulk);
     *extra_buf = hg_mem_aligned_alloc(page_size, *extra_buf_size);
     HG_CHECK_ERROR(*extra_buf == NULL, done, ret, HG_NOMEM,
         "Could not allocate extra payload buffer");
 
-    ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
-        extra_buf_size, HG_BULK_READWRITE, &local_handle);
+    ret = hg_bulk_create_uncached(hg_handle->handle.info.hg_class, 1,
+        extra_buf, extra_buf_size, HG_BULK_READWRITE, &local_handle);
     HG_CHECK_HG_ERROR(done, ret, "Could not create HG bulk handle");
 
     /* Read bulk data here and wait for the data to be here  */
@@ -976,10 +1178,23 @@ HG_Init_opt(const char *na_info_string, hg_bool_t na_listen,
     HG_Core_set_more_data_callback(
         hg_class->hg_class.core_class, hg_more_data_cb, hg_more_data_free_cb);
 
+    /* Create pool for RPCs that have dispatch enabled */
+    if (hg_init_info && hg_init_info->dispatch_pool_size > 0) {
+        int rc = hg_thread_ws_pool_init(
+            hg_init_info->dispatch_pool_size, &hg_class->dispatch_pool);
+        HG_CHECK_ERROR_NORET(rc != HG_UTIL_SUCCESS, error,
+            "Could not create dispatch pool");
+    }
+
+    if (hg_init_info)
+        hg_class->bulk_op_pool_size = hg_init_info->bulk_op_pool_size;
+
     return (hg_class_t *) hg_class;
 
 error:
     if (hg_class) {
+        if (hg_class->hg_class.core_class)
+            HG_Core_finalize(hg_class->hg_class.core_class);
         hg_thread_spin_destroy(&hg_class->register_lock);
         free(hg_class);
     }
@@ -994,6 +1209,14 @@ HG_Finalize(hg_class_t *hg_class)
         (struct hg_private_class *) hg_class;
     hg_return_t ret = HG_SUCCESS;
 
+    /* Wait for dispatched RPC callbacks to complete */
+    if (private_class->dispatch_pool) {
+        int rc = hg_thread_ws_pool_destroy(private_class->dispatch_pool);
+        HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_PROTOCOL_ERROR,
+            "Could not destroy dispatch pool");
+        private_class->dispatch_pool = NULL;
+    }
+
     ret = HG_Core_finalize(private_class->hg_class.core_class);
     HG_CHECK_HG_ERROR(done, ret, "Could not finalize HG core class");
 
@@ -1066,6 +1289,18 @@ HG_Context_create_id(hg_class_t *hg_class, hg_uint8_t id)
     HG_Core_context_set_handle_create_callback(
         hg_context->core_context, hg_handle_create_cb, hg_context);
 
+    /* Set handle recycle callback */
+    HG_Core_context_set_handle_recycle_callback(
+        hg_context->core_context, hg_handle_recycle_cb, hg_context);
+
+    /* Create pool of bulk operations */
+    if (HG_CONTEXT_CLASS(hg_context)->bulk_op_pool_size > 0) {
+        hg_context->bulk_op_pool = hg_bulk_op_pool_create(
+            HG_CONTEXT_CLASS(hg_context)->bulk_op_pool_size);
+        HG_CHECK_ERROR_NORET(hg_context->bulk_op_pool == NULL, error,
+            "Could not create bulk operation pool");
+    }
+
     /* If we are listening, start posting requests */
     if (HG_Core_class_is_listening(hg_class->core_class)) {
         hg_return_t ret = HG_Core_context_post(
@@ -1083,6 +1318,7 @@ error:
             HG_CHECK_ERROR_DONE(
                 ret != HG_SUCCESS, "Could not destroy HG core context");
         }
+        hg_bulk_op_pool_destroy(hg_context->bulk_op_pool);
         free(hg_context);
     }
     return NULL;
@@ -1101,6 +1337,8 @@ HG_Context_destroy(hg_context_t *context)
     HG_CHECK_HG_ERROR(done, ret, "Could not destroy HG core context (%s)",
         HG_Error_to_string(ret));
 
+    /* No bulk operation can be pending once core context is destroyed */
+    hg_bulk_op_pool_destroy(context->bulk_op_pool);
     free(context);
 
 done:
@@ -1135,8 +1373,6 @@ hg_return_t
 HG_Registered_name(
     hg_class_t *hg_class, const char *func_name, hg_id_t *id, hg_bool_t *flag)
 {
-    struct hg_private_class *private_class =
-        (struct hg_private_class *) hg_class;
     hg_id_t rpc_id = 0;
     hg_return_t ret = HG_SUCCESS;
 
@@ -1147,18 +1383,14 @@ HG_Registered_name(
     /* Generate an ID from the function name */
     rpc_id = hg_hash_string(func_name);
 
-    hg_thread_spin_lock(&private_class->register_lock);
-
-    ret = HG_Core_registered(private_class->hg_class.core_class, rpc_id, flag);
-    HG_CHECK_HG_ERROR(unlock, ret, "Could not check for registered RPC ID (%s)",
+    /* Function map lookups do not need to be serialized with registration */
+    ret = HG_Core_registered(hg_class->core_class, rpc_id, flag);
+    HG_CHECK_HG_ERROR(done, ret, "Could not check for registered RPC ID (%s)",
         HG_Error_to_string(ret));
 
     if (id)
         *id = rpc_id;
 
-unlock:
-    hg_thread_spin_unlock(&private_class->register_lock);
-
 done:
     return ret;
 }
@@ -1252,16 +1484,13 @@ done:
 hg_return_t
 HG_Registered(hg_class_t *hg_class, hg_id_t id, hg_bool_t *flag)
 {
-    struct hg_private_class *private_class =
-        (struct hg_private_class *) hg_class;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    /* Function map lookups do not need to be serialized with registration */
     ret = HG_Core_registered(hg_class->core_class, id, flag);
-    hg_thread_spin_unlock(&private_class->register_lock);
     HG_CHECK_HG_ERROR(done, ret, "Could not check for registered RPC ID (s)",
         HG_Error_to_string(ret));
 
@@ -1429,6 +1658,130 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_enable_dispatch(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t enable)
+{
+    struct hg_private_class *private_class =
+        (struct hg_private_class *) hg_class;
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+
+    hg_thread_spin_lock(&private_class->register_lock);
+
+    /* Retrieve proc function from function map */
+    hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
+        hg_class->core_class, id);
+    HG_CHECK_ERROR(hg_proc_info == NULL, unlock, ret, HG_NOENTRY,
+        "Could not get registered data");
+
+    hg_proc_info->dispatch = enable;
+
+unlock:
+    hg_thread_spin_unlock(&private_class->register_lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_enabled_dispatch(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t *enabled)
+{
+    struct hg_private_class *private_class =
+        (struct hg_private_class *) hg_class;
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+    HG_CHECK_ERROR(enabled == NULL, done, ret, HG_INVALID_ARG,
+        "NULL pointer to enabled flag");
+
+    hg_thread_spin_lock(&private_class->register_lock);
+
+    /* Retrieve proc function from function map */
+    hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
+        hg_class->core_class, id);
+    HG_CHECK_ERROR(hg_proc_info == NULL, unlock, ret, HG_NOENTRY,
+        "Could not get registered data");
+
+    *enabled = hg_proc_info->dispatch;
+
+unlock:
+    hg_thread_spin_unlock(&private_class->register_lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_enable_size_pass(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t enable)
+{
+    struct hg_private_class *private_class =
+        (struct hg_private_class *) hg_class;
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+
+    hg_thread_spin_lock(&private_class->register_lock);
+
+    /* Retrieve proc function from function map */
+    hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
+        hg_class->core_class, id);
+    HG_CHECK_ERROR(hg_proc_info == NULL, unlock, ret, HG_NOENTRY,
+        "Could not get registered data");
+
+    hg_proc_info->size_pass = enable;
+
+unlock:
+    hg_thread_spin_unlock(&private_class->register_lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_enabled_size_pass(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t *enabled)
+{
+    struct hg_private_class *private_class =
+        (struct hg_private_class *) hg_class;
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+    HG_CHECK_ERROR(enabled == NULL, done, ret, HG_INVALID_ARG,
+        "NULL pointer to enabled flag");
+
+    hg_thread_spin_lock(&private_class->register_lock);
+
+    /* Retrieve proc function from function map */
+    hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
+        hg_class->core_class, id);
+    HG_CHECK_ERROR(hg_proc_info == NULL, unlock, ret, HG_NOENTRY,
+        "Could not get registered data");
+
+    *enabled = hg_proc_info->size_pass;
+
+unlock:
+    hg_thread_spin_unlock(&private_class->register_lock);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Addr_lookup1(hg_context_t *context, hg_cb_t callback, void *arg,
@@ -1483,6 +1836,44 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Addr_lookup_batch(hg_context_t *context, hg_cb_t callback, void *arg,
+    const char *const *names, hg_addr_t *addrs, unsigned int count,
+    hg_op_id_t *op_id)
+{
+    struct hg_op_id *hg_op_id = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, error, ret, HG_INVALID_ARG, "NULL HG context");
+    (void) op_id;
+
+    /* Allocate op_id */
+    hg_op_id = (struct hg_op_id *) malloc(sizeof(struct hg_op_id));
+    HG_CHECK_ERROR(hg_op_id == NULL, error, ret, HG_NOMEM,
+        "Could not allocate HG operation ID");
+
+    hg_op_id->context = context;
+    hg_op_id->type = HG_CB_LOOKUP;
+    hg_op_id->callback = callback;
+    hg_op_id->arg = arg;
+    hg_op_id->info.lookup.hg_addr = HG_ADDR_NULL;
+
+    ret = HG_Core_addr_lookup_batch(context->core_context,
+        hg_core_addr_lookup_cb, hg_op_id, names, (hg_core_addr_t *) addrs,
+        count, HG_CORE_OP_ID_IGNORE);
+    HG_CHECK_HG_ERROR(error, ret, "Could not lookup batch of %u names (%s)",
+        count, HG_Error_to_string(ret));
+
+    return ret;
+
+error:
+    free(hg_op_id);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Addr_free(hg_class_t *hg_class, hg_addr_t addr)
@@ -1678,8 +2069,8 @@ HG_Get_input(hg_handle_t handle, void *in_struct)
         hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
 
     /* Get input struct */
-    ret = hg_get_struct(
-        (struct hg_private_handle *) handle, hg_proc_info, HG_INPUT, in_struct);
+    ret = hg_get_struct((struct hg_private_handle *) handle, hg_proc_info,
+        HG_INPUT, NULL, in_struct);
     HG_CHECK_HG_ERROR(
         done, ret, "Could not get input (%s)", HG_Error_to_string(ret));
 
@@ -1706,8 +2097,8 @@ HG_Free_input(hg_handle_t handle, void *in_struct)
         hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
 
     /* Free input struct */
-    ret = hg_free_struct(
-        (struct hg_private_handle *) handle, hg_proc_info, HG_INPUT, in_struct);
+    ret = hg_free_struct((struct hg_private_handle *) handle, hg_proc_info,
+        HG_INPUT, NULL, in_struct);
     HG_CHECK_HG_ERROR(
         done, ret, "Could not free input (%s)", HG_Error_to_string(ret));
 
@@ -1715,6 +2106,106 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Get_input_prefix(hg_handle_t handle, hg_proc_cb_t prefix_cb, void *in_struct)
+{
+    const struct hg_proc_info *hg_proc_info;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        handle == HG_HANDLE_NULL, done, ret, HG_INVALID_ARG, "NULL HG handle");
+    HG_CHECK_ERROR(
+        prefix_cb == NULL, done, ret, HG_INVALID_ARG, "NULL prefix proc");
+    HG_CHECK_ERROR(in_struct == NULL, done, ret, HG_INVALID_ARG,
+        "NULL pointer to input struct");
+
+    /* Retrieve RPC data */
+    hg_proc_info =
+        (const struct hg_proc_info *) HG_Core_get_rpc_data(handle->core_handle);
+    HG_CHECK_ERROR(
+        hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
+
+    /* Get input prefix */
+    ret = hg_get_struct((struct hg_private_handle *) handle, hg_proc_info,
+        HG_INPUT, prefix_cb, in_struct);
+    HG_CHECK_HG_ERROR(
+        done, ret, "Could not get input prefix (%s)", HG_Error_to_string(ret));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Free_input_prefix(
+    hg_handle_t handle, hg_proc_cb_t prefix_cb, void *in_struct)
+{
+    const struct hg_proc_info *hg_proc_info;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        handle == HG_HANDLE_NULL, done, ret, HG_INVALID_ARG, "NULL HG handle");
+    HG_CHECK_ERROR(
+        prefix_cb == NULL, done, ret, HG_INVALID_ARG, "NULL prefix proc");
+    HG_CHECK_ERROR(in_struct == NULL, done, ret, HG_INVALID_ARG,
+        "NULL pointer to input struct");
+
+    /* Retrieve RPC data */
+    hg_proc_info =
+        (const struct hg_proc_info *) HG_Core_get_rpc_data(handle->core_handle);
+    HG_CHECK_ERROR(
+        hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
+
+    /* Free input prefix */
+    ret = hg_free_struct((struct hg_private_handle *) handle, hg_proc_info,
+        HG_INPUT, prefix_cb, in_struct);
+    HG_CHECK_HG_ERROR(
+        done, ret, "Could not free input prefix (%s)", HG_Error_to_string(ret));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Get_input_payload(
+    hg_handle_t handle, const void **payload, hg_size_t *payload_size)
+{
+    struct hg_private_handle *private_handle =
+        (struct hg_private_handle *) handle;
+    hg_size_t header_offset = hg_header_get_size(HG_INPUT);
+    void *buf;
+    hg_size_t buf_size;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        handle == HG_HANDLE_NULL, done, ret, HG_INVALID_ARG, "NULL HG handle");
+    HG_CHECK_ERROR(payload == NULL, done, ret, HG_INVALID_ARG,
+        "NULL input payload pointer");
+
+    /* Payload is either in the extra buffer or follows the headers */
+    if (private_handle->in_extra_buf) {
+        buf = private_handle->in_extra_buf;
+        buf_size = private_handle->in_extra_buf_size;
+    } else {
+        ret = HG_Core_get_input(handle->core_handle, &buf, &buf_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not get input buffer (%s)",
+            HG_Error_to_string(ret));
+
+        header_offset += handle->info.hg_class->in_offset;
+        buf = (char *) buf + header_offset;
+        buf_size -= header_offset;
+    }
+
+    *payload = buf;
+    if (payload_size)
+        *payload_size = buf_size;
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Get_output(hg_handle_t handle, void *out_struct)
@@ -1735,7 +2226,7 @@ HG_Get_output(hg_handle_t handle, void *out_struct)
 
     /* Get output struct */
     ret = hg_get_struct((struct hg_private_handle *) handle, hg_proc_info,
-        HG_OUTPUT, out_struct);
+        HG_OUTPUT, NULL, out_struct);
     HG_CHECK_HG_ERROR(
         done, ret, "Could not get output (%s)", HG_Error_to_string(ret));
 
@@ -1763,7 +2254,7 @@ HG_Free_output(hg_handle_t handle, void *out_struct)
 
     /* Free output struct */
     ret = hg_free_struct((struct hg_private_handle *) handle, hg_proc_info,
-        HG_OUTPUT, out_struct);
+        HG_OUTPUT, NULL, out_struct);
     HG_CHECK_HG_ERROR(
         done, ret, "Could not free output (%s)", HG_Error_to_string(ret));
 
@@ -1875,13 +2366,61 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Set_input_extra_bulk(hg_handle_t handle, hg_bulk_t bulk)
+{
+    struct hg_private_handle *private_handle =
+        (struct hg_private_handle *) handle;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        handle == HG_HANDLE_NULL, done, ret, HG_INVALID_ARG, "NULL HG handle");
+    HG_CHECK_ERROR(bulk != HG_BULK_NULL && HG_Bulk_get_segment_count(bulk) != 1,
+        done, ret, HG_INVALID_ARG, "Bulk handle must have a single segment");
+
+    if (bulk != HG_BULK_NULL) {
+        ret = HG_Bulk_ref_incr(bulk);
+        HG_CHECK_HG_ERROR(done, ret, "Could not increment bulk ref count");
+    }
+    HG_Bulk_free(private_handle->in_user_bulk);
+    private_handle->in_user_bulk = bulk;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Set_output_extra_bulk(hg_handle_t handle, hg_bulk_t bulk)
+{
+    struct hg_private_handle *private_handle =
+        (struct hg_private_handle *) handle;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        handle == HG_HANDLE_NULL, done, ret, HG_INVALID_ARG, "NULL HG handle");
+    HG_CHECK_ERROR(bulk != HG_BULK_NULL && HG_Bulk_get_segment_count(bulk) != 1,
+        done, ret, HG_INVALID_ARG, "Bulk handle must have a single segment");
+
+    if (bulk != HG_BULK_NULL) {
+        ret = HG_Bulk_ref_incr(bulk);
+        HG_CHECK_HG_ERROR(done, ret, "Could not increment bulk ref count");
+    }
+    HG_Bulk_free(private_handle->out_user_bulk);
+    private_handle->out_user_bulk = bulk;
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
 {
     struct hg_private_handle *private_handle =
         (struct hg_private_handle *) handle;
-    const struct hg_proc_info *hg_proc_info = NULL;
+    struct hg_proc_info *hg_proc_info = NULL;
     hg_size_t payload_size = 0;
     hg_bool_t more_data = HG_FALSE;
     hg_uint8_t flags = 0;
@@ -1894,9 +2433,12 @@ HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
     private_handle->forward_cb = callback;
     private_handle->forward_arg = arg;
 
-    /* Retrieve RPC data */
-    hg_proc_info =
-        (const struct hg_proc_info *) HG_Core_get_rpc_data(handle->core_handle);
+    /* Retrieve RPC data (not read-only as it records whether parameters
+     * overflowed) */
+    hg_proc_info = (handle->core_handle->rpc_info)
+                       ? (struct hg_proc_info *)
+                             handle->core_handle->rpc_info->data
+                       : NULL;
     HG_CHECK_ERROR(
         hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
 
@@ -1932,7 +2474,7 @@ HG_Respond(hg_handle_t handle, hg_cb_t callback, void *arg, void *out_struct)
 {
     struct hg_private_handle *private_handle =
         (struct hg_private_handle *) handle;
-    const struct hg_proc_info *hg_proc_info;
+    struct hg_proc_info *hg_proc_info;
     hg_size_t payload_size;
     hg_bool_t more_data = HG_FALSE;
     hg_uint8_t flags = 0;
@@ -1945,9 +2487,12 @@ HG_Respond(hg_handle_t handle, hg_cb_t callback, void *arg, void *out_struct)
     private_handle->respond_cb = callback;
     private_handle->respond_arg = arg;
 
-    /* Retrieve RPC data */
-    hg_proc_info =
-        (const struct hg_proc_info *) HG_Core_get_rpc_data(handle->core_handle);
+    /* Retrieve RPC data (not read-only as it records whether parameters
+     * overflowed) */
+    hg_proc_info = (handle->core_handle->rpc_info)
+                       ? (struct hg_proc_info *)
+                             handle->core_handle->rpc_info->data
+                       : NULL;
     HG_CHECK_ERROR(
         hg_proc_info == NULL, done, ret, HG_FAULT, "Could not get proc info");
 
@@ -2008,6 +2553,41 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Trigger_batch(hg_context_t *context, unsigned int timeout,
+    unsigned int max_count, hg_completion_t *completions,
+    unsigned int *actual_count)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG context");
+
+    ret = HG_Core_trigger_batch(context->core_context, timeout, max_count,
+        (hg_core_completion_t *) completions, actual_count);
+    HG_CHECK_ERROR_NORET(ret != HG_SUCCESS && ret != HG_TIMEOUT, done,
+        "Could not trigger operations from context (%s)",
+        HG_Error_to_string(ret));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Trigger_completion(hg_completion_t completion)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = HG_Core_trigger_completion((hg_core_completion_t) completion);
+    HG_CHECK_HG_ERROR(done, ret, "Could not trigger completion (%s)",
+        HG_Error_to_string(ret));
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Cancel(hg_handle_t handle)
@@ -318,6 +318,36 @@ HG_Context_set_data(
 static HG_INLINE void *
 HG_Context_get_data(const hg_context_t *context);
 
+/**
+ * Retrieve the number of handles that were re-used from the context handle
+ * pool and the number of handles that had to be allocated. Handle pooling is
+ * enabled by setting handle_pool_size in hg_init_info.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param hit_count [OUT]       pointer to number of hits
+ * \param miss_count [OUT]      pointer to number of misses
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Context_get_handle_pool_stats(const hg_context_t *context,
+    hg_uint64_t *hit_count, hg_uint64_t *miss_count);
+
+/**
+ * Retrieve the number of progress calls that completed while spinning and
+ * the number of calls that had to fall back to blocking. Spinning is enabled
+ * by setting NA_ADAPTIVE_SPIN in the progress mode of hg_init_info.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param spin_count [OUT]      pointer to number of calls completed spinning
+ * \param block_count [OUT]     pointer to number of calls that blocked
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Context_get_progress_stats(const hg_context_t *context,
+    hg_uint64_t *spin_count, hg_uint64_t *block_count);
+
 /**
  * Dynamically register a function func_name as an RPC as well as the
  * RPC callback executed when the RPC request ID associated to func_name is
@@ -470,6 +500,126 @@ HG_PUBLIC hg_return_t
 HG_Registered_disabled_response(
     hg_class_t *hg_class, hg_id_t id, hg_bool_t *disabled);
 
+/**
+ * Enable or disable recording of RPC statistics. When enabled, the number of
+ * RPCs forwarded and handled, the number of bytes sent and received, the
+ * number of payloads that exceeded eager buffers and per-phase latency
+ * histograms (see hg_stats_phase_t) are recorded for each RPC ID. Statistics
+ * are disabled by default.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Stats_enable(hg_class_t *hg_class, hg_bool_t enable);
+
+/**
+ * Retrieve statistics recorded for a given RPC ID. Statistics can be
+ * retrieved while RPCs are in flight, in which case values may not all
+ * reflect the same point in time.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param stats [OUT]           pointer to statistics
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Stats_get(hg_class_t *hg_class, hg_id_t id, struct hg_stats *stats);
+
+/**
+ * Reset statistics recorded for a given RPC ID, or for all registered RPC IDs
+ * if id is 0.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID or 0
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Stats_reset(hg_class_t *hg_class, hg_id_t id);
+
+/**
+ * Estimate a latency percentile from a histogram returned by HG_Stats_get().
+ *
+ * \param hist [IN]             pointer to latency histogram
+ * \param percentile [IN]       percentile between 0 and 100
+ *
+ * \return latency in ns or 0 if the histogram is empty
+ */
+static HG_INLINE hg_uint64_t
+HG_Stats_percentile(const struct hg_stats_hist *hist, double percentile);
+
+/**
+ * Execute the RPC callback of a given RPC ID in the dispatch pool instead of
+ * executing it inline from HG_Trigger(). Slow RPC callbacks then do not
+ * delay the progress of other RPCs. The dispatch pool is created by setting
+ * dispatch_pool_size in hg_init_info; if no pool was created, RPC callbacks
+ * keep being executed inline. RPC callbacks that are dispatched may run
+ * concurrently and must therefore be thread-safe.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Registered_enable_dispatch(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t enable);
+
+/**
+ * Check if dispatch is enabled for a given RPC ID
+ * (i.e., HG_Registered_enable_dispatch() has been called for this RPC ID).
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enabled [OUT]         boolean (HG_TRUE if enabled
+ *                                       HG_FALSE if disabled)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Registered_enabled_dispatch(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t *enabled);
+
+/**
+ * Compute the encoded size of the input and output of a given RPC ID before
+ * encoding them, once they have overflowed the eager buffer. The extra buffer
+ * is then allocated once instead of being grown while encoding. Procs of that
+ * RPC are called with HG_SIZE (see hg_proc_reset()) and must support it, procs
+ * generated with MERCURY_GEN_PROC() do. This is disabled by default.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Registered_enable_size_pass(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t enable);
+
+/**
+ * Check if size pass is enabled for a given RPC ID
+ * (i.e., HG_Registered_enable_size_pass() has been called for this RPC ID).
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enabled [OUT]         boolean (HG_TRUE if enabled
+ *                                       HG_FALSE if disabled)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Registered_enabled_size_pass(
+    hg_class_t *hg_class, hg_id_t id, hg_bool_t *enabled);
+
 /**
  * Lookup an addr from a peer address/name. Addresses need to be
  * freed by calling HG_Addr_free(). After completion, user callback is
@@ -507,6 +657,33 @@ HG_Addr_lookup1(hg_context_t *context, hg_cb_t callback, void *arg,
 HG_PUBLIC hg_return_t
 HG_Addr_lookup2(hg_class_t *hg_class, const char *name, hg_addr_t *addr);
 
+/**
+ * Lookup addrs from a batch of peer addresses/names. Names are looked up
+ * concurrently by the threads of the addr lookup pool (see
+ * hg_init_info.addr_lookup_pool_size) or by the caller if there is no pool.
+ * Once all names have been looked up, user callback is placed into a
+ * completion queue and can be triggered using HG_Trigger(). Each
+ * successfully looked up addr needs to be freed by calling HG_Addr_free(),
+ * addrs of names that could not be looked up are set to HG_ADDR_NULL and the
+ * callback return code is set to the first error that occurred.
+ *
+ * \remark names and addrs must remain valid until the callback is triggered.
+ *
+ * \param context [IN]          pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param names [IN]            array of lookup names
+ * \param addrs [OUT]           array of abstract addresses
+ * \param count [IN]            number of names
+ * \param op_id [OUT]           pointer to returned operation ID (unused)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Addr_lookup_batch(hg_context_t *context, hg_cb_t callback, void *arg,
+    const char *const *names, hg_addr_t *addrs, unsigned int count,
+    hg_op_id_t *op_id);
+
 /**
  * Free the addr.
  *
@@ -693,6 +870,10 @@ HG_Get_data(hg_handle_t handle);
  *   - HG_Core_get_input()
  *   - Call hg_proc to deserialize parameters
  *
+ * \remark Borrowed views (hg_const_string_view_t, hg_bytes_view_t) point into
+ * the buffer that input was received into, the handle keeps that buffer until
+ * HG_Free_input() is called.
+ *
  * \param handle [IN]           HG handle
  * \param in_struct [IN/OUT]    pointer to input structure
  *
@@ -706,6 +887,11 @@ HG_Get_input(hg_handle_t handle, void *in_struct);
  * User may copy parameters contained in the input structure before calling
  * HG_Free_input().
  *
+ * \remark Memory allocated by input procs through hg_proc_arena_alloc(), which
+ * includes strings, comes from an arena owned by the handle. It must not be
+ * freed by the user and is released at once when the last input decoded from
+ * the handle is freed.
+ *
  * \param handle [IN]           HG handle
  * \param in_struct [IN/OUT]    pointer to input structure
  *
@@ -714,6 +900,58 @@ HG_Get_input(hg_handle_t handle, void *in_struct);
 HG_PUBLIC hg_return_t
 HG_Free_input(hg_handle_t handle, void *in_struct);
 
+/**
+ * Decode only the leading fields of the input, for instance to route or
+ * reject a request before decoding the rest of it. prefix_cb must decode the
+ * same leading fields as the input proc registered with HG_Register(), such
+ * procs are generated for each field by MERCURY_GEN_PROC() and can be used
+ * through MERCURY_PEEK_INPUT(). Input prefix must be freed using
+ * HG_Free_input_prefix().
+ *
+ * \remark The input checksum is not verified as the payload is only
+ * partially decoded. HG_Get_input() can still be called afterwards.
+ *
+ * \param handle [IN]           HG handle
+ * \param prefix_cb [IN]        proc decoding leading input fields
+ * \param in_struct [IN/OUT]    pointer to input structure
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Get_input_prefix(
+    hg_handle_t handle, hg_proc_cb_t prefix_cb, void *in_struct);
+
+/**
+ * Free resources allocated when decoding the input prefix.
+ *
+ * \param handle [IN]           HG handle
+ * \param prefix_cb [IN]        proc passed to HG_Get_input_prefix()
+ * \param in_struct [IN/OUT]    pointer to input structure
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Free_input_prefix(
+    hg_handle_t handle, hg_proc_cb_t prefix_cb, void *in_struct);
+
+/**
+ * Get a read-only view of the encoded input payload, i.e., of the bytes that
+ * HG_Get_input() decodes, without copying or decoding it. Unlike
+ * HG_Get_input_buf(), the payload excludes the input offset set with
+ * HG_Class_set_input_offset() and points to the extra buffer if the input
+ * did not fit into the eager buffer. The view remains valid until the handle
+ * is destroyed.
+ *
+ * \param handle [IN]           HG handle
+ * \param payload [OUT]         pointer to encoded input payload
+ * \param payload_size [OUT]    pointer to payload size (may be NULL)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Get_input_payload(
+    hg_handle_t handle, const void **payload, hg_size_t *payload_size);
+
 /**
  * Get output from handle (requires registration of output proc to deserialize
  * parameters). Output must be freed using HG_Free_output().
@@ -826,6 +1064,40 @@ HG_PUBLIC hg_return_t
 HG_Get_output_extra_buf(
     hg_handle_t handle, void **out_buf, hg_size_t *out_buf_size);
 
+/**
+ * Set a pre-registered bulk handle that input parameters are directly encoded
+ * into when they do not fit into an eager buffer. This avoids allocating,
+ * registering and deregistering a new extra buffer for each HG_Forward() call
+ * with large input parameters. The bulk handle must have a single segment
+ * and must remain accessible for reading by the target; its content must not
+ * be modified until the forward callback is triggered. If the encoded input
+ * does not fit into that buffer, an extra buffer is allocated as usual.
+ * A reference to the bulk handle is kept until HG_Set_input_extra_bulk() is
+ * called again or until the handle is destroyed. Passing HG_BULK_NULL
+ * releases the previous bulk handle.
+ *
+ * \param handle [IN]           HG handle
+ * \param bulk [IN]             bulk handle
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Set_input_extra_bulk(hg_handle_t handle, hg_bulk_t bulk);
+
+/**
+ * Set a pre-registered bulk handle that output parameters are directly
+ * encoded into when they do not fit into an eager buffer. Same as
+ * HG_Set_input_extra_bulk() but for HG_Respond(), the content of the buffer
+ * must not be modified until the handle is destroyed.
+ *
+ * \param handle [IN]           HG handle
+ * \param bulk [IN]             bulk handle
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Set_output_extra_bulk(hg_handle_t handle, hg_bulk_t bulk);
+
 /**
  * Set target context ID that will receive and process the RPC request
  * (ID is defined on target context creation, see HG_Context_create_id()).
@@ -838,6 +1110,23 @@ HG_Get_output_extra_buf(
 static HG_INLINE hg_return_t
 HG_Set_target_id(hg_handle_t handle, hg_uint8_t id);
 
+/**
+ * Set target context ID by hashing \key over the \count target contexts of
+ * IDs \first_id to \first_id + \count - 1, so that requests with the same key
+ * are always processed by the same target context (e.g., one of the contexts
+ * of a progress group created with the same \first_id and \count).
+ *
+ * \param handle [IN]           HG handle
+ * \param key [IN]              user-defined key (e.g., object ID)
+ * \param first_id [IN]         ID of first target context
+ * \param count [IN]            number of target contexts (up to 256)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Set_target_id_hash(hg_handle_t handle, hg_uint64_t key, hg_uint8_t first_id,
+    unsigned int count);
+
 /**
  * Forward a call to a local/remote target using an existing HG handle.
  * Input structure can be passed and parameters serialized using a previously
@@ -912,6 +1201,41 @@ HG_PUBLIC hg_return_t
 HG_Trigger(hg_context_t *context, unsigned int timeout, unsigned int max_count,
     unsigned int *actual_count);
 
+/**
+ * Dequeue at most max_count completions in batches. If completions is NULL,
+ * callbacks are executed inline, otherwise completions are stored into the
+ * completions array (of at least max_count entries) and callbacks must later
+ * be executed by calling HG_Trigger_completion() on each of them, possibly
+ * from a different thread. If timeout is non-zero, wait up to timeout before
+ * returning.
+ *
+ * \remark This routine is internally equivalent to:
+ *   - HG_Core_trigger_batch()
+ *
+ * \param context [IN]          pointer to HG context
+ * \param timeout [IN]          timeout (in milliseconds)
+ * \param max_count [IN]        maximum number of completions dequeued
+ * \param completions [OUT]     array of completions (may be NULL)
+ * \param actual_count [OUT]    actual number of completions dequeued
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Trigger_batch(hg_context_t *context, unsigned int timeout,
+    unsigned int max_count, hg_completion_t *completions,
+    unsigned int *actual_count);
+
+/**
+ * Execute the callback of a completion previously returned by
+ * HG_Trigger_batch(). Each completion must be triggered exactly once.
+ *
+ * \param completion [IN]       completion entry
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Trigger_completion(hg_completion_t completion);
+
 /**
  * Cancel an ongoing operation.
  *
@@ -935,8 +1259,9 @@ struct hg_class {
 
 /* HG context */
 struct hg_context {
-    hg_core_context_t *core_context; /* Core context */
-    hg_class_t *hg_class;            /* HG class */
+    hg_core_context_t *core_context;      /* Core context */
+    hg_class_t *hg_class;                 /* HG class */
+    struct hg_bulk_op_pool *bulk_op_pool; /* Pool of bulk operations */
 };
 
 /* HG handle */
@@ -1058,6 +1383,52 @@ HG_Context_get_data(const hg_context_t *context)
     return HG_Core_context_get_data(context->core_context);
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Context_get_handle_pool_stats(const hg_context_t *context,
+    hg_uint64_t *hit_count, hg_uint64_t *miss_count)
+{
+    return HG_Core_context_get_handle_pool_stats(
+        context->core_context, hit_count, miss_count);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Context_get_progress_stats(const hg_context_t *context,
+    hg_uint64_t *spin_count, hg_uint64_t *block_count)
+{
+    return HG_Core_context_get_progress_stats(
+        context->core_context, spin_count, block_count);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Stats_enable(hg_class_t *hg_class, hg_bool_t enable)
+{
+    return HG_Core_stats_enable(hg_class->core_class, enable);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Stats_get(hg_class_t *hg_class, hg_id_t id, struct hg_stats *stats)
+{
+    return HG_Core_stats_get(hg_class->core_class, id, stats);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Stats_reset(hg_class_t *hg_class, hg_id_t id)
+{
+    return HG_Core_stats_reset(hg_class->core_class, id);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_uint64_t
+HG_Stats_percentile(const struct hg_stats_hist *hist, double percentile)
+{
+    return HG_Core_stats_percentile(hist, percentile);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_return_t
 HG_Ref_incr(hg_handle_t handle)
@@ -1105,6 +1476,21 @@ HG_Set_target_id(hg_handle_t handle, hg_uint8_t id)
     return HG_Core_set_target_id(handle->core_handle, id);
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Set_target_id_hash(hg_handle_t handle, hg_uint64_t key, hg_uint8_t first_id,
+    unsigned int count)
+{
+    /* Fibonacci hashing, spreads consecutive keys across targets */
+    hg_uint32_t hash = (hg_uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+
+    /* Target context IDs are 8-bit */
+    if (count == 0 || count > 256 || (unsigned int) first_id + count > 256)
+        return HG_INVALID_ARG;
+
+    return HG_Set_target_id(handle, (hg_uint8_t)(first_id + hash % count));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,11 +9,15 @@
  */
 
 #include "mercury_bulk.h"
+#include "mercury_bulk_cache.h"
 #include "mercury_core.h"
 #include "mercury_error.h"
 #include "mercury_private.h"
 
 #include "mercury_atomic.h"
+#include "mercury_atomic_queue.h"
+#include "mercury_thread_spin.h"
+#include "mercury_trace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -24,6 +28,25 @@
 
 #define HG_BULK_MIN(a, b) (a < b) ? a : b
 
+/* No chunk to issue again */
+#define HG_BULK_CHUNK_NONE ((unsigned int) -1)
+
+/* Number of NA operation IDs stored inline in bulk operation IDs */
+#define HG_BULK_OP_INLINE_COUNT 8
+
+/* Map stat type to either 32-bit atomic or 64-bit */
+#ifndef HG_UTIL_HAS_OPA_PRIMITIVES_H
+typedef hg_atomic_int64_t hg_bulk_stat_t;
+#    define hg_bulk_stat_init hg_atomic_init64
+#    define hg_bulk_stat_incr hg_atomic_incr64
+#    define hg_bulk_stat_get  hg_atomic_get64
+#else
+typedef hg_atomic_int32_t hg_bulk_stat_t;
+#    define hg_bulk_stat_init hg_atomic_init32
+#    define hg_bulk_stat_incr hg_atomic_incr32
+#    define hg_bulk_stat_get  hg_atomic_get32
+#endif
+
 /* Remove warnings when plugin does not use callback arguments */
 #if defined(__cplusplus)
 #    define HG_BULK_UNUSED
@@ -44,7 +67,9 @@ struct hg_class {
 
 /* HG context */
 struct hg_context {
-    hg_core_context_t *core_context; /* Core context */
+    hg_core_context_t *core_context;      /* Core context */
+    hg_class_t *hg_class;                 /* HG class */
+    struct hg_bulk_op_pool *bulk_op_pool; /* Pool of bulk operations */
 };
 
 /* HG Bulk op id */
@@ -65,12 +90,32 @@ struct hg_bulk_op_id {
     unsigned int op_count;                /* Number of ongoing operations */
     hg_bulk_op_t op;                      /* Operation type */
     hg_bool_t is_self;                    /* Is self operation */
+    struct hg_bulk_pipeline *pipeline;    /* Pipelined transfer (optional) */
+    struct hg_bulk_op_pool *pool;         /* Pool operation returns to */
+    na_class_t *na_op_class;              /* NA class of NA operation IDs */
+    unsigned int na_op_id_count;          /* Number of NA operation IDs */
+    na_op_id_t na_op_ids_inline[HG_BULK_OP_INLINE_COUNT]; /* Inline IDs */
+    hg_util_uint64_t trace_id;            /* Trace correlation ID */
 };
 
-/* Segment used to transfer data and map to NA layer */
-struct hg_bulk_segment {
-    hg_ptr_t address; /* address of the segment */
-    hg_size_t size;   /* size of the segment in bytes */
+/* Pool of bulk operation IDs */
+struct hg_bulk_op_pool {
+    struct hg_atomic_queue *free_list; /* Free list of cached operations */
+    hg_atomic_int32_t count;           /* Number of cached operations */
+    unsigned int max_count;            /* High-water mark */
+    hg_bulk_stat_t hit_count;          /* Operations re-used from pool */
+    hg_bulk_stat_t miss_count;         /* Operations allocated from scratch */
+};
+
+/* Chunk of pipelined transfer */
+struct hg_bulk_chunk {
+    struct hg_bulk_op_id *hg_bulk_op_id; /* Operation ID */
+    hg_size_t offset;                    /* Offset in transfer */
+    hg_size_t size;                      /* Size of chunk */
+    hg_size_t origin_segment_index;      /* Origin segment index */
+    hg_size_t origin_segment_offset;     /* Offset in origin segment */
+    hg_size_t local_segment_index;       /* Local segment index */
+    hg_size_t local_segment_offset;      /* Offset in local segment */
 };
 
 /* Wrapper on top of NA layer */
@@ -81,6 +126,39 @@ typedef na_return_t (*na_bulk_op_t)(na_class_t *na_class, na_context_t *context,
     na_offset_t remote_offset, na_size_t data_size, na_addr_t remote_addr,
     na_uint8_t remote_id, na_op_id_t *op_id);
 
+/* Pipelined transfer */
+struct hg_bulk_pipeline {
+    struct hg_bulk_chunk cursor;  /* Position of next chunk */
+    struct hg_bulk_chunk *chunks; /* Chunks, one per NA operation ID slot */
+    unsigned int *free_slots;     /* FIFO of free slots */
+    na_bulk_op_t na_bulk_op;      /* NA operation */
+    na_addr_t origin_addr;        /* NA address of origin */
+    hg_bulk_chunk_cb_t chunk_cb;  /* Chunk callback */
+    void *chunk_arg;              /* Chunk callback argument */
+    hg_size_t chunk_size;         /* Max size of chunks */
+    hg_size_t remaining_size;     /* Size left to issue */
+    hg_thread_spin_t lock;        /* Lock */
+    unsigned int max_in_flight;   /* Max chunks in flight */
+    unsigned int in_flight;       /* Number of chunks in flight */
+    unsigned int slot_count;      /* Number of slots */
+    unsigned int free_head;       /* Index of first free slot in FIFO */
+    unsigned int free_count;      /* Number of free slots */
+    unsigned int started;         /* Number of chunks posted to NA */
+    unsigned int retry;           /* Chunk to issue again */
+    hg_return_t ret;              /* Return code of transfer */
+    na_uint8_t origin_id;         /* Context ID of origin */
+    hg_bool_t scatter_gather;     /* Origin/local segments are mapped */
+    hg_bool_t use_sm;             /* Use NA SM handles */
+    hg_bool_t pumping;            /* Chunks are being issued */
+    hg_bool_t finished;           /* Completion was reported */
+};
+
+/* Segment used to transfer data and map to NA layer */
+struct hg_bulk_segment {
+    hg_ptr_t address; /* address of the segment */
+    hg_size_t size;   /* size of the segment in bytes */
+};
+
 /* Note to self, get_serialize_size may be updated accordingly */
 struct hg_bulk {
     hg_class_t *hg_class; /* HG class */
@@ -94,6 +172,7 @@ struct hg_bulk {
 #ifdef HG_HAS_SM_ROUTING
     na_mem_handle_t *na_sm_mem_handles; /* Array of NA SM memory handles */
 #endif
+    struct hg_bulk_cache_entry **cache_entries; /* Cached registrations */
     void *serialize_ptr;             /* Cached serialization buffer */
     hg_size_t total_size;            /* Total size of data abstracted */
     hg_size_t serialize_size;        /* Cached serialization size */
@@ -116,7 +195,8 @@ struct hg_bulk {
  */
 static hg_return_t
 hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
-    const hg_size_t *buf_sizes, hg_uint8_t flags, struct hg_bulk **hg_bulk_ptr);
+    const hg_size_t *buf_sizes, hg_uint8_t flags, hg_bool_t use_cache,
+    struct hg_bulk **hg_bulk_ptr);
 
 /**
  * Free handle.
@@ -157,6 +237,76 @@ hg_bulk_transfer_pieces(na_bulk_op_t na_bulk_op, na_addr_t origin_addr,
     hg_bool_t scatter_gather, struct hg_bulk_op_id *hg_bulk_op_id,
     unsigned int *na_op_count);
 
+/**
+ * Create pipeline state and slots of chunks in flight.
+ */
+static hg_return_t
+hg_bulk_pipeline_create(struct hg_bulk_op_id *hg_bulk_op_id,
+    const struct hg_bulk_pipeline_info *pipeline_info, na_bulk_op_t na_bulk_op,
+    na_addr_t origin_addr, na_uint8_t origin_id, hg_bool_t use_sm,
+    hg_size_t origin_segment_start_index, hg_size_t origin_segment_start_offset,
+    hg_size_t local_segment_start_index, hg_size_t local_segment_start_offset,
+    hg_size_t size, hg_bool_t scatter_gather);
+
+/**
+ * Free pipeline state.
+ */
+static void
+hg_bulk_pipeline_free(struct hg_bulk_pipeline *pipeline);
+
+/**
+ * Get next chunk and advance position.
+ */
+static void
+hg_bulk_pipeline_next(
+    struct hg_bulk_op_id *hg_bulk_op_id, struct hg_bulk_chunk *chunk);
+
+/**
+ * Take oldest free slot other than \busy_slot (must be called with lock
+ * held).
+ */
+static HG_INLINE unsigned int
+hg_bulk_pipeline_slot_get(
+    struct hg_bulk_pipeline *pipeline, unsigned int busy_slot);
+
+/**
+ * Return slot to free slots (must be called with lock held).
+ */
+static HG_INLINE void
+hg_bulk_pipeline_slot_put(struct hg_bulk_pipeline *pipeline, unsigned int slot);
+
+/**
+ * Check whether a chunk can be issued (must be called with lock held).
+ */
+static HG_INLINE hg_bool_t
+hg_bulk_pipeline_can_issue(struct hg_bulk_op_id *hg_bulk_op_id);
+
+/**
+ * Check whether transfer is finished (must be called with lock held).
+ */
+static HG_INLINE hg_bool_t
+hg_bulk_pipeline_finish(struct hg_bulk_op_id *hg_bulk_op_id);
+
+/**
+ * Post chunk to NA.
+ */
+static na_return_t
+hg_bulk_pipeline_post(struct hg_bulk_op_id *hg_bulk_op_id, unsigned int index);
+
+/**
+ * Issue chunks until window is full (pumping must be set by caller), the
+ * slot of the chunk whose callback is being executed is not re-used.
+ */
+static hg_return_t
+hg_bulk_pipeline_pump(
+    struct hg_bulk_op_id *hg_bulk_op_id, unsigned int busy_slot);
+
+/**
+ * Pipelined transfer callback.
+ */
+static int
+hg_bulk_pipeline_cb(const struct na_cb_info *callback_info);
+
 /**
  * Transfer data.
  */
@@ -165,7 +315,39 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_bulk_op_t op, struct hg_addr *origin_addr, hg_uint8_t origin_id,
     struct hg_bulk *hg_bulk_origin, hg_size_t origin_offset,
     struct hg_bulk *hg_bulk_local, hg_size_t local_offset, hg_size_t size,
-    hg_op_id_t *op_id);
+    const struct hg_bulk_pipeline_info *pipeline_info, hg_op_id_t *op_id);
+
+/**
+ * Get operation ID from pool or allocate a new one.
+ */
+static struct hg_bulk_op_id *
+hg_bulk_op_create(struct hg_bulk_op_pool *hg_bulk_op_pool);
+
+/**
+ * Make sure that operation ID has at least count NA operation IDs created
+ * with its NA class, existing NA operation IDs are re-used.
+ */
+static hg_return_t
+hg_bulk_op_reserve_na(
+    struct hg_bulk_op_id *hg_bulk_op_id, unsigned int count);
+
+/**
+ * Destroy NA operation IDs of operation ID.
+ */
+static hg_return_t
+hg_bulk_op_free_na(struct hg_bulk_op_id *hg_bulk_op_id);
+
+/**
+ * Return operation ID to its pool or free it.
+ */
+static void
+hg_bulk_op_release(struct hg_bulk_op_id *hg_bulk_op_id);
+
+/**
+ * Free operation ID.
+ */
+static void
+hg_bulk_op_free(struct hg_bulk_op_id *hg_bulk_op_id);
 
 /**
  * Complete operation ID.
@@ -305,7 +487,8 @@ done:
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
-    const hg_size_t *buf_sizes, hg_uint8_t flags, struct hg_bulk **hg_bulk_ptr)
+    const hg_size_t *buf_sizes, hg_uint8_t flags, hg_bool_t use_cache,
+    struct hg_bulk **hg_bulk_ptr)
 {
     struct hg_bulk *hg_bulk = NULL;
     hg_return_t ret = HG_SUCCESS;
@@ -316,8 +499,13 @@ hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
 #endif
     hg_bool_t use_register_segments =
         (hg_bool_t)(na_class->ops->mem_handle_create_segments && count > 1);
+    struct hg_bulk_cache *cache = hg_class->core_class->bulk_cache;
     unsigned int i;
 
+    /* Only user memory registered segment by segment is cached */
+    if (!cache || !buf_ptrs || use_register_segments)
+        use_cache = HG_FALSE;
+
     hg_bulk = (struct hg_bulk *) malloc(sizeof(struct hg_bulk));
     HG_CHECK_ERROR(
         hg_bulk == NULL, error, ret, HG_NOMEM, "Could not allocate handle");
@@ -373,6 +561,12 @@ hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
             "Could not allocate SM mem handle array");
     }
 #endif
+    if (use_cache) {
+        hg_bulk->cache_entries = (struct hg_bulk_cache_entry **) calloc(
+            hg_bulk->na_mem_handle_count, sizeof(struct hg_bulk_cache_entry *));
+        HG_CHECK_ERROR(hg_bulk->cache_entries == NULL, error, ret, HG_NOMEM,
+            "Could not allocate cache entry array");
+    }
     for (i = 0; i < hg_bulk->na_mem_handle_count; i++) {
         hg_bulk->na_mem_handles[i] = NA_MEM_HANDLE_NULL;
 #ifdef HG_HAS_SM_ROUTING
@@ -387,6 +581,22 @@ hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
         if (!hg_bulk->segments[i].address)
             continue;
 
+        if (use_cache) {
+            ret = hg_bulk_cache_acquire(cache,
+                (void *) hg_bulk->segments[i].address,
+                hg_bulk->segments[i].size, flags, &hg_bulk->cache_entries[i],
+                &hg_bulk->na_mem_handles[i],
+#ifdef HG_HAS_SM_ROUTING
+                hg_bulk->na_sm_mem_handles ? &hg_bulk->na_sm_mem_handles[i]
+                                           : NULL
+#else
+                NULL
+#endif
+            );
+            HG_CHECK_HG_ERROR(error, ret, "Could not get cached registration");
+            continue;
+        }
+
         if (use_register_segments) {
             struct na_segment *na_segments =
                 (struct na_segment *) hg_bulk->segments;
@@ -476,6 +686,29 @@ hg_bulk_free(struct hg_bulk *hg_bulk)
         na_class_t *na_sm_class = hg_bulk->na_sm_class;
 #endif
 
+        /* Give back cached registrations, they are not ours to free */
+        if (hg_bulk->cache_entries) {
+            struct hg_bulk_cache *cache =
+                hg_bulk->hg_class->core_class->bulk_cache;
+
+            for (i = 0; i < hg_bulk->na_mem_handle_count; i++) {
+                if (!hg_bulk->cache_entries[i])
+                    continue;
+
+                ret = hg_bulk_cache_release(cache, hg_bulk->cache_entries[i]);
+                HG_CHECK_HG_ERROR(
+                    done, ret, "Could not release cached registration");
+                hg_bulk->cache_entries[i] = NULL;
+                hg_bulk->na_mem_handles[i] = NA_MEM_HANDLE_NULL;
+#ifdef HG_HAS_SM_ROUTING
+                if (hg_bulk->na_sm_mem_handles)
+                    hg_bulk->na_sm_mem_handles[i] = NA_MEM_HANDLE_NULL;
+#endif
+            }
+            free(hg_bulk->cache_entries);
+            hg_bulk->cache_entries = NULL;
+        }
+
         /* Unregister/free NA memory handles */
         if (hg_bulk->segment_published) {
             for (i = 0; i < hg_bulk->na_mem_handle_count; i++) {
@@ -771,13 +1004,387 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_pipeline_create(struct hg_bulk_op_id *hg_bulk_op_id,
+    const struct hg_bulk_pipeline_info *pipeline_info, na_bulk_op_t na_bulk_op,
+    na_addr_t origin_addr, na_uint8_t origin_id, hg_bool_t use_sm,
+    hg_size_t origin_segment_start_index, hg_size_t origin_segment_start_offset,
+    hg_size_t local_segment_start_index, hg_size_t local_segment_start_offset,
+    hg_size_t size, hg_bool_t scatter_gather)
+{
+    struct hg_bulk_pipeline *pipeline = NULL;
+    struct hg_bulk_chunk chunk;
+    unsigned int count = 0, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    pipeline =
+        (struct hg_bulk_pipeline *) malloc(sizeof(struct hg_bulk_pipeline));
+    HG_CHECK_ERROR(pipeline == NULL, error, ret, HG_NOMEM,
+        "Could not allocate bulk pipeline");
+    memset(pipeline, 0, sizeof(struct hg_bulk_pipeline));
+    hg_thread_spin_init(&pipeline->lock);
+    pipeline->cursor.origin_segment_index = origin_segment_start_index;
+    pipeline->cursor.origin_segment_offset = origin_segment_start_offset;
+    pipeline->cursor.local_segment_index = local_segment_start_index;
+    pipeline->cursor.local_segment_offset = local_segment_start_offset;
+    pipeline->na_bulk_op = na_bulk_op;
+    pipeline->origin_addr = origin_addr;
+    pipeline->chunk_cb = pipeline_info->chunk_cb;
+    pipeline->chunk_arg = pipeline_info->chunk_arg;
+    pipeline->chunk_size = pipeline_info->chunk_size;
+    pipeline->remaining_size = size;
+    pipeline->max_in_flight = pipeline_info->max_in_flight;
+    pipeline->retry = HG_BULK_CHUNK_NONE;
+    pipeline->ret = HG_SUCCESS;
+    pipeline->origin_id = origin_id;
+    pipeline->scatter_gather = scatter_gather;
+    pipeline->use_sm = use_sm;
+    hg_bulk_op_id->pipeline = pipeline;
+
+    /* One slot (chunk and NA operation ID) per chunk, at most max_in_flight
+     * + 1 so that the slot of a completing chunk, whose NA operation ID is
+     * only released once its callback returns, is never re-used from that
+     * callback */
+    while (pipeline->remaining_size &&
+           (!pipeline->max_in_flight || count <= pipeline->max_in_flight)) {
+        hg_bulk_pipeline_next(hg_bulk_op_id, &chunk);
+        count++;
+    }
+    pipeline->cursor.offset = 0;
+    pipeline->cursor.origin_segment_index = origin_segment_start_index;
+    pipeline->cursor.origin_segment_offset = origin_segment_start_offset;
+    pipeline->cursor.local_segment_index = local_segment_start_index;
+    pipeline->cursor.local_segment_offset = local_segment_start_offset;
+    pipeline->remaining_size = size;
+
+    pipeline->slot_count = count;
+    pipeline->chunks = (struct hg_bulk_chunk *) malloc(
+        count * sizeof(struct hg_bulk_chunk));
+    HG_CHECK_ERROR(pipeline->chunks == NULL, error, ret, HG_NOMEM,
+        "Could not allocate bulk chunks");
+    pipeline->free_slots =
+        (unsigned int *) malloc(count * sizeof(unsigned int));
+    HG_CHECK_ERROR(pipeline->free_slots == NULL, error, ret, HG_NOMEM,
+        "Could not allocate bulk chunk slots");
+    for (i = 0; i < count; i++)
+        pipeline->free_slots[i] = i;
+    pipeline->free_count = count;
+    hg_bulk_op_id->op_count = count;
+
+    return ret;
+
+error:
+    hg_bulk_pipeline_free(pipeline);
+    hg_bulk_op_id->pipeline = NULL;
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_pipeline_free(struct hg_bulk_pipeline *pipeline)
+{
+    if (!pipeline)
+        return;
+
+    hg_thread_spin_destroy(&pipeline->lock);
+    free(pipeline->free_slots);
+    free(pipeline->chunks);
+    free(pipeline);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_pipeline_next(
+    struct hg_bulk_op_id *hg_bulk_op_id, struct hg_bulk_chunk *chunk)
+{
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+    struct hg_bulk *hg_bulk_origin = hg_bulk_op_id->hg_bulk_origin;
+    struct hg_bulk *hg_bulk_local = hg_bulk_op_id->hg_bulk_local;
+    struct hg_bulk_chunk *cursor = &pipeline->cursor;
+    hg_size_t transfer_size = pipeline->remaining_size;
+
+    if (!pipeline->scatter_gather) {
+        /* Can only transfer smallest size */
+        hg_size_t origin_transfer_size =
+            hg_bulk_origin->segments[cursor->origin_segment_index].size -
+            cursor->origin_segment_offset;
+        hg_size_t local_transfer_size =
+            hg_bulk_local->segments[cursor->local_segment_index].size -
+            cursor->local_segment_offset;
+
+        transfer_size = HG_BULK_MIN(transfer_size, origin_transfer_size);
+        transfer_size = HG_BULK_MIN(transfer_size, local_transfer_size);
+    }
+
+    /* Chunk size may be smaller */
+    if (pipeline->chunk_size)
+        transfer_size = HG_BULK_MIN(transfer_size, pipeline->chunk_size);
+
+    *chunk = *cursor;
+    chunk->hg_bulk_op_id = hg_bulk_op_id;
+    chunk->size = transfer_size;
+
+    /* Increment offsets from the size of data we transferred */
+    pipeline->remaining_size -= transfer_size;
+    cursor->offset += transfer_size;
+    cursor->origin_segment_offset += transfer_size;
+    cursor->local_segment_offset += transfer_size;
+    if (pipeline->scatter_gather || !pipeline->remaining_size)
+        return;
+
+    /* Change segment if new offset reaches segment size, skip empty ones */
+    while (cursor->origin_segment_offset >=
+               hg_bulk_origin->segments[cursor->origin_segment_index].size &&
+           cursor->origin_segment_index + 1 < hg_bulk_origin->segment_count) {
+        cursor->origin_segment_index++;
+        cursor->origin_segment_offset = 0;
+    }
+    while (cursor->local_segment_offset >=
+               hg_bulk_local->segments[cursor->local_segment_index].size &&
+           cursor->local_segment_index + 1 < hg_bulk_local->segment_count) {
+        cursor->local_segment_index++;
+        cursor->local_segment_offset = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_bulk_pipeline_slot_get(
+    struct hg_bulk_pipeline *pipeline, unsigned int busy_slot)
+{
+    unsigned int slot = pipeline->free_slots[pipeline->free_head];
+
+    pipeline->free_head = (pipeline->free_head + 1) % pipeline->slot_count;
+    pipeline->free_count--;
+
+    /* Window is not full so there is always another free slot */
+    if (slot == busy_slot) {
+        hg_bulk_pipeline_slot_put(pipeline, slot);
+        slot = pipeline->free_slots[pipeline->free_head];
+        pipeline->free_head = (pipeline->free_head + 1) % pipeline->slot_count;
+        pipeline->free_count--;
+    }
+
+    return slot;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_bulk_pipeline_slot_put(struct hg_bulk_pipeline *pipeline, unsigned int slot)
+{
+    pipeline->free_slots[(pipeline->free_head + pipeline->free_count) %
+                         pipeline->slot_count] = slot;
+    pipeline->free_count++;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_bool_t
+hg_bulk_pipeline_can_issue(struct hg_bulk_op_id *hg_bulk_op_id)
+{
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+
+    return (pipeline->ret == HG_SUCCESS &&
+               !hg_atomic_get32(&hg_bulk_op_id->canceled) &&
+               (!pipeline->max_in_flight ||
+                   pipeline->in_flight < pipeline->max_in_flight) &&
+               (pipeline->retry != HG_BULK_CHUNK_NONE ||
+                   pipeline->remaining_size > 0))
+               ? HG_TRUE
+               : HG_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_bool_t
+hg_bulk_pipeline_finish(struct hg_bulk_op_id *hg_bulk_op_id)
+{
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+
+    if (pipeline->finished || pipeline->in_flight > 0)
+        return HG_FALSE;
+
+    /* Stop on error or cancelation once nothing is in flight */
+    if (pipeline->ret == HG_SUCCESS &&
+        !hg_atomic_get32(&hg_bulk_op_id->canceled) &&
+        (pipeline->remaining_size > 0 ||
+            pipeline->retry != HG_BULK_CHUNK_NONE))
+        return HG_FALSE;
+
+    pipeline->finished = HG_TRUE;
+
+    return HG_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+hg_bulk_pipeline_post(struct hg_bulk_op_id *hg_bulk_op_id, unsigned int index)
+{
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+    struct hg_bulk_chunk *chunk = &pipeline->chunks[index];
+    struct hg_bulk *hg_bulk_origin = hg_bulk_op_id->hg_bulk_origin;
+    struct hg_bulk *hg_bulk_local = hg_bulk_op_id->hg_bulk_local;
+    na_mem_handle_t *na_origin_mem_handles =
+#ifdef HG_HAS_SM_ROUTING
+        pipeline->use_sm ? hg_bulk_origin->na_sm_mem_handles :
+#endif
+                         hg_bulk_origin->na_mem_handles;
+    na_mem_handle_t *na_local_mem_handles =
+#ifdef HG_HAS_SM_ROUTING
+        pipeline->use_sm ? hg_bulk_local->na_sm_mem_handles :
+#endif
+                         hg_bulk_local->na_mem_handles;
+    hg_size_t na_origin_segment_index = hg_bulk_origin->na_mem_handle_count > 1
+                                            ? chunk->origin_segment_index
+                                            : 0;
+    hg_size_t na_local_segment_index = hg_bulk_local->na_mem_handle_count > 1
+                                           ? chunk->local_segment_index
+                                           : 0;
+
+    return pipeline->na_bulk_op(hg_bulk_op_id->na_class,
+        hg_bulk_op_id->na_context, hg_bulk_pipeline_cb, chunk,
+        na_local_mem_handles[na_local_segment_index],
+        hg_bulk_local->segments[chunk->local_segment_index].address,
+        chunk->local_segment_offset,
+        na_origin_mem_handles[na_origin_segment_index],
+        hg_bulk_origin->segments[chunk->origin_segment_index].address,
+        chunk->origin_segment_offset, chunk->size, pipeline->origin_addr,
+        pipeline->origin_id, &hg_bulk_op_id->na_op_ids[index]);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_pipeline_pump(
+    struct hg_bulk_op_id *hg_bulk_op_id, unsigned int busy_slot)
+{
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+    hg_bool_t finished = HG_FALSE;
+    hg_return_t ret = HG_SUCCESS;
+
+    for (;;) {
+        unsigned int index;
+        na_return_t na_ret;
+
+        hg_thread_spin_lock(&pipeline->lock);
+        if (!hg_bulk_pipeline_can_issue(hg_bulk_op_id)) {
+            pipeline->pumping = HG_FALSE;
+            finished = hg_bulk_pipeline_finish(hg_bulk_op_id);
+            hg_thread_spin_unlock(&pipeline->lock);
+            break;
+        }
+        if (pipeline->retry != HG_BULK_CHUNK_NONE) {
+            index = pipeline->retry;
+            pipeline->retry = HG_BULK_CHUNK_NONE;
+        } else {
+            index = hg_bulk_pipeline_slot_get(pipeline, busy_slot);
+            hg_bulk_pipeline_next(hg_bulk_op_id, &pipeline->chunks[index]);
+        }
+        pipeline->in_flight++;
+        hg_thread_spin_unlock(&pipeline->lock);
+
+        /* Lock is not held while posting as callback may be called inline */
+        na_ret = hg_bulk_pipeline_post(hg_bulk_op_id, index);
+
+        hg_thread_spin_lock(&pipeline->lock);
+        if (na_ret == NA_SUCCESS) {
+            pipeline->started++;
+            hg_thread_spin_unlock(&pipeline->lock);
+            continue;
+        }
+        pipeline->in_flight--;
+
+        /* Release slot unless chunk is issued again (see below) */
+        if (na_ret != NA_AGAIN || pipeline->in_flight == 0)
+            hg_bulk_pipeline_slot_put(pipeline, index);
+
+        if (!pipeline->started) {
+            /* Nothing was posted, let caller handle the error */
+            pipeline->pumping = HG_FALSE;
+            hg_thread_spin_unlock(&pipeline->lock);
+            if (na_ret == NA_AGAIN)
+                HG_GOTO_DONE(done, ret, HG_AGAIN);
+            HG_GOTO_ERROR(done, ret, (hg_return_t) na_ret,
+                "Could not transfer data (%s)", NA_Error_to_string(na_ret));
+        }
+
+        if (na_ret == NA_AGAIN && pipeline->in_flight > 0) {
+            /* Issue chunk again once one of the chunks in flight completes */
+            pipeline->retry = index;
+            pipeline->pumping = HG_FALSE;
+            hg_thread_spin_unlock(&pipeline->lock);
+            break;
+        }
+
+        /* Stop issuing, transfer completes with error once drained */
+        HG_LOG_ERROR(
+            "Could not transfer data (%s)", NA_Error_to_string(na_ret));
+        if (pipeline->ret == HG_SUCCESS)
+            pipeline->ret = (hg_return_t) na_ret;
+        hg_thread_spin_unlock(&pipeline->lock);
+    }
+
+    if (finished)
+        hg_bulk_complete(hg_bulk_op_id);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bulk_pipeline_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_bulk_chunk *chunk = (struct hg_bulk_chunk *) callback_info->arg;
+    struct hg_bulk_op_id *hg_bulk_op_id = chunk->hg_bulk_op_id;
+    struct hg_bulk_pipeline *pipeline = hg_bulk_op_id->pipeline;
+    unsigned int slot = (unsigned int) (chunk - pipeline->chunks);
+    hg_bool_t pump = HG_FALSE, finished = HG_FALSE;
+    int ret = 0;
+
+    /* Notify chunk completion, if canceled, mark handle as canceled */
+    if (callback_info->ret == NA_SUCCESS) {
+        if (pipeline->chunk_cb)
+            pipeline->chunk_cb(pipeline->chunk_arg, chunk->offset, chunk->size);
+    } else if (callback_info->ret == NA_CANCELED)
+        hg_atomic_cas32(&hg_bulk_op_id->canceled, 0, 1);
+    else
+        HG_LOG_ERROR("Error in NA callback (%s)",
+            NA_Error_to_string(callback_info->ret));
+
+    hg_thread_spin_lock(&pipeline->lock);
+    hg_bulk_pipeline_slot_put(pipeline, slot);
+    pipeline->in_flight--;
+    if (callback_info->ret != NA_SUCCESS &&
+        callback_info->ret != NA_CANCELED && pipeline->ret == HG_SUCCESS)
+        pipeline->ret = (hg_return_t) callback_info->ret;
+
+    /* If nobody is issuing chunks, refill window or finish transfer */
+    if (!pipeline->pumping) {
+        if (hg_bulk_pipeline_can_issue(hg_bulk_op_id))
+            pump = pipeline->pumping = HG_TRUE;
+        else
+            finished = hg_bulk_pipeline_finish(hg_bulk_op_id);
+    }
+    hg_thread_spin_unlock(&pipeline->lock);
+
+    /* NA operation ID of this chunk is only released once we return */
+    if (pump)
+        hg_bulk_pipeline_pump(hg_bulk_op_id, slot);
+    else if (finished) {
+        hg_bulk_complete(hg_bulk_op_id);
+        ret++;
+    }
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_bulk_op_t op, struct hg_addr *origin_addr, hg_uint8_t origin_id,
     struct hg_bulk *hg_bulk_origin, hg_size_t origin_offset,
     struct hg_bulk *hg_bulk_local, hg_size_t local_offset, hg_size_t size,
-    hg_op_id_t *op_id)
+    const struct hg_bulk_pipeline_info *pipeline_info, hg_op_id_t *op_id)
 {
     hg_uint32_t origin_segment_start_index = 0, local_segment_start_index = 0;
     hg_size_t origin_segment_start_offset = origin_offset,
@@ -801,7 +1408,6 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
         (na_class->ops->mem_handle_create_segments && !is_self) ? HG_TRUE
                                                                 : HG_FALSE;
     hg_return_t ret = HG_SUCCESS;
-    unsigned int i;
 
     /* Map op to NA op */
     switch (op) {
@@ -821,8 +1427,7 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     }
 
     /* Allocate op_id */
-    hg_bulk_op_id =
-        (struct hg_bulk_op_id *) malloc(sizeof(struct hg_bulk_op_id));
+    hg_bulk_op_id = hg_bulk_op_create(context->bulk_op_pool);
     HG_CHECK_ERROR(hg_bulk_op_id == NULL, error, ret, HG_NOMEM,
         "Could not allocate HG Bulk operation ID");
 
@@ -850,8 +1455,10 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_atomic_incr32(&hg_bulk_origin->ref_count); /* Increment ref count */
     hg_bulk_op_id->hg_bulk_local = hg_bulk_local;
     hg_atomic_incr32(&hg_bulk_local->ref_count); /* Increment ref count */
-    hg_bulk_op_id->na_op_ids = NULL;
     hg_bulk_op_id->is_self = is_self;
+    hg_bulk_op_id->pipeline = NULL;
+    hg_bulk_op_id->trace_id = HG_TRACE_ENABLED() ? hg_trace_id_gen() : 0;
+    HG_TRACE(HG_TRACE_BULK_TRANSFER, hg_bulk_op_id->trace_id, size);
 
     /* Translate bulk_offset */
     if (origin_offset && !scatter_gather)
@@ -864,7 +1471,13 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
             &local_segment_start_index, &local_segment_start_offset);
 
     /* Figure out number of NA operations required */
-    if (!scatter_gather) {
+    if (pipeline_info) {
+        ret = hg_bulk_pipeline_create(hg_bulk_op_id, pipeline_info, na_bulk_op,
+            na_origin_addr, origin_id, use_sm, origin_segment_start_index,
+            origin_segment_start_offset, local_segment_start_index,
+            local_segment_start_offset, size, scatter_gather);
+        HG_CHECK_HG_ERROR(error, ret, "Could not create bulk pipeline");
+    } else if (!scatter_gather) {
         ret = hg_bulk_transfer_pieces(NULL, NA_ADDR_NULL, origin_id, use_sm,
             hg_bulk_origin, origin_segment_start_index,
             origin_segment_start_offset, hg_bulk_local,
@@ -875,23 +1488,20 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
             "Could not get bulk op_count");
     }
 
-    /* Allocate memory for NA operation IDs */
-    hg_bulk_op_id->na_op_ids =
-        malloc(sizeof(na_op_id_t) * hg_bulk_op_id->op_count);
-    HG_CHECK_ERROR(hg_bulk_op_id->na_op_ids == NULL, error, ret, HG_NOMEM,
-        "Could not allocate memory for op_ids");
-
-    for (i = 0; i < hg_bulk_op_id->op_count; i++) {
-        hg_bulk_op_id->na_op_ids[i] = NA_Op_create(hg_bulk_op_id->na_class);
-        HG_CHECK_ERROR(hg_bulk_op_id->na_op_ids[i] == NA_OP_ID_NULL, error, ret,
-            HG_NA_ERROR, "Could not create NA op ID");
-    }
+    /* Create NA operation IDs, cached operations may already have them */
+    ret = hg_bulk_op_reserve_na(hg_bulk_op_id, hg_bulk_op_id->op_count);
+    HG_CHECK_HG_ERROR(error, ret, "Could not create NA op IDs");
 
     /* Do actual transfer */
-    ret = hg_bulk_transfer_pieces(na_bulk_op, na_origin_addr, origin_id, use_sm,
-        hg_bulk_origin, origin_segment_start_index, origin_segment_start_offset,
-        hg_bulk_local, local_segment_start_index, local_segment_start_offset,
-        size, scatter_gather, hg_bulk_op_id, NULL);
+    if (hg_bulk_op_id->pipeline) {
+        hg_bulk_op_id->pipeline->pumping = HG_TRUE;
+        ret = hg_bulk_pipeline_pump(hg_bulk_op_id, HG_BULK_CHUNK_NONE);
+    } else
+        ret = hg_bulk_transfer_pieces(na_bulk_op, na_origin_addr, origin_id,
+            use_sm, hg_bulk_origin, origin_segment_start_index,
+            origin_segment_start_offset, hg_bulk_local,
+            local_segment_start_index, local_segment_start_offset, size,
+            scatter_gather, hg_bulk_op_id, NULL);
     if (ret == HG_AGAIN)
         goto error;
     HG_CHECK_HG_ERROR(error, ret, "Could not transfer data pieces");
@@ -904,12 +1514,195 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
 
 error:
     if (hg_bulk_op_id) {
+        hg_atomic_decr32(&hg_bulk_origin->ref_count);
+        hg_atomic_decr32(&hg_bulk_local->ref_count);
+        hg_bulk_pipeline_free(hg_bulk_op_id->pipeline);
+        hg_bulk_op_release(hg_bulk_op_id);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_bulk_op_id *
+hg_bulk_op_create(struct hg_bulk_op_pool *hg_bulk_op_pool)
+{
+    struct hg_bulk_op_id *hg_bulk_op_id = NULL;
+
+    /* Re-use operation and its NA operation IDs if one is available */
+    if (hg_bulk_op_pool) {
+        hg_bulk_op_id = (struct hg_bulk_op_id *) hg_atomic_queue_pop_mc(
+            hg_bulk_op_pool->free_list);
+        if (hg_bulk_op_id) {
+            hg_atomic_decr32(&hg_bulk_op_pool->count);
+            hg_bulk_stat_incr(&hg_bulk_op_pool->hit_count);
+            return hg_bulk_op_id;
+        }
+        hg_bulk_stat_incr(&hg_bulk_op_pool->miss_count);
+    }
+
+    hg_bulk_op_id =
+        (struct hg_bulk_op_id *) malloc(sizeof(struct hg_bulk_op_id));
+    HG_CHECK_ERROR_NORET(hg_bulk_op_id == NULL, done,
+        "Could not allocate HG Bulk operation ID");
+    memset(hg_bulk_op_id, 0, sizeof(struct hg_bulk_op_id));
+    hg_bulk_op_id->na_op_ids = hg_bulk_op_id->na_op_ids_inline;
+    hg_bulk_op_id->pool = hg_bulk_op_pool;
+
+done:
+    return hg_bulk_op_id;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_op_reserve_na(struct hg_bulk_op_id *hg_bulk_op_id, unsigned int count)
+{
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    /* NA operation IDs cannot be used with another NA class */
+    if (hg_bulk_op_id->na_op_class != hg_bulk_op_id->na_class) {
+        ret = hg_bulk_op_free_na(hg_bulk_op_id);
+        HG_CHECK_HG_ERROR(done, ret, "Could not free NA op IDs");
+        hg_bulk_op_id->na_op_class = hg_bulk_op_id->na_class;
+    }
+
+    if (count <= hg_bulk_op_id->na_op_id_count)
+        goto done;
+
+    /* Move to heap once inline storage is too small */
+    if (count > HG_BULK_OP_INLINE_COUNT) {
+        na_op_id_t *na_op_ids;
+
+        if (hg_bulk_op_id->na_op_ids == hg_bulk_op_id->na_op_ids_inline) {
+            na_op_ids = (na_op_id_t *) malloc(count * sizeof(na_op_id_t));
+            HG_CHECK_ERROR(na_op_ids == NULL, done, ret, HG_NOMEM,
+                "Could not allocate memory for op_ids");
+            memcpy(na_op_ids, hg_bulk_op_id->na_op_ids_inline,
+                hg_bulk_op_id->na_op_id_count * sizeof(na_op_id_t));
+        } else {
+            na_op_ids = (na_op_id_t *) realloc(
+                hg_bulk_op_id->na_op_ids, count * sizeof(na_op_id_t));
+            HG_CHECK_ERROR(na_op_ids == NULL, done, ret, HG_NOMEM,
+                "Could not allocate memory for op_ids");
+        }
+        hg_bulk_op_id->na_op_ids = na_op_ids;
+    }
+
+    for (i = hg_bulk_op_id->na_op_id_count; i < count; i++) {
+        hg_bulk_op_id->na_op_ids[i] = NA_Op_create(hg_bulk_op_id->na_class);
+        HG_CHECK_ERROR(hg_bulk_op_id->na_op_ids[i] == NA_OP_ID_NULL, done, ret,
+            HG_NA_ERROR, "Could not create NA op ID");
+        hg_bulk_op_id->na_op_id_count++;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_op_free_na(struct hg_bulk_op_id *hg_bulk_op_id)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    while (hg_bulk_op_id->na_op_id_count > 0) {
+        na_return_t na_ret = NA_Op_destroy(hg_bulk_op_id->na_op_class,
+            hg_bulk_op_id->na_op_ids[hg_bulk_op_id->na_op_id_count - 1]);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "Could not destroy NA op ID (%s)", NA_Error_to_string(na_ret));
+        hg_bulk_op_id->na_op_id_count--;
+    }
+
+    if (hg_bulk_op_id->na_op_ids != hg_bulk_op_id->na_op_ids_inline) {
         free(hg_bulk_op_id->na_op_ids);
-        free(hg_bulk_op_id);
+        hg_bulk_op_id->na_op_ids = hg_bulk_op_id->na_op_ids_inline;
     }
+
+done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_op_release(struct hg_bulk_op_id *hg_bulk_op_id)
+{
+    struct hg_bulk_op_pool *hg_bulk_op_pool = hg_bulk_op_id->pool;
+
+    hg_bulk_op_id->pipeline = NULL;
+
+    /* Reserve slot */
+    if (hg_bulk_op_pool) {
+        if (hg_atomic_incr32(&hg_bulk_op_pool->count) <=
+                (hg_util_int32_t) hg_bulk_op_pool->max_count &&
+            hg_atomic_queue_push(hg_bulk_op_pool->free_list, hg_bulk_op_id) ==
+                HG_UTIL_SUCCESS)
+            return;
+        hg_atomic_decr32(&hg_bulk_op_pool->count);
+    }
+
+    hg_bulk_op_free(hg_bulk_op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_op_free(struct hg_bulk_op_id *hg_bulk_op_id)
+{
+    hg_return_t ret = hg_bulk_op_free_na(hg_bulk_op_id);
+
+    HG_CHECK_ERROR_DONE(ret != HG_SUCCESS, "Could not free NA op IDs");
+    free(hg_bulk_op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+struct hg_bulk_op_pool *
+hg_bulk_op_pool_create(unsigned int max_count)
+{
+    struct hg_bulk_op_pool *hg_bulk_op_pool = NULL;
+    unsigned int queue_size = 2;
+
+    hg_bulk_op_pool =
+        (struct hg_bulk_op_pool *) malloc(sizeof(struct hg_bulk_op_pool));
+    HG_CHECK_ERROR_NORET(hg_bulk_op_pool == NULL, error,
+        "Could not allocate bulk operation pool");
+    memset(hg_bulk_op_pool, 0, sizeof(struct hg_bulk_op_pool));
+
+    /* Atomic queue keeps one slot empty, make sure it holds max_count */
+    while (queue_size <= max_count)
+        queue_size <<= 1;
+    hg_bulk_op_pool->free_list = hg_atomic_queue_alloc(queue_size);
+    HG_CHECK_ERROR_NORET(hg_bulk_op_pool->free_list == NULL, error,
+        "Could not allocate bulk operation pool free list");
+
+    hg_atomic_init32(&hg_bulk_op_pool->count, 0);
+    hg_bulk_op_pool->max_count = max_count;
+    hg_bulk_stat_init(&hg_bulk_op_pool->hit_count, 0);
+    hg_bulk_stat_init(&hg_bulk_op_pool->miss_count, 0);
+
+    return hg_bulk_op_pool;
+
+error:
+    free(hg_bulk_op_pool);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bulk_op_pool_destroy(struct hg_bulk_op_pool *hg_bulk_op_pool)
+{
+    struct hg_bulk_op_id *hg_bulk_op_id;
+
+    if (!hg_bulk_op_pool)
+        return;
+
+    /* Free cached operations and their NA operation IDs */
+    while ((hg_bulk_op_id = (struct hg_bulk_op_id *) hg_atomic_queue_pop_mc(
+                hg_bulk_op_pool->free_list)))
+        hg_bulk_op_free(hg_bulk_op_id);
+
+    hg_atomic_queue_free(hg_bulk_op_pool->free_list);
+    free(hg_bulk_op_pool);
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_bulk_complete(struct hg_bulk_op_id *hg_bulk_op_id)
@@ -919,6 +1712,8 @@ hg_bulk_complete(struct hg_bulk_op_id *hg_bulk_op_id)
 
     /* Mark operation as completed */
     hg_atomic_incr32(&hg_bulk_op_id->completed);
+    HG_TRACE(
+        HG_TRACE_BULK_COMPLETE, hg_bulk_op_id->trace_id, hg_bulk_op_id->op);
 
     if (hg_bulk_op_id->hg_bulk_origin->eager_mode) {
         /* In the case of eager bulk transfer, directly trigger the operation
@@ -947,15 +1742,18 @@ hg_return_t
 hg_bulk_trigger_entry(struct hg_bulk_op_id *hg_bulk_op_id)
 {
     hg_return_t ret = HG_SUCCESS;
-    unsigned int i;
 
     /* Execute callback */
     if (hg_bulk_op_id->callback) {
         struct hg_cb_info hg_cb_info;
 
         hg_cb_info.arg = hg_bulk_op_id->arg;
-        hg_cb_info.ret = hg_atomic_get32(&hg_bulk_op_id->canceled) ? HG_CANCELED
-                                                                   : HG_SUCCESS;
+        if (hg_atomic_get32(&hg_bulk_op_id->canceled))
+            hg_cb_info.ret = HG_CANCELED;
+        else if (hg_bulk_op_id->pipeline)
+            hg_cb_info.ret = hg_bulk_op_id->pipeline->ret;
+        else
+            hg_cb_info.ret = HG_SUCCESS;
         hg_cb_info.type = HG_CB_BULK;
         hg_cb_info.info.bulk.op = hg_bulk_op_id->op;
         hg_cb_info.info.bulk.origin_handle =
@@ -973,15 +1771,9 @@ hg_bulk_trigger_entry(struct hg_bulk_op_id *hg_bulk_op_id)
     ret = hg_bulk_free(hg_bulk_op_id->hg_bulk_local);
     HG_CHECK_HG_ERROR(done, ret, "Could not free bulk handle");
 
-    /* Free op */
-    for (i = 0; i < hg_bulk_op_id->op_count; i++) {
-        na_return_t na_ret =
-            NA_Op_destroy(hg_bulk_op_id->na_class, hg_bulk_op_id->na_op_ids[i]);
-        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
-            "Could not destroy NA op ID (%s)", NA_Error_to_string(na_ret));
-    }
-    free(hg_bulk_op_id->na_op_ids);
-    free(hg_bulk_op_id);
+    /* Release op, NA op IDs are kept if op is cached */
+    hg_bulk_pipeline_free(hg_bulk_op_id->pipeline);
+    hg_bulk_op_release(hg_bulk_op_id);
 
 done:
     return ret;
@@ -1012,7 +1804,27 @@ HG_Bulk_create(hg_class_t *hg_class, hg_uint32_t count, void **buf_ptrs,
                 done, ret, HG_INVALID_ARG, "Unrecognized handle flag");
     }
 
-    ret = hg_bulk_create(hg_class, count, buf_ptrs, buf_sizes, flags, &hg_bulk);
+    ret = hg_bulk_create(
+        hg_class, count, buf_ptrs, buf_sizes, flags, HG_TRUE, &hg_bulk);
+    HG_CHECK_HG_ERROR(done, ret, "Could not create bulk handle");
+
+    *handle = (hg_bulk_t) hg_bulk;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_create_uncached(hg_class_t *hg_class, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes, hg_uint8_t flags,
+    hg_bulk_t *handle)
+{
+    struct hg_bulk *hg_bulk = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = hg_bulk_create(
+        hg_class, count, buf_ptrs, buf_sizes, flags, HG_FALSE, &hg_bulk);
     HG_CHECK_HG_ERROR(done, ret, "Could not create bulk handle");
 
     *handle = (hg_bulk_t) hg_bulk;
@@ -1055,6 +1867,142 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+void *
+HG_Bulk_buf_alloc(hg_class_t *hg_class, hg_size_t size, void **buf_data)
+{
+    na_class_t *na_class;
+    void *ret = NULL;
+
+    HG_CHECK_ERROR_NORET(hg_class == NULL, done, "NULL HG class");
+    HG_CHECK_ERROR_NORET(buf_data == NULL, done, "NULL pointer to buf data");
+
+    /* Use SM class when available so that memory can be shared locally */
+#ifdef HG_HAS_SM_ROUTING
+    na_class = HG_Core_class_get_na_sm(hg_class->core_class);
+    if (!na_class)
+        na_class = HG_Core_class_get_na(hg_class->core_class);
+#else
+    na_class = HG_Core_class_get_na(hg_class->core_class);
+#endif
+
+    ret = NA_Mem_alloc(na_class, (na_size_t) size, buf_data);
+    HG_CHECK_ERROR_NORET(
+        ret == NULL, done, "Could not allocate %zu bytes", (size_t) size);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Bulk_buf_free(
+    hg_class_t *hg_class, void *buf, hg_size_t size, void *buf_data)
+{
+    na_class_t *na_class;
+    hg_return_t ret = HG_SUCCESS;
+    na_return_t na_ret;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+    HG_CHECK_ERROR(buf == NULL, done, ret, HG_INVALID_ARG, "NULL buffer");
+
+    /* Registrations of that memory can no longer be reused */
+    if (hg_class->core_class->bulk_cache) {
+        ret = hg_bulk_cache_invalidate(
+            hg_class->core_class->bulk_cache, buf, size);
+        HG_CHECK_HG_ERROR(
+            done, ret, "Could not invalidate cached registrations");
+    }
+
+#ifdef HG_HAS_SM_ROUTING
+    na_class = HG_Core_class_get_na_sm(hg_class->core_class);
+    if (!na_class)
+        na_class = HG_Core_class_get_na(hg_class->core_class);
+#else
+    na_class = HG_Core_class_get_na(hg_class->core_class);
+#endif
+
+    na_ret = NA_Mem_free(na_class, buf, buf_data);
+    HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+        "Could not free memory (%s)", NA_Error_to_string(na_ret));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Bulk_cache_invalidate(hg_class_t *hg_class, void *buf, hg_size_t size)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+
+    /* Nothing to do if no cache */
+    if (!hg_class->core_class->bulk_cache)
+        goto done;
+
+    ret = hg_bulk_cache_invalidate(
+        hg_class->core_class->bulk_cache, buf, size);
+    HG_CHECK_HG_ERROR(done, ret, "Could not invalidate cached registrations");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Bulk_op_pool_get_stats(
+    const hg_context_t *context, hg_uint64_t *hits, hg_uint64_t *misses)
+{
+    hg_uint64_t hit_count = 0, miss_count = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG context");
+
+    if (context->bulk_op_pool) {
+        hit_count =
+            (hg_uint64_t) hg_bulk_stat_get(&context->bulk_op_pool->hit_count);
+        miss_count =
+            (hg_uint64_t) hg_bulk_stat_get(&context->bulk_op_pool->miss_count);
+    }
+
+    if (hits)
+        *hits = hit_count;
+    if (misses)
+        *misses = miss_count;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Bulk_cache_get_stats(
+    hg_class_t *hg_class, hg_uint64_t *hits, hg_uint64_t *misses)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
+
+    if (hg_class->core_class->bulk_cache)
+        hg_bulk_cache_get_stats(
+            hg_class->core_class->bulk_cache, hits, misses);
+    else {
+        if (hits)
+            *hits = 0;
+        if (misses)
+            *misses = 0;
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Bulk_bind(hg_bulk_t handle, hg_context_t *context)
@@ -1248,7 +2196,9 @@ HG_Bulk_serialize(
     /* Publish handle at this point if not published yet */
     if (!hg_bulk->segment_published) {
         for (i = 0; i < hg_bulk->na_mem_handle_count; i++) {
-            if (!hg_bulk->na_mem_handles[i])
+            /* Cached registrations are already published */
+            if (!hg_bulk->na_mem_handles[i] ||
+                (hg_bulk->cache_entries && hg_bulk->cache_entries[i]))
                 continue;
 
             na_ret = NA_Mem_publish(na_class, hg_bulk->na_mem_handles[i]);
@@ -1689,6 +2639,19 @@ HG_Bulk_transfer_id(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_bulk_op_t op, hg_addr_t origin_addr, hg_uint8_t origin_id,
     hg_bulk_t origin_handle, hg_size_t origin_offset, hg_bulk_t local_handle,
     hg_size_t local_offset, hg_size_t size, hg_op_id_t *op_id)
+{
+    return HG_Bulk_transfer_pipeline(context, callback, arg, op, origin_addr,
+        origin_id, origin_handle, origin_offset, local_handle, local_offset,
+        size, NULL, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Bulk_transfer_pipeline(hg_context_t *context, hg_cb_t callback, void *arg,
+    hg_bulk_op_t op, hg_addr_t origin_addr, hg_uint8_t origin_id,
+    hg_bulk_t origin_handle, hg_size_t origin_offset, hg_bulk_t local_handle,
+    hg_size_t local_offset, hg_size_t size,
+    const struct hg_bulk_pipeline_info *pipeline_info, hg_op_id_t *op_id)
 {
     struct hg_bulk *hg_bulk_origin = (struct hg_bulk *) origin_handle;
     struct hg_bulk *hg_bulk_local = (struct hg_bulk *) local_handle;
@@ -1736,7 +2699,7 @@ HG_Bulk_transfer_id(hg_context_t *context, hg_cb_t callback, void *arg,
 
     ret = hg_bulk_transfer(context, callback, arg, op, origin_addr, origin_id,
         hg_bulk_origin, origin_offset, hg_bulk_local, local_offset, size,
-        op_id);
+        pipeline_info, op_id);
     if (ret == HG_AGAIN)
         goto done;
     HG_CHECK_HG_ERROR(done, ret, "Could not start transfer of bulk data");
@@ -1758,6 +2721,10 @@ HG_Bulk_cancel(hg_op_id_t op_id)
     if (HG_UTIL_TRUE != hg_atomic_cas32(&hg_bulk_op_id->completed, 1, 0)) {
         unsigned int i = 0;
 
+        /* Stop issuing chunks of pipelined transfer */
+        if (hg_bulk_op_id->pipeline)
+            hg_atomic_cas32(&hg_bulk_op_id->canceled, 0, 1);
+
         /* Cancel all NA operations issued */
         for (i = 0; i < hg_bulk_op_id->op_count; i++) {
             na_return_t na_ret = NA_Cancel(hg_bulk_op_id->na_class,
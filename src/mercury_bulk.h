@@ -17,6 +17,18 @@
 /* Public Type and Struct Definition */
 /*************************************/
 
+/* Callback executed when a chunk of a pipelined transfer completes, offset
+ * is relative to the start of the transfer */
+typedef void (*hg_bulk_chunk_cb_t)(void *arg, hg_size_t offset, hg_size_t size);
+
+/* Pipelined transfer info */
+struct hg_bulk_pipeline_info {
+    hg_size_t chunk_size;        /* Max size of NA transfers (0: no limit) */
+    unsigned int max_in_flight;  /* Max NA transfers in flight (0: no limit) */
+    hg_bulk_chunk_cb_t chunk_cb; /* Chunk callback (may be NULL) */
+    void *chunk_arg;             /* Chunk callback argument */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -38,6 +50,8 @@ extern "C" {
 /**
  * Create an abstract bulk handle from specified memory segments.
  * Memory allocated is then freed when HG_Bulk_free() is called.
+ * \remark If a registration cache was requested at init time, registrations
+ * of user memory are reused across calls, see HG_Bulk_cache_invalidate().
  * \remark If NULL is passed to buf_ptrs, i.e.,
  * \verbatim HG_Bulk_create(count, NULL, buf_sizes, flags, &handle) \endverbatim
  * memory for the missing buf_ptrs array will be internally allocated.
@@ -78,6 +92,83 @@ HG_Bulk_free(hg_bulk_t handle);
 HG_PUBLIC hg_return_t
 HG_Bulk_ref_incr(hg_bulk_t handle);
 
+/**
+ * Allocate size bytes of memory suitable for bulk transfers. When the
+ * underlying NA plugin supports it (e.g., "na+sm"), the memory is shared
+ * with local peers, which map it once and then access bulk handles created
+ * on that memory with plain memory copies, without per-transfer system
+ * calls. Other plugins return page-aligned memory.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param size [IN]             size of memory
+ * \param buf_data [OUT]        pointer to internal allocation data
+ *
+ * \return Pointer to allocated memory or NULL in case of failure
+ */
+HG_PUBLIC void *
+HG_Bulk_buf_alloc(hg_class_t *hg_class, hg_size_t size, void **buf_data);
+
+/**
+ * Free memory allocated with HG_Bulk_buf_alloc(). Bulk handles created on
+ * that memory must be freed first, cached registrations of that memory are
+ * dropped.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param buf [IN]              pointer to memory
+ * \param size [IN]             size of memory
+ * \param buf_data [IN]         internal allocation data
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Bulk_buf_free(
+    hg_class_t *hg_class, void *buf, hg_size_t size, void *buf_data);
+
+/**
+ * Drop cached registrations of memory overlapping [buf, buf + size). When
+ * a registration cache is used (see hg_init_info bulk_cache_size), memory
+ * registered through HG_Bulk_create() remains registered after the bulk
+ * handle is freed, this must therefore be called before that memory is freed
+ * or unmapped. Registrations still used by bulk handles are released once
+ * these handles are freed.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param buf [IN]              pointer to memory
+ * \param size [IN]             size of memory
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Bulk_cache_invalidate(hg_class_t *hg_class, void *buf, hg_size_t size);
+
+/**
+ * Get number of registration cache hits and misses since HG_Init().
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param hits [OUT]            pointer to number of hits
+ * \param misses [OUT]          pointer to number of misses
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Bulk_cache_get_stats(
+    hg_class_t *hg_class, hg_uint64_t *hits, hg_uint64_t *misses);
+
+/**
+ * Get number of bulk operations re-used from the context's operation pool
+ * (hits) and allocated from scratch (misses). The pool is enabled by setting
+ * bulk_op_pool_size in hg_init_info, counts are zero otherwise.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param hits [OUT]            pointer to number of hits
+ * \param misses [OUT]          pointer to number of misses
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Bulk_op_pool_get_stats(
+    const hg_context_t *context, hg_uint64_t *hits, hg_uint64_t *misses);
+
 /**
  * Bind an existing bulk handle to a local HG context and associate its local
  * address. This function can be used to forward and share a bulk handle
@@ -330,6 +421,45 @@ HG_Bulk_transfer_id(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_bulk_t origin_handle, hg_size_t origin_offset, hg_bulk_t local_handle,
     hg_size_t local_offset, hg_size_t size, hg_op_id_t *op_id);
 
+/**
+ * Same as HG_Bulk_transfer_id() but splits the transfer into chunks of at
+ * most pipeline_info->chunk_size bytes and keeps at most
+ * pipeline_info->max_in_flight of them in flight, the next chunk is issued
+ * as soon as one completes. Chunks that cannot be issued because the NA
+ * plugin is out of resources (NA_AGAIN) are issued again once other chunks
+ * complete. NA resources are only allocated for the chunks of that window
+ * and re-used by the next chunks. If pipeline_info->chunk_cb is set, it is
+ * called with the offset and size of every chunk that completed
+ * successfully, chunks may complete out of order. That callback is executed
+ * from the context that makes progress (HG_Progress()) and should therefore
+ * not block. The user callback is placed into the completion queue once all
+ * chunks completed.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param op [IN]               transfer operation:
+ *                                  - HG_BULK_PUSH
+ *                                  - HG_BULK_PULL
+ * \param origin_addr [IN]      abstract address of origin
+ * \param origin_id [IN]        context ID of origin
+ * \param origin_handle [IN]    abstract bulk handle
+ * \param origin_offset [IN]    offset
+ * \param local_handle [IN]     abstract bulk handle
+ * \param local_offset [IN]     offset
+ * \param size [IN]             size of data to be transferred
+ * \param pipeline_info [IN]    pointer to pipeline info
+ * \param op_id [OUT]           pointer to returned operation ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Bulk_transfer_pipeline(hg_context_t *context, hg_cb_t callback, void *arg,
+    hg_bulk_op_t op, hg_addr_t origin_addr, hg_uint8_t origin_id,
+    hg_bulk_t origin_handle, hg_size_t origin_offset, hg_bulk_t local_handle,
+    hg_size_t local_offset, hg_size_t size,
+    const struct hg_bulk_pipeline_info *pipeline_info, hg_op_id_t *op_id);
+
 /**
  * Cancel an ongoing operation.
  *
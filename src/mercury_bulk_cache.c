@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_bulk_cache.h"
+#include "mercury_error.h"
+
+#include "na.h"
+
+#include "mercury_thread_mutex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BULK_CACHE_END(entry) ((entry)->start + (entry)->size)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Cached registration, node of the interval tree (treap ordered by start
+ * address and augmented with the max end address of the subtree) */
+struct hg_bulk_cache_entry {
+    struct hg_bulk_cache_entry *left;       /* Left child */
+    struct hg_bulk_cache_entry *right;      /* Right child */
+    struct hg_bulk_cache_entry *lru_prev;   /* Prev entry in LRU list */
+    struct hg_bulk_cache_entry *lru_next;   /* Next entry in LRU list */
+    struct hg_bulk_cache_entry *next_stale; /* Next entry to invalidate */
+    na_mem_handle_t na_mem_handle;          /* NA memory handle */
+    na_mem_handle_t na_sm_mem_handle;       /* NA SM memory handle */
+    hg_ptr_t start;                         /* Start address of region */
+    hg_ptr_t max_end;                       /* Max end address of subtree */
+    hg_size_t size;                         /* Size of region */
+    hg_uint32_t priority;                   /* Treap priority */
+    hg_uint32_t ref_count;                  /* Number of users */
+    hg_bool_t in_tree;                      /* Entry can be looked up */
+    hg_uint8_t flags;                       /* Permission flags */
+};
+
+/* Registration cache */
+struct hg_bulk_cache {
+    na_class_t *na_class;                 /* NA class */
+    na_class_t *na_sm_class;              /* NA SM class */
+    struct hg_bulk_cache_entry *root;     /* Root of interval tree */
+    struct hg_bulk_cache_entry *lru_head; /* Most recently released */
+    struct hg_bulk_cache_entry *lru_tail; /* Least recently released */
+    hg_uint64_t hits;                     /* Number of hits */
+    hg_uint64_t misses;                   /* Number of misses */
+    hg_size_t unused_size;                /* Size of unused registrations */
+    hg_size_t max_size;                   /* Max size of unused registrations */
+    hg_uint32_t seed;                     /* Seed for treap priorities */
+    hg_uint32_t used_count;               /* Number of entries in use */
+    hg_thread_mutex_t mutex;              /* Cache mutex */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Compare entry to region key.
+ */
+static HG_INLINE int
+hg_bulk_cache_cmp(const struct hg_bulk_cache_entry *entry, hg_ptr_t start,
+    hg_size_t size, hg_uint8_t flags);
+
+/**
+ * Recompute max end address of node.
+ */
+static HG_INLINE void
+hg_bulk_cache_update(struct hg_bulk_cache_entry *node);
+
+/**
+ * Rotate subtree.
+ */
+static void
+hg_bulk_cache_rotate_left(struct hg_bulk_cache_entry **node_ptr);
+
+static void
+hg_bulk_cache_rotate_right(struct hg_bulk_cache_entry **node_ptr);
+
+/**
+ * Insert entry into tree.
+ */
+static void
+hg_bulk_cache_insert(
+    struct hg_bulk_cache_entry **node_ptr, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Remove entry from tree.
+ */
+static void
+hg_bulk_cache_remove(
+    struct hg_bulk_cache_entry **node_ptr, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Find entry matching region.
+ */
+static struct hg_bulk_cache_entry *
+hg_bulk_cache_find(struct hg_bulk_cache *cache, hg_ptr_t start, hg_size_t size,
+    hg_uint8_t flags);
+
+/**
+ * Add entries overlapping [start, end) to stale list.
+ */
+static void
+hg_bulk_cache_find_overlap(struct hg_bulk_cache_entry *node, hg_ptr_t start,
+    hg_ptr_t end, struct hg_bulk_cache_entry **stale_ptr);
+
+/**
+ * LRU list operations.
+ */
+static void
+hg_bulk_cache_lru_push(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry);
+
+static void
+hg_bulk_cache_lru_remove(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Register region.
+ */
+static hg_return_t
+hg_bulk_cache_entry_register(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Deregister region and free entry.
+ */
+static hg_return_t
+hg_bulk_cache_entry_free(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Evict unused entries until unused size fits in cache.
+ */
+static hg_return_t
+hg_bulk_cache_evict(struct hg_bulk_cache *cache);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_bulk_cache_cmp(const struct hg_bulk_cache_entry *entry, hg_ptr_t start,
+    hg_size_t size, hg_uint8_t flags)
+{
+    if (start != entry->start)
+        return (start < entry->start) ? -1 : 1;
+    if (size != entry->size)
+        return (size < entry->size) ? -1 : 1;
+    if (flags != entry->flags)
+        return (flags < entry->flags) ? -1 : 1;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_bulk_cache_update(struct hg_bulk_cache_entry *node)
+{
+    node->max_end = HG_BULK_CACHE_END(node);
+    if (node->left && node->left->max_end > node->max_end)
+        node->max_end = node->left->max_end;
+    if (node->right && node->right->max_end > node->max_end)
+        node->max_end = node->right->max_end;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_rotate_left(struct hg_bulk_cache_entry **node_ptr)
+{
+    struct hg_bulk_cache_entry *node = *node_ptr, *right = node->right;
+
+    node->right = right->left;
+    right->left = node;
+    hg_bulk_cache_update(node);
+    hg_bulk_cache_update(right);
+    *node_ptr = right;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_rotate_right(struct hg_bulk_cache_entry **node_ptr)
+{
+    struct hg_bulk_cache_entry *node = *node_ptr, *left = node->left;
+
+    node->left = left->right;
+    left->right = node;
+    hg_bulk_cache_update(node);
+    hg_bulk_cache_update(left);
+    *node_ptr = left;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_insert(
+    struct hg_bulk_cache_entry **node_ptr, struct hg_bulk_cache_entry *entry)
+{
+    struct hg_bulk_cache_entry *node = *node_ptr;
+
+    if (!node) {
+        entry->left = entry->right = NULL;
+        hg_bulk_cache_update(entry);
+        *node_ptr = entry;
+        return;
+    }
+
+    if (hg_bulk_cache_cmp(node, entry->start, entry->size, entry->flags) < 0) {
+        hg_bulk_cache_insert(&node->left, entry);
+        if (node->left->priority > node->priority)
+            hg_bulk_cache_rotate_right(node_ptr);
+        else
+            hg_bulk_cache_update(node);
+    } else {
+        hg_bulk_cache_insert(&node->right, entry);
+        if (node->right->priority > node->priority)
+            hg_bulk_cache_rotate_left(node_ptr);
+        else
+            hg_bulk_cache_update(node);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_remove(
+    struct hg_bulk_cache_entry **node_ptr, struct hg_bulk_cache_entry *entry)
+{
+    struct hg_bulk_cache_entry *node = *node_ptr;
+
+    if (node == entry) {
+        if (!node->left)
+            *node_ptr = node->right;
+        else if (!node->right)
+            *node_ptr = node->left;
+        else {
+            /* Push node down towards the child with the higher priority */
+            if (node->left->priority > node->right->priority) {
+                hg_bulk_cache_rotate_right(node_ptr);
+                hg_bulk_cache_remove(&(*node_ptr)->right, entry);
+            } else {
+                hg_bulk_cache_rotate_left(node_ptr);
+                hg_bulk_cache_remove(&(*node_ptr)->left, entry);
+            }
+            hg_bulk_cache_update(*node_ptr);
+        }
+        entry->left = entry->right = NULL;
+        return;
+    }
+
+    if (hg_bulk_cache_cmp(node, entry->start, entry->size, entry->flags) < 0)
+        hg_bulk_cache_remove(&node->left, entry);
+    else
+        hg_bulk_cache_remove(&node->right, entry);
+    hg_bulk_cache_update(node);
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_bulk_cache_entry *
+hg_bulk_cache_find(struct hg_bulk_cache *cache, hg_ptr_t start, hg_size_t size,
+    hg_uint8_t flags)
+{
+    struct hg_bulk_cache_entry *node = cache->root;
+
+    while (node) {
+        int cmp = hg_bulk_cache_cmp(node, start, size, flags);
+
+        if (cmp == 0)
+            break;
+        node = (cmp < 0) ? node->left : node->right;
+    }
+
+    return node;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_find_overlap(struct hg_bulk_cache_entry *node, hg_ptr_t start,
+    hg_ptr_t end, struct hg_bulk_cache_entry **stale_ptr)
+{
+    /* No region of that subtree ends after start */
+    if (!node || node->max_end <= start)
+        return;
+
+    hg_bulk_cache_find_overlap(node->left, start, end, stale_ptr);
+
+    /* Regions of right subtree all start after this one */
+    if (node->start >= end)
+        return;
+
+    if (HG_BULK_CACHE_END(node) > start) {
+        node->next_stale = *stale_ptr;
+        *stale_ptr = node;
+    }
+
+    hg_bulk_cache_find_overlap(node->right, start, end, stale_ptr);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_lru_push(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+    cache->lru_head = entry;
+    cache->unused_size += entry->size;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bulk_cache_lru_remove(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+    cache->unused_size -= entry->size;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_cache_entry_register(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry)
+{
+    hg_return_t ret = HG_SUCCESS;
+    na_return_t na_ret;
+
+    na_ret = NA_Mem_handle_create(cache->na_class, (void *) entry->start,
+        entry->size, entry->flags, &entry->na_mem_handle);
+    HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+        "NA_Mem_handle_create() failed (%s)", NA_Error_to_string(na_ret));
+
+    na_ret = NA_Mem_register(cache->na_class, entry->na_mem_handle);
+    HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+        "NA_Mem_register() failed (%s)", NA_Error_to_string(na_ret));
+
+    /* Cached handles are shared, publish them once */
+    na_ret = NA_Mem_publish(cache->na_class, entry->na_mem_handle);
+    HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+        "NA_Mem_publish() failed (%s)", NA_Error_to_string(na_ret));
+
+    if (cache->na_sm_class) {
+        na_ret = NA_Mem_handle_create(cache->na_sm_class, (void *) entry->start,
+            entry->size, entry->flags, &entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_handle_create() for SM failed (%s)",
+            NA_Error_to_string(na_ret));
+
+        na_ret = NA_Mem_register(cache->na_sm_class, entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_register() for SM failed (%s)", NA_Error_to_string(na_ret));
+
+        na_ret = NA_Mem_publish(cache->na_sm_class, entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_publish() for SM failed (%s)", NA_Error_to_string(na_ret));
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_cache_entry_free(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry)
+{
+    hg_return_t ret = HG_SUCCESS;
+    na_return_t na_ret;
+
+    if (entry->na_mem_handle != NA_MEM_HANDLE_NULL) {
+        na_ret = NA_Mem_unpublish(cache->na_class, entry->na_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_unpublish() failed (%s)", NA_Error_to_string(na_ret));
+
+        na_ret = NA_Mem_deregister(cache->na_class, entry->na_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_deregister() failed (%s)", NA_Error_to_string(na_ret));
+
+        na_ret = NA_Mem_handle_free(cache->na_class, entry->na_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_handle_free() failed (%s)", NA_Error_to_string(na_ret));
+        entry->na_mem_handle = NA_MEM_HANDLE_NULL;
+    }
+
+    if (entry->na_sm_mem_handle != NA_MEM_HANDLE_NULL) {
+        na_ret = NA_Mem_unpublish(cache->na_sm_class, entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_unpublish() for SM failed (%s)",
+            NA_Error_to_string(na_ret));
+
+        na_ret = NA_Mem_deregister(cache->na_sm_class, entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_deregister() for SM failed (%s)",
+            NA_Error_to_string(na_ret));
+
+        na_ret =
+            NA_Mem_handle_free(cache->na_sm_class, entry->na_sm_mem_handle);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "NA_Mem_handle_free() for SM failed (%s)",
+            NA_Error_to_string(na_ret));
+        entry->na_sm_mem_handle = NA_MEM_HANDLE_NULL;
+    }
+
+    free(entry);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_cache_evict(struct hg_bulk_cache *cache)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    while (cache->unused_size > cache->max_size) {
+        struct hg_bulk_cache_entry *entry = cache->lru_tail;
+
+        hg_bulk_cache_lru_remove(cache, entry);
+        hg_bulk_cache_remove(&cache->root, entry);
+        entry->in_tree = HG_FALSE;
+
+        ret = hg_bulk_cache_entry_free(cache, entry);
+        HG_CHECK_HG_ERROR(done, ret, "Could not free cache entry");
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+struct hg_bulk_cache *
+hg_bulk_cache_create(
+    na_class_t *na_class, na_class_t *na_sm_class, hg_size_t max_size)
+{
+    struct hg_bulk_cache *cache = NULL;
+
+    cache = (struct hg_bulk_cache *) malloc(sizeof(struct hg_bulk_cache));
+    HG_CHECK_ERROR_NORET(cache == NULL, done, "Could not allocate cache");
+    memset(cache, 0, sizeof(struct hg_bulk_cache));
+    cache->na_class = na_class;
+    cache->na_sm_class = na_sm_class;
+    cache->max_size = max_size;
+    cache->seed = (hg_uint32_t)((hg_ptr_t) cache >> 4) | 1;
+    hg_thread_mutex_init(&cache->mutex);
+
+done:
+    return cache;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_cache_destroy(struct hg_bulk_cache *cache)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!cache)
+        goto done;
+
+    HG_CHECK_ERROR(cache->used_count != 0, done, ret, HG_BUSY,
+        "Bulk handles must be freed before destroying cache (%u remaining)",
+        cache->used_count);
+
+    /* Evict everything */
+    cache->max_size = 0;
+    ret = hg_bulk_cache_evict(cache);
+    HG_CHECK_HG_ERROR(done, ret, "Could not evict cache entries");
+
+    hg_thread_mutex_destroy(&cache->mutex);
+    free(cache);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_cache_acquire(struct hg_bulk_cache *cache, void *buf, hg_size_t size,
+    hg_uint8_t flags, struct hg_bulk_cache_entry **entry_ptr,
+    na_mem_handle_t *na_mem_handle_ptr, na_mem_handle_t *na_sm_mem_handle_ptr)
+{
+    struct hg_bulk_cache_entry *entry;
+    hg_return_t ret = HG_SUCCESS;
+
+    hg_thread_mutex_lock(&cache->mutex);
+
+    /* Only exact matches are reused so that remote peers are never given
+     * access to more memory, or with more permissions, than requested */
+    entry = hg_bulk_cache_find(cache, (hg_ptr_t) buf, size, flags);
+    if (entry) {
+        if (entry->ref_count == 0)
+            hg_bulk_cache_lru_remove(cache, entry);
+        cache->hits++;
+    } else {
+        entry = (struct hg_bulk_cache_entry *) malloc(
+            sizeof(struct hg_bulk_cache_entry));
+        HG_CHECK_ERROR(entry == NULL, unlock, ret, HG_NOMEM,
+            "Could not allocate cache entry");
+        memset(entry, 0, sizeof(struct hg_bulk_cache_entry));
+        entry->na_mem_handle = NA_MEM_HANDLE_NULL;
+        entry->na_sm_mem_handle = NA_MEM_HANDLE_NULL;
+        entry->start = (hg_ptr_t) buf;
+        entry->size = size;
+        entry->flags = flags;
+
+        /* xorshift */
+        cache->seed ^= cache->seed << 13;
+        cache->seed ^= cache->seed >> 17;
+        cache->seed ^= cache->seed << 5;
+        entry->priority = cache->seed;
+
+        ret = hg_bulk_cache_entry_register(cache, entry);
+        if (ret != HG_SUCCESS) {
+            hg_bulk_cache_entry_free(cache, entry);
+            goto unlock;
+        }
+
+        hg_bulk_cache_insert(&cache->root, entry);
+        entry->in_tree = HG_TRUE;
+        cache->misses++;
+    }
+    if (entry->ref_count++ == 0)
+        cache->used_count++;
+
+    *entry_ptr = entry;
+    *na_mem_handle_ptr = entry->na_mem_handle;
+    if (na_sm_mem_handle_ptr)
+        *na_sm_mem_handle_ptr = entry->na_sm_mem_handle;
+
+unlock:
+    hg_thread_mutex_unlock(&cache->mutex);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_cache_release(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    hg_thread_mutex_lock(&cache->mutex);
+
+    if (--entry->ref_count > 0)
+        goto unlock;
+    cache->used_count--;
+
+    /* Entry was invalidated while in use */
+    if (!entry->in_tree) {
+        ret = hg_bulk_cache_entry_free(cache, entry);
+        HG_CHECK_HG_ERROR(unlock, ret, "Could not free cache entry");
+        goto unlock;
+    }
+
+    hg_bulk_cache_lru_push(cache, entry);
+
+    ret = hg_bulk_cache_evict(cache);
+    HG_CHECK_HG_ERROR(unlock, ret, "Could not evict cache entries");
+
+unlock:
+    hg_thread_mutex_unlock(&cache->mutex);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_cache_invalidate(struct hg_bulk_cache *cache, void *buf, hg_size_t size)
+{
+    struct hg_bulk_cache_entry *stale = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    hg_thread_mutex_lock(&cache->mutex);
+
+    hg_bulk_cache_find_overlap(
+        cache->root, (hg_ptr_t) buf, (hg_ptr_t) buf + size, &stale);
+
+    while (stale) {
+        struct hg_bulk_cache_entry *entry = stale;
+
+        stale = entry->next_stale;
+        hg_bulk_cache_remove(&cache->root, entry);
+        entry->in_tree = HG_FALSE;
+
+        /* Entries in use are freed on last release */
+        if (entry->ref_count > 0)
+            continue;
+
+        hg_bulk_cache_lru_remove(cache, entry);
+        ret = hg_bulk_cache_entry_free(cache, entry);
+        HG_CHECK_HG_ERROR(unlock, ret, "Could not free cache entry");
+    }
+
+unlock:
+    hg_thread_mutex_unlock(&cache->mutex);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bulk_cache_get_stats(
+    struct hg_bulk_cache *cache, hg_uint64_t *hits, hg_uint64_t *misses)
+{
+    hg_thread_mutex_lock(&cache->mutex);
+    if (hits)
+        *hits = cache->hits;
+    if (misses)
+        *misses = cache->misses;
+    hg_thread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_BULK_CACHE_H
+#define MERCURY_BULK_CACHE_H
+
+#include "mercury_core_types.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Cache of registered memory regions, kept in an interval tree so that
+ * regions overlapping a range can be invalidated, unused registrations are
+ * evicted in LRU order once the total registered size exceeds the limit. */
+struct hg_bulk_cache;
+
+/* Cached registration */
+struct hg_bulk_cache_entry;
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+/**
+ * Create a new registration cache.
+ *
+ * \param na_class [IN]         pointer to NA class
+ * \param na_sm_class [IN]      pointer to NA SM class (may be NULL)
+ * \param max_size [IN]         max size of unused registrations kept
+ *
+ * \return Pointer to cache or NULL in case of failure
+ */
+HG_PRIVATE struct hg_bulk_cache *
+hg_bulk_cache_create(
+    na_class_t *na_class, na_class_t *na_sm_class, hg_size_t max_size);
+
+/**
+ * Destroy cache and release all registrations. Fails if registrations are
+ * still in use.
+ *
+ * \param cache [IN/OUT]        pointer to cache
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PRIVATE hg_return_t
+hg_bulk_cache_destroy(struct hg_bulk_cache *cache);
+
+/**
+ * Get a registration for the region [buf, buf + size) with permission
+ * flags, registering and publishing the region if it is not cached yet.
+ *
+ * \param cache [IN/OUT]        pointer to cache
+ * \param buf [IN]              pointer to region
+ * \param size [IN]             size of region
+ * \param flags [IN]            permission flags
+ * \param entry_ptr [OUT]       pointer to cache entry
+ * \param na_mem_handle_ptr [OUT]
+ *                              pointer to NA memory handle
+ * \param na_sm_mem_handle_ptr [OUT]
+ *                              pointer to NA SM memory handle (may be NULL)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PRIVATE hg_return_t
+hg_bulk_cache_acquire(struct hg_bulk_cache *cache, void *buf, hg_size_t size,
+    hg_uint8_t flags, struct hg_bulk_cache_entry **entry_ptr,
+    na_mem_handle_t *na_mem_handle_ptr, na_mem_handle_t *na_sm_mem_handle_ptr);
+
+/**
+ * Release a registration obtained with hg_bulk_cache_acquire().
+ *
+ * \param cache [IN/OUT]        pointer to cache
+ * \param entry [IN/OUT]        pointer to cache entry
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PRIVATE hg_return_t
+hg_bulk_cache_release(
+    struct hg_bulk_cache *cache, struct hg_bulk_cache_entry *entry);
+
+/**
+ * Drop registrations overlapping [buf, buf + size). Registrations in use are
+ * no longer returned and are released once their last user is done.
+ *
+ * \param cache [IN/OUT]        pointer to cache
+ * \param buf [IN]              pointer to region
+ * \param size [IN]             size of region
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PRIVATE hg_return_t
+hg_bulk_cache_invalidate(
+    struct hg_bulk_cache *cache, void *buf, hg_size_t size);
+
+/**
+ * Get number of cache hits and misses.
+ *
+ * \param cache [IN]            pointer to cache
+ * \param hits [OUT]            pointer to number of hits
+ * \param misses [OUT]          pointer to number of misses
+ */
+HG_PRIVATE void
+hg_bulk_cache_get_stats(struct hg_bulk_cache *cache, hg_uint64_t *hits,
+    hg_uint64_t *misses);
+
+#endif /* MERCURY_BULK_CACHE_H */
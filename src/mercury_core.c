@@ -9,14 +9,15 @@
  */
 
 #include "mercury_core.h"
+#include "mercury_bulk_cache.h"
 #include "mercury_private.h"
 
 #include "mercury_atomic_queue.h"
-#ifdef HG_HAS_SELF_FORWARD
-#    include "mercury_event.h"
-#endif
+#include "mercury_mpmc_queue.h"
 #include "mercury_error.h"
-#include "mercury_hash_table.h"
+#include "mercury_event.h"
+#include "mercury_hash_map.h"
+#include "mercury_hash_string.h"
 #include "mercury_list.h"
 #include "mercury_mem.h"
 #include "mercury_poll.h"
@@ -26,11 +27,19 @@
 #include "mercury_thread_pool.h"
 #include "mercury_thread_spin.h"
 #include "mercury_time.h"
+#include "mercury_trace.h"
 
 #ifdef HG_HAS_SM_ROUTING
 #    include <na_sm.h>
 #endif
 
+#ifdef _WIN32
+#    include <process.h>
+#    define getpid _getpid
+#else
+#    include <unistd.h>
+#endif
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -38,16 +47,19 @@
 /* Local Macros */
 /****************/
 
-#define HG_CORE_ATOMIC_QUEUE_SIZE 1024
-#define HG_CORE_PENDING_INCR      256
-#define HG_CORE_CLEANUP_TIMEOUT   1000
-#define HG_CORE_MAX_EVENTS        1
-#define HG_CORE_MAX_TRIGGER_COUNT 1
+#define HG_CORE_PENDING_INCR       256
+#define HG_CORE_CLEANUP_TIMEOUT    1000
+#define HG_CORE_MAX_EVENTS         1
+#define HG_CORE_MAX_TRIGGER_COUNT  1
+#define HG_CORE_TRIGGER_BATCH_SIZE 64
+#define HG_CORE_MIN(a, b)          (a < b) ? a : b /* Min macro */
+#define HG_CORE_SPIN_TIME_MIN      1 /* Lower bound of spin time (us) */
+#define HG_CORE_FUNC_MAP_MIN_SIZE  16 /* Min number of func map slots */
+#define HG_CORE_STATS_SHARDS       8  /* Number of thread shards */
 #ifdef HG_HAS_SM_ROUTING
 #    define HG_CORE_ADDR_MAX_SIZE   256
 #    define HG_CORE_PROTO_DELIMITER ":"
 #    define HG_CORE_ADDR_DELIMITER  "#"
-#    define HG_CORE_MIN(a, b)       (a < b) ? a : b /* Min macro */
 #endif
 
 /* Remove warnings when routine does not use arguments */
@@ -60,18 +72,18 @@
 #endif
 
 /* Map stat type to either 32-bit atomic or 64-bit */
-#ifdef HG_HAS_COLLECT_STATS
-#    ifndef HG_UTIL_HAS_OPA_PRIMITIVES_H
+#ifndef HG_UTIL_HAS_OPA_PRIMITIVES_H
 typedef hg_atomic_int64_t hg_core_stat_t;
-#        define hg_core_stat_incr hg_atomic_incr64
-#        define hg_core_stat_get  hg_atomic_get64
-#    else
+#    define hg_core_stat_init hg_atomic_init64
+#    define hg_core_stat_incr hg_atomic_incr64
+#    define hg_core_stat_get  hg_atomic_get64
+#else
 typedef hg_atomic_int32_t hg_core_stat_t;
-#        define hg_core_stat_incr hg_atomic_incr32
-#        define hg_core_stat_get  hg_atomic_get32
-#    endif
-#    define HG_CORE_STAT_INIT HG_ATOMIC_VAR_INIT
+#    define hg_core_stat_init hg_atomic_init32
+#    define hg_core_stat_incr hg_atomic_incr32
+#    define hg_core_stat_get  hg_atomic_get32
 #endif
+#define HG_CORE_STAT_INIT HG_ATOMIC_VAR_INIT
 
 #define HG_CORE_CONTEXT_CLASS(context)                                         \
     ((struct hg_core_private_class *) (context->core_context.core_class))
@@ -81,27 +93,114 @@ typedef hg_atomic_int32_t hg_core_stat_t;
 #define HG_CORE_HANDLE_CONTEXT(handle)                                         \
     ((struct hg_core_private_context *) (handle->core_handle.info.context))
 
+/* Record trace event of handle, the correlation ID is carried in the request
+ * header so that origin and target events can be matched */
+#define HG_CORE_HANDLE_TRACE(handle, type, arg)                                \
+    HG_TRACE(type, (handle)->in_header.msg.request.trace_id, arg)
+
+/* Select handle pool matching NA class */
+#ifdef HG_HAS_SM_ROUTING
+#    define HG_CORE_CONTEXT_HANDLE_POOL(context, use_sm)                       \
+        ((use_sm) ? context->sm_handle_pool : context->handle_pool)
+#else
+#    define HG_CORE_CONTEXT_HANDLE_POOL(context, use_sm) (context->handle_pool)
+#endif
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
 
+/* RPC statistics counters */
+typedef enum hg_core_stats_counter {
+    HG_CORE_STATS_FORWARD_COUNT,
+    HG_CORE_STATS_HANDLE_COUNT,
+    HG_CORE_STATS_BYTES_OUT,
+    HG_CORE_STATS_BYTES_IN,
+    HG_CORE_STATS_OVERFLOW_COUNT,
+    HG_CORE_STATS_COUNTER_MAX
+} hg_core_stats_counter_t;
+
+/* Latency histogram (see struct hg_stats_hist) */
+struct hg_core_stats_hist {
+    hg_atomic_int64_t count;
+    hg_atomic_int64_t sum;
+    hg_atomic_int64_t max;
+    hg_atomic_int64_t buckets[HG_STATS_HIST_BUCKETS];
+};
+
+/* RPC statistics shard, threads are assigned a shard so that updates from
+ * different threads do not contend on the same counters */
+struct hg_core_stats {
+    hg_atomic_int64_t counters[HG_CORE_STATS_COUNTER_MAX];
+    struct hg_core_stats_hist latency[HG_STATS_PHASE_MAX];
+};
+
+/* RPC info */
+struct hg_core_private_rpc_info {
+    struct hg_core_rpc_info rpc_info; /* Must remain as first field */
+    hg_atomic_int64_t
+        stats[HG_CORE_STATS_SHARDS]; /* Shards (struct hg_core_stats *) */
+};
+
+/* Function map entry */
+struct hg_core_func_map_entry {
+    hg_id_t id;                         /* RPC ID */
+    struct hg_core_rpc_info *rpc_info;  /* RPC info (NULL if slot is free) */
+};
+
+/* Function map. Maps are never modified once published, updates copy the
+ * current map and replace it so that lookups do not need to lock. Replaced
+ * maps and removed entries are freed once readers that may still access
+ * them are done (see hg_core_func_map_synchronize()).
+ */
+struct hg_core_func_map {
+    unsigned int count;                      /* Number of entries */
+    unsigned int mask;                       /* Number of slots - 1 */
+    struct hg_core_func_map_entry entries[]; /* Open-addressing slots */
+};
+
+/* Function map readers of a thread shard, counted per epoch parity. Padded
+ * so that readers of different shards do not share cache lines */
+struct hg_core_func_map_readers {
+    hg_atomic_int32_t count[2];
+    char pad[HG_MEM_CACHE_LINE_SIZE - 2 * sizeof(hg_atomic_int32_t)];
+};
+
 /* HG class */
 struct hg_core_private_class {
     struct hg_core_class core_class; /* Must remain as first field */
 #ifdef HG_HAS_SM_ROUTING
     na_sm_id_t host_id; /* Host ID for local identification */
 #endif
-    hg_hash_table_t *func_map; /* Function map */
+    hg_atomic_int64_t func_map; /* Function map (struct hg_core_func_map *) */
+    struct hg_core_func_map_readers
+        func_map_readers[HG_CORE_STATS_SHARDS]; /* Readers per thread shard */
+    hg_atomic_int32_t func_map_epoch;           /* Function map epoch */
     hg_return_t (*more_data_acquire)(hg_core_handle_t, hg_op_t,
         hg_return_t (*done_callback)(hg_core_handle_t)); /* more_data_acquire */
     void (*more_data_release)(hg_core_handle_t);         /* more_data_release */
     na_tag_t request_max_tag;                            /* Max value for tag */
-    hg_atomic_int32_t n_contexts;   /* Atomic used for number of contexts */
-    hg_atomic_int32_t n_addrs;      /* Atomic used for number of addrs */
-    hg_atomic_int32_t request_tag;  /* Atomic used for tag generation */
-    hg_thread_spin_t func_map_lock; /* Function map lock */
-    na_uint32_t progress_mode;      /* NA progress mode */
-    hg_bool_t na_ext_init;          /* NA externally initialized */
+    hg_atomic_int32_t n_contexts;       /* Atomic used for number of contexts */
+    hg_atomic_int32_t n_addrs;          /* Atomic used for number of addrs */
+    hg_atomic_int32_t request_tag;      /* Atomic used for tag generation */
+    hg_atomic_int32_t stats_enabled;    /* RPC stats are being recorded */
+    hg_atomic_int32_t stats_shards;     /* Number of thread shards assigned */
+    hg_thread_key_t stats_key;          /* Thread shard of calling thread */
+    char *trace_file;                   /* Trace dump path prefix */
+    hg_hash_map_t *addr_cache;          /* Cached addrs (by lookup name) */
+    hg_thread_pool_t *addr_lookup_pool; /* Batch lookup thread pool */
+    hg_thread_mutex_t addr_cache_mutex; /* Addr cache lock */
+    hg_util_uint64_t addr_cache_clock;  /* Addr cache LRU clock */
+    unsigned int addr_cache_ttl;        /* Cached addr lifetime (ms) */
+    unsigned int addr_cache_neg_ttl;    /* Failed lookup lifetime (ms) */
+    unsigned int addr_cache_size;       /* Max number of cached addrs */
+    unsigned int addr_lookup_pool_size; /* Number of lookup pool threads */
+    hg_thread_spin_t func_map_lock;     /* Function map update lock */
+    na_uint32_t progress_mode;          /* NA progress mode */
+    na_uint32_t max_spin_time;          /* Max spin time (us) */
+    unsigned int handle_pool_size;      /* Max handles cached per context */
+    hg_bool_t na_ext_init;              /* NA externally initialized */
+    hg_bool_t stats_key_created;        /* Stats key must be deleted */
 #ifdef HG_HAS_COLLECT_STATS
     hg_bool_t stats; /* (Debug) Print stats at exit */
 #endif
@@ -116,15 +215,22 @@ typedef enum hg_core_poll_type {
     HG_CORE_POLL_NA
 } hg_core_poll_type_t;
 
+/* HG handle pool */
+struct hg_core_handle_pool {
+    struct hg_atomic_queue *free_list; /* Free list of cached handles */
+    hg_atomic_int32_t count;           /* Number of cached handles */
+    unsigned int max_count;            /* High-water mark */
+    hg_core_stat_t hit_count;          /* Handles re-used from pool */
+    hg_core_stat_t miss_count;         /* Handles allocated from scratch */
+};
+
 /* HG context */
 struct hg_core_private_context {
     struct hg_core_context core_context;      /* Must remain as first field */
     hg_thread_cond_t completion_queue_cond;   /* Completion queue cond */
     hg_thread_mutex_t completion_queue_mutex; /* Completion queue mutex */
     hg_thread_mutex_t completion_queue_notify_mutex; /* Notify mutex */
-    HG_QUEUE_HEAD(hg_completion_entry)
-    backfill_queue;                           /* Backfill completion queue */
-    struct hg_atomic_queue *completion_queue; /* Default completion queue */
+    struct hg_mpmc_queue *completion_queue;   /* Default completion queue */
     HG_LIST_HEAD(hg_core_private_handle)
     created_list; /* List of handles for that context */
     HG_LIST_HEAD(hg_core_private_handle)
@@ -134,21 +240,27 @@ struct hg_core_private_context {
     sm_pending_list; /* List of SM pending handles */
 #endif
     hg_return_t (*handle_create)(hg_core_handle_t, void *); /* handle_create */
-    void *handle_create_arg;      /* handle_create arg */
+    void *handle_create_arg;                          /* handle_create arg */
+    void (*handle_recycle)(hg_core_handle_t, void *); /* handle_recycle */
+    void *handle_recycle_arg;                         /* handle_recycle arg */
+    struct hg_core_handle_pool *handle_pool;          /* Handle pool */
+#ifdef HG_HAS_SM_ROUTING
+    struct hg_core_handle_pool *sm_handle_pool; /* SM handle pool */
+#endif
     struct hg_poll_set *poll_set; /* Context poll set */
     struct hg_poll_event
         poll_events[HG_CORE_MAX_EVENTS]; /* Context poll events */
     hg_atomic_int32_t
         completion_queue_must_notify; /* Notify of completion queue events */
-    hg_atomic_int32_t backfill_queue_count; /* Backfill queue count */
-    hg_atomic_int32_t trigger_waiting;      /* Waiting in trigger */
+    hg_atomic_int32_t trigger_waiting;  /* Waiting in trigger */
     hg_atomic_int32_t n_handles;        /* Atomic used for number of handles */
     hg_thread_spin_t created_list_lock; /* Handle list lock */
     hg_thread_spin_t pending_list_lock; /* Pending list lock */
-#ifdef HG_HAS_SELF_FORWARD
-    int completion_queue_notify; /* Self notification */
-#endif
-    hg_bool_t finalizing; /* Prevent reposts */
+    int completion_queue_notify; /* Completion queue notification */
+    hg_core_stat_t spin_count;  /* Progress made while spinning */
+    hg_core_stat_t block_count; /* Fallbacks to blocking progress */
+    double spin_time;           /* Current spin time (s) */
+    hg_bool_t finalizing;       /* Prevent reposts */
 };
 
 #ifdef HG_HAS_SELF_FORWARD
@@ -171,6 +283,16 @@ struct hg_core_private_addr {
     hg_bool_t is_mine;           /* Created internally or not */
 };
 
+/* HG addr cache entry */
+struct hg_core_addr_cache_entry {
+    char *name;                                /* Lookup name (key) */
+    struct hg_core_private_addr *hg_core_addr; /* Addr (NULL if failed) */
+    hg_time_t expire;                          /* Expiration time */
+    hg_util_uint64_t last_use;                 /* Last use (LRU clock) */
+    hg_return_t ret;                           /* Lookup return code */
+    hg_bool_t expires;                         /* Entry may expire */
+};
+
 /* HG core op type */
 typedef enum {
     HG_CORE_FORWARD,    /*!< Forward completion */
@@ -214,6 +336,9 @@ struct hg_core_private_handle {
     na_size_t in_buf_used;     /* Amount of input buffer used */
     na_size_t out_buf_used;    /* Amount of output buffer used */
     na_tag_t tag;              /* Tag used for request and response */
+    hg_time_t stats_start;     /* Forward / request receipt time */
+    hg_time_t stats_mid;       /* Request sent / RPC callback time */
+    hg_time_t stats_end;       /* Response receipt time */
     hg_atomic_int32_t
         na_op_completed_count;   /* Number of NA operations completed */
     hg_atomic_int32_t in_use;    /* Is in use */
@@ -227,6 +352,7 @@ struct hg_core_private_handle {
     hg_bool_t repost;            /* Repost handle on completion (listen) */
     hg_bool_t is_self;           /* Self processed */
     hg_bool_t no_response;       /* Require response or not */
+    hg_bool_t stats;             /* Record RPC stats */
 };
 
 /* HG op id */
@@ -244,6 +370,21 @@ struct hg_core_op_id {
     hg_core_cb_t callback;                   /* Callback */
     void *arg;                               /* Callback arguments */
     hg_cb_type_t type;                       /* Callback type */
+    hg_return_t ret;                         /* Return code */
+};
+
+/* HG batch lookup, names are looked up by the workers of the lookup pool
+ * (or by the caller if there is none) and the last one to finish adds the
+ * batch to the completion queue */
+struct hg_core_lookup_batch {
+    struct hg_core_op_id op_id;          /* Must remain as first field */
+    const char *const *names;            /* Names to look up */
+    struct hg_core_private_addr **addrs; /* Resulting addrs */
+    hg_atomic_int32_t next;              /* Index of next name */
+    hg_atomic_int32_t n_workers;         /* Workers still running */
+    hg_atomic_int32_t ret;               /* First error */
+    unsigned int count;                  /* Number of names */
+    struct hg_thread_work works[];       /* Lookup pool work items */
 };
 
 /********************/
@@ -251,22 +392,117 @@ struct hg_core_op_id {
 /********************/
 
 /**
- * Equal function for function map.
+ * Free function for value in function map.
  */
-static HG_INLINE int
-hg_core_int_equal(void *vlocation1, void *vlocation2);
+static void
+hg_core_func_map_value_free(struct hg_core_rpc_info *hg_core_rpc_info);
 
 /**
- * Hash function for function map.
+ * Get the thread shard of the calling thread.
  */
 static HG_INLINE unsigned int
-hg_core_int_hash(void *vlocation);
+hg_core_thread_shard(struct hg_core_private_class *hg_core_class);
 
 /**
- * Free function for value in function map.
+ * Enter function map read-side section. Lookups and accesses to the RPC info
+ * they return must be done before the section is left by passing the returned
+ * reader count to hg_core_func_map_read_unlock().
+ */
+static HG_INLINE hg_atomic_int32_t *
+hg_core_func_map_read_lock(struct hg_core_private_class *hg_core_class);
+
+/**
+ * Leave function map read-side section.
+ */
+static HG_INLINE void
+hg_core_func_map_read_unlock(hg_atomic_int32_t *readers);
+
+/**
+ * Look up RPC info from function map (does not lock), must be called from
+ * a read-side section or with func_map_lock held.
+ */
+static HG_INLINE struct hg_core_rpc_info *
+hg_core_func_map_lookup(
+    struct hg_core_private_class *hg_core_class, hg_id_t id);
+
+/**
+ * Wait for readers that entered the function map before the last update.
+ * Must be called with func_map_lock held.
+ */
+static void
+hg_core_func_map_synchronize(struct hg_core_private_class *hg_core_class);
+
+/**
+ * Publish a new function map where id is mapped to rpc_info, or removed if
+ * rpc_info is NULL. The previous map is freed once no reader can access it.
+ * Must be called with func_map_lock held.
+ */
+static hg_return_t
+hg_core_func_map_update(struct hg_core_private_class *hg_core_class,
+    hg_id_t id, struct hg_core_rpc_info *rpc_info);
+
+/**
+ * Free function map and its entries.
+ */
+static void
+hg_core_func_map_free(struct hg_core_private_class *hg_core_class);
+
+/**
+ * Get the stats shard of the calling thread for an RPC, the shard is
+ * allocated on first use. Returns NULL if it could not be allocated.
+ */
+static struct hg_core_stats *
+hg_core_stats_shard(struct hg_core_private_class *hg_core_class,
+    struct hg_core_rpc_info *hg_core_rpc_info);
+
+/**
+ * Add value to stats counter.
+ */
+static HG_INLINE void
+hg_core_stats_add(hg_atomic_int64_t *counter, hg_util_int64_t value);
+
+/**
+ * Record elapsed time between start and end in latency histogram.
  */
 static void
-hg_core_func_map_value_free(hg_hash_table_value_t value);
+hg_core_stats_hist_record(
+    struct hg_core_stats_hist *hist, hg_time_t start, hg_time_t end);
+
+/**
+ * Get index of histogram bucket that counts value.
+ */
+static HG_INLINE unsigned int
+hg_core_stats_hist_bucket(hg_uint64_t value);
+
+/**
+ * Record stats of a completed forward (origin).
+ */
+static void
+hg_core_stats_forward(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Record stats of a request about to be processed (target).
+ */
+static void
+hg_core_stats_process(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Record stats of a response about to be sent (target).
+ */
+static void
+hg_core_stats_respond(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Free stats shards of an RPC.
+ */
+static void
+hg_core_stats_free(struct hg_core_private_rpc_info *hg_core_rpc_info);
+
+/**
+ * Reset stats of an RPC.
+ */
+static void
+hg_core_stats_reset(struct hg_core_private_rpc_info *hg_core_rpc_info);
 
 /**
  * Generate a new tag.
@@ -321,12 +557,64 @@ hg_core_addr_create(
     struct hg_core_private_class *hg_core_class, na_class_t *na_class);
 
 /**
- * Lookup addr.
+ * Lookup addr, going through the addr cache if enabled.
  */
 static hg_return_t
 hg_core_addr_lookup(struct hg_core_private_class *hg_core_class,
     const char *name, struct hg_core_private_addr **addr);
 
+/**
+ * Resolve addr through NA.
+ */
+static hg_return_t
+hg_core_addr_resolve(struct hg_core_private_class *hg_core_class,
+    const char *name, struct hg_core_private_addr **addr);
+
+/**
+ * Hash function for addr cache.
+ */
+static HG_INLINE unsigned int
+hg_core_addr_cache_hash(hg_hash_map_key_t key);
+
+/**
+ * Equal function for addr cache.
+ */
+static HG_INLINE int
+hg_core_addr_cache_equal(hg_hash_map_key_t key1, hg_hash_map_key_t key2);
+
+/**
+ * Remove least recently used (or expired) entry from addr cache. Must be
+ * called with addr_cache_mutex held.
+ */
+static struct hg_core_addr_cache_entry *
+hg_core_addr_cache_evict(
+    struct hg_core_private_class *hg_core_class, hg_time_t now);
+
+/**
+ * Free addr cache entry and release its addr reference.
+ */
+static void
+hg_core_addr_cache_entry_free(struct hg_core_private_class *hg_core_class,
+    struct hg_core_addr_cache_entry *entry);
+
+/**
+ * Free addr cache and all its entries.
+ */
+static void
+hg_core_addr_cache_destroy(struct hg_core_private_class *hg_core_class);
+
+/**
+ * Look up remaining names of batch.
+ */
+static hg_return_t
+hg_core_addr_lookup_batch_run(struct hg_core_lookup_batch *batch);
+
+/**
+ * Batch lookup pool worker.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_core_addr_lookup_batch_thread(void *arg);
+
 /**
  * Free addr.
  */
@@ -356,6 +644,24 @@ static hg_return_t
 hg_core_addr_to_string(struct hg_core_private_class *hg_core_class, char *buf,
     hg_size_t *buf_size, struct hg_core_private_addr *hg_core_addr);
 
+/**
+ * Create handle pool.
+ */
+static struct hg_core_handle_pool *
+hg_core_handle_pool_create(unsigned int max_count);
+
+/**
+ * Destroy handle pool and free cached handles.
+ */
+static void
+hg_core_handle_pool_destroy(struct hg_core_handle_pool *hg_core_handle_pool);
+
+/**
+ * Get handle from pool.
+ */
+static HG_INLINE struct hg_core_private_handle *
+hg_core_handle_pool_get(struct hg_core_handle_pool *hg_core_handle_pool);
+
 /**
  * Create handle.
  */
@@ -363,11 +669,29 @@ static struct hg_core_private_handle *
 hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm);
 
 /**
- * Free handle.
+ * Allocate handle.
+ */
+static struct hg_core_private_handle *
+hg_core_alloc(struct hg_core_private_context *context, hg_bool_t use_sm);
+
+/**
+ * Release handle.
  */
 static void
 hg_core_destroy(struct hg_core_private_handle *hg_core_handle);
 
+/**
+ * Reset handle and return it to context pool.
+ */
+static hg_bool_t
+hg_core_recycle(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Free handle.
+ */
+static void
+hg_core_free(struct hg_core_private_handle *hg_core_handle);
+
 /**
  * Allocate NA resources.
  */
@@ -557,13 +881,11 @@ static hg_return_t
 hg_core_progress_na(
     na_class_t *na_class, na_context_t *na_context, unsigned int timeout);
 
-#ifdef HG_HAS_SELF_FORWARD
 /**
  * Completion queue notification callback.
  */
 static HG_INLINE hg_return_t
 hg_core_progress_loopback_notify(struct hg_core_private_context *context);
-#endif
 
 /**
  * Determines when it is safe to block.
@@ -571,6 +893,13 @@ hg_core_progress_loopback_notify(struct hg_core_private_context *context);
 static HG_INLINE hg_bool_t
 hg_core_poll_try_wait(struct hg_core_private_context *context);
 
+/**
+ * Spin on progress for a self-tuned amount of time before blocking.
+ */
+static hg_return_t
+hg_core_progress_spin(
+    struct hg_core_private_context *context, double *remaining);
+
 /**
  * Make progress.
  */
@@ -578,11 +907,25 @@ static hg_return_t
 hg_core_progress(struct hg_core_private_context *context, unsigned int timeout);
 
 /**
- * Trigger callbacks.
+ * Dequeue completion entries.
+ */
+static HG_INLINE unsigned int
+hg_core_completion_dequeue(struct hg_core_private_context *context,
+    struct hg_completion_entry **hg_completion_entries, unsigned int max_count);
+
+/**
+ * Trigger callbacks or return completion entries if array is passed.
  */
 static hg_return_t
 hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
-    unsigned int max_count, unsigned int *actual_count);
+    unsigned int max_count, struct hg_completion_entry **hg_completion_entries,
+    unsigned int *actual_count);
+
+/**
+ * Trigger callback from completion entry.
+ */
+static hg_return_t
+hg_core_trigger_completion(struct hg_completion_entry *hg_completion_entry);
 
 /**
  * Trigger callback from HG lookup op ID.
@@ -646,29 +989,396 @@ hg_core_print_stats(void)
 #endif
 
 /*---------------------------------------------------------------------------*/
-static HG_INLINE int
-hg_core_int_equal(void *vlocation1, void *vlocation2)
+static HG_INLINE unsigned int
+hg_core_func_map_hash(hg_id_t id)
+{
+    /* Fibonacci hashing, use upper bits of the product */
+    return (unsigned int) ((id * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_func_map_value_free(struct hg_core_rpc_info *hg_core_rpc_info)
 {
-    return *((int *) vlocation1) == *((int *) vlocation2);
+    if (hg_core_rpc_info->free_callback)
+        hg_core_rpc_info->free_callback(hg_core_rpc_info->data);
+    hg_core_stats_free((struct hg_core_private_rpc_info *) hg_core_rpc_info);
+    free(hg_core_rpc_info);
 }
 
 /*---------------------------------------------------------------------------*/
 static HG_INLINE unsigned int
-hg_core_int_hash(void *vlocation)
+hg_core_thread_shard(struct hg_core_private_class *hg_core_class)
 {
-    return *((unsigned int *) vlocation);
+    size_t shard;
+
+    /* Threads are assigned shards round-robin, key stores shard + 1 */
+    shard = (size_t) hg_thread_getspecific(hg_core_class->stats_key);
+    if (shard == 0) {
+        shard = (size_t) hg_atomic_incr32(&hg_core_class->stats_shards);
+        shard = shard % HG_CORE_STATS_SHARDS + 1;
+        hg_thread_setspecific(hg_core_class->stats_key, (void *) shard);
+    }
+
+    return (unsigned int) (shard - 1);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_atomic_int32_t *
+hg_core_func_map_read_lock(struct hg_core_private_class *hg_core_class)
+{
+    struct hg_core_func_map_readers *shard_readers =
+        &hg_core_class->func_map_readers[hg_core_thread_shard(hg_core_class)];
+    hg_atomic_int32_t *readers;
+    hg_util_int32_t epoch;
+
+    /* Count reader in the current epoch, an update that moved to the next
+     * epoch before the reader was counted would not wait for it, retry */
+    for (;;) {
+        epoch = hg_atomic_get32(&hg_core_class->func_map_epoch);
+        readers = &shard_readers->count[epoch & 1];
+        hg_atomic_incr32(readers);
+        if (hg_atomic_get32(&hg_core_class->func_map_epoch) == epoch)
+            break;
+        hg_atomic_decr32(readers);
+    }
+
+    return readers;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_func_map_read_unlock(hg_atomic_int32_t *readers)
+{
+    hg_atomic_decr32(readers);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE struct hg_core_rpc_info *
+hg_core_func_map_lookup(struct hg_core_private_class *hg_core_class, hg_id_t id)
+{
+    struct hg_core_func_map *func_map =
+        (struct hg_core_func_map *) hg_atomic_get64(&hg_core_class->func_map);
+    unsigned int i;
+
+    /* Maps are at most half full so probing always hits a free slot */
+    for (i = hg_core_func_map_hash(id) & func_map->mask;;
+         i = (i + 1) & func_map->mask) {
+        if (func_map->entries[i].rpc_info == NULL)
+            return NULL;
+        if (func_map->entries[i].id == id)
+            return func_map->entries[i].rpc_info;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_func_map_insert(struct hg_core_func_map *func_map, hg_id_t id,
+    struct hg_core_rpc_info *rpc_info)
+{
+    unsigned int i;
+
+    for (i = hg_core_func_map_hash(id) & func_map->mask;
+         func_map->entries[i].rpc_info != NULL; i = (i + 1) & func_map->mask)
+        continue;
+
+    func_map->entries[i].id = id;
+    func_map->entries[i].rpc_info = rpc_info;
+    func_map->count++;
 }
 
 /*---------------------------------------------------------------------------*/
 static void
-hg_core_func_map_value_free(hg_hash_table_value_t value)
+hg_core_func_map_synchronize(struct hg_core_private_class *hg_core_class)
 {
-    struct hg_core_rpc_info *hg_core_rpc_info =
-        (struct hg_core_rpc_info *) value;
+    hg_util_int32_t epoch;
+    unsigned int i;
+
+    /* New readers are counted in the next epoch and can only see the current
+     * map, wait for readers of the previous epoch to leave */
+    epoch = hg_atomic_incr32(&hg_core_class->func_map_epoch) - 1;
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++)
+        while (hg_atomic_get32(
+                   &hg_core_class->func_map_readers[i].count[epoch & 1]) != 0)
+            hg_thread_yield();
+}
 
-    if (hg_core_rpc_info->free_callback)
-        hg_core_rpc_info->free_callback(hg_core_rpc_info->data);
-    free(hg_core_rpc_info);
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_func_map_update(struct hg_core_private_class *hg_core_class,
+    hg_id_t id, struct hg_core_rpc_info *rpc_info)
+{
+    struct hg_core_func_map *old_map =
+        (struct hg_core_func_map *) hg_atomic_get64(&hg_core_class->func_map);
+    struct hg_core_func_map *new_map = NULL;
+    unsigned int count = (old_map ? old_map->count : 0) + 1, size, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Keep load factor below 1/2 */
+    for (size = HG_CORE_FUNC_MAP_MIN_SIZE; size < 2 * count; size *= 2)
+        continue;
+
+    new_map = (struct hg_core_func_map *) malloc(
+        sizeof(struct hg_core_func_map) +
+        size * sizeof(struct hg_core_func_map_entry));
+    HG_CHECK_ERROR(new_map == NULL, done, ret, HG_NOMEM,
+        "Could not allocate function map");
+    memset(new_map->entries, 0, size * sizeof(struct hg_core_func_map_entry));
+    new_map->count = 0;
+    new_map->mask = size - 1;
+
+    /* Copy entries, replacing or removing previous mapping of id */
+    if (old_map) {
+        for (i = 0; i <= old_map->mask; i++) {
+            if (old_map->entries[i].rpc_info == NULL ||
+                old_map->entries[i].id == id)
+                continue;
+            hg_core_func_map_insert(new_map, old_map->entries[i].id,
+                old_map->entries[i].rpc_info);
+        }
+    }
+    if (rpc_info)
+        hg_core_func_map_insert(new_map, id, rpc_info);
+
+    /* Entries are filled, publish map */
+    hg_atomic_set64(&hg_core_class->func_map, (hg_util_int64_t) new_map);
+
+    /* Free previous map once readers are done with it */
+    if (old_map) {
+        hg_core_func_map_synchronize(hg_core_class);
+        free(old_map);
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_func_map_free(struct hg_core_private_class *hg_core_class)
+{
+    struct hg_core_func_map *func_map =
+        (struct hg_core_func_map *) hg_atomic_get64(&hg_core_class->func_map);
+    unsigned int i;
+
+    if (!func_map)
+        return;
+
+    for (i = 0; i <= func_map->mask; i++)
+        if (func_map->entries[i].rpc_info)
+            hg_core_func_map_value_free(func_map->entries[i].rpc_info);
+
+    free(func_map);
+    hg_atomic_set64(&hg_core_class->func_map, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_core_stats *
+hg_core_stats_shard(struct hg_core_private_class *hg_core_class,
+    struct hg_core_rpc_info *hg_core_rpc_info)
+{
+    struct hg_core_private_rpc_info *private_rpc_info =
+        (struct hg_core_private_rpc_info *) hg_core_rpc_info;
+    struct hg_core_stats *stats;
+    unsigned int shard;
+
+    if (!hg_core_rpc_info)
+        return NULL;
+
+    shard = hg_core_thread_shard(hg_core_class);
+    stats = (struct hg_core_stats *) hg_atomic_get64(
+        &private_rpc_info->stats[shard]);
+    if (!stats) {
+        struct hg_core_stats *new_stats =
+            (struct hg_core_stats *) calloc(1, sizeof(struct hg_core_stats));
+        if (!new_stats)
+            return NULL;
+
+        /* Another thread of the same shard may have allocated it first */
+        if (hg_atomic_cas64(&private_rpc_info->stats[shard], 0,
+                (hg_util_int64_t) new_stats))
+            stats = new_stats;
+        else {
+            free(new_stats);
+            stats = (struct hg_core_stats *) hg_atomic_get64(
+                &private_rpc_info->stats[shard]);
+        }
+    }
+
+    return stats;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_stats_add(hg_atomic_int64_t *counter, hg_util_int64_t value)
+{
+    hg_util_int64_t old_value;
+
+    do {
+        old_value = hg_atomic_get64(counter);
+    } while (!hg_atomic_cas64(counter, old_value, old_value + value));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_hist_record(
+    struct hg_core_stats_hist *hist, hg_time_t start, hg_time_t end)
+{
+    double elapsed = hg_time_diff(end, start) * 1e9;
+    hg_uint64_t value = (elapsed > 0) ? (hg_uint64_t) elapsed : 0;
+    hg_util_int64_t max;
+
+    hg_atomic_incr64(&hist->count);
+    hg_core_stats_add(&hist->sum, (hg_util_int64_t) value);
+    hg_atomic_incr64(&hist->buckets[hg_core_stats_hist_bucket(value)]);
+    do {
+        max = hg_atomic_get64(&hist->max);
+    } while ((hg_uint64_t) max < value &&
+             !hg_atomic_cas64(&hist->max, max, (hg_util_int64_t) value));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_stats_hist_bucket(hg_uint64_t value)
+{
+    unsigned int exp = HG_STATS_HIST_SUB_BITS, index;
+
+    /* Values below 2^(sub_bits + 1) have their own bucket */
+    if (value < (1 << (HG_STATS_HIST_SUB_BITS + 1)))
+        return (unsigned int) value;
+
+    /* Otherwise 2^sub_bits buckets per power of two */
+    while (exp < 63 && (value >> (exp + 1)) != 0)
+        exp++;
+    index = ((exp - HG_STATS_HIST_SUB_BITS + 1) << HG_STATS_HIST_SUB_BITS) +
+            (unsigned int) ((value >> (exp - HG_STATS_HIST_SUB_BITS)) &
+                            ((1 << HG_STATS_HIST_SUB_BITS) - 1));
+
+    return (index < HG_STATS_HIST_BUCKETS) ? index
+                                           : HG_STATS_HIST_BUCKETS - 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_forward(struct hg_core_private_handle *hg_core_handle)
+{
+    struct hg_core_stats *stats =
+        hg_core_stats_shard(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            hg_core_handle->core_handle.rpc_info);
+
+    if (!stats)
+        return;
+
+    hg_atomic_incr64(&stats->counters[HG_CORE_STATS_FORWARD_COUNT]);
+    if (hg_core_handle->in_header.msg.request.flags & HG_CORE_MORE_DATA)
+        hg_atomic_incr64(&stats->counters[HG_CORE_STATS_OVERFLOW_COUNT]);
+    if (hg_core_handle->ret != HG_SUCCESS)
+        return;
+    if (!hg_core_handle->no_response &&
+        (hg_core_handle->out_header.msg.response.flags & HG_CORE_MORE_DATA))
+        hg_atomic_incr64(&stats->counters[HG_CORE_STATS_OVERFLOW_COUNT]);
+
+    /* Only RPCs that completed through NA are timed */
+    if (hg_core_handle->is_self)
+        return;
+
+    /* NA does not report the size of expected messages, response bytes are
+     * therefore only counted by the target */
+    hg_core_stats_add(&stats->counters[HG_CORE_STATS_BYTES_OUT],
+        (hg_util_int64_t) hg_core_handle->in_buf_used);
+    hg_core_stats_hist_record(&stats->latency[HG_STATS_FORWARD],
+        hg_core_handle->stats_start, hg_core_handle->stats_mid);
+
+    /* Response may be received before send completion is reported */
+    if (!hg_core_handle->no_response)
+        hg_core_stats_hist_record(&stats->latency[HG_STATS_RESPONSE],
+            hg_core_handle->stats_mid, hg_core_handle->stats_end);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_process(struct hg_core_private_handle *hg_core_handle)
+{
+    struct hg_core_stats *stats =
+        hg_core_stats_shard(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            hg_core_handle->core_handle.rpc_info);
+
+    if (!stats)
+        return;
+
+    hg_atomic_incr64(&stats->counters[HG_CORE_STATS_HANDLE_COUNT]);
+    if (hg_core_handle->in_header.msg.request.flags & HG_CORE_MORE_DATA)
+        hg_atomic_incr64(&stats->counters[HG_CORE_STATS_OVERFLOW_COUNT]);
+
+    if (hg_core_handle->is_self)
+        return;
+
+    hg_core_stats_add(&stats->counters[HG_CORE_STATS_BYTES_IN],
+        (hg_util_int64_t) hg_core_handle->in_buf_used);
+    hg_time_get_current(&hg_core_handle->stats_mid);
+    hg_core_stats_hist_record(&stats->latency[HG_STATS_QUEUE],
+        hg_core_handle->stats_start, hg_core_handle->stats_mid);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_respond(struct hg_core_private_handle *hg_core_handle)
+{
+    struct hg_core_stats *stats =
+        hg_core_stats_shard(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            hg_core_handle->core_handle.rpc_info);
+    hg_time_t now;
+
+    if (!stats)
+        return;
+
+    if (hg_core_handle->out_header.msg.response.flags & HG_CORE_MORE_DATA)
+        hg_atomic_incr64(&stats->counters[HG_CORE_STATS_OVERFLOW_COUNT]);
+
+    if (hg_core_handle->is_self)
+        return;
+
+    hg_core_stats_add(&stats->counters[HG_CORE_STATS_BYTES_OUT],
+        (hg_util_int64_t) hg_core_handle->out_buf_used);
+    hg_time_get_current(&now);
+    hg_core_stats_hist_record(&stats->latency[HG_STATS_HANDLER],
+        hg_core_handle->stats_mid, now);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_free(struct hg_core_private_rpc_info *hg_core_rpc_info)
+{
+    unsigned int i;
+
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++)
+        free((struct hg_core_stats *) hg_atomic_get64(
+            &hg_core_rpc_info->stats[i]));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_stats_reset(struct hg_core_private_rpc_info *hg_core_rpc_info)
+{
+    unsigned int i, j, k;
+
+    /* Shards are kept, counters may still be updated concurrently */
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++) {
+        struct hg_core_stats *stats = (struct hg_core_stats *) hg_atomic_get64(
+            &hg_core_rpc_info->stats[i]);
+
+        if (!stats)
+            continue;
+        for (j = 0; j < HG_CORE_STATS_COUNTER_MAX; j++)
+            hg_atomic_set64(&stats->counters[j], 0);
+        for (j = 0; j < HG_STATS_PHASE_MAX; j++) {
+            hg_atomic_set64(&stats->latency[j].count, 0);
+            hg_atomic_set64(&stats->latency[j].sum, 0);
+            hg_atomic_set64(&stats->latency[j].max, 0);
+            for (k = 0; k < HG_STATS_HIST_BUCKETS; k++)
+                hg_atomic_set64(&stats->latency[j].buckets[k], 0);
+        }
+    }
 }
 
 /*---------------------------------------------------------------------------*/
@@ -795,7 +1505,7 @@ hg_core_context_lists_wait(struct hg_core_private_context *context)
 
         /* Trigger everything we can from HG */
         do {
-            trigger_ret = hg_core_trigger(context, 0, 1, &actual_count);
+            trigger_ret = hg_core_trigger(context, 0, 1, NULL, &actual_count);
         } while ((trigger_ret == HG_SUCCESS) && actual_count);
         HG_CHECK_ERROR(trigger_ret != HG_SUCCESS && trigger_ret != HG_TIMEOUT,
             done, ret, trigger_ret, "Could not trigger entry");
@@ -842,6 +1552,7 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
     na_tag_t na_sm_max_tag;
     hg_bool_t auto_sm = HG_FALSE;
 #endif
+    unsigned int i;
     hg_return_t ret = HG_SUCCESS;
 
     /* Create new HG class */
@@ -859,6 +1570,11 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
             hg_core_class->na_ext_init = HG_TRUE;
         }
         hg_core_class->progress_mode = hg_init_info->na_init_info.progress_mode;
+        hg_core_class->max_spin_time = hg_init_info->na_init_info.max_spin_time;
+        hg_core_class->handle_pool_size = hg_init_info->handle_pool_size;
+        hg_core_class->addr_cache_size = hg_init_info->addr_cache_size;
+        hg_core_class->addr_cache_ttl = hg_init_info->addr_cache_ttl;
+        hg_core_class->addr_cache_neg_ttl = hg_init_info->addr_cache_neg_ttl;
 #ifdef HG_HAS_SM_ROUTING
         auto_sm = hg_init_info->auto_sm;
 #else
@@ -876,6 +1592,10 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
         }
 #endif
     }
+    if (hg_core_class->max_spin_time == 0)
+        hg_core_class->max_spin_time = NA_SPIN_TIME_DEFAULT;
+    else if (hg_core_class->max_spin_time < HG_CORE_SPIN_TIME_MIN)
+        hg_core_class->max_spin_time = HG_CORE_SPIN_TIME_MIN;
 
     /* Initialize NA if not provided externally */
     if (!hg_core_class->na_ext_init) {
@@ -927,6 +1647,20 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
     }
 #endif
 
+    /* Create registration cache */
+    if (hg_init_info && hg_init_info->bulk_cache_size > 0) {
+        hg_core_class->core_class.bulk_cache =
+            hg_bulk_cache_create(hg_core_class->core_class.na_class,
+#ifdef HG_HAS_SM_ROUTING
+                hg_core_class->core_class.na_sm_class,
+#else
+                NULL,
+#endif
+                hg_init_info->bulk_cache_size);
+        HG_CHECK_ERROR(hg_core_class->core_class.bulk_cache == NULL, error,
+            ret, HG_NOMEM, "Could not create registration cache");
+    }
+
     /* Initialize atomic for tags */
     hg_atomic_init32(&hg_core_class->request_tag, 0);
 
@@ -936,18 +1670,54 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
     /* No addr created yet */
     hg_atomic_init32(&hg_core_class->n_addrs, 0);
 
-    /* Create new function map */
-    hg_core_class->func_map =
-        hg_hash_table_new(hg_core_int_hash, hg_core_int_equal);
-    HG_CHECK_ERROR(hg_core_class->func_map == NULL, error, ret, HG_NOMEM,
-        "Could not create function map");
+    /* Create addr cache, cached addrs never expire if addr_cache_ttl is 0
+     * and failed lookups are only cached if addr_cache_neg_ttl is not 0 */
+    hg_thread_mutex_init(&hg_core_class->addr_cache_mutex);
+    if (hg_core_class->addr_cache_size > 0) {
+        hg_core_class->addr_cache = hg_hash_map_new(
+            hg_core_addr_cache_hash, hg_core_addr_cache_equal);
+        HG_CHECK_ERROR(hg_core_class->addr_cache == NULL, error, ret,
+            HG_NOMEM, "Could not create addr cache");
+    }
 
-    /* Automatically free all the values with the hash map */
-    hg_hash_table_register_free_functions(
-        hg_core_class->func_map, free, hg_core_func_map_value_free);
+    /* Create batch lookup pool */
+    if (hg_init_info && hg_init_info->addr_lookup_pool_size > 0) {
+        HG_CHECK_ERROR(
+            hg_thread_pool_init(hg_init_info->addr_lookup_pool_size,
+                &hg_core_class->addr_lookup_pool) != HG_UTIL_SUCCESS,
+            error, ret, HG_NOMEM, "Could not create addr lookup pool");
+        hg_core_class->addr_lookup_pool_size =
+            hg_init_info->addr_lookup_pool_size;
+    }
 
-    /* Initialize mutex */
+    /* Create new (empty) function map */
+    hg_atomic_init64(&hg_core_class->func_map, 0);
+    hg_atomic_init32(&hg_core_class->func_map_epoch, 0);
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++) {
+        hg_atomic_init32(&hg_core_class->func_map_readers[i].count[0], 0);
+        hg_atomic_init32(&hg_core_class->func_map_readers[i].count[1], 0);
+    }
     hg_thread_spin_init(&hg_core_class->func_map_lock);
+    ret = hg_core_func_map_update(hg_core_class, 0, NULL);
+    HG_CHECK_HG_ERROR(error, ret, "Could not create function map");
+
+    /* RPC stats are disabled by default */
+    hg_atomic_init32(&hg_core_class->stats_enabled, 0);
+    hg_atomic_init32(&hg_core_class->stats_shards, 0);
+    HG_CHECK_ERROR(hg_thread_key_create(&hg_core_class->stats_key) !=
+                       HG_UTIL_SUCCESS,
+        error, ret, HG_NOMEM, "Could not create stats key");
+    hg_core_class->stats_key_created = HG_TRUE;
+
+    /* Tracing can be enabled from the environment, events are then dumped to
+     * HG_TRACE_FILE.<pid> when the class is finalized */
+    if (getenv("HG_TRACE_FILE")) {
+        hg_core_class->trace_file = strdup(getenv("HG_TRACE_FILE"));
+        HG_CHECK_ERROR(hg_core_class->trace_file == NULL, error, ret, HG_NOMEM,
+            "Could not duplicate trace file name");
+        HG_CHECK_ERROR(hg_trace_enable(1) != HG_UTIL_SUCCESS, error, ret,
+            HG_NOMEM, "Could not enable tracing");
+    }
 
     // TODO
     (void) ret;
@@ -974,14 +1744,26 @@ hg_core_finalize(struct hg_core_private_class *hg_core_class)
         "HG contexts must be destroyed before finalizing HG (%d remaining)",
         n_contexts);
 
+    /* Pending batch lookups must complete before releasing cached addrs */
+    if (hg_core_class->addr_lookup_pool) {
+        HG_CHECK_ERROR(hg_thread_pool_destroy(
+                           hg_core_class->addr_lookup_pool) != HG_UTIL_SUCCESS,
+            done, ret, HG_FAULT, "Could not destroy addr lookup pool");
+        hg_core_class->addr_lookup_pool = NULL;
+    }
+    hg_core_addr_cache_destroy(hg_core_class);
+
     n_addrs = hg_atomic_get32(&hg_core_class->n_addrs);
     HG_CHECK_ERROR(n_addrs != 0, done, ret, HG_BUSY,
         "HG addrs must be freed before finalizing HG (%d remaining)", n_addrs);
 
+    /* Release cached registrations */
+    ret = hg_bulk_cache_destroy(hg_core_class->core_class.bulk_cache);
+    HG_CHECK_HG_ERROR(done, ret, "Could not destroy registration cache");
+    hg_core_class->core_class.bulk_cache = NULL;
+
     /* Delete function map */
-    if (hg_core_class->func_map)
-        hg_hash_table_free(hg_core_class->func_map);
-    hg_core_class->func_map = NULL;
+    hg_core_func_map_free(hg_core_class);
 
     /* Free user data */
     if (hg_core_class->core_class.data_free_callback)
@@ -990,6 +1772,21 @@ hg_core_finalize(struct hg_core_private_class *hg_core_class)
 
     /* Destroy mutex */
     hg_thread_spin_destroy(&hg_core_class->func_map_lock);
+    hg_thread_mutex_destroy(&hg_core_class->addr_cache_mutex);
+
+    if (hg_core_class->stats_key_created)
+        hg_thread_key_delete(hg_core_class->stats_key);
+
+    if (hg_core_class->trace_file) {
+        char trace_path[1024];
+
+        snprintf(trace_path, sizeof(trace_path), "%s.%d",
+            hg_core_class->trace_file, (int) getpid());
+        HG_CHECK_WARNING(hg_trace_dump(trace_path) != HG_UTIL_SUCCESS,
+            "Could not dump trace to %s", trace_path);
+        free(hg_core_class->trace_file);
+        hg_core_class->trace_file = NULL;
+    }
 
     if (!hg_core_class->na_ext_init) {
         /* Finalize interface */
@@ -1033,16 +1830,115 @@ hg_core_addr_create(
 #endif
     hg_atomic_init32(&hg_core_addr->ref_count, 1);
 
-    /* Increment N addrs from HG class */
-    hg_atomic_incr32(&hg_core_class->n_addrs);
+    /* Increment N addrs from HG class */
+    hg_atomic_incr32(&hg_core_class->n_addrs);
+
+done:
+    return hg_core_addr;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_lookup(struct hg_core_private_class *hg_core_class,
+    const char *name, struct hg_core_private_addr **addr)
+{
+    struct hg_core_addr_cache_entry *entry, *new_entry = NULL,
+                                            *old_entry = NULL,
+                                            *evicted_entry = NULL;
+    struct hg_core_private_addr *hg_core_addr = NULL;
+    hg_hash_map_key_t key = (hg_hash_map_key_t) (size_t) name; /* Not const */
+    hg_time_t now;
+    unsigned int ttl_ms;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_core_class->addr_cache) {
+        ret = hg_core_addr_resolve(hg_core_class, name, addr);
+        goto done;
+    }
+
+    hg_time_get_current_ms(&now);
+
+    /* Look for a cached addr or a cached failure */
+    hg_thread_mutex_lock(&hg_core_class->addr_cache_mutex);
+    entry = (struct hg_core_addr_cache_entry *) hg_hash_map_lookup(
+        hg_core_class->addr_cache, key);
+    if (entry != HG_HASH_MAP_NULL) {
+        if (entry->expires && hg_time_less(entry->expire, now)) {
+            hg_hash_map_remove(
+                hg_core_class->addr_cache, (hg_hash_map_key_t) entry->name);
+            old_entry = entry;
+        } else {
+            entry->last_use = ++hg_core_class->addr_cache_clock;
+            ret = entry->ret;
+            if (entry->hg_core_addr) {
+                hg_atomic_incr32(&entry->hg_core_addr->ref_count);
+                *addr = entry->hg_core_addr;
+            }
+            hg_thread_mutex_unlock(&hg_core_class->addr_cache_mutex);
+            goto done;
+        }
+    }
+    hg_thread_mutex_unlock(&hg_core_class->addr_cache_mutex);
+    hg_core_addr_cache_entry_free(hg_core_class, old_entry);
+    old_entry = NULL;
+
+    /* Resolve without holding the lock so that lookups of other names can
+     * proceed concurrently */
+    ret = hg_core_addr_resolve(hg_core_class, name, &hg_core_addr);
+    if (ret != HG_SUCCESS && hg_core_class->addr_cache_neg_ttl == 0)
+        goto done;
+
+    /* Failing to cache the result does not fail the lookup, the name is
+     * stored right after the entry */
+    new_entry = (struct hg_core_addr_cache_entry *) malloc(
+        sizeof(struct hg_core_addr_cache_entry) + strlen(name) + 1);
+    HG_CHECK_ERROR_NORET(
+        new_entry == NULL, out, "Could not allocate addr cache entry");
+    new_entry->name = (char *) (new_entry + 1);
+    strcpy(new_entry->name, name);
+    new_entry->ret = ret;
+    if (ret == HG_SUCCESS) {
+        /* Cache holds its own reference */
+        hg_atomic_incr32(&hg_core_addr->ref_count);
+        new_entry->hg_core_addr = hg_core_addr;
+        ttl_ms = hg_core_class->addr_cache_ttl;
+    } else {
+        new_entry->hg_core_addr = NULL;
+        ttl_ms = hg_core_class->addr_cache_neg_ttl;
+    }
+    new_entry->expire =
+        hg_time_add(now, hg_time_from_double((double) ttl_ms / 1000.0));
+    new_entry->expires = (ttl_ms != 0);
+
+    hg_thread_mutex_lock(&hg_core_class->addr_cache_mutex);
+    if (hg_hash_map_lookup(hg_core_class->addr_cache, key) !=
+        HG_HASH_MAP_NULL) {
+        /* Another thread cached the same name first, keep its entry */
+        old_entry = new_entry;
+    } else {
+        if (hg_hash_map_num_entries(hg_core_class->addr_cache) >=
+            hg_core_class->addr_cache_size)
+            evicted_entry = hg_core_addr_cache_evict(hg_core_class, now);
+        new_entry->last_use = ++hg_core_class->addr_cache_clock;
+        if (!hg_hash_map_insert(hg_core_class->addr_cache,
+                (hg_hash_map_key_t) new_entry->name, new_entry))
+            old_entry = new_entry;
+    }
+    hg_thread_mutex_unlock(&hg_core_class->addr_cache_mutex);
+    hg_core_addr_cache_entry_free(hg_core_class, evicted_entry);
+    hg_core_addr_cache_entry_free(hg_core_class, old_entry);
+
+out:
+    if (ret == HG_SUCCESS)
+        *addr = hg_core_addr;
 
 done:
-    return hg_core_addr;
+    return ret;
 }
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
-hg_core_addr_lookup(struct hg_core_private_class *hg_core_class,
+hg_core_addr_resolve(struct hg_core_private_class *hg_core_class,
     const char *name, struct hg_core_private_addr **addr)
 {
     na_class_t *na_class = hg_core_class->core_class.na_class;
@@ -1117,6 +2013,128 @@ error:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_addr_cache_hash(hg_hash_map_key_t key)
+{
+    return hg_hash_string((const char *) key);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_core_addr_cache_equal(hg_hash_map_key_t key1, hg_hash_map_key_t key2)
+{
+    return strcmp((const char *) key1, (const char *) key2) == 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_core_addr_cache_entry *
+hg_core_addr_cache_evict(
+    struct hg_core_private_class *hg_core_class, hg_time_t now)
+{
+    struct hg_core_addr_cache_entry *victim = NULL;
+    hg_hash_map_iter_t iter;
+
+    /* Entries are only scanned when the cache is full, prefer any expired
+     * entry over the least recently used one */
+    hg_hash_map_iterate(hg_core_class->addr_cache, &iter);
+    while (hg_hash_map_iter_has_more(&iter)) {
+        struct hg_core_addr_cache_entry *entry =
+            (struct hg_core_addr_cache_entry *) hg_hash_map_iter_next(&iter);
+
+        if (entry->expires && hg_time_less(entry->expire, now)) {
+            victim = entry;
+            break;
+        }
+        if (victim == NULL || entry->last_use < victim->last_use)
+            victim = entry;
+    }
+
+    if (victim)
+        hg_hash_map_remove(
+            hg_core_class->addr_cache, (hg_hash_map_key_t) victim->name);
+
+    return victim;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_addr_cache_entry_free(struct hg_core_private_class *hg_core_class,
+    struct hg_core_addr_cache_entry *entry)
+{
+    hg_return_t ret;
+
+    if (!entry)
+        return;
+
+    if (entry->hg_core_addr) {
+        ret = hg_core_addr_free(hg_core_class, entry->hg_core_addr);
+        HG_CHECK_ERROR_DONE(ret != HG_SUCCESS, "Could not free cached addr");
+    }
+    free(entry);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_addr_cache_destroy(struct hg_core_private_class *hg_core_class)
+{
+    hg_hash_map_iter_t iter;
+
+    if (!hg_core_class->addr_cache)
+        return;
+
+    hg_hash_map_iterate(hg_core_class->addr_cache, &iter);
+    while (hg_hash_map_iter_has_more(&iter))
+        hg_core_addr_cache_entry_free(hg_core_class,
+            (struct hg_core_addr_cache_entry *) hg_hash_map_iter_next(&iter));
+    hg_hash_map_free(hg_core_class->addr_cache);
+    hg_core_class->addr_cache = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_lookup_batch_run(struct hg_core_lookup_batch *batch)
+{
+    struct hg_core_private_context *context = batch->op_id.context;
+    hg_util_int32_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Workers claim names one at a time so that slow lookups do not hold
+     * back the others */
+    while ((i = hg_atomic_incr32(&batch->next) - 1) <
+           (hg_util_int32_t) batch->count) {
+        hg_return_t lookup_ret = hg_core_addr_lookup(
+            HG_CORE_CONTEXT_CLASS(context), batch->names[i], &batch->addrs[i]);
+        if (lookup_ret != HG_SUCCESS) {
+            batch->addrs[i] = NULL;
+            hg_atomic_cas32(&batch->ret, HG_SUCCESS, lookup_ret);
+        }
+    }
+
+    /* Last worker completes the batch */
+    if (hg_atomic_decr32(&batch->n_workers) == 0) {
+        batch->op_id.ret = (hg_return_t) hg_atomic_get32(&batch->ret);
+        ret = hg_core_completion_add(&context->core_context,
+            &batch->op_id.hg_completion_entry, HG_TRUE);
+        HG_CHECK_HG_ERROR(done, ret,
+            "Could not add HG completion entry to completion queue");
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_core_addr_lookup_batch_thread(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+
+    (void) hg_core_addr_lookup_batch_run((struct hg_core_lookup_batch *) arg);
+
+    return thread_ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_core_addr_free(struct hg_core_private_class *hg_core_class,
@@ -1298,9 +2316,111 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static struct hg_core_handle_pool *
+hg_core_handle_pool_create(unsigned int max_count)
+{
+    struct hg_core_handle_pool *hg_core_handle_pool = NULL;
+    unsigned int queue_size = 2;
+
+    hg_core_handle_pool = (struct hg_core_handle_pool *) malloc(
+        sizeof(struct hg_core_handle_pool));
+    HG_CHECK_ERROR_NORET(
+        hg_core_handle_pool == NULL, error, "Could not allocate handle pool");
+    memset(hg_core_handle_pool, 0, sizeof(struct hg_core_handle_pool));
+
+    /* Atomic queue size must be a power of 2 and always keeps one slot empty,
+     * make sure that it can hold max_count entries */
+    while (queue_size <= max_count)
+        queue_size <<= 1;
+    hg_core_handle_pool->free_list = hg_atomic_queue_alloc(queue_size);
+    HG_CHECK_ERROR_NORET(hg_core_handle_pool->free_list == NULL, error,
+        "Could not allocate handle pool free list");
+
+    hg_atomic_init32(&hg_core_handle_pool->count, 0);
+    hg_core_handle_pool->max_count = max_count;
+    hg_core_stat_init(&hg_core_handle_pool->hit_count, 0);
+    hg_core_stat_init(&hg_core_handle_pool->miss_count, 0);
+
+    return hg_core_handle_pool;
+
+error:
+    free(hg_core_handle_pool);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_handle_pool_destroy(struct hg_core_handle_pool *hg_core_handle_pool)
+{
+    struct hg_core_private_handle *hg_core_handle;
+
+    if (!hg_core_handle_pool)
+        return;
+
+    /* Free cached handles and their NA resources */
+    while ((hg_core_handle = (struct hg_core_private_handle *)
+                    hg_atomic_queue_pop_mc(hg_core_handle_pool->free_list)))
+        hg_core_free(hg_core_handle);
+
+    hg_atomic_queue_free(hg_core_handle_pool->free_list);
+    free(hg_core_handle_pool);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE struct hg_core_private_handle *
+hg_core_handle_pool_get(struct hg_core_handle_pool *hg_core_handle_pool)
+{
+    struct hg_core_private_handle *hg_core_handle;
+
+    hg_core_handle = (struct hg_core_private_handle *) hg_atomic_queue_pop_mc(
+        hg_core_handle_pool->free_list);
+    if (hg_core_handle) {
+        hg_atomic_decr32(&hg_core_handle_pool->count);
+        hg_core_stat_incr(&hg_core_handle_pool->hit_count);
+    } else
+        hg_core_stat_incr(&hg_core_handle_pool->miss_count);
+
+    return hg_core_handle;
+}
+
 /*---------------------------------------------------------------------------*/
 static struct hg_core_private_handle *
 hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
+{
+    struct hg_core_handle_pool *hg_core_handle_pool =
+        HG_CORE_CONTEXT_HANDLE_POOL(context, use_sm);
+    struct hg_core_private_handle *hg_core_handle = NULL;
+
+    /* Re-use handle and its NA resources if one is available */
+    if (hg_core_handle_pool)
+        hg_core_handle = hg_core_handle_pool_get(hg_core_handle_pool);
+    if (!hg_core_handle) {
+        hg_core_handle = hg_core_alloc(context, use_sm);
+        HG_CHECK_ERROR_NORET(
+            hg_core_handle == NULL, error, "Could not allocate handle");
+    }
+
+    /* Add handle to handle list so that we can track it */
+    hg_thread_spin_lock(&context->created_list_lock);
+    HG_LIST_INSERT_HEAD(&context->created_list, hg_core_handle, created);
+    hg_thread_spin_unlock(&context->created_list_lock);
+
+    /* Set refcount to 1 */
+    hg_atomic_init32(&hg_core_handle->ref_count, 1);
+
+    /* Increment N handles from HG context */
+    hg_atomic_incr32(&context->n_handles);
+
+    return hg_core_handle;
+
+error:
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_core_private_handle *
+hg_core_alloc(struct hg_core_private_context *context, hg_bool_t use_sm)
 {
     struct hg_core_private_handle *hg_core_handle = NULL;
     hg_return_t ret = HG_SUCCESS;
@@ -1323,14 +2443,6 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     /* Default return code */
     hg_core_handle->ret = HG_SUCCESS;
 
-    /* Add handle to handle list so that we can track it */
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
-    HG_LIST_INSERT_HEAD(&HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list,
-        hg_core_handle, created);
-    hg_thread_spin_unlock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
-
     /* Handle is not in use */
     hg_atomic_init32(&hg_core_handle->in_use, HG_FALSE);
 
@@ -1344,12 +2456,6 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     hg_core_header_request_init(&hg_core_handle->in_header);
     hg_core_header_response_init(&hg_core_handle->out_header);
 
-    /* Set refcount to 1 */
-    hg_atomic_init32(&hg_core_handle->ref_count, 1);
-
-    /* Increment N handles from HG context */
-    hg_atomic_incr32(&context->n_handles);
-
     /* Alloc/init NA resources */
     ret = hg_core_alloc_na(hg_core_handle, use_sm);
     HG_CHECK_HG_ERROR(error, ret, "Could not allocate NA handle ops");
@@ -1357,7 +2463,8 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     return hg_core_handle;
 
 error:
-    hg_core_destroy(hg_core_handle);
+    if (hg_core_handle)
+        hg_core_free(hg_core_handle);
     return NULL;
 }
 
@@ -1384,7 +2491,81 @@ hg_core_destroy(struct hg_core_private_handle *hg_core_handle)
     /* Remove reference to HG addr */
     hg_core_addr_free(HG_CORE_HANDLE_CLASS(hg_core_handle),
         (struct hg_core_private_addr *) hg_core_handle->core_handle.info.addr);
+    hg_core_handle->core_handle.info.addr = HG_CORE_ADDR_NULL;
 
+    /* Keep handle in context pool if there is room left */
+    if (hg_core_recycle(hg_core_handle))
+        goto done;
+
+    hg_core_free(hg_core_handle);
+
+done:
+    return;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_core_recycle(struct hg_core_private_handle *hg_core_handle)
+{
+    struct hg_core_private_context *context =
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle);
+    struct hg_core_handle_pool *hg_core_handle_pool;
+    hg_bool_t HG_UNUSED use_sm = HG_FALSE;
+    int rc;
+
+#ifdef HG_HAS_SM_ROUTING
+    use_sm = (hg_core_handle->na_class ==
+              context->core_context.core_class->na_sm_class);
+#endif
+    hg_core_handle_pool = HG_CORE_CONTEXT_HANDLE_POOL(context, use_sm);
+
+    /* Handles that are being canceled may still be referenced by NA */
+    if (!hg_core_handle_pool || context->finalizing ||
+        hg_atomic_get32(&hg_core_handle->canceling))
+        return HG_FALSE;
+
+    /* Reserve slot */
+    if (hg_atomic_incr32(&hg_core_handle_pool->count) >
+        (hg_util_int32_t) hg_core_handle_pool->max_count) {
+        hg_atomic_decr32(&hg_core_handle_pool->count);
+        return HG_FALSE;
+    }
+
+    /* Reset handle state, NA buffers and op IDs are kept */
+    hg_core_reset(hg_core_handle, HG_TRUE);
+    hg_core_handle->core_handle.rpc_info = NULL;
+    hg_core_handle->forward = NULL;
+    hg_core_handle->respond = NULL;
+    hg_core_handle->no_respond = NULL;
+    hg_core_handle->repost = HG_FALSE;
+    hg_core_handle->is_self = HG_FALSE;
+    hg_atomic_set32(&hg_core_handle->in_use, HG_FALSE);
+    hg_atomic_set32(&hg_core_handle->posted, HG_FALSE);
+
+    /* Let upper layers release per-use data, otherwise free it */
+    if (context->handle_recycle)
+        context->handle_recycle(
+            (hg_core_handle_t) hg_core_handle, context->handle_recycle_arg);
+    else if (hg_core_handle->core_handle.data_free_callback) {
+        hg_core_handle->core_handle.data_free_callback(
+            hg_core_handle->core_handle.data);
+        hg_core_handle->core_handle.data = NULL;
+        hg_core_handle->core_handle.data_free_callback = NULL;
+    }
+
+    rc = hg_atomic_queue_push(hg_core_handle_pool->free_list, hg_core_handle);
+    if (rc != HG_UTIL_SUCCESS) {
+        hg_atomic_decr32(&hg_core_handle_pool->count);
+        return HG_FALSE;
+    }
+
+    return HG_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_free(struct hg_core_private_handle *hg_core_handle)
+{
     hg_core_header_request_finalize(&hg_core_handle->in_header);
     hg_core_header_response_finalize(&hg_core_handle->out_header);
 
@@ -1402,9 +2583,6 @@ hg_core_destroy(struct hg_core_private_handle *hg_core_handle)
     hg_core_free_na(hg_core_handle);
 
     free(hg_core_handle);
-
-done:
-    return;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -1571,6 +2749,7 @@ hg_core_reset(
     hg_core_handle->na_op_count = 1; /* Default (no response) */
     hg_atomic_set32(&hg_core_handle->na_op_completed_count, 0);
     hg_core_handle->no_response = HG_FALSE;
+    hg_core_handle->stats = HG_FALSE;
 
     /* Free extra data here if needed */
     if (HG_CORE_HANDLE_CLASS(hg_core_handle)->more_data_release)
@@ -1625,16 +2804,15 @@ hg_core_set_rpc(struct hg_core_private_handle *hg_core_handle,
 
     /* We also allow for NULL RPC id to be passed (same reason as above) */
     if (id && hg_core_handle->core_handle.info.id != id) {
+        struct hg_core_private_class *hg_core_class =
+            HG_CORE_HANDLE_CLASS(hg_core_handle);
         struct hg_core_rpc_info *hg_core_rpc_info;
+        hg_atomic_int32_t *readers;
 
         /* Retrieve ID function from function map */
-        hg_thread_spin_lock(
-            &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
-        hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
-            HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map,
-            (hg_hash_table_key_t) &id);
-        hg_thread_spin_unlock(
-            &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
+        readers = hg_core_func_map_read_lock(hg_core_class);
+        hg_core_rpc_info = hg_core_func_map_lookup(hg_core_class, id);
+        hg_core_func_map_read_unlock(readers);
         if (!hg_core_rpc_info)
             HG_GOTO_DONE(done, ret, HG_NOENTRY);
 
@@ -1879,6 +3057,11 @@ hg_core_send_input_cb(const struct na_cb_info *callback_info)
     hg_bool_t completed = HG_TRUE;
     hg_return_t ret;
 
+    if (hg_core_handle->stats)
+        hg_time_get_current(&hg_core_handle->stats_mid);
+    HG_CORE_HANDLE_TRACE(hg_core_handle, HG_TRACE_CORE_SEND_COMPLETE,
+        hg_core_handle->core_handle.info.id);
+
     /* If canceled, mark handle as canceled */
     if (callback_info->ret == NA_CANCELED)
         hg_core_handle->ret = HG_CANCELED;
@@ -1939,6 +3122,12 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
     /* Reset ret value */
     hg_core_handle->ret = HG_SUCCESS;
 
+    /* Record stats when processed if enabled */
+    hg_core_handle->stats = (hg_bool_t) hg_atomic_get32(
+        &HG_CORE_HANDLE_CLASS(hg_core_handle)->stats_enabled);
+    if (hg_core_handle->stats)
+        hg_time_get_current(&hg_core_handle->stats_start);
+
     /* Fill unexpected info */
     hg_core_handle->core_handle.info.addr->na_addr =
         na_cb_info_recv_unexpected->source;
@@ -2006,6 +3195,8 @@ hg_core_process_input(
     ret = hg_core_proc_header_request(
         &hg_core_handle->core_handle, &hg_core_handle->in_header, HG_DECODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not get request header");
+    HG_CORE_HANDLE_TRACE(
+        hg_core_handle, HG_TRACE_CORE_RECV_REQUEST, hg_core_handle->in_buf_used);
 
     /* Get operation ID from header */
     hg_core_handle->core_handle.info.id =
@@ -2106,6 +3297,9 @@ hg_core_recv_output_cb(const struct na_cb_info *callback_info)
         HG_CHECK_ERROR_NORET(callback_info->ret != NA_SUCCESS, done,
             "Error in NA callback (s)", NA_Error_to_string(callback_info->ret));
 
+    if (hg_core_handle->stats)
+        hg_time_get_current(&hg_core_handle->stats_end);
+
     /* Process output information */
     ret = hg_core_process_output(hg_core_handle, &completed, hg_core_send_ack);
     HG_CHECK_HG_ERROR(done, ret, "Could not process output");
@@ -2132,6 +3326,8 @@ hg_core_process_output(struct hg_core_private_handle *hg_core_handle,
     ret = hg_core_proc_header_response(
         &hg_core_handle->core_handle, &hg_core_handle->out_header, HG_DECODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not decode header");
+    HG_CORE_HANDLE_TRACE(hg_core_handle, HG_TRACE_CORE_RECV_RESPONSE,
+        hg_core_handle->core_handle.info.id);
 
     /* Get return code from header */
     hg_core_handle->ret =
@@ -2326,33 +3522,43 @@ done:
 static hg_return_t
 hg_core_process(struct hg_core_private_handle *hg_core_handle)
 {
+    struct hg_core_private_class *hg_core_class =
+        HG_CORE_HANDLE_CLASS(hg_core_handle);
     struct hg_core_rpc_info *hg_core_rpc_info;
+    hg_core_rpc_cb_t rpc_cb = NULL;
+    hg_atomic_int32_t *readers;
     hg_return_t ret = HG_SUCCESS;
 
     /* Retrieve exe function from function map */
-    hg_thread_spin_lock(&HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
-    hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
-        HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map,
-        (hg_hash_table_key_t) &hg_core_handle->core_handle.info.id);
-    hg_thread_spin_unlock(&HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
+    readers = hg_core_func_map_read_lock(hg_core_class);
+    hg_core_rpc_info = hg_core_func_map_lookup(
+        hg_core_class, hg_core_handle->core_handle.info.id);
+    if (hg_core_rpc_info)
+        rpc_cb = hg_core_rpc_info->rpc_cb;
+    hg_core_func_map_read_unlock(readers);
     if (!hg_core_rpc_info) {
         HG_LOG_WARNING("Could not find RPC ID in function map");
         ret = HG_NOENTRY;
         goto done;
     }
 
-    HG_CHECK_ERROR(hg_core_rpc_info->rpc_cb == NULL, done, ret, HG_INVALID_ARG,
-        "No RPC callback registered");
+    HG_CHECK_ERROR(
+        rpc_cb == NULL, done, ret, HG_INVALID_ARG, "No RPC callback registered");
 
     /* Cache RPC info */
     hg_core_handle->core_handle.rpc_info = hg_core_rpc_info;
 
+    if (hg_core_handle->stats)
+        hg_core_stats_process(hg_core_handle);
+    HG_CORE_HANDLE_TRACE(hg_core_handle, HG_TRACE_CORE_PROCESS,
+        hg_core_handle->core_handle.info.id);
+
     /* Increment ref count here so that a call to HG_Destroy in user's RPC
      * callback does not free the handle but only schedules its completion */
     hg_atomic_incr32(&hg_core_handle->ref_count);
 
     /* Execute RPC callback */
-    ret = hg_core_rpc_info->rpc_cb((hg_core_handle_t) hg_core_handle);
+    ret = rpc_cb((hg_core_handle_t) hg_core_handle);
     HG_CHECK_HG_ERROR(done, ret, "Error while executing RPC callback");
 
 done:
@@ -2417,6 +3623,7 @@ hg_core_completion_add(struct hg_core_context *context,
     struct hg_core_private_context *private_context =
         (struct hg_core_private_context *) context;
     hg_return_t ret = HG_SUCCESS;
+    int rc;
 
 #ifdef HG_HAS_COLLECT_STATS
     /* Increment counter */
@@ -2424,15 +3631,10 @@ hg_core_completion_add(struct hg_core_context *context,
         hg_core_stat_incr(&hg_core_bulk_count_g);
 #endif
 
-    if (hg_atomic_queue_push(private_context->completion_queue,
-            hg_completion_entry) != HG_UTIL_SUCCESS) {
-        /* Queue is full */
-        hg_thread_mutex_lock(&private_context->completion_queue_mutex);
-        HG_QUEUE_PUSH_TAIL(
-            &private_context->backfill_queue, hg_completion_entry, entry);
-        hg_atomic_incr32(&private_context->backfill_queue_count);
-        hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
-    }
+    rc = hg_mpmc_queue_push(
+        private_context->completion_queue, hg_completion_entry);
+    HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_NOMEM,
+        "Could not push completion entry to completion queue");
 
     if (hg_atomic_get32(&private_context->trigger_waiting)) {
         hg_thread_mutex_lock(&private_context->completion_queue_mutex);
@@ -2442,7 +3644,6 @@ hg_core_completion_add(struct hg_core_context *context,
         hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
     }
 
-#ifdef HG_HAS_SELF_FORWARD
     if (!(HG_CORE_CONTEXT_CLASS(private_context)->progress_mode &
             NA_NO_BLOCK) &&
         self_notify && (private_context->completion_queue_notify > 0)) {
@@ -2450,15 +3651,12 @@ hg_core_completion_add(struct hg_core_context *context,
         /* Do not bother notifying if it's not needed as any event call will
          * increase latency */
         if (hg_atomic_get32(&private_context->completion_queue_must_notify)) {
-            int rc = hg_event_set(private_context->completion_queue_notify);
+            rc = hg_event_set(private_context->completion_queue_notify);
             HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_FAULT,
                 "Could not signal completion queue");
         }
         hg_thread_mutex_unlock(&private_context->completion_queue_notify_mutex);
     }
-#else
-    (void) self_notify;
-#endif
 
 done:
     return ret;
@@ -2667,7 +3865,6 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-#ifdef HG_HAS_SELF_FORWARD
 static HG_INLINE hg_return_t
 hg_core_progress_loopback_notify(struct hg_core_private_context *context)
 {
@@ -2685,15 +3882,13 @@ hg_core_progress_loopback_notify(struct hg_core_private_context *context)
 done:
     return ret;
 }
-#endif
 
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_bool_t
 hg_core_poll_try_wait(struct hg_core_private_context *context)
 {
     /* Something is in one of the completion queues */
-    if (!hg_atomic_queue_is_empty(context->completion_queue) ||
-        (hg_atomic_get32(&context->backfill_queue_count) > 0))
+    if (!hg_mpmc_queue_is_empty(context->completion_queue))
         return HG_FALSE;
 
 #ifdef HG_HAS_SM_ROUTING
@@ -2710,6 +3905,84 @@ hg_core_poll_try_wait(struct hg_core_private_context *context)
     return HG_TRUE;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_progress_spin(
+    struct hg_core_private_context *context, double *remaining)
+{
+    double max_spin_time =
+        (double) HG_CORE_CONTEXT_CLASS(context)->max_spin_time / 1e6;
+    double min_spin_time = (double) HG_CORE_SPIN_TIME_MIN / 1e6;
+    double spin_time = context->spin_time, elapsed = 0;
+    hg_time_t t1, t2;
+    hg_return_t ret = HG_TIMEOUT;
+
+    /* Never spin past the requested timeout */
+    if (spin_time > *remaining)
+        spin_time = *remaining;
+
+    hg_time_get_current(&t1);
+    do {
+        hg_bool_t progressed = HG_FALSE;
+
+        /* There is stuff in the queues to process */
+        if (!hg_mpmc_queue_is_empty(context->completion_queue))
+            progressed = HG_TRUE;
+        else {
+#ifdef HG_HAS_SM_ROUTING
+            if (context->core_context.na_sm_context) {
+                ret = hg_core_progress_na(
+                    HG_CORE_CONTEXT_CLASS(context)->core_class.na_sm_class,
+                    context->core_context.na_sm_context, 0);
+                if (ret == HG_SUCCESS)
+                    progressed |= HG_TRUE;
+                else if (ret != HG_TIMEOUT)
+                    HG_CHECK_HG_ERROR(
+                        done, ret, "hg_core_progress_na() failed");
+            }
+#endif
+            ret = hg_core_progress_na(
+                HG_CORE_CONTEXT_CLASS(context)->core_class.na_class,
+                context->core_context.na_context, 0);
+            if (ret == HG_SUCCESS)
+                progressed |= HG_TRUE;
+            else if (ret != HG_TIMEOUT)
+                HG_CHECK_HG_ERROR(done, ret, "hg_core_progress_na() failed");
+        }
+
+        hg_time_get_current(&t2);
+        elapsed = hg_time_diff(t2, t1);
+        if (progressed) {
+            ret = HG_SUCCESS;
+            break;
+        }
+
+        cpu_spinwait();
+    } while (elapsed < spin_time);
+
+    if (ret == HG_SUCCESS) {
+        hg_core_stat_incr(&context->spin_count);
+
+        /* Progress was made late in the window, spin longer next time */
+        if (elapsed * 2.0 > context->spin_time)
+            context->spin_time = (context->spin_time * 2.0 < max_spin_time)
+                                     ? context->spin_time * 2.0
+                                     : max_spin_time;
+    } else {
+        /* Nothing arrived, spin less next time */
+        context->spin_time = (context->spin_time / 2.0 > min_spin_time)
+                                 ? context->spin_time / 2.0
+                                 : min_spin_time;
+    }
+
+    *remaining -= elapsed;
+    if (*remaining < 0)
+        *remaining = 0;
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
@@ -2718,6 +3991,17 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
         timeout / 1000.0; /* Convert timeout in ms into seconds */
     hg_return_t ret = HG_TIMEOUT;
 
+    /* Spin for a while before blocking, completions that arrive within that
+     * time then avoid the cost of a wake-up */
+    if ((HG_CORE_CONTEXT_CLASS(context)->progress_mode & NA_ADAPTIVE_SPIN) &&
+        context->poll_set && timeout &&
+        hg_mpmc_queue_is_empty(context->completion_queue)) {
+        ret = hg_core_progress_spin(context, &remaining);
+        if (ret != HG_TIMEOUT)
+            goto done;
+        hg_core_stat_incr(&context->block_count);
+    }
+
     do {
         hg_time_t t1, t2;
         hg_bool_t safe_wait = HG_FALSE;
@@ -2751,14 +4035,12 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
 
             for (i = 0; i < nevents; i++) {
                 switch (context->poll_events[i].data.u32) {
-#ifdef HG_HAS_SELF_FORWARD
                     case HG_CORE_POLL_LOOPBACK:
                         HG_LOG_DEBUG("HG_CORE_POLL_LOOPBACK event");
                         ret = hg_core_progress_loopback_notify(context);
                         HG_CHECK_HG_ERROR(done, ret,
                             "hg_core_progress_loopback_notify() failed");
                         break;
-#endif
 #ifdef HG_HAS_SM_ROUTING
                     case HG_CORE_POLL_SM:
                         HG_LOG_DEBUG("HG_CORE_POLL_SM event");
@@ -2831,8 +4113,7 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
         }
 
         /* There is stuff in the queues to process */
-        if (!hg_atomic_queue_is_empty(context->completion_queue) ||
-            (hg_atomic_get32(&context->backfill_queue_count) > 0)) {
+        if (!hg_mpmc_queue_is_empty(context->completion_queue)) {
             ret = HG_SUCCESS;
             break;
         }
@@ -2847,102 +4128,92 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_completion_dequeue(struct hg_core_private_context *context,
+    struct hg_completion_entry **hg_completion_entries, unsigned int max_count)
+{
+    return hg_mpmc_queue_pop_batch(
+        context->completion_queue, (void **) hg_completion_entries, max_count);
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
-    unsigned int max_count, unsigned int *actual_count)
+    unsigned int max_count, struct hg_completion_entry **hg_completion_entries,
+    unsigned int *actual_count)
 {
+    struct hg_completion_entry *hg_completion_batch[HG_CORE_TRIGGER_BATCH_SIZE];
     double remaining =
         timeout / 1000.0; /* Convert timeout in ms into seconds */
     unsigned int count = 0;
     hg_return_t ret = HG_SUCCESS;
 
     while (count < max_count) {
-        struct hg_completion_entry *hg_completion_entry = NULL;
-
-        hg_completion_entry = hg_atomic_queue_pop_mc(context->completion_queue);
-        if (!hg_completion_entry) {
-            /* Check backfill queue */
-            if (hg_atomic_get32(&context->backfill_queue_count)) {
-                hg_thread_mutex_lock(&context->completion_queue_mutex);
-                hg_completion_entry = HG_QUEUE_FIRST(&context->backfill_queue);
-                HG_QUEUE_POP_HEAD(&context->backfill_queue, entry);
-                hg_atomic_decr32(&context->backfill_queue_count);
-                hg_thread_mutex_unlock(&context->completion_queue_mutex);
-                if (!hg_completion_entry)
-                    continue; /* Give another change to grab it */
-            } else {
-                hg_time_t t1, t2;
+        struct hg_completion_entry **entries;
+        unsigned int n, i;
 
-                /* If something was already processed leave */
-                if (count)
-                    break;
+        /* Either return entries to caller or trigger them by batch */
+        if (hg_completion_entries) {
+            entries = hg_completion_entries + count;
+            n = max_count - count;
+        } else {
+            entries = hg_completion_batch;
+            n = HG_CORE_MIN(max_count - count, HG_CORE_TRIGGER_BATCH_SIZE);
+        }
 
-                /* Timeout is 0 so leave */
-                if ((int) (remaining * 1000.0) <= 0) {
-                    ret = HG_TIMEOUT;
-                    break;
-                }
+        n = hg_core_completion_dequeue(context, entries, n);
+        if (n == 0) {
+            hg_time_t t1, t2;
 
-                hg_time_get_current_ms(&t1);
-
-                hg_atomic_incr32(&context->trigger_waiting);
-                hg_thread_mutex_lock(&context->completion_queue_mutex);
-                /* Otherwise wait timeout ms */
-                while (hg_atomic_queue_is_empty(context->completion_queue) &&
-                       !hg_atomic_get32(&context->backfill_queue_count)) {
-                    if (hg_thread_cond_timedwait(
-                            &context->completion_queue_cond,
-                            &context->completion_queue_mutex,
-                            timeout) != HG_UTIL_SUCCESS) {
-                        /* Timeout occurred so leave */
-                        ret = HG_TIMEOUT;
-                        break;
-                    }
-                }
-                hg_thread_mutex_unlock(&context->completion_queue_mutex);
-                hg_atomic_decr32(&context->trigger_waiting);
-                if (ret == HG_TIMEOUT)
-                    break;
+            /* If something was already processed leave */
+            if (count)
+                break;
+
+            /* Timeout is 0 so leave */
+            if ((int) (remaining * 1000.0) <= 0) {
+                ret = HG_TIMEOUT;
+                break;
+            }
 
-                hg_time_get_current_ms(&t2);
-                remaining -= hg_time_diff(t2, t1);
-                continue; /* Give another change to grab it */
+            hg_time_get_current_ms(&t1);
+
+            hg_atomic_incr32(&context->trigger_waiting);
+            hg_thread_mutex_lock(&context->completion_queue_mutex);
+            /* Otherwise wait timeout ms */
+            while (hg_mpmc_queue_is_empty(context->completion_queue)) {
+                if (hg_thread_cond_timedwait(&context->completion_queue_cond,
+                        &context->completion_queue_mutex,
+                        timeout) != HG_UTIL_SUCCESS) {
+                    /* Timeout occurred so leave */
+                    ret = HG_TIMEOUT;
+                    break;
+                }
             }
+            hg_thread_mutex_unlock(&context->completion_queue_mutex);
+            hg_atomic_decr32(&context->trigger_waiting);
+            if (ret == HG_TIMEOUT)
+                break;
+
+            hg_time_get_current_ms(&t2);
+            remaining -= hg_time_diff(t2, t1);
+            continue; /* Give another change to grab it */
         }
 
-        /* Completion queue should not be empty now */
-        HG_CHECK_ERROR(hg_completion_entry == NULL, done, ret, HG_FAULT,
-            "NULL completion entry");
-
-        /* Trigger entry */
-        switch (hg_completion_entry->op_type) {
-            case HG_ADDR:
-                ret = hg_core_trigger_lookup_entry(
-                    hg_completion_entry->op_id.hg_core_op_id);
-                HG_CHECK_HG_ERROR(
-                    done, ret, "Could not trigger addr completion entry");
-                break;
-            case HG_RPC:
-                ret = hg_core_trigger_entry(
-                    (struct hg_core_private_handle *)
-                        hg_completion_entry->op_id.hg_core_handle);
-                HG_CHECK_HG_ERROR(
-                    done, ret, "Could not trigger RPC completion entry");
-                break;
-            case HG_BULK:
-                ret = hg_bulk_trigger_entry(
-                    hg_completion_entry->op_id.hg_bulk_op_id);
-                HG_CHECK_HG_ERROR(
-                    done, ret, "Could not trigger bulk completion entry");
-                break;
-            default:
-                HG_GOTO_ERROR(done, ret, HG_INVALID_ARG,
-                    "Invalid type of completion entry (%d)",
-                    (int) hg_completion_entry->op_type);
+        if (!hg_completion_entries) {
+            /* Trigger all dequeued entries so that none of them is lost,
+             * even if one of them fails */
+            for (i = 0; i < n; i++) {
+                hg_return_t trigger_ret =
+                    hg_core_trigger_completion(entries[i]);
+                if (trigger_ret != HG_SUCCESS && ret == HG_SUCCESS)
+                    ret = trigger_ret;
+            }
+            HG_CHECK_HG_ERROR(
+                done, ret, "Could not trigger completion entries");
         }
 
-        count++;
+        count += n;
     }
 
     if (actual_count)
@@ -2952,6 +4223,44 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_trigger_completion(struct hg_completion_entry *hg_completion_entry)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(hg_completion_entry == NULL, done, ret, HG_FAULT,
+        "NULL completion entry");
+
+    switch (hg_completion_entry->op_type) {
+        case HG_ADDR:
+            ret = hg_core_trigger_lookup_entry(
+                hg_completion_entry->op_id.hg_core_op_id);
+            HG_CHECK_HG_ERROR(
+                done, ret, "Could not trigger addr completion entry");
+            break;
+        case HG_RPC:
+            ret = hg_core_trigger_entry((struct hg_core_private_handle *)
+                    hg_completion_entry->op_id.hg_core_handle);
+            HG_CHECK_HG_ERROR(
+                done, ret, "Could not trigger RPC completion entry");
+            break;
+        case HG_BULK:
+            ret = hg_bulk_trigger_entry(
+                hg_completion_entry->op_id.hg_bulk_op_id);
+            HG_CHECK_HG_ERROR(
+                done, ret, "Could not trigger bulk completion entry");
+            break;
+        default:
+            HG_GOTO_ERROR(done, ret, HG_INVALID_ARG,
+                "Invalid type of completion entry (%d)",
+                (int) hg_completion_entry->op_type);
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_core_trigger_lookup_entry(struct hg_core_op_id *hg_core_op_id)
@@ -2963,7 +4272,7 @@ hg_core_trigger_lookup_entry(struct hg_core_op_id *hg_core_op_id)
         struct hg_core_cb_info hg_core_cb_info;
 
         hg_core_cb_info.arg = hg_core_op_id->arg;
-        hg_core_cb_info.ret = HG_SUCCESS;
+        hg_core_cb_info.ret = hg_core_op_id->ret;
         hg_core_cb_info.type = HG_CB_LOOKUP;
         hg_core_cb_info.info.lookup.addr =
             (hg_core_addr_t) hg_core_op_id->info.lookup.hg_core_addr;
@@ -2988,15 +4297,9 @@ hg_core_trigger_entry(struct hg_core_private_handle *hg_core_handle)
 
         /* Run RPC callback */
         ret = hg_core_process(hg_core_handle);
-        if (ret != HG_SUCCESS && !hg_core_handle->no_response) {
-            hg_size_t header_size =
-                hg_core_header_response_get_size() +
-                hg_core_handle->core_handle.na_out_header_offset;
-
+        if (ret != HG_SUCCESS) {
             /* Respond in case of error */
-            hg_core_handle->ret = ret;
-            ret = HG_Core_respond(
-                (hg_core_handle_t) hg_core_handle, NULL, NULL, 0, header_size);
+            ret = hg_core_respond_error((hg_core_handle_t) hg_core_handle, ret);
             HG_CHECK_HG_ERROR(done, ret, "Could not respond");
         }
 
@@ -3019,6 +4322,8 @@ hg_core_trigger_entry(struct hg_core_private_handle *hg_core_handle)
                 HG_FALLTHROUGH();
 #endif
             case HG_CORE_FORWARD:
+                if (hg_core_handle->stats)
+                    hg_core_stats_forward(hg_core_handle);
                 hg_cb = hg_core_handle->request_callback;
                 hg_core_cb_info.arg = hg_core_handle->request_arg;
                 hg_core_cb_info.type = HG_CB_FORWARD;
@@ -3051,6 +4356,8 @@ hg_core_trigger_entry(struct hg_core_private_handle *hg_core_handle)
         }
 
         /* Execute user callback */
+        HG_CORE_HANDLE_TRACE(
+            hg_core_handle, HG_TRACE_CORE_TRIGGER, hg_core_handle->op_type);
         if (hg_cb)
             hg_cb(&hg_core_cb_info);
     }
@@ -3189,13 +4496,10 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
 
     memset(context, 0, sizeof(struct hg_core_private_context));
     context->core_context.core_class = hg_core_class;
-    context->completion_queue =
-        hg_atomic_queue_alloc(HG_CORE_ATOMIC_QUEUE_SIZE);
+    context->completion_queue = hg_mpmc_queue_alloc();
     HG_CHECK_ERROR_NORET(
         context->completion_queue == NULL, error, "Could not allocate queue");
 
-    HG_QUEUE_INIT(&context->backfill_queue);
-    hg_atomic_init32(&context->backfill_queue_count, 0);
     HG_LIST_INIT(&context->pending_list);
 #ifdef HG_HAS_SM_ROUTING
     HG_LIST_INIT(&context->sm_pending_list);
@@ -3214,6 +4518,12 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
     hg_thread_cond_init(&context->completion_queue_cond);
     hg_atomic_init32(&context->trigger_waiting, 0);
 
+    /* Start spinning for the max amount of time and adjust from there */
+    hg_core_stat_init(&context->spin_count, 0);
+    hg_core_stat_init(&context->block_count, 0);
+    context->spin_time =
+        (double) HG_CORE_CONTEXT_CLASS(context)->max_spin_time / 1e6;
+
     hg_thread_spin_init(&context->pending_list_lock);
     hg_thread_spin_init(&context->created_list_lock);
 
@@ -3231,6 +4541,22 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
     }
 #endif
 
+    /* Create pools of free handles */
+    if (HG_CORE_CONTEXT_CLASS(context)->handle_pool_size > 0) {
+        context->handle_pool = hg_core_handle_pool_create(
+            HG_CORE_CONTEXT_CLASS(context)->handle_pool_size);
+        HG_CHECK_ERROR_NORET(context->handle_pool == NULL, error,
+            "Could not create handle pool");
+#ifdef HG_HAS_SM_ROUTING
+        if (hg_core_class->na_sm_class) {
+            context->sm_handle_pool = hg_core_handle_pool_create(
+                HG_CORE_CONTEXT_CLASS(context)->handle_pool_size);
+            HG_CHECK_ERROR_NORET(context->sm_handle_pool == NULL, error,
+                "Could not create SM handle pool");
+        }
+#endif
+    }
+
     /* If NA plugin exposes fd, we will use poll set and use appropriate
      * progress function */
     na_poll_fd = NA_Poll_get_fd(
@@ -3265,8 +4591,8 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
         }
 #endif
 
-#ifdef HG_HAS_SELF_FORWARD
-        /* Create event for completion queue notification */
+        /* Create event for completion queue notification (self forward and
+         * completions posted from other threads, e.g., batch lookups) */
         context->completion_queue_notify = hg_event_create();
         HG_CHECK_ERROR_NORET(context->completion_queue_notify < 0, error,
             "Could not create event");
@@ -3277,7 +4603,6 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
             context->poll_set, context->completion_queue_notify, &event);
         HG_CHECK_ERROR_NORET(
             rc != HG_UTIL_SUCCESS, error, "hg_poll_add() failed");
-#endif
     }
 
     /* Assign context ID */
@@ -3301,7 +4626,6 @@ HG_Core_context_destroy(hg_core_context_t *context)
         (struct hg_core_private_context *) context;
     unsigned int actual_count;
     hg_util_int32_t n_handles;
-    hg_bool_t empty;
     na_return_t na_ret;
     hg_return_t ret = HG_SUCCESS;
     int rc;
@@ -3359,30 +4683,30 @@ HG_Core_context_destroy(hg_core_context_t *context)
         goto done;
     }
 
-    /* Check that completion queue is empty now */
-    HG_CHECK_ERROR(!hg_atomic_queue_is_empty(private_context->completion_queue),
-        done, ret, HG_BUSY, "Completion queue should be empty");
-    hg_atomic_queue_free(private_context->completion_queue);
+    /* Free cached handles, this must be done before NA contexts are
+     * destroyed */
+    hg_core_handle_pool_destroy(private_context->handle_pool);
+    private_context->handle_pool = NULL;
+#ifdef HG_HAS_SM_ROUTING
+    hg_core_handle_pool_destroy(private_context->sm_handle_pool);
+    private_context->sm_handle_pool = NULL;
+#endif
 
     /* Check that completion queue is empty now */
-    hg_thread_mutex_lock(&private_context->completion_queue_mutex);
-    empty = HG_QUEUE_IS_EMPTY(&private_context->backfill_queue);
-    hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
-    HG_CHECK_ERROR(
-        !empty, done, ret, HG_BUSY, "Completion queue should be empty");
+    HG_CHECK_ERROR(!hg_mpmc_queue_is_empty(private_context->completion_queue),
+        done, ret, HG_BUSY, "Completion queue should be empty");
+    hg_mpmc_queue_free(private_context->completion_queue);
 
-#ifdef HG_HAS_SELF_FORWARD
     if (private_context->completion_queue_notify > 0) {
         rc = hg_poll_remove(private_context->poll_set,
             private_context->completion_queue_notify);
         HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_NOENTRY,
-            "Could not remove self processing event from poll set");
+            "Could not remove completion queue event from poll set");
 
         rc = hg_event_destroy(private_context->completion_queue_notify);
         HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_NOENTRY,
-            "Could not destroy self processing event");
+            "Could not destroy completion queue event");
     }
-#endif
 
     if (private_context->poll_set) {
         /* If NA plugin exposes fd, remove it from poll set */
@@ -3472,6 +4796,85 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_set_handle_recycle_callback(hg_core_context_t *context,
+    void (*callback)(hg_core_handle_t, void *), void *arg)
+{
+    struct hg_core_private_context *private_context =
+        (struct hg_core_private_context *) context;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+
+    private_context->handle_recycle = callback;
+    private_context->handle_recycle_arg = arg;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_get_handle_pool_stats(const hg_core_context_t *context,
+    hg_uint64_t *hit_count, hg_uint64_t *miss_count)
+{
+    const struct hg_core_private_context *private_context =
+        (const struct hg_core_private_context *) context;
+    hg_uint64_t hits = 0, misses = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+
+    if (private_context->handle_pool) {
+        hits += (hg_uint64_t) hg_core_stat_get(
+            &private_context->handle_pool->hit_count);
+        misses += (hg_uint64_t) hg_core_stat_get(
+            &private_context->handle_pool->miss_count);
+    }
+#ifdef HG_HAS_SM_ROUTING
+    if (private_context->sm_handle_pool) {
+        hits += (hg_uint64_t) hg_core_stat_get(
+            &private_context->sm_handle_pool->hit_count);
+        misses += (hg_uint64_t) hg_core_stat_get(
+            &private_context->sm_handle_pool->miss_count);
+    }
+#endif
+
+    if (hit_count)
+        *hit_count = hits;
+    if (miss_count)
+        *miss_count = misses;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_get_progress_stats(hg_core_context_t *context,
+    hg_uint64_t *spin_count, hg_uint64_t *block_count)
+{
+    struct hg_core_private_context *private_context =
+        (struct hg_core_private_context *) context;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+
+    if (spin_count)
+        *spin_count =
+            (hg_uint64_t) hg_core_stat_get(&private_context->spin_count);
+    if (block_count)
+        *block_count =
+            (hg_uint64_t) hg_core_stat_get(&private_context->block_count);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_context_post(
@@ -3509,52 +4912,50 @@ HG_Core_register(
 {
     struct hg_core_private_class *private_class =
         (struct hg_core_private_class *) hg_core_class;
-    hg_id_t *func_key = NULL;
+    struct hg_core_private_rpc_info *private_rpc_info = NULL;
     struct hg_core_rpc_info *hg_core_rpc_info = NULL;
+    unsigned int i;
     hg_return_t ret = HG_SUCCESS;
-    int hash_ret;
 
-    HG_CHECK_ERROR(hg_core_class == NULL, error, ret, HG_INVALID_ARG,
-        "NULL HG core class");
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
 
-    /* Check if registered and set RPC CB */
     hg_thread_spin_lock(&private_class->func_map_lock);
-    hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
-        private_class->func_map, (hg_hash_table_key_t) &id);
-    if (hg_core_rpc_info && rpc_cb)
-        hg_core_rpc_info->rpc_cb = rpc_cb;
-    hg_thread_spin_unlock(&private_class->func_map_lock);
 
-    if (!hg_core_rpc_info) {
-        /* Allocate the key */
-        func_key = (hg_id_t *) malloc(sizeof(hg_id_t));
-        HG_CHECK_ERROR(func_key == NULL, error, ret, HG_NOMEM,
-            "Could not allocate ID key");
-        *func_key = id;
-
-        /* Fill info and store it into the function map */
-        hg_core_rpc_info =
-            (struct hg_core_rpc_info *) malloc(sizeof(struct hg_core_rpc_info));
-        HG_CHECK_ERROR(hg_core_rpc_info == NULL, error, ret, HG_NOMEM,
-            "Could not allocate HG info");
-
-        hg_core_rpc_info->rpc_cb = rpc_cb;
-        hg_core_rpc_info->data = NULL;
-        hg_core_rpc_info->free_callback = NULL;
-
-        hg_thread_spin_lock(&private_class->func_map_lock);
-        hash_ret = hg_hash_table_insert(private_class->func_map,
-            (hg_hash_table_key_t) func_key, hg_core_rpc_info);
+    /* Check if registered and set RPC CB */
+    hg_core_rpc_info = hg_core_func_map_lookup(private_class, id);
+    if (hg_core_rpc_info) {
+        if (rpc_cb)
+            hg_core_rpc_info->rpc_cb = rpc_cb;
         hg_thread_spin_unlock(&private_class->func_map_lock);
-        HG_CHECK_ERROR(hash_ret == 0, error, ret, HG_INVALID_ARG,
-            "Could not insert RPC ID into function map (already registered?)");
+        goto done;
     }
 
+    /* Fill info and store it into the function map */
+    private_rpc_info = (struct hg_core_private_rpc_info *) malloc(
+        sizeof(struct hg_core_private_rpc_info));
+    HG_CHECK_ERROR(private_rpc_info == NULL, error, ret, HG_NOMEM,
+        "Could not allocate HG info");
+    hg_core_rpc_info = &private_rpc_info->rpc_info;
+
+    hg_core_rpc_info->rpc_cb = rpc_cb;
+    hg_core_rpc_info->data = NULL;
+    hg_core_rpc_info->free_callback = NULL;
+    /* Stats shards are allocated on first use */
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++)
+        hg_atomic_init64(&private_rpc_info->stats[i], 0);
+
+    ret = hg_core_func_map_update(private_class, id, hg_core_rpc_info);
+    HG_CHECK_HG_ERROR(error, ret, "Could not insert RPC ID into function map");
+
+    hg_thread_spin_unlock(&private_class->func_map_lock);
+
+done:
     return ret;
 
 error:
-    free(func_key);
-    free(hg_core_rpc_info);
+    hg_thread_spin_unlock(&private_class->func_map_lock);
+    free(private_rpc_info);
 
     return ret;
 }
@@ -3565,18 +4966,22 @@ HG_Core_deregister(hg_core_class_t *hg_core_class, hg_id_t id)
 {
     struct hg_core_private_class *private_class =
         (struct hg_core_private_class *) hg_core_class;
+    struct hg_core_rpc_info *hg_core_rpc_info = NULL;
     hg_return_t ret = HG_SUCCESS;
-    int hash_ret;
 
     HG_CHECK_ERROR(
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
 
     hg_thread_spin_lock(&private_class->func_map_lock);
-    hash_ret = hg_hash_table_remove(
-        private_class->func_map, (hg_hash_table_key_t) &id);
+    hg_core_rpc_info = hg_core_func_map_lookup(private_class, id);
+    if (hg_core_rpc_info)
+        ret = hg_core_func_map_update(private_class, id, NULL);
     hg_thread_spin_unlock(&private_class->func_map_lock);
-    HG_CHECK_ERROR(hash_ret == 0, done, ret, HG_NOENTRY,
+    HG_CHECK_ERROR(hg_core_rpc_info == NULL, done, ret, HG_NOENTRY,
         "Could not deregister RPC ID from function map");
+    HG_CHECK_HG_ERROR(done, ret, "Could not remove RPC ID from function map");
+
+    hg_core_func_map_value_free(hg_core_rpc_info);
 
 done:
     return ret;
@@ -3588,16 +4993,16 @@ HG_Core_registered(hg_core_class_t *hg_core_class, hg_id_t id, hg_bool_t *flag)
 {
     struct hg_core_private_class *private_class =
         (struct hg_core_private_class *) hg_core_class;
+    hg_atomic_int32_t *readers;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
     HG_CHECK_ERROR(flag == NULL, done, ret, HG_INVALID_ARG, "NULL flag");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
-    *flag = (hg_bool_t)(hg_hash_table_lookup(private_class->func_map,
-                            (hg_hash_table_key_t) &id) != HG_HASH_TABLE_NULL);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    readers = hg_core_func_map_read_lock(private_class);
+    *flag = (hg_bool_t)(hg_core_func_map_lookup(private_class, id) != NULL);
+    hg_core_func_map_read_unlock(readers);
 
 done:
     return ret;
@@ -3611,16 +5016,15 @@ HG_Core_register_data(hg_core_class_t *hg_core_class, hg_id_t id, void *data,
     struct hg_core_private_class *private_class =
         (struct hg_core_private_class *) hg_core_class;
     struct hg_core_rpc_info *hg_core_rpc_info = NULL;
+    hg_atomic_int32_t *readers;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
-    hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
-        private_class->func_map, (hg_hash_table_key_t) &id);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
-    HG_CHECK_ERROR(hg_core_rpc_info == NULL, done, ret, HG_NOENTRY,
+    readers = hg_core_func_map_read_lock(private_class);
+    hg_core_rpc_info = hg_core_func_map_lookup(private_class, id);
+    HG_CHECK_ERROR(hg_core_rpc_info == NULL, unlock, ret, HG_NOENTRY,
         "Could not find RPC ID in function map");
 
     HG_CHECK_WARNING(
@@ -3628,6 +5032,9 @@ HG_Core_register_data(hg_core_class_t *hg_core_class, hg_id_t id, void *data,
     hg_core_rpc_info->data = data;
     hg_core_rpc_info->free_callback = free_callback;
 
+unlock:
+    hg_core_func_map_read_unlock(readers);
+
 done:
     return ret;
 }
@@ -3639,23 +5046,180 @@ HG_Core_registered_data(hg_core_class_t *hg_core_class, hg_id_t id)
     struct hg_core_private_class *private_class =
         (struct hg_core_private_class *) hg_core_class;
     struct hg_core_rpc_info *hg_core_rpc_info = NULL;
+    hg_atomic_int32_t *readers;
     void *data = NULL;
 
     HG_CHECK_ERROR_NORET(hg_core_class == NULL, done, "NULL HG core class");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
-    hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
-        private_class->func_map, (hg_hash_table_key_t) &id);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    readers = hg_core_func_map_read_lock(private_class);
+    hg_core_rpc_info = hg_core_func_map_lookup(private_class, id);
+    if (hg_core_rpc_info)
+        data = hg_core_rpc_info->data;
+    hg_core_func_map_read_unlock(readers);
     HG_CHECK_ERROR_NORET(hg_core_rpc_info == NULL, done,
         "Could not find RPC ID in function map");
 
-    data = hg_core_rpc_info->data;
-
 done:
     return data;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_stats_enable(hg_core_class_t *hg_core_class, hg_bool_t enable)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+
+    hg_atomic_set32(
+        &((struct hg_core_private_class *) hg_core_class)->stats_enabled,
+        (hg_util_int32_t) enable);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_stats_get(
+    hg_core_class_t *hg_core_class, hg_id_t id, struct hg_stats *stats)
+{
+    struct hg_core_private_class *private_class =
+        (struct hg_core_private_class *) hg_core_class;
+    struct hg_core_private_rpc_info *private_rpc_info = NULL;
+    hg_uint64_t counters[HG_CORE_STATS_COUNTER_MAX] = {0};
+    hg_atomic_int32_t *readers;
+    unsigned int i, j, k;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+    HG_CHECK_ERROR(stats == NULL, done, ret, HG_INVALID_ARG, "NULL stats");
+
+    readers = hg_core_func_map_read_lock(private_class);
+    private_rpc_info = (struct hg_core_private_rpc_info *)
+        hg_core_func_map_lookup(private_class, id);
+    HG_CHECK_ERROR(private_rpc_info == NULL, unlock, ret, HG_NOENTRY,
+        "Could not find RPC ID in function map");
+
+    /* Sum shards, values are read while they may still be updated */
+    memset(stats, 0, sizeof(struct hg_stats));
+    for (i = 0; i < HG_CORE_STATS_SHARDS; i++) {
+        struct hg_core_stats *shard = (struct hg_core_stats *) hg_atomic_get64(
+            &private_rpc_info->stats[i]);
+
+        if (!shard)
+            continue;
+        for (j = 0; j < HG_CORE_STATS_COUNTER_MAX; j++)
+            counters[j] += (hg_uint64_t) hg_atomic_get64(&shard->counters[j]);
+        for (j = 0; j < HG_STATS_PHASE_MAX; j++) {
+            struct hg_core_stats_hist *hist = &shard->latency[j];
+            hg_uint64_t max = (hg_uint64_t) hg_atomic_get64(&hist->max);
+
+            stats->latency[j].count += (hg_uint64_t) hg_atomic_get64(
+                &hist->count);
+            stats->latency[j].sum += (hg_uint64_t) hg_atomic_get64(&hist->sum);
+            if (max > stats->latency[j].max)
+                stats->latency[j].max = max;
+            for (k = 0; k < HG_STATS_HIST_BUCKETS; k++)
+                stats->latency[j].buckets[k] +=
+                    (hg_uint64_t) hg_atomic_get64(&hist->buckets[k]);
+        }
+    }
+    stats->forward_count = counters[HG_CORE_STATS_FORWARD_COUNT];
+    stats->handle_count = counters[HG_CORE_STATS_HANDLE_COUNT];
+    stats->bytes_out = counters[HG_CORE_STATS_BYTES_OUT];
+    stats->bytes_in = counters[HG_CORE_STATS_BYTES_IN];
+    stats->overflow_count = counters[HG_CORE_STATS_OVERFLOW_COUNT];
+
+unlock:
+    hg_core_func_map_read_unlock(readers);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_stats_reset(hg_core_class_t *hg_core_class, hg_id_t id)
+{
+    struct hg_core_private_class *private_class =
+        (struct hg_core_private_class *) hg_core_class;
+    hg_atomic_int32_t *readers;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+
+    readers = hg_core_func_map_read_lock(private_class);
+    if (id == 0) {
+        struct hg_core_func_map *func_map =
+            (struct hg_core_func_map *) hg_atomic_get64(
+                &private_class->func_map);
+        unsigned int i;
+
+        for (i = 0; i <= func_map->mask; i++)
+            if (func_map->entries[i].rpc_info)
+                hg_core_stats_reset((struct hg_core_private_rpc_info *)
+                                        func_map->entries[i].rpc_info);
+    } else {
+        struct hg_core_rpc_info *hg_core_rpc_info =
+            hg_core_func_map_lookup(private_class, id);
+
+        HG_CHECK_ERROR(hg_core_rpc_info == NULL, unlock, ret, HG_NOENTRY,
+            "Could not find RPC ID in function map");
+        hg_core_stats_reset(
+            (struct hg_core_private_rpc_info *) hg_core_rpc_info);
+    }
+
+unlock:
+    hg_core_func_map_read_unlock(readers);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint64_t
+HG_Core_stats_percentile(const struct hg_stats_hist *hist, double percentile)
+{
+    hg_uint64_t rank, count = 0, value = 0;
+    unsigned int i;
+
+    if (hist == NULL || hist->count == 0)
+        return 0;
+
+    /* Rank of the sample in [1, count] */
+    rank = (hg_uint64_t) (percentile / 100.0 * (double) hist->count);
+    if ((double) rank < percentile / 100.0 * (double) hist->count)
+        rank++;
+    if (rank == 0)
+        rank = 1;
+
+    for (i = 0; i < HG_STATS_HIST_BUCKETS; i++) {
+        count += hist->buckets[i];
+        if (count >= rank)
+            break;
+    }
+
+    /* Report upper bound of bucket */
+    if (i < (1 << (HG_STATS_HIST_SUB_BITS + 1)))
+        value = i;
+    else if (i < HG_STATS_HIST_BUCKETS - 1) {
+        unsigned int exp = (i >> HG_STATS_HIST_SUB_BITS) +
+                           HG_STATS_HIST_SUB_BITS - 1,
+                     sub = i & ((1 << HG_STATS_HIST_SUB_BITS) - 1);
+
+        value = ((hg_uint64_t) 1 << exp) +
+                ((hg_uint64_t) (sub + 1) << (exp - HG_STATS_HIST_SUB_BITS)) -
+                1;
+    } else
+        value = hist->max;
+
+    return (value < hist->max) ? value : hist->max;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_addr_create(hg_core_class_t *hg_core_class, hg_core_addr_t *addr)
@@ -3703,6 +5267,7 @@ HG_Core_addr_lookup1(hg_core_context_t *context, hg_core_cb_t callback,
     hg_core_op_id->type = HG_CB_LOOKUP;
     hg_core_op_id->callback = callback;
     hg_core_op_id->arg = arg;
+    hg_core_op_id->ret = HG_SUCCESS;
     hg_core_op_id->info.lookup.hg_core_addr = NULL;
 
     ret = hg_core_addr_lookup(
@@ -3753,6 +5318,83 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_addr_lookup_batch(hg_core_context_t *context, hg_core_cb_t callback,
+    void *arg, const char *const *names, hg_core_addr_t *addrs,
+    unsigned int count, hg_core_op_id_t *op_id)
+{
+    struct hg_core_private_class *hg_core_class = NULL;
+    struct hg_core_lookup_batch *batch = NULL;
+    unsigned int n_workers = 1, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+    HG_CHECK_ERROR(
+        callback == NULL, done, ret, HG_INVALID_ARG, "NULL callback");
+    HG_CHECK_ERROR(names == NULL, done, ret, HG_INVALID_ARG, "NULL lookups");
+    HG_CHECK_ERROR(
+        addrs == NULL, done, ret, HG_INVALID_ARG, "NULL pointer to addresses");
+    HG_CHECK_ERROR(count == 0, done, ret, HG_INVALID_ARG, "Empty batch");
+
+    /* Do not start more workers than there are names */
+    hg_core_class = (struct hg_core_private_class *) context->core_class;
+    if (hg_core_class->addr_lookup_pool)
+        n_workers = HG_CORE_MIN(hg_core_class->addr_lookup_pool_size, count);
+
+    /* Allocate batch */
+    batch = (struct hg_core_lookup_batch *) malloc(
+        sizeof(struct hg_core_lookup_batch) +
+        n_workers * sizeof(struct hg_thread_work));
+    HG_CHECK_ERROR(
+        batch == NULL, done, ret, HG_NOMEM, "Could not allocate HG batch");
+
+    batch->op_id.context = (struct hg_core_private_context *) context;
+    batch->op_id.type = HG_CB_LOOKUP;
+    batch->op_id.callback = callback;
+    batch->op_id.arg = arg;
+    batch->op_id.ret = HG_SUCCESS;
+    batch->op_id.info.lookup.hg_core_addr = NULL;
+    batch->op_id.hg_completion_entry.op_type = HG_ADDR;
+    batch->op_id.hg_completion_entry.op_id.hg_core_op_id = &batch->op_id;
+    batch->names = names;
+    batch->addrs = (struct hg_core_private_addr **) addrs;
+    batch->count = count;
+    hg_atomic_init32(&batch->next, 0);
+    hg_atomic_init32(&batch->n_workers, (hg_util_int32_t) n_workers);
+    hg_atomic_init32(&batch->ret, HG_SUCCESS);
+
+    /* Assign op_id before any lookup can complete */
+    if (op_id && op_id != HG_CORE_OP_ID_IGNORE)
+        *op_id = &batch->op_id;
+
+    /* Without a lookup pool, names are looked up by the caller */
+    if (!hg_core_class->addr_lookup_pool) {
+        ret = hg_core_addr_lookup_batch_run(batch);
+        HG_CHECK_HG_ERROR(error, ret, "Could not look up batch");
+        goto done;
+    }
+
+    /* The batch may be triggered and freed as soon as the last work item
+     * has run, it must not be accessed after the last post */
+    for (i = 0; i < n_workers; i++) {
+        batch->works[i].func = hg_core_addr_lookup_batch_thread;
+        batch->works[i].args = batch;
+        hg_thread_pool_post(hg_core_class->addr_lookup_pool, &batch->works[i]);
+    }
+
+done:
+    return ret;
+
+error:
+    for (i = 0; i < count; i++)
+        hg_core_addr_free(hg_core_class, batch->addrs[i]);
+    free(batch);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_addr_free(hg_core_class_t *hg_core_class, hg_core_addr_t addr)
@@ -3774,6 +5416,8 @@ done:
 hg_return_t
 HG_Core_addr_set_remove(hg_core_class_t *hg_core_class, hg_core_addr_t addr)
 {
+    struct hg_core_private_class *private_class =
+        (struct hg_core_private_class *) hg_core_class;
     struct hg_core_private_addr *hg_core_addr =
         (struct hg_core_private_addr *) addr;
     hg_return_t ret = HG_SUCCESS;
@@ -3787,6 +5431,27 @@ HG_Core_addr_set_remove(hg_core_class_t *hg_core_class, hg_core_addr_t addr)
     HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
         "Could not set address to be removed (%s)", NA_Error_to_string(na_ret));
 
+    /* Stop handing out the removed addr */
+    if (private_class->addr_cache) {
+        struct hg_core_addr_cache_entry *entry = NULL;
+        hg_hash_map_iter_t iter;
+
+        hg_thread_mutex_lock(&private_class->addr_cache_mutex);
+        hg_hash_map_iterate(private_class->addr_cache, &iter);
+        while (hg_hash_map_iter_has_more(&iter)) {
+            entry = (struct hg_core_addr_cache_entry *) hg_hash_map_iter_next(
+                &iter);
+            if (entry->hg_core_addr == hg_core_addr)
+                break;
+            entry = NULL;
+        }
+        if (entry)
+            hg_hash_map_remove(
+                private_class->addr_cache, (hg_hash_map_key_t) entry->name);
+        hg_thread_mutex_unlock(&private_class->addr_cache_mutex);
+        hg_core_addr_cache_entry_free(private_class, entry);
+    }
+
 done:
     return ret;
 }
@@ -3920,6 +5585,9 @@ HG_Core_create(hg_core_context_t *context, hg_core_addr_t addr, hg_id_t id,
         HG_CHECK_HG_ERROR(error, ret, "Error in HG handle create callback");
     }
 
+    /* Not correlated yet, a new trace ID is assigned on each forward */
+    HG_TRACE(HG_TRACE_CORE_CREATE, 0, id);
+
     *handle = (hg_core_handle_t) hg_core_handle;
 
     return ret;
@@ -4091,6 +5759,12 @@ HG_Core_forward(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
     /* Reset handle ret */
     hg_core_handle->ret = HG_SUCCESS;
 
+    /* Record stats on completion if enabled */
+    hg_core_handle->stats = (hg_bool_t) hg_atomic_get32(
+        &HG_CORE_HANDLE_CLASS(hg_core_handle)->stats_enabled);
+    if (hg_core_handle->stats)
+        hg_time_get_current(&hg_core_handle->stats_start);
+
     /* Increase ref count here so that a call to HG_Destroy does not free the
      * handle but only schedules its completion
      */
@@ -4126,6 +5800,10 @@ HG_Core_forward(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
      * which context ID it needs to send the response to. */
     hg_core_handle->in_header.msg.request.cookie =
         hg_core_handle->core_handle.info.context->id;
+    hg_core_handle->in_header.msg.request.trace_id =
+        HG_TRACE_ENABLED() ? hg_trace_id_gen() : 0;
+    HG_CORE_HANDLE_TRACE(hg_core_handle, HG_TRACE_CORE_FORWARD,
+        hg_core_handle->core_handle.info.id);
 
     /* Encode request header */
     ret = hg_core_proc_header_request(
@@ -4194,6 +5872,12 @@ HG_Core_respond(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
         &hg_core_handle->core_handle, &hg_core_handle->out_header, HG_ENCODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not encode header");
 
+    /* Handle may be released once responded */
+    if (hg_core_handle->stats)
+        hg_core_stats_respond(hg_core_handle);
+    HG_CORE_HANDLE_TRACE(
+        hg_core_handle, HG_TRACE_CORE_RESPOND, hg_core_handle->out_buf_used);
+
     /* If addr is self, forward locally, otherwise send the encoded buffer
      * through NA and pre-post response */
     ret = hg_core_handle->respond(hg_core_handle);
@@ -4203,6 +5887,25 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_core_respond_error(hg_core_handle_t handle, hg_return_t ret)
+{
+    struct hg_core_private_handle *hg_core_handle =
+        (struct hg_core_private_handle *) handle;
+    hg_size_t header_size;
+
+    if (hg_core_handle->no_response)
+        return HG_SUCCESS;
+
+    /* Empty response that only carries the error */
+    header_size = hg_core_header_response_get_size() +
+                  hg_core_handle->core_handle.na_out_header_offset;
+    hg_core_handle->ret = ret;
+
+    return HG_Core_respond(handle, NULL, NULL, 0, header_size);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_progress(hg_core_context_t *context, unsigned int timeout)
@@ -4234,7 +5937,27 @@ HG_Core_trigger(hg_core_context_t *context, unsigned int timeout,
         context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
 
     ret = hg_core_trigger((struct hg_core_private_context *) context, timeout,
-        max_count, actual_count);
+        max_count, NULL, actual_count);
+    HG_CHECK_ERROR_NORET(ret != HG_SUCCESS && ret != HG_TIMEOUT, done,
+        "Could not trigger callbacks");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_trigger_batch(hg_core_context_t *context, unsigned int timeout,
+    unsigned int max_count, hg_core_completion_t *completions,
+    unsigned int *actual_count)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+
+    ret = hg_core_trigger((struct hg_core_private_context *) context, timeout,
+        max_count, (struct hg_completion_entry **) completions, actual_count);
     HG_CHECK_ERROR_NORET(ret != HG_SUCCESS && ret != HG_TIMEOUT, done,
         "Could not trigger callbacks");
 
@@ -4242,6 +5965,22 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_trigger_completion(hg_core_completion_t completion)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(completion == HG_CORE_COMPLETION_NULL, done, ret,
+        HG_INVALID_ARG, "NULL HG core completion");
+
+    ret = hg_core_trigger_completion((struct hg_completion_entry *) completion);
+    HG_CHECK_HG_ERROR(done, ret, "Could not trigger completion");
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_cancel(hg_core_handle_t handle)
@@ -25,6 +25,8 @@ typedef struct hg_core_context hg_core_context_t; /* Opaque HG core context */
 typedef struct hg_core_addr *hg_core_addr_t;      /* Abstract HG address */
 typedef struct hg_core_handle *hg_core_handle_t;  /* Abstract RPC handle */
 typedef struct hg_core_op_id *hg_core_op_id_t;    /* Abstract operation id */
+typedef struct hg_completion_entry
+    *hg_core_completion_t; /* Abstract completion entry */
 
 /* HG info struct */
 struct hg_core_info {
@@ -69,10 +71,11 @@ typedef hg_return_t (*hg_core_cb_t)(
 /*****************/
 
 /* Constant values */
-#define HG_CORE_ADDR_NULL    ((hg_core_addr_t) 0)
-#define HG_CORE_HANDLE_NULL  ((hg_core_handle_t) 0)
-#define HG_CORE_OP_ID_NULL   ((hg_core_op_id_t) 0)
-#define HG_CORE_OP_ID_IGNORE ((hg_core_op_id_t *) 1)
+#define HG_CORE_ADDR_NULL       ((hg_core_addr_t) 0)
+#define HG_CORE_HANDLE_NULL     ((hg_core_handle_t) 0)
+#define HG_CORE_OP_ID_NULL      ((hg_core_op_id_t) 0)
+#define HG_CORE_OP_ID_IGNORE    ((hg_core_op_id_t *) 1)
+#define HG_CORE_COMPLETION_NULL ((hg_core_completion_t) 0)
 
 /* Flags */
 #define HG_CORE_MORE_DATA   0x01 /* More data required */
@@ -371,6 +374,54 @@ HG_PUBLIC hg_return_t
 HG_Core_context_set_handle_create_callback(hg_core_context_t *context,
     hg_return_t (*callback)(hg_core_handle_t, void *), void *arg);
 
+/**
+ * Set callback to be called when a HG core handle is returned to the context
+ * handle pool (see hg_init_info handle_pool_size) instead of being freed.
+ * Data attached to the handle is kept so that it can be re-used by the next
+ * handle_create callback, upper layers are expected to release any per-use
+ * resources from that callback. If no callback is set, data attached to the
+ * handle is freed using its free callback.
+ *
+ * \param context [IN]          pointer to HG core context
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_context_set_handle_recycle_callback(hg_core_context_t *context,
+    void (*callback)(hg_core_handle_t, void *), void *arg);
+
+/**
+ * Retrieve the number of handles that were re-used from the context handle
+ * pool (hits) and the number of handles that had to be allocated because the
+ * pool was empty (misses).
+ *
+ * \param context [IN]          pointer to HG core context
+ * \param hit_count [OUT]       pointer to number of hits
+ * \param miss_count [OUT]      pointer to number of misses
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_context_get_handle_pool_stats(const hg_core_context_t *context,
+    hg_uint64_t *hit_count, hg_uint64_t *miss_count);
+
+/**
+ * Retrieve the number of progress calls that completed while spinning and
+ * the number of calls that had to fall back to blocking. Spinning is enabled
+ * by setting NA_ADAPTIVE_SPIN in the progress mode of hg_init_info.
+ *
+ * \param context [IN]          pointer to HG core context
+ * \param spin_count [OUT]      pointer to number of calls completed spinning
+ * \param block_count [OUT]     pointer to number of calls that blocked
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_context_get_progress_stats(hg_core_context_t *context,
+    hg_uint64_t *spin_count, hg_uint64_t *block_count);
+
 /**
  * Post requests associated to context in order to receive incoming RPCs.
  * Requests are automatically re-posted after completion depending on the
@@ -455,6 +506,62 @@ HG_Core_register_data(hg_core_class_t *hg_core_class, hg_id_t id, void *data,
 HG_PUBLIC void *
 HG_Core_registered_data(hg_core_class_t *hg_core_class, hg_id_t id);
 
+/**
+ * Enable or disable recording of RPC statistics. When enabled, the number of
+ * RPCs forwarded and handled, the number of bytes sent and received, the
+ * number of payloads that exceeded eager buffers and per-phase latency
+ * histograms (see hg_stats_phase_t) are recorded for each RPC ID. Statistics
+ * are disabled by default.
+ *
+ * \param hg_core_class [IN]    pointer to HG core class
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_stats_enable(hg_core_class_t *hg_core_class, hg_bool_t enable);
+
+/**
+ * Retrieve statistics recorded for a given RPC ID. Statistics can be
+ * retrieved while RPCs are in flight, in which case values may not all
+ * reflect the same point in time.
+ *
+ * \param hg_core_class [IN]    pointer to HG core class
+ * \param id [IN]               registered function ID
+ * \param stats [OUT]           pointer to statistics
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_stats_get(
+    hg_core_class_t *hg_core_class, hg_id_t id, struct hg_stats *stats);
+
+/**
+ * Reset statistics recorded for a given RPC ID, or for all registered RPC IDs
+ * if id is 0.
+ *
+ * \param hg_core_class [IN]    pointer to HG core class
+ * \param id [IN]               registered function ID or 0
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_stats_reset(hg_core_class_t *hg_core_class, hg_id_t id);
+
+/**
+ * Estimate a latency percentile from a histogram. The returned value is the
+ * upper bound of the bucket that contains the percentile, bounded by the
+ * largest recorded value.
+ *
+ * \param hist [IN]             pointer to latency histogram
+ * \param percentile [IN]       percentile between 0 and 100
+ *
+ * \return latency in ns or 0 if the histogram is empty
+ */
+HG_PUBLIC hg_uint64_t
+HG_Core_stats_percentile(const struct hg_stats_hist *hist, double percentile);
+
 /**
  * Create a HG core address.
  *
@@ -497,6 +604,34 @@ HG_PUBLIC hg_return_t
 HG_Core_addr_lookup2(
     hg_core_class_t *hg_core_class, const char *name, hg_core_addr_t *addr);
 
+/**
+ * Lookup addrs from a batch of peer addresses/names. Names are looked up
+ * concurrently by the threads of the addr lookup pool (see
+ * hg_init_info.addr_lookup_pool_size) or by the caller if there is no pool.
+ * Once all names have been looked up, user callback is placed into a
+ * completion queue and can be triggered using HG_Core_trigger(). Each
+ * successfully looked up addr needs to be freed by calling
+ * HG_Core_addr_free(), addrs of names that could not be looked up are set
+ * to HG_CORE_ADDR_NULL and the callback return code is set to the first
+ * error that occurred.
+ *
+ * \remark names and addrs must remain valid until the callback is triggered.
+ *
+ * \param context [IN]          pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param names [IN]            array of lookup names
+ * \param addrs [OUT]           array of abstract addresses
+ * \param count [IN]            number of names
+ * \param op_id [OUT]           pointer to returned operation ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_addr_lookup_batch(hg_core_context_t *context, hg_core_cb_t callback,
+    void *arg, const char *const *names, hg_core_addr_t *addrs,
+    unsigned int count, hg_core_op_id_t *op_id);
+
 /**
  * Free the addr from the list of peers.
  *
@@ -830,6 +965,38 @@ HG_PUBLIC hg_return_t
 HG_Core_trigger(hg_core_context_t *context, unsigned int timeout,
     unsigned int max_count, unsigned int *actual_count);
 
+/**
+ * Dequeue at most max_count completions in batches. If completions is NULL,
+ * callbacks are executed inline, otherwise completions are stored into the
+ * completions array (of at least max_count entries) and callbacks must later
+ * be executed by calling HG_Core_trigger_completion() on each of them,
+ * possibly from a different thread. If timeout is non-zero, wait up to
+ * timeout before returning.
+ *
+ * \param context [IN]          pointer to HG core context
+ * \param timeout [IN]          timeout (in milliseconds)
+ * \param max_count [IN]        maximum number of completions dequeued
+ * \param completions [OUT]     array of completions (may be NULL)
+ * \param actual_count [OUT]    actual number of completions dequeued
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_trigger_batch(hg_core_context_t *context, unsigned int timeout,
+    unsigned int max_count, hg_core_completion_t *completions,
+    unsigned int *actual_count);
+
+/**
+ * Execute the callback of a completion previously returned by
+ * HG_Core_trigger_batch(). Each completion must be triggered exactly once.
+ *
+ * \param completion [IN]       completion entry
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_trigger_completion(hg_core_completion_t completion);
+
 /**
  * Cancel an ongoing operation.
  *
@@ -850,6 +1017,7 @@ struct hg_core_class {
 #ifdef HG_HAS_SM_ROUTING
     na_class_t *na_sm_class; /* NA SM class */
 #endif
+    struct hg_bulk_cache *bulk_cache;   /* Registration cache */
     void *data;                         /* User data */
     void (*data_free_callback)(void *); /* User data free callback */
 };
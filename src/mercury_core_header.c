@@ -196,6 +196,10 @@ hg_core_header_request_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     HG_CORE_HEADER_PROC(
         hg_core_header, buf_ptr, header->cookie, hg_uint8_t, op);
 
+    /* Trace ID */
+    HG_CORE_HEADER_PROC(
+        hg_core_header, buf_ptr, header->trace_id, hg_uint64_t, op);
+
 #ifdef HG_HAS_CHECKSUMS
     /* Checksum of header */
     mchecksum_get(hg_core_header->checksum, &header->hash.header,
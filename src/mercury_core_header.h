@@ -31,15 +31,16 @@ union hg_core_header_hash {
 #endif
 
 struct hg_core_header_request {
-    hg_uint8_t hg;       /* Mercury identifier */
-    hg_uint8_t protocol; /* Version number */
-    hg_uint64_t id;      /* RPC request identifier */
-    hg_uint8_t flags;    /* Flags */
-    hg_uint8_t cookie;   /* Cookie */
-    /* 96 bits here */
+    hg_uint8_t hg;        /* Mercury identifier */
+    hg_uint8_t protocol;  /* Version number */
+    hg_uint64_t id;       /* RPC request identifier */
+    hg_uint8_t flags;     /* Flags */
+    hg_uint8_t cookie;    /* Cookie */
+    hg_uint64_t trace_id; /* Trace correlation ID */
+    /* 160 bits here */
 #ifdef HG_HAS_CHECKSUMS
     union hg_core_header_hash hash; /* Hash */
-    /* 128 bits here */
+    /* 192 bits here */
 #endif
 };
 
@@ -75,7 +76,8 @@ struct hg_core_header {
  *
  *
  * Request:
- * mercury byte / protocol version number / rpc id / flags / cookie / checksum
+ * mercury byte / protocol version number / rpc id / flags / cookie /
+ * trace id / checksum
  *
  * Response:
  * flags / return code / cookie / checksum
@@ -89,7 +91,7 @@ struct hg_core_header {
 #define HG_CORE_IDENTIFIER (('H' << 1) | ('G')) /* 0xD7 */
 
 /* Mercury protocol version number */
-#define HG_CORE_PROTOCOL_VERSION 0x04
+#define HG_CORE_PROTOCOL_VERSION 0x05
 
 /* Flags */
 #define HG_CORE_SELF_FORWARD 0x80 /* Forward to self */
@@ -23,10 +23,18 @@ typedef hg_uint64_t hg_id_t;   /* RPC ID */
 
 /* HG init info struct */
 struct hg_init_info {
-    struct na_init_info na_init_info; /* NA Init Info */
-    na_class_t *na_class;             /* NA class */
-    hg_bool_t auto_sm;                /* Use NA SM plugin with local addrs */
-    hg_bool_t stats;                  /* (Debug) Print stats at exit */
+    struct na_init_info na_init_info;  /* NA Init Info */
+    na_class_t *na_class;              /* NA class */
+    hg_bool_t auto_sm;                 /* Use NA SM plugin with local addrs */
+    hg_bool_t stats;                   /* (Debug) Print stats at exit */
+    hg_uint32_t handle_pool_size;      /* Max handles cached per context */
+    hg_uint32_t dispatch_pool_size;    /* Threads used to dispatch RPCs */
+    hg_size_t bulk_cache_size;         /* Max unused registered bulk bytes */
+    hg_uint32_t bulk_op_pool_size;     /* Max bulk ops cached per context */
+    hg_uint32_t addr_cache_size;       /* Max addrs cached by lookup name */
+    hg_uint32_t addr_cache_ttl;        /* Cached addr lifetime (ms) */
+    hg_uint32_t addr_cache_neg_ttl;    /* Failed lookup lifetime (ms) */
+    hg_uint32_t addr_lookup_pool_size; /* Threads used for batch lookups */
 };
 
 /* Error return codes:
@@ -85,10 +93,46 @@ typedef enum { HG_UNDEF, HG_INPUT, HG_OUTPUT } hg_op_t;
 typedef enum {
     HG_ENCODE, /*!< causes the type to be encoded into the stream */
     HG_DECODE, /*!< causes the type to be extracted from the stream */
-    HG_FREE    /*!< can be used to release the space allocated by an HG_DECODE
+    HG_FREE,   /*!< can be used to release the space allocated by an HG_DECODE
                   request */
+    HG_SIZE    /*!< causes the encoded size of the type to be computed without
+                  encoding it */
 } hg_proc_op_t;
 
+/* RPC latency phases, origin phases are recorded by the process that
+ * forwards the RPC and target phases by the process that handles it */
+typedef enum hg_stats_phase {
+    HG_STATS_FORWARD,  /*!< origin: forward to request send completion */
+    HG_STATS_QUEUE,    /*!< target: request receipt to RPC callback */
+    HG_STATS_HANDLER,  /*!< target: RPC callback to respond */
+    HG_STATS_RESPONSE, /*!< origin: request sent to response receipt */
+    HG_STATS_PHASE_MAX
+} hg_stats_phase_t;
+
+/* Latency histogram (ns). Buckets are log-linear with
+ * 2^HG_STATS_HIST_SUB_BITS buckets per power of two (values below
+ * 2^(HG_STATS_HIST_SUB_BITS + 1) are exact), values of 2^41 ns or more are
+ * counted in the last bucket. */
+#define HG_STATS_HIST_SUB_BITS 2
+#define HG_STATS_HIST_BUCKETS  160
+
+struct hg_stats_hist {
+    hg_uint64_t count;                          /* Number of samples */
+    hg_uint64_t sum;                            /* Sum of samples */
+    hg_uint64_t max;                            /* Largest sample */
+    hg_uint64_t buckets[HG_STATS_HIST_BUCKETS]; /* Sample counts */
+};
+
+/* Statistics of an RPC ID */
+struct hg_stats {
+    hg_uint64_t forward_count;  /* RPCs forwarded */
+    hg_uint64_t handle_count;   /* RPCs handled */
+    hg_uint64_t bytes_out;      /* Request and response bytes sent */
+    hg_uint64_t bytes_in;       /* Request and response bytes received */
+    hg_uint64_t overflow_count; /* Payloads exceeding eager buffers */
+    struct hg_stats_hist latency[HG_STATS_PHASE_MAX]; /* Latency per phase */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -102,7 +146,8 @@ typedef enum {
 /* HG init info initializer */
 #define HG_INIT_INFO_INITIALIZER                                               \
     {                                                                          \
-        NA_INIT_INFO_INITIALIZER, NULL, HG_FALSE, HG_FALSE                     \
+        NA_INIT_INFO_INITIALIZER, NULL, HG_FALSE, HG_FALSE, 0, 0, 0, 0, 0, 0,  \
+            0, 0                                                               \
     }
 
 #endif /* MERCURY_CORE_TYPES_H */
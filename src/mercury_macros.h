@@ -14,6 +14,7 @@
 #include "mercury.h"
 #include "mercury_proc.h"
 #include "mercury_proc_bulk.h"
+#include "mercury_proc_view.h"
 
 #ifdef HG_HAS_BOOST
 #    include <boost/preprocessor.hpp>
@@ -26,6 +27,7 @@
  *   - MERCURY_REGISTER
  *   - MERCURY_GEN_PROC
  *   - MERCURY_GEN_STRUCT_PROC
+ *   - MERCURY_PEEK_INPUT / MERCURY_FREE_PEEK_INPUT
  */
 
 /****************/
@@ -56,8 +58,8 @@
             return ret;                                                        \
         }
 
-/* Generate proc for struct */
-#    define HG_GEN_STRUCT_PROC(struct_type_name, fields)                       \
+/* Generate proc for struct that encodes fields one by one */
+#    define HG_GEN_STRUCT_FIELDS_PROC(struct_type_name, fields)                \
         static HG_INLINE hg_return_t BOOST_PP_CAT(hg_proc_, struct_type_name)( \
             hg_proc_t proc, void *data)                                        \
         {                                                                      \
@@ -69,6 +71,159 @@
             return ret;                                                        \
         }
 
+/* Types that are encoded as a plain copy of sizeof(type) bytes, i.e., for
+ * which HG_GEN_FLAT_PROBE_<type> is defined (hg_id_t is not as it is
+ * encoded on 32 bits) */
+#    define HG_GEN_FLAT_PROBE_hg_int8_t   ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_uint8_t  ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_int16_t  ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_uint16_t ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_int32_t  ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_uint32_t ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_int64_t  ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_uint64_t ~, 1
+#    define HG_GEN_FLAT_PROBE_int8_t      ~, 1
+#    define HG_GEN_FLAT_PROBE_uint8_t     ~, 1
+#    define HG_GEN_FLAT_PROBE_int16_t     ~, 1
+#    define HG_GEN_FLAT_PROBE_uint16_t    ~, 1
+#    define HG_GEN_FLAT_PROBE_int32_t     ~, 1
+#    define HG_GEN_FLAT_PROBE_uint32_t    ~, 1
+#    define HG_GEN_FLAT_PROBE_int64_t     ~, 1
+#    define HG_GEN_FLAT_PROBE_uint64_t    ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_bool_t   ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_ptr_t    ~, 1
+#    define HG_GEN_FLAT_PROBE_hg_size_t   ~, 1
+
+/* Expand to 1 if type is flat, 0 otherwise */
+#    define HG_GEN_FLAT_CHECK_N(x, n, ...) n
+#    define HG_GEN_FLAT_CHECK(...)         HG_GEN_FLAT_CHECK_N(__VA_ARGS__, 0, )
+#    define HG_GEN_IS_FLAT_TYPE(type)                                          \
+        HG_GEN_FLAT_CHECK(BOOST_PP_CAT(HG_GEN_FLAT_PROBE_, type))
+
+/* Expand to 1 if all fields are flat, 0 otherwise. XDR encodes each field
+ * separately so that structs are never flat in that case */
+#    define HG_GEN_FLAT_AND(s, state, field)                                   \
+        BOOST_PP_BITAND(state, HG_GEN_IS_FLAT_TYPE(HG_GEN_GET_TYPE(field)))
+#    ifdef HG_HAS_XDR
+#        define HG_GEN_IS_FLAT(fields) 0
+#    else
+#        define HG_GEN_IS_FLAT(fields)                                         \
+            BOOST_PP_SEQ_FOLD_LEFT(HG_GEN_FLAT_AND, 1, fields)
+#    endif
+
+/* Pack wire layout of flat structs */
+#    ifdef _WIN32
+#        define HG_GEN_PACK_PUSH __pragma(pack(push, 1))
+#        define HG_GEN_PACK_POP  __pragma(pack(pop))
+#    else
+#        define HG_GEN_PACK_PUSH _Pragma("pack(push, 1)")
+#        define HG_GEN_PACK_POP  _Pragma("pack(pop)")
+#    endif
+
+/* Copy struct field to / from wire layout */
+#    define HG_GEN_FLAT_ENCODE(r, data, field)                                 \
+        flat_data->HG_GEN_GET_NAME(field) = struct_data->HG_GEN_GET_NAME(field);
+#    define HG_GEN_FLAT_DECODE(r, data, field)                                 \
+        struct_data->HG_GEN_GET_NAME(field) = flat_data->HG_GEN_GET_NAME(field);
+
+/* Generate proc for struct that only has flat fields. Fields are laid out on
+ * the wire without padding in the order they are declared, which is what
+ * encoding them one by one produces, but are copied after a single size
+ * check and checksum update. hg_proc_<struct_type_name>_size gives the
+ * encoded size */
+#    define HG_GEN_STRUCT_FLAT_PROC(struct_type_name, fields)                  \
+        HG_GEN_PACK_PUSH                                                       \
+        struct BOOST_PP_CAT(hg_proc_, BOOST_PP_CAT(struct_type_name, _flat)) { \
+            BOOST_PP_SEQ_FOR_EACH(HG_GEN_STRUCT_FIELD, , fields)               \
+        };                                                                     \
+        HG_GEN_PACK_POP                                                        \
+                                                                               \
+        enum {                                                                 \
+            BOOST_PP_CAT(hg_proc_, BOOST_PP_CAT(struct_type_name, _size)) =    \
+                sizeof(struct BOOST_PP_CAT(                                    \
+                    hg_proc_, BOOST_PP_CAT(struct_type_name, _flat)))          \
+        };                                                                     \
+                                                                               \
+        static HG_INLINE hg_return_t BOOST_PP_CAT(hg_proc_, struct_type_name)( \
+            hg_proc_t proc, void *data)                                        \
+        {                                                                      \
+            const hg_size_t size =                                             \
+                BOOST_PP_CAT(hg_proc_, BOOST_PP_CAT(struct_type_name, _size)); \
+            struct_type_name *struct_data = (struct_type_name *) data;         \
+            typedef struct BOOST_PP_CAT(                                       \
+                hg_proc_, BOOST_PP_CAT(struct_type_name, _flat)) flat_t;       \
+            flat_t *flat_data;                                                 \
+            hg_return_t ret = HG_SUCCESS;                                      \
+                                                                               \
+            switch (hg_proc_get_op(proc)) {                                    \
+                case HG_ENCODE:                                                \
+                    HG_PROC_CHECK_SIZE(proc, size, done, ret);                 \
+                    flat_data = (flat_t *) HG_PROC_BUF_PTR(proc);              \
+                    BOOST_PP_SEQ_FOR_EACH(HG_GEN_FLAT_ENCODE, , fields)        \
+                    break;                                                     \
+                case HG_DECODE:                                                \
+                    HG_PROC_CHECK_SIZE(proc, size, done, ret);                 \
+                    flat_data = (flat_t *) HG_PROC_BUF_PTR(proc);              \
+                    BOOST_PP_SEQ_FOR_EACH(HG_GEN_FLAT_DECODE, , fields)        \
+                    break;                                                     \
+                case HG_SIZE:                                                  \
+                    HG_PROC_SIZE_UPDATE(proc, size);                           \
+                    goto done;                                                 \
+                case HG_FREE:                                                  \
+                default:                                                       \
+                    goto done;                                                 \
+            }                                                                  \
+                                                                               \
+            HG_PROC_UPDATE(proc, size);                                        \
+            HG_PROC_CHECKSUM_UPDATE(proc, flat_data, size);                    \
+                                                                               \
+        done:                                                                  \
+            return ret;                                                        \
+        }
+
+/* Generate proc for struct, flat if possible */
+#    define HG_GEN_STRUCT_PROC(struct_type_name, fields)                       \
+        BOOST_PP_IIF(HG_GEN_IS_FLAT(fields), HG_GEN_STRUCT_FLAT_PROC,          \
+            HG_GEN_STRUCT_FIELDS_PROC)                                         \
+        (struct_type_name, fields)
+
+/* Generate proc for struct field, stopping after n_fields fields */
+#    define HG_GEN_PROC_N(r, struct_name, field)                               \
+        if (n_fields-- == 0)                                                   \
+            return ret;                                                        \
+        HG_GEN_PROC(r, struct_name, field)
+
+/* Generate proc for the first n_fields fields of struct */
+#    define HG_GEN_STRUCT_PROC_N(struct_type_name, fields)                     \
+        static HG_INLINE hg_return_t BOOST_PP_CAT(                             \
+            hg_proc_, BOOST_PP_CAT(struct_type_name, _n))(                     \
+            hg_proc_t proc, void *data, unsigned int n_fields)                 \
+        {                                                                      \
+            hg_return_t ret = HG_SUCCESS;                                      \
+            struct_type_name *struct_data = (struct_type_name *) data;         \
+                                                                               \
+            BOOST_PP_SEQ_FOR_EACH(HG_GEN_PROC_N, struct_data, fields)          \
+                                                                               \
+            return ret;                                                        \
+        }
+
+/* Generate peek proc for struct field, i.e., proc for all fields up to and
+ * including that field */
+#    define HG_GEN_PEEK_PROC(r, struct_type_name, i, field)                    \
+        static HG_INLINE hg_return_t BOOST_PP_CAT(hg_proc_,                    \
+            BOOST_PP_CAT(struct_type_name,                                     \
+                BOOST_PP_CAT(_peek_, HG_GEN_GET_NAME(field))))(                \
+            hg_proc_t proc, void *data)                                        \
+        {                                                                      \
+            return BOOST_PP_CAT(hg_proc_, BOOST_PP_CAT(struct_type_name, _n))( \
+                proc, data, i + 1);                                            \
+        }
+
+/* Generate peek procs for struct */
+#    define HG_GEN_STRUCT_PEEK_PROCS(struct_type_name, fields)                 \
+        HG_GEN_STRUCT_PROC_N(struct_type_name, fields)                         \
+        BOOST_PP_SEQ_FOR_EACH_I(HG_GEN_PEEK_PROC, struct_type_name, fields)
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -80,10 +235,15 @@
             BOOST_PP_CAT(hg_proc_, in_struct_type_name),                       \
             BOOST_PP_CAT(hg_proc_, out_struct_type_name), rpc_cb)
 
-/* Generate struct and corresponding struct proc */
+/* Generate struct and corresponding struct proc, as well as one peek proc
+ * hg_proc_<struct_type_name>_peek_<field> per field that can be used with
+ * MERCURY_PEEK_INPUT(). If all fields are fixed-width integers, the struct
+ * is encoded with a single copy and its encoded size is given by the
+ * hg_proc_<struct_type_name>_size constant */
 #    define MERCURY_GEN_PROC(struct_type_name, fields)                         \
         HG_GEN_STRUCT(struct_type_name, fields)                                \
-        HG_GEN_STRUCT_PROC(struct_type_name, fields)
+        HG_GEN_STRUCT_PROC(struct_type_name, fields)                           \
+        HG_GEN_STRUCT_PEEK_PROCS(struct_type_name, fields)
 
 /* In the case of user defined structures / MERCURY_GEN_STRUCT_PROC can be
  * used to generate the corresponding proc routine.
@@ -107,6 +267,19 @@
 
 #endif /* HG_HAS_BOOST */
 
+/* Decode input fields up to and including field without decoding the rest
+ * of the input, e.g.:
+ *   MERCURY_PEEK_INPUT(handle, my_rpc_in_t, obj_id, &in_struct)
+ * Peeked input must be freed with MERCURY_FREE_PEEK_INPUT()
+ */
+#define MERCURY_PEEK_INPUT(handle, struct_type_name, field, in_struct)         \
+    HG_Get_input_prefix(                                                       \
+        handle, hg_proc_##struct_type_name##_peek_##field, in_struct)
+
+#define MERCURY_FREE_PEEK_INPUT(handle, struct_type_name, field, in_struct)    \
+    HG_Free_input_prefix(                                                      \
+        handle, hg_proc_##struct_type_name##_peek_##field, in_struct)
+
 /* If no input args or output args, a void type can be
  * passed to MERCURY_REGISTER
  */
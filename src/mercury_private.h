@@ -12,8 +12,7 @@
 #define MERCURY_PRIVATE_H
 
 #include "mercury_core.h"
-
-#include "mercury_queue.h"
+#include "mercury_types.h"
 
 /*************************************/
 /* Public Type and Struct Definition */
@@ -33,8 +32,39 @@ struct hg_completion_entry {
         hg_core_handle_t hg_core_handle;
         struct hg_bulk_op_id *hg_bulk_op_id;
     } op_id;
-    HG_QUEUE_ENTRY(hg_completion_entry) entry;
     hg_op_type_t op_type;
 };
 
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+/**
+ * Create bulk handle without going through the registration cache, used for
+ * memory that is allocated and freed internally.
+ */
+HG_PRIVATE hg_return_t
+hg_bulk_create_uncached(hg_class_t *hg_class, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes, hg_uint8_t flags,
+    hg_bulk_t *handle);
+
+/**
+ * Respond to an RPC whose callback failed by sending an empty response
+ * carrying ret, if the RPC expects a response.
+ */
+HG_PRIVATE hg_return_t
+hg_core_respond_error(hg_core_handle_t handle, hg_return_t ret);
+
+/**
+ * Create pool of bulk operation IDs that caches up to max_count operations.
+ */
+HG_PRIVATE struct hg_bulk_op_pool *
+hg_bulk_op_pool_create(unsigned int max_count);
+
+/**
+ * Destroy pool of bulk operation IDs and free cached operations.
+ */
+HG_PRIVATE void
+hg_bulk_op_pool_destroy(struct hg_bulk_op_pool *hg_bulk_op_pool);
+
 #endif /* MERCURY_PRIVATE_H */
@@ -13,6 +13,7 @@
 #include "mercury_mem.h"
 
 #ifdef HG_HAS_CHECKSUMS
+#    include "mercury_crc32c.h"
 #    include <mchecksum.h>
 #endif
 
@@ -20,6 +21,9 @@
 /* Local Macros */
 /****************/
 
+/* Arena allocations are aligned to 16 bytes */
+#define HG_PROC_ARENA_ALIGN(size) (((size) + 15) & ~((hg_size_t) 15))
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -28,10 +32,31 @@
 /* Local Prototypes */
 /********************/
 
+/**
+ * Free arena chunks.
+ */
+static void
+hg_proc_arena_destroy(struct hg_proc_arena *arena);
+
 /*******************/
 /* Local Variables */
 /*******************/
 
+/*---------------------------------------------------------------------------*/
+static void
+hg_proc_arena_destroy(struct hg_proc_arena *arena)
+{
+    struct hg_proc_arena_chunk *chunk = arena->first;
+
+    while (chunk) {
+        struct hg_proc_arena_chunk *next = chunk->next;
+
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_proc_create(hg_class_t *hg_class, hg_proc_hash_t hash, hg_proc_t *proc)
@@ -49,6 +74,9 @@ hg_proc_create(hg_class_t *hg_class, hg_proc_hash_t hash, hg_proc_t *proc)
 
     memset(hg_proc, 0, sizeof(struct hg_proc));
     hg_proc->hg_class = hg_class;
+#ifdef HG_HAS_CHECKSUMS
+    hg_proc->hash = hash;
+#endif
 
     /* Map enum to string */
     switch (hash) {
@@ -68,11 +96,16 @@ hg_proc_create(hg_class_t *hg_class, hg_proc_hash_t hash, hg_proc_t *proc)
 
     if (hash_method) {
 #ifdef HG_HAS_CHECKSUMS
-        int rc = mchecksum_init(hash_method, &hg_proc->checksum);
-        HG_CHECK_ERROR(rc < 0, error, ret, HG_CHECKSUM_ERROR,
-            "Could not initialize checksum");
-
-        hg_proc->checksum_size = mchecksum_get_size(hg_proc->checksum);
+        if (hash == HG_CRC32) {
+            /* CRC32C is computed while copying data */
+            hg_proc->checksum_size = sizeof(hg_uint32_t);
+        } else {
+            int rc = mchecksum_init(hash_method, &hg_proc->checksum);
+            HG_CHECK_ERROR(rc < 0, error, ret, HG_CHECKSUM_ERROR,
+                "Could not initialize checksum");
+
+            hg_proc->checksum_size = mchecksum_get_size(hg_proc->checksum);
+        }
         hg_proc->checksum_hash = (char *) malloc(hg_proc->checksum_size);
         HG_CHECK_ERROR(hg_proc->checksum_hash == NULL, error, ret, HG_NOMEM,
             "Could not allocate space for checksum hash");
@@ -89,10 +122,9 @@ hg_proc_create(hg_class_t *hg_class, hg_proc_hash_t hash, hg_proc_t *proc)
 error:
     if (hg_proc) {
 #ifdef HG_HAS_CHECKSUMS
-        if (hash_method && hg_proc->checksum != MCHECKSUM_OBJECT_NULL) {
-            free(hg_proc->checksum_hash);
+        free(hg_proc->checksum_hash);
+        if (hash_method && hg_proc->checksum != MCHECKSUM_OBJECT_NULL)
             mchecksum_destroy(hg_proc->checksum);
-        }
 #endif
         free(hg_proc);
     }
@@ -147,6 +179,9 @@ hg_proc_free(hg_proc_t proc)
     if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine)
         hg_mem_aligned_free(hg_proc->extra_buf.buf);
 
+    if (hg_proc->arena)
+        hg_proc_arena_destroy(hg_proc->arena);
+
     /* Free proc */
     free(hg_proc);
 
@@ -163,8 +198,8 @@ hg_proc_reset(hg_proc_t proc, void *buf, hg_size_t buf_size, hg_proc_op_t op)
 
     HG_CHECK_ERROR(
         proc == HG_PROC_NULL, done, ret, HG_INVALID_ARG, "NULL HG proc");
-    HG_CHECK_ERROR(
-        !buf && op != HG_FREE, done, ret, HG_INVALID_ARG, "NULL buffer");
+    HG_CHECK_ERROR(!buf && op != HG_FREE && op != HG_SIZE, done, ret,
+        HG_INVALID_ARG, "NULL buffer");
 
     hg_proc->op = op;
 #ifdef HG_HAS_XDR
@@ -181,6 +216,9 @@ hg_proc_reset(hg_proc_t proc, void *buf, hg_size_t buf_size, hg_proc_op_t op)
             xdrmem_create(&hg_proc->proc_buf.xdr, (char *) buf,
                 (hg_uint32_t) buf_size, XDR_FREE);
             break;
+        case HG_SIZE:
+            /* Sizes are computed without XDR stream */
+            break;
         default:
             HG_GOTO_ERROR(
                 done, ret, HG_INVALID_PARAM, "Unknown proc operation");
@@ -200,13 +238,18 @@ hg_proc_reset(hg_proc_t proc, void *buf, hg_size_t buf_size, hg_proc_op_t op)
     hg_proc->extra_buf.size = 0;
     hg_proc->extra_buf.buf_ptr = hg_proc->extra_buf.buf;
     hg_proc->extra_buf.size_left = hg_proc->extra_buf.size;
+    hg_proc->user_extra_buf = NULL;
+    hg_proc->user_extra_buf_size = 0;
 
     /* Default to proc_buf */
     hg_proc->current_buf = &hg_proc->proc_buf;
 
 #ifdef HG_HAS_CHECKSUMS
     /* Reset checksum */
-    if (hg_proc->checksum != MCHECKSUM_OBJECT_NULL) {
+    if (hg_proc->hash == HG_CRC32) {
+        hg_proc->crc32c = 0;
+        memset(hg_proc->checksum_hash, 0, hg_proc->checksum_size);
+    } else if (hg_proc->checksum != MCHECKSUM_OBJECT_NULL) {
         int rc = mchecksum_reset(hg_proc->checksum);
         HG_CHECK_ERROR(
             rc < 0, done, ret, HG_CHECKSUM_ERROR, "Could not reset checksum");
@@ -242,8 +285,13 @@ hg_proc_set_size(hg_proc_t proc, hg_size_t req_buf_size)
     HG_CHECK_ERROR(new_buf_size <= hg_proc_get_size(proc), error, ret,
         HG_INVALID_ARG, "Buffer is already of the size requested");
 
-    /* If was not using extra buffer init extra buffer */
-    if (!hg_proc->extra_buf.buf) {
+    /* If was not using extra buffer init extra buffer, use buffer supplied
+     * by caller first if it is large enough */
+    if (!hg_proc->extra_buf.buf && hg_proc->user_extra_buf &&
+        req_buf_size <= hg_proc->user_extra_buf_size) {
+        new_buf = hg_proc->user_extra_buf;
+        new_buf_size = hg_proc->user_extra_buf_size;
+    } else if (!hg_proc->extra_buf.buf || !hg_proc->extra_buf.is_mine) {
         /* Allocate buffer */
         new_buf = hg_mem_aligned_alloc(page_size, new_buf_size);
         allocated = HG_TRUE;
@@ -258,14 +306,17 @@ hg_proc_set_size(hg_proc_t proc, hg_size_t req_buf_size)
 
         /* Switch buffer */
         hg_proc->current_buf = &hg_proc->extra_buf;
-    }
+    } else if (allocated)
+        /* Buffer supplied by caller is too small, copy what was encoded */
+        memcpy(new_buf, hg_proc->extra_buf.buf, (size_t) current_pos);
 
     hg_proc->extra_buf.buf = new_buf;
     hg_proc->extra_buf.size = new_buf_size;
     hg_proc->extra_buf.buf_ptr = (char *) hg_proc->extra_buf.buf + current_pos;
     hg_proc->extra_buf.size_left =
         hg_proc->extra_buf.size - (hg_size_t) current_pos;
-    hg_proc->extra_buf.is_mine = HG_TRUE;
+    hg_proc->extra_buf.is_mine =
+        (hg_bool_t)(new_buf != hg_proc->user_extra_buf);
 
     return ret;
 
@@ -287,6 +338,12 @@ hg_proc_save_ptr(hg_proc_t proc, hg_size_t data_size)
 
     HG_CHECK_ERROR_NORET(proc == HG_PROC_NULL, done, "Proc is not initialized");
 
+    /* Only account for size, there is no buffer */
+    if (hg_proc->op == HG_SIZE) {
+        HG_PROC_SIZE_UPDATE(proc, data_size);
+        goto done;
+    }
+
     /* If not enough space allocate extra space if encoding or
      * just get extra buffer if decoding */
     if (data_size && hg_proc->current_buf->size_left < data_size)
@@ -316,7 +373,8 @@ hg_proc_restore_ptr(hg_proc_t proc, void *data, hg_size_t data_size)
         "Proc is not initialized");
 
 #ifdef HG_HAS_CHECKSUMS
-    hg_proc_checksum_update(proc, data, data_size);
+    if (hg_proc_get_op(proc) != HG_SIZE)
+        hg_proc_checksum_update(proc, data, data_size);
 #else
     /* Silent warning */
     (void) data;
@@ -345,6 +403,106 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_set_user_extra_buf(hg_proc_t proc, void *buf, hg_size_t buf_size)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(proc == HG_PROC_NULL, done, ret, HG_INVALID_ARG,
+        "Proc is not initialized");
+    HG_CHECK_ERROR(hg_proc->extra_buf.buf != NULL, done, ret, HG_INVALID_ARG,
+        "Extra buf is already in use");
+
+    hg_proc->user_extra_buf = buf;
+    hg_proc->user_extra_buf_size = (buf) ? buf_size : 0;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_set_arena(hg_proc_t proc, hg_size_t chunk_size)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(proc == HG_PROC_NULL, done, ret, HG_INVALID_ARG,
+        "Proc is not initialized");
+
+    if (!chunk_size) {
+        if (hg_proc->arena) {
+            hg_proc_arena_destroy(hg_proc->arena);
+            hg_proc->arena = NULL;
+        }
+        goto done;
+    }
+
+    if (!hg_proc->arena) {
+        hg_proc->arena =
+            (struct hg_proc_arena *) malloc(sizeof(struct hg_proc_arena));
+        HG_CHECK_ERROR(hg_proc->arena == NULL, done, ret, HG_NOMEM,
+            "Could not allocate proc arena");
+        memset(hg_proc->arena, 0, sizeof(struct hg_proc_arena));
+    }
+    hg_proc->arena->chunk_size = chunk_size;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void *
+hg_proc_arena_alloc(hg_proc_t proc, hg_size_t size)
+{
+    struct hg_proc_arena *arena = ((struct hg_proc *) proc)->arena;
+    struct hg_proc_arena_chunk *chunk, *last = NULL;
+    hg_size_t offset;
+    void *ptr;
+
+    if (!arena)
+        return malloc(size);
+
+    size = HG_PROC_ARENA_ALIGN(size);
+
+    /* Move on to chunks kept from previous use until one has enough space */
+    chunk = arena->current;
+    offset = arena->offset;
+    while (chunk && offset + size > chunk->size) {
+        last = chunk;
+        chunk = chunk->next;
+        offset = 0;
+    }
+
+    /* Append new chunk */
+    if (!chunk) {
+        hg_size_t chunk_size =
+            (size > arena->chunk_size) ? size : arena->chunk_size;
+
+        chunk = (struct hg_proc_arena_chunk *) malloc(
+            sizeof(struct hg_proc_arena_chunk) + chunk_size);
+        HG_CHECK_ERROR_NORET(
+            chunk == NULL, error, "Could not allocate arena chunk");
+        chunk->next = NULL;
+        chunk->size = chunk_size;
+        if (last)
+            last->next = chunk;
+        else
+            arena->first = chunk;
+    }
+
+    ptr = (char *) (chunk + 1) + offset;
+    arena->current = chunk;
+    arena->offset = offset + size;
+
+    return ptr;
+
+error:
+    return NULL;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_proc_flush(hg_proc_t proc)
@@ -359,6 +517,12 @@ hg_proc_flush(hg_proc_t proc)
         "Proc is not initialized");
 
 #ifdef HG_HAS_CHECKSUMS
+    if (hg_proc->hash == HG_CRC32) {
+        memcpy(
+            hg_proc->checksum_hash, &hg_proc->crc32c, sizeof(hg_uint32_t));
+        goto done;
+    }
+
     rc = mchecksum_get(hg_proc->checksum, hg_proc->checksum_hash,
         hg_proc->checksum_size, MCHECKSUM_FINALIZE);
     HG_CHECK_ERROR(
@@ -374,16 +538,41 @@ done:
 void
 hg_proc_checksum_update(hg_proc_t proc, void *data, hg_size_t data_size)
 {
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
     int rc;
 
+    if (hg_proc->hash == HG_CRC32) {
+        hg_proc->crc32c =
+            hg_crc32c_update(hg_proc->crc32c, data, (size_t) data_size);
+        goto done;
+    }
+
     /* Update checksum */
-    rc = mchecksum_update(((struct hg_proc *) proc)->checksum, data, data_size);
+    rc = mchecksum_update(hg_proc->checksum, data, data_size);
     HG_CHECK_ERROR_NORET(rc < 0, done, "Could not update checksum");
 
 done:
     return;
 }
 
+/*---------------------------------------------------------------------------*/
+void
+hg_proc_checksum_copy(
+    hg_proc_t proc, void *dst, const void *src, hg_size_t data_size)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+
+    /* Read data once */
+    if (hg_proc->hash == HG_CRC32) {
+        hg_proc->crc32c =
+            hg_crc32c_copy(hg_proc->crc32c, dst, src, (size_t) data_size);
+        return;
+    }
+
+    memcpy(dst, src, (size_t) data_size);
+    hg_proc_checksum_update(proc, dst, data_size);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_proc_checksum_get(hg_proc_t proc, void *hash, hg_size_t hash_size)
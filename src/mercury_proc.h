@@ -95,6 +95,9 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
         } while (0)
 #endif
 
+/* Current position in proc buffer */
+#define HG_PROC_BUF_PTR(proc) (((struct hg_proc *) proc)->current_buf->buf_ptr)
+
 /* Encode type */
 #define HG_PROC_TYPE_ENCODE(proc, data, size)                                  \
     memcpy(((struct hg_proc *) proc)->current_buf->buf_ptr, data, size)
@@ -111,6 +114,15 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
         ((struct hg_proc *) proc)->current_buf->size_left -= size;             \
     } while (0)
 
+/* Account for size when computing encoded size (HG_SIZE) */
+#define HG_PROC_SIZE_UPDATE(proc, data_size)                                   \
+    ((struct hg_proc *) proc)->current_buf->size += (hg_size_t) (data_size)
+
+/* XDR encodes data in units of 4 bytes */
+#ifdef HG_HAS_XDR
+#    define HG_PROC_XDR_SIZE(size) (((size) + 3) & ~((hg_size_t) 3))
+#endif
+
 /* Update checksum */
 #ifdef HG_HAS_CHECKSUMS
 #    define HG_PROC_CHECKSUM_UPDATE(proc, data, size)                          \
@@ -119,10 +131,29 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
 #    define HG_PROC_CHECKSUM_UPDATE(proc, data, size)
 #endif
 
+/* Encode / decode type and update checksum, reading data only once */
+#ifdef HG_HAS_CHECKSUMS
+#    define HG_PROC_TYPE_ENCODE_CHECKSUM(proc, data, size)                     \
+        hg_proc_checksum_copy(proc, HG_PROC_BUF_PTR(proc), data, size)
+#    define HG_PROC_TYPE_DECODE_CHECKSUM(proc, data, size)                     \
+        hg_proc_checksum_copy(proc, data, HG_PROC_BUF_PTR(proc), size)
+#else
+#    define HG_PROC_TYPE_ENCODE_CHECKSUM(proc, data, size)                     \
+        HG_PROC_TYPE_ENCODE(proc, data, size)
+#    define HG_PROC_TYPE_DECODE_CHECKSUM(proc, data, size)                     \
+        HG_PROC_TYPE_DECODE(proc, data, size)
+#endif
+
 /* Base proc function */
 #ifdef HG_HAS_XDR
 #    define HG_PROC_TYPE(proc, type, data, label, ret)                         \
         do {                                                                   \
+            /* Only account for size in HG_SIZE */                             \
+            if (hg_proc_get_op(proc) == HG_SIZE) {                             \
+                HG_PROC_SIZE_UPDATE(proc, HG_PROC_XDR_SIZE(sizeof(type)));     \
+                goto label;                                                    \
+            }                                                                  \
+                                                                               \
             HG_PROC_CHECK_SIZE(proc, sizeof(type), label, ret);                \
                                                                                \
             if (xdr_##type(hg_proc_get_xdr_ptr(proc), data) == 0) {            \
@@ -140,19 +171,24 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
             if (hg_proc_get_op(proc) == HG_FREE)                               \
                 goto label;                                                    \
                                                                                \
+            /* Only account for size in HG_SIZE */                             \
+            if (hg_proc_get_op(proc) == HG_SIZE) {                             \
+                HG_PROC_SIZE_UPDATE(proc, sizeof(type));                       \
+                goto label;                                                    \
+            }                                                                  \
+                                                                               \
             /* If not enough space allocate extra space if encoding or just */ \
             /* get extra buffer if decoding */                                 \
             HG_PROC_CHECK_SIZE(proc, sizeof(type), label, ret);                \
                                                                                \
-            /* Encode, decode type */                                          \
+            /* Encode, decode type and update checksum */                      \
             if (hg_proc_get_op(proc) == HG_ENCODE)                             \
-                HG_PROC_TYPE_ENCODE(proc, data, sizeof(type));                 \
+                HG_PROC_TYPE_ENCODE_CHECKSUM(proc, data, sizeof(type));        \
             else                                                               \
-                HG_PROC_TYPE_DECODE(proc, data, sizeof(type));                 \
+                HG_PROC_TYPE_DECODE_CHECKSUM(proc, data, sizeof(type));        \
                                                                                \
-            /* Update proc pointers etc */                                     \
+            /* Update proc pointers */                                         \
             HG_PROC_UPDATE(proc, sizeof(type));                                \
-            HG_PROC_CHECKSUM_UPDATE(proc, data, sizeof(type));                 \
         } while (0)
 #endif
 
@@ -160,6 +196,12 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
 #ifdef HG_HAS_XDR
 #    define HG_PROC_BYTES(proc, data, size, label, ret)                        \
         do {                                                                   \
+            /* Only account for size in HG_SIZE */                             \
+            if (hg_proc_get_op(proc) == HG_SIZE) {                             \
+                HG_PROC_SIZE_UPDATE(proc, 4 + HG_PROC_XDR_SIZE(size));         \
+                goto label;                                                    \
+            }                                                                  \
+                                                                               \
             HG_PROC_CHECK_SIZE(proc, size, label, ret);                        \
                                                                                \
             if (xdr_bytes(hg_proc_get_xdr_ptr(proc), (char **) &data,          \
@@ -178,19 +220,24 @@ typedef enum { HG_CRC16, HG_CRC32, HG_CRC64, HG_NOHASH } hg_proc_hash_t;
             if (hg_proc_get_op(proc) == HG_FREE)                               \
                 goto label;                                                    \
                                                                                \
+            /* Only account for size in HG_SIZE */                             \
+            if (hg_proc_get_op(proc) == HG_SIZE) {                             \
+                HG_PROC_SIZE_UPDATE(proc, size);                               \
+                goto label;                                                    \
+            }                                                                  \
+                                                                               \
             /* If not enough space allocate extra space if encoding or just */ \
             /* get extra buffer if decoding */                                 \
             HG_PROC_CHECK_SIZE(proc, size, label, ret);                        \
                                                                                \
-            /* Encode, decode type */                                          \
+            /* Encode, decode type and update checksum */                      \
             if (hg_proc_get_op(proc) == HG_ENCODE)                             \
-                HG_PROC_TYPE_ENCODE(proc, data, size);                         \
+                HG_PROC_TYPE_ENCODE_CHECKSUM(proc, data, size);                \
             else                                                               \
-                HG_PROC_TYPE_DECODE(proc, data, size);                         \
+                HG_PROC_TYPE_DECODE_CHECKSUM(proc, data, size);                \
                                                                                \
-            /* Update proc pointers etc */                                     \
+            /* Update proc pointers */                                         \
             HG_PROC_UPDATE(proc, size);                                        \
-            HG_PROC_CHECKSUM_UPDATE(proc, data, size);                         \
         } while (0)
 #endif
 
@@ -253,7 +300,17 @@ hg_proc_free(hg_proc_t proc);
  *                              serialization/deserialization
  * \param buf_size [IN]         buffer size
  * \param op [IN]               operation type: HG_ENCODE / HG_DECODE /
- * HG_FREE
+ * HG_FREE / HG_SIZE
+ *
+ * \remark With HG_SIZE, buf may be NULL and nothing is encoded, procs only
+ * account for the size that encoding would use, which hg_proc_get_size_used()
+ * then returns. Mercury only resets procs with HG_SIZE for RPCs registered with
+ * HG_Registered_enable_size_pass(). Procs of these RPCs must then handle
+ * HG_SIZE as HG_ENCODE without reading or writing buffers: call the type
+ * procs, hg_proc_raw() or hg_proc_save_ptr() on the same fields, which only
+ * account for the size, and never take the HG_DECODE path, which would
+ * allocate and decode from a NULL buffer. A proc that returns an error on
+ * HG_SIZE is encoded without computing its size first.
  *
  * \return HG_SUCCESS or corresponding HG error code
  */
@@ -324,7 +381,8 @@ hg_proc_get_size_left(hg_proc_t proc);
 
 /**
  * Get pointer to current buffer. Will reserve data_size for manual
- * encoding.
+ * encoding. With HG_SIZE, data_size is only accounted for and NULL is
+ * returned.
  *
  * \param proc [IN]             abstract processor object
  * \param data_size [IN]        data size
@@ -389,6 +447,72 @@ hg_proc_get_extra_size(hg_proc_t proc);
 HG_PUBLIC hg_return_t
 hg_proc_set_extra_buf_is_mine(hg_proc_t proc, hg_bool_t mine);
 
+/**
+ * Set buffer that processor writes into when encoded data does not fit into
+ * the buffer passed to hg_proc_reset(), instead of allocating a new extra
+ * buffer. The buffer remains owned by the caller, if it is too small, an extra
+ * buffer is allocated as usual. That buffer is only used until the next call
+ * to hg_proc_reset().
+ *
+ * \param proc [IN]             abstract processor object
+ * \param buf [IN]              pointer to buffer
+ * \param buf_size [IN]         buffer size
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+hg_proc_set_user_extra_buf(hg_proc_t proc, void *buf, hg_size_t buf_size);
+
+/**
+ * Attach a bump arena to the processor that hg_proc_arena_alloc() allocates
+ * from. Chunks of chunk_size bytes are allocated on first use and are kept
+ * until the processor is freed, so that decoding into a processor that is
+ * reused does not allocate once the arena has grown to the size needed.
+ * Passing a chunk_size of 0 detaches and frees the arena.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param chunk_size [IN]       minimum size of arena chunks
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+hg_proc_set_arena(hg_proc_t proc, hg_size_t chunk_size);
+
+/**
+ * Allocate memory while decoding. Memory is allocated from the processor arena
+ * if one is attached, otherwise it is allocated with malloc(). In both cases,
+ * it must be released with hg_proc_arena_free() when the proc operation is
+ * HG_FREE.
+ *
+ * \param proc [IN]             abstract processor object
+ * \param size [IN]             size of allocation
+ *
+ * \return Pointer to memory or NULL if it could not be allocated
+ */
+HG_PUBLIC void *
+hg_proc_arena_alloc(hg_proc_t proc, hg_size_t size);
+
+/**
+ * Release memory allocated with hg_proc_arena_alloc(). Nothing is done if the
+ * processor has an arena attached, memory is released all at once when the
+ * arena is reset.
+ *
+ * \param proc [IN]             abstract processor object
+ * \param ptr [IN]              pointer to memory
+ */
+static HG_INLINE void
+hg_proc_arena_free(hg_proc_t proc, void *ptr);
+
+/**
+ * Release all memory allocated from the processor arena at once. Memory is
+ * kept for subsequent allocations. Unlike hg_proc_reset(), this must only be
+ * called once decoded data is no longer in use.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ */
+static HG_INLINE void
+hg_proc_arena_reset(hg_proc_t proc);
+
 /**
  * Flush the proc after data has been encoded or decoded and finalize
  * internal checksum if checksum of data processed was initially requested.
@@ -559,6 +683,11 @@ hg_proc_bytes(hg_proc_t proc, void *data, hg_size_t data_size);
 #ifdef HG_HAS_CHECKSUMS
 HG_PUBLIC void
 hg_proc_checksum_update(hg_proc_t proc, void *data, hg_size_t data_size);
+
+/* Copy data and update checksum */
+HG_PUBLIC void
+hg_proc_checksum_copy(
+    hg_proc_t proc, void *dst, const void *src, hg_size_t data_size);
 #endif
 
 /************************************/
@@ -577,20 +706,59 @@ struct hg_proc_buf {
 #endif
 };
 
+/* HG proc arena chunk, data follows */
+struct hg_proc_arena_chunk {
+    struct hg_proc_arena_chunk *next; /* Next chunk */
+    hg_size_t size;                   /* Size of data */
+};
+
+/* HG proc arena */
+struct hg_proc_arena {
+    struct hg_proc_arena_chunk *first;   /* First chunk */
+    struct hg_proc_arena_chunk *current; /* Chunk allocated from */
+    hg_size_t offset;                    /* Offset in current chunk */
+    hg_size_t chunk_size;                /* Minimum chunk size */
+};
+
 /* HG proc */
 struct hg_proc {
     struct hg_proc_buf proc_buf;
     struct hg_proc_buf extra_buf;
     hg_class_t *hg_class; /* HG class */
     struct hg_proc_buf *current_buf;
+    void *user_extra_buf;          /* Extra buffer supplied by caller */
+    hg_size_t user_extra_buf_size; /* Size of user extra buffer */
+    struct hg_proc_arena *arena;   /* Arena for decoded data */
 #ifdef HG_HAS_CHECKSUMS
     void *checksum;       /* Checksum */
     void *checksum_hash;  /* Base checksum buf */
     size_t checksum_size; /* Checksum size */
+    hg_uint32_t crc32c;   /* CRC32C (HG_CRC32) */
+    hg_proc_hash_t hash;  /* Hash method */
 #endif
     hg_proc_op_t op;
 };
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_proc_arena_free(hg_proc_t proc, void *ptr)
+{
+    if (!((struct hg_proc *) proc)->arena)
+        free(ptr);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_proc_arena_reset(hg_proc_t proc)
+{
+    struct hg_proc_arena *arena = ((struct hg_proc *) proc)->arena;
+
+    if (arena) {
+        arena->current = arena->first;
+        arena->offset = 0;
+    }
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_class_t *
 hg_proc_get_class(hg_proc_t proc)
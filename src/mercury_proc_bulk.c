@@ -37,7 +37,8 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
     hg_uint64_t buf_size = 0;
 
     switch (hg_proc_get_op(proc)) {
-        case HG_ENCODE: {
+        case HG_ENCODE:
+        case HG_SIZE: {
             hg_bool_t request_eager = HG_FALSE;
             void *cached_ptr = NULL;
 
@@ -70,6 +71,8 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
                 hg_proc_raw(proc, cached_ptr, buf_size);
             else {
                 buf = hg_proc_save_ptr(proc, buf_size);
+                if (hg_proc_get_op(proc) == HG_SIZE)
+                    break;
                 ret =
                     HG_Bulk_serialize(buf, buf_size, request_eager, *bulk_ptr);
                 if (ret != HG_SUCCESS)
@@ -91,6 +94,9 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
                 break;
             }
 
+            /* Bulk handles are reference counted and may be kept after the
+             * decoded struct is freed, they are therefore never allocated
+             * from the proc arena */
             buf = hg_proc_save_ptr(proc, buf_size);
             ret = HG_Bulk_deserialize(hg_class, bulk_ptr, buf, buf_size);
             if (ret != HG_SUCCESS)
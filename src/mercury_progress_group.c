@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_progress_group.h"
+#include "mercury_error.h"
+
+#include "mercury_atomic.h"
+#include "mercury_thread.h"
+#include "mercury_time.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Timeout (ms) used by progress threads, bounds the time to notice exit */
+#define HG_PROGRESS_GROUP_TIMEOUT 100
+
+/* Max number of callbacks triggered at once by progress threads */
+#define HG_PROGRESS_GROUP_TRIGGER_MAX 64
+
+/* Max contexts in a group (context IDs are 8-bit) */
+#define HG_PROGRESS_GROUP_MAX_COUNT 256
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Progress thread */
+struct hg_progress_thread {
+    struct hg_progress_group *group; /* Group this thread belongs to */
+    hg_context_t *context;           /* Context owned by this thread */
+    hg_thread_t thread;              /* Thread ID */
+    hg_bool_t started;               /* Thread was started */
+};
+
+/* Progress group */
+struct hg_progress_group {
+    struct hg_progress_thread *threads; /* Array of threads */
+    unsigned int count;                 /* Number of threads */
+    hg_uint8_t first_id;                /* ID of first context */
+    unsigned long flags;                /* Group flags */
+    hg_atomic_int32_t finalizing;       /* Stop threads */
+    hg_atomic_int32_t error;            /* First error of a progress thread */
+    hg_atomic_int32_t trigger_index;    /* Next context to trigger */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Progress thread loop.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_progress_group_thread(void *arg);
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_progress_group_thread(void *arg)
+{
+    struct hg_progress_thread *progress_thread =
+        (struct hg_progress_thread *) arg;
+    struct hg_progress_group *group = progress_thread->group;
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    hg_return_t ret;
+
+    while (!hg_atomic_get32(&group->finalizing)) {
+        if (!(group->flags & HG_PROGRESS_GROUP_SHARED_TRIGGER)) {
+            unsigned int actual_count = 0;
+
+            do {
+                ret = HG_Trigger(progress_thread->context, 0,
+                    HG_PROGRESS_GROUP_TRIGGER_MAX, &actual_count);
+            } while ((ret == HG_SUCCESS) && actual_count &&
+                     !hg_atomic_get32(&group->finalizing));
+            HG_CHECK_ERROR_NORET(ret != HG_SUCCESS && ret != HG_TIMEOUT, error,
+                "Could not trigger callbacks (%s)", HG_Error_to_string(ret));
+        }
+
+        ret = HG_Progress(progress_thread->context, HG_PROGRESS_GROUP_TIMEOUT);
+        HG_CHECK_ERROR_NORET(ret != HG_SUCCESS && ret != HG_TIMEOUT, error,
+            "Could not make progress (%s)", HG_Error_to_string(ret));
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+
+error:
+    /* Context no longer makes progress, report it to the group owner */
+    hg_atomic_cas32(&group->error, HG_SUCCESS, (hg_util_int32_t) ret);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_progress_group_t *
+HG_Progress_group_create(hg_class_t *hg_class, hg_uint8_t first_id,
+    unsigned int count, unsigned long flags)
+{
+    struct hg_progress_group *group = NULL;
+    unsigned int i;
+
+    HG_CHECK_ERROR_NORET(hg_class == NULL, error, "NULL HG class");
+    HG_CHECK_ERROR_NORET(count == 0, error, "Invalid number of contexts");
+    HG_CHECK_ERROR_NORET(first_id + count > HG_PROGRESS_GROUP_MAX_COUNT, error,
+        "Context IDs exceed %d", HG_PROGRESS_GROUP_MAX_COUNT);
+
+    group = (struct hg_progress_group *) malloc(
+        sizeof(struct hg_progress_group));
+    HG_CHECK_ERROR_NORET(
+        group == NULL, error, "Could not allocate progress group");
+    memset(group, 0, sizeof(struct hg_progress_group));
+    group->first_id = first_id;
+    group->flags = flags;
+    hg_atomic_init32(&group->finalizing, 0);
+    hg_atomic_init32(&group->error, HG_SUCCESS);
+    hg_atomic_init32(&group->trigger_index, 0);
+
+    group->threads = (struct hg_progress_thread *) malloc(
+        count * sizeof(struct hg_progress_thread));
+    HG_CHECK_ERROR_NORET(
+        group->threads == NULL, error, "Could not allocate progress threads");
+    memset(group->threads, 0, count * sizeof(struct hg_progress_thread));
+    group->count = count;
+
+    /* Create all contexts first so that no RPC is lost */
+    for (i = 0; i < count; i++) {
+        group->threads[i].group = group;
+        group->threads[i].context =
+            HG_Context_create_id(hg_class, (hg_uint8_t)(first_id + i));
+        HG_CHECK_ERROR_NORET(group->threads[i].context == NULL, error,
+            "Could not create context with ID %u", first_id + i);
+    }
+
+    for (i = 0; i < count; i++) {
+        int rc = hg_thread_create(&group->threads[i].thread,
+            hg_progress_group_thread, &group->threads[i]);
+        HG_CHECK_ERROR_NORET(
+            rc != HG_UTIL_SUCCESS, error, "Could not create progress thread");
+        group->threads[i].started = HG_TRUE;
+    }
+
+    return group;
+
+error:
+    if (group)
+        HG_Progress_group_destroy(group);
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Progress_group_destroy(hg_progress_group_t *group)
+{
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    if (!group)
+        goto done;
+
+    /* Stop all threads before destroying contexts */
+    hg_atomic_set32(&group->finalizing, 1);
+    for (i = 0; i < group->count; i++) {
+        if (group->threads[i].started) {
+            hg_thread_join(group->threads[i].thread);
+            group->threads[i].started = HG_FALSE;
+        }
+    }
+
+    for (i = 0; i < group->count; i++) {
+        if (!group->threads[i].context)
+            continue;
+
+        ret = HG_Context_destroy(group->threads[i].context);
+        HG_CHECK_HG_ERROR(done, ret, "Could not destroy context (%s)",
+            HG_Error_to_string(ret));
+        group->threads[i].context = NULL;
+    }
+
+    /* Report failure of progress threads */
+    ret = (hg_return_t) hg_atomic_get32(&group->error);
+    if (ret != HG_SUCCESS)
+        HG_LOG_ERROR("Progress thread failed (%s)", HG_Error_to_string(ret));
+
+    free(group->threads);
+    free(group);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+HG_Progress_group_get_count(const hg_progress_group_t *group)
+{
+    return (group) ? group->count : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint8_t
+HG_Progress_group_get_first_id(const hg_progress_group_t *group)
+{
+    return (group) ? group->first_id : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_context_t *
+HG_Progress_group_get_context(
+    const hg_progress_group_t *group, unsigned int index)
+{
+    HG_CHECK_ERROR_NORET(group == NULL, error, "NULL progress group");
+    HG_CHECK_ERROR_NORET(
+        index >= group->count, error, "Invalid context index (%u)", index);
+
+    return group->threads[index].context;
+
+error:
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Progress_group_trigger(hg_progress_group_t *group, unsigned int timeout,
+    unsigned int max_count, unsigned int *actual_count)
+{
+    double remaining =
+        timeout / 1000.0; /* Convert timeout in ms into seconds */
+    unsigned int count = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(group == NULL, done, ret, HG_INVALID_ARG,
+        "NULL progress group");
+    HG_CHECK_ERROR(!(group->flags & HG_PROGRESS_GROUP_SHARED_TRIGGER), done,
+        ret, HG_INVALID_ARG, "Progress group does not use shared trigger");
+
+    /* Contexts of failed progress threads would never complete */
+    ret = (hg_return_t) hg_atomic_get32(&group->error);
+    HG_CHECK_HG_ERROR(
+        done, ret, "Progress thread failed (%s)", HG_Error_to_string(ret));
+
+    for (;;) {
+        unsigned int start, i;
+        hg_time_t t1, t2;
+
+        /* Start from a different context each time to avoid starvation */
+        start = (unsigned int) hg_atomic_incr32(&group->trigger_index);
+        for (i = 0; i < group->count && count < max_count; i++) {
+            hg_context_t *context =
+                group->threads[(start + i) % group->count].context;
+            unsigned int context_count = 0;
+
+            ret = HG_Trigger(context, 0, max_count - count, &context_count);
+            if (ret == HG_TIMEOUT)
+                continue;
+            HG_CHECK_HG_ERROR(done, ret, "Could not trigger callbacks (%s)",
+                HG_Error_to_string(ret));
+            count += context_count;
+        }
+
+        if (count > 0 || (int) (remaining * 1000.0) <= 0)
+            break;
+
+        /* Nothing completed, wait on one of the contexts for a while */
+        hg_time_get_current_ms(&t1);
+        ret = HG_Trigger(group->threads[start % group->count].context, 1,
+            max_count, &count);
+        if (ret != HG_TIMEOUT) {
+            HG_CHECK_HG_ERROR(done, ret, "Could not trigger callbacks (%s)",
+                HG_Error_to_string(ret));
+            break;
+        }
+        hg_time_get_current_ms(&t2);
+        remaining -= hg_time_diff(t2, t1);
+    }
+
+    ret = (count > 0) ? HG_SUCCESS : HG_TIMEOUT;
+
+done:
+    if (actual_count)
+        *actual_count = count;
+
+    return ret;
+}
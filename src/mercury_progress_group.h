@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_PROGRESS_GROUP_H
+#define MERCURY_PROGRESS_GROUP_H
+
+#include "mercury.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+typedef struct hg_progress_group hg_progress_group_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Progress group flags */
+#define HG_PROGRESS_GROUP_SHARED_TRIGGER (1 << 0) /* No trigger in threads */
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create a group of \count progress threads. Each thread owns its own HG
+ * context, contexts are created with HG_Context_create_id() using IDs
+ * \first_id to \first_id + \count - 1, so that remote peers can direct RPCs
+ * to a given thread by using HG_Set_target_id() or HG_Set_target_id_hash()
+ * with the same \first_id and \count. NA must be initialized with enough
+ * contexts (see na_init_info.max_contexts) when the plugin requires it.
+ * By default, each thread progresses and triggers its own context. If
+ * HG_PROGRESS_GROUP_SHARED_TRIGGER is passed, threads only make progress
+ * and callbacks must be executed by calling HG_Progress_group_trigger().
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param first_id [IN]         ID of first context
+ * \param count [IN]            number of threads / contexts
+ * \param flags [IN]            bitwise OR of progress group flags
+ *
+ * \return Pointer to progress group or NULL in case of failure
+ */
+HG_PUBLIC hg_progress_group_t *
+HG_Progress_group_create(hg_class_t *hg_class, hg_uint8_t first_id,
+    unsigned int count, unsigned long flags);
+
+/**
+ * Stop progress threads and destroy the contexts of the group. If a progress
+ * thread stopped on an error, the group is still destroyed and that error is
+ * returned.
+ *
+ * \param group [IN]            pointer to progress group
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Progress_group_destroy(hg_progress_group_t *group);
+
+/**
+ * Get number of contexts in progress group.
+ *
+ * \param group [IN]            pointer to progress group
+ *
+ * \return Number of contexts
+ */
+HG_PUBLIC unsigned int
+HG_Progress_group_get_count(const hg_progress_group_t *group);
+
+/**
+ * Get ID of first context in progress group.
+ *
+ * \param group [IN]            pointer to progress group
+ *
+ * \return ID of first context
+ */
+HG_PUBLIC hg_uint8_t
+HG_Progress_group_get_first_id(const hg_progress_group_t *group);
+
+/**
+ * Get context of index \index (context ID is first_id + index).
+ *
+ * \param group [IN]            pointer to progress group
+ * \param index [IN]            index of context
+ *
+ * \return Pointer to context or NULL if index is not valid
+ */
+HG_PUBLIC hg_context_t *
+HG_Progress_group_get_context(
+    const hg_progress_group_t *group, unsigned int index);
+
+/**
+ * Execute at most max_count callbacks from the completion queues of all
+ * the contexts of the group. Must be used along with
+ * HG_PROGRESS_GROUP_SHARED_TRIGGER, can be called by multiple threads.
+ * Progress threads stop on error, in which case that error is returned and
+ * the group must be destroyed.
+ *
+ * \param group [IN]            pointer to progress group
+ * \param timeout [IN]          timeout (in milliseconds)
+ * \param max_count [IN]        maximum number of callbacks triggered
+ * \param actual_count [OUT]    actual number of callbacks triggered
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Progress_group_trigger(hg_progress_group_t *group, unsigned int timeout,
+    unsigned int max_count, unsigned int *actual_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_PROGRESS_GROUP_H */
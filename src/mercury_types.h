@@ -24,6 +24,8 @@ typedef struct hg_handle *hg_handle_t;  /* Abstract RPC handle */
 typedef struct hg_bulk *hg_bulk_t;      /* Abstract bulk data handle */
 typedef struct hg_proc *hg_proc_t;      /* Abstract serialization processor */
 typedef struct hg_op_id *hg_op_id_t;    /* Abstract operation id */
+typedef struct hg_completion_entry
+    *hg_completion_t; /* Abstract completion entry */
 
 /* HG info struct */
 struct hg_info {
@@ -85,11 +87,12 @@ typedef hg_return_t (*hg_proc_cb_t)(hg_proc_t proc, void *data);
 /*****************/
 
 /* Constant values */
-#define HG_ADDR_NULL    ((hg_addr_t) 0)
-#define HG_HANDLE_NULL  ((hg_handle_t) 0)
-#define HG_BULK_NULL    ((hg_bulk_t) 0)
-#define HG_PROC_NULL    ((hg_proc_t) 0)
-#define HG_OP_ID_NULL   ((hg_op_id_t) 0)
-#define HG_OP_ID_IGNORE ((hg_op_id_t *) 1)
+#define HG_ADDR_NULL       ((hg_addr_t) 0)
+#define HG_HANDLE_NULL     ((hg_handle_t) 0)
+#define HG_BULK_NULL       ((hg_bulk_t) 0)
+#define HG_PROC_NULL       ((hg_proc_t) 0)
+#define HG_OP_ID_NULL      ((hg_op_id_t) 0)
+#define HG_OP_ID_IGNORE    ((hg_op_id_t *) 1)
+#define HG_COMPLETION_NULL ((hg_completion_t) 0)
 
 #endif /* MERCURY_TYPES_H */
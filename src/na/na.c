@@ -10,7 +10,9 @@
 
 #include "na_plugin.h"
 
+#include "mercury_atomic_queue.h"
 #include "mercury_mem.h"
+#include "mercury_mpmc_queue.h"
 #include "mercury_time.h"
 
 #include <stdlib.h>
@@ -28,11 +30,25 @@
 #    define strdup _strdup
 #endif
 
-#define NA_ATOMIC_QUEUE_SIZE 1024 /* TODO make it configurable */
-
 /* 32-bit lock value for serial progress */
 #define NA_PROGRESS_LOCK 0x80000000
 
+/* Lower bound of adaptive spin time (us) */
+#define NA_SPIN_TIME_MIN 1
+
+/* Map stat type to either 32-bit atomic or 64-bit */
+#ifndef HG_UTIL_HAS_OPA_PRIMITIVES_H
+typedef hg_atomic_int64_t na_stat_t;
+#    define na_stat_init hg_atomic_init64
+#    define na_stat_incr hg_atomic_incr64
+#    define na_stat_get  hg_atomic_get64
+#else
+typedef hg_atomic_int32_t na_stat_t;
+#    define na_stat_init hg_atomic_init32
+#    define na_stat_incr hg_atomic_incr32
+#    define na_stat_get  hg_atomic_get32
+#endif
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -52,16 +68,15 @@ struct na_private_context {
 #ifdef NA_HAS_MULTI_PROGRESS
     hg_thread_mutex_t progress_mutex; /* Progress mutex */
 #endif
-    HG_QUEUE_HEAD(na_cb_completion_data)
-    backfill_queue;                           /* Backfill completion queue */
-    struct hg_atomic_queue *completion_queue; /* Default completion queue */
-    na_class_t *na_class;                     /* Pointer to NA class */
-    hg_atomic_int32_t
-        backfill_queue_count;          /* Number of entries in backfill queue */
-    hg_atomic_int32_t trigger_waiting; /* Polling/waiting in trigger */
+    struct hg_mpmc_queue *completion_queue; /* Default completion queue */
+    na_class_t *na_class;                   /* Pointer to NA class */
+    hg_atomic_int32_t trigger_waiting;      /* Polling/waiting in trigger */
 #ifdef NA_HAS_MULTI_PROGRESS
     hg_atomic_int32_t progressing; /* Progressing count */
 #endif
+    na_stat_t spin_count;  /* Progress made while spinning */
+    na_stat_t block_count; /* Fallbacks to blocking progress */
+    double spin_time;      /* Current spin time (s) */
 };
 
 /********************/
@@ -76,6 +91,11 @@ na_info_parse(const char *host_string, struct na_info **na_info_ptr);
 static void
 na_info_free(struct na_info *na_info);
 
+/* Spin on progress for a self-tuned amount of time */
+static na_return_t
+na_progress_spin(
+    struct na_private_context *na_private_context, double *remaining);
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -96,6 +116,9 @@ static const struct na_class_ops *const na_class_table[] = {
 #endif
 #ifdef NA_HAS_CCI
     &NA_PLUGIN_OPS(cci),
+#endif
+#ifdef NA_HAS_TCP
+    &NA_PLUGIN_OPS(tcp),
 #endif
     NULL};
 
@@ -203,6 +226,67 @@ na_info_free(struct na_info *na_info)
     free(na_info);
 }
 
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_progress_spin(
+    struct na_private_context *na_private_context, double *remaining)
+{
+    na_class_t *na_class = na_private_context->na_class;
+    double max_spin_time = (double) na_class->max_spin_time / 1e6;
+    double min_spin_time = (double) NA_SPIN_TIME_MIN / 1e6;
+    double spin_time = na_private_context->spin_time, elapsed = 0;
+    hg_time_t t1, t2;
+    na_return_t ret = NA_TIMEOUT;
+
+    /* Never spin past the requested timeout */
+    if (spin_time > *remaining)
+        spin_time = *remaining;
+
+    hg_time_get_current(&t1);
+    do {
+        /* Something is in one of the completion queues */
+        if (!hg_mpmc_queue_is_empty(na_private_context->completion_queue))
+            ret = NA_SUCCESS;
+        else {
+            ret = na_class->ops->progress(
+                na_class, &na_private_context->context, 0);
+            if (ret != NA_TIMEOUT)
+                NA_CHECK_NA_ERROR(done, ret, "Could not make progress");
+        }
+
+        hg_time_get_current(&t2);
+        elapsed = hg_time_diff(t2, t1);
+        if (ret == NA_SUCCESS)
+            break;
+
+        cpu_spinwait();
+    } while (elapsed < spin_time);
+
+    if (ret == NA_SUCCESS) {
+        na_stat_incr(&na_private_context->spin_count);
+
+        /* Progress was made late in the window, spin longer next time */
+        if (elapsed * 2.0 > na_private_context->spin_time)
+            na_private_context->spin_time =
+                (na_private_context->spin_time * 2.0 < max_spin_time)
+                    ? na_private_context->spin_time * 2.0
+                    : max_spin_time;
+    } else {
+        /* Nothing arrived, spin less next time */
+        na_private_context->spin_time =
+            (na_private_context->spin_time / 2.0 > min_spin_time)
+                ? na_private_context->spin_time / 2.0
+                : min_spin_time;
+    }
+
+    *remaining -= elapsed;
+    if (*remaining < 0)
+        *remaining = 0;
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 na_class_t *
 NA_Initialize(const char *info_string, na_bool_t listen)
@@ -246,8 +330,14 @@ NA_Initialize_opt(const char *info_string, na_bool_t listen,
     NA_CHECK_NA_ERROR(error, ret, "Could not parse host string");
 
     na_info->na_init_info = na_init_info;
-    if (na_init_info)
+    if (na_init_info) {
         na_private_class->na_class.progress_mode = na_init_info->progress_mode;
+        na_private_class->na_class.max_spin_time = na_init_info->max_spin_time;
+    }
+    if (na_private_class->na_class.max_spin_time == 0)
+        na_private_class->na_class.max_spin_time = NA_SPIN_TIME_DEFAULT;
+    else if (na_private_class->na_class.max_spin_time < NA_SPIN_TIME_MIN)
+        na_private_class->na_class.max_spin_time = NA_SPIN_TIME_MIN;
 
     /* Print debug info */
     NA_LOG_DEBUG("Class: %s, Protocol: %s, Hostname: %s", na_info->class_name,
@@ -408,12 +498,9 @@ NA_Context_create_id(na_class_t *na_class, na_uint8_t id)
     }
 
     /* Initialize completion queue */
-    na_private_context->completion_queue =
-        hg_atomic_queue_alloc(NA_ATOMIC_QUEUE_SIZE);
+    na_private_context->completion_queue = hg_mpmc_queue_alloc();
     NA_CHECK_ERROR(na_private_context->completion_queue == NULL, error, ret,
         NA_NOMEM, "Could not allocate queue");
-    HG_QUEUE_INIT(&na_private_context->backfill_queue);
-    hg_atomic_init32(&na_private_context->backfill_queue_count, 0);
 
     /* Initialize completion queue mutex/cond */
     hg_thread_mutex_init(&na_private_context->completion_queue_mutex);
@@ -427,6 +514,11 @@ NA_Context_create_id(na_class_t *na_class, na_uint8_t id)
     hg_atomic_init32(&na_private_context->progressing, 0);
 #endif
 
+    /* Start spinning for the max amount of time and adjust from there */
+    na_stat_init(&na_private_context->spin_count, 0);
+    na_stat_init(&na_private_context->block_count, 0);
+    na_private_context->spin_time = (double) na_class->max_spin_time / 1e6;
+
     return (na_context_t *) na_private_context;
 
 error:
@@ -449,17 +541,10 @@ NA_Context_destroy(na_class_t *na_class, na_context_t *context)
         goto done;
 
     /* Check that completion queue is empty now */
-    empty = hg_atomic_queue_is_empty(na_private_context->completion_queue);
-    NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
-        "Completion queue should be empty");
-    hg_atomic_queue_free(na_private_context->completion_queue);
-
-    /* Check that backfill completion queue is empty now */
-    hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
-    empty = HG_QUEUE_IS_EMPTY(&na_private_context->backfill_queue);
-    hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
+    empty = hg_mpmc_queue_is_empty(na_private_context->completion_queue);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
         "Completion queue should be empty");
+    hg_mpmc_queue_free(na_private_context->completion_queue);
 
     /* Destroy completion queue mutex/cond */
     hg_thread_mutex_destroy(&na_private_context->completion_queue_mutex);
@@ -486,6 +571,28 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Context_get_progress_stats(na_context_t *context,
+    na_uint64_t *spin_count, na_uint64_t *block_count)
+{
+    struct na_private_context *na_private_context =
+        (struct na_private_context *) context;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(context == NULL, done, ret, NA_INVALID_ARG, "NULL context");
+
+    if (spin_count)
+        *spin_count =
+            (na_uint64_t) na_stat_get(&na_private_context->spin_count);
+    if (block_count)
+        *block_count =
+            (na_uint64_t) na_stat_get(&na_private_context->block_count);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 na_op_id_t
 NA_Op_create(na_class_t *na_class)
@@ -876,6 +983,57 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+void *
+NA_Mem_alloc(na_class_t *na_class, na_size_t buf_size, void **plugin_data)
+{
+    void *ret = NULL;
+
+    NA_CHECK_ERROR_NORET(na_class == NULL, done, "NULL NA class");
+    NA_CHECK_ERROR_NORET(buf_size == 0, done, "NULL buffer size");
+    NA_CHECK_ERROR_NORET(
+        plugin_data == NULL, done, "NULL pointer to plugin data");
+
+    NA_CHECK_ERROR_NORET(na_class->ops == NULL, done, "NULL NA class ops");
+    if (na_class->ops->mem_alloc)
+        ret = na_class->ops->mem_alloc(na_class, buf_size, plugin_data);
+    else {
+        na_size_t page_size = (na_size_t) hg_mem_get_page_size();
+
+        ret = hg_mem_aligned_alloc(page_size, buf_size);
+        NA_CHECK_ERROR_NORET(
+            ret == NULL, done, "Could not allocate %d bytes", (int) buf_size);
+        *plugin_data = (void *) 1; /* Sanity check on free */
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Mem_free(na_class_t *na_class, void *buf, void *plugin_data)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(
+        na_class == NULL, done, ret, NA_INVALID_ARG, "NULL NA class");
+    NA_CHECK_ERROR(buf == NULL, done, ret, NA_INVALID_ARG, "NULL buffer");
+
+    NA_CHECK_ERROR(
+        na_class->ops == NULL, done, ret, NA_INVALID_ARG, "NULL NA class ops");
+    if (na_class->ops->mem_free)
+        ret = na_class->ops->mem_free(na_class, buf, plugin_data);
+    else {
+        NA_CHECK_ERROR(plugin_data != (void *) 1, done, ret, NA_FAULT,
+            "Invalid plugin data value");
+        hg_mem_aligned_free(buf);
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 na_return_t
 NA_Mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
@@ -1106,8 +1264,7 @@ NA_Poll_try_wait(na_class_t *na_class, na_context_t *context)
         return NA_FALSE;
 
     /* Something is in one of the completion queues */
-    if (!hg_atomic_queue_is_empty(na_private_context->completion_queue) ||
-        hg_atomic_get32(&na_private_context->backfill_queue_count))
+    if (!hg_mpmc_queue_is_empty(na_private_context->completion_queue))
         return NA_FALSE;
 
     /* Check plugin try wait */
@@ -1190,8 +1347,7 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
 #endif
 
     /* Something is in one of the completion queues */
-    if (!hg_atomic_queue_is_empty(na_private_context->completion_queue) ||
-        hg_atomic_get32(&na_private_context->backfill_queue_count)) {
+    if (!hg_mpmc_queue_is_empty(na_private_context->completion_queue)) {
         ret = NA_SUCCESS; /* Progressed */
 #ifdef NA_HAS_MULTI_PROGRESS
         goto unlock;
@@ -1200,6 +1356,19 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
 #endif
     }
 
+    /* Spin for a while before blocking, completions that arrive within that
+     * time then avoid the cost of a wake-up */
+    if ((na_class->progress_mode & NA_ADAPTIVE_SPIN) && remaining > 0) {
+        ret = na_progress_spin(na_private_context, &remaining);
+        if (ret != NA_TIMEOUT)
+#ifdef NA_HAS_MULTI_PROGRESS
+            goto unlock;
+#else
+            goto done;
+#endif
+        na_stat_incr(&na_private_context->block_count);
+    }
+
     /* Try to make progress for remaining time */
     ret = na_class->ops->progress(
         na_class, context, (unsigned int) (remaining * 1000.0));
@@ -1241,62 +1410,45 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
         struct na_cb_completion_data *completion_data = NULL;
 
         completion_data =
-            hg_atomic_queue_pop_mc(na_private_context->completion_queue);
+            hg_mpmc_queue_pop(na_private_context->completion_queue);
         if (!completion_data) {
-            /* Check backfill queue */
-            if (hg_atomic_get32(&na_private_context->backfill_queue_count)) {
-                hg_thread_mutex_lock(
-                    &na_private_context->completion_queue_mutex);
-                completion_data =
-                    HG_QUEUE_FIRST(&na_private_context->backfill_queue);
-                HG_QUEUE_POP_HEAD(&na_private_context->backfill_queue, entry);
-                hg_atomic_decr32(&na_private_context->backfill_queue_count);
-                hg_thread_mutex_unlock(
-                    &na_private_context->completion_queue_mutex);
-                if (!completion_data)
-                    continue; /* Give another chance to grab it */
-            } else {
-                hg_time_t t1, t2;
-
-                /* If something was already processed leave */
-                if (count)
-                    break;
+            hg_time_t t1, t2;
 
-                /* Timeout is 0 so leave */
-                if ((int) (remaining * 1000.0) <= 0) {
+            /* If something was already processed leave */
+            if (count)
+                break;
+
+            /* Timeout is 0 so leave */
+            if ((int) (remaining * 1000.0) <= 0) {
+                ret = NA_TIMEOUT;
+                break;
+            }
+
+            hg_time_get_current_ms(&t1);
+
+            hg_atomic_incr32(&na_private_context->trigger_waiting);
+            hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
+            /* Otherwise wait timeout ms */
+            while (
+                hg_mpmc_queue_is_empty(na_private_context->completion_queue)) {
+                if (hg_thread_cond_timedwait(
+                        &na_private_context->completion_queue_cond,
+                        &na_private_context->completion_queue_mutex,
+                        timeout) != HG_UTIL_SUCCESS) {
+                    /* Timeout occurred so leave */
                     ret = NA_TIMEOUT;
                     break;
                 }
-
-                hg_time_get_current_ms(&t1);
-
-                hg_atomic_incr32(&na_private_context->trigger_waiting);
-                hg_thread_mutex_lock(
-                    &na_private_context->completion_queue_mutex);
-                /* Otherwise wait timeout ms */
-                while (hg_atomic_queue_is_empty(
-                           na_private_context->completion_queue) &&
-                       !hg_atomic_get32(
-                           &na_private_context->backfill_queue_count)) {
-                    if (hg_thread_cond_timedwait(
-                            &na_private_context->completion_queue_cond,
-                            &na_private_context->completion_queue_mutex,
-                            timeout) != HG_UTIL_SUCCESS) {
-                        /* Timeout occurred so leave */
-                        ret = NA_TIMEOUT;
-                        break;
-                    }
-                }
-                hg_thread_mutex_unlock(
-                    &na_private_context->completion_queue_mutex);
-                hg_atomic_decr32(&na_private_context->trigger_waiting);
-                if (ret == NA_TIMEOUT)
-                    break;
-
-                hg_time_get_current_ms(&t2);
-                remaining -= hg_time_diff(t2, t1);
-                continue; /* Give another chance to grab it */
             }
+            hg_thread_mutex_unlock(
+                &na_private_context->completion_queue_mutex);
+            hg_atomic_decr32(&na_private_context->trigger_waiting);
+            if (ret == NA_TIMEOUT)
+                break;
+
+            hg_time_get_current_ms(&t2);
+            remaining -= hg_time_diff(t2, t1);
+            continue; /* Give another chance to grab it */
         }
 
         /* Completion data should be valid */
@@ -1304,6 +1456,9 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
             "NULL completion data");
 
         /* Execute callback */
+        HG_TRACE(HG_TRACE_NA_COMPLETE,
+            (size_t) completion_data->callback_info.arg,
+            completion_data->callback_info.type);
         if (completion_data->callback) {
             int cb_ret =
                 completion_data->callback(&completion_data->callback_info);
@@ -1369,16 +1524,12 @@ na_cb_completion_add(
     struct na_private_context *na_private_context =
         (struct na_private_context *) context;
     na_return_t ret = NA_SUCCESS;
+    int rc;
 
-    if (hg_atomic_queue_push(na_private_context->completion_queue,
-            na_cb_completion_data) != HG_UTIL_SUCCESS) {
-        /* Queue is full */
-        hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
-        HG_QUEUE_PUSH_TAIL(
-            &na_private_context->backfill_queue, na_cb_completion_data, entry);
-        hg_atomic_incr32(&na_private_context->backfill_queue_count);
-        hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
-    }
+    rc = hg_mpmc_queue_push(
+        na_private_context->completion_queue, na_cb_completion_data);
+    NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, NA_NOMEM,
+        "Could not push completion data to completion queue");
 
     if (hg_atomic_get32(&na_private_context->trigger_waiting)) {
         hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
@@ -1388,5 +1539,6 @@ na_cb_completion_add(
         hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
     }
 
+done:
     return ret;
 }
@@ -13,6 +13,8 @@
 
 #include "na_types.h"
 
+#include "mercury_trace.h"
+
 /*************************************/
 /* Public Type and Struct Definition */
 /*************************************/
@@ -145,6 +147,23 @@ NA_Context_create_id(na_class_t *na_class, na_uint8_t id) NA_WARN_UNUSED_RESULT;
 NA_PUBLIC na_return_t
 NA_Context_destroy(na_class_t *na_class, na_context_t *context);
 
+/**
+ * Retrieve progress statistics of a context. When the class was initialized
+ * with NA_ADAPTIVE_SPIN, NA_Progress() first spins for a self-tuned amount of
+ * time before blocking. The spin count is the number of calls that made
+ * progress while spinning, the block count the number of calls that had to
+ * fall back to blocking progress.
+ *
+ * \param context [IN]          pointer to context of execution
+ * \param spin_count [OUT]      pointer to number of calls completed spinning
+ * \param block_count [OUT]     pointer to number of calls that blocked
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_PUBLIC na_return_t
+NA_Context_get_progress_stats(na_context_t *context,
+    na_uint64_t *spin_count, na_uint64_t *block_count);
+
 /**
  * Allocate an operation ID for the higher level layer to save and
  * pass back to the NA layer rather than have the NA layer allocate operation
@@ -571,6 +590,39 @@ NA_Msg_recv_expected(na_class_t *na_class, na_context_t *context,
     void *plugin_data, na_addr_t source_addr, na_uint8_t source_id,
     na_tag_t tag, na_op_id_t *op_id);
 
+/**
+ * Allocate buf_size bytes of memory suitable for RMA operations and return a
+ * pointer to the allocated memory. Plugins may return memory that remote
+ * peers can map directly (e.g., shared-memory segments), in which case RMA
+ * operations targeting memory handles created on that buffer can avoid
+ * per-operation registration or system calls. If the plugin does not provide
+ * a specific allocator, page-aligned memory is returned. If size is 0,
+ * NA_Mem_alloc() returns NULL.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param buf_size [IN]         buffer size
+ * \param plugin_data [OUT]     pointer to internal plugin data
+ *
+ * \return Pointer to allocated memory or NULL in case of failure
+ */
+NA_PUBLIC void *
+NA_Mem_alloc(na_class_t *na_class, na_size_t buf_size,
+    void **plugin_data) NA_WARN_UNUSED_RESULT;
+
+/**
+ * The NA_Mem_free() function releases the memory space pointed to by buf,
+ * which must have been returned by a previous call to NA_Mem_alloc().
+ * Memory handles created on that buffer must be freed first.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param buf [IN]              pointer to buffer
+ * \param plugin_data [IN]      pointer to internal plugin data
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_PUBLIC na_return_t
+NA_Mem_free(na_class_t *na_class, void *buf, void *plugin_data);
+
 /**
  * Create memory handle for RMA operations.
  * For non-contiguous memory, use NA_Mem_handle_create_segments() instead.
@@ -886,6 +938,7 @@ struct na_class {
     void *plugin_class;             /* Plugin private class */
     char *protocol_name;            /* Name of protocol */
     na_uint32_t progress_mode;      /* NA progress mode */
+    na_uint32_t max_spin_time;      /* Max spin time (us) */
     na_bool_t listen;               /* Listen for connections */
 };
 
@@ -952,6 +1005,10 @@ struct na_class_ops {
         na_context_t *context, na_cb_t callback, void *arg, void *buf,
         na_size_t buf_size, void *plugin_data, na_addr_t source_addr,
         na_uint8_t source_id, na_tag_t tag, na_op_id_t *op_id);
+    void *(*mem_alloc)(
+        na_class_t *na_class, na_size_t buf_size, void **plugin_data);
+    na_return_t (*mem_free)(
+        na_class_t *na_class, void *buf, void *plugin_data);
     na_return_t (*mem_handle_create)(na_class_t *na_class, void *buf,
         na_size_t buf_size, unsigned long flags, na_mem_handle_t *mem_handle);
     na_return_t (*mem_handle_create_segments)(na_class_t *na_class,
@@ -1072,6 +1129,7 @@ NA_Msg_send_unexpected(na_class_t *na_class, na_context_t *context,
     void *plugin_data, na_addr_t dest_addr, na_uint8_t dest_id, na_tag_t tag,
     na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_SEND, (size_t) arg, buf_size);
     return na_class->ops->msg_send_unexpected(na_class, context, callback, arg,
         buf, buf_size, plugin_data, dest_addr, dest_id, tag, op_id);
 }
@@ -1082,6 +1140,7 @@ NA_Msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
     na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
     void *plugin_data, na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_RECV, (size_t) arg, buf_size);
     return na_class->ops->msg_recv_unexpected(
         na_class, context, callback, arg, buf, buf_size, plugin_data, op_id);
 }
@@ -1093,6 +1152,7 @@ NA_Msg_send_expected(na_class_t *na_class, na_context_t *context,
     void *plugin_data, na_addr_t dest_addr, na_uint8_t dest_id, na_tag_t tag,
     na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_SEND, (size_t) arg, buf_size);
     return na_class->ops->msg_send_expected(na_class, context, callback, arg,
         buf, buf_size, plugin_data, dest_addr, dest_id, tag, op_id);
 }
@@ -1104,6 +1164,7 @@ NA_Msg_recv_expected(na_class_t *na_class, na_context_t *context,
     void *plugin_data, na_addr_t source_addr, na_uint8_t source_id,
     na_tag_t tag, na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_RECV, (size_t) arg, buf_size);
     return na_class->ops->msg_recv_expected(na_class, context, callback, arg,
         buf, buf_size, plugin_data, source_addr, source_id, tag, op_id);
 }
@@ -1124,6 +1185,7 @@ NA_Put(na_class_t *na_class, na_context_t *context, na_cb_t callback, void *arg,
     na_size_t data_size, na_addr_t remote_addr, na_uint8_t remote_id,
     na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_PUT, (size_t) arg, data_size);
     return na_class->ops->put(na_class, context, callback, arg,
         local_mem_handle, local_offset, remote_mem_handle, remote_offset,
         data_size, remote_addr, remote_id, op_id);
@@ -1137,6 +1199,7 @@ NA_Get(na_class_t *na_class, na_context_t *context, na_cb_t callback, void *arg,
     na_size_t data_size, na_addr_t remote_addr, na_uint8_t remote_id,
     na_op_id_t *op_id)
 {
+    HG_TRACE(HG_TRACE_NA_GET, (size_t) arg, data_size);
     return na_class->ops->get(na_class, context, callback, arg,
         local_mem_handle, local_offset, remote_mem_handle, remote_offset,
         data_size, remote_addr, remote_id, op_id);
@@ -934,6 +934,8 @@ const struct na_class_ops NA_PLUGIN_OPS(ofi) = {
     NULL,                                  /* msg_init_expected */
     na_ofi_msg_send_expected,              /* msg_send_expected */
     na_ofi_msg_recv_expected,              /* msg_recv_expected */
+    NULL,                                  /* mem_alloc */
+    NULL,                                  /* mem_free */
     na_ofi_mem_handle_create,              /* mem_handle_create */
     NULL,                                  /* mem_handle_create_segment */
     na_ofi_mem_handle_free,                /* mem_handle_free */
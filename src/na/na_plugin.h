@@ -33,7 +33,6 @@ struct na_cb_completion_data {
     na_plugin_cb_t plugin_callback;  /* Callback which will be called after
                                       * the user callback returns. */
     void *plugin_callback_args;      /* Argument to plugin_callback */
-    HG_QUEUE_ENTRY(na_cb_completion_data) entry; /* Completion queue entry */
 };
 
 /*****************/
@@ -117,6 +116,9 @@ extern NA_PRIVATE const struct na_class_ops NA_PLUGIN_OPS(cci);
 #ifdef NA_HAS_OFI
 extern NA_PRIVATE const struct na_class_ops NA_PLUGIN_OPS(ofi);
 #endif
+#ifdef NA_HAS_TCP
+extern NA_PRIVATE const struct na_class_ops NA_PLUGIN_OPS(tcp);
+#endif
 
 #ifdef __cplusplus
 }
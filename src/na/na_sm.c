@@ -20,6 +20,7 @@
 #include "mercury_mem.h"
 #include "mercury_poll.h"
 #include "mercury_queue.h"
+#include "mercury_thread.h"
 #include "mercury_thread_rwlock.h"
 #include "mercury_thread_spin.h"
 #include "mercury_time.h"
@@ -71,20 +72,39 @@
 /* Max filename length used for shared files */
 #define NA_SM_MAX_FILENAME 64
 
-/* Max number of shared-memory buffers (reserved by 64-bit atomic integer) */
-#define NA_SM_NUM_BUFS 64
+/* Number of shared-memory buffers per queue pair (reserved by 64-bit atomic
+ * integer, must be a power of 2) */
+#ifdef NA_SM_COPY_BUF_COUNT
+#    define NA_SM_NUM_BUFS NA_SM_COPY_BUF_COUNT
+#else
+#    define NA_SM_NUM_BUFS 32
+#endif
 
 /* Size of shared-memory buffer */
 #define NA_SM_COPY_BUF_SIZE NA_SM_PAGE_SIZE
 
+/* Size of msg queues (one entry of the ring is always left empty, make sure
+ * that there is room for one msg per buffer) */
+#define NA_SM_MSG_QUEUE_SIZE (NA_SM_NUM_BUFS * 2)
+
+/* Max number of contiguous shared-memory buffers used by a single msg */
+#if NA_SM_NUM_BUFS < 16
+#    define NA_SM_MAX_MSG_BUFS NA_SM_NUM_BUFS
+#else
+#    define NA_SM_MAX_MSG_BUFS 16
+#endif
+
 /* Max number of fds used for cleanup */
 #define NA_SM_CLEANUP_NFDS 16
 
+/* Max time (ms) spent retrying to send events to a busy peer socket */
+#define NA_SM_EVENT_SEND_TIMEOUT 1000
+
 /* Max number of peers */
 #define NA_SM_MAX_PEERS (NA_CONTEXT_ID_MAX + 1)
 
 /* Msg sizes */
-#define NA_SM_UNEXPECTED_SIZE NA_SM_COPY_BUF_SIZE
+#define NA_SM_UNEXPECTED_SIZE (NA_SM_MAX_MSG_BUFS * NA_SM_COPY_BUF_SIZE)
 #define NA_SM_EXPECTED_SIZE   NA_SM_UNEXPECTED_SIZE
 
 /* Max tag */
@@ -93,6 +113,9 @@
 /* Max events */
 #define NA_SM_MAX_EVENTS 16
 
+/* Max number of peers without available buffers skipped by retries */
+#define NA_SM_MAX_RETRY_SKIP 16
+
 /* Op ID status bits */
 #define NA_SM_OP_COMPLETED (1 << 0)
 #define NA_SM_OP_CANCELED  (1 << 1)
@@ -108,6 +131,12 @@
     snprintf(                                                                  \
         filename, maxlen, "%s_%s-%d-%u", NA_SM_SHM_PREFIX, username, pid, id)
 
+/* Generate SHM file name of memory allocated with NA_Mem_alloc() */
+#define NA_SM_GEN_MEM_SHM_NAME(                                                \
+    filename, maxlen, username, pid, id, region_id)                            \
+    snprintf(filename, maxlen, "%s_%s-%d-%u-mem%u", NA_SM_SHM_PREFIX,          \
+        username, pid, id, region_id)
+
 /* Generate socket path */
 #define NA_SM_GEN_SOCK_PATH(pathname, maxlen, username, pid, id)               \
     snprintf(pathname, maxlen, "%s/%s_%s/%d/%u", NA_SM_TMP_DIRECTORY,          \
@@ -129,9 +158,9 @@
 typedef union {
     struct {
         unsigned int tag : 32;      /* Message tag : UINT MAX */
-        unsigned int buf_size : 16; /* Buffer length: 4KB MAX */
-        unsigned int buf_idx : 8;   /* Index reserved: 64 MAX */
-        unsigned int type : 8;      /* Message type */
+        unsigned int buf_size : 20; /* Buffer length: 1MB MAX */
+        unsigned int buf_idx : 8;   /* First index reserved: 64 MAX */
+        unsigned int type : 4;      /* Message type */
     } hdr;
     na_uint64_t val;
 } na_sm_msg_hdr_t;
@@ -147,11 +176,9 @@ typedef union {
     char pad[NA_SM_CACHE_LINE_SIZE];
 } na_sm_cacheline_atomic_int256_t;
 
-/* Msg buffers (page aligned) */
+/* Msg buffers of a queue pair (page aligned) */
 struct na_sm_copy_buf {
-    hg_thread_spin_t buf_locks[NA_SM_NUM_BUFS];    /* Locks on buffers */
     char buf[NA_SM_NUM_BUFS][NA_SM_COPY_BUF_SIZE]; /* Array of buffers */
-    na_sm_cacheline_atomic_int64_t available;      /* Available bitmask */
 };
 
 /* Msg queue (allocate queue's flexible array member statically) */
@@ -166,14 +193,19 @@ struct na_sm_msg_queue {
     hg_atomic_int32_t cons_tail;
     unsigned int cons_size;
     unsigned int cons_mask;
-    hg_atomic_int64_t ring[NA_SM_NUM_BUFS]
+    hg_atomic_int64_t ring[NA_SM_MSG_QUEUE_SIZE]
         __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
 };
 
 /* Shared queue pair */
 struct na_sm_queue_pair {
-    struct na_sm_msg_queue tx_queue; /* Send queue */
-    struct na_sm_msg_queue rx_queue; /* Recv queue */
+    struct na_sm_msg_queue tx_queue;          /* Send queue */
+    struct na_sm_msg_queue rx_queue;          /* Recv queue */
+    na_sm_cacheline_atomic_int64_t available; /* Available copy buffers */
+    na_sm_cacheline_atomic_int64_t tx_wait;   /* Tx side waits for buffers */
+    na_sm_cacheline_atomic_int64_t rx_wait;   /* Rx side waits for buffers */
+    na_sm_cacheline_atomic_int64_t tx_spin;   /* Tx side spins on its queue */
+    na_sm_cacheline_atomic_int64_t rx_spin;   /* Rx side spins on its queue */
 };
 
 /* Cmd values */
@@ -210,7 +242,7 @@ struct na_sm_cmd_queue {
 
 /* Shared region */
 struct na_sm_region {
-    struct na_sm_copy_buf copy_bufs; /* Pool of msg buffers */
+    struct na_sm_copy_buf copy_bufs[NA_SM_MAX_PEERS]; /* Msg buffers */
     struct na_sm_queue_pair queue_pairs[NA_SM_MAX_PEERS]
         __attribute__((aligned(NA_SM_PAGE_SIZE))); /* Msg queue pairs */
     struct na_sm_cmd_queue cmd_queue;              /* Cmd queue */
@@ -230,6 +262,12 @@ struct na_sm_addr {
     struct na_sm_region *shared_region; /* Shared-memory region */
     struct na_sm_msg_queue *tx_queue;   /* Pointer to shared tx queue */
     struct na_sm_msg_queue *rx_queue;   /* Pointer to shared rx queue */
+    struct na_sm_copy_buf *copy_buf;    /* Pointer to shared msg buffers */
+    hg_atomic_int64_t *copy_buf_avail;  /* Pointer to available buffers */
+    hg_atomic_int64_t *tx_wait;         /* Set when waiting for buffers */
+    hg_atomic_int64_t *rx_wait;         /* Set when peer waits for buffers */
+    hg_atomic_int64_t *spinning;        /* Set when spinning on rx queue */
+    hg_atomic_int64_t *peer_spinning;   /* Set when peer spins on its queue */
     int tx_notify;                      /* Notify fd for tx queue */
     int rx_notify;                      /* Notify fd for rx queue */
     na_sm_poll_type_t tx_poll_type;     /* Tx poll type */
@@ -261,12 +299,32 @@ struct na_sm_lookup_args {
     na_uint8_t id;
 };
 
+/* Memory region allocated with NA_Mem_alloc(), either owned by this class
+ * or mapped from a peer so that RMA operations can use memcpy */
+struct na_sm_mem_region {
+    HG_LIST_ENTRY(na_sm_mem_region) entry; /* Entry in region list */
+    char *base;                            /* Local address of region */
+    char *owner_base;                      /* Address of region in owner */
+    size_t size;                           /* Size of region */
+    pid_t pid;                             /* PID of owner */
+    na_uint32_t region_id;                 /* Region ID */
+    na_uint8_t id;                         /* SM ID of owner */
+    na_bool_t owned;                       /* Allocated by this class */
+};
+
+/* Memory region list */
+struct na_sm_mem_region_list {
+    HG_LIST_HEAD(na_sm_mem_region) list;
+    hg_thread_rwlock_t lock;
+};
+
 /* Memory handle */
 struct na_sm_mem_handle {
-    struct iovec *iov;    /* I/O segments */
-    unsigned long iovcnt; /* Segment count */
-    size_t len;           /* Size of region */
-    na_uint8_t flags;     /* Flag of operation access */
+    struct iovec *iov;               /* I/O segments */
+    unsigned long iovcnt;            /* Segment count */
+    size_t len;                      /* Size of region */
+    struct na_sm_mem_region *region; /* Shared region (may be NULL) */
+    na_uint8_t flags;                /* Flag of operation access */
 };
 
 /* Msg info */
@@ -338,10 +396,12 @@ struct na_sm_context {
 
 /* Private data */
 struct na_sm_class {
-    struct na_sm_endpoint endpoint; /* Endpoint */
-    char *username;                 /* Username */
-    na_uint8_t max_contexts;        /* Max number of contexts */
-    na_bool_t no_wait;              /* Ignore wait object */
+    struct na_sm_endpoint endpoint;          /* Endpoint */
+    struct na_sm_mem_region_list mem_regions; /* Shared memory regions */
+    hg_atomic_int32_t mem_region_id;         /* Last region ID */
+    char *username;                          /* Username */
+    na_uint8_t max_contexts;                 /* Max number of contexts */
+    na_bool_t no_wait;                       /* Ignore wait object */
 };
 
 /********************/
@@ -626,16 +686,39 @@ na_sm_addr_event_recv(int sock, na_sm_cmd_hdr_t *cmd_hdr, int *tx_notify,
     int *rx_notify, na_bool_t *received);
 
 /**
- * Reserve shared buffer.
+ * Reserve contiguous shared buffers large enough to hold n bytes.
  */
 static NA_INLINE na_return_t
-na_sm_buf_reserve(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int *index);
+na_sm_buf_reserve(hg_atomic_int64_t *available, size_t n, unsigned int *index);
 
 /**
- * Release shared buffer.
+ * Release shared buffers reserved for n bytes.
  */
 static NA_INLINE void
-na_sm_buf_release(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index);
+na_sm_buf_release(hg_atomic_int64_t *available, unsigned int index, size_t n);
+
+/**
+ * Reserve buffers to send n bytes to addr. If none are available, ask the
+ * peer to notify us when it releases buffers.
+ */
+static NA_INLINE na_return_t
+na_sm_addr_buf_reserve(
+    struct na_sm_addr *na_sm_addr, size_t n, unsigned int *index);
+
+/**
+ * Release buffers shared with addr and notify the peer if it is waiting for
+ * buffers.
+ */
+static NA_INLINE na_return_t
+na_sm_addr_buf_release(
+    struct na_sm_addr *na_sm_addr, unsigned int index, size_t n);
+
+/**
+ * Notify the peer that a message was posted, unless it is currently spinning
+ * on its rx queue.
+ */
+static NA_INLINE na_return_t
+na_sm_addr_notify(struct na_sm_addr *na_sm_addr);
 
 /**
  * Copy src to shared buffer.
@@ -658,6 +741,36 @@ static void
 na_sm_offset_translate(struct na_sm_mem_handle *mem_handle, na_offset_t offset,
     na_size_t length, struct iovec *iov, unsigned long *iovcnt);
 
+/**
+ * Find owned memory region that contains all segments.
+ */
+static struct na_sm_mem_region *
+na_sm_mem_region_find(struct na_sm_mem_region_list *na_sm_mem_region_list,
+    const struct iovec *iov, unsigned long iovcnt);
+
+/**
+ * Get memory region allocated by peer, mapping it if not already mapped.
+ */
+static na_return_t
+na_sm_mem_region_get(struct na_sm_class *na_sm_class, pid_t pid, na_uint8_t id,
+    na_uint32_t region_id, char *owner_base, size_t size,
+    struct na_sm_mem_region **region_ptr);
+
+/**
+ * Unmap all memory regions.
+ */
+static void
+na_sm_mem_regions_close(struct na_sm_class *na_sm_class);
+
+/**
+ * Copy between local segments and segments of a mapped memory region.
+ */
+static na_size_t
+na_sm_mem_region_copy(const struct na_sm_mem_region *region,
+    const struct iovec *local_iov, unsigned long liovcnt,
+    const struct iovec *remote_iov, unsigned long riovcnt, na_size_t length,
+    na_bool_t put);
+
 /**
  * Progress on endpoint sock.
  */
@@ -684,6 +797,13 @@ na_sm_progress_tx_notify(struct na_sm_addr *poll_addr, na_bool_t *progressed);
 static na_return_t
 na_sm_progress_rx_notify(struct na_sm_addr *poll_addr, na_bool_t *progressed);
 
+/**
+ * Stop advertising that rx queues are being spun on and check that they are
+ * all empty, in which case it is safe to block.
+ */
+static na_bool_t
+na_sm_progress_try_wait(struct na_sm_addr_list *poll_addr_list);
+
 /**
  * Progress rx queue.
  */
@@ -710,7 +830,8 @@ na_sm_process_expected(struct na_sm_op_queue *expected_op_queue,
  * Process retries.
  */
 static na_return_t
-na_sm_process_retries(struct na_sm_op_queue *retry_op_queue);
+na_sm_process_retries(
+    struct na_sm_op_queue *retry_op_queue, na_bool_t *progressed);
 
 /**
  * Complete operation.
@@ -839,6 +960,14 @@ na_sm_msg_recv_expected(na_class_t *na_class, na_context_t *context,
     void *plugin_data, na_addr_t source_addr, na_uint8_t source_id,
     na_tag_t tag, na_op_id_t *op_id);
 
+/* mem_alloc */
+static void *
+na_sm_mem_alloc(na_class_t *na_class, na_size_t buf_size, void **plugin_data);
+
+/* mem_free */
+static na_return_t
+na_sm_mem_free(na_class_t *na_class, void *buf, void *plugin_data);
+
 /* mem_handle_create */
 static na_return_t
 na_sm_mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
@@ -942,6 +1071,8 @@ const struct na_class_ops NA_PLUGIN_OPS(sm) = {
     NULL,                              /* msg_init_expected */
     na_sm_msg_send_expected,           /* msg_send_expected */
     na_sm_msg_recv_expected,           /* msg_recv_expected */
+    na_sm_mem_alloc,                   /* mem_alloc */
+    na_sm_mem_free,                    /* mem_free */
     na_sm_mem_handle_create,           /* mem_handle_create */
 #ifdef NA_SM_HAS_CMA
     na_sm_mem_handle_create_segments, /* mem_handle_create_segments */
@@ -1244,7 +1375,7 @@ na_sm_msg_queue_init(struct na_sm_msg_queue *na_sm_queue)
 {
     struct hg_atomic_queue *hg_atomic_queue =
         (struct hg_atomic_queue *) na_sm_queue;
-    unsigned int count = NA_SM_NUM_BUFS;
+    unsigned int count = NA_SM_MSG_QUEUE_SIZE;
 
     hg_atomic_queue->prod_size = hg_atomic_queue->cons_size = count;
     hg_atomic_queue->prod_mask = hg_atomic_queue->cons_mask = count - 1;
@@ -1407,15 +1538,8 @@ na_sm_region_open(const char *username, pid_t pid, na_uint8_t id,
     if (create) {
         int i;
 
-        /* Initialize copy buf (all buffers are available by default) */
-        hg_atomic_init64(
-            &na_sm_region->copy_bufs.available.val, ~((hg_util_int64_t) 0));
-        memset(&na_sm_region->copy_bufs.buf, 0,
-            sizeof(na_sm_region->copy_bufs.buf));
-
-        /* Initialize locks */
-        for (i = 0; i < NA_SM_NUM_BUFS; i++)
-            hg_thread_spin_init(&na_sm_region->copy_bufs.buf_locks[i]);
+        /* Copy bufs are left untouched (zeroed by the system) so that only
+         * pages of buffers that are used get allocated */
 
         /* Initialize queue pairs */
         for (i = 0; i < 4; i++)
@@ -1425,6 +1549,15 @@ na_sm_region_open(const char *username, pid_t pid, na_uint8_t id,
         for (i = 0; i < NA_SM_MAX_PEERS; i++) {
             na_sm_msg_queue_init(&na_sm_region->queue_pairs[i].rx_queue);
             na_sm_msg_queue_init(&na_sm_region->queue_pairs[i].tx_queue);
+            /* All buffers are available by default */
+            hg_atomic_init64(&na_sm_region->queue_pairs[i].available.val,
+                (hg_util_int64_t) ((NA_SM_NUM_BUFS < 64)
+                                       ? ((1ULL << NA_SM_NUM_BUFS) - 1)
+                                       : ~0ULL));
+            hg_atomic_init64(&na_sm_region->queue_pairs[i].tx_wait.val, 0);
+            hg_atomic_init64(&na_sm_region->queue_pairs[i].rx_wait.val, 0);
+            hg_atomic_init64(&na_sm_region->queue_pairs[i].tx_spin.val, 0);
+            hg_atomic_init64(&na_sm_region->queue_pairs[i].rx_spin.val, 0);
         }
 
         /* Initialize command queue */
@@ -2358,6 +2491,13 @@ na_sm_addr_create(struct na_sm_endpoint *na_sm_endpoint,
     na_sm_addr->queue_pair_idx = queue_pair_idx;
     na_sm_addr->shared_region = shared_region;
 
+    /* Msg buffers are shared by both directions of a queue pair */
+    if (shared_region) {
+        na_sm_addr->copy_buf = &shared_region->copy_bufs[queue_pair_idx];
+        na_sm_addr->copy_buf_avail =
+            &shared_region->queue_pairs[queue_pair_idx].available.val;
+    }
+
     if (!unexpected) {
         /* Simply assign queues (source address may not have shared region) */
         na_sm_addr->tx_queue =
@@ -2366,6 +2506,22 @@ na_sm_addr_create(struct na_sm_endpoint *na_sm_endpoint,
         na_sm_addr->rx_queue =
             shared_region ? &shared_region->queue_pairs[queue_pair_idx].rx_queue
                           : NULL;
+        na_sm_addr->tx_wait =
+            shared_region
+                ? &shared_region->queue_pairs[queue_pair_idx].tx_wait.val
+                : NULL;
+        na_sm_addr->rx_wait =
+            shared_region
+                ? &shared_region->queue_pairs[queue_pair_idx].rx_wait.val
+                : NULL;
+        na_sm_addr->spinning =
+            shared_region
+                ? &shared_region->queue_pairs[queue_pair_idx].tx_spin.val
+                : NULL;
+        na_sm_addr->peer_spinning =
+            shared_region
+                ? &shared_region->queue_pairs[queue_pair_idx].rx_spin.val
+                : NULL;
 
         /* Simply assign notify descriptors */
         na_sm_addr->tx_notify = tx_notify;
@@ -2376,12 +2532,24 @@ na_sm_addr_create(struct na_sm_endpoint *na_sm_endpoint,
             &shared_region->queue_pairs[queue_pair_idx].rx_queue;
         na_sm_addr->rx_queue =
             &shared_region->queue_pairs[queue_pair_idx].tx_queue;
+        na_sm_addr->tx_wait =
+            &shared_region->queue_pairs[queue_pair_idx].rx_wait.val;
+        na_sm_addr->rx_wait =
+            &shared_region->queue_pairs[queue_pair_idx].tx_wait.val;
+        na_sm_addr->spinning =
+            &shared_region->queue_pairs[queue_pair_idx].rx_spin.val;
+        na_sm_addr->peer_spinning =
+            &shared_region->queue_pairs[queue_pair_idx].tx_spin.val;
 
         /* Invert descriptors so that local rx is remote tx */
         na_sm_addr->tx_notify = rx_notify;
         na_sm_addr->rx_notify = tx_notify;
     }
 
+    /* Queue pairs are re-used, clear state left by a previous owner */
+    if (na_sm_addr->spinning)
+        hg_atomic_set64(na_sm_addr->spinning, 0);
+
     if (na_sm_endpoint->poll_set && (na_sm_addr->rx_notify > 0)) {
         na_sm_addr->rx_poll_type = NA_SM_POLL_RX_NOTIFY;
         NA_LOG_DEBUG(
@@ -2530,7 +2698,19 @@ na_sm_addr_event_send(int sock, const char *username, pid_t pid, na_uint8_t id,
         msg.msg_controllen = 0;
     }
 
+    /* Socket queue of peer fills up when many peers connect at once */
     nsend = sendmsg(sock, &msg, 0);
+    if (nsend == -1 && errno == EAGAIN) {
+        hg_time_t t1, t2;
+
+        hg_time_get_current_ms(&t1);
+        do {
+            hg_thread_yield();
+            nsend = sendmsg(sock, &msg, 0);
+            hg_time_get_current_ms(&t2);
+        } while (nsend == -1 && errno == EAGAIN &&
+                 hg_time_diff(t2, t1) * 1000.0 < NA_SM_EVENT_SEND_TIMEOUT);
+    }
     if (!ignore_error) {
         NA_CHECK_ERROR(nsend == -1, done, ret, na_sm_errno_to_na(errno),
             "sendmsg() failed (%s)", strerror(errno));
@@ -2605,19 +2785,22 @@ done:
 
 /*---------------------------------------------------------------------------*/
 static NA_INLINE na_return_t
-na_sm_buf_reserve(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int *index)
+na_sm_buf_reserve(hg_atomic_int64_t *available, size_t n, unsigned int *index)
 {
-    hg_util_int64_t bits = 1LL;
+    unsigned int count = (n > NA_SM_COPY_BUF_SIZE)
+                             ? (unsigned int) ((n + NA_SM_COPY_BUF_SIZE - 1) /
+                                               NA_SM_COPY_BUF_SIZE)
+                             : 1;
+    hg_util_int64_t bits = (hg_util_int64_t) ((1ULL << count) - 1);
     unsigned int i = 0;
 
     do {
-        hg_util_int64_t available =
-            hg_atomic_get64(&na_sm_copy_buf->available.val);
-        if (!available) {
+        hg_util_int64_t avail = hg_atomic_get64(available);
+        if (!avail) {
             /* Nothing available */
             break;
         }
-        if ((available & bits) != bits) {
+        if ((avail & bits) != bits) {
             /* Already reserved */
             hg_atomic_fence();
             i++;
@@ -2625,30 +2808,83 @@ na_sm_buf_reserve(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int *index)
             continue;
         }
 
-        if (hg_atomic_cas64(
-                &na_sm_copy_buf->available.val, available, available & ~bits)) {
+        if (hg_atomic_cas64(available, avail, avail & ~bits)) {
 #ifdef NA_HAS_DEBUG
             char buf[65] = {'\0'};
-            available = hg_atomic_get64(&na_sm_copy_buf->available.val);
-            NA_LOG_DEBUG("Reserved bit index %u\n### Available: %s", i,
-                lltoa((hg_util_uint64_t) available, buf, 2));
+            avail = hg_atomic_get64(available);
+            NA_LOG_DEBUG("Reserved bit index %u (%u)\n### Available: %s", i,
+                count, lltoa((hg_util_uint64_t) avail, buf, 2));
 #endif
             *index = i;
             return NA_SUCCESS;
         }
         /* Can't use atomic XOR directly, if there is a race and the cas
          * fails, we should be able to pick the next one available */
-    } while (i < NA_SM_NUM_BUFS);
+    } while (i + count <= NA_SM_NUM_BUFS);
 
     return NA_AGAIN;
 }
 
 /*---------------------------------------------------------------------------*/
 static NA_INLINE void
-na_sm_buf_release(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index)
+na_sm_buf_release(hg_atomic_int64_t *available, unsigned int index, size_t n)
 {
-    hg_atomic_or64(&na_sm_copy_buf->available.val, 1LL << index);
-    NA_LOG_DEBUG("Released bit index %u", index);
+    unsigned int count = (n > NA_SM_COPY_BUF_SIZE)
+                             ? (unsigned int) ((n + NA_SM_COPY_BUF_SIZE - 1) /
+                                               NA_SM_COPY_BUF_SIZE)
+                             : 1;
+
+    hg_atomic_or64(
+        available, (hg_util_int64_t) (((1ULL << count) - 1) << index));
+    NA_LOG_DEBUG("Released bit index %u (%u)", index, count);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_return_t
+na_sm_addr_buf_reserve(
+    struct na_sm_addr *na_sm_addr, size_t n, unsigned int *index)
+{
+    if (na_sm_buf_reserve(na_sm_addr->copy_buf_avail, n, index) == NA_SUCCESS)
+        return NA_SUCCESS;
+
+    /* Peer may have released buffers before seeing the flag, try again */
+    hg_atomic_set64(na_sm_addr->tx_wait, 1);
+    hg_atomic_fence();
+
+    return na_sm_buf_reserve(na_sm_addr->copy_buf_avail, n, index);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_return_t
+na_sm_addr_buf_release(
+    struct na_sm_addr *na_sm_addr, unsigned int index, size_t n)
+{
+    na_sm_buf_release(na_sm_addr->copy_buf_avail, index, n);
+
+    /* Wake up peer so that it retries its sends */
+    if (hg_atomic_get64(na_sm_addr->rx_wait) &&
+        hg_atomic_cas64(na_sm_addr->rx_wait, 1, 0) &&
+        na_sm_addr->tx_notify > 0)
+        return na_sm_event_set(na_sm_addr->tx_notify);
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_return_t
+na_sm_addr_notify(struct na_sm_addr *na_sm_addr)
+{
+    /* Notifications are not enabled */
+    if (na_sm_addr->tx_notify <= 0)
+        return NA_SUCCESS;
+
+    /* Make the posted message visible before reading the peer's flag, pairs
+     * with the fence in na_sm_progress_try_wait() */
+    hg_atomic_fence();
+    if (hg_atomic_get64(na_sm_addr->peer_spinning))
+        return NA_SUCCESS;
+
+    return na_sm_event_set(na_sm_addr->tx_notify);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2656,9 +2892,9 @@ static NA_INLINE void
 na_sm_buf_copy_to(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index,
     const void *src, size_t n)
 {
-    hg_thread_spin_lock(&na_sm_copy_buf->buf_locks[index]);
-    memcpy(na_sm_copy_buf->buf[index], src, n);
-    hg_thread_spin_unlock(&na_sm_copy_buf->buf_locks[index]);
+    /* Buffers are owned by the reserving side until the msg is pushed, the
+     * msg queue orders accesses so that no lock is needed */
+    memcpy(&na_sm_copy_buf->buf[0][0] + index * NA_SM_COPY_BUF_SIZE, src, n);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2666,9 +2902,7 @@ static NA_INLINE void
 na_sm_buf_copy_from(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index,
     void *dest, size_t n)
 {
-    hg_thread_spin_lock(&na_sm_copy_buf->buf_locks[index]);
-    memcpy(dest, na_sm_copy_buf->buf[index], n);
-    hg_thread_spin_unlock(&na_sm_copy_buf->buf_locks[index]);
+    memcpy(dest, &na_sm_copy_buf->buf[0][0] + index * NA_SM_COPY_BUF_SIZE, n);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2710,6 +2944,182 @@ na_sm_offset_translate(struct na_sm_mem_handle *mem_handle, na_offset_t offset,
     *iovcnt = i;
 }
 
+/*---------------------------------------------------------------------------*/
+static struct na_sm_mem_region *
+na_sm_mem_region_find(struct na_sm_mem_region_list *na_sm_mem_region_list,
+    const struct iovec *iov, unsigned long iovcnt)
+{
+    struct na_sm_mem_region *region;
+
+    hg_thread_rwlock_rdlock(&na_sm_mem_region_list->lock);
+    HG_LIST_FOREACH (region, &na_sm_mem_region_list->list, entry) {
+        unsigned long i;
+
+        if (!region->owned)
+            continue;
+
+        for (i = 0; i < iovcnt; i++) {
+            const char *start = (const char *) iov[i].iov_base;
+
+            if (start < region->base ||
+                start + iov[i].iov_len > region->base + region->size)
+                break;
+        }
+        if (i == iovcnt)
+            break;
+    }
+    hg_thread_rwlock_release_rdlock(&na_sm_mem_region_list->lock);
+
+    return region;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_mem_region_get(struct na_sm_class *na_sm_class, pid_t pid, na_uint8_t id,
+    na_uint32_t region_id, char *owner_base, size_t size,
+    struct na_sm_mem_region **region_ptr)
+{
+    struct na_sm_mem_region_list *na_sm_mem_region_list =
+        &na_sm_class->mem_regions;
+    struct na_sm_mem_region *region = NULL;
+    char shm_name[NA_SM_MAX_FILENAME] = {'\0'};
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    /* Regions are mapped once and remain mapped until finalize, the owner
+     * base address and size guard against PID reuse */
+    hg_thread_rwlock_rdlock(&na_sm_mem_region_list->lock);
+    HG_LIST_FOREACH (region, &na_sm_mem_region_list->list, entry)
+        if (region->pid == pid && region->id == id &&
+            region->region_id == region_id &&
+            region->owner_base == owner_base && region->size == size)
+            break;
+    hg_thread_rwlock_release_rdlock(&na_sm_mem_region_list->lock);
+    if (region)
+        goto done;
+
+    hg_thread_rwlock_wrlock(&na_sm_mem_region_list->lock);
+
+    /* Make sure region was not mapped in the meantime */
+    HG_LIST_FOREACH (region, &na_sm_mem_region_list->list, entry)
+        if (region->pid == pid && region->id == id &&
+            region->region_id == region_id &&
+            region->owner_base == owner_base && region->size == size)
+            break;
+    if (region)
+        goto unlock;
+
+    region = (struct na_sm_mem_region *) malloc(
+        sizeof(struct na_sm_mem_region));
+    NA_CHECK_ERROR(region == NULL, unlock, ret, NA_NOMEM,
+        "Could not allocate memory region");
+
+    rc = NA_SM_GEN_MEM_SHM_NAME(shm_name, NA_SM_MAX_FILENAME,
+        na_sm_class->username, (int) pid, id, region_id);
+    NA_CHECK_ERROR(rc < 0 || rc > NA_SM_MAX_FILENAME, error, ret, NA_OVERFLOW,
+        "NA_SM_GEN_MEM_SHM_NAME() failed, rc: %d", rc);
+
+    NA_LOG_DEBUG("shm_map() %s", shm_name);
+    region->base = (char *) na_sm_shm_map(shm_name, size, NA_FALSE);
+    NA_CHECK_ERROR(region->base == NULL, error, ret, NA_NODEV,
+        "Could not map memory region (%s)", shm_name);
+    region->owner_base = owner_base;
+    region->size = size;
+    region->pid = pid;
+    region->region_id = region_id;
+    region->id = id;
+    region->owned = NA_FALSE;
+
+    HG_LIST_INSERT_HEAD(&na_sm_mem_region_list->list, region, entry);
+
+unlock:
+    hg_thread_rwlock_release_wrlock(&na_sm_mem_region_list->lock);
+
+done:
+    if (ret == NA_SUCCESS)
+        *region_ptr = region;
+
+    return ret;
+
+error:
+    hg_thread_rwlock_release_wrlock(&na_sm_mem_region_list->lock);
+    free(region);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_sm_mem_regions_close(struct na_sm_class *na_sm_class)
+{
+    struct na_sm_mem_region_list *na_sm_mem_region_list =
+        &na_sm_class->mem_regions;
+
+    while (!HG_LIST_IS_EMPTY(&na_sm_mem_region_list->list)) {
+        struct na_sm_mem_region *region =
+            HG_LIST_FIRST(&na_sm_mem_region_list->list);
+        char shm_name[NA_SM_MAX_FILENAME] = {'\0'};
+        const char *shm_name_ptr = NULL;
+
+        HG_LIST_REMOVE(region, entry);
+
+        /* Remove regions that were not freed by the user */
+        if (region->owned) {
+            int rc = NA_SM_GEN_MEM_SHM_NAME(shm_name, NA_SM_MAX_FILENAME,
+                na_sm_class->username, (int) region->pid, region->id,
+                region->region_id);
+            if (rc > 0 && rc <= NA_SM_MAX_FILENAME)
+                shm_name_ptr = shm_name;
+        }
+
+        NA_LOG_DEBUG("shm_unmap() %s", shm_name_ptr);
+        (void) na_sm_shm_unmap(shm_name_ptr, region->base, region->size);
+        free(region);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static na_size_t
+na_sm_mem_region_copy(const struct na_sm_mem_region *region,
+    const struct iovec *local_iov, unsigned long liovcnt,
+    const struct iovec *remote_iov, unsigned long riovcnt, na_size_t length,
+    na_bool_t put)
+{
+    unsigned long li = 0, ri = 0;
+    size_t loff = 0, roff = 0;
+    na_size_t ncopy = 0;
+
+    while (ncopy < length && li < liovcnt && ri < riovcnt) {
+        char *local_ptr = (char *) local_iov[li].iov_base + loff;
+        /* Translate peer address into local mapping */
+        char *remote_ptr = region->base +
+                           ((char *) remote_iov[ri].iov_base -
+                               region->owner_base) +
+                           roff;
+        size_t n = MIN(length - ncopy,
+            MIN(local_iov[li].iov_len - loff, remote_iov[ri].iov_len - roff));
+
+        if (put)
+            memcpy(remote_ptr, local_ptr, n);
+        else
+            memcpy(local_ptr, remote_ptr, n);
+        ncopy += n;
+
+        loff += n;
+        if (loff == local_iov[li].iov_len) {
+            li++;
+            loff = 0;
+        }
+        roff += n;
+        if (roff == remote_iov[ri].iov_len) {
+            ri++;
+            roff = 0;
+        }
+    }
+
+    return ncopy;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_sm_progress_sock(struct na_sm_endpoint *na_sm_endpoint, const char *username,
@@ -2767,7 +3177,7 @@ na_sm_process_cmd(struct na_sm_endpoint *na_sm_endpoint, const char *username,
         }
         case NA_SM_RELEASED: {
             struct na_sm_addr *na_sm_addr = NULL;
-            na_bool_t found = NA_FALSE;
+            na_bool_t found = NA_FALSE, progressed;
 
             /* Find address from list of addresses to poll */
             hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
@@ -2790,6 +3200,14 @@ na_sm_process_cmd(struct na_sm_endpoint *na_sm_endpoint, const char *username,
                 break;
             }
 
+            /* Peer may have exited right after posting its last msgs */
+            do {
+                progressed = NA_FALSE;
+                ret = na_sm_progress_rx_queue(
+                    na_sm_endpoint, na_sm_addr, &progressed);
+                NA_CHECK_NA_ERROR(done, ret, "Could not progress rx queue");
+            } while (progressed);
+
             if (hg_atomic_decr32(&na_sm_addr->ref_count))
                 /* Cannot free yet */
                 break;
@@ -2852,6 +3270,43 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_bool_t
+na_sm_progress_try_wait(struct na_sm_addr_list *poll_addr_list)
+{
+    struct na_sm_addr *poll_addr;
+    na_bool_t ret = NA_TRUE;
+
+    hg_thread_spin_lock(&poll_addr_list->lock);
+    HG_LIST_FOREACH (poll_addr, &poll_addr_list->list, entry) {
+        /* Peers must notify us again, clear flag before reading the queue
+         * so that a message posted concurrently is not missed */
+        if (poll_addr->spinning && hg_atomic_get64(poll_addr->spinning)) {
+            na_bool_t signaled;
+
+            hg_atomic_set64(poll_addr->spinning, 0);
+            hg_atomic_fence();
+
+            /* Consume notifications left while spinning */
+            if (poll_addr->rx_notify > 0 &&
+                na_sm_event_get(poll_addr->rx_notify, &signaled) !=
+                    NA_SUCCESS) {
+                ret = NA_FALSE;
+                break;
+            }
+        }
+
+        /* Check whether something is in one of the rx queues */
+        if (!na_sm_msg_queue_is_empty(poll_addr->rx_queue)) {
+            ret = NA_FALSE;
+            break;
+        }
+    }
+    hg_thread_spin_unlock(&poll_addr_list->lock);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_sm_progress_rx_queue(struct na_sm_endpoint *na_sm_endpoint,
@@ -2921,13 +3376,13 @@ na_sm_process_unexpected(struct na_sm_op_queue *unexpected_op_queue,
         na_sm_op_id->info.msg.tag = (na_tag_t) msg_hdr.hdr.tag;
 
         /* Copy buffer */
-        na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
-            msg_hdr.hdr.buf_idx, na_sm_op_id->info.msg.buf.ptr,
-            msg_hdr.hdr.buf_size);
+        na_sm_buf_copy_from(poll_addr->copy_buf, msg_hdr.hdr.buf_idx,
+            na_sm_op_id->info.msg.buf.ptr, msg_hdr.hdr.buf_size);
 
         /* Release buffer */
-        na_sm_buf_release(
-            &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+        ret = na_sm_addr_buf_release(
+            poll_addr, msg_hdr.hdr.buf_idx, msg_hdr.hdr.buf_size);
+        NA_CHECK_NA_ERROR(done, ret, "Could not release buffer");
 
         /* Complete operation (no need to notify) */
         ret = na_sm_complete(na_sm_op_id, 0);
@@ -2950,13 +3405,13 @@ na_sm_process_unexpected(struct na_sm_op_queue *unexpected_op_queue,
             "Could not allocate na_sm_unexpected_info buf");
 
         /* Copy buffer */
-        na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
-            msg_hdr.hdr.buf_idx, na_sm_unexpected_info->buf,
-            msg_hdr.hdr.buf_size);
+        na_sm_buf_copy_from(poll_addr->copy_buf, msg_hdr.hdr.buf_idx,
+            na_sm_unexpected_info->buf, msg_hdr.hdr.buf_size);
 
         /* Release buffer */
-        na_sm_buf_release(
-            &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+        ret = na_sm_addr_buf_release(
+            poll_addr, msg_hdr.hdr.buf_idx, msg_hdr.hdr.buf_size);
+        NA_CHECK_NA_ERROR(error, ret, "Could not release buffer");
 
         /* Otherwise push the unexpected message into our unexpected queue so
          * that we can treat it later when a recv_unexpected is posted */
@@ -2970,6 +3425,8 @@ done:
     return ret;
 
 error:
+    if (na_sm_unexpected_info)
+        free(na_sm_unexpected_info->buf);
     free(na_sm_unexpected_info);
     return ret;
 }
@@ -3004,13 +3461,13 @@ na_sm_process_expected(struct na_sm_op_queue *expected_op_queue,
     na_sm_op_id->info.msg.actual_buf_size = msg_hdr.hdr.buf_size;
 
     /* Copy buffer */
-    na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
-        msg_hdr.hdr.buf_idx, na_sm_op_id->info.msg.buf.ptr,
-        msg_hdr.hdr.buf_size);
+    na_sm_buf_copy_from(poll_addr->copy_buf, msg_hdr.hdr.buf_idx,
+        na_sm_op_id->info.msg.buf.ptr, msg_hdr.hdr.buf_size);
 
     /* Release buffer */
-    na_sm_buf_release(
-        &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+    ret = na_sm_addr_buf_release(
+        poll_addr, msg_hdr.hdr.buf_idx, msg_hdr.hdr.buf_size);
+    NA_CHECK_NA_ERROR(done, ret, "Could not release buffer");
 
     /* Complete operation */
     ret = na_sm_complete(na_sm_op_id, 0);
@@ -3022,80 +3479,87 @@ done:
 
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_process_retries(struct na_sm_op_queue *retry_op_queue)
+na_sm_process_retries(
+    struct na_sm_op_queue *retry_op_queue, na_bool_t *progressed)
 {
     struct na_sm_op_id *na_sm_op_id = NULL;
     unsigned int buf_idx;
     na_return_t ret = NA_SUCCESS;
 
     do {
+        struct na_sm_addr *skipped_addrs[NA_SM_MAX_RETRY_SKIP];
+        unsigned int skipped_count = 0;
         na_sm_msg_hdr_t msg_hdr;
         na_bool_t rc;
 
+        /* Buffers are reserved per peer, skip ops of peers that have no
+         * buffers available so that they do not hold back ops of other
+         * peers (ops of a same peer are still retried in order) */
         hg_thread_spin_lock(&retry_op_queue->lock);
-        na_sm_op_id = HG_QUEUE_FIRST(&retry_op_queue->queue);
-        hg_thread_spin_unlock(&retry_op_queue->lock);
+        HG_QUEUE_FOREACH (na_sm_op_id, &retry_op_queue->queue, entry) {
+            unsigned int i;
 
-        if (!na_sm_op_id)
-            break;
+            /* Canceled ops are completed by na_sm_cancel() */
+            if (hg_atomic_get32(&na_sm_op_id->status) & NA_SM_OP_CANCELED)
+                continue;
 
-        NA_LOG_DEBUG("Attempting to retry %p", na_sm_op_id);
+            for (i = 0; i < skipped_count; i++)
+                if (skipped_addrs[i] == na_sm_op_id->na_sm_addr)
+                    break;
+            if (i < skipped_count)
+                continue;
 
-        /* Try to reserve buffer atomically */
-        if (na_sm_buf_reserve(
-                &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, &buf_idx) ==
-            NA_AGAIN)
-            break;
+            NA_LOG_DEBUG("Attempting to retry %p", na_sm_op_id);
 
-        /* Successfully reserved a buffer, check that the operation has not
-         * been canceled in the meantime so that we can dequeue the op from
-         * the queue properly. */
-        hg_thread_spin_lock(&retry_op_queue->lock);
+            /* Try to reserve buffer atomically */
+            if (na_sm_addr_buf_reserve(na_sm_op_id->na_sm_addr,
+                    na_sm_op_id->info.msg.buf_size, &buf_idx) == NA_SUCCESS) {
+                HG_QUEUE_REMOVE(
+                    &retry_op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
+                hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
+                break;
+            }
 
-        if ((hg_atomic_get32(&na_sm_op_id->status) & NA_SM_OP_CANCELED)) {
-            hg_thread_spin_unlock(&retry_op_queue->lock);
-            na_sm_buf_release(
-                &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, buf_idx);
-            continue;
+            if (skipped_count == NA_SM_MAX_RETRY_SKIP) {
+                na_sm_op_id = NULL;
+                break;
+            }
+            skipped_addrs[skipped_count++] = na_sm_op_id->na_sm_addr;
         }
-
-        HG_QUEUE_REMOVE(
-            &retry_op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
-        hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
-
         hg_thread_spin_unlock(&retry_op_queue->lock);
 
+        if (!na_sm_op_id)
+            break;
+
         /* Copy buffer */
-        na_sm_buf_copy_to(&na_sm_op_id->na_sm_addr->shared_region->copy_bufs,
-            buf_idx, na_sm_op_id->info.msg.buf.const_ptr,
+        na_sm_buf_copy_to(na_sm_op_id->na_sm_addr->copy_buf, buf_idx,
+            na_sm_op_id->info.msg.buf.const_ptr,
             na_sm_op_id->info.msg.buf_size);
 
         /* Post message to queue */
         msg_hdr.hdr.type = na_sm_op_id->completion_data.callback_info.type;
         msg_hdr.hdr.buf_idx = buf_idx & 0xff;
-        msg_hdr.hdr.buf_size = na_sm_op_id->info.msg.buf_size & 0xffff;
+        msg_hdr.hdr.buf_size = na_sm_op_id->info.msg.buf_size & 0xfffff;
         msg_hdr.hdr.tag = na_sm_op_id->info.msg.tag;
 
         rc = na_sm_msg_queue_push(na_sm_op_id->na_sm_addr->tx_queue, msg_hdr);
         NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
 
         /* Notify remote if notifications are enabled */
-        if (na_sm_op_id->na_sm_addr->tx_notify > 0) {
-            ret = na_sm_event_set(na_sm_op_id->na_sm_addr->tx_notify);
-            NA_CHECK_NA_ERROR(
-                error, ret, "Could not send completion notification");
-        }
+        ret = na_sm_addr_notify(na_sm_op_id->na_sm_addr);
+        NA_CHECK_NA_ERROR(error, ret, "Could not send completion notification");
 
         /* Immediate completion, add directly to completion queue. */
         ret = na_sm_complete(na_sm_op_id, 0);
         NA_CHECK_NA_ERROR(error, ret, "Could not complete operation");
+        *progressed = NA_TRUE;
     } while (1);
 
     return ret;
 
 error:
-    na_sm_buf_release(
-        &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, buf_idx);
+    (void) na_sm_addr_buf_release(
+        na_sm_op_id->na_sm_addr, buf_idx, na_sm_op_id->info.msg.buf_size);
     hg_atomic_decr32(&na_sm_op_id->na_sm_addr->ref_count);
     hg_atomic_decr32(&na_sm_op_id->ref_count);
 
@@ -3253,6 +3717,9 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
     memset(na_class->plugin_class, 0, sizeof(struct na_sm_class));
     NA_SM_CLASS(na_class)->no_wait = no_wait;
     NA_SM_CLASS(na_class)->max_contexts = max_contexts;
+    HG_LIST_INIT(&NA_SM_CLASS(na_class)->mem_regions.list);
+    hg_thread_rwlock_init(&NA_SM_CLASS(na_class)->mem_regions.lock);
+    hg_atomic_init32(&NA_SM_CLASS(na_class)->mem_region_id, 0);
 
     /* Copy username */
     NA_SM_CLASS(na_class)->username = strdup(username);
@@ -3272,6 +3739,7 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
 
 error:
     if (na_class->plugin_class) {
+        hg_thread_rwlock_destroy(&NA_SM_CLASS(na_class)->mem_regions.lock);
         free(NA_SM_CLASS(na_class)->username);
         free(na_class->plugin_class);
         na_class->plugin_class = NULL;
@@ -3296,6 +3764,10 @@ na_sm_finalize(na_class_t *na_class)
         &NA_SM_CLASS(na_class)->endpoint, NA_SM_CLASS(na_class)->username);
     NA_CHECK_NA_ERROR(done, ret, "Could not close endpoint");
 
+    /* Unmap memory regions */
+    na_sm_mem_regions_close(NA_SM_CLASS(na_class));
+    hg_thread_rwlock_destroy(&NA_SM_CLASS(na_class)->mem_regions.lock);
+
     free(NA_SM_CLASS(na_class)->username);
     free(na_class->plugin_class);
     na_class->plugin_class = NULL;
@@ -3695,7 +4167,7 @@ na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.tag = tag;
 
     /* Try to reserve buffer atomically */
-    ret = na_sm_buf_reserve(&na_sm_addr->shared_region->copy_bufs, &buf_idx);
+    ret = na_sm_addr_buf_reserve(na_sm_addr, buf_size, &buf_idx);
     if (unlikely(ret == NA_AGAIN)) {
         struct na_sm_op_queue *retry_op_queue =
             &NA_SM_CLASS(na_class)->endpoint.retry_op_queue;
@@ -3717,24 +4189,20 @@ na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
         reserved = NA_TRUE;
 
         /* Reservation succeeded, copy buffer */
-        na_sm_buf_copy_to(
-            &na_sm_addr->shared_region->copy_bufs, buf_idx, buf, buf_size);
+        na_sm_buf_copy_to(na_sm_addr->copy_buf, buf_idx, buf, buf_size);
 
         /* Post message to queue */
         msg_hdr.hdr.type = na_sm_op_id->completion_data.callback_info.type;
         msg_hdr.hdr.buf_idx = buf_idx & 0xff;
-        msg_hdr.hdr.buf_size = buf_size & 0xffff;
+        msg_hdr.hdr.buf_size = buf_size & 0xfffff;
         msg_hdr.hdr.tag = tag;
 
         rc = na_sm_msg_queue_push(na_sm_addr->tx_queue, msg_hdr);
         NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
 
         /* Notify remote if notifications are enabled */
-        if (na_sm_addr->tx_notify > 0) {
-            ret = na_sm_event_set(na_sm_addr->tx_notify);
-            NA_CHECK_NA_ERROR(
-                error, ret, "Could not send completion notification");
-        }
+        ret = na_sm_addr_notify(na_sm_addr);
+        NA_CHECK_NA_ERROR(error, ret, "Could not send completion notification");
 
         /* Immediate completion, add directly to completion queue. */
         ret = na_sm_complete(na_sm_op_id,
@@ -3747,9 +4215,11 @@ done:
 
 error:
     if (reserved)
-        na_sm_buf_release(&na_sm_addr->shared_region->copy_bufs, buf_idx);
+        (void) na_sm_addr_buf_release(na_sm_addr, buf_idx, buf_size);
     hg_atomic_decr32(&na_sm_addr->ref_count);
     hg_atomic_decr32(&na_sm_op_id->ref_count);
+    /* Op can be reused */
+    hg_atomic_set32(&na_sm_op_id->status, NA_SM_OP_COMPLETED);
 
     return ret;
 }
@@ -3880,7 +4350,7 @@ na_sm_msg_send_expected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.tag = tag;
 
     /* Try to reserve buffer atomically */
-    ret = na_sm_buf_reserve(&na_sm_addr->shared_region->copy_bufs, &buf_idx);
+    ret = na_sm_addr_buf_reserve(na_sm_addr, buf_size, &buf_idx);
     if (unlikely(ret == NA_AGAIN)) {
         struct na_sm_op_queue *retry_op_queue =
             &NA_SM_CLASS(na_class)->endpoint.retry_op_queue;
@@ -3902,24 +4372,20 @@ na_sm_msg_send_expected(na_class_t *na_class, na_context_t *context,
         reserved = NA_TRUE;
 
         /* Reservation succeeded, copy buffer */
-        na_sm_buf_copy_to(
-            &na_sm_addr->shared_region->copy_bufs, buf_idx, buf, buf_size);
+        na_sm_buf_copy_to(na_sm_addr->copy_buf, buf_idx, buf, buf_size);
 
         /* Post message to queue */
         msg_hdr.hdr.type = na_sm_op_id->completion_data.callback_info.type;
         msg_hdr.hdr.buf_idx = buf_idx & 0xff;
-        msg_hdr.hdr.buf_size = buf_size & 0xffff;
+        msg_hdr.hdr.buf_size = buf_size & 0xfffff;
         msg_hdr.hdr.tag = tag;
 
         rc = na_sm_msg_queue_push(na_sm_addr->tx_queue, msg_hdr);
         NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
 
         /* Notify remote if notifications are enabled */
-        if (na_sm_addr->tx_notify > 0) {
-            ret = na_sm_event_set(na_sm_addr->tx_notify);
-            NA_CHECK_NA_ERROR(
-                error, ret, "Could not send completion notification");
-        }
+        ret = na_sm_addr_notify(na_sm_addr);
+        NA_CHECK_NA_ERROR(error, ret, "Could not send completion notification");
 
         /* Immediate completion, add directly to completion queue. */
         ret = na_sm_complete(na_sm_op_id,
@@ -3932,9 +4398,11 @@ done:
 
 error:
     if (reserved)
-        na_sm_buf_release(&na_sm_addr->shared_region->copy_bufs, buf_idx);
+        (void) na_sm_addr_buf_release(na_sm_addr, buf_idx, buf_size);
     hg_atomic_decr32(&na_sm_op_id->na_sm_addr->ref_count);
     hg_atomic_decr32(&na_sm_op_id->ref_count);
+    /* Op can be reused */
+    hg_atomic_set32(&na_sm_op_id->status, NA_SM_OP_COMPLETED);
 
     return ret;
 }
@@ -3992,10 +4460,94 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static void *
+na_sm_mem_alloc(na_class_t *na_class, na_size_t buf_size, void **plugin_data)
+{
+    struct na_sm_class *na_sm_class = NA_SM_CLASS(na_class);
+    struct na_sm_addr *source_addr = na_sm_class->endpoint.source_addr;
+    size_t page_size = (size_t) hg_mem_get_page_size();
+    struct na_sm_mem_region *region = NULL;
+    char shm_name[NA_SM_MAX_FILENAME] = {'\0'};
+    int rc;
+
+    region = (struct na_sm_mem_region *) malloc(
+        sizeof(struct na_sm_mem_region));
+    NA_CHECK_ERROR_NORET(
+        region == NULL, error, "Could not allocate memory region");
+
+    /* Region IDs start at 1, 0 is used for handles without region */
+    region->region_id =
+        (na_uint32_t) hg_atomic_incr32(&na_sm_class->mem_region_id);
+    region->size = (buf_size + page_size - 1) & ~(page_size - 1);
+    region->pid = source_addr->pid;
+    region->id = source_addr->id;
+    region->owned = NA_TRUE;
+
+    rc = NA_SM_GEN_MEM_SHM_NAME(shm_name, NA_SM_MAX_FILENAME,
+        na_sm_class->username, (int) region->pid, region->id,
+        region->region_id);
+    NA_CHECK_ERROR_NORET(rc < 0 || rc > NA_SM_MAX_FILENAME, error,
+        "NA_SM_GEN_MEM_SHM_NAME() failed, rc: %d", rc);
+
+    /* Pages are zeroed by the system and only allocated when touched */
+    NA_LOG_DEBUG("shm_map() %s", shm_name);
+    region->base = (char *) na_sm_shm_map(shm_name, region->size, NA_TRUE);
+    NA_CHECK_ERROR_NORET(region->base == NULL, error,
+        "Could not map memory region (%s)", shm_name);
+    region->owner_base = region->base;
+
+    hg_thread_rwlock_wrlock(&na_sm_class->mem_regions.lock);
+    HG_LIST_INSERT_HEAD(&na_sm_class->mem_regions.list, region, entry);
+    hg_thread_rwlock_release_wrlock(&na_sm_class->mem_regions.lock);
+
+    *plugin_data = region;
+
+    return region->base;
+
+error:
+    free(region);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_mem_free(na_class_t *na_class, void *buf, void *plugin_data)
+{
+    struct na_sm_class *na_sm_class = NA_SM_CLASS(na_class);
+    struct na_sm_mem_region *region = (struct na_sm_mem_region *) plugin_data;
+    char shm_name[NA_SM_MAX_FILENAME] = {'\0'};
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    NA_CHECK_ERROR(region == NULL || region->base != buf || !region->owned,
+        done, ret, NA_INVALID_ARG, "Invalid plugin data value");
+
+    rc = NA_SM_GEN_MEM_SHM_NAME(shm_name, NA_SM_MAX_FILENAME,
+        na_sm_class->username, (int) region->pid, region->id,
+        region->region_id);
+    NA_CHECK_ERROR(rc < 0 || rc > NA_SM_MAX_FILENAME, done, ret, NA_OVERFLOW,
+        "NA_SM_GEN_MEM_SHM_NAME() failed, rc: %d", rc);
+
+    hg_thread_rwlock_wrlock(&na_sm_class->mem_regions.lock);
+    HG_LIST_REMOVE(region, entry);
+    hg_thread_rwlock_release_wrlock(&na_sm_class->mem_regions.lock);
+
+    /* Peers that mapped the region keep their mapping until they finalize */
+    NA_LOG_DEBUG("shm_unmap() %s", shm_name);
+    ret = na_sm_shm_unmap(shm_name, region->base, region->size);
+    free(region);
+    NA_CHECK_NA_ERROR(
+        done, ret, "Could not unmap memory region (%s)", shm_name);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_mem_handle_create(na_class_t NA_UNUSED *na_class, void *buf,
-    na_size_t buf_size, unsigned long flags, na_mem_handle_t *mem_handle)
+na_sm_mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
+    unsigned long flags, na_mem_handle_t *mem_handle)
 {
     struct na_sm_mem_handle *na_sm_mem_handle = NULL;
     na_return_t ret = NA_SUCCESS;
@@ -4014,6 +4566,8 @@ na_sm_mem_handle_create(na_class_t NA_UNUSED *na_class, void *buf,
     na_sm_mem_handle->iovcnt = 1;
     na_sm_mem_handle->flags = flags & 0xff;
     na_sm_mem_handle->len = buf_size;
+    na_sm_mem_handle->region = na_sm_mem_region_find(
+        &NA_SM_CLASS(na_class)->mem_regions, na_sm_mem_handle->iov, 1);
 
     *mem_handle = (na_mem_handle_t) na_sm_mem_handle;
 
@@ -4030,7 +4584,7 @@ error:
 /*---------------------------------------------------------------------------*/
 #ifdef NA_SM_HAS_CMA
 static na_return_t
-na_sm_mem_handle_create_segments(na_class_t NA_UNUSED *na_class,
+na_sm_mem_handle_create_segments(na_class_t *na_class,
     struct na_segment *segments, na_size_t segment_count, unsigned long flags,
     na_mem_handle_t *mem_handle)
 {
@@ -4061,6 +4615,9 @@ na_sm_mem_handle_create_segments(na_class_t NA_UNUSED *na_class,
     }
     na_sm_mem_handle->iovcnt = segment_count;
     na_sm_mem_handle->flags = flags & 0xff;
+    na_sm_mem_handle->region =
+        na_sm_mem_region_find(&NA_SM_CLASS(na_class)->mem_regions,
+            na_sm_mem_handle->iov, na_sm_mem_handle->iovcnt);
 
     *mem_handle = (na_mem_handle_t) na_sm_mem_handle;
 
@@ -4103,6 +4660,12 @@ na_sm_mem_handle_get_serialize_size(
     for (i = 0; i < na_sm_mem_handle->iovcnt; i++)
         ret += sizeof(void *) + sizeof(size_t);
 
+    /* Region */
+    ret += sizeof(na_uint32_t);
+    if (na_sm_mem_handle->region)
+        ret += sizeof(pid_t) + sizeof(na_uint8_t) + sizeof(void *) +
+               sizeof(size_t);
+
     return ret;
 }
 
@@ -4137,16 +4700,33 @@ na_sm_mem_handle_serialize(na_class_t NA_UNUSED *na_class, void *buf,
         buf_ptr += sizeof(size_t);
     }
 
+    /* Region (ID 0 if none) */
+    if (na_sm_mem_handle->region) {
+        struct na_sm_mem_region *region = na_sm_mem_handle->region;
+
+        memcpy(buf_ptr, &region->region_id, sizeof(na_uint32_t));
+        buf_ptr += sizeof(na_uint32_t);
+        memcpy(buf_ptr, &region->pid, sizeof(pid_t));
+        buf_ptr += sizeof(pid_t);
+        memcpy(buf_ptr, &region->id, sizeof(na_uint8_t));
+        buf_ptr += sizeof(na_uint8_t);
+        memcpy(buf_ptr, &region->owner_base, sizeof(void *));
+        buf_ptr += sizeof(void *);
+        memcpy(buf_ptr, &region->size, sizeof(size_t));
+    } else
+        memset(buf_ptr, 0, sizeof(na_uint32_t));
+
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_mem_handle_deserialize(na_class_t NA_UNUSED *na_class,
-    na_mem_handle_t *mem_handle, const void *buf, NA_UNUSED na_size_t buf_size)
+na_sm_mem_handle_deserialize(na_class_t *na_class, na_mem_handle_t *mem_handle,
+    const void *buf, NA_UNUSED na_size_t buf_size)
 {
     struct na_sm_mem_handle *na_sm_mem_handle = NULL;
     const char *buf_ptr = (const char *) buf;
+    na_uint32_t region_id;
     na_return_t ret = NA_SUCCESS;
     unsigned long i;
 
@@ -4155,6 +4735,7 @@ na_sm_mem_handle_deserialize(na_class_t NA_UNUSED *na_class,
     NA_CHECK_ERROR(na_sm_mem_handle == NULL, error, ret, NA_NOMEM,
         "Could not allocate NA SM memory handle");
     na_sm_mem_handle->iov = NULL;
+    na_sm_mem_handle->region = NULL;
 
     /* Number of segments */
     memcpy(&na_sm_mem_handle->iovcnt, buf_ptr, sizeof(unsigned long));
@@ -4183,6 +4764,43 @@ na_sm_mem_handle_deserialize(na_class_t NA_UNUSED *na_class,
         buf_ptr += sizeof(size_t);
     }
 
+    /* Region */
+    memcpy(&region_id, buf_ptr, sizeof(na_uint32_t));
+    buf_ptr += sizeof(na_uint32_t);
+    if (region_id) {
+        na_return_t region_ret;
+        char *owner_base;
+        size_t size;
+        pid_t pid;
+        na_uint8_t id;
+
+        memcpy(&pid, buf_ptr, sizeof(pid_t));
+        buf_ptr += sizeof(pid_t);
+        memcpy(&id, buf_ptr, sizeof(na_uint8_t));
+        buf_ptr += sizeof(na_uint8_t);
+        memcpy(&owner_base, buf_ptr, sizeof(void *));
+        buf_ptr += sizeof(void *);
+        memcpy(&size, buf_ptr, sizeof(size_t));
+
+        /* Segments must be within region */
+        for (i = 0; i < na_sm_mem_handle->iovcnt; i++) {
+            const char *start =
+                (const char *) na_sm_mem_handle->iov[i].iov_base;
+
+            NA_CHECK_ERROR(start < owner_base ||
+                               start + na_sm_mem_handle->iov[i].iov_len >
+                                   owner_base + size,
+                error, ret, NA_FAULT, "Segment is outside of memory region");
+        }
+
+        /* Fall back to CMA if region cannot be mapped */
+        region_ret = na_sm_mem_region_get(NA_SM_CLASS(na_class), pid, id,
+            region_id, owner_base, size, &na_sm_mem_handle->region);
+        if (region_ret != NA_SUCCESS)
+            NA_LOG_WARNING("Could not map memory region %u of PID=%d, ID=%u",
+                region_id, (int) pid, id);
+    }
+
     *mem_handle = (na_mem_handle_t) na_sm_mem_handle;
 
     return ret;
@@ -4222,8 +4840,8 @@ na_sm_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
 #endif
 
 #if !defined(NA_SM_HAS_CMA) && !defined(__APPLE__)
-    NA_GOTO_ERROR(
-        done, ret, NA_OPNOTSUPPORTED, "Not implemented for this platform");
+    NA_CHECK_ERROR(na_sm_mem_handle_remote->region == NULL, done, ret,
+        NA_OPNOTSUPPORTED, "Not implemented for this platform");
 #endif
 
     switch (na_sm_mem_handle_remote->flags) {
@@ -4282,6 +4900,16 @@ na_sm_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
         riovcnt = na_sm_mem_handle_remote->iovcnt;
     }
 
+    if (na_sm_mem_handle_remote->region) {
+        /* Remote memory is mapped, no system call needed */
+        na_size_t ncopy =
+            na_sm_mem_region_copy(na_sm_mem_handle_remote->region, local_iov,
+                liovcnt, remote_iov, riovcnt, length, NA_TRUE);
+        NA_CHECK_ERROR(ncopy != length, error, ret, NA_MSGSIZE,
+            "Wrote %lu bytes, was expecting %lu bytes", ncopy, length);
+        goto complete;
+    }
+
 #if defined(NA_SM_HAS_CMA)
     nwrite = process_vm_writev(na_sm_addr->pid, local_iov, liovcnt, remote_iov,
         riovcnt, /* unused */ 0);
@@ -4321,6 +4949,7 @@ na_sm_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
         "mach_vm_write() failed (%s)", mach_error_string(kret));
 #endif
 
+complete:
     /* Immediate completion */
     ret = na_sm_complete(
         na_sm_op_id, NA_SM_CLASS(na_class)->endpoint.source_addr->tx_notify);
@@ -4364,8 +4993,8 @@ na_sm_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
 #endif
 
 #if !defined(NA_SM_HAS_CMA) && !defined(__APPLE__)
-    NA_GOTO_ERROR(
-        done, ret, NA_OPNOTSUPPORTED, "Not implemented for this platform");
+    NA_CHECK_ERROR(na_sm_mem_handle_remote->region == NULL, done, ret,
+        NA_OPNOTSUPPORTED, "Not implemented for this platform");
 #endif
 
     switch (na_sm_mem_handle_remote->flags) {
@@ -4419,6 +5048,16 @@ na_sm_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
         riovcnt = na_sm_mem_handle_remote->iovcnt;
     }
 
+    if (na_sm_mem_handle_remote->region) {
+        /* Remote memory is mapped, no system call needed */
+        na_size_t ncopy =
+            na_sm_mem_region_copy(na_sm_mem_handle_remote->region, local_iov,
+                liovcnt, remote_iov, riovcnt, length, NA_FALSE);
+        NA_CHECK_ERROR(ncopy != length, error, ret, NA_MSGSIZE,
+            "Read %lu bytes, was expecting %lu bytes", ncopy, length);
+        goto complete;
+    }
+
 #if defined(NA_SM_HAS_CMA)
     nread = process_vm_readv(na_sm_addr->pid, local_iov, liovcnt, remote_iov,
         riovcnt, /* unused */ 0);
@@ -4460,6 +5099,7 @@ na_sm_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
         "Read %ld bytes, was expecting %lu bytes", nread, length);
 #endif
 
+complete:
     /* Immediate completion */
     ret = na_sm_complete(
         na_sm_op_id, NA_SM_CLASS(na_class)->endpoint.source_addr->tx_notify);
@@ -4495,21 +5135,8 @@ done:
 static NA_INLINE na_bool_t
 na_sm_poll_try_wait(na_class_t *na_class, na_context_t NA_UNUSED *context)
 {
-    struct na_sm_addr *na_sm_addr;
-
-    /* Check whether something is in one of the rx queues */
-    hg_thread_spin_lock(&NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock);
-    HG_LIST_FOREACH (na_sm_addr,
-        &NA_SM_CLASS(na_class)->endpoint.poll_addr_list.list, entry) {
-        if (!na_sm_msg_queue_is_empty(na_sm_addr->rx_queue)) {
-            hg_thread_spin_unlock(
-                &NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock);
-            return NA_FALSE;
-        }
-    }
-    hg_thread_spin_unlock(&NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock);
-
-    return NA_TRUE;
+    return na_sm_progress_try_wait(
+        &NA_SM_CLASS(na_class)->endpoint.poll_addr_list);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -4531,7 +5158,10 @@ na_sm_progress(
         if (timeout)
             hg_time_get_current_ms(&t1);
 
-        if (timeout && na_sm_endpoint->poll_set) {
+        /* When spinning, peers may have skipped notifications */
+        if (timeout && na_sm_endpoint->poll_set &&
+            (!(na_class->progress_mode & NA_ADAPTIVE_SPIN) ||
+                na_sm_progress_try_wait(&na_sm_endpoint->poll_addr_list))) {
             unsigned int nevents = 0, i;
             /* Just wait on a single event, anything greater may increase
              * latency, and slow down progress, we will not wait next round
@@ -4592,6 +5222,8 @@ na_sm_progress(
             struct na_sm_addr_list *poll_addr_list =
                 &na_sm_endpoint->poll_addr_list;
             struct na_sm_addr *poll_addr;
+            na_bool_t spin = (na_class->progress_mode & NA_ADAPTIVE_SPIN) &&
+                             na_sm_endpoint->poll_set;
 
             /* Check whether something is in one of the rx queues */
             hg_thread_spin_lock(&poll_addr_list->lock);
@@ -4600,7 +5232,12 @@ na_sm_progress(
 
                 hg_thread_spin_unlock(&poll_addr_list->lock);
 
-                if (na_sm_endpoint->poll_set) {
+                if (spin) {
+                    /* Let peers skip notifications while we poll, pending
+                     * ones are consumed next time we block */
+                    if (!hg_atomic_get64(poll_addr->spinning))
+                        hg_atomic_set64(poll_addr->spinning, 1);
+                } else if (na_sm_endpoint->poll_set) {
                     na_bool_t progressed_notify = NA_FALSE;
                     ret =
                         na_sm_progress_rx_notify(poll_addr, &progressed_notify);
@@ -4648,7 +5285,8 @@ na_sm_progress(
         }
 
         /* Process retries */
-        ret = na_sm_process_retries(&na_sm_endpoint->retry_op_queue);
+        ret = na_sm_process_retries(
+            &na_sm_endpoint->retry_op_queue, &progressed);
         NA_CHECK_NA_ERROR(done, ret, "Could not process retried msgs");
 
         if (timeout) {
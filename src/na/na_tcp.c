@@ -0,0 +1,3848 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+#include "na_ip.h"
+#include "na_plugin.h"
+
+#include "mercury_hash_table.h"
+#include "mercury_list.h"
+#include "mercury_poll.h"
+#include "mercury_queue.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_rwlock.h"
+#include "mercury_thread_spin.h"
+#include "mercury_time.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Msg sizes */
+#define NA_TCP_UNEXPECTED_SIZE 8192
+#define NA_TCP_EXPECTED_SIZE   NA_TCP_UNEXPECTED_SIZE
+
+/* Max tag */
+#define NA_TCP_MAX_TAG NA_TAG_MAX
+
+/* Max events */
+#define NA_TCP_MAX_EVENTS 16
+
+/* Size of per-connection receive buffer */
+#define NA_TCP_RX_BUF_SIZE (64 * 1024)
+
+/* Payloads left that large are read directly into their destination */
+#define NA_TCP_RX_DIRECT_SIZE (16 * 1024)
+
+/* Number of segments kept inline in tx entries */
+#define NA_TCP_TX_IOV_INLINE 4
+
+/* Max length of address strings */
+#define NA_TCP_MAX_ADDR_NAME 64
+
+/* Environment variables used to set socket options */
+#define NA_TCP_NODELAY_ENV   "NA_TCP_NODELAY"
+#define NA_TCP_BUSY_POLL_ENV "NA_TCP_BUSY_POLL"
+
+/* Op ID status bits */
+#define NA_TCP_OP_COMPLETED (1 << 0)
+#define NA_TCP_OP_CANCELED  (1 << 1)
+#define NA_TCP_OP_QUEUED    (1 << 2)
+#define NA_TCP_OP_TX        (1 << 3)
+
+/* Private data access */
+#define NA_TCP_CLASS(na_class)                                                 \
+    ((struct na_tcp_class *) (na_class->plugin_class))
+#define NA_TCP_CONTEXT(context)                                                \
+    ((struct na_tcp_context *) (context->plugin_context))
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Msg types */
+typedef enum na_tcp_msg_type {
+    NA_TCP_HELLO = 1,  /* Connection handshake */
+    NA_TCP_UNEXPECTED, /* Unexpected msg */
+    NA_TCP_EXPECTED,   /* Expected msg */
+    NA_TCP_PUT,        /* Put request (descriptor followed by data) */
+    NA_TCP_PUT_ACK,    /* Put completion */
+    NA_TCP_GET,        /* Get request (descriptor) */
+    NA_TCP_GET_RESP    /* Get response followed by data */
+} na_tcp_msg_type_t;
+
+/* Msg header (peers are expected to share the same byte order) */
+struct na_tcp_msg_hdr {
+    na_uint64_t size;   /* Payload size (excluding RMA descriptor) */
+    na_uint64_t token;  /* RMA token */
+    na_uint32_t tag;    /* Msg tag */
+    na_uint32_t status; /* Status of RMA at target (replies) */
+    na_uint32_t type;   /* Msg type */
+    na_uint32_t pad;    /* Padding */
+};
+
+/* RMA descriptor, target memory is only accessed through the handles that it
+ * registered, peers never send raw addresses */
+struct na_tcp_rma_desc {
+    na_uint64_t key;    /* Key of registered memory handle */
+    na_uint64_t offset; /* Offset within memory handle */
+    na_uint64_t len;    /* Length of transfer */
+};
+
+/* Handshake, identifies the listening address of the connecting peer */
+struct na_tcp_hello {
+    na_uint32_t s_addr; /* IP (network byte order) */
+    na_uint32_t port;   /* Port (network byte order, 0 if not listening) */
+};
+
+/* Poll type */
+typedef enum na_tcp_poll_type {
+    NA_TCP_POLL_LISTEN = 1,
+    NA_TCP_POLL_CONN
+} na_tcp_poll_type_t;
+
+/* Connection state */
+typedef enum na_tcp_conn_state {
+    NA_TCP_CONN_CONNECTING = 1,
+    NA_TCP_CONN_CONNECTED
+} na_tcp_conn_state_t;
+
+/* Rx stage */
+typedef enum na_tcp_rx_stage {
+    NA_TCP_RX_HDR = 1, /* Receiving header */
+    NA_TCP_RX_DESC,    /* Receiving RMA descriptor */
+    NA_TCP_RX_DATA     /* Receiving payload */
+} na_tcp_rx_stage_t;
+
+/* Address */
+struct na_tcp_addr {
+    struct sockaddr_in sin;      /* Listening address (port 0 if none) */
+    struct na_tcp_conn *conn;    /* Connection used to send */
+    hg_thread_mutex_t lock;      /* Lock on connection and send path */
+    hg_atomic_int32_t ref_count; /* Ref count */
+};
+
+/* Map (used to cache addresses) */
+struct na_tcp_map {
+    hg_thread_rwlock_t lock;
+    hg_hash_table_t *map;
+};
+
+/* Memory handle (remote handles have no segments) */
+struct na_tcp_mem_handle {
+    struct iovec *iov;    /* I/O segments */
+    unsigned long iovcnt; /* Segment count */
+    size_t len;           /* Size of region */
+    na_uint64_t key;      /* Key of registration (0 if not registered) */
+    na_uint8_t flags;     /* Flag of operation access */
+};
+
+/* Tx entry */
+struct na_tcp_tx {
+    HG_QUEUE_ENTRY(na_tcp_tx) entry;   /* Entry in connection tx queue */
+    struct na_tcp_msg_hdr hdr;         /* Msg header */
+    struct iovec *iov;                 /* Segments left to write */
+    unsigned long iovcnt;              /* Number of segments left */
+    struct iovec *iov_alloc;           /* Allocated segments */
+    unsigned long iov_alloc_count;     /* Number of allocated segments */
+    struct na_tcp_rma_desc desc;       /* RMA descriptor */
+    struct na_tcp_op_id *na_tcp_op_id; /* Op ID (NULL for control msgs) */
+    na_bool_t started;                 /* Partially written */
+    na_bool_t allocated;               /* Free once written */
+
+    struct iovec iov_inline[NA_TCP_TX_IOV_INLINE]; /* Inline segments */
+};
+
+/* Unexpected msg info */
+struct na_tcp_unexpected_info {
+    HG_QUEUE_ENTRY(na_tcp_unexpected_info) entry;
+    struct na_tcp_addr *na_tcp_addr;
+    void *buf;
+    na_size_t buf_size;
+    na_tag_t tag;
+};
+
+/* Unexpected msg queue */
+struct na_tcp_unexpected_msg_queue {
+    HG_QUEUE_HEAD(na_tcp_unexpected_info) queue;
+    hg_thread_spin_t lock;
+};
+
+/* Rx state */
+struct na_tcp_rx {
+    struct na_tcp_msg_hdr hdr;         /* Current msg header */
+    struct na_tcp_hello hello;         /* Handshake */
+    char *buf;                         /* Receive buffer */
+    size_t buf_head;                   /* First unread byte */
+    size_t buf_tail;                   /* Past last read byte */
+    size_t hdr_len;                    /* Header bytes read */
+    struct iovec *iov;                 /* Payload left (NULL discards) */
+    unsigned long iovcnt;              /* Number of payload segments left */
+    size_t remaining;                  /* Payload bytes left */
+    struct iovec iov_single;           /* Contiguous payload */
+    struct iovec *iov_alloc;           /* Allocated payload segments */
+    unsigned long iov_alloc_count;     /* Number of allocated segments */
+    struct na_tcp_rma_desc desc;       /* RMA descriptor */
+    struct na_tcp_op_id *na_tcp_op_id; /* Op ID receiving payload */
+    na_return_t ret;                   /* Status of op receiving payload */
+    na_tcp_rx_stage_t stage;           /* Rx stage */
+
+    struct na_tcp_unexpected_info *unexpected_info; /* Unexpected payload */
+};
+
+/* Connection */
+struct na_tcp_conn {
+    HG_LIST_ENTRY(na_tcp_conn) entry;  /* Entry in connection list */
+    HG_QUEUE_HEAD(na_tcp_tx) tx_queue; /* Pending sends (under addr lock) */
+    struct na_tcp_rx rx;               /* Rx state */
+    struct na_tcp_tx hello_tx;         /* Handshake tx entry */
+    struct na_tcp_hello hello;         /* Handshake sent */
+    struct na_tcp_addr *na_tcp_addr;   /* Peer address */
+    na_tcp_poll_type_t poll_type;      /* Poll type */
+    na_tcp_conn_state_t state;         /* Connection state */
+    unsigned int poll_events;          /* Registered poll events */
+    int fd;                            /* Socket */
+};
+
+/* Connection list */
+struct na_tcp_conn_list {
+    HG_LIST_HEAD(na_tcp_conn) list;
+    hg_thread_spin_t lock;
+};
+
+/* Msg info */
+struct na_tcp_msg_info {
+    union {
+        const void *const_ptr;
+        void *ptr;
+    } buf;
+    size_t buf_size;
+    na_size_t actual_buf_size;
+    na_tag_t tag;
+};
+
+/* RMA info */
+struct na_tcp_rma_info {
+    struct na_tcp_mem_handle *local_mem_handle; /* Local handle */
+    na_offset_t local_offset;                   /* Local offset */
+    na_size_t length;                           /* Length of transfer */
+    na_uint64_t token;                          /* Token matching reply */
+};
+
+/* Operation ID */
+struct na_tcp_op_id {
+    struct na_cb_completion_data completion_data; /* Completion data */
+    union {
+        struct na_tcp_msg_info msg;
+        struct na_tcp_rma_info rma;
+    } info;                             /* Op info                  */
+    struct na_tcp_tx tx;                /* Tx entry                 */
+    HG_QUEUE_ENTRY(na_tcp_op_id) entry; /* Entry in queue           */
+    na_class_t *na_class;               /* NA class associated      */
+    na_context_t *context;              /* NA context associated    */
+    struct na_tcp_addr *na_tcp_addr;    /* Address associated       */
+    hg_atomic_int32_t status;           /* Operation status         */
+    hg_atomic_int32_t ref_count;        /* Refcount                 */
+};
+
+/* Op ID queue */
+struct na_tcp_op_queue {
+    HG_QUEUE_HEAD(na_tcp_op_id) queue;
+    hg_thread_spin_t lock;
+};
+
+/* Private context */
+struct na_tcp_context {
+    struct hg_poll_event events[NA_TCP_MAX_EVENTS];
+};
+
+/* Private data */
+struct na_tcp_class {
+    struct na_tcp_map addr_map; /* Map of listening addresses */
+    struct na_tcp_map mem_map;  /* Map of registered memory handles */
+    struct na_tcp_unexpected_msg_queue
+        unexpected_msg_queue;                   /* Unexpected msg queue */
+    struct na_tcp_op_queue unexpected_op_queue; /* Unexpected op queue */
+    struct na_tcp_op_queue expected_op_queue;   /* Expected op queue */
+    struct na_tcp_op_queue rma_op_queue;        /* Put/get op queue */
+    struct na_tcp_conn_list conn_list;          /* Open connections */
+    struct na_tcp_addr *self_addr;              /* Self address */
+    hg_poll_set_t *poll_set;                    /* Poll set */
+    hg_thread_mutex_t progress_lock;            /* Progress lock */
+    hg_atomic_int64_t next_token;               /* Next RMA token */
+    hg_atomic_int64_t next_key;                 /* Next memory handle key */
+    na_tcp_poll_type_t listen_poll_type;        /* Listen poll type */
+    int listen_fd;                              /* Listening socket */
+    int busy_poll;                              /* SO_BUSY_POLL (us) */
+    na_bool_t nodelay;                          /* Set TCP_NODELAY */
+    na_bool_t no_wait;                          /* Ignore wait object */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Convert errno to NA return values.
+ */
+static na_return_t
+na_tcp_errno_to_na(int rc);
+
+/**
+ * Generate key from address.
+ */
+static NA_INLINE na_uint64_t
+na_tcp_addr_to_key(const struct sockaddr_in *sin);
+
+/**
+ * Key hash for hash table.
+ */
+static NA_INLINE unsigned int
+na_tcp_addr_key_hash(hg_hash_table_key_t vlocation);
+
+/**
+ * Compare key.
+ */
+static NA_INLINE int
+na_tcp_addr_key_equal(
+    hg_hash_table_key_t vlocation1, hg_hash_table_key_t vlocation2);
+
+/**
+ * Convert "[<protocol>://]<host>:<port>" string to address. When passive is
+ * set, host and port may be omitted.
+ */
+static na_return_t
+na_tcp_string_to_sin(
+    const char *str, na_bool_t passive, struct sockaddr_in *sin);
+
+/**
+ * Set socket options.
+ */
+static void
+na_tcp_sock_set_options(struct na_tcp_class *na_tcp_class, int fd);
+
+/**
+ * Register fd to poll set.
+ */
+static na_return_t
+na_tcp_poll_register(
+    hg_poll_set_t *poll_set, int fd, unsigned int events, void *ptr);
+
+/**
+ * Deregister fd from poll set.
+ */
+static na_return_t
+na_tcp_poll_deregister(hg_poll_set_t *poll_set, int fd);
+
+/**
+ * Open endpoint.
+ */
+static na_return_t
+na_tcp_endpoint_open(struct na_tcp_class *na_tcp_class,
+    const char *host_name, const char *ip_subnet, na_bool_t listening);
+
+/**
+ * Close endpoint.
+ */
+static na_return_t
+na_tcp_endpoint_close(struct na_tcp_class *na_tcp_class);
+
+/**
+ * Allocate new address.
+ */
+static struct na_tcp_addr *
+na_tcp_addr_create(const struct sockaddr_in *sin);
+
+/**
+ * Release address.
+ */
+static void
+na_tcp_addr_release(struct na_tcp_addr *na_tcp_addr);
+
+/**
+ * Get address for listening address sin, inserting it into the map if it is
+ * not already there. Returned address must be released.
+ */
+static na_return_t
+na_tcp_addr_map_get(struct na_tcp_map *na_tcp_map,
+    const struct sockaddr_in *sin, struct na_tcp_addr **addr);
+
+/**
+ * Allocate new connection and register it to poll set.
+ */
+static na_return_t
+na_tcp_conn_create(struct na_tcp_class *na_tcp_class, int fd,
+    struct na_tcp_addr *na_tcp_addr, na_tcp_conn_state_t state,
+    struct na_tcp_conn **conn);
+
+/**
+ * Connect to address and queue handshake, must be called with addr locked.
+ */
+static na_return_t
+na_tcp_conn_connect(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_addr *na_tcp_addr);
+
+/**
+ * Close connection, fail pending operations and free connection.
+ */
+static void
+na_tcp_conn_close(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn);
+
+/**
+ * Update events registered for connection.
+ */
+static na_return_t
+na_tcp_conn_poll_update(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_conn *conn, unsigned int events);
+
+/**
+ * Write queued tx entries, must be called with addr locked.
+ */
+static na_return_t
+na_tcp_conn_write(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn);
+
+/**
+ * Read from connection and process received msgs.
+ */
+static na_return_t
+na_tcp_conn_read(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn,
+    na_bool_t *closed);
+
+/**
+ * Accept incoming connections.
+ */
+static na_return_t
+na_tcp_progress_listen(
+    struct na_tcp_class *na_tcp_class, na_bool_t *progressed);
+
+/**
+ * Progress connection events, closed is set if connection was closed.
+ */
+static void
+na_tcp_progress_conn(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_conn *conn, unsigned int events, na_bool_t *closed);
+
+/**
+ * Process handshake.
+ */
+static na_return_t
+na_tcp_process_hello(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn);
+
+/**
+ * Start receiving payload of msg once header is received.
+ */
+static na_return_t
+na_tcp_rx_start(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn);
+
+/**
+ * Complete msg once payload is received.
+ */
+static na_return_t
+na_tcp_rx_finish(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn);
+
+/**
+ * Make sure rx state can hold count payload segments.
+ */
+static na_return_t
+na_tcp_rx_iov_reserve(struct na_tcp_rx *rx, unsigned long count);
+
+/**
+ * Copy buffered bytes into rx payload segments.
+ */
+static NA_INLINE void
+na_tcp_rx_copy(struct na_tcp_rx *rx, size_t len);
+
+/**
+ * Make sure tx entry can hold iovcnt segments.
+ */
+static na_return_t
+na_tcp_tx_reserve(struct na_tcp_tx *tx, unsigned long iovcnt);
+
+/**
+ * Free resources allocated by tx entry.
+ */
+static void
+na_tcp_tx_free(struct na_tcp_tx *tx);
+
+/**
+ * Handle tx entry once it has been written or if it failed.
+ */
+static na_return_t
+na_tcp_tx_done(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_tx *tx, na_return_t ret);
+
+/**
+ * Queue tx entry on address connection and try to write it.
+ */
+static na_return_t
+na_tcp_send(struct na_tcp_class *na_tcp_class, struct na_tcp_addr *na_tcp_addr,
+    struct na_tcp_tx *tx);
+
+/**
+ * Send control msg carrying RMA status and segments of local memory.
+ */
+static na_return_t
+na_tcp_send_ctrl(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_addr *na_tcp_addr, na_tcp_msg_type_t type, na_uint64_t token,
+    na_return_t status, const struct iovec *iov, unsigned long iovcnt);
+
+/**
+ * Skip len bytes of segments.
+ */
+static NA_INLINE void
+na_tcp_iov_advance(struct iovec **iov, unsigned long *iovcnt, size_t len);
+
+/**
+ * Translate offset from mem_handle into usable iovec.
+ */
+static void
+na_tcp_offset_translate(struct na_tcp_mem_handle *mem_handle,
+    na_offset_t offset, na_size_t length, struct iovec *iov,
+    unsigned long *iovcnt);
+
+/**
+ * Look up the registered memory handle of an RMA descriptor received from a
+ * peer, check that it grants access and contains the requested range, and
+ * translate that range into rx segments.
+ */
+static na_return_t
+na_tcp_rma_desc_translate(struct na_tcp_class *na_tcp_class,
+    const struct na_tcp_rma_desc *desc, na_uint8_t access,
+    struct na_tcp_rx *rx);
+
+/**
+ * Remove RMA op ID matching token from queue.
+ */
+static struct na_tcp_op_id *
+na_tcp_rma_op_pop(struct na_tcp_op_queue *rma_op_queue, na_uint64_t token);
+
+/**
+ * Issue put/get.
+ */
+static na_return_t
+na_tcp_rma(na_class_t *na_class, na_context_t *context, na_cb_type_t cb_type,
+    na_cb_t callback, void *arg, struct na_tcp_mem_handle *local_mem_handle,
+    na_offset_t local_offset, struct na_tcp_mem_handle *remote_mem_handle,
+    na_offset_t remote_offset, na_size_t length, na_addr_t remote_addr,
+    na_op_id_t *op_id);
+
+/**
+ * Complete operation.
+ */
+static na_return_t
+na_tcp_complete(struct na_tcp_op_id *na_tcp_op_id, na_return_t op_ret);
+
+/**
+ * Release memory.
+ */
+static NA_INLINE void
+na_tcp_release(void *arg);
+
+/* check_protocol */
+static na_bool_t
+na_tcp_check_protocol(const char *protocol_name);
+
+/* initialize */
+static na_return_t
+na_tcp_initialize(
+    na_class_t *na_class, const struct na_info *na_info, na_bool_t listen);
+
+/* finalize */
+static na_return_t
+na_tcp_finalize(na_class_t *na_class);
+
+/* context_create */
+static na_return_t
+na_tcp_context_create(na_class_t *na_class, void **context, na_uint8_t id);
+
+/* context_destroy */
+static na_return_t
+na_tcp_context_destroy(na_class_t *na_class, void *context);
+
+/* op_create */
+static na_op_id_t
+na_tcp_op_create(na_class_t *na_class);
+
+/* op_destroy */
+static na_return_t
+na_tcp_op_destroy(na_class_t *na_class, na_op_id_t op_id);
+
+/* addr_lookup */
+static na_return_t
+na_tcp_addr_lookup(na_class_t *na_class, const char *name, na_addr_t *addr);
+
+/* addr_free */
+static na_return_t
+na_tcp_addr_free(na_class_t *na_class, na_addr_t addr);
+
+/* addr_self */
+static na_return_t
+na_tcp_addr_self(na_class_t *na_class, na_addr_t *addr);
+
+/* addr_dup */
+static na_return_t
+na_tcp_addr_dup(na_class_t *na_class, na_addr_t addr, na_addr_t *new_addr);
+
+/* addr_cmp */
+static na_bool_t
+na_tcp_addr_cmp(na_class_t *na_class, na_addr_t addr1, na_addr_t addr2);
+
+/* addr_is_self */
+static NA_INLINE na_bool_t
+na_tcp_addr_is_self(na_class_t *na_class, na_addr_t addr);
+
+/* addr_to_string */
+static na_return_t
+na_tcp_addr_to_string(
+    na_class_t *na_class, char *buf, na_size_t *buf_size, na_addr_t addr);
+
+/* addr_get_serialize_size */
+static NA_INLINE na_size_t
+na_tcp_addr_get_serialize_size(na_class_t *na_class, na_addr_t addr);
+
+/* addr_serialize */
+static na_return_t
+na_tcp_addr_serialize(
+    na_class_t *na_class, void *buf, na_size_t buf_size, na_addr_t addr);
+
+/* addr_deserialize */
+static na_return_t
+na_tcp_addr_deserialize(
+    na_class_t *na_class, na_addr_t *addr, const void *buf, na_size_t buf_size);
+
+/* msg_get_max_unexpected_size */
+static NA_INLINE na_size_t
+na_tcp_msg_get_max_unexpected_size(const na_class_t *na_class);
+
+/* msg_get_max_expected_size */
+static NA_INLINE na_size_t
+na_tcp_msg_get_max_expected_size(const na_class_t *na_class);
+
+/* msg_get_max_tag */
+static NA_INLINE na_tag_t
+na_tcp_msg_get_max_tag(const na_class_t *na_class);
+
+/* msg_send_unexpected */
+static na_return_t
+na_tcp_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
+    void *plugin_data, na_addr_t dest_addr, na_uint8_t dest_id, na_tag_t tag,
+    na_op_id_t *op_id);
+
+/* msg_recv_unexpected */
+static na_return_t
+na_tcp_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
+    void *plugin_data, na_op_id_t *op_id);
+
+/* msg_send_expected */
+static na_return_t
+na_tcp_msg_send_expected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
+    void *plugin_data, na_addr_t dest_addr, na_uint8_t dest_id, na_tag_t tag,
+    na_op_id_t *op_id);
+
+/* msg_recv_expected */
+static na_return_t
+na_tcp_msg_recv_expected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
+    void *plugin_data, na_addr_t source_addr, na_uint8_t source_id,
+    na_tag_t tag, na_op_id_t *op_id);
+
+/* mem_handle_create */
+static na_return_t
+na_tcp_mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
+    unsigned long flags, na_mem_handle_t *mem_handle);
+
+/* mem_handle_create_segments */
+static na_return_t
+na_tcp_mem_handle_create_segments(na_class_t *na_class,
+    struct na_segment *segments, na_size_t segment_count, unsigned long flags,
+    na_mem_handle_t *mem_handle);
+
+/* mem_handle_free */
+static na_return_t
+na_tcp_mem_handle_free(na_class_t *na_class, na_mem_handle_t mem_handle);
+
+/* mem_register */
+static na_return_t
+na_tcp_mem_register(na_class_t *na_class, na_mem_handle_t mem_handle);
+
+/* mem_deregister */
+static na_return_t
+na_tcp_mem_deregister(na_class_t *na_class, na_mem_handle_t mem_handle);
+
+/* mem_handle_get_serialize_size */
+static NA_INLINE na_size_t
+na_tcp_mem_handle_get_serialize_size(
+    na_class_t *na_class, na_mem_handle_t mem_handle);
+
+/* mem_handle_serialize */
+static na_return_t
+na_tcp_mem_handle_serialize(na_class_t *na_class, void *buf,
+    na_size_t buf_size, na_mem_handle_t mem_handle);
+
+/* mem_handle_deserialize */
+static na_return_t
+na_tcp_mem_handle_deserialize(na_class_t *na_class,
+    na_mem_handle_t *mem_handle, const void *buf, na_size_t buf_size);
+
+/* put */
+static na_return_t
+na_tcp_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
+    void *arg, na_mem_handle_t local_mem_handle, na_offset_t local_offset,
+    na_mem_handle_t remote_mem_handle, na_offset_t remote_offset,
+    na_size_t length, na_addr_t remote_addr, na_uint8_t remote_id,
+    na_op_id_t *op_id);
+
+/* get */
+static na_return_t
+na_tcp_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
+    void *arg, na_mem_handle_t local_mem_handle, na_offset_t local_offset,
+    na_mem_handle_t remote_mem_handle, na_offset_t remote_offset,
+    na_size_t length, na_addr_t remote_addr, na_uint8_t remote_id,
+    na_op_id_t *op_id);
+
+/* poll_get_fd */
+static NA_INLINE int
+na_tcp_poll_get_fd(na_class_t *na_class, na_context_t *context);
+
+/* poll_try_wait */
+static NA_INLINE na_bool_t
+na_tcp_poll_try_wait(na_class_t *na_class, na_context_t *context);
+
+/* progress */
+static na_return_t
+na_tcp_progress(
+    na_class_t *na_class, na_context_t *context, unsigned int timeout);
+
+/* cancel */
+static na_return_t
+na_tcp_cancel(na_class_t *na_class, na_context_t *context, na_op_id_t op_id);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+const struct na_class_ops NA_PLUGIN_OPS(tcp) = {
+    "tcp",                                /* name */
+    na_tcp_check_protocol,                /* check_protocol */
+    na_tcp_initialize,                    /* initialize */
+    na_tcp_finalize,                      /* finalize */
+    NULL,                                 /* cleanup */
+    na_tcp_context_create,                /* context_create */
+    na_tcp_context_destroy,               /* context_destroy */
+    na_tcp_op_create,                     /* op_create */
+    na_tcp_op_destroy,                    /* op_destroy */
+    na_tcp_addr_lookup,                   /* addr_lookup */
+    na_tcp_addr_free,                     /* addr_free */
+    NULL,                                 /* addr_set_remove */
+    na_tcp_addr_self,                     /* addr_self */
+    na_tcp_addr_dup,                      /* addr_dup */
+    na_tcp_addr_cmp,                      /* addr_cmp */
+    na_tcp_addr_is_self,                  /* addr_is_self */
+    na_tcp_addr_to_string,                /* addr_to_string */
+    na_tcp_addr_get_serialize_size,       /* addr_get_serialize_size */
+    na_tcp_addr_serialize,                /* addr_serialize */
+    na_tcp_addr_deserialize,              /* addr_deserialize */
+    na_tcp_msg_get_max_unexpected_size,   /* msg_get_max_unexpected_size */
+    na_tcp_msg_get_max_expected_size,     /* msg_get_max_expected_size */
+    NULL,                                 /* msg_get_unexpected_header_size */
+    NULL,                                 /* msg_get_expected_header_size */
+    na_tcp_msg_get_max_tag,               /* msg_get_max_tag */
+    NULL,                                 /* msg_buf_alloc */
+    NULL,                                 /* msg_buf_free */
+    NULL,                                 /* msg_init_unexpected */
+    na_tcp_msg_send_unexpected,           /* msg_send_unexpected */
+    na_tcp_msg_recv_unexpected,           /* msg_recv_unexpected */
+    NULL,                                 /* msg_init_expected */
+    na_tcp_msg_send_expected,             /* msg_send_expected */
+    na_tcp_msg_recv_expected,             /* msg_recv_expected */
+    NULL,                                 /* mem_alloc */
+    NULL,                                 /* mem_free */
+    na_tcp_mem_handle_create,             /* mem_handle_create */
+    na_tcp_mem_handle_create_segments,    /* mem_handle_create_segments */
+    na_tcp_mem_handle_free,               /* mem_handle_free */
+    na_tcp_mem_register,                  /* mem_register */
+    na_tcp_mem_deregister,                /* mem_deregister */
+    NULL,                                 /* mem_publish */
+    NULL,                                 /* mem_unpublish */
+    na_tcp_mem_handle_get_serialize_size, /* mem_handle_get_serialize_size */
+    na_tcp_mem_handle_serialize,          /* mem_handle_serialize */
+    na_tcp_mem_handle_deserialize,        /* mem_handle_deserialize */
+    na_tcp_put,                           /* put */
+    na_tcp_get,                           /* get */
+    na_tcp_poll_get_fd,                   /* poll_get_fd */
+    na_tcp_poll_try_wait,                 /* poll_try_wait */
+    na_tcp_progress,                      /* progress */
+    na_tcp_cancel                         /* cancel */
+};
+
+/********************/
+/* Plugin callbacks */
+/********************/
+
+static na_return_t
+na_tcp_errno_to_na(int rc)
+{
+    na_return_t ret;
+
+    switch (rc) {
+        case EPERM:
+            ret = NA_PERMISSION;
+            break;
+        case ENOENT:
+            ret = NA_NOENTRY;
+            break;
+        case EINTR:
+            ret = NA_INTERRUPT;
+            break;
+        case EAGAIN:
+            ret = NA_AGAIN;
+            break;
+        case ENOMEM:
+            ret = NA_NOMEM;
+            break;
+        case EACCES:
+            ret = NA_ACCESS;
+            break;
+        case EFAULT:
+            ret = NA_FAULT;
+            break;
+        case EBUSY:
+            ret = NA_BUSY;
+            break;
+        case EEXIST:
+            ret = NA_EXIST;
+            break;
+        case ENODEV:
+            ret = NA_NODEV;
+            break;
+        case EINVAL:
+            ret = NA_INVALID_ARG;
+            break;
+        case EOVERFLOW:
+        case ENAMETOOLONG:
+            ret = NA_OVERFLOW;
+            break;
+        case EMSGSIZE:
+            ret = NA_MSGSIZE;
+            break;
+        case EPROTONOSUPPORT:
+            ret = NA_PROTONOSUPPORT;
+            break;
+        case EOPNOTSUPP:
+            ret = NA_OPNOTSUPPORTED;
+            break;
+        case EADDRINUSE:
+            ret = NA_ADDRINUSE;
+            break;
+        case EADDRNOTAVAIL:
+        case ECONNREFUSED:
+        case EHOSTUNREACH:
+        case ENETUNREACH:
+            ret = NA_ADDRNOTAVAIL;
+            break;
+        case ETIMEDOUT:
+            ret = NA_TIMEOUT;
+            break;
+        case ECANCELED:
+            ret = NA_CANCELED;
+            break;
+        default:
+            ret = NA_PROTOCOL_ERROR;
+            break;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_uint64_t
+na_tcp_addr_to_key(const struct sockaddr_in *sin)
+{
+    return ((na_uint64_t) sin->sin_addr.s_addr) << 32 | sin->sin_port;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE unsigned int
+na_tcp_addr_key_hash(hg_hash_table_key_t vlocation)
+{
+    na_uint64_t key = *((na_uint64_t *) vlocation);
+
+    return (unsigned int) (key >> 32) ^ (unsigned int) (key & 0xffffffff);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE int
+na_tcp_addr_key_equal(
+    hg_hash_table_key_t vlocation1, hg_hash_table_key_t vlocation2)
+{
+    return *((na_uint64_t *) vlocation1) == *((na_uint64_t *) vlocation2);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_string_to_sin(
+    const char *str, na_bool_t passive, struct sockaddr_in *sin)
+{
+    struct addrinfo hints, *res = NULL;
+    char *name = NULL, *host, *port_str;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    /**
+     * Clean up name, strings can be of the format:
+     *   [<protocol>://]<host>:<port>
+     */
+    name = strdup(str);
+    NA_CHECK_ERROR(
+        name == NULL, done, ret, NA_NOMEM, "Could not duplicate string");
+
+    host = strstr(name, "://");
+    host = (host) ? host + 3 : name;
+
+    port_str = strrchr(host, ':');
+    if (port_str)
+        *port_str++ = '\0';
+    else
+        NA_CHECK_ERROR(!passive, done, ret, NA_INVALID_ARG,
+            "No port specified in %s", str);
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (passive)
+        hints.ai_flags = AI_PASSIVE;
+
+    rc = getaddrinfo((*host != '\0') ? host : NULL,
+        (port_str && *port_str != '\0') ? port_str : "0", &hints, &res);
+    NA_CHECK_ERROR(rc != 0, done, ret, NA_ADDRNOTAVAIL,
+        "getaddrinfo() failed for %s (%s)", str, gai_strerror(rc));
+
+    memcpy(sin, res->ai_addr, sizeof(*sin));
+
+done:
+    if (res)
+        freeaddrinfo(res);
+    free(name);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_sock_set_options(struct na_tcp_class *na_tcp_class, int fd)
+{
+    int rc;
+
+    if (na_tcp_class->nodelay) {
+        int nodelay = 1;
+
+        rc = setsockopt(
+            fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        NA_CHECK_WARNING(
+            rc != 0, "Could not set TCP_NODELAY (%s)", strerror(errno));
+    }
+
+#ifdef SO_BUSY_POLL
+    if (na_tcp_class->busy_poll > 0) {
+        rc = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &na_tcp_class->busy_poll,
+            sizeof(na_tcp_class->busy_poll));
+        NA_CHECK_WARNING(
+            rc != 0, "Could not set SO_BUSY_POLL (%s)", strerror(errno));
+    }
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_poll_register(
+    hg_poll_set_t *poll_set, int fd, unsigned int events, void *ptr)
+{
+    struct hg_poll_event event = {.events = events, .data.ptr = ptr};
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    rc = hg_poll_add(poll_set, fd, &event);
+    NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, na_tcp_errno_to_na(errno),
+        "hg_poll_add() failed");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_poll_deregister(hg_poll_set_t *poll_set, int fd)
+{
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    rc = hg_poll_remove(poll_set, fd);
+    NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, na_tcp_errno_to_na(errno),
+        "hg_poll_remove() failed");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_endpoint_open(struct na_tcp_class *na_tcp_class,
+    const char *host_name, const char *ip_subnet, na_bool_t listening)
+{
+    struct sockaddr_in sin;
+    na_bool_t listen_registered = NA_FALSE;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    na_tcp_class->listen_fd = -1;
+
+    /* Initialize queues */
+    HG_QUEUE_INIT(&na_tcp_class->unexpected_msg_queue.queue);
+    hg_thread_spin_init(&na_tcp_class->unexpected_msg_queue.lock);
+
+    HG_QUEUE_INIT(&na_tcp_class->unexpected_op_queue.queue);
+    hg_thread_spin_init(&na_tcp_class->unexpected_op_queue.lock);
+
+    HG_QUEUE_INIT(&na_tcp_class->expected_op_queue.queue);
+    hg_thread_spin_init(&na_tcp_class->expected_op_queue.lock);
+
+    HG_QUEUE_INIT(&na_tcp_class->rma_op_queue.queue);
+    hg_thread_spin_init(&na_tcp_class->rma_op_queue.lock);
+
+    /* Initialize connection list */
+    HG_LIST_INIT(&na_tcp_class->conn_list.list);
+    hg_thread_spin_init(&na_tcp_class->conn_list.lock);
+
+    hg_thread_mutex_init(&na_tcp_class->progress_lock);
+    hg_atomic_init64(&na_tcp_class->next_token, 0);
+    hg_atomic_init64(&na_tcp_class->next_key, 0);
+
+    /* Create addr hash-table */
+    na_tcp_class->addr_map.map =
+        hg_hash_table_new(na_tcp_addr_key_hash, na_tcp_addr_key_equal);
+    NA_CHECK_ERROR(na_tcp_class->addr_map.map == NULL, error, ret, NA_NOMEM,
+        "hg_hash_table_new() failed");
+    hg_hash_table_register_free_functions(
+        na_tcp_class->addr_map.map, free, NULL);
+    hg_thread_rwlock_init(&na_tcp_class->addr_map.lock);
+
+    /* Create hash-table of registered memory, keys are stored in handles */
+    na_tcp_class->mem_map.map =
+        hg_hash_table_new(na_tcp_addr_key_hash, na_tcp_addr_key_equal);
+    NA_CHECK_ERROR(na_tcp_class->mem_map.map == NULL, error, ret, NA_NOMEM,
+        "hg_hash_table_new() failed");
+    hg_thread_rwlock_init(&na_tcp_class->mem_map.lock);
+
+    /* Create poll set to wait for events, connections are always polled */
+    na_tcp_class->poll_set = hg_poll_create();
+    NA_CHECK_ERROR(na_tcp_class->poll_set == NULL, error, ret,
+        na_tcp_errno_to_na(errno), "Cannot create poll set");
+
+    if (listening) {
+        socklen_t sin_len = sizeof(sin);
+        int reuse = 1;
+
+        ret = na_tcp_string_to_sin(
+            (host_name) ? host_name : "", NA_TRUE, &sin);
+        NA_CHECK_NA_ERROR(error, ret, "Could not resolve listening address");
+
+        na_tcp_class->listen_fd =
+            socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        NA_CHECK_ERROR(na_tcp_class->listen_fd == -1, error, ret,
+            na_tcp_errno_to_na(errno), "socket() failed (%s)",
+            strerror(errno));
+
+        rc = setsockopt(na_tcp_class->listen_fd, SOL_SOCKET, SO_REUSEADDR,
+            &reuse, sizeof(reuse));
+        NA_CHECK_ERROR(rc == -1, error, ret, na_tcp_errno_to_na(errno),
+            "setsockopt() failed (%s)", strerror(errno));
+
+        rc = bind(na_tcp_class->listen_fd, (struct sockaddr *) &sin,
+            sizeof(sin));
+        NA_CHECK_ERROR(rc == -1, error, ret, na_tcp_errno_to_na(errno),
+            "bind() failed (%s)", strerror(errno));
+
+        rc = listen(na_tcp_class->listen_fd, SOMAXCONN);
+        NA_CHECK_ERROR(rc == -1, error, ret, na_tcp_errno_to_na(errno),
+            "listen() failed (%s)", strerror(errno));
+
+        /* Retrieve port if it was picked by the system */
+        rc = getsockname(
+            na_tcp_class->listen_fd, (struct sockaddr *) &sin, &sin_len);
+        NA_CHECK_ERROR(rc == -1, error, ret, na_tcp_errno_to_na(errno),
+            "getsockname() failed (%s)", strerror(errno));
+
+        na_tcp_class->listen_poll_type = NA_TCP_POLL_LISTEN;
+        ret = na_tcp_poll_register(na_tcp_class->poll_set,
+            na_tcp_class->listen_fd, HG_POLLIN,
+            &na_tcp_class->listen_poll_type);
+        NA_CHECK_NA_ERROR(error, ret, "Could not add listen fd to poll set");
+        listen_registered = NA_TRUE;
+    } else {
+        /* Peers cannot connect back to us, port remains 0 */
+        memset(&sin, 0, sizeof(sin));
+        sin.sin_family = AF_INET;
+    }
+
+    /* Pick preferred IP if bound to any address */
+    if (sin.sin_addr.s_addr == htonl(INADDR_ANY)) {
+        na_uint32_t subnet = 0, netmask = 0;
+        char pref_anyip[16];
+
+        if (ip_subnet) {
+            ret = na_ip_parse_subnet(ip_subnet, &subnet, &netmask);
+            NA_CHECK_NA_ERROR(error, ret, "na_ip_parse_subnet() failed");
+        }
+        ret = na_ip_pref_addr(subnet, netmask, pref_anyip);
+        NA_CHECK_NA_ERROR(error, ret, "na_ip_pref_addr() failed");
+
+        rc = inet_pton(AF_INET, pref_anyip, &sin.sin_addr);
+        NA_CHECK_ERROR(rc != 1, error, ret, NA_ADDRNOTAVAIL,
+            "inet_pton() failed for %s", pref_anyip);
+    }
+
+    /* Create self address, listening addresses are kept in the map so that
+     * connections to self are recognized */
+    if (listening)
+        ret = na_tcp_addr_map_get(
+            &na_tcp_class->addr_map, &sin, &na_tcp_class->self_addr);
+    else {
+        na_tcp_class->self_addr = na_tcp_addr_create(&sin);
+        if (na_tcp_class->self_addr == NULL)
+            ret = NA_NOMEM;
+    }
+    NA_CHECK_NA_ERROR(error, ret, "Could not create self address");
+
+    NA_LOG_DEBUG("Opened endpoint %s:%d", inet_ntoa(sin.sin_addr),
+        ntohs(sin.sin_port));
+
+    return ret;
+
+error:
+    if (listen_registered)
+        na_tcp_poll_deregister(na_tcp_class->poll_set, na_tcp_class->listen_fd);
+    if (na_tcp_class->listen_fd != -1) {
+        close(na_tcp_class->listen_fd);
+        na_tcp_class->listen_fd = -1;
+    }
+    if (na_tcp_class->poll_set) {
+        hg_poll_destroy(na_tcp_class->poll_set);
+        na_tcp_class->poll_set = NULL;
+    }
+    if (na_tcp_class->addr_map.map) {
+        hg_hash_table_iter_t iter;
+
+        /* Release addresses that were inserted */
+        hg_hash_table_iterate(na_tcp_class->addr_map.map, &iter);
+        while (hg_hash_table_iter_has_more(&iter))
+            na_tcp_addr_release((struct na_tcp_addr *) hg_hash_table_iter_next(
+                &iter));
+        hg_hash_table_free(na_tcp_class->addr_map.map);
+        na_tcp_class->addr_map.map = NULL;
+        hg_thread_rwlock_destroy(&na_tcp_class->addr_map.lock);
+    }
+    if (na_tcp_class->mem_map.map) {
+        hg_hash_table_free(na_tcp_class->mem_map.map);
+        na_tcp_class->mem_map.map = NULL;
+        hg_thread_rwlock_destroy(&na_tcp_class->mem_map.lock);
+    }
+
+    hg_thread_mutex_destroy(&na_tcp_class->progress_lock);
+    hg_thread_spin_destroy(&na_tcp_class->unexpected_msg_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->unexpected_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->expected_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->rma_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->conn_list.lock);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_endpoint_close(struct na_tcp_class *na_tcp_class)
+{
+    struct na_tcp_conn *conn;
+    na_return_t ret = NA_SUCCESS;
+    na_bool_t empty;
+
+    /* Check that unexpected message queue is empty */
+    hg_thread_spin_lock(&na_tcp_class->unexpected_msg_queue.lock);
+    empty = HG_QUEUE_IS_EMPTY(&na_tcp_class->unexpected_msg_queue.queue);
+    hg_thread_spin_unlock(&na_tcp_class->unexpected_msg_queue.lock);
+    NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
+        "Unexpected msg queue should be empty");
+
+    /* Check that unexpected op queue is empty */
+    hg_thread_spin_lock(&na_tcp_class->unexpected_op_queue.lock);
+    empty = HG_QUEUE_IS_EMPTY(&na_tcp_class->unexpected_op_queue.queue);
+    hg_thread_spin_unlock(&na_tcp_class->unexpected_op_queue.lock);
+    NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
+        "Unexpected op queue should be empty");
+
+    /* Check that expected op queue is empty */
+    hg_thread_spin_lock(&na_tcp_class->expected_op_queue.lock);
+    empty = HG_QUEUE_IS_EMPTY(&na_tcp_class->expected_op_queue.queue);
+    hg_thread_spin_unlock(&na_tcp_class->expected_op_queue.lock);
+    NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
+        "Expected op queue should be empty");
+
+    /* Check that RMA op queue is empty */
+    hg_thread_spin_lock(&na_tcp_class->rma_op_queue.lock);
+    empty = HG_QUEUE_IS_EMPTY(&na_tcp_class->rma_op_queue.queue);
+    hg_thread_spin_unlock(&na_tcp_class->rma_op_queue.lock);
+    NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
+        "RMA op queue should be empty");
+
+    /* Close remaining connections */
+    hg_thread_spin_lock(&na_tcp_class->conn_list.lock);
+    while ((conn = HG_LIST_FIRST(&na_tcp_class->conn_list.list)) != NULL) {
+        hg_thread_spin_unlock(&na_tcp_class->conn_list.lock);
+        na_tcp_conn_close(na_tcp_class, conn);
+        hg_thread_spin_lock(&na_tcp_class->conn_list.lock);
+    }
+    hg_thread_spin_unlock(&na_tcp_class->conn_list.lock);
+
+    if (na_tcp_class->listen_fd != -1) {
+        ret = na_tcp_poll_deregister(
+            na_tcp_class->poll_set, na_tcp_class->listen_fd);
+        NA_CHECK_NA_ERROR(done, ret, "na_tcp_poll_deregister() failed");
+
+        close(na_tcp_class->listen_fd);
+        na_tcp_class->listen_fd = -1;
+    }
+
+    if (na_tcp_class->poll_set) {
+        int rc = hg_poll_destroy(na_tcp_class->poll_set);
+        NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret,
+            na_tcp_errno_to_na(errno), "hg_poll_destroy() failed");
+
+        na_tcp_class->poll_set = NULL;
+    }
+
+    /* Release self address */
+    if (na_tcp_class->self_addr) {
+        na_tcp_addr_release(na_tcp_class->self_addr);
+        na_tcp_class->self_addr = NULL;
+    }
+
+    /* Release cached addresses and free hash table */
+    if (na_tcp_class->addr_map.map) {
+        hg_hash_table_iter_t iter;
+
+        hg_hash_table_iterate(na_tcp_class->addr_map.map, &iter);
+        while (hg_hash_table_iter_has_more(&iter))
+            na_tcp_addr_release((struct na_tcp_addr *) hg_hash_table_iter_next(
+                &iter));
+        hg_hash_table_free(na_tcp_class->addr_map.map);
+        na_tcp_class->addr_map.map = NULL;
+        hg_thread_rwlock_destroy(&na_tcp_class->addr_map.lock);
+    }
+    if (na_tcp_class->mem_map.map) {
+        hg_hash_table_free(na_tcp_class->mem_map.map);
+        na_tcp_class->mem_map.map = NULL;
+        hg_thread_rwlock_destroy(&na_tcp_class->mem_map.lock);
+    }
+
+    /* Destroy mutexes */
+    hg_thread_mutex_destroy(&na_tcp_class->progress_lock);
+    hg_thread_spin_destroy(&na_tcp_class->unexpected_msg_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->unexpected_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->expected_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->rma_op_queue.lock);
+    hg_thread_spin_destroy(&na_tcp_class->conn_list.lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct na_tcp_addr *
+na_tcp_addr_create(const struct sockaddr_in *sin)
+{
+    struct na_tcp_addr *na_tcp_addr = NULL;
+
+    na_tcp_addr = (struct na_tcp_addr *) malloc(sizeof(struct na_tcp_addr));
+    NA_CHECK_ERROR_NORET(
+        na_tcp_addr == NULL, done, "Could not allocate NA TCP addr");
+    memset(na_tcp_addr, 0, sizeof(struct na_tcp_addr));
+
+    na_tcp_addr->sin = *sin;
+    hg_thread_mutex_init(&na_tcp_addr->lock);
+    hg_atomic_init32(&na_tcp_addr->ref_count, 1);
+
+done:
+    return na_tcp_addr;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_addr_release(struct na_tcp_addr *na_tcp_addr)
+{
+    if (hg_atomic_decr32(&na_tcp_addr->ref_count))
+        /* Cannot free yet */
+        return;
+
+    NA_LOG_DEBUG("Freeing addr %s:%d", inet_ntoa(na_tcp_addr->sin.sin_addr),
+        ntohs(na_tcp_addr->sin.sin_port));
+
+    hg_thread_mutex_destroy(&na_tcp_addr->lock);
+    free(na_tcp_addr);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_map_get(struct na_tcp_map *na_tcp_map,
+    const struct sockaddr_in *sin, struct na_tcp_addr **addr)
+{
+    struct na_tcp_addr *na_tcp_addr = NULL;
+    na_uint64_t key = na_tcp_addr_to_key(sin);
+    hg_hash_table_key_t key_ptr = (hg_hash_table_key_t) &key;
+    hg_hash_table_value_t value;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    /* Lookup key */
+    hg_thread_rwlock_rdlock(&na_tcp_map->lock);
+    value = hg_hash_table_lookup(na_tcp_map->map, key_ptr);
+    if (value != HG_HASH_TABLE_NULL) {
+        na_tcp_addr = (struct na_tcp_addr *) value;
+        hg_atomic_incr32(&na_tcp_addr->ref_count);
+    }
+    hg_thread_rwlock_release_rdlock(&na_tcp_map->lock);
+    if (na_tcp_addr)
+        goto done;
+
+    hg_thread_rwlock_wrlock(&na_tcp_map->lock);
+
+    /* Look up again to prevent race between lock release/acquire */
+    value = hg_hash_table_lookup(na_tcp_map->map, key_ptr);
+    if (value != HG_HASH_TABLE_NULL) {
+        na_tcp_addr = (struct na_tcp_addr *) value;
+        hg_atomic_incr32(&na_tcp_addr->ref_count);
+        goto unlock;
+    }
+
+    /* Allocate new key */
+    key_ptr = (hg_hash_table_key_t) malloc(sizeof(na_uint64_t));
+    NA_CHECK_ERROR(key_ptr == NULL, unlock, ret, NA_NOMEM,
+        "Cannot allocate memory for new addr key");
+    *((na_uint64_t *) key_ptr) = key;
+
+    /* Map keeps one reference to the address until finalize */
+    na_tcp_addr = na_tcp_addr_create(sin);
+    NA_CHECK_ERROR(na_tcp_addr == NULL, error, ret, NA_NOMEM,
+        "Could not create new address");
+
+    rc = hg_hash_table_insert(
+        na_tcp_map->map, key_ptr, (hg_hash_table_value_t) na_tcp_addr);
+    NA_CHECK_ERROR(
+        rc == 0, error, ret, NA_NOMEM, "hg_hash_table_insert() failed");
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+
+unlock:
+    hg_thread_rwlock_release_wrlock(&na_tcp_map->lock);
+
+done:
+    *addr = na_tcp_addr;
+
+    return ret;
+
+error:
+    hg_thread_rwlock_release_wrlock(&na_tcp_map->lock);
+    if (na_tcp_addr)
+        na_tcp_addr_release(na_tcp_addr);
+    free(key_ptr);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_conn_create(struct na_tcp_class *na_tcp_class, int fd,
+    struct na_tcp_addr *na_tcp_addr, na_tcp_conn_state_t state,
+    struct na_tcp_conn **conn_ptr)
+{
+    struct na_tcp_conn *conn = NULL;
+    na_return_t ret = NA_SUCCESS;
+
+    conn = (struct na_tcp_conn *) malloc(sizeof(struct na_tcp_conn));
+    NA_CHECK_ERROR(conn == NULL, error, ret, NA_NOMEM,
+        "Could not allocate NA TCP connection");
+    memset(conn, 0, sizeof(struct na_tcp_conn));
+
+    conn->rx.buf = (char *) malloc(NA_TCP_RX_BUF_SIZE);
+    NA_CHECK_ERROR(conn->rx.buf == NULL, error, ret, NA_NOMEM,
+        "Could not allocate receive buffer");
+    conn->rx.stage = NA_TCP_RX_HDR;
+
+    HG_QUEUE_INIT(&conn->tx_queue);
+    conn->fd = fd;
+    conn->state = state;
+    conn->poll_type = NA_TCP_POLL_CONN;
+    conn->poll_events = HG_POLLIN;
+    /* Wait for connection to be established */
+    if (state == NA_TCP_CONN_CONNECTING)
+        conn->poll_events |= HG_POLLOUT;
+
+    /* Peer address is only known after handshake for accepted connections */
+    if (na_tcp_addr) {
+        hg_atomic_incr32(&na_tcp_addr->ref_count);
+        conn->na_tcp_addr = na_tcp_addr;
+    }
+
+    /* Register connection once it is ready to be progressed */
+    ret = na_tcp_poll_register(
+        na_tcp_class->poll_set, fd, conn->poll_events, &conn->poll_type);
+    NA_CHECK_NA_ERROR(error, ret, "Could not add connection to poll set");
+
+    hg_thread_spin_lock(&na_tcp_class->conn_list.lock);
+    HG_LIST_INSERT_HEAD(&na_tcp_class->conn_list.list, conn, entry);
+    hg_thread_spin_unlock(&na_tcp_class->conn_list.lock);
+
+    NA_LOG_DEBUG("Created connection (fd=%d)", fd);
+
+    *conn_ptr = conn;
+
+    return ret;
+
+error:
+    if (conn) {
+        if (conn->na_tcp_addr)
+            na_tcp_addr_release(conn->na_tcp_addr);
+        free(conn->rx.buf);
+        free(conn);
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_conn_connect(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_addr *na_tcp_addr)
+{
+    struct na_tcp_conn *conn = NULL;
+    struct na_tcp_tx *hello_tx;
+    na_tcp_conn_state_t state = NA_TCP_CONN_CONNECTED;
+    na_return_t ret = NA_SUCCESS;
+    int fd = -1, rc;
+
+    NA_CHECK_ERROR(na_tcp_addr->sin.sin_port == 0, error, ret,
+        NA_ADDRNOTAVAIL, "Peer is not listening, cannot connect");
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    NA_CHECK_ERROR(fd == -1, error, ret, na_tcp_errno_to_na(errno),
+        "socket() failed (%s)", strerror(errno));
+
+    na_tcp_sock_set_options(na_tcp_class, fd);
+
+    rc = connect(
+        fd, (struct sockaddr *) &na_tcp_addr->sin, sizeof(na_tcp_addr->sin));
+    if (rc == -1) {
+        NA_CHECK_ERROR(errno != EINPROGRESS, error, ret,
+            na_tcp_errno_to_na(errno), "connect() to %s:%d failed (%s)",
+            inet_ntoa(na_tcp_addr->sin.sin_addr),
+            ntohs(na_tcp_addr->sin.sin_port), strerror(errno));
+        state = NA_TCP_CONN_CONNECTING;
+    }
+
+    ret = na_tcp_conn_create(na_tcp_class, fd, na_tcp_addr, state, &conn);
+    NA_CHECK_NA_ERROR(error, ret, "Could not create connection");
+
+    /* Handshake is always the first msg sent */
+    conn->hello.s_addr = na_tcp_class->self_addr->sin.sin_addr.s_addr;
+    conn->hello.port = na_tcp_class->self_addr->sin.sin_port;
+
+    hello_tx = &conn->hello_tx;
+    hello_tx->hdr.type = NA_TCP_HELLO;
+    hello_tx->hdr.size = sizeof(conn->hello);
+    hello_tx->iov_inline[0].iov_base = &hello_tx->hdr;
+    hello_tx->iov_inline[0].iov_len = sizeof(hello_tx->hdr);
+    hello_tx->iov_inline[1].iov_base = &conn->hello;
+    hello_tx->iov_inline[1].iov_len = sizeof(conn->hello);
+    hello_tx->iov = hello_tx->iov_inline;
+    hello_tx->iovcnt = 2;
+    HG_QUEUE_PUSH_TAIL(&conn->tx_queue, hello_tx, entry);
+
+    na_tcp_addr->conn = conn;
+
+    NA_LOG_DEBUG("Connecting to %s:%d (fd=%d)",
+        inet_ntoa(na_tcp_addr->sin.sin_addr), ntohs(na_tcp_addr->sin.sin_port),
+        fd);
+
+    return ret;
+
+error:
+    if (fd != -1)
+        close(fd);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_conn_close(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn)
+{
+    struct na_tcp_addr *na_tcp_addr = conn->na_tcp_addr;
+    struct na_tcp_rx *rx = &conn->rx;
+    struct na_tcp_tx *tx;
+    na_bool_t detached = NA_FALSE;
+
+    NA_LOG_DEBUG("Closing connection (fd=%d)", conn->fd);
+
+    hg_thread_spin_lock(&na_tcp_class->conn_list.lock);
+    HG_LIST_REMOVE(conn, entry);
+    hg_thread_spin_unlock(&na_tcp_class->conn_list.lock);
+
+    /* Operation that was receiving payload */
+    if (rx->na_tcp_op_id) {
+        struct na_tcp_op_id *na_tcp_op_id = rx->na_tcp_op_id;
+
+        /* Unexpected receives can be matched with another msg */
+        if (na_tcp_op_id->completion_data.callback_info.type ==
+                NA_CB_RECV_UNEXPECTED &&
+            !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_CANCELED)) {
+            struct na_tcp_op_queue *unexpected_op_queue =
+                &na_tcp_class->unexpected_op_queue;
+
+            hg_thread_spin_lock(&unexpected_op_queue->lock);
+            HG_QUEUE_PUSH_TAIL(
+                &unexpected_op_queue->queue, na_tcp_op_id, entry);
+            hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_QUEUED);
+            hg_thread_spin_unlock(&unexpected_op_queue->lock);
+        } else
+            na_tcp_complete(na_tcp_op_id, NA_PROTOCOL_ERROR);
+    }
+    free(rx->unexpected_info);
+
+    /* Senders access the connection through the address, detach it first */
+    if (na_tcp_addr) {
+        hg_thread_mutex_lock(&na_tcp_addr->lock);
+        if (na_tcp_addr->conn == conn)
+            na_tcp_addr->conn = NULL;
+        detached = (na_tcp_addr->conn == NULL);
+    }
+
+    na_tcp_poll_deregister(na_tcp_class->poll_set, conn->fd);
+    close(conn->fd);
+
+    /* Fail pending sends */
+    while ((tx = HG_QUEUE_FIRST(&conn->tx_queue)) != NULL) {
+        HG_QUEUE_POP_HEAD(&conn->tx_queue, entry);
+        na_tcp_tx_done(na_tcp_class, tx, NA_PROTOCOL_ERROR);
+    }
+
+    if (na_tcp_addr) {
+        hg_thread_mutex_unlock(&na_tcp_addr->lock);
+
+        /* Replies to RMA operations can no longer be received */
+        if (detached) {
+            struct na_tcp_op_queue *rma_op_queue = &na_tcp_class->rma_op_queue;
+            HG_QUEUE_HEAD(na_tcp_op_id) failed_queue;
+            struct na_tcp_op_id *na_tcp_op_id, *next;
+
+            HG_QUEUE_INIT(&failed_queue);
+
+            hg_thread_spin_lock(&rma_op_queue->lock);
+            na_tcp_op_id = HG_QUEUE_FIRST(&rma_op_queue->queue);
+            while (na_tcp_op_id) {
+                next = HG_QUEUE_NEXT(na_tcp_op_id, entry);
+                if (na_tcp_op_id->na_tcp_addr == na_tcp_addr) {
+                    HG_QUEUE_REMOVE(&rma_op_queue->queue, na_tcp_op_id,
+                        na_tcp_op_id, entry);
+                    hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+                    HG_QUEUE_PUSH_TAIL(&failed_queue, na_tcp_op_id, entry);
+                }
+                na_tcp_op_id = next;
+            }
+            hg_thread_spin_unlock(&rma_op_queue->lock);
+
+            while ((na_tcp_op_id = HG_QUEUE_FIRST(&failed_queue)) != NULL) {
+                HG_QUEUE_POP_HEAD(&failed_queue, entry);
+                na_tcp_complete(na_tcp_op_id, NA_PROTOCOL_ERROR);
+            }
+        }
+
+        na_tcp_addr_release(na_tcp_addr);
+    }
+
+    free(rx->buf);
+    free(rx->iov_alloc);
+    free(conn);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_conn_poll_update(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_conn *conn, unsigned int events)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (conn->poll_events == events)
+        goto done;
+
+    /* Poll sets do not support modifying events, register fd again */
+    ret = na_tcp_poll_deregister(na_tcp_class->poll_set, conn->fd);
+    NA_CHECK_NA_ERROR(done, ret, "Could not remove connection from poll set");
+
+    ret = na_tcp_poll_register(
+        na_tcp_class->poll_set, conn->fd, events, &conn->poll_type);
+    NA_CHECK_NA_ERROR(done, ret, "Could not add connection to poll set");
+
+    conn->poll_events = events;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_conn_write(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn)
+{
+    struct na_tcp_tx *tx;
+    na_return_t ret = NA_SUCCESS;
+
+    while ((tx = HG_QUEUE_FIRST(&conn->tx_queue)) != NULL) {
+        struct msghdr msg;
+        ssize_t nwrite;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = tx->iov;
+        msg.msg_iovlen = MIN(tx->iovcnt, IOV_MAX);
+
+        /* Peer may have closed the connection, do not raise SIGPIPE */
+        nwrite = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (nwrite == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EINTR)
+                continue;
+            NA_GOTO_ERROR(done, ret, na_tcp_errno_to_na(errno),
+                "sendmsg() failed (%s)", strerror(errno));
+        }
+
+        tx->started = NA_TRUE;
+        na_tcp_iov_advance(&tx->iov, &tx->iovcnt, (size_t) nwrite);
+        if (tx->iovcnt > 0)
+            continue;
+
+        HG_QUEUE_POP_HEAD(&conn->tx_queue, entry);
+        ret = na_tcp_tx_done(na_tcp_class, tx, NA_SUCCESS);
+        NA_CHECK_NA_ERROR(done, ret, "Could not complete tx");
+    }
+
+    /* Only wait for socket to be writable if something is left to write */
+    ret = na_tcp_conn_poll_update(na_tcp_class, conn,
+        HG_QUEUE_IS_EMPTY(&conn->tx_queue) ? HG_POLLIN
+                                           : HG_POLLIN | HG_POLLOUT);
+    NA_CHECK_NA_ERROR(done, ret, "Could not update poll events");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_conn_read(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn,
+    na_bool_t *closed)
+{
+    struct na_tcp_rx *rx = &conn->rx;
+    na_bool_t drained = NA_FALSE;
+    na_return_t ret = NA_SUCCESS;
+
+    for (;;) {
+        ssize_t nread;
+        size_t len;
+
+        /* Process buffered bytes */
+        while (rx->buf_head < rx->buf_tail) {
+            if (rx->stage == NA_TCP_RX_HDR) {
+                len = MIN(rx->buf_tail - rx->buf_head,
+                    sizeof(rx->hdr) - rx->hdr_len);
+                memcpy((char *) &rx->hdr + rx->hdr_len,
+                    rx->buf + rx->buf_head, len);
+                rx->buf_head += len;
+                rx->hdr_len += len;
+                if (rx->hdr_len < sizeof(rx->hdr))
+                    continue;
+
+                ret = na_tcp_rx_start(na_tcp_class, conn);
+                NA_CHECK_NA_ERROR(done, ret, "Could not start receiving msg");
+            } else {
+                len = MIN(rx->buf_tail - rx->buf_head, rx->remaining);
+                na_tcp_rx_copy(rx, len);
+                if (rx->remaining > 0)
+                    continue;
+
+                ret = na_tcp_rx_finish(na_tcp_class, conn);
+                NA_CHECK_NA_ERROR(done, ret, "Could not finish receiving msg");
+            }
+        }
+        rx->buf_head = rx->buf_tail = 0;
+
+        /* Last read did not fill up the buffer, wait for next event */
+        if (drained)
+            break;
+
+        if (rx->stage != NA_TCP_RX_HDR && rx->iov &&
+            rx->remaining >= NA_TCP_RX_DIRECT_SIZE) {
+            /* Large payloads are read directly into their destination */
+            nread = readv(conn->fd, rx->iov, (int) MIN(rx->iovcnt, IOV_MAX));
+            if (nread > 0) {
+                drained = ((size_t) nread < rx->remaining);
+                na_tcp_iov_advance(&rx->iov, &rx->iovcnt, (size_t) nread);
+                rx->remaining -= (size_t) nread;
+                if (rx->remaining == 0) {
+                    ret = na_tcp_rx_finish(na_tcp_class, conn);
+                    NA_CHECK_NA_ERROR(
+                        done, ret, "Could not finish receiving msg");
+                }
+                continue;
+            }
+        } else {
+            nread = recv(conn->fd, rx->buf, NA_TCP_RX_BUF_SIZE, 0);
+            if (nread > 0) {
+                drained = ((size_t) nread < NA_TCP_RX_BUF_SIZE);
+                rx->buf_tail = (size_t) nread;
+                continue;
+            }
+        }
+
+        if (nread == 0) {
+            NA_LOG_DEBUG("Connection closed by peer (fd=%d)", conn->fd);
+            *closed = NA_TRUE;
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+        if (errno == EINTR)
+            continue;
+        NA_GOTO_ERROR(done, ret, na_tcp_errno_to_na(errno),
+            "recv() failed (%s)", strerror(errno));
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_process_hello(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn)
+{
+    struct na_tcp_addr *na_tcp_addr = NULL;
+    struct sockaddr_in sin;
+    na_return_t ret = NA_SUCCESS;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = conn->rx.hello.s_addr;
+    sin.sin_port = (in_port_t) conn->rx.hello.port;
+
+    if (sin.sin_port == 0) {
+        /* Peer is not listening, address is only valid with connection */
+        na_tcp_addr = na_tcp_addr_create(&sin);
+        NA_CHECK_ERROR(na_tcp_addr == NULL, done, ret, NA_NOMEM,
+            "Could not create new address");
+    } else {
+        ret = na_tcp_addr_map_get(&na_tcp_class->addr_map, &sin, &na_tcp_addr);
+        NA_CHECK_NA_ERROR(done, ret, "Could not get address");
+    }
+
+    NA_LOG_DEBUG("Accepted connection from %s:%d (fd=%d)",
+        inet_ntoa(sin.sin_addr), ntohs(sin.sin_port), conn->fd);
+
+    /* Connection keeps reference to address */
+    conn->na_tcp_addr = na_tcp_addr;
+
+    /* Reply on that connection unless there is one already */
+    hg_thread_mutex_lock(&na_tcp_addr->lock);
+    if (na_tcp_addr->conn == NULL)
+        na_tcp_addr->conn = conn;
+    hg_thread_mutex_unlock(&na_tcp_addr->lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_rx_start(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn)
+{
+    struct na_tcp_rx *rx = &conn->rx;
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    na_return_t ret = NA_SUCCESS;
+
+    rx->hdr_len = 0;
+    rx->iov = NULL;
+    rx->iovcnt = 0;
+    rx->remaining = (size_t) rx->hdr.size;
+    rx->na_tcp_op_id = NULL;
+    rx->unexpected_info = NULL;
+    rx->ret = NA_SUCCESS;
+    rx->stage = NA_TCP_RX_DATA;
+
+    /* Nothing but a handshake can be received until the peer is known */
+    NA_CHECK_ERROR(
+        (conn->na_tcp_addr == NULL) != (rx->hdr.type == NA_TCP_HELLO), done,
+        ret, NA_PROTOCOL_ERROR, "Unexpected msg type (%u)", rx->hdr.type);
+
+    switch (rx->hdr.type) {
+        case NA_TCP_HELLO:
+            NA_CHECK_ERROR(rx->hdr.size != sizeof(rx->hello), done, ret,
+                NA_PROTOCOL_ERROR, "Invalid handshake size (%" PRIu64 ")",
+                rx->hdr.size);
+            rx->iov_single.iov_base = &rx->hello;
+            rx->iov_single.iov_len = sizeof(rx->hello);
+            rx->iov = &rx->iov_single;
+            rx->iovcnt = 1;
+            break;
+        case NA_TCP_UNEXPECTED: {
+            struct na_tcp_op_queue *unexpected_op_queue =
+                &na_tcp_class->unexpected_op_queue;
+
+            NA_CHECK_ERROR(rx->hdr.size > NA_TCP_UNEXPECTED_SIZE, done, ret,
+                NA_PROTOCOL_ERROR, "Exceeds unexpected size, %" PRIu64,
+                rx->hdr.size);
+
+            /* Receive directly into posted buffer if there is one */
+            hg_thread_spin_lock(&unexpected_op_queue->lock);
+            na_tcp_op_id = HG_QUEUE_FIRST(&unexpected_op_queue->queue);
+            if (na_tcp_op_id) {
+                HG_QUEUE_POP_HEAD(&unexpected_op_queue->queue, entry);
+                hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+            }
+            hg_thread_spin_unlock(&unexpected_op_queue->lock);
+
+            if (na_tcp_op_id) {
+                rx->na_tcp_op_id = na_tcp_op_id;
+                if (rx->hdr.size > na_tcp_op_id->info.msg.buf_size) {
+                    rx->ret = NA_MSGSIZE;
+                    break;
+                }
+                rx->iov_single.iov_base = na_tcp_op_id->info.msg.buf.ptr;
+            } else {
+                struct na_tcp_unexpected_info *na_tcp_unexpected_info;
+
+                /* Buffer is allocated along with info */
+                na_tcp_unexpected_info =
+                    (struct na_tcp_unexpected_info *) malloc(
+                        sizeof(struct na_tcp_unexpected_info) +
+                        (size_t) rx->hdr.size);
+                NA_CHECK_ERROR(na_tcp_unexpected_info == NULL, done, ret,
+                    NA_NOMEM, "Could not allocate unexpected info");
+                na_tcp_unexpected_info->buf = na_tcp_unexpected_info + 1;
+                na_tcp_unexpected_info->buf_size = (na_size_t) rx->hdr.size;
+                na_tcp_unexpected_info->na_tcp_addr = NULL;
+                rx->unexpected_info = na_tcp_unexpected_info;
+
+                rx->iov_single.iov_base = na_tcp_unexpected_info->buf;
+            }
+            rx->iov_single.iov_len = (size_t) rx->hdr.size;
+            rx->iov = &rx->iov_single;
+            rx->iovcnt = 1;
+        } break;
+        case NA_TCP_EXPECTED: {
+            struct na_tcp_op_queue *expected_op_queue =
+                &na_tcp_class->expected_op_queue;
+
+            /* Match posted receive with source and tag */
+            hg_thread_spin_lock(&expected_op_queue->lock);
+            HG_QUEUE_FOREACH (na_tcp_op_id, &expected_op_queue->queue, entry) {
+                if (na_tcp_op_id->na_tcp_addr == conn->na_tcp_addr &&
+                    na_tcp_op_id->info.msg.tag == rx->hdr.tag) {
+                    HG_QUEUE_REMOVE(&expected_op_queue->queue, na_tcp_op_id,
+                        na_tcp_op_id, entry);
+                    hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+                    break;
+                }
+            }
+            hg_thread_spin_unlock(&expected_op_queue->lock);
+
+            if (na_tcp_op_id == NULL) {
+                NA_LOG_WARNING("Ignoring expected msg with tag %u, no "
+                               "matching receive was posted",
+                    rx->hdr.tag);
+                break;
+            }
+
+            rx->na_tcp_op_id = na_tcp_op_id;
+            if (rx->hdr.size > na_tcp_op_id->info.msg.buf_size) {
+                rx->ret = NA_MSGSIZE;
+                break;
+            }
+            na_tcp_op_id->info.msg.actual_buf_size = (na_size_t) rx->hdr.size;
+
+            rx->iov_single.iov_base = na_tcp_op_id->info.msg.buf.ptr;
+            rx->iov_single.iov_len = (size_t) rx->hdr.size;
+            rx->iov = &rx->iov_single;
+            rx->iovcnt = 1;
+        } break;
+        case NA_TCP_PUT:
+        case NA_TCP_GET:
+            NA_CHECK_ERROR(rx->hdr.type == NA_TCP_GET && rx->hdr.size != 0,
+                done, ret, NA_PROTOCOL_ERROR,
+                "Invalid get request size (%" PRIu64 ")", rx->hdr.size);
+
+            /* Receive RMA descriptor first */
+            rx->iov_single.iov_base = &rx->desc;
+            rx->iov_single.iov_len = sizeof(rx->desc);
+            rx->iov = &rx->iov_single;
+            rx->iovcnt = 1;
+            rx->remaining = sizeof(rx->desc);
+            rx->stage = NA_TCP_RX_DESC;
+            break;
+        case NA_TCP_PUT_ACK:
+            NA_CHECK_ERROR(rx->hdr.size != 0, done, ret, NA_PROTOCOL_ERROR,
+                "Invalid put completion size (%" PRIu64 ")", rx->hdr.size);
+            NA_CHECK_ERROR(rx->hdr.status >= NA_RETURN_MAX, done, ret,
+                NA_PROTOCOL_ERROR, "Invalid put status (%u)", rx->hdr.status);
+            break;
+        case NA_TCP_GET_RESP:
+            NA_CHECK_ERROR(rx->hdr.status >= NA_RETURN_MAX ||
+                               (rx->hdr.status != NA_SUCCESS && rx->hdr.size),
+                done, ret, NA_PROTOCOL_ERROR, "Invalid get status (%u)",
+                rx->hdr.status);
+
+            na_tcp_op_id =
+                na_tcp_rma_op_pop(&na_tcp_class->rma_op_queue, rx->hdr.token);
+            if (na_tcp_op_id == NULL) {
+                /* Operation was canceled */
+                NA_LOG_DEBUG("Discarding get response (token=%" PRIu64 ")",
+                    rx->hdr.token);
+                break;
+            }
+
+            rx->na_tcp_op_id = na_tcp_op_id;
+            if (rx->hdr.status != NA_SUCCESS) {
+                /* Target rejected request */
+                rx->ret = (na_return_t) rx->hdr.status;
+                break;
+            }
+            NA_CHECK_ERROR(rx->hdr.size != na_tcp_op_id->info.rma.length,
+                done, ret, NA_PROTOCOL_ERROR,
+                "Invalid get response size (%" PRIu64 ")", rx->hdr.size);
+
+            /* Receive directly into local memory */
+            ret = na_tcp_rx_iov_reserve(
+                rx, na_tcp_op_id->info.rma.local_mem_handle->iovcnt);
+            NA_CHECK_NA_ERROR(done, ret, "Could not reserve segments");
+            na_tcp_offset_translate(na_tcp_op_id->info.rma.local_mem_handle,
+                na_tcp_op_id->info.rma.local_offset,
+                na_tcp_op_id->info.rma.length, rx->iov, &rx->iovcnt);
+            break;
+        default:
+            NA_GOTO_ERROR(done, ret, NA_PROTOCOL_ERROR,
+                "Unknown msg type (%u)", rx->hdr.type);
+    }
+
+    if (rx->remaining == 0) {
+        ret = na_tcp_rx_finish(na_tcp_class, conn);
+        NA_CHECK_NA_ERROR(done, ret, "Could not finish receiving msg");
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_rx_finish(struct na_tcp_class *na_tcp_class, struct na_tcp_conn *conn)
+{
+    struct na_tcp_rx *rx = &conn->rx;
+    struct na_tcp_op_id *na_tcp_op_id = rx->na_tcp_op_id;
+    na_return_t ret = NA_SUCCESS;
+
+    switch (rx->hdr.type) {
+        case NA_TCP_HELLO:
+            ret = na_tcp_process_hello(na_tcp_class, conn);
+            NA_CHECK_NA_ERROR(done, ret, "Could not process handshake");
+            break;
+        case NA_TCP_UNEXPECTED:
+            if (na_tcp_op_id) {
+                na_tcp_op_id->na_tcp_addr = conn->na_tcp_addr;
+                hg_atomic_incr32(&conn->na_tcp_addr->ref_count);
+                na_tcp_op_id->info.msg.actual_buf_size =
+                    (na_size_t) rx->hdr.size;
+                na_tcp_op_id->info.msg.tag = rx->hdr.tag;
+
+                rx->na_tcp_op_id = NULL;
+                ret = na_tcp_complete(na_tcp_op_id, rx->ret);
+                NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+            } else {
+                struct na_tcp_unexpected_msg_queue *unexpected_msg_queue =
+                    &na_tcp_class->unexpected_msg_queue;
+                struct na_tcp_op_queue *unexpected_op_queue =
+                    &na_tcp_class->unexpected_op_queue;
+                struct na_tcp_unexpected_info *na_tcp_unexpected_info =
+                    rx->unexpected_info;
+
+                rx->unexpected_info = NULL;
+                na_tcp_unexpected_info->na_tcp_addr = conn->na_tcp_addr;
+                hg_atomic_incr32(&conn->na_tcp_addr->ref_count);
+                na_tcp_unexpected_info->tag = rx->hdr.tag;
+
+                /* A receive may have been posted while payload was read,
+                 * queue msg only if there is still none */
+                hg_thread_spin_lock(&unexpected_msg_queue->lock);
+                hg_thread_spin_lock(&unexpected_op_queue->lock);
+                na_tcp_op_id = HG_QUEUE_FIRST(&unexpected_op_queue->queue);
+                if (na_tcp_op_id) {
+                    HG_QUEUE_POP_HEAD(&unexpected_op_queue->queue, entry);
+                    hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+                }
+                hg_thread_spin_unlock(&unexpected_op_queue->lock);
+                if (na_tcp_op_id == NULL)
+                    HG_QUEUE_PUSH_TAIL(&unexpected_msg_queue->queue,
+                        na_tcp_unexpected_info, entry);
+                hg_thread_spin_unlock(&unexpected_msg_queue->lock);
+
+                if (na_tcp_op_id) {
+                    na_return_t op_ret = NA_SUCCESS;
+
+                    /* Address reference is passed to operation */
+                    na_tcp_op_id->na_tcp_addr =
+                        na_tcp_unexpected_info->na_tcp_addr;
+                    na_tcp_op_id->info.msg.actual_buf_size =
+                        na_tcp_unexpected_info->buf_size;
+                    na_tcp_op_id->info.msg.tag = na_tcp_unexpected_info->tag;
+                    if (na_tcp_unexpected_info->buf_size >
+                        na_tcp_op_id->info.msg.buf_size)
+                        op_ret = NA_MSGSIZE;
+                    else
+                        memcpy(na_tcp_op_id->info.msg.buf.ptr,
+                            na_tcp_unexpected_info->buf,
+                            na_tcp_unexpected_info->buf_size);
+                    free(na_tcp_unexpected_info);
+
+                    ret = na_tcp_complete(na_tcp_op_id, op_ret);
+                    NA_CHECK_NA_ERROR(
+                        done, ret, "Could not complete operation");
+                }
+            }
+            break;
+        case NA_TCP_EXPECTED:
+            if (na_tcp_op_id) {
+                rx->na_tcp_op_id = NULL;
+                ret = na_tcp_complete(na_tcp_op_id, rx->ret);
+                NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+            }
+            break;
+        case NA_TCP_PUT:
+            if (rx->stage == NA_TCP_RX_DESC) {
+                /* Receive data into registered memory, data is discarded
+                 * and the put fails if the request is rejected */
+                if (rx->desc.len == rx->hdr.size)
+                    rx->ret = na_tcp_rma_desc_translate(
+                        na_tcp_class, &rx->desc, NA_MEM_WRITE_ONLY, rx);
+                else
+                    rx->ret = NA_INVALID_ARG;
+                if (rx->ret != NA_SUCCESS) {
+                    rx->iov = NULL;
+                    rx->iovcnt = 0;
+                }
+                rx->remaining = (size_t) rx->hdr.size;
+                rx->stage = NA_TCP_RX_DATA;
+                if (rx->remaining > 0)
+                    goto done;
+            }
+
+            ret = na_tcp_send_ctrl(na_tcp_class, conn->na_tcp_addr,
+                NA_TCP_PUT_ACK, rx->hdr.token, rx->ret, NULL, 0);
+            NA_CHECK_NA_ERROR(done, ret, "Could not send put completion");
+            break;
+        case NA_TCP_GET:
+            rx->ret = na_tcp_rma_desc_translate(
+                na_tcp_class, &rx->desc, NA_MEM_READ_ONLY, rx);
+            if (rx->ret != NA_SUCCESS)
+                rx->iovcnt = 0;
+
+            ret = na_tcp_send_ctrl(na_tcp_class, conn->na_tcp_addr,
+                NA_TCP_GET_RESP, rx->hdr.token, rx->ret, rx->iov, rx->iovcnt);
+            NA_CHECK_NA_ERROR(done, ret, "Could not send get response");
+            break;
+        case NA_TCP_PUT_ACK:
+            na_tcp_op_id =
+                na_tcp_rma_op_pop(&na_tcp_class->rma_op_queue, rx->hdr.token);
+            if (na_tcp_op_id) {
+                ret = na_tcp_complete(
+                    na_tcp_op_id, (na_return_t) rx->hdr.status);
+                NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+            }
+            break;
+        case NA_TCP_GET_RESP:
+            if (na_tcp_op_id) {
+                rx->na_tcp_op_id = NULL;
+                ret = na_tcp_complete(na_tcp_op_id, rx->ret);
+                NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+            }
+            break;
+        default:
+            NA_GOTO_ERROR(done, ret, NA_PROTOCOL_ERROR,
+                "Unknown msg type (%u)", rx->hdr.type);
+    }
+
+    /* Wait for next header */
+    rx->na_tcp_op_id = NULL;
+    rx->iov = NULL;
+    rx->iovcnt = 0;
+    rx->stage = NA_TCP_RX_HDR;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_rx_iov_reserve(struct na_tcp_rx *rx, unsigned long count)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (count <= 1) {
+        rx->iov = &rx->iov_single;
+        goto done;
+    }
+
+    if (count > rx->iov_alloc_count) {
+        struct iovec *iov = (struct iovec *) realloc(
+            rx->iov_alloc, count * sizeof(struct iovec));
+        NA_CHECK_ERROR(
+            iov == NULL, done, ret, NA_NOMEM, "Could not allocate iovec");
+        rx->iov_alloc = iov;
+        rx->iov_alloc_count = count;
+    }
+    rx->iov = rx->iov_alloc;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_tcp_rx_copy(struct na_tcp_rx *rx, size_t len)
+{
+    /* Payload is discarded if there is no destination */
+    if (rx->iov) {
+        const char *src = rx->buf + rx->buf_head;
+        size_t left = len;
+
+        while (left > 0) {
+            size_t n = MIN(left, rx->iov->iov_len);
+
+            memcpy(rx->iov->iov_base, src, n);
+            src += n;
+            left -= n;
+            na_tcp_iov_advance(&rx->iov, &rx->iovcnt, n);
+        }
+    }
+
+    rx->buf_head += len;
+    rx->remaining -= len;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_tx_reserve(struct na_tcp_tx *tx, unsigned long iovcnt)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (iovcnt <= NA_TCP_TX_IOV_INLINE)
+        tx->iov = tx->iov_inline;
+    else {
+        if (iovcnt > tx->iov_alloc_count) {
+            struct iovec *iov = (struct iovec *) realloc(
+                tx->iov_alloc, iovcnt * sizeof(struct iovec));
+            NA_CHECK_ERROR(
+                iov == NULL, done, ret, NA_NOMEM, "Could not allocate iovec");
+            tx->iov_alloc = iov;
+            tx->iov_alloc_count = iovcnt;
+        }
+        tx->iov = tx->iov_alloc;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_tx_free(struct na_tcp_tx *tx)
+{
+    free(tx->iov_alloc);
+    tx->iov_alloc = NULL;
+    tx->iov_alloc_count = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_tx_done(
+    struct na_tcp_class *na_tcp_class, struct na_tcp_tx *tx, na_return_t ret)
+{
+    struct na_tcp_op_id *na_tcp_op_id = tx->na_tcp_op_id;
+    struct na_tcp_op_queue *rma_op_queue = &na_tcp_class->rma_op_queue;
+    na_bool_t dequeued = NA_FALSE;
+    hg_util_int32_t status;
+
+    /* Control msgs */
+    if (na_tcp_op_id == NULL) {
+        if (tx->allocated) {
+            na_tcp_tx_free(tx);
+            free(tx);
+        }
+        return NA_SUCCESS;
+    }
+
+    status = hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_TX);
+
+    switch (na_tcp_op_id->completion_data.callback_info.type) {
+        case NA_CB_SEND_UNEXPECTED:
+        case NA_CB_SEND_EXPECTED:
+            return na_tcp_complete(na_tcp_op_id, ret);
+        case NA_CB_PUT:
+        case NA_CB_GET:
+            /* Completed once reply is received */
+            if (ret == NA_SUCCESS && !(status & NA_TCP_OP_CANCELED))
+                return NA_SUCCESS;
+
+            hg_thread_spin_lock(&rma_op_queue->lock);
+            if (hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_QUEUED) {
+                HG_QUEUE_REMOVE(
+                    &rma_op_queue->queue, na_tcp_op_id, na_tcp_op_id, entry);
+                hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+                dequeued = NA_TRUE;
+            }
+            hg_thread_spin_unlock(&rma_op_queue->lock);
+
+            return (dequeued) ? na_tcp_complete(na_tcp_op_id, ret)
+                              : NA_SUCCESS;
+        default:
+            NA_LOG_ERROR("Operation type %d not supported",
+                na_tcp_op_id->completion_data.callback_info.type);
+            return NA_INVALID_ARG;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_send(struct na_tcp_class *na_tcp_class, struct na_tcp_addr *na_tcp_addr,
+    struct na_tcp_tx *tx)
+{
+    struct na_tcp_conn *conn;
+    na_bool_t write_now;
+    na_return_t ret = NA_SUCCESS;
+
+    hg_thread_mutex_lock(&na_tcp_addr->lock);
+
+    conn = na_tcp_addr->conn;
+    if (conn == NULL) {
+        ret = na_tcp_conn_connect(na_tcp_class, na_tcp_addr);
+        NA_CHECK_NA_ERROR(unlock, ret, "Could not connect");
+        conn = na_tcp_addr->conn;
+        write_now = NA_TRUE;
+    } else
+        write_now = HG_QUEUE_IS_EMPTY(&conn->tx_queue);
+
+    tx->started = NA_FALSE;
+    if (tx->na_tcp_op_id)
+        hg_atomic_or32(&tx->na_tcp_op_id->status, NA_TCP_OP_TX);
+    HG_QUEUE_PUSH_TAIL(&conn->tx_queue, tx, entry);
+
+    /* Otherwise tx is written once socket is writable */
+    if (write_now && conn->state == NA_TCP_CONN_CONNECTED) {
+        na_return_t write_ret = na_tcp_conn_write(na_tcp_class, conn);
+
+        /* Connection is closed and tx failed during progress */
+        NA_CHECK_WARNING(write_ret != NA_SUCCESS,
+            "Could not write to connection (%s)",
+            NA_Error_to_string(write_ret));
+    }
+
+unlock:
+    hg_thread_mutex_unlock(&na_tcp_addr->lock);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_send_ctrl(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_addr *na_tcp_addr, na_tcp_msg_type_t type, na_uint64_t token,
+    na_return_t status, const struct iovec *iov, unsigned long iovcnt)
+{
+    struct na_tcp_tx *tx = NULL;
+    na_return_t ret = NA_SUCCESS;
+    unsigned long i;
+
+    tx = (struct na_tcp_tx *) malloc(sizeof(struct na_tcp_tx));
+    NA_CHECK_ERROR(
+        tx == NULL, error, ret, NA_NOMEM, "Could not allocate tx entry");
+    memset(tx, 0, sizeof(struct na_tcp_tx));
+    tx->allocated = NA_TRUE;
+
+    ret = na_tcp_tx_reserve(tx, 1 + iovcnt);
+    NA_CHECK_NA_ERROR(error, ret, "Could not reserve segments");
+
+    tx->hdr.type = type;
+    tx->hdr.token = token;
+    tx->hdr.status = (na_uint32_t) status;
+    tx->iov[0].iov_base = &tx->hdr;
+    tx->iov[0].iov_len = sizeof(tx->hdr);
+    for (i = 0; i < iovcnt; i++) {
+        tx->iov[i + 1] = iov[i];
+        tx->hdr.size += iov[i].iov_len;
+    }
+    tx->iovcnt = 1 + iovcnt;
+
+    ret = na_tcp_send(na_tcp_class, na_tcp_addr, tx);
+    NA_CHECK_NA_ERROR(error, ret, "Could not send control msg");
+
+    return ret;
+
+error:
+    if (tx) {
+        na_tcp_tx_free(tx);
+        free(tx);
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_tcp_iov_advance(struct iovec **iov, unsigned long *iovcnt, size_t len)
+{
+    /* Skip segments that were fully consumed */
+    while (*iovcnt > 0 && len >= (*iov)->iov_len) {
+        len -= (*iov)->iov_len;
+        (*iov)++;
+        (*iovcnt)--;
+    }
+
+    if (len > 0) {
+        (*iov)->iov_base = (char *) (*iov)->iov_base + len;
+        (*iov)->iov_len -= len;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_offset_translate(struct na_tcp_mem_handle *mem_handle,
+    na_offset_t offset, na_size_t length, struct iovec *iov,
+    unsigned long *iovcnt)
+{
+    unsigned long i, new_start_index = 0;
+    na_offset_t new_offset = offset, next_offset = 0;
+    na_size_t remaining_len = length;
+
+    /* Get start index and handle offset */
+    for (i = 0; i < mem_handle->iovcnt; i++) {
+        next_offset += mem_handle->iov[i].iov_len;
+        if (offset < next_offset) {
+            new_start_index = i;
+            break;
+        }
+        new_offset -= mem_handle->iov[i].iov_len;
+    }
+
+    iov[0].iov_base =
+        (char *) mem_handle->iov[new_start_index].iov_base + new_offset;
+    iov[0].iov_len = MIN(
+        remaining_len, mem_handle->iov[new_start_index].iov_len - new_offset);
+    remaining_len -= iov[0].iov_len;
+
+    for (i = 1; remaining_len && (i < mem_handle->iovcnt - new_start_index);
+         i++) {
+        iov[i].iov_base = mem_handle->iov[i + new_start_index].iov_base;
+        /* Can only transfer smallest size */
+        iov[i].iov_len =
+            MIN(remaining_len, mem_handle->iov[i + new_start_index].iov_len);
+
+        /* Decrease remaining len from the len of data */
+        remaining_len -= iov[i].iov_len;
+    }
+
+    *iovcnt = i;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_rma_desc_translate(struct na_tcp_class *na_tcp_class,
+    const struct na_tcp_rma_desc *desc, na_uint8_t access,
+    struct na_tcp_rx *rx)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle;
+    na_uint64_t key = desc->key;
+    hg_hash_table_value_t value;
+    na_return_t ret = NA_SUCCESS;
+
+    /* Handle cannot be deregistered while its segments are translated */
+    hg_thread_rwlock_rdlock(&na_tcp_class->mem_map.lock);
+    value = hg_hash_table_lookup(
+        na_tcp_class->mem_map.map, (hg_hash_table_key_t) &key);
+    NA_CHECK_ERROR(value == HG_HASH_TABLE_NULL, unlock, ret, NA_NOENTRY,
+        "No registered memory handle with key %" PRIu64, key);
+    na_tcp_mem_handle = (struct na_tcp_mem_handle *) value;
+
+    NA_CHECK_ERROR(!(na_tcp_mem_handle->flags & access), unlock, ret,
+        NA_PERMISSION, "Registered memory does not grant %s access",
+        (access == NA_MEM_WRITE_ONLY) ? "write" : "read");
+    NA_CHECK_ERROR(desc->offset > na_tcp_mem_handle->len ||
+                       desc->len > na_tcp_mem_handle->len - desc->offset,
+        unlock, ret, NA_OVERFLOW,
+        "Exceeds registered memory size (offset=%" PRIu64 ", len=%" PRIu64
+        ")",
+        desc->offset, desc->len);
+
+    ret = na_tcp_rx_iov_reserve(rx, na_tcp_mem_handle->iovcnt);
+    NA_CHECK_NA_ERROR(unlock, ret, "Could not reserve segments");
+    na_tcp_offset_translate(na_tcp_mem_handle, (na_offset_t) desc->offset,
+        (na_size_t) desc->len, rx->iov, &rx->iovcnt);
+
+unlock:
+    hg_thread_rwlock_release_rdlock(&na_tcp_class->mem_map.lock);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct na_tcp_op_id *
+na_tcp_rma_op_pop(struct na_tcp_op_queue *rma_op_queue, na_uint64_t token)
+{
+    struct na_tcp_op_id *na_tcp_op_id;
+
+    hg_thread_spin_lock(&rma_op_queue->lock);
+    HG_QUEUE_FOREACH (na_tcp_op_id, &rma_op_queue->queue, entry) {
+        if (na_tcp_op_id->info.rma.token == token) {
+            HG_QUEUE_REMOVE(
+                &rma_op_queue->queue, na_tcp_op_id, na_tcp_op_id, entry);
+            hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+            break;
+        }
+    }
+    hg_thread_spin_unlock(&rma_op_queue->lock);
+
+    /* Sender may not be done with the tx entry yet, wait for it */
+    if (na_tcp_op_id &&
+        (hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_TX)) {
+        hg_thread_mutex_lock(&na_tcp_op_id->na_tcp_addr->lock);
+        hg_thread_mutex_unlock(&na_tcp_op_id->na_tcp_addr->lock);
+    }
+
+    return na_tcp_op_id;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_progress_listen(
+    struct na_tcp_class *na_tcp_class, na_bool_t *progressed)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    for (;;) {
+        struct na_tcp_conn *conn;
+        int fd;
+
+        fd = accept4(na_tcp_class->listen_fd, NULL, NULL,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            NA_GOTO_ERROR(done, ret, na_tcp_errno_to_na(errno),
+                "accept4() failed (%s)", strerror(errno));
+        }
+
+        na_tcp_sock_set_options(na_tcp_class, fd);
+
+        /* Peer address is set once handshake is received */
+        ret = na_tcp_conn_create(
+            na_tcp_class, fd, NULL, NA_TCP_CONN_CONNECTED, &conn);
+        if (ret != NA_SUCCESS) {
+            close(fd);
+            NA_GOTO_ERROR(done, ret, ret, "Could not create connection");
+        }
+
+        *progressed = NA_TRUE;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_tcp_progress_conn(struct na_tcp_class *na_tcp_class,
+    struct na_tcp_conn *conn, unsigned int events, na_bool_t *closed)
+{
+    struct na_tcp_addr *na_tcp_addr = conn->na_tcp_addr;
+    na_return_t ret;
+
+    /* Only connections that have something to send are polled for POLLOUT */
+    if (na_tcp_addr &&
+        ((events & HG_POLLOUT) || conn->state == NA_TCP_CONN_CONNECTING)) {
+        hg_thread_mutex_lock(&na_tcp_addr->lock);
+        if (conn->state == NA_TCP_CONN_CONNECTING) {
+            socklen_t len = sizeof(int);
+            int err = 0, rc;
+
+            rc = getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (rc == -1)
+                err = errno;
+            if (err != 0 || !(events & HG_POLLOUT)) {
+                hg_thread_mutex_unlock(&na_tcp_addr->lock);
+                NA_LOG_ERROR("Could not connect to %s:%d (%s)",
+                    inet_ntoa(na_tcp_addr->sin.sin_addr),
+                    ntohs(na_tcp_addr->sin.sin_port),
+                    strerror((err != 0) ? err : ECONNREFUSED));
+                *closed = NA_TRUE;
+                goto close;
+            }
+            conn->state = NA_TCP_CONN_CONNECTED;
+        }
+        ret = na_tcp_conn_write(na_tcp_class, conn);
+        hg_thread_mutex_unlock(&na_tcp_addr->lock);
+        if (ret != NA_SUCCESS) {
+            *closed = NA_TRUE;
+            goto close;
+        }
+    }
+
+    if (events & (HG_POLLIN | HG_POLLERR | HG_POLLHUP)) {
+        ret = na_tcp_conn_read(na_tcp_class, conn, closed);
+        if (ret != NA_SUCCESS)
+            *closed = NA_TRUE;
+    }
+
+close:
+    if (*closed)
+        na_tcp_conn_close(na_tcp_class, conn);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_rma(na_class_t *na_class, na_context_t *context, na_cb_type_t cb_type,
+    na_cb_t callback, void *arg, struct na_tcp_mem_handle *local_mem_handle,
+    na_offset_t local_offset, struct na_tcp_mem_handle *remote_mem_handle,
+    na_offset_t remote_offset, na_size_t length, na_addr_t remote_addr,
+    na_op_id_t *op_id)
+{
+    struct na_tcp_op_queue *rma_op_queue =
+        &NA_TCP_CLASS(na_class)->rma_op_queue;
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) remote_addr;
+    struct na_tcp_tx *tx;
+    unsigned long liovcnt = 0;
+    na_return_t ret = NA_SUCCESS;
+
+    switch (remote_mem_handle->flags) {
+        case NA_MEM_READ_ONLY:
+            NA_CHECK_ERROR(cb_type == NA_CB_PUT, done, ret, NA_PERMISSION,
+                "Registered memory requires write permission");
+            break;
+        case NA_MEM_WRITE_ONLY:
+            NA_CHECK_ERROR(cb_type == NA_CB_GET, done, ret, NA_PERMISSION,
+                "Registered memory requires read permission");
+            break;
+        case NA_MEM_READWRITE:
+            break;
+        default:
+            NA_GOTO_ERROR(
+                done, ret, NA_INVALID_ARG, "Invalid memory access flag");
+    }
+    NA_CHECK_ERROR(remote_mem_handle->key == 0, done, ret, NA_INVALID_ARG,
+        "Remote memory handle was not registered");
+    NA_CHECK_ERROR(remote_offset > remote_mem_handle->len ||
+                       length > remote_mem_handle->len - remote_offset,
+        done, ret, NA_OVERFLOW, "Exceeds remote memory handle size");
+    NA_CHECK_ERROR(local_offset > local_mem_handle->len ||
+                       length > local_mem_handle->len - local_offset,
+        done, ret, NA_OVERFLOW, "Exceeds local memory handle size");
+
+    /* Check op_id */
+    NA_CHECK_ERROR(
+        op_id == NULL || op_id == NA_OP_ID_IGNORE || *op_id == NA_OP_ID_NULL,
+        done, ret, NA_INVALID_ARG, "Invalid operation ID");
+
+    na_tcp_op_id = (struct na_tcp_op_id *) *op_id;
+    NA_CHECK_ERROR(
+        !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_COMPLETED), done,
+        ret, NA_BUSY, "Attempting to use OP ID that was not completed");
+    /* Make sure op ID is fully released before re-using it */
+    while (hg_atomic_cas32(&na_tcp_op_id->ref_count, 1, 2) != HG_UTIL_TRUE)
+        cpu_spinwait();
+
+    na_tcp_op_id->context = context;
+    na_tcp_op_id->completion_data.callback_info.type = cb_type;
+    na_tcp_op_id->completion_data.callback = callback;
+    na_tcp_op_id->completion_data.callback_info.arg = arg;
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+    na_tcp_op_id->na_tcp_addr = na_tcp_addr;
+    hg_atomic_set32(&na_tcp_op_id->status, 0);
+    na_tcp_op_id->info.rma.local_mem_handle = local_mem_handle;
+    na_tcp_op_id->info.rma.local_offset = local_offset;
+    na_tcp_op_id->info.rma.length = length;
+    na_tcp_op_id->info.rma.token =
+        (na_uint64_t) hg_atomic_incr64(&NA_TCP_CLASS(na_class)->next_token);
+
+    /* Msg is made of header, RMA descriptor and data (put only), remote
+     * memory is described by its registration key and an offset */
+    tx = &na_tcp_op_id->tx;
+    ret = na_tcp_tx_reserve(tx,
+        2 + ((cb_type == NA_CB_PUT) ? local_mem_handle->iovcnt : 0));
+    NA_CHECK_NA_ERROR(error, ret, "Could not reserve segments");
+
+    tx->desc.key = remote_mem_handle->key;
+    tx->desc.offset = remote_offset;
+    tx->desc.len = length;
+
+    memset(&tx->hdr, 0, sizeof(tx->hdr));
+    tx->hdr.token = na_tcp_op_id->info.rma.token;
+    if (cb_type == NA_CB_PUT) {
+        tx->hdr.type = NA_TCP_PUT;
+        tx->hdr.size = length;
+        na_tcp_offset_translate(
+            local_mem_handle, local_offset, length, &tx->iov[2], &liovcnt);
+    } else
+        tx->hdr.type = NA_TCP_GET;
+    tx->iov[0].iov_base = &tx->hdr;
+    tx->iov[0].iov_len = sizeof(tx->hdr);
+    tx->iov[1].iov_base = &tx->desc;
+    tx->iov[1].iov_len = sizeof(tx->desc);
+    tx->iovcnt = 2 + liovcnt;
+    tx->na_tcp_op_id = na_tcp_op_id;
+
+    /* Queue op ID before sending so that reply can be matched */
+    hg_thread_spin_lock(&rma_op_queue->lock);
+    HG_QUEUE_PUSH_TAIL(&rma_op_queue->queue, na_tcp_op_id, entry);
+    hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_QUEUED);
+    hg_thread_spin_unlock(&rma_op_queue->lock);
+
+    ret = na_tcp_send(NA_TCP_CLASS(na_class), na_tcp_addr, tx);
+    NA_CHECK_NA_ERROR(error, ret, "Could not send RMA request");
+
+done:
+    return ret;
+
+error:
+    hg_thread_spin_lock(&rma_op_queue->lock);
+    if (hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_QUEUED) {
+        HG_QUEUE_REMOVE(
+            &rma_op_queue->queue, na_tcp_op_id, na_tcp_op_id, entry);
+        hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+    }
+    hg_thread_spin_unlock(&rma_op_queue->lock);
+    hg_atomic_set32(&na_tcp_op_id->status, NA_TCP_OP_COMPLETED);
+    hg_atomic_decr32(&na_tcp_op_id->na_tcp_addr->ref_count);
+    hg_atomic_decr32(&na_tcp_op_id->ref_count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_complete(struct na_tcp_op_id *na_tcp_op_id, na_return_t op_ret)
+{
+    struct na_cb_info *callback_info = NULL;
+    na_return_t ret = NA_SUCCESS;
+    hg_util_int32_t status;
+
+    /* Mark op id as completed before checking for cancelation */
+    status = hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_COMPLETED);
+
+    /* Init callback info */
+    callback_info = &na_tcp_op_id->completion_data.callback_info;
+
+    /* Check for current status before completing */
+    if (status & NA_TCP_OP_CANCELED) {
+        /* If it was canceled while being processed, set callback ret
+         * accordingly */
+        NA_LOG_DEBUG("Operation ID %p was canceled", na_tcp_op_id);
+        callback_info->ret = NA_CANCELED;
+    } else
+        callback_info->ret = op_ret;
+
+    switch (callback_info->type) {
+        case NA_CB_SEND_UNEXPECTED:
+            break;
+        case NA_CB_RECV_UNEXPECTED:
+            if (callback_info->ret != NA_SUCCESS) {
+                /* In case of cancellation where no recv'd data */
+                callback_info->info.recv_unexpected.actual_buf_size = 0;
+                callback_info->info.recv_unexpected.source = NA_ADDR_NULL;
+                callback_info->info.recv_unexpected.tag = 0;
+            } else {
+                /* Increment addr ref count */
+                hg_atomic_incr32(&na_tcp_op_id->na_tcp_addr->ref_count);
+
+                /* Fill callback info */
+                callback_info->info.recv_unexpected.actual_buf_size =
+                    na_tcp_op_id->info.msg.actual_buf_size;
+                callback_info->info.recv_unexpected.source =
+                    (na_addr_t) na_tcp_op_id->na_tcp_addr;
+                callback_info->info.recv_unexpected.tag =
+                    na_tcp_op_id->info.msg.tag;
+            }
+            break;
+        case NA_CB_SEND_EXPECTED:
+            break;
+        case NA_CB_RECV_EXPECTED:
+            break;
+        case NA_CB_PUT:
+            break;
+        case NA_CB_GET:
+            break;
+        default:
+            NA_GOTO_ERROR(done, ret, NA_INVALID_ARG,
+                "Operation type %d not supported", callback_info->type);
+    }
+
+    /* Add OP to NA completion queue */
+    ret = na_cb_completion_add(
+        na_tcp_op_id->context, &na_tcp_op_id->completion_data);
+    NA_CHECK_NA_ERROR(done, ret, "Could not add callback to completion queue");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_tcp_release(void *arg)
+{
+    struct na_tcp_op_id *na_tcp_op_id = (struct na_tcp_op_id *) arg;
+
+    NA_CHECK_WARNING(na_tcp_op_id && (!(hg_atomic_get32(&na_tcp_op_id->status) &
+                                         NA_TCP_OP_COMPLETED)),
+        "Releasing resources from an uncompleted operation");
+
+    if (na_tcp_op_id->na_tcp_addr) {
+        na_tcp_addr_release(na_tcp_op_id->na_tcp_addr);
+        na_tcp_op_id->na_tcp_addr = NULL;
+    }
+    na_tcp_op_destroy(na_tcp_op_id->na_class, na_tcp_op_id);
+}
+
+/********************/
+/* Plugin callbacks */
+/********************/
+
+static na_bool_t
+na_tcp_check_protocol(const char *protocol_name)
+{
+    na_bool_t accept = NA_FALSE;
+
+    if (!strcmp("tcp", protocol_name))
+        accept = NA_TRUE;
+
+    return accept;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_initialize(
+    na_class_t *na_class, const struct na_info *na_info, na_bool_t listen)
+{
+    const char *ip_subnet = NULL;
+    const char *env;
+    na_return_t ret = NA_SUCCESS;
+
+    /* Initialize private data */
+    na_class->plugin_class = malloc(sizeof(struct na_tcp_class));
+    NA_CHECK_ERROR(na_class->plugin_class == NULL, error, ret, NA_NOMEM,
+        "Could not allocate TCP private class");
+    memset(na_class->plugin_class, 0, sizeof(struct na_tcp_class));
+
+    /* Get init info */
+    if (na_info->na_init_info) {
+        /* Progress mode */
+        if (na_info->na_init_info->progress_mode & NA_NO_BLOCK)
+            NA_TCP_CLASS(na_class)->no_wait = NA_TRUE;
+        /* Preferred IP subnet */
+        ip_subnet = na_info->na_init_info->ip_subnet;
+    }
+
+    /* Socket options, TCP_NODELAY is set unless explicitly disabled */
+    env = getenv(NA_TCP_NODELAY_ENV);
+    NA_TCP_CLASS(na_class)->nodelay =
+        (env && strcmp(env, "0") == 0) ? NA_FALSE : NA_TRUE;
+    env = getenv(NA_TCP_BUSY_POLL_ENV);
+    NA_TCP_CLASS(na_class)->busy_poll = (env) ? atoi(env) : 0;
+#ifndef SO_BUSY_POLL
+    NA_CHECK_WARNING(NA_TCP_CLASS(na_class)->busy_poll > 0,
+        "SO_BUSY_POLL is not supported on this platform");
+#endif
+
+    /* Open endpoint */
+    ret = na_tcp_endpoint_open(
+        NA_TCP_CLASS(na_class), na_info->host_name, ip_subnet, listen);
+    NA_CHECK_NA_ERROR(error, ret, "Could not open endpoint");
+
+    return ret;
+
+error:
+    free(na_class->plugin_class);
+    na_class->plugin_class = NULL;
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_finalize(na_class_t *na_class)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class->plugin_class)
+        goto done;
+
+    /* Close endpoint */
+    ret = na_tcp_endpoint_close(NA_TCP_CLASS(na_class));
+    NA_CHECK_NA_ERROR(done, ret, "Could not close endpoint");
+
+    free(na_class->plugin_class);
+    na_class->plugin_class = NULL;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_context_create(
+    na_class_t NA_UNUSED *na_class, void **context, na_uint8_t NA_UNUSED id)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    *context = malloc(sizeof(struct na_tcp_context));
+    NA_CHECK_ERROR(*context == NULL, done, ret, NA_NOMEM,
+        "Could not allocate TCP private context");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_context_destroy(na_class_t NA_UNUSED *na_class, void *context)
+{
+    free(context);
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_op_id_t
+na_tcp_op_create(na_class_t *na_class)
+{
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+
+    na_tcp_op_id = (struct na_tcp_op_id *) malloc(sizeof(struct na_tcp_op_id));
+    NA_CHECK_ERROR_NORET(
+        na_tcp_op_id == NULL, done, "Could not allocate NA TCP operation ID");
+    memset(na_tcp_op_id, 0, sizeof(struct na_tcp_op_id));
+
+    na_tcp_op_id->na_class = na_class;
+    hg_atomic_init32(&na_tcp_op_id->ref_count, 1);
+    /* Completed by default */
+    hg_atomic_init32(&na_tcp_op_id->status, NA_TCP_OP_COMPLETED);
+
+    /* Set op ID release callbacks */
+    na_tcp_op_id->completion_data.plugin_callback = na_tcp_release;
+    na_tcp_op_id->completion_data.plugin_callback_args = na_tcp_op_id;
+
+done:
+    return (na_op_id_t) na_tcp_op_id;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_op_destroy(na_class_t NA_UNUSED *na_class, na_op_id_t op_id)
+{
+    struct na_tcp_op_id *na_tcp_op_id = (struct na_tcp_op_id *) op_id;
+
+    if (hg_atomic_decr32(&na_tcp_op_id->ref_count)) {
+        /* Cannot free yet */
+        goto done;
+    }
+    na_tcp_tx_free(&na_tcp_op_id->tx);
+    free(na_tcp_op_id);
+
+done:
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_lookup(na_class_t *na_class, const char *name, na_addr_t *addr)
+{
+    struct na_tcp_addr *na_tcp_addr = NULL;
+    struct sockaddr_in sin;
+    na_return_t ret = NA_SUCCESS;
+
+    ret = na_tcp_string_to_sin(name, NA_FALSE, &sin);
+    NA_CHECK_NA_ERROR(done, ret, "Could not convert string to address");
+
+    NA_LOG_DEBUG(
+        "Lookup addr %s:%d", inet_ntoa(sin.sin_addr), ntohs(sin.sin_port));
+
+    ret = na_tcp_addr_map_get(&NA_TCP_CLASS(na_class)->addr_map, &sin,
+        &na_tcp_addr);
+    NA_CHECK_NA_ERROR(done, ret, "Could not get address");
+
+    *addr = (na_addr_t) na_tcp_addr;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_free(na_class_t NA_UNUSED *na_class, na_addr_t addr)
+{
+    if (addr)
+        na_tcp_addr_release((struct na_tcp_addr *) addr);
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_self(na_class_t *na_class, na_addr_t *addr)
+{
+    struct na_tcp_addr *na_tcp_addr = NA_TCP_CLASS(na_class)->self_addr;
+
+    /* Increment refcount */
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+
+    *addr = (na_addr_t) na_tcp_addr;
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_dup(
+    na_class_t NA_UNUSED *na_class, na_addr_t addr, na_addr_t *new_addr)
+{
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) addr;
+
+    /* Increment refcount */
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+
+    *new_addr = (na_addr_t) na_tcp_addr;
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_bool_t
+na_tcp_addr_cmp(
+    na_class_t NA_UNUSED *na_class, na_addr_t addr1, na_addr_t addr2)
+{
+    struct na_tcp_addr *na_tcp_addr1 = (struct na_tcp_addr *) addr1;
+    struct na_tcp_addr *na_tcp_addr2 = (struct na_tcp_addr *) addr2;
+
+    /* Addresses of peers that are not listening are only equal to self */
+    return (na_tcp_addr1 == na_tcp_addr2) ||
+           (na_tcp_addr1->sin.sin_port != 0 &&
+               na_tcp_addr1->sin.sin_port == na_tcp_addr2->sin.sin_port &&
+               na_tcp_addr1->sin.sin_addr.s_addr ==
+                   na_tcp_addr2->sin.sin_addr.s_addr);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_bool_t
+na_tcp_addr_is_self(na_class_t *na_class, na_addr_t addr)
+{
+    return na_tcp_addr_cmp(
+        na_class, (na_addr_t) NA_TCP_CLASS(na_class)->self_addr, addr);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_to_string(na_class_t NA_UNUSED *na_class, char *buf,
+    na_size_t *buf_size, na_addr_t addr)
+{
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) addr;
+    char ip_string[INET_ADDRSTRLEN] = {'\0'};
+    char addr_string[NA_TCP_MAX_ADDR_NAME] = {'\0'};
+    na_size_t string_len;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    NA_CHECK_ERROR(inet_ntop(AF_INET, &na_tcp_addr->sin.sin_addr, ip_string,
+                       sizeof(ip_string)) == NULL,
+        done, ret, na_tcp_errno_to_na(errno), "inet_ntop() failed (%s)",
+        strerror(errno));
+
+    rc = snprintf(addr_string, NA_TCP_MAX_ADDR_NAME, "tcp://%s:%d", ip_string,
+        ntohs(na_tcp_addr->sin.sin_port));
+    NA_CHECK_ERROR(rc < 0 || rc > NA_TCP_MAX_ADDR_NAME, done, ret,
+        NA_OVERFLOW, "snprintf() failed, rc: %d", rc);
+
+    string_len = strlen(addr_string);
+    if (buf) {
+        NA_CHECK_ERROR(string_len >= *buf_size, done, ret, NA_OVERFLOW,
+            "Buffer size too small to copy addr");
+        strcpy(buf, addr_string);
+    }
+    *buf_size = string_len + 1;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_size_t
+na_tcp_addr_get_serialize_size(
+    na_class_t NA_UNUSED *na_class, na_addr_t addr)
+{
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) addr;
+
+    return sizeof(na_tcp_addr->sin.sin_addr.s_addr) +
+           sizeof(na_tcp_addr->sin.sin_port);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_serialize(na_class_t NA_UNUSED *na_class, void *buf,
+    na_size_t buf_size, na_addr_t addr)
+{
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) addr;
+    na_uint8_t *p = buf;
+    na_size_t len = sizeof(na_tcp_addr->sin.sin_addr.s_addr) +
+                    sizeof(na_tcp_addr->sin.sin_port);
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size < len, done, ret, NA_OVERFLOW,
+        "Buffer size too small for serializing address");
+
+    /* Encode IP */
+    memcpy(p, &na_tcp_addr->sin.sin_addr.s_addr,
+        sizeof(na_tcp_addr->sin.sin_addr.s_addr));
+    p += sizeof(na_tcp_addr->sin.sin_addr.s_addr);
+
+    /* Encode port */
+    memcpy(p, &na_tcp_addr->sin.sin_port, sizeof(na_tcp_addr->sin.sin_port));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_addr_deserialize(
+    na_class_t *na_class, na_addr_t *addr, const void *buf, na_size_t buf_size)
+{
+    struct na_tcp_addr *na_tcp_addr = NULL;
+    const na_uint8_t *p = buf;
+    struct sockaddr_in sin;
+    na_size_t len = sizeof(sin.sin_addr.s_addr) + sizeof(sin.sin_port);
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size < len, done, ret, NA_OVERFLOW,
+        "Buffer size too small for serializing address");
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+
+    /* Decode IP */
+    memcpy(&sin.sin_addr.s_addr, p, sizeof(sin.sin_addr.s_addr));
+    p += sizeof(sin.sin_addr.s_addr);
+
+    /* Decode port */
+    memcpy(&sin.sin_port, p, sizeof(sin.sin_port));
+    NA_CHECK_ERROR(sin.sin_port == 0, done, ret, NA_ADDRNOTAVAIL,
+        "Cannot deserialize address of peer that is not listening");
+
+    ret = na_tcp_addr_map_get(&NA_TCP_CLASS(na_class)->addr_map, &sin,
+        &na_tcp_addr);
+    NA_CHECK_NA_ERROR(done, ret, "Could not get address");
+
+    *addr = (na_addr_t) na_tcp_addr;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_size_t
+na_tcp_msg_get_max_unexpected_size(const na_class_t NA_UNUSED *na_class)
+{
+    return NA_TCP_UNEXPECTED_SIZE;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_size_t
+na_tcp_msg_get_max_expected_size(const na_class_t NA_UNUSED *na_class)
+{
+    return NA_TCP_EXPECTED_SIZE;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_tag_t
+na_tcp_msg_get_max_tag(const na_class_t NA_UNUSED *na_class)
+{
+    return NA_TCP_MAX_TAG;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
+    void NA_UNUSED *plugin_data, na_addr_t dest_addr,
+    na_uint8_t NA_UNUSED dest_id, na_tag_t tag, na_op_id_t *op_id)
+{
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) dest_addr;
+    struct na_tcp_tx *tx;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size > NA_TCP_UNEXPECTED_SIZE, done, ret, NA_OVERFLOW,
+        "Exceeds unexpected size, %d", buf_size);
+
+    /* Check op_id */
+    NA_CHECK_ERROR(
+        op_id == NULL || op_id == NA_OP_ID_IGNORE || *op_id == NA_OP_ID_NULL,
+        done, ret, NA_INVALID_ARG, "Invalid operation ID");
+
+    na_tcp_op_id = (struct na_tcp_op_id *) *op_id;
+    NA_CHECK_ERROR(
+        !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_COMPLETED), done,
+        ret, NA_BUSY, "Attempting to use OP ID that was not completed");
+    /* Make sure op ID is fully released before re-using it */
+    while (hg_atomic_cas32(&na_tcp_op_id->ref_count, 1, 2) != HG_UTIL_TRUE)
+        cpu_spinwait();
+
+    na_tcp_op_id->context = context;
+    na_tcp_op_id->completion_data.callback_info.type = NA_CB_SEND_UNEXPECTED;
+    na_tcp_op_id->completion_data.callback = callback;
+    na_tcp_op_id->completion_data.callback_info.arg = arg;
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+    na_tcp_op_id->na_tcp_addr = na_tcp_addr;
+    hg_atomic_set32(&na_tcp_op_id->status, 0);
+    /* TODO we assume that buf remains valid (safe because we pre-allocate
+     * buffers) */
+    na_tcp_op_id->info.msg.buf.const_ptr = buf;
+    na_tcp_op_id->info.msg.buf_size = buf_size;
+    na_tcp_op_id->info.msg.actual_buf_size = buf_size;
+    na_tcp_op_id->info.msg.tag = tag;
+
+    /* Buffer is written from user memory */
+    tx = &na_tcp_op_id->tx;
+    memset(&tx->hdr, 0, sizeof(tx->hdr));
+    tx->hdr.type = NA_TCP_UNEXPECTED;
+    tx->hdr.size = buf_size;
+    tx->hdr.tag = tag;
+    tx->iov_inline[0].iov_base = &tx->hdr;
+    tx->iov_inline[0].iov_len = sizeof(tx->hdr);
+    tx->iov_inline[1].iov_base = na_tcp_op_id->info.msg.buf.ptr;
+    tx->iov_inline[1].iov_len = buf_size;
+    tx->iov = tx->iov_inline;
+    tx->iovcnt = 2;
+    tx->na_tcp_op_id = na_tcp_op_id;
+
+    ret = na_tcp_send(NA_TCP_CLASS(na_class), na_tcp_addr, tx);
+    NA_CHECK_NA_ERROR(error, ret, "Could not send msg");
+
+done:
+    return ret;
+
+error:
+    hg_atomic_set32(&na_tcp_op_id->status, NA_TCP_OP_COMPLETED);
+    hg_atomic_decr32(&na_tcp_op_id->na_tcp_addr->ref_count);
+    hg_atomic_decr32(&na_tcp_op_id->ref_count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
+    void NA_UNUSED *plugin_data, na_op_id_t *op_id)
+{
+    struct na_tcp_unexpected_msg_queue *unexpected_msg_queue =
+        &NA_TCP_CLASS(na_class)->unexpected_msg_queue;
+    struct na_tcp_op_queue *unexpected_op_queue =
+        &NA_TCP_CLASS(na_class)->unexpected_op_queue;
+    struct na_tcp_unexpected_info *na_tcp_unexpected_info;
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size > NA_TCP_UNEXPECTED_SIZE, done, ret, NA_OVERFLOW,
+        "Exceeds unexpected size, %d", buf_size);
+
+    /* Check op_id */
+    NA_CHECK_ERROR(
+        op_id == NULL || op_id == NA_OP_ID_IGNORE || *op_id == NA_OP_ID_NULL,
+        done, ret, NA_INVALID_ARG, "Invalid operation ID");
+
+    na_tcp_op_id = (struct na_tcp_op_id *) *op_id;
+    NA_CHECK_ERROR(
+        !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_COMPLETED), done,
+        ret, NA_BUSY, "Attempting to use OP ID that was not completed");
+    /* Make sure op ID is fully released before re-using it */
+    while (hg_atomic_cas32(&na_tcp_op_id->ref_count, 1, 2) != HG_UTIL_TRUE)
+        cpu_spinwait();
+
+    na_tcp_op_id->context = context;
+    na_tcp_op_id->completion_data.callback_info.type = NA_CB_RECV_UNEXPECTED;
+    na_tcp_op_id->completion_data.callback = callback;
+    na_tcp_op_id->completion_data.callback_info.arg = arg;
+    na_tcp_op_id->na_tcp_addr = NULL;
+    hg_atomic_set32(&na_tcp_op_id->status, 0);
+    na_tcp_op_id->info.msg.buf.ptr = buf;
+    na_tcp_op_id->info.msg.buf_size = buf_size;
+    na_tcp_op_id->info.msg.actual_buf_size = 0;
+    na_tcp_op_id->info.msg.tag = 0;
+
+    /* Look for an unexpected message already received, otherwise add op_id
+     * to progress queue (both queues are locked so that a msg received
+     * concurrently cannot be missed) */
+    hg_thread_spin_lock(&unexpected_msg_queue->lock);
+    na_tcp_unexpected_info = HG_QUEUE_FIRST(&unexpected_msg_queue->queue);
+    if (na_tcp_unexpected_info)
+        HG_QUEUE_POP_HEAD(&unexpected_msg_queue->queue, entry);
+    else {
+        hg_thread_spin_lock(&unexpected_op_queue->lock);
+        HG_QUEUE_PUSH_TAIL(&unexpected_op_queue->queue, na_tcp_op_id, entry);
+        hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_QUEUED);
+        hg_thread_spin_unlock(&unexpected_op_queue->lock);
+    }
+    hg_thread_spin_unlock(&unexpected_msg_queue->lock);
+
+    if (na_tcp_unexpected_info) {
+        na_return_t op_ret = NA_SUCCESS;
+
+        /* Address reference is passed to operation */
+        na_tcp_op_id->na_tcp_addr = na_tcp_unexpected_info->na_tcp_addr;
+        na_tcp_op_id->info.msg.actual_buf_size =
+            na_tcp_unexpected_info->buf_size;
+        na_tcp_op_id->info.msg.tag = na_tcp_unexpected_info->tag;
+
+        /* Copy buffers */
+        if (na_tcp_unexpected_info->buf_size > buf_size)
+            op_ret = NA_MSGSIZE;
+        else
+            memcpy(na_tcp_op_id->info.msg.buf.ptr, na_tcp_unexpected_info->buf,
+                na_tcp_unexpected_info->buf_size);
+
+        free(na_tcp_unexpected_info);
+
+        ret = na_tcp_complete(na_tcp_op_id, op_ret);
+        NA_CHECK_NA_ERROR(error, ret, "Could not complete operation");
+    }
+
+done:
+    return ret;
+
+error:
+    hg_atomic_decr32(&na_tcp_op_id->na_tcp_addr->ref_count);
+    hg_atomic_decr32(&na_tcp_op_id->ref_count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_msg_send_expected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
+    void NA_UNUSED *plugin_data, na_addr_t dest_addr,
+    na_uint8_t NA_UNUSED dest_id, na_tag_t tag, na_op_id_t *op_id)
+{
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) dest_addr;
+    struct na_tcp_tx *tx;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size > NA_TCP_EXPECTED_SIZE, done, ret, NA_OVERFLOW,
+        "Exceeds expected size, %d", buf_size);
+
+    /* Check op_id */
+    NA_CHECK_ERROR(
+        op_id == NULL || op_id == NA_OP_ID_IGNORE || *op_id == NA_OP_ID_NULL,
+        done, ret, NA_INVALID_ARG, "Invalid operation ID");
+
+    na_tcp_op_id = (struct na_tcp_op_id *) *op_id;
+    NA_CHECK_ERROR(
+        !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_COMPLETED), done,
+        ret, NA_BUSY, "Attempting to use OP ID that was not completed");
+    /* Make sure op ID is fully released before re-using it */
+    while (hg_atomic_cas32(&na_tcp_op_id->ref_count, 1, 2) != HG_UTIL_TRUE)
+        cpu_spinwait();
+
+    na_tcp_op_id->context = context;
+    na_tcp_op_id->completion_data.callback_info.type = NA_CB_SEND_EXPECTED;
+    na_tcp_op_id->completion_data.callback = callback;
+    na_tcp_op_id->completion_data.callback_info.arg = arg;
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+    na_tcp_op_id->na_tcp_addr = na_tcp_addr;
+    hg_atomic_set32(&na_tcp_op_id->status, 0);
+    /* TODO we assume that buf remains valid (safe because we pre-allocate
+     * buffers) */
+    na_tcp_op_id->info.msg.buf.const_ptr = buf;
+    na_tcp_op_id->info.msg.buf_size = buf_size;
+    na_tcp_op_id->info.msg.actual_buf_size = buf_size;
+    na_tcp_op_id->info.msg.tag = tag;
+
+    /* Buffer is written from user memory */
+    tx = &na_tcp_op_id->tx;
+    memset(&tx->hdr, 0, sizeof(tx->hdr));
+    tx->hdr.type = NA_TCP_EXPECTED;
+    tx->hdr.size = buf_size;
+    tx->hdr.tag = tag;
+    tx->iov_inline[0].iov_base = &tx->hdr;
+    tx->iov_inline[0].iov_len = sizeof(tx->hdr);
+    tx->iov_inline[1].iov_base = na_tcp_op_id->info.msg.buf.ptr;
+    tx->iov_inline[1].iov_len = buf_size;
+    tx->iov = tx->iov_inline;
+    tx->iovcnt = 2;
+    tx->na_tcp_op_id = na_tcp_op_id;
+
+    ret = na_tcp_send(NA_TCP_CLASS(na_class), na_tcp_addr, tx);
+    NA_CHECK_NA_ERROR(error, ret, "Could not send msg");
+
+done:
+    return ret;
+
+error:
+    hg_atomic_set32(&na_tcp_op_id->status, NA_TCP_OP_COMPLETED);
+    hg_atomic_decr32(&na_tcp_op_id->na_tcp_addr->ref_count);
+    hg_atomic_decr32(&na_tcp_op_id->ref_count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_msg_recv_expected(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
+    void NA_UNUSED *plugin_data, na_addr_t source_addr,
+    na_uint8_t NA_UNUSED source_id, na_tag_t tag, na_op_id_t *op_id)
+{
+    struct na_tcp_op_queue *expected_op_queue =
+        &NA_TCP_CLASS(na_class)->expected_op_queue;
+    struct na_tcp_op_id *na_tcp_op_id = NULL;
+    struct na_tcp_addr *na_tcp_addr = (struct na_tcp_addr *) source_addr;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size > NA_TCP_EXPECTED_SIZE, done, ret, NA_OVERFLOW,
+        "Exceeds expected size, %d", buf_size);
+
+    /* Check op_id */
+    NA_CHECK_ERROR(
+        op_id == NULL || op_id == NA_OP_ID_IGNORE || *op_id == NA_OP_ID_NULL,
+        done, ret, NA_INVALID_ARG, "Invalid operation ID");
+
+    na_tcp_op_id = (struct na_tcp_op_id *) *op_id;
+    NA_CHECK_ERROR(
+        !(hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_COMPLETED), done,
+        ret, NA_BUSY, "Attempting to use OP ID that was not completed");
+    /* Make sure op ID is fully released before re-using it */
+    while (hg_atomic_cas32(&na_tcp_op_id->ref_count, 1, 2) != HG_UTIL_TRUE)
+        cpu_spinwait();
+
+    na_tcp_op_id->context = context;
+    na_tcp_op_id->completion_data.callback_info.type = NA_CB_RECV_EXPECTED;
+    na_tcp_op_id->completion_data.callback = callback;
+    na_tcp_op_id->completion_data.callback_info.arg = arg;
+    hg_atomic_incr32(&na_tcp_addr->ref_count);
+    na_tcp_op_id->na_tcp_addr = na_tcp_addr;
+    hg_atomic_set32(&na_tcp_op_id->status, 0);
+    na_tcp_op_id->info.msg.buf.ptr = buf;
+    na_tcp_op_id->info.msg.buf_size = buf_size;
+    na_tcp_op_id->info.msg.actual_buf_size = 0;
+    na_tcp_op_id->info.msg.tag = tag;
+
+    /* Expected messages must always be pre-posted, therefore a message should
+     * never arrive before that call returns (not completes), simply add
+     * op_id to queue */
+    hg_thread_spin_lock(&expected_op_queue->lock);
+    HG_QUEUE_PUSH_TAIL(&expected_op_queue->queue, na_tcp_op_id, entry);
+    hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_QUEUED);
+    hg_thread_spin_unlock(&expected_op_queue->lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_handle_create(na_class_t NA_UNUSED *na_class, void *buf,
+    na_size_t buf_size, unsigned long flags, na_mem_handle_t *mem_handle)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle = NULL;
+    na_return_t ret = NA_SUCCESS;
+
+    na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) malloc(sizeof(struct na_tcp_mem_handle));
+    NA_CHECK_ERROR(na_tcp_mem_handle == NULL, error, ret, NA_NOMEM,
+        "Could not allocate NA TCP memory handle");
+
+    na_tcp_mem_handle->iov = (struct iovec *) malloc(sizeof(struct iovec));
+    NA_CHECK_ERROR(na_tcp_mem_handle->iov == NULL, error, ret, NA_NOMEM,
+        "Could not allocate iovec");
+
+    na_tcp_mem_handle->iov->iov_base = buf;
+    na_tcp_mem_handle->iov->iov_len = buf_size;
+    na_tcp_mem_handle->iovcnt = 1;
+    na_tcp_mem_handle->flags = flags & 0xff;
+    na_tcp_mem_handle->len = buf_size;
+    na_tcp_mem_handle->key = 0;
+
+    *mem_handle = (na_mem_handle_t) na_tcp_mem_handle;
+
+    return ret;
+
+error:
+    if (na_tcp_mem_handle) {
+        free(na_tcp_mem_handle->iov);
+        free(na_tcp_mem_handle);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_handle_create_segments(na_class_t NA_UNUSED *na_class,
+    struct na_segment *segments, na_size_t segment_count, unsigned long flags,
+    na_mem_handle_t *mem_handle)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle = NULL;
+    na_return_t ret = NA_SUCCESS;
+    na_size_t i;
+
+    na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) malloc(sizeof(struct na_tcp_mem_handle));
+    NA_CHECK_ERROR(na_tcp_mem_handle == NULL, error, ret, NA_NOMEM,
+        "Could not allocate NA TCP memory handle");
+
+    na_tcp_mem_handle->iov =
+        (struct iovec *) malloc(segment_count * sizeof(struct iovec));
+    NA_CHECK_ERROR(na_tcp_mem_handle->iov == NULL, error, ret, NA_NOMEM,
+        "Could not allocate iovec");
+
+    na_tcp_mem_handle->len = 0;
+    for (i = 0; i < segment_count; i++) {
+        na_tcp_mem_handle->iov[i].iov_base = (void *) segments[i].address;
+        na_tcp_mem_handle->iov[i].iov_len = segments[i].size;
+        na_tcp_mem_handle->len += na_tcp_mem_handle->iov[i].iov_len;
+    }
+    na_tcp_mem_handle->iovcnt = segment_count;
+    na_tcp_mem_handle->flags = flags & 0xff;
+    na_tcp_mem_handle->key = 0;
+
+    *mem_handle = (na_mem_handle_t) na_tcp_mem_handle;
+
+    return ret;
+
+error:
+    if (na_tcp_mem_handle) {
+        free(na_tcp_mem_handle->iov);
+        free(na_tcp_mem_handle);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_handle_free(
+    na_class_t NA_UNUSED *na_class, na_mem_handle_t mem_handle)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) mem_handle;
+
+    free(na_tcp_mem_handle->iov);
+    free(na_tcp_mem_handle);
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_register(na_class_t *na_class, na_mem_handle_t mem_handle)
+{
+    struct na_tcp_map *mem_map = &NA_TCP_CLASS(na_class)->mem_map;
+    struct na_tcp_mem_handle *na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) mem_handle;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    NA_CHECK_ERROR(na_tcp_mem_handle->iov == NULL, done, ret, NA_INVALID_ARG,
+        "Cannot register deserialized memory handle");
+    NA_CHECK_ERROR(na_tcp_mem_handle->key != 0, done, ret, NA_EXIST,
+        "Memory handle was already registered");
+
+    /* Peers can only access memory through the key of its handle */
+    na_tcp_mem_handle->key =
+        (na_uint64_t) hg_atomic_incr64(&NA_TCP_CLASS(na_class)->next_key);
+
+    hg_thread_rwlock_wrlock(&mem_map->lock);
+    rc = hg_hash_table_insert(mem_map->map,
+        (hg_hash_table_key_t) &na_tcp_mem_handle->key,
+        (hg_hash_table_value_t) na_tcp_mem_handle);
+    hg_thread_rwlock_release_wrlock(&mem_map->lock);
+    if (rc == 0) {
+        na_tcp_mem_handle->key = 0;
+        NA_GOTO_ERROR(done, ret, NA_NOMEM, "hg_hash_table_insert() failed");
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_deregister(na_class_t *na_class, na_mem_handle_t mem_handle)
+{
+    struct na_tcp_map *mem_map = &NA_TCP_CLASS(na_class)->mem_map;
+    struct na_tcp_mem_handle *na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) mem_handle;
+    na_return_t ret = NA_SUCCESS;
+    int rc;
+
+    /* Keys of deserialized handles belong to the peer, nothing to remove */
+    if (na_tcp_mem_handle->iov == NULL)
+        goto done;
+
+    NA_CHECK_ERROR(na_tcp_mem_handle->key == 0, done, ret, NA_INVALID_ARG,
+        "Memory handle was not registered");
+
+    hg_thread_rwlock_wrlock(&mem_map->lock);
+    rc = hg_hash_table_remove(
+        mem_map->map, (hg_hash_table_key_t) &na_tcp_mem_handle->key);
+    hg_thread_rwlock_release_wrlock(&mem_map->lock);
+    NA_CHECK_ERROR(rc == 0, done, ret, NA_NOENTRY,
+        "Could not remove key %" PRIu64 " from memory map",
+        na_tcp_mem_handle->key);
+    na_tcp_mem_handle->key = 0;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_size_t
+na_tcp_mem_handle_get_serialize_size(
+    na_class_t NA_UNUSED *na_class, na_mem_handle_t NA_UNUSED mem_handle)
+{
+    return 2 * sizeof(na_uint64_t) + sizeof(na_uint8_t);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_handle_serialize(na_class_t NA_UNUSED *na_class, void *buf,
+    na_size_t buf_size, na_mem_handle_t mem_handle)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) mem_handle;
+    char *buf_ptr = (char *) buf;
+    na_uint64_t len = (na_uint64_t) na_tcp_mem_handle->len;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size < na_tcp_mem_handle_get_serialize_size(
+                                  na_class, mem_handle),
+        done, ret, NA_OVERFLOW, "Buffer size too small for serializing handle");
+
+    /* Segment addresses are never exposed, only the registration key */
+    memcpy(buf_ptr, &na_tcp_mem_handle->key, sizeof(na_uint64_t));
+    buf_ptr += sizeof(na_uint64_t);
+
+    /* Length */
+    memcpy(buf_ptr, &len, sizeof(na_uint64_t));
+    buf_ptr += sizeof(na_uint64_t);
+
+    /* Flags */
+    memcpy(buf_ptr, &na_tcp_mem_handle->flags, sizeof(na_uint8_t));
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_mem_handle_deserialize(na_class_t NA_UNUSED *na_class,
+    na_mem_handle_t *mem_handle, const void *buf, na_size_t buf_size)
+{
+    struct na_tcp_mem_handle *na_tcp_mem_handle = NULL;
+    const char *buf_ptr = (const char *) buf;
+    na_uint64_t len;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(buf_size < na_tcp_mem_handle_get_serialize_size(
+                                  na_class, NA_MEM_HANDLE_NULL),
+        done, ret, NA_OVERFLOW, "Buffer size too small for handle");
+
+    na_tcp_mem_handle =
+        (struct na_tcp_mem_handle *) malloc(sizeof(struct na_tcp_mem_handle));
+    NA_CHECK_ERROR(na_tcp_mem_handle == NULL, done, ret, NA_NOMEM,
+        "Could not allocate NA TCP memory handle");
+
+    /* Remote handles have no segments */
+    na_tcp_mem_handle->iov = NULL;
+    na_tcp_mem_handle->iovcnt = 0;
+
+    /* Key */
+    memcpy(&na_tcp_mem_handle->key, buf_ptr, sizeof(na_uint64_t));
+    buf_ptr += sizeof(na_uint64_t);
+
+    /* Length */
+    memcpy(&len, buf_ptr, sizeof(na_uint64_t));
+    buf_ptr += sizeof(na_uint64_t);
+    na_tcp_mem_handle->len = (size_t) len;
+
+    /* Flags */
+    memcpy(&na_tcp_mem_handle->flags, buf_ptr, sizeof(na_uint8_t));
+
+    *mem_handle = (na_mem_handle_t) na_tcp_mem_handle;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
+    void *arg, na_mem_handle_t local_mem_handle, na_offset_t local_offset,
+    na_mem_handle_t remote_mem_handle, na_offset_t remote_offset,
+    na_size_t length, na_addr_t remote_addr, na_uint8_t NA_UNUSED remote_id,
+    na_op_id_t *op_id)
+{
+    return na_tcp_rma(na_class, context, NA_CB_PUT, callback, arg,
+        (struct na_tcp_mem_handle *) local_mem_handle, local_offset,
+        (struct na_tcp_mem_handle *) remote_mem_handle, remote_offset, length,
+        remote_addr, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
+    void *arg, na_mem_handle_t local_mem_handle, na_offset_t local_offset,
+    na_mem_handle_t remote_mem_handle, na_offset_t remote_offset,
+    na_size_t length, na_addr_t remote_addr, na_uint8_t NA_UNUSED remote_id,
+    na_op_id_t *op_id)
+{
+    return na_tcp_rma(na_class, context, NA_CB_GET, callback, arg,
+        (struct na_tcp_mem_handle *) local_mem_handle, local_offset,
+        (struct na_tcp_mem_handle *) remote_mem_handle, remote_offset, length,
+        remote_addr, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE int
+na_tcp_poll_get_fd(na_class_t *na_class, na_context_t NA_UNUSED *context)
+{
+    int fd = -1;
+
+    /* Do not expose fd if we are not allowed to block */
+    if (!NA_TCP_CLASS(na_class)->no_wait) {
+        fd = hg_poll_get_fd(NA_TCP_CLASS(na_class)->poll_set);
+        NA_CHECK_ERROR_NORET(
+            fd == -1, done, "Could not get poll fd from poll set");
+    }
+
+done:
+    return fd;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_bool_t
+na_tcp_poll_try_wait(
+    na_class_t NA_UNUSED *na_class, na_context_t NA_UNUSED *context)
+{
+    /* Received bytes are never left in connection buffers */
+    return NA_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_progress(
+    na_class_t *na_class, na_context_t *context, unsigned int timeout)
+{
+    struct na_tcp_class *na_tcp_class = NA_TCP_CLASS(na_class);
+    struct hg_poll_event *events = NA_TCP_CONTEXT(context)->events;
+    double remaining =
+        timeout / 1000.0; /* Convert timeout in ms into seconds */
+    na_return_t ret = NA_TIMEOUT;
+
+    /* Poll set and connections are progressed by one thread at a time */
+    hg_thread_mutex_lock(&na_tcp_class->progress_lock);
+
+    do {
+        na_bool_t progressed = NA_FALSE;
+        unsigned int nevents = 0, i;
+        hg_time_t t1, t2;
+        int rc;
+
+        if (timeout)
+            hg_time_get_current_ms(&t1);
+
+        rc = hg_poll_wait(na_tcp_class->poll_set,
+            (na_tcp_class->no_wait) ? 0 : (unsigned int) (remaining * 1000.0),
+            NA_TCP_MAX_EVENTS, events, &nevents);
+        NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret,
+            na_tcp_errno_to_na(errno), "hg_poll_wait() failed");
+
+        /* Process events */
+        for (i = 0; i < nevents; i++) {
+            struct na_tcp_conn *conn;
+            na_bool_t closed = NA_FALSE;
+            unsigned int j;
+
+            /* Connection was closed while processing previous events */
+            if (events[i].data.ptr == NULL)
+                continue;
+
+            switch (*(na_tcp_poll_type_t *) events[i].data.ptr) {
+                case NA_TCP_POLL_LISTEN:
+                    NA_LOG_DEBUG("NA_TCP_POLL_LISTEN event");
+                    ret = na_tcp_progress_listen(na_tcp_class, &progressed);
+                    NA_CHECK_NA_ERROR(
+                        done, ret, "Could not accept connections");
+                    break;
+                case NA_TCP_POLL_CONN:
+                    NA_LOG_DEBUG("NA_TCP_POLL_CONN event");
+                    conn = container_of(
+                        events[i].data.ptr, struct na_tcp_conn, poll_type);
+                    na_tcp_progress_conn(
+                        na_tcp_class, conn, events[i].events, &closed);
+                    if (closed) {
+                        for (j = i + 1; j < nevents; j++)
+                            if (events[j].data.ptr == events[i].data.ptr)
+                                events[j].data.ptr = NULL;
+                    }
+                    progressed = NA_TRUE;
+                    break;
+                default:
+                    NA_GOTO_ERROR(done, ret, NA_INVALID_ARG,
+                        "Operation type %d not supported",
+                        *(na_tcp_poll_type_t *) events[i].data.ptr);
+            }
+        }
+
+        if (timeout) {
+            hg_time_get_current_ms(&t2);
+            remaining -= hg_time_diff(t2, t1);
+        }
+
+        ret = (progressed) ? NA_SUCCESS : NA_TIMEOUT;
+    } while (remaining > 0 && (ret != NA_SUCCESS));
+
+done:
+    hg_thread_mutex_unlock(&na_tcp_class->progress_lock);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_tcp_cancel(
+    na_class_t *na_class, na_context_t NA_UNUSED *context, na_op_id_t op_id)
+{
+    struct na_tcp_class *na_tcp_class = NA_TCP_CLASS(na_class);
+    struct na_tcp_op_queue *op_queue = NULL;
+    struct na_tcp_op_id *na_tcp_op_id = (struct na_tcp_op_id *) op_id;
+    na_return_t ret = NA_SUCCESS;
+
+    /* Exit if op has already completed */
+    if (hg_atomic_or32(&na_tcp_op_id->status, NA_TCP_OP_CANCELED) &
+        NA_TCP_OP_COMPLETED)
+        goto done;
+
+    NA_LOG_DEBUG("Canceling operation ID %p", na_tcp_op_id);
+
+    switch (na_tcp_op_id->completion_data.callback_info.type) {
+        case NA_CB_RECV_UNEXPECTED:
+            /* Must remove op_id from unexpected op queue */
+            op_queue = &na_tcp_class->unexpected_op_queue;
+            break;
+        case NA_CB_RECV_EXPECTED:
+            /* Must remove op_id from expected op queue */
+            op_queue = &na_tcp_class->expected_op_queue;
+            break;
+        case NA_CB_SEND_UNEXPECTED:
+        case NA_CB_SEND_EXPECTED:
+        case NA_CB_PUT:
+        case NA_CB_GET: {
+            struct na_tcp_addr *na_tcp_addr = na_tcp_op_id->na_tcp_addr;
+
+            /* Remove tx entry if nothing has been written yet */
+            hg_thread_mutex_lock(&na_tcp_addr->lock);
+            if ((hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_TX) &&
+                !na_tcp_op_id->tx.started) {
+                HG_QUEUE_REMOVE(&na_tcp_addr->conn->tx_queue,
+                    &na_tcp_op_id->tx, na_tcp_tx, entry);
+                ret = na_tcp_tx_done(
+                    na_tcp_class, &na_tcp_op_id->tx, NA_CANCELED);
+                hg_thread_mutex_unlock(&na_tcp_addr->lock);
+                NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+                goto done;
+            }
+            hg_thread_mutex_unlock(&na_tcp_addr->lock);
+
+            /* Must remove op_id from RMA op queue if waiting for reply */
+            if (na_tcp_op_id->completion_data.callback_info.type ==
+                    NA_CB_PUT ||
+                na_tcp_op_id->completion_data.callback_info.type == NA_CB_GET)
+                op_queue = &na_tcp_class->rma_op_queue;
+        } break;
+        default:
+            NA_GOTO_ERROR(done, ret, NA_INVALID_ARG,
+                "Operation type %d not supported",
+                na_tcp_op_id->completion_data.callback_info.type);
+    }
+
+    /* Remove op id from queue it is on */
+    if (op_queue) {
+        na_bool_t canceled = NA_FALSE;
+
+        hg_thread_spin_lock(&op_queue->lock);
+        if (hg_atomic_get32(&na_tcp_op_id->status) & NA_TCP_OP_QUEUED) {
+            HG_QUEUE_REMOVE(
+                &op_queue->queue, na_tcp_op_id, na_tcp_op_id, entry);
+            hg_atomic_and32(&na_tcp_op_id->status, ~NA_TCP_OP_QUEUED);
+            canceled = NA_TRUE;
+        }
+        hg_thread_spin_unlock(&op_queue->lock);
+
+        /* Cancel op id */
+        if (canceled) {
+            ret = na_tcp_complete(na_tcp_op_id, NA_CANCELED);
+            NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+        }
+    }
+
+done:
+    return ret;
+}
@@ -35,6 +35,7 @@ struct na_init_info {
     const char *auth_key;      /* Authorization key */
     na_uint32_t progress_mode; /* Progress mode */
     na_uint8_t max_contexts;   /* Max contexts */
+    na_uint32_t max_spin_time; /* Max spin time in us (NA_ADAPTIVE_SPIN) */
 };
 
 /* Segment */
@@ -131,13 +132,17 @@ typedef int (*na_cb_t)(const struct na_cb_info *callback_info);
 #define NA_MEM_READWRITE  0x03
 
 /* Progress modes */
-#define NA_NO_BLOCK 0x01 /*!< no blocking progress */
-#define NA_NO_RETRY 0x02 /*!< no retry of operations in progress */
+#define NA_NO_BLOCK      0x01 /*!< no blocking progress */
+#define NA_NO_RETRY      0x02 /*!< no retry of operations in progress */
+#define NA_ADAPTIVE_SPIN 0x04 /*!< spin for a self-tuned time before blocking */
+
+/* Default max spin time (us) used with NA_ADAPTIVE_SPIN */
+#define NA_SPIN_TIME_DEFAULT 50
 
 /* NA init info initializer */
 #define NA_INIT_INFO_INITIALIZER                                               \
     {                                                                          \
-        NULL, NULL, 0, 1                                                       \
+        NULL, NULL, 0, 1, 0                                                    \
     }
 
 #endif /* NA_TYPES_H */
@@ -36,6 +36,7 @@ hg_proc_hg_string_object_t(hg_proc_t proc, void *string)
 
     switch (hg_proc_get_op(proc)) {
         case HG_ENCODE:
+        case HG_SIZE:
             string_len = (strobj->data) ? strlen(strobj->data) + 1 : 0;
             ret = hg_proc_uint64_t(proc, &string_len);
             if (ret != HG_SUCCESS)
@@ -59,28 +60,28 @@ hg_proc_hg_string_object_t(hg_proc_t proc, void *string)
             if (ret != HG_SUCCESS)
                 goto done;
             if (string_len) {
-                strobj->data = (char *) malloc(string_len);
+                strobj->data = (char *) hg_proc_arena_alloc(proc, string_len);
                 if (strobj->data == NULL) {
                     ret = HG_NOMEM;
                     goto done;
                 }
                 ret = hg_proc_bytes(proc, strobj->data, string_len);
                 if (ret != HG_SUCCESS) {
-                    free(strobj->data);
+                    hg_proc_arena_free(proc, strobj->data);
                     strobj->data = NULL;
                     goto done;
                 }
                 ret =
                     hg_proc_hg_uint8_t(proc, (hg_uint8_t *) &strobj->is_const);
                 if (ret != HG_SUCCESS) {
-                    free(strobj->data);
+                    hg_proc_arena_free(proc, strobj->data);
                     strobj->data = NULL;
                     goto done;
                 }
                 ret =
                     hg_proc_hg_uint8_t(proc, (hg_uint8_t *) &strobj->is_owned);
                 if (ret != HG_SUCCESS) {
-                    free(strobj->data);
+                    hg_proc_arena_free(proc, strobj->data);
                     strobj->data = NULL;
                     goto done;
                 }
@@ -88,9 +89,11 @@ hg_proc_hg_string_object_t(hg_proc_t proc, void *string)
                 strobj->data = NULL;
             break;
         case HG_FREE:
-            ret = hg_string_object_free(strobj);
-            if (ret != HG_SUCCESS)
-                goto done;
+            /* Data decoded into an arena is released with the arena */
+            if (strobj->is_owned) {
+                hg_proc_arena_free(proc, strobj->data);
+                strobj->data = NULL;
+            }
             break;
         default:
             break;
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_proc_view.h"
+#include "mercury_error.h"
+
+/****************/
+/* Local Macros */
+/****************/
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Encode bytes or decode pointer to bytes in place.
+ */
+static hg_return_t
+hg_proc_view(hg_proc_t proc, const void **data, hg_size_t size);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_view(hg_proc_t proc, const void **data, hg_size_t size)
+{
+    void *buf;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Only account for size */
+    if (hg_proc_get_op(proc) == HG_SIZE) {
+        hg_proc_save_ptr(proc, size);
+        goto done;
+    }
+
+    if (hg_proc_get_op(proc) == HG_ENCODE)
+        HG_PROC_CHECK_SIZE(proc, size, done, ret);
+    else
+        /* Data must be contained in the buffer being decoded */
+        HG_CHECK_ERROR(hg_proc_get_size_left(proc) < size, done, ret,
+            HG_OVERFLOW, "View of %zu bytes exceeds buffer size", size);
+
+    buf = hg_proc_save_ptr(proc, size);
+    if (hg_proc_get_op(proc) == HG_ENCODE)
+        memcpy(buf, *data, size);
+    else
+        *data = buf;
+    ret = hg_proc_restore_ptr(proc, buf, size);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_hg_const_string_view_t(hg_proc_t proc, void *data)
+{
+    hg_const_string_view_t *view = (hg_const_string_view_t *) data;
+    hg_uint64_t string_len = 0;
+    hg_uint8_t is_const = 1, is_owned = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_ENCODE:
+        case HG_SIZE:
+            string_len = (view->data) ? view->len + 1 : 0;
+            ret = hg_proc_uint64_t(proc, &string_len);
+            if (ret != HG_SUCCESS || !string_len)
+                goto done;
+            ret = hg_proc_view(
+                proc, (const void **) &view->data, (hg_size_t) string_len);
+            if (ret != HG_SUCCESS)
+                goto done;
+            ret = hg_proc_hg_uint8_t(proc, &is_const);
+            if (ret != HG_SUCCESS)
+                goto done;
+            ret = hg_proc_hg_uint8_t(proc, &is_owned);
+            if (ret != HG_SUCCESS)
+                goto done;
+            break;
+        case HG_DECODE:
+            view->data = NULL;
+            view->len = 0;
+            ret = hg_proc_uint64_t(proc, &string_len);
+            if (ret != HG_SUCCESS || !string_len)
+                goto done;
+            ret = hg_proc_view(
+                proc, (const void **) &view->data, (hg_size_t) string_len);
+            if (ret != HG_SUCCESS)
+                goto done;
+            HG_CHECK_ERROR(view->data[string_len - 1] != '\0', done, ret,
+                HG_PROTOCOL_ERROR, "String is not NULL-terminated");
+            view->len = (hg_size_t) string_len - 1;
+            /* Flags are only meaningful to hg_string_object_t */
+            ret = hg_proc_hg_uint8_t(proc, &is_const);
+            if (ret != HG_SUCCESS)
+                goto done;
+            ret = hg_proc_hg_uint8_t(proc, &is_owned);
+            if (ret != HG_SUCCESS)
+                goto done;
+            break;
+        case HG_FREE:
+            /* Nothing was allocated */
+            view->data = NULL;
+            view->len = 0;
+            break;
+        default:
+            break;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_hg_bytes_view_t(hg_proc_t proc, void *data)
+{
+    hg_bytes_view_t *view = (hg_bytes_view_t *) data;
+    hg_uint64_t size = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_ENCODE:
+        case HG_SIZE:
+            size = (hg_uint64_t) view->size;
+            ret = hg_proc_uint64_t(proc, &size);
+            if (ret != HG_SUCCESS || !size)
+                goto done;
+            ret = hg_proc_view(proc, &view->data, view->size);
+            break;
+        case HG_DECODE:
+            view->data = NULL;
+            ret = hg_proc_uint64_t(proc, &size);
+            if (ret != HG_SUCCESS)
+                goto done;
+            view->size = (hg_size_t) size;
+            if (!size)
+                goto done;
+            ret = hg_proc_view(proc, &view->data, view->size);
+            break;
+        case HG_FREE:
+            /* Nothing was allocated */
+            view->data = NULL;
+            view->size = 0;
+            break;
+        default:
+            break;
+    }
+
+done:
+    return ret;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_PROC_VIEW_H
+#define MERCURY_PROC_VIEW_H
+
+#include "mercury_proc.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Borrowed views are decoded to a pointer into the buffer being decoded, data
+ * is not copied and remains valid until the decoded struct is freed (e.g.,
+ * HG_Free_input()), which is also when the handle releases that buffer. */
+
+/* String view, encoded as a hg_const_string_t */
+typedef struct hg_const_string_view {
+    const char *data; /* NULL-terminated string or NULL */
+    hg_size_t len;    /* String length, not including terminating NULL */
+} hg_const_string_view_t;
+
+/* Byte array view */
+typedef struct hg_bytes_view {
+    const void *data; /* Bytes or NULL if size is 0 */
+    hg_size_t size;   /* Number of bytes */
+} hg_bytes_view_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Generic processing routine. The encoding is the same as hg_const_string_t
+ * so that either type can be used on each side. When encoding, data[len]
+ * must be the terminating NULL character.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to string view
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+hg_proc_hg_const_string_view_t(hg_proc_t proc, void *data);
+
+/**
+ * Generic processing routine.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to byte array view
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+hg_proc_hg_bytes_view_t(hg_proc_t proc, void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_PROC_VIEW_H */
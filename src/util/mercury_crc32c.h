@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* CRC32C (Castagnoli) checksums. The SSE4.2 crc32 instruction is used when
+ * the CPU supports it, ARMv8 CRC instructions are used when the compiler
+ * targets them, a portable slicing-by-8 implementation is used otherwise.
+ * CRC values follow the usual convention (initial and final values are
+ * inverted) so that they can be chained by passing the previous value,
+ * starting from 0. */
+
+#ifndef MERCURY_CRC32C_H
+#define MERCURY_CRC32C_H
+
+#include "mercury_util_config.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+/**
+ * Update CRC with the content of a buffer.
+ *
+ * \param crc [IN]              previous CRC value (0 for first buffer)
+ * \param buf [IN]              pointer to buffer
+ * \param size [IN]             buffer size
+ *
+ * \return new CRC value
+ */
+HG_UTIL_PUBLIC hg_util_uint32_t
+hg_crc32c_update(hg_util_uint32_t crc, const void *buf, size_t size);
+
+/**
+ * Copy a buffer and update CRC with its content, reading it only once.
+ * Buffers must not overlap.
+ *
+ * \param crc [IN]              previous CRC value (0 for first buffer)
+ * \param dst [OUT]             pointer to destination buffer
+ * \param src [IN]              pointer to source buffer
+ * \param size [IN]             buffer size
+ *
+ * \return new CRC value
+ */
+HG_UTIL_PUBLIC hg_util_uint32_t
+hg_crc32c_copy(
+    hg_util_uint32_t crc, void *dst, const void *src, size_t size);
+
+/**
+ * Update CRC using the portable implementation only. Results are identical
+ * to hg_crc32c_update().
+ *
+ * \param crc [IN]              previous CRC value (0 for first buffer)
+ * \param buf [IN]              pointer to buffer
+ * \param size [IN]             buffer size
+ *
+ * \return new CRC value
+ */
+HG_UTIL_PUBLIC hg_util_uint32_t
+hg_crc32c_update_sw(hg_util_uint32_t crc, const void *buf, size_t size);
+
+/**
+ * Name of the implementation used by hg_crc32c_update() / hg_crc32c_copy().
+ *
+ * \return "sse4.2", "armv8" or "slicing-by-8"
+ */
+HG_UTIL_PUBLIC const char *
+hg_crc32c_impl_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_CRC32C_H */
@@ -0,0 +1,581 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_hash_map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#endif
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Control byte values, full slots hold the low 7 bits of the hash */
+#define HG_HASH_MAP_EMPTY   ((unsigned char) 0x80)
+#define HG_HASH_MAP_DELETED ((unsigned char) 0xFE)
+
+/* Split hash into group probe position and control byte */
+#define HG_HASH_MAP_H1(hash) ((hash) >> 7)
+#define HG_HASH_MAP_H2(hash) ((unsigned char) ((hash) & 0x7F))
+
+/* Rehash when full and deleted slots exceed 7/8 of the slots */
+#define HG_HASH_MAP_FULL(count, size) ((count) * 8 > (size) * 7)
+
+/* Group of control bytes that are matched at once. Matches are returned as
+ * a bit mask with HG_HASH_MAP_GROUP_SHIFT bits per control byte. */
+#if defined(__SSE2__)
+#    define HG_HASH_MAP_GROUP_WIDTH 16
+#    define HG_HASH_MAP_GROUP_SHIFT 0
+typedef unsigned int hg_hash_map_mask_t;
+#else
+#    define HG_HASH_MAP_GROUP_WIDTH 8
+#    define HG_HASH_MAP_GROUP_SHIFT 3
+typedef hg_util_uint64_t hg_hash_map_mask_t;
+#    define HG_HASH_MAP_LSBS ((hg_util_uint64_t) 0x0101010101010101ULL)
+#    define HG_HASH_MAP_MSBS ((hg_util_uint64_t) 0x8080808080808080ULL)
+#endif
+
+/* Initial number of slots (power of 2, at least one group) */
+#define HG_HASH_MAP_MIN_SIZE 16
+
+/* Index of lowest / highest set bit in a non-zero mask */
+#if defined(__GNUC__)
+#    define HG_HASH_MAP_CTZ(mask) ((unsigned int) __builtin_ctzll(mask))
+#    define HG_HASH_MAP_CLZ(mask)                                              \
+        ((unsigned int) __builtin_clzll(mask) -                                \
+            (64 - (HG_HASH_MAP_GROUP_WIDTH << HG_HASH_MAP_GROUP_SHIFT)))
+#else
+#    define HG_HASH_MAP_CTZ(mask) hg_hash_map_ctz(mask)
+#    define HG_HASH_MAP_CLZ(mask) hg_hash_map_clz(mask)
+#endif
+
+/* Iterate over set bits of a mask, yields group offsets */
+#define HG_HASH_MAP_MASK_NEXT(mask) ((mask) & ((mask) - 1))
+#define HG_HASH_MAP_MASK_OFFSET(mask)                                          \
+    (HG_HASH_MAP_CTZ(mask) >> HG_HASH_MAP_GROUP_SHIFT)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_hash_map_slot {
+    hg_hash_map_key_t key;
+    hg_hash_map_value_t value;
+};
+
+struct hg_hash_map {
+    unsigned char *ctrl;                           /* Control bytes */
+    struct hg_hash_map_slot *slots;                /* Keys and values */
+    hg_hash_map_hash_func_t hash_func;             /* Key hash function */
+    hg_hash_map_equal_func_t equal_func;           /* Key compare function */
+    hg_hash_map_key_free_func_t key_free_func;     /* Key free function */
+    hg_hash_map_value_free_func_t value_free_func; /* Value free function */
+    unsigned int mask;                             /* Number of slots - 1 */
+    unsigned int num_entries;                      /* Number of entries */
+    unsigned int num_deleted;                      /* Number of tombstones */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+#if !defined(__GNUC__)
+/**
+ * Portable bit scans.
+ */
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_ctz(hg_hash_map_mask_t mask);
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_clz(hg_hash_map_mask_t mask);
+#endif
+
+/**
+ * Match control bytes of group starting at ctrl.
+ */
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match(const unsigned char *ctrl, unsigned char h2);
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty(const unsigned char *ctrl);
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty_or_deleted(const unsigned char *ctrl);
+
+/**
+ * Hash key and mix bits so that weak hash functions still spread evenly.
+ */
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_hash(hg_hash_map_t *hash_map, hg_hash_map_key_t key);
+
+/**
+ * Set control byte, keeping the copy of the first group past the end in
+ * sync so that groups can be loaded at any slot without wrapping.
+ */
+static HG_UTIL_INLINE void
+hg_hash_map_set_ctrl(
+    hg_hash_map_t *hash_map, unsigned int slot, unsigned char value);
+
+/**
+ * Allocate control bytes and slots for size slots.
+ */
+static int
+hg_hash_map_alloc(hg_hash_map_t *hash_map, unsigned int size);
+
+/**
+ * Find first empty or deleted slot in probe sequence of hash.
+ */
+static unsigned int
+hg_hash_map_find_free(hg_hash_map_t *hash_map, unsigned int hash);
+
+/**
+ * Re-place existing entries into size slots, dropping tombstones.
+ */
+static int
+hg_hash_map_rehash(hg_hash_map_t *hash_map, unsigned int size);
+
+/**
+ * Find slot holding key, returns -1 if not found.
+ */
+static HG_UTIL_INLINE long
+hg_hash_map_find(
+    hg_hash_map_t *hash_map, unsigned int hash, hg_hash_map_key_t key);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/*---------------------------------------------------------------------------*/
+#if !defined(__GNUC__)
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_ctz(hg_hash_map_mask_t mask)
+{
+    unsigned int n = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_clz(hg_hash_map_mask_t mask)
+{
+    unsigned int n = 0,
+                 bit = (HG_HASH_MAP_GROUP_WIDTH << HG_HASH_MAP_GROUP_SHIFT) - 1;
+
+    while (!((mask >> bit) & 1)) {
+        bit--;
+        n++;
+    }
+
+    return n;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if defined(__SSE2__)
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match(const unsigned char *ctrl, unsigned char h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+
+    return (hg_hash_map_mask_t) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8((char) h2), group));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty(const unsigned char *ctrl)
+{
+    return hg_hash_map_match(ctrl, HG_HASH_MAP_EMPTY);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty_or_deleted(const unsigned char *ctrl)
+{
+    /* Only empty and deleted bytes have their high bit set */
+    return (hg_hash_map_mask_t) _mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *) ctrl));
+}
+#else
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_hash_map_load(const unsigned char *ctrl)
+{
+    hg_util_uint64_t group;
+
+    memcpy(&group, ctrl, sizeof(group));
+#    if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    group = __builtin_bswap64(group);
+#    endif
+
+    return group;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match(const unsigned char *ctrl, unsigned char h2)
+{
+    /* May report false positives, which are filtered by key comparison */
+    hg_util_uint64_t x = hg_hash_map_load(ctrl) ^ (HG_HASH_MAP_LSBS * h2);
+
+    return (x - HG_HASH_MAP_LSBS) & ~x & HG_HASH_MAP_MSBS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty(const unsigned char *ctrl)
+{
+    hg_util_uint64_t group = hg_hash_map_load(ctrl);
+
+    /* High bit set and bit 1 clear */
+    return group & ~(group << 6) & HG_HASH_MAP_MSBS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_hash_map_mask_t
+hg_hash_map_match_empty_or_deleted(const unsigned char *ctrl)
+{
+    return hg_hash_map_load(ctrl) & HG_HASH_MAP_MSBS;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hg_hash_map_hash(hg_hash_map_t *hash_map, hg_hash_map_key_t key)
+{
+    unsigned int hash = hash_map->hash_func(key);
+
+    /* Murmur3 finalizer */
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_hash_map_set_ctrl(
+    hg_hash_map_t *hash_map, unsigned int slot, unsigned char value)
+{
+    hash_map->ctrl[slot] = value;
+    if (slot < HG_HASH_MAP_GROUP_WIDTH)
+        hash_map->ctrl[hash_map->mask + 1 + slot] = value;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_hash_map_alloc(hg_hash_map_t *hash_map, unsigned int size)
+{
+    hash_map->ctrl = (unsigned char *) malloc(size + HG_HASH_MAP_GROUP_WIDTH);
+    if (hash_map->ctrl == NULL)
+        return 0;
+
+    hash_map->slots =
+        (struct hg_hash_map_slot *) malloc(size * sizeof(*hash_map->slots));
+    if (hash_map->slots == NULL) {
+        free(hash_map->ctrl);
+        return 0;
+    }
+
+    memset(hash_map->ctrl, HG_HASH_MAP_EMPTY, size + HG_HASH_MAP_GROUP_WIDTH);
+    hash_map->mask = size - 1;
+    hash_map->num_deleted = 0;
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+hg_hash_map_find_free(hg_hash_map_t *hash_map, unsigned int hash)
+{
+    unsigned int pos = HG_HASH_MAP_H1(hash) & hash_map->mask, step = 0;
+
+    /* Load factor guarantees that a free slot exists */
+    for (;;) {
+        hg_hash_map_mask_t match =
+            hg_hash_map_match_empty_or_deleted(hash_map->ctrl + pos);
+
+        if (match)
+            return (pos + HG_HASH_MAP_MASK_OFFSET(match)) & hash_map->mask;
+
+        /* Triangular probing over groups visits every group */
+        step += HG_HASH_MAP_GROUP_WIDTH;
+        pos = (pos + step) & hash_map->mask;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_hash_map_rehash(hg_hash_map_t *hash_map, unsigned int size)
+{
+    unsigned char *old_ctrl = hash_map->ctrl;
+    struct hg_hash_map_slot *old_slots = hash_map->slots;
+    unsigned int old_size = hash_map->mask + 1, i;
+
+    if (!hg_hash_map_alloc(hash_map, size)) {
+        hash_map->ctrl = old_ctrl;
+        hash_map->slots = old_slots;
+        return 0;
+    }
+
+    for (i = 0; i < old_size; i++) {
+        unsigned int hash, slot;
+
+        if (old_ctrl[i] & HG_HASH_MAP_EMPTY)
+            continue;
+
+        hash = hg_hash_map_hash(hash_map, old_slots[i].key);
+        slot = hg_hash_map_find_free(hash_map, hash);
+        hg_hash_map_set_ctrl(hash_map, slot, HG_HASH_MAP_H2(hash));
+        hash_map->slots[slot] = old_slots[i];
+    }
+
+    free(old_ctrl);
+    free(old_slots);
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE long
+hg_hash_map_find(
+    hg_hash_map_t *hash_map, unsigned int hash, hg_hash_map_key_t key)
+{
+    unsigned int pos = HG_HASH_MAP_H1(hash) & hash_map->mask, step = 0;
+    unsigned char h2 = HG_HASH_MAP_H2(hash);
+
+    for (;;) {
+        const unsigned char *group = hash_map->ctrl + pos;
+        hg_hash_map_mask_t match = hg_hash_map_match(group, h2);
+
+        while (match) {
+            unsigned int slot =
+                (pos + HG_HASH_MAP_MASK_OFFSET(match)) & hash_map->mask;
+
+            if (hash_map->equal_func(hash_map->slots[slot].key, key))
+                return (long) slot;
+            match = HG_HASH_MAP_MASK_NEXT(match);
+        }
+
+        /* An empty slot ends the probe sequence */
+        if (hg_hash_map_match_empty(group))
+            return -1;
+
+        step += HG_HASH_MAP_GROUP_WIDTH;
+        pos = (pos + step) & hash_map->mask;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_map_t *
+hg_hash_map_new(
+    hg_hash_map_hash_func_t hash_func, hg_hash_map_equal_func_t equal_func)
+{
+    hg_hash_map_t *hash_map;
+
+    hash_map = (hg_hash_map_t *) malloc(sizeof(hg_hash_map_t));
+    if (hash_map == NULL)
+        return NULL;
+
+    hash_map->hash_func = hash_func;
+    hash_map->equal_func = equal_func;
+    hash_map->key_free_func = NULL;
+    hash_map->value_free_func = NULL;
+    hash_map->num_entries = 0;
+
+    if (!hg_hash_map_alloc(hash_map, HG_HASH_MAP_MIN_SIZE)) {
+        free(hash_map);
+        return NULL;
+    }
+
+    return hash_map;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_map_free(hg_hash_map_t *hash_map)
+{
+    unsigned int i;
+
+    if (hash_map->key_free_func != NULL || hash_map->value_free_func != NULL) {
+        for (i = 0; i <= hash_map->mask; i++) {
+            if (hash_map->ctrl[i] & HG_HASH_MAP_EMPTY)
+                continue;
+            if (hash_map->key_free_func != NULL)
+                hash_map->key_free_func(hash_map->slots[i].key);
+            if (hash_map->value_free_func != NULL)
+                hash_map->value_free_func(hash_map->slots[i].value);
+        }
+    }
+
+    free(hash_map->ctrl);
+    free(hash_map->slots);
+    free(hash_map);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_map_register_free_functions(hg_hash_map_t *hash_map,
+    hg_hash_map_key_free_func_t key_free_func,
+    hg_hash_map_value_free_func_t value_free_func)
+{
+    hash_map->key_free_func = key_free_func;
+    hash_map->value_free_func = value_free_func;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_map_insert(
+    hg_hash_map_t *hash_map, hg_hash_map_key_t key, hg_hash_map_value_t value)
+{
+    unsigned int hash = hg_hash_map_hash(hash_map, key), slot;
+    long found;
+
+    /* Overwrite existing entry */
+    found = hg_hash_map_find(hash_map, hash, key);
+    if (found >= 0) {
+        struct hg_hash_map_slot *entry = &hash_map->slots[found];
+
+        if (hash_map->value_free_func != NULL)
+            hash_map->value_free_func(entry->value);
+        if (hash_map->key_free_func != NULL)
+            hash_map->key_free_func(entry->key);
+        entry->key = key;
+        entry->value = value;
+
+        return 1;
+    }
+
+    /* Grow if mostly full, otherwise only drop tombstones */
+    if (HG_HASH_MAP_FULL(hash_map->num_entries + hash_map->num_deleted + 1,
+            hash_map->mask + 1)) {
+        unsigned int size = hash_map->mask + 1;
+
+        if (HG_HASH_MAP_FULL(hash_map->num_entries * 2 + 2, size))
+            size *= 2;
+        if (!hg_hash_map_rehash(hash_map, size))
+            return 0;
+    }
+
+    slot = hg_hash_map_find_free(hash_map, hash);
+    if (hash_map->ctrl[slot] == HG_HASH_MAP_DELETED)
+        hash_map->num_deleted--;
+    hg_hash_map_set_ctrl(hash_map, slot, HG_HASH_MAP_H2(hash));
+    hash_map->slots[slot].key = key;
+    hash_map->slots[slot].value = value;
+    hash_map->num_entries++;
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_map_value_t
+hg_hash_map_lookup(hg_hash_map_t *hash_map, hg_hash_map_key_t key)
+{
+    long slot =
+        hg_hash_map_find(hash_map, hg_hash_map_hash(hash_map, key), key);
+
+    return (slot >= 0) ? hash_map->slots[slot].value : HG_HASH_MAP_NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_map_remove(hg_hash_map_t *hash_map, hg_hash_map_key_t key)
+{
+    long found =
+        hg_hash_map_find(hash_map, hg_hash_map_hash(hash_map, key), key);
+    hg_hash_map_mask_t empty_before, empty_after;
+    unsigned int slot;
+
+    if (found < 0)
+        return 0;
+    slot = (unsigned int) found;
+
+    if (hash_map->key_free_func != NULL)
+        hash_map->key_free_func(hash_map->slots[slot].key);
+    if (hash_map->value_free_func != NULL)
+        hash_map->value_free_func(hash_map->slots[slot].value);
+
+    /* Slot can be marked empty again if no group containing it was ever
+     * full, i.e., no probe sequence could have continued past it */
+    empty_before = hg_hash_map_match_empty(hash_map->ctrl +
+                                           ((slot - HG_HASH_MAP_GROUP_WIDTH) &
+                                               hash_map->mask));
+    empty_after = hg_hash_map_match_empty(hash_map->ctrl + slot);
+    if (empty_before && empty_after &&
+        (HG_HASH_MAP_CLZ(empty_before) >> HG_HASH_MAP_GROUP_SHIFT) +
+                (HG_HASH_MAP_CTZ(empty_after) >> HG_HASH_MAP_GROUP_SHIFT) <
+            HG_HASH_MAP_GROUP_WIDTH)
+        hg_hash_map_set_ctrl(hash_map, slot, HG_HASH_MAP_EMPTY);
+    else {
+        hg_hash_map_set_ctrl(hash_map, slot, HG_HASH_MAP_DELETED);
+        hash_map->num_deleted++;
+    }
+    hash_map->num_entries--;
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_hash_map_num_entries(hg_hash_map_t *hash_map)
+{
+    return hash_map->num_entries;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_map_iterate(hg_hash_map_t *hash_map, hg_hash_map_iter_t *iter)
+{
+    unsigned int slot = 0;
+
+    while (slot <= hash_map->mask && (hash_map->ctrl[slot] & HG_HASH_MAP_EMPTY))
+        slot++;
+
+    iter->hash_map = hash_map;
+    iter->next_slot = slot;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_map_iter_has_more(hg_hash_map_iter_t *iter)
+{
+    return iter->next_slot <= iter->hash_map->mask;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_map_value_t
+hg_hash_map_iter_next(hg_hash_map_iter_t *iter)
+{
+    hg_hash_map_t *hash_map = iter->hash_map;
+    unsigned int slot = iter->next_slot;
+    hg_hash_map_value_t value;
+
+    if (slot > hash_map->mask)
+        return HG_HASH_MAP_NULL;
+    value = hash_map->slots[slot].value;
+
+    for (slot++; slot <= hash_map->mask; slot++)
+        if (!(hash_map->ctrl[slot] & HG_HASH_MAP_EMPTY))
+            break;
+    iter->next_slot = slot;
+
+    return value;
+}
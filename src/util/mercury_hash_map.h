@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Open-addressing hash table with SwissTable-style group probing. Keys and
+ * values are stored inline in a single slot array, a parallel array of one
+ * control byte per slot (7 bits of hash or empty / deleted) is matched a
+ * group at a time (SSE2 when available, 64-bit words otherwise), entries are
+ * never allocated individually and lookups do not chase pointers. The API
+ * mirrors mercury_hash_table.h so that users of the chained table can switch
+ * over by renaming calls. */
+
+#ifndef MERCURY_HASH_MAP_H
+#define MERCURY_HASH_MAP_H
+
+#include "mercury_util_config.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+typedef struct hg_hash_map hg_hash_map_t;
+typedef void *hg_hash_map_key_t;
+typedef void *hg_hash_map_value_t;
+
+/* Hash function used to generate hash values for keys */
+typedef unsigned int (*hg_hash_map_hash_func_t)(hg_hash_map_key_t key);
+
+/* Function used to compare two keys, returns non-zero if equal */
+typedef int (*hg_hash_map_equal_func_t)(
+    hg_hash_map_key_t key1, hg_hash_map_key_t key2);
+
+/* Functions used to free keys and values when entries are removed */
+typedef void (*hg_hash_map_key_free_func_t)(hg_hash_map_key_t key);
+typedef void (*hg_hash_map_value_free_func_t)(hg_hash_map_value_t value);
+
+/* Iterator, the map must not be modified while iterating */
+typedef struct hg_hash_map_iter {
+    hg_hash_map_t *hash_map;
+    unsigned int next_slot;
+} hg_hash_map_iter_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+#define HG_HASH_MAP_NULL ((void *) 0)
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create a new hash map.
+ *
+ * \param hash_func [IN]        function used to hash keys
+ * \param equal_func [IN]       function used to compare keys
+ *
+ * \return pointer to new hash map or NULL on failure
+ */
+HG_UTIL_PUBLIC hg_hash_map_t *
+hg_hash_map_new(
+    hg_hash_map_hash_func_t hash_func, hg_hash_map_equal_func_t equal_func);
+
+/**
+ * Destroy a hash map, calling the registered free functions on remaining
+ * entries.
+ *
+ * \param hash_map [IN/OUT]     pointer to hash map
+ */
+HG_UTIL_PUBLIC void
+hg_hash_map_free(hg_hash_map_t *hash_map);
+
+/**
+ * Register functions used to free keys and values when entries are removed.
+ *
+ * \param hash_map [IN/OUT]     pointer to hash map
+ * \param key_free_func [IN]    function used to free keys
+ * \param value_free_func [IN]  function used to free values
+ */
+HG_UTIL_PUBLIC void
+hg_hash_map_register_free_functions(hg_hash_map_t *hash_map,
+    hg_hash_map_key_free_func_t key_free_func,
+    hg_hash_map_value_free_func_t value_free_func);
+
+/**
+ * Insert a value, overwriting any existing entry that has the same key.
+ * Memory is only allocated when the map needs to grow.
+ *
+ * \param hash_map [IN/OUT]     pointer to hash map
+ * \param key [IN]              key
+ * \param value [IN]            value
+ *
+ * \return Non-zero on success or zero if the map could not be grown
+ */
+HG_UTIL_PUBLIC int
+hg_hash_map_insert(
+    hg_hash_map_t *hash_map, hg_hash_map_key_t key, hg_hash_map_value_t value);
+
+/**
+ * Look up a value by key.
+ *
+ * \param hash_map [IN]         pointer to hash map
+ * \param key [IN]              key
+ *
+ * \return value or HG_HASH_MAP_NULL if key is not present
+ */
+HG_UTIL_PUBLIC hg_hash_map_value_t
+hg_hash_map_lookup(hg_hash_map_t *hash_map, hg_hash_map_key_t key);
+
+/**
+ * Remove an entry by key.
+ *
+ * \param hash_map [IN/OUT]     pointer to hash map
+ * \param key [IN]              key
+ *
+ * \return Non-zero if an entry was removed or zero if key was not present
+ */
+HG_UTIL_PUBLIC int
+hg_hash_map_remove(hg_hash_map_t *hash_map, hg_hash_map_key_t key);
+
+/**
+ * Retrieve the number of entries.
+ *
+ * \param hash_map [IN]         pointer to hash map
+ *
+ * \return number of entries
+ */
+HG_UTIL_PUBLIC unsigned int
+hg_hash_map_num_entries(hg_hash_map_t *hash_map);
+
+/**
+ * Initialize an iterator over the entries of a hash map.
+ *
+ * \param hash_map [IN]         pointer to hash map
+ * \param iter [OUT]            pointer to iterator
+ */
+HG_UTIL_PUBLIC void
+hg_hash_map_iterate(hg_hash_map_t *hash_map, hg_hash_map_iter_t *iter);
+
+/**
+ * Determine if there are more entries to iterate over.
+ *
+ * \param iter [IN]             pointer to iterator
+ *
+ * \return Non-zero if there are more entries
+ */
+HG_UTIL_PUBLIC int
+hg_hash_map_iter_has_more(hg_hash_map_iter_t *iter);
+
+/**
+ * Retrieve the value of the next entry.
+ *
+ * \param iter [IN/OUT]         pointer to iterator
+ *
+ * \return value or HG_HASH_MAP_NULL if there are no more entries
+ */
+HG_UTIL_PUBLIC hg_hash_map_value_t
+hg_hash_map_iter_next(hg_hash_map_iter_t *iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_HASH_MAP_H */
@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_mpmc_queue.h"
+#include "mercury_util_error.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Number of entries per segment */
+#define HG_MPMC_QUEUE_SEGMENT_SIZE 256
+
+/* For busy loop spinning */
+#ifndef cpu_spinwait
+#    if defined(_WIN32)
+#        define cpu_spinwait YieldProcessor
+#    elif defined(__x86_64__) || defined(__i386__)
+#        include <immintrin.h>
+#        define cpu_spinwait _mm_pause
+#    elif defined(__arm__)
+#        define cpu_spinwait() __asm__ __volatile__("yield")
+#    else
+#        warning "Processor yield is not supported on this architecture."
+#        define cpu_spinwait(x)
+#    endif
+#endif
+
+/* Pointer <-> 64-bit atomic conversion */
+#define HG_MPMC_QUEUE_SEGMENT(x) ((struct hg_mpmc_queue_segment *) (x))
+#define HG_MPMC_QUEUE_VALUE(x)   ((hg_util_int64_t)(x))
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Segment of entries, tickets [id * SEGMENT_SIZE, (id + 1) * SEGMENT_SIZE) */
+struct hg_mpmc_queue_segment {
+    hg_atomic_int64_t next;                     /* Next segment */
+    struct hg_mpmc_queue_segment *retired_next; /* Next retired segment */
+    hg_util_int64_t id;                         /* Segment index */
+    hg_util_int32_t retire_epoch;               /* Epoch of retirement */
+    hg_atomic_int32_t consumed;                 /* Consumed entries */
+
+    /* Entries */
+    hg_atomic_int64_t slots[HG_MPMC_QUEUE_SEGMENT_SIZE]
+        __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Allocate new segment.
+ */
+static struct hg_mpmc_queue_segment *
+hg_mpmc_queue_segment_alloc(hg_util_int64_t id);
+
+/**
+ * Find segment of index id, starting from segment seg. Segments are
+ * allocated if necessary.
+ */
+static struct hg_mpmc_queue_segment *
+hg_mpmc_queue_segment_find(struct hg_mpmc_queue_segment *seg,
+    hg_util_int64_t id, hg_util_bool_t alloc);
+
+/**
+ * Unlink fully consumed segments from the head of the queue.
+ */
+static void
+hg_mpmc_queue_advance_head(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/**
+ * Enter epoch, segments cannot be freed while a thread is inside an epoch.
+ */
+static hg_util_int32_t
+hg_mpmc_queue_epoch_enter(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/**
+ * Exit epoch and reclaim retired segments that are no longer referenced.
+ */
+static void
+hg_mpmc_queue_epoch_exit(
+    struct hg_mpmc_queue *hg_mpmc_queue, hg_util_int32_t epoch);
+
+/**
+ * Retire segment.
+ */
+static void
+hg_mpmc_queue_retire(struct hg_mpmc_queue *hg_mpmc_queue,
+    struct hg_mpmc_queue_segment *seg);
+
+/**
+ * Free segments that were retired at least two epochs ago.
+ */
+static void
+hg_mpmc_queue_reclaim(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/*---------------------------------------------------------------------------*/
+static struct hg_mpmc_queue_segment *
+hg_mpmc_queue_segment_alloc(hg_util_int64_t id)
+{
+    struct hg_mpmc_queue_segment *seg;
+
+    seg = hg_mem_aligned_alloc(
+        HG_MEM_CACHE_LINE_SIZE, sizeof(struct hg_mpmc_queue_segment));
+    HG_UTIL_CHECK_ERROR_NORET(
+        seg == NULL, done, "Could not allocate queue segment");
+
+    memset(seg, 0, sizeof(struct hg_mpmc_queue_segment));
+    seg->id = id;
+
+done:
+    return seg;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_mpmc_queue_segment *
+hg_mpmc_queue_segment_find(struct hg_mpmc_queue_segment *seg,
+    hg_util_int64_t id, hg_util_bool_t alloc)
+{
+    while (seg->id < id) {
+        struct hg_mpmc_queue_segment *next =
+            HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&seg->next));
+
+        if (next == NULL) {
+            if (!alloc) {
+                /* Producer has not linked next segment yet */
+                cpu_spinwait();
+                continue;
+            }
+            next = hg_mpmc_queue_segment_alloc(seg->id + 1);
+            if (next == NULL)
+                return NULL;
+            if (!hg_atomic_cas64(&seg->next, 0, HG_MPMC_QUEUE_VALUE(next))) {
+                hg_mem_aligned_free(next);
+                next = HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&seg->next));
+            }
+        }
+        seg = next;
+    }
+
+    return seg;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_mpmc_queue_advance_head(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    for (;;) {
+        struct hg_mpmc_queue_segment *seg = HG_MPMC_QUEUE_SEGMENT(
+            hg_atomic_get64(&hg_mpmc_queue->head_segment));
+        struct hg_mpmc_queue_segment *next, *tail_seg;
+
+        if (hg_atomic_get32(&seg->consumed) != HG_MPMC_QUEUE_SEGMENT_SIZE)
+            break;
+
+        /* Keep at least one segment, next push will allocate it */
+        next = HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&seg->next));
+        if (next == NULL)
+            break;
+
+        /* Producers must no longer be able to reach seg */
+        do {
+            tail_seg = HG_MPMC_QUEUE_SEGMENT(
+                hg_atomic_get64(&hg_mpmc_queue->tail_segment));
+        } while (tail_seg->id <= seg->id &&
+                 !hg_atomic_cas64(&hg_mpmc_queue->tail_segment,
+                     HG_MPMC_QUEUE_VALUE(tail_seg), HG_MPMC_QUEUE_VALUE(next)));
+
+        if (hg_atomic_cas64(&hg_mpmc_queue->head_segment,
+                HG_MPMC_QUEUE_VALUE(seg), HG_MPMC_QUEUE_VALUE(next)))
+            hg_mpmc_queue_retire(hg_mpmc_queue, seg);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_int32_t
+hg_mpmc_queue_epoch_enter(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    for (;;) {
+        hg_util_int32_t epoch = hg_atomic_get32(&hg_mpmc_queue->epoch);
+        hg_atomic_int32_t *active =
+            &hg_mpmc_queue->active[(hg_util_uint32_t) epoch %
+                                   HG_MPMC_QUEUE_EPOCHS];
+
+        hg_atomic_incr32(active);
+        /* Make sure epoch did not move before we were accounted for */
+        if (hg_atomic_cas32(&hg_mpmc_queue->epoch, epoch, epoch))
+            return epoch;
+        hg_atomic_decr32(active);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_mpmc_queue_epoch_exit(
+    struct hg_mpmc_queue *hg_mpmc_queue, hg_util_int32_t epoch)
+{
+    if (hg_atomic_get64(&hg_mpmc_queue->retired) != 0) {
+        hg_util_int32_t prev = (hg_util_int32_t)(
+            (hg_util_uint32_t) epoch + HG_MPMC_QUEUE_EPOCHS - 1);
+
+        /* Epoch can move forward once no thread is left in previous epoch */
+        if (hg_atomic_cas32(&hg_mpmc_queue->epoch, epoch, epoch) &&
+            hg_atomic_cas32(&hg_mpmc_queue
+                                 ->active[(hg_util_uint32_t) prev %
+                                          HG_MPMC_QUEUE_EPOCHS],
+                0, 0))
+            hg_atomic_cas32(&hg_mpmc_queue->epoch, epoch,
+                (hg_util_int32_t)((hg_util_uint32_t) epoch + 1));
+
+        hg_mpmc_queue_reclaim(hg_mpmc_queue);
+    }
+
+    hg_atomic_decr32(
+        &hg_mpmc_queue
+             ->active[(hg_util_uint32_t) epoch % HG_MPMC_QUEUE_EPOCHS]);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_mpmc_queue_retire(
+    struct hg_mpmc_queue *hg_mpmc_queue, struct hg_mpmc_queue_segment *seg)
+{
+    hg_util_int64_t head;
+
+    /* Epoch is read after seg was unlinked */
+    seg->retire_epoch = hg_atomic_get32(&hg_mpmc_queue->epoch);
+    do {
+        head = hg_atomic_get64(&hg_mpmc_queue->retired);
+        seg->retired_next = HG_MPMC_QUEUE_SEGMENT(head);
+    } while (!hg_atomic_cas64(
+        &hg_mpmc_queue->retired, head, HG_MPMC_QUEUE_VALUE(seg)));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_mpmc_queue_reclaim(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    struct hg_mpmc_queue_segment *seg, *keep_head = NULL, *keep_tail = NULL;
+    hg_util_int64_t head;
+    hg_util_int32_t epoch;
+
+    /* Take all retired segments */
+    do {
+        head = hg_atomic_get64(&hg_mpmc_queue->retired);
+        if (head == 0)
+            return;
+    } while (!hg_atomic_cas64(&hg_mpmc_queue->retired, head, 0));
+
+    /* No thread can reference a segment once the epoch has moved twice since
+     * it was retired */
+    epoch = hg_atomic_get32(&hg_mpmc_queue->epoch);
+    seg = HG_MPMC_QUEUE_SEGMENT(head);
+    while (seg != NULL) {
+        struct hg_mpmc_queue_segment *next = seg->retired_next;
+
+        if ((hg_util_uint32_t) epoch - (hg_util_uint32_t) seg->retire_epoch >=
+            2)
+            hg_mem_aligned_free(seg);
+        else {
+            seg->retired_next = NULL;
+            if (keep_tail)
+                keep_tail->retired_next = seg;
+            else
+                keep_head = seg;
+            keep_tail = seg;
+        }
+        seg = next;
+    }
+
+    /* Put back remaining segments */
+    if (keep_head) {
+        do {
+            head = hg_atomic_get64(&hg_mpmc_queue->retired);
+            keep_tail->retired_next = HG_MPMC_QUEUE_SEGMENT(head);
+        } while (!hg_atomic_cas64(
+            &hg_mpmc_queue->retired, head, HG_MPMC_QUEUE_VALUE(keep_head)));
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+struct hg_mpmc_queue *
+hg_mpmc_queue_alloc(void)
+{
+    struct hg_mpmc_queue *hg_mpmc_queue = NULL;
+    struct hg_mpmc_queue_segment *seg = NULL;
+    unsigned int i;
+
+    hg_mpmc_queue = hg_mem_aligned_alloc(
+        HG_MEM_CACHE_LINE_SIZE, sizeof(struct hg_mpmc_queue));
+    HG_UTIL_CHECK_ERROR_NORET(
+        hg_mpmc_queue == NULL, error, "Could not allocate MPMC queue");
+
+    seg = hg_mpmc_queue_segment_alloc(0);
+    HG_UTIL_CHECK_ERROR_NORET(seg == NULL, error, "Could not allocate segment");
+
+    hg_atomic_init64(&hg_mpmc_queue->tail, 0);
+    hg_atomic_init64(&hg_mpmc_queue->tail_segment, HG_MPMC_QUEUE_VALUE(seg));
+    hg_atomic_init64(&hg_mpmc_queue->head, 0);
+    hg_atomic_init64(&hg_mpmc_queue->head_segment, HG_MPMC_QUEUE_VALUE(seg));
+    hg_atomic_init32(&hg_mpmc_queue->epoch, 0);
+    for (i = 0; i < HG_MPMC_QUEUE_EPOCHS; i++)
+        hg_atomic_init32(&hg_mpmc_queue->active[i], 0);
+    hg_atomic_init64(&hg_mpmc_queue->retired, 0);
+
+    return hg_mpmc_queue;
+
+error:
+    hg_mem_aligned_free(hg_mpmc_queue);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_mpmc_queue_free(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    struct hg_mpmc_queue_segment *seg;
+
+    if (!hg_mpmc_queue)
+        return;
+
+    seg = HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&hg_mpmc_queue->head_segment));
+    while (seg != NULL) {
+        struct hg_mpmc_queue_segment *next =
+            HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&seg->next));
+        hg_mem_aligned_free(seg);
+        seg = next;
+    }
+
+    seg = HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&hg_mpmc_queue->retired));
+    while (seg != NULL) {
+        struct hg_mpmc_queue_segment *next = seg->retired_next;
+        hg_mem_aligned_free(seg);
+        seg = next;
+    }
+
+    hg_mem_aligned_free(hg_mpmc_queue);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_mpmc_queue_push(struct hg_mpmc_queue *hg_mpmc_queue, void *entry)
+{
+    struct hg_mpmc_queue_segment *seg, *tail_seg;
+    hg_util_int32_t epoch;
+    hg_util_int64_t tail;
+    int ret = HG_UTIL_SUCCESS;
+
+    epoch = hg_mpmc_queue_epoch_enter(hg_mpmc_queue);
+
+    for (;;) {
+        hg_util_int64_t id;
+
+        tail = hg_atomic_get64(&hg_mpmc_queue->tail);
+        id = tail / HG_MPMC_QUEUE_SEGMENT_SIZE;
+
+        seg = HG_MPMC_QUEUE_SEGMENT(
+            hg_atomic_get64(&hg_mpmc_queue->tail_segment));
+        if (seg->id > id)
+            seg = HG_MPMC_QUEUE_SEGMENT(
+                hg_atomic_get64(&hg_mpmc_queue->head_segment));
+
+        /* Segment must exist before ticket is taken */
+        seg = hg_mpmc_queue_segment_find(seg, id, HG_UTIL_TRUE);
+        HG_UTIL_CHECK_ERROR(seg == NULL, done, ret, HG_UTIL_FAIL,
+            "Could not allocate queue segment");
+        if (seg->id != id)
+            continue; /* Stale tail */
+
+        if (hg_atomic_cas64(&hg_mpmc_queue->tail, tail, tail + 1))
+            break;
+    }
+
+    hg_atomic_set64(&seg->slots[tail % HG_MPMC_QUEUE_SEGMENT_SIZE],
+        HG_MPMC_QUEUE_VALUE(entry));
+
+    /* Move tail segment forward */
+    do {
+        tail_seg = HG_MPMC_QUEUE_SEGMENT(
+            hg_atomic_get64(&hg_mpmc_queue->tail_segment));
+    } while (tail_seg->id < seg->id &&
+             !hg_atomic_cas64(&hg_mpmc_queue->tail_segment,
+                 HG_MPMC_QUEUE_VALUE(tail_seg), HG_MPMC_QUEUE_VALUE(seg)));
+
+done:
+    hg_mpmc_queue_epoch_exit(hg_mpmc_queue, epoch);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void *
+hg_mpmc_queue_pop(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    void *entry;
+
+    return (hg_mpmc_queue_pop_batch(hg_mpmc_queue, &entry, 1) == 1) ? entry
+                                                                   : NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_mpmc_queue_pop_batch(
+    struct hg_mpmc_queue *hg_mpmc_queue, void **entries, unsigned int count)
+{
+    struct hg_mpmc_queue_segment *seg;
+    hg_util_int64_t head, tail, n;
+    hg_util_int32_t epoch;
+    unsigned int i;
+
+    if (count == 0 || hg_mpmc_queue_is_empty(hg_mpmc_queue))
+        return 0;
+
+    epoch = hg_mpmc_queue_epoch_enter(hg_mpmc_queue);
+
+    /* Reserve up to count tickets at once */
+    do {
+        head = hg_atomic_get64(&hg_mpmc_queue->head);
+        tail = hg_atomic_get64(&hg_mpmc_queue->tail);
+        if (head >= tail) {
+            n = 0;
+            goto done;
+        }
+        n = (tail - head < (hg_util_int64_t) count) ? tail - head
+                                                    : (hg_util_int64_t) count;
+    } while (!hg_atomic_cas64(&hg_mpmc_queue->head, head, head + n));
+
+    /* Head segment cannot move past our first ticket until we consume it */
+    seg = HG_MPMC_QUEUE_SEGMENT(hg_atomic_get64(&hg_mpmc_queue->head_segment));
+    for (i = 0; i < (unsigned int) n; i++) {
+        hg_util_int64_t ticket = head + (hg_util_int64_t) i;
+        hg_atomic_int64_t *slot;
+        hg_util_int64_t value;
+
+        seg = hg_mpmc_queue_segment_find(
+            seg, ticket / HG_MPMC_QUEUE_SEGMENT_SIZE, HG_UTIL_FALSE);
+        slot = &seg->slots[ticket % HG_MPMC_QUEUE_SEGMENT_SIZE];
+
+        /* Wait for producer that holds that ticket to complete */
+        while ((value = hg_atomic_get64(slot)) == 0)
+            cpu_spinwait();
+        entries[i] = (void *) value;
+
+        if (hg_atomic_incr32(&seg->consumed) == HG_MPMC_QUEUE_SEGMENT_SIZE)
+            hg_mpmc_queue_advance_head(hg_mpmc_queue);
+    }
+
+done:
+    hg_mpmc_queue_epoch_exit(hg_mpmc_queue, epoch);
+
+    return (unsigned int) n;
+}
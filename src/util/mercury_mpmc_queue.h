@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Unbounded multi-producer / multi-consumer queue. Entries are stored in a
+ * linked list of fixed-size segments that are indexed by 64-bit tickets,
+ * producers and consumers reserve tickets using CAS on the tail and head
+ * counters. Fully consumed segments are unlinked and reclaimed once no
+ * thread can still reference them (epoch-based reclamation). */
+
+#ifndef MERCURY_MPMC_QUEUE_H
+#define MERCURY_MPMC_QUEUE_H
+
+#include "mercury_atomic.h"
+#include "mercury_mem.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Number of epochs used for segment reclamation */
+#define HG_MPMC_QUEUE_EPOCHS 3
+
+struct hg_mpmc_queue {
+    hg_atomic_int64_t tail;         /* Next producer ticket */
+    hg_atomic_int64_t tail_segment; /* Last known producer segment */
+    hg_atomic_int64_t head
+        __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE))); /* Next ticket */
+    hg_atomic_int64_t head_segment; /* Oldest segment */
+    hg_atomic_int32_t epoch
+        __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE))); /* Global epoch */
+    hg_atomic_int32_t active[HG_MPMC_QUEUE_EPOCHS]; /* Threads per epoch */
+    hg_atomic_int64_t retired;                      /* Retired segments */
+};
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocate a new queue. Queue grows and shrinks as needed.
+ *
+ * \return pointer to allocated queue or NULL on failure
+ */
+HG_UTIL_PUBLIC struct hg_mpmc_queue *
+hg_mpmc_queue_alloc(void);
+
+/**
+ * Free an existing queue.
+ *
+ * \param hg_mpmc_queue [IN]        pointer to queue
+ */
+HG_UTIL_PUBLIC void
+hg_mpmc_queue_free(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/**
+ * Push an entry to the queue.
+ *
+ * \param hg_mpmc_queue [IN/OUT]    pointer to queue
+ * \param entry [IN]                pointer to object (must not be NULL)
+ *
+ * \return Non-negative on success or negative if no memory is available
+ */
+HG_UTIL_PUBLIC int
+hg_mpmc_queue_push(struct hg_mpmc_queue *hg_mpmc_queue, void *entry);
+
+/**
+ * Pop an entry from the queue.
+ *
+ * \param hg_mpmc_queue [IN/OUT]    pointer to queue
+ *
+ * \return Pointer to popped object or NULL if queue is empty
+ */
+HG_UTIL_PUBLIC void *
+hg_mpmc_queue_pop(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/**
+ * Pop up to \count entries from the queue at once.
+ *
+ * \param hg_mpmc_queue [IN/OUT]    pointer to queue
+ * \param entries [OUT]             array of popped objects
+ * \param count [IN]                maximum number of objects to pop
+ *
+ * \return Number of popped objects or 0 if queue is empty
+ */
+HG_UTIL_PUBLIC unsigned int
+hg_mpmc_queue_pop_batch(
+    struct hg_mpmc_queue *hg_mpmc_queue, void **entries, unsigned int count);
+
+/**
+ * Determine whether queue is empty.
+ *
+ * \param hg_mpmc_queue [IN/OUT]    pointer to queue
+ *
+ * \return HG_UTIL_TRUE if empty, HG_UTIL_FALSE if not
+ */
+static HG_UTIL_INLINE hg_util_bool_t
+hg_mpmc_queue_is_empty(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/**
+ * Determine number of entries in a queue.
+ *
+ * \param hg_mpmc_queue [IN/OUT]    pointer to queue
+ *
+ * \return Number of entries queued or 0 if none
+ */
+static HG_UTIL_INLINE unsigned int
+hg_mpmc_queue_count(struct hg_mpmc_queue *hg_mpmc_queue);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_bool_t
+hg_mpmc_queue_is_empty(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    return (hg_atomic_get64(&hg_mpmc_queue->head) >=
+            hg_atomic_get64(&hg_mpmc_queue->tail));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hg_mpmc_queue_count(struct hg_mpmc_queue *hg_mpmc_queue)
+{
+    hg_util_int64_t head = hg_atomic_get64(&hg_mpmc_queue->head);
+    hg_util_int64_t tail = hg_atomic_get64(&hg_mpmc_queue->tail);
+
+    return (tail > head) ? (unsigned int) (tail - head) : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_MPMC_QUEUE_H */
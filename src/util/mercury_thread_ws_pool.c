@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_thread_ws_pool.h"
+
+#include "mercury_atomic.h"
+#include "mercury_mem.h"
+#include "mercury_thread_spin.h"
+#include "mercury_util_error.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Per-worker work queue */
+struct hg_thread_ws_queue {
+    HG_QUEUE_HEAD(hg_thread_work) queue; /* Queue of work */
+    hg_thread_spin_t lock;               /* Queue lock */
+    hg_atomic_int32_t count;             /* Number of queued work */
+} __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
+
+/* Worker */
+struct hg_thread_ws_worker {
+    struct hg_thread_ws_pool *pool; /* Pool this worker belongs to */
+    unsigned int index;             /* Index of worker (and queue) */
+    hg_thread_t thread;             /* Thread ID */
+    hg_util_bool_t started;         /* Thread was started */
+};
+
+/* Pool */
+struct hg_thread_ws_pool {
+    struct hg_thread_ws_queue *queues;   /* Array of queues */
+    struct hg_thread_ws_worker *workers; /* Array of workers */
+    unsigned int thread_count;           /* Number of workers */
+    hg_thread_key_t worker_key;          /* Key to retrieve current worker */
+    hg_atomic_int32_t next_queue;        /* Queue used for next external post */
+    hg_atomic_int32_t pending;           /* Total number of queued work */
+    hg_atomic_int32_t sleeping;          /* Number of sleeping workers */
+    hg_atomic_int32_t shutdown;          /* Shutting down */
+    hg_thread_mutex_t mutex;             /* Mutex for sleeping workers */
+    hg_thread_cond_t cond;               /* Cond for sleeping workers */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Pop work from queue.
+ */
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_ws_queue_pop(struct hg_thread_ws_queue *queue);
+
+/**
+ * Get work from own queue or steal it from other workers.
+ */
+static struct hg_thread_work *
+hg_thread_ws_pool_get_work(struct hg_thread_ws_worker *worker);
+
+/**
+ * Worker thread run by the thread pool
+ */
+static HG_THREAD_RETURN_TYPE
+hg_thread_ws_pool_worker(void *args);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_ws_queue_pop(struct hg_thread_ws_queue *queue)
+{
+    struct hg_thread_work *work;
+
+    /* Do not bother taking the lock if queue is empty */
+    if (hg_atomic_get32(&queue->count) == 0)
+        return NULL;
+
+    hg_thread_spin_lock(&queue->lock);
+    work = HG_QUEUE_FIRST(&queue->queue);
+    if (work) {
+        HG_QUEUE_POP_HEAD(&queue->queue, entry);
+        hg_atomic_decr32(&queue->count);
+    }
+    hg_thread_spin_unlock(&queue->lock);
+
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_thread_ws_pool_get_work(struct hg_thread_ws_worker *worker)
+{
+    struct hg_thread_ws_pool *pool = worker->pool;
+    struct hg_thread_work *work;
+    unsigned int i;
+
+    work = hg_thread_ws_queue_pop(&pool->queues[worker->index]);
+    if (work)
+        return work;
+
+    /* Steal from other workers, starting from our neighbor */
+    for (i = 1; i < pool->thread_count; i++) {
+        work = hg_thread_ws_queue_pop(
+            &pool->queues[(worker->index + i) % pool->thread_count]);
+        if (work)
+            return work;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_thread_ws_pool_worker(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    struct hg_thread_ws_worker *worker = (struct hg_thread_ws_worker *) args;
+    struct hg_thread_ws_pool *pool = worker->pool;
+
+    hg_thread_setspecific(pool->worker_key, worker);
+
+    while (1) {
+        struct hg_thread_work *work = hg_thread_ws_pool_get_work(worker);
+
+        if (work) {
+            hg_atomic_decr32(&pool->pending);
+
+            /* Get to work */
+            (*work->func)(work->args);
+            continue;
+        }
+
+        hg_thread_mutex_lock(&pool->mutex);
+
+        /* If not shutting down and nothing to do, worker sleeps */
+        hg_atomic_incr32(&pool->sleeping);
+        while (!hg_atomic_get32(&pool->shutdown) &&
+               hg_atomic_get32(&pool->pending) <= 0) {
+            int rc = hg_thread_cond_wait(&pool->cond, &pool->mutex);
+            HG_UTIL_CHECK_ERROR_NORET(rc != HG_UTIL_SUCCESS, unlock,
+                "Thread cannot wait on condition variable");
+        }
+        hg_atomic_decr32(&pool->sleeping);
+
+        if (hg_atomic_get32(&pool->shutdown) &&
+            hg_atomic_get32(&pool->pending) <= 0)
+            goto unlock;
+
+        hg_thread_mutex_unlock(&pool->mutex);
+    }
+
+unlock:
+    hg_thread_mutex_unlock(&pool->mutex);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_ws_pool_init(
+    unsigned int thread_count, hg_thread_ws_pool_t **pool_ptr)
+{
+    struct hg_thread_ws_pool *pool = NULL;
+    int ret = HG_UTIL_SUCCESS, rc;
+    unsigned int i;
+
+    HG_UTIL_CHECK_ERROR(
+        pool_ptr == NULL, error, ret, HG_UTIL_FAIL, "NULL pointer");
+    HG_UTIL_CHECK_ERROR(
+        thread_count == 0, error, ret, HG_UTIL_FAIL, "Invalid thread count");
+
+    pool =
+        (struct hg_thread_ws_pool *) malloc(sizeof(struct hg_thread_ws_pool));
+    HG_UTIL_CHECK_ERROR(
+        pool == NULL, error, ret, HG_UTIL_FAIL, "Could not allocate pool");
+    memset(pool, 0, sizeof(struct hg_thread_ws_pool));
+    hg_atomic_init32(&pool->next_queue, 0);
+    hg_atomic_init32(&pool->pending, 0);
+    hg_atomic_init32(&pool->sleeping, 0);
+    hg_atomic_init32(&pool->shutdown, 0);
+
+    rc = hg_thread_mutex_init(&pool->mutex);
+    HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
+        "Could not initialize mutex");
+
+    rc = hg_thread_cond_init(&pool->cond);
+    HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
+        "Could not initialize thread condition");
+
+    rc = hg_thread_key_create(&pool->worker_key);
+    HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
+        "Could not create thread key");
+
+    pool->queues = (struct hg_thread_ws_queue *) hg_mem_aligned_alloc(
+        HG_MEM_CACHE_LINE_SIZE,
+        thread_count * sizeof(struct hg_thread_ws_queue));
+    HG_UTIL_CHECK_ERROR(pool->queues == NULL, error, ret, HG_UTIL_FAIL,
+        "Could not allocate queues");
+    pool->thread_count = thread_count;
+    for (i = 0; i < thread_count; i++) {
+        HG_QUEUE_INIT(&pool->queues[i].queue);
+        hg_thread_spin_init(&pool->queues[i].lock);
+        hg_atomic_init32(&pool->queues[i].count, 0);
+    }
+
+    pool->workers = (struct hg_thread_ws_worker *) malloc(
+        thread_count * sizeof(struct hg_thread_ws_worker));
+    HG_UTIL_CHECK_ERROR(pool->workers == NULL, error, ret, HG_UTIL_FAIL,
+        "Could not allocate workers");
+    memset(pool->workers, 0, thread_count * sizeof(struct hg_thread_ws_worker));
+
+    /* Start worker threads */
+    for (i = 0; i < thread_count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        rc = hg_thread_create(&pool->workers[i].thread,
+            hg_thread_ws_pool_worker, &pool->workers[i]);
+        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
+            "Could not create thread");
+        pool->workers[i].started = HG_UTIL_TRUE;
+    }
+
+    *pool_ptr = pool;
+
+    return ret;
+
+error:
+    if (pool)
+        hg_thread_ws_pool_destroy(pool);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_ws_pool_destroy(hg_thread_ws_pool_t *pool)
+{
+    int ret = HG_UTIL_SUCCESS, rc;
+    unsigned int i;
+
+    if (!pool)
+        goto done;
+
+    if (pool->workers) {
+        hg_thread_mutex_lock(&pool->mutex);
+        hg_atomic_set32(&pool->shutdown, 1);
+        rc = hg_thread_cond_broadcast(&pool->cond);
+        hg_thread_mutex_unlock(&pool->mutex);
+        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
+            "Could not broadcast condition signal");
+
+        for (i = 0; i < pool->thread_count; i++) {
+            if (!pool->workers[i].started)
+                continue;
+            rc = hg_thread_join(pool->workers[i].thread);
+            HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
+                "Could not join thread");
+        }
+        free(pool->workers);
+    }
+
+    if (pool->queues) {
+        for (i = 0; i < pool->thread_count; i++)
+            hg_thread_spin_destroy(&pool->queues[i].lock);
+        hg_mem_aligned_free(pool->queues);
+    }
+
+    hg_thread_key_delete(pool->worker_key);
+    hg_thread_mutex_destroy(&pool->mutex);
+    hg_thread_cond_destroy(&pool->cond);
+    free(pool);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_ws_pool_post(hg_thread_ws_pool_t *pool, struct hg_thread_work *work)
+{
+    struct hg_thread_ws_worker *worker;
+    struct hg_thread_ws_queue *queue;
+
+    if (!pool || !work || !work->func)
+        return HG_UTIL_FAIL;
+
+    /* Keep work local if posted from one of our workers */
+    worker = (struct hg_thread_ws_worker *) hg_thread_getspecific(
+        pool->worker_key);
+    if (worker)
+        queue = &pool->queues[worker->index];
+    else if (hg_atomic_get32(&pool->shutdown))
+        /* Only workers can post while shutting down, they drain that work */
+        return HG_UTIL_FAIL;
+    else
+        queue = &pool->queues[(hg_util_uint32_t) hg_atomic_incr32(
+                                  &pool->next_queue) %
+                              pool->thread_count];
+
+    /* Add task to task queue */
+    hg_thread_spin_lock(&queue->lock);
+    HG_QUEUE_PUSH_TAIL(&queue->queue, work, entry);
+    hg_atomic_incr32(&queue->count);
+    hg_thread_spin_unlock(&queue->lock);
+    hg_atomic_incr32(&pool->pending);
+
+    /* Wake up sleeping worker, work is queued at this point and will be
+     * executed by the next worker that wakes up so do not report failure */
+    if (hg_atomic_get32(&pool->sleeping)) {
+        int rc;
+
+        hg_thread_mutex_lock(&pool->mutex);
+        rc = hg_thread_cond_signal(&pool->cond);
+        hg_thread_mutex_unlock(&pool->mutex);
+        HG_UTIL_CHECK_ERROR_DONE(
+            rc != HG_UTIL_SUCCESS, "Could not signal thread condition");
+    }
+
+    return HG_UTIL_SUCCESS;
+}
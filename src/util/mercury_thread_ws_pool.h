@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_THREAD_WS_POOL_H
+#define MERCURY_THREAD_WS_POOL_H
+
+#include "mercury_thread_pool.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Work-stealing thread pool: each worker owns a work queue, work posted from
+ * outside the pool is spread across workers' queues, work posted by a worker
+ * goes to its own queue, idle workers steal from other queues. */
+typedef struct hg_thread_ws_pool hg_thread_ws_pool_t;
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize the work-stealing thread pool.
+ *
+ * \param thread_count [IN]     number of threads that will be created at
+ *                              initialization
+ * \param pool [OUT]            pointer to pool object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_ws_pool_init(unsigned int thread_count, hg_thread_ws_pool_t **pool);
+
+/**
+ * Destroy the work-stealing thread pool. Work already posted is executed
+ * before the pool is destroyed.
+ *
+ * \param pool [IN/OUT]         pointer to pool object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_ws_pool_destroy(hg_thread_ws_pool_t *pool);
+
+/**
+ * Post work to the pool. Once the pool is being destroyed, only work posted
+ * from within the pool (by its workers) is accepted. Work is always queued
+ * when the call succeeds and never queued when it fails.
+ *
+ * \param pool [IN/OUT]         pointer to pool object
+ * \param work [IN]             pointer to work struct
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_ws_pool_post(hg_thread_ws_pool_t *pool, struct hg_thread_work *work);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_THREAD_WS_POOL_H */
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_trace.h"
+#include "mercury_thread.h"
+#include "mercury_time.h"
+#include "mercury_util_error.h"
+
+#ifdef _WIN32
+#    include <process.h>
+#    define getpid _getpid
+#else
+#    include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Tracing state */
+#define HG_TRACE_STATE_NONE  0
+#define HG_TRACE_STATE_INIT  1
+#define HG_TRACE_STATE_READY 2
+
+/* Number of bits of correlation IDs used by the per-process counter */
+#define HG_TRACE_ID_COUNTER_BITS 32
+#define HG_TRACE_ID_COUNTER_MASK                                               \
+    (((hg_util_uint64_t) 1 << HG_TRACE_ID_COUNTER_BITS) - 1)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Per-thread ring of events, only the owning thread writes to it */
+struct hg_trace_buffer {
+    struct hg_trace_event *events; /* Ring of events */
+    struct hg_trace_buffer *next;  /* Next buffer in global list */
+    hg_util_uint64_t mask;         /* Number of events - 1 */
+    hg_util_uint64_t tid;          /* Sequential thread index */
+    hg_util_uint64_t pos;          /* Next write position (owner only) */
+    hg_atomic_int64_t head;        /* Published write position */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Convert time to ns.
+ */
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_trace_time_ns(hg_time_t tv);
+
+/**
+ * Create the calling thread's buffer.
+ */
+static struct hg_trace_buffer *
+hg_trace_buffer_new(void);
+
+/**
+ * Copy the events of a buffer that have not been overwritten.
+ */
+static hg_util_uint64_t
+hg_trace_buffer_snapshot(struct hg_trace_buffer *buffer,
+    struct hg_trace_event *events, hg_util_uint64_t *lost_events);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Tracing is enabled */
+hg_atomic_int32_t hg_trace_enabled_g;
+
+/* Key used to retrieve thread buffers */
+static hg_atomic_int32_t hg_trace_state_g;
+static hg_thread_key_t hg_trace_key_g;
+
+/* List of all buffers (struct hg_trace_buffer *) */
+static hg_atomic_int64_t hg_trace_buffers_g;
+
+/* Thread index and correlation ID counters */
+static hg_atomic_int64_t hg_trace_tid_g;
+static hg_atomic_int64_t hg_trace_id_g;
+static hg_util_uint64_t hg_trace_id_prefix_g;
+
+/* Number of events of new buffers */
+static unsigned int hg_trace_buffer_size_g = HG_TRACE_BUFFER_SIZE_DEFAULT;
+
+/* Event type names */
+static const char *const hg_trace_type_names_g[HG_TRACE_TYPE_MAX] = {
+    "create", "forward", "send_complete", "recv_request", "process", "respond",
+    "recv_response", "trigger", "bulk_transfer", "bulk_complete", "na_send",
+    "na_recv", "na_put", "na_get", "na_complete"};
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_trace_time_ns(hg_time_t tv)
+{
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+    return (hg_util_uint64_t) tv.tv_sec * 1000000000 +
+           (hg_util_uint64_t) tv.tv_nsec;
+#else
+    return (hg_util_uint64_t) tv.tv_sec * 1000000000 +
+           (hg_util_uint64_t) tv.tv_usec * 1000;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_trace_buffer *
+hg_trace_buffer_new(void)
+{
+    struct hg_trace_buffer *buffer = NULL;
+    hg_util_int64_t next;
+    int rc;
+
+    buffer = (struct hg_trace_buffer *) malloc(sizeof(*buffer));
+    HG_UTIL_CHECK_ERROR_NORET(
+        buffer == NULL, error, "Could not allocate trace buffer");
+
+    buffer->events = (struct hg_trace_event *) calloc(
+        hg_trace_buffer_size_g, sizeof(struct hg_trace_event));
+    HG_UTIL_CHECK_ERROR_NORET(
+        buffer->events == NULL, error, "Could not allocate trace events");
+    buffer->mask = (hg_util_uint64_t) hg_trace_buffer_size_g - 1;
+    buffer->tid = (hg_util_uint64_t) hg_atomic_incr64(&hg_trace_tid_g) - 1;
+    buffer->pos = 0;
+    hg_atomic_init64(&buffer->head, 0);
+
+    rc = hg_thread_setspecific(hg_trace_key_g, buffer);
+    HG_UTIL_CHECK_ERROR_NORET(
+        rc != HG_UTIL_SUCCESS, error, "hg_thread_setspecific() failed");
+
+    /* Push to global list, buffers are only removed at finalize */
+    do {
+        next = hg_atomic_get64(&hg_trace_buffers_g);
+        buffer->next = (struct hg_trace_buffer *) next;
+    } while (!hg_atomic_cas64(
+        &hg_trace_buffers_g, next, (hg_util_int64_t) buffer));
+
+    return buffer;
+
+error:
+    if (buffer) {
+        free(buffer->events);
+        free(buffer);
+    }
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_uint64_t
+hg_trace_buffer_snapshot(struct hg_trace_buffer *buffer,
+    struct hg_trace_event *events, hg_util_uint64_t *lost_events)
+{
+    hg_util_uint64_t size = buffer->mask + 1, start, end, first, i;
+
+    end = (hg_util_uint64_t) hg_atomic_get64(&buffer->head);
+    start = (end > size) ? end - size : 0;
+    for (i = start; i < end; i++)
+        events[i - start] = buffer->events[i & buffer->mask];
+
+    /* Events the owner may have overwritten while copying, including the
+     * slot of the event currently being written, are dropped */
+    hg_atomic_fence();
+    first = (hg_util_uint64_t) hg_atomic_get64(&buffer->head) + 1;
+    first = (first > size) ? first - size : 0;
+    if (first < start)
+        first = start;
+    else if (first > end)
+        first = end;
+    if (first > start)
+        memmove(events, events + (first - start),
+            (size_t) (end - first) * sizeof(struct hg_trace_event));
+    *lost_events += first;
+
+    return end - first;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_trace_enable(int enable)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    if (!enable) {
+        hg_atomic_set32(&hg_trace_enabled_g, 0);
+        goto done;
+    }
+
+    if (hg_atomic_cas32(
+            &hg_trace_state_g, HG_TRACE_STATE_NONE, HG_TRACE_STATE_INIT)) {
+        hg_time_t now;
+        hg_util_uint64_t seed;
+        int rc;
+
+        rc = hg_thread_key_create(&hg_trace_key_g);
+        if (rc != HG_UTIL_SUCCESS) {
+            hg_atomic_set32(&hg_trace_state_g, HG_TRACE_STATE_NONE);
+            HG_UTIL_GOTO_ERROR(
+                done, ret, HG_UTIL_FAIL, "hg_thread_key_create() failed");
+        }
+
+        /* Mix time, process ID and address space layout into the prefix */
+        hg_time_get_current(&now);
+        seed = hg_trace_time_ns(now) ^ ((hg_util_uint64_t) getpid() << 32) ^
+               (hg_util_uint64_t) (size_t) &now;
+        seed = (seed ^ (seed >> 33)) * 0xff51afd7ed558ccdULL;
+        seed = (seed ^ (seed >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+        seed ^= seed >> 33;
+        hg_trace_id_prefix_g = seed & ~HG_TRACE_ID_COUNTER_MASK;
+
+        hg_atomic_set32(&hg_trace_state_g, HG_TRACE_STATE_READY);
+    } else {
+        while (hg_atomic_get32(&hg_trace_state_g) != HG_TRACE_STATE_READY)
+            if (hg_atomic_get32(&hg_trace_state_g) == HG_TRACE_STATE_NONE)
+                HG_UTIL_GOTO_ERROR(
+                    done, ret, HG_UTIL_FAIL, "Could not initialize tracing");
+    }
+
+    hg_atomic_set32(&hg_trace_enabled_g, 1);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_trace_set_buffer_size(unsigned int n_events)
+{
+    unsigned int size = 1;
+    int ret = HG_UTIL_SUCCESS;
+
+    HG_UTIL_CHECK_ERROR(n_events == 0 || n_events > (1U << 31), done, ret,
+        HG_UTIL_FAIL, "Invalid number of events (%u)", n_events);
+
+    while (size < n_events)
+        size <<= 1;
+    hg_trace_buffer_size_g = size;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_trace_record(hg_trace_type_t type, hg_util_uint64_t id, hg_util_uint64_t arg)
+{
+    struct hg_trace_buffer *buffer =
+        (struct hg_trace_buffer *) hg_thread_getspecific(hg_trace_key_g);
+    struct hg_trace_event *event;
+    hg_time_t now;
+
+    if (unlikely(buffer == NULL)) {
+        buffer = hg_trace_buffer_new();
+        if (buffer == NULL)
+            return;
+    }
+
+    hg_time_get_current(&now);
+    event = &buffer->events[buffer->pos & buffer->mask];
+    event->time = hg_trace_time_ns(now);
+    event->id = id;
+    event->arg = arg;
+    event->type = (hg_util_uint32_t) type;
+
+    /* Publish event to readers */
+    hg_atomic_set64(&buffer->head, (hg_util_int64_t) ++buffer->pos);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_util_uint64_t
+hg_trace_id_gen(void)
+{
+    hg_util_uint64_t count;
+
+    /* Skip counter values that would wrap to a zero low part */
+    do {
+        count = (hg_util_uint64_t) hg_atomic_incr64(&hg_trace_id_g);
+    } while ((count & HG_TRACE_ID_COUNTER_MASK) == 0);
+
+    return hg_trace_id_prefix_g | (count & HG_TRACE_ID_COUNTER_MASK);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_trace_dump(const char *path)
+{
+    struct hg_trace_file_header header;
+    struct hg_trace_buffer *buffers, *buffer;
+    struct hg_trace_event *events = NULL;
+    hg_util_uint64_t max_size = 0;
+    FILE *file = NULL;
+    int ret = HG_UTIL_SUCCESS;
+
+    file = fopen(path, "wb");
+    HG_UTIL_CHECK_ERROR(
+        file == NULL, done, ret, HG_UTIL_FAIL, "Could not open %s", path);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HG_TRACE_MAGIC, sizeof(HG_TRACE_MAGIC));
+    header.version = HG_TRACE_VERSION;
+    header.pid = (hg_util_uint64_t) getpid();
+
+    /* Buffers are pushed to the head of the list, buffers created after this
+     * point are not dumped */
+    buffers = (struct hg_trace_buffer *) hg_atomic_get64(&hg_trace_buffers_g);
+    for (buffer = buffers; buffer != NULL; buffer = buffer->next) {
+        header.n_buffers++;
+        if (buffer->mask + 1 > max_size)
+            max_size = buffer->mask + 1;
+    }
+
+    HG_UTIL_CHECK_ERROR(fwrite(&header, sizeof(header), 1, file) != 1, done,
+        ret, HG_UTIL_FAIL, "Could not write trace header");
+    if (header.n_buffers == 0)
+        goto done;
+
+    events = (struct hg_trace_event *) malloc(
+        (size_t) max_size * sizeof(struct hg_trace_event));
+    HG_UTIL_CHECK_ERROR(events == NULL, done, ret, HG_UTIL_FAIL,
+        "Could not allocate trace events");
+
+    for (buffer = buffers; buffer != NULL; buffer = buffer->next) {
+        struct hg_trace_buffer_header buffer_header;
+        size_t n_events;
+
+        buffer_header.tid = buffer->tid;
+        buffer_header.n_events =
+            hg_trace_buffer_snapshot(buffer, events, &header.lost_events);
+        n_events = (size_t) buffer_header.n_events;
+        HG_UTIL_CHECK_ERROR(
+            fwrite(&buffer_header, sizeof(buffer_header), 1, file) != 1 ||
+                fwrite(events, sizeof(*events), n_events, file) != n_events,
+            done, ret, HG_UTIL_FAIL, "Could not write trace events");
+    }
+
+    /* Rewrite header now that the number of lost events is known */
+    HG_UTIL_CHECK_ERROR(fseek(file, 0, SEEK_SET) != 0 ||
+                            fwrite(&header, sizeof(header), 1, file) != 1,
+        done, ret, HG_UTIL_FAIL, "Could not write trace header");
+
+done:
+    free(events);
+    if (file != NULL && fclose(file) != 0)
+        ret = HG_UTIL_FAIL;
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_trace_finalize(void)
+{
+    struct hg_trace_buffer *buffer;
+
+    hg_atomic_set32(&hg_trace_enabled_g, 0);
+
+    buffer = (struct hg_trace_buffer *) hg_atomic_get64(&hg_trace_buffers_g);
+    hg_atomic_set64(&hg_trace_buffers_g, 0);
+    while (buffer != NULL) {
+        struct hg_trace_buffer *next = buffer->next;
+
+        free(buffer->events);
+        free(buffer);
+        buffer = next;
+    }
+    hg_atomic_set64(&hg_trace_tid_g, 0);
+
+    /* Buffers of all threads are reset along with the key */
+    if (hg_atomic_cas32(
+            &hg_trace_state_g, HG_TRACE_STATE_READY, HG_TRACE_STATE_INIT)) {
+        hg_thread_key_delete(hg_trace_key_g);
+        hg_atomic_set32(&hg_trace_state_g, HG_TRACE_STATE_NONE);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+const char *
+hg_trace_type_name(hg_trace_type_t type)
+{
+    return ((unsigned int) type < HG_TRACE_TYPE_MAX)
+               ? hg_trace_type_names_g[type]
+               : NULL;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Binary event tracing. Each thread records fixed-size timestamped events
+ * into its own ring buffer, the owning thread is the only writer so that
+ * recording an event does not take locks nor issue atomic read-modify-write
+ * operations. Buffers can be dumped at any time to a binary file that can
+ * then be converted to a Chrome / Perfetto trace with hg_trace_json. */
+
+#ifndef MERCURY_TRACE_H
+#define MERCURY_TRACE_H
+
+#include "mercury_atomic.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Event types */
+typedef enum {
+    HG_TRACE_CORE_CREATE,        /* handle created (arg: RPC ID) */
+    HG_TRACE_CORE_FORWARD,       /* request posted (arg: RPC ID) */
+    HG_TRACE_CORE_SEND_COMPLETE, /* request sent (arg: RPC ID) */
+    HG_TRACE_CORE_RECV_REQUEST,  /* request received (arg: input size) */
+    HG_TRACE_CORE_PROCESS,       /* RPC handler called (arg: RPC ID) */
+    HG_TRACE_CORE_RESPOND,       /* response posted (arg: output size) */
+    HG_TRACE_CORE_RECV_RESPONSE, /* response received (arg: RPC ID) */
+    HG_TRACE_CORE_TRIGGER,       /* user callback called (arg: op type) */
+    HG_TRACE_BULK_TRANSFER,      /* bulk transfer posted (arg: size) */
+    HG_TRACE_BULK_COMPLETE,      /* bulk transfer completed (arg: op) */
+    HG_TRACE_NA_SEND,            /* message posted (arg: size) */
+    HG_TRACE_NA_RECV,            /* receive posted (arg: size) */
+    HG_TRACE_NA_PUT,             /* RMA put posted (arg: size) */
+    HG_TRACE_NA_GET,             /* RMA get posted (arg: size) */
+    HG_TRACE_NA_COMPLETE,        /* NA callback called (arg: callback type) */
+    HG_TRACE_TYPE_MAX
+} hg_trace_type_t;
+
+/* Event, IDs correlate events that belong to the same operation */
+struct hg_trace_event {
+    hg_util_uint64_t time; /* Monotonic time in ns */
+    hg_util_uint64_t id;   /* Correlation ID (0 if none) */
+    hg_util_uint64_t arg;  /* Type specific argument */
+    hg_util_uint32_t type; /* hg_trace_type_t */
+    hg_util_uint32_t pad;
+};
+
+/* Dump file layout: one file header followed by n_buffers buffer headers,
+ * each followed by n_events events in chronological order. All fields are in
+ * host byte order. */
+#define HG_TRACE_MAGIC   "HGTRACE"
+#define HG_TRACE_VERSION 1
+
+struct hg_trace_file_header {
+    char magic[8];                /* HG_TRACE_MAGIC */
+    hg_util_uint32_t version;     /* HG_TRACE_VERSION */
+    hg_util_uint32_t n_buffers;   /* Number of buffers that follow */
+    hg_util_uint64_t pid;         /* Process ID */
+    hg_util_uint64_t lost_events; /* Events overwritten before dump */
+};
+
+struct hg_trace_buffer_header {
+    hg_util_uint64_t tid;      /* Sequential thread index */
+    hg_util_uint64_t n_events; /* Number of events that follow */
+};
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Default number of events per thread buffer */
+#define HG_TRACE_BUFFER_SIZE_DEFAULT (1 << 16)
+
+/* Tracing is enabled */
+#define HG_TRACE_ENABLED() (hg_atomic_get32(&hg_trace_enabled_g) != 0)
+
+/* Record event if tracing is enabled */
+#define HG_TRACE(type, id, arg)                                                \
+    do {                                                                       \
+        if (HG_TRACE_ENABLED())                                                \
+            hg_trace_record(type, (hg_util_uint64_t) (id),                     \
+                (hg_util_uint64_t) (arg));                                     \
+    } while (0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************/
+/* Public Variables */
+/********************/
+
+/* Use HG_TRACE_ENABLED() */
+extern HG_UTIL_PUBLIC hg_atomic_int32_t hg_trace_enabled_g;
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+/**
+ * Enable or disable tracing. Events recorded while tracing was enabled are
+ * kept until hg_trace_finalize() is called.
+ *
+ * \param enable [IN]           non-zero to enable tracing
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_trace_enable(int enable);
+
+/**
+ * Set the number of events that can be held by thread buffers created after
+ * this call, older events are overwritten once a buffer is full. As the
+ * oldest slot may be overwritten while dumping, up to n_events - 1 events
+ * per thread are dumped.
+ *
+ * \param n_events [IN]         number of events (rounded up to a power of 2)
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_trace_set_buffer_size(unsigned int n_events);
+
+/**
+ * Record an event into the calling thread's buffer. HG_TRACE() should be
+ * used instead so that nothing is evaluated when tracing is disabled.
+ *
+ * \param type [IN]             event type
+ * \param id [IN]               correlation ID
+ * \param arg [IN]              type specific argument
+ */
+HG_UTIL_PUBLIC void
+hg_trace_record(
+    hg_trace_type_t type, hg_util_uint64_t id, hg_util_uint64_t arg);
+
+/**
+ * Generate a new non-zero correlation ID. IDs are made of a random
+ * per-process prefix and of a counter so that IDs generated by different
+ * processes are unlikely to collide.
+ *
+ * \return correlation ID
+ */
+HG_UTIL_PUBLIC hg_util_uint64_t
+hg_trace_id_gen(void);
+
+/**
+ * Write the content of all thread buffers to a file. Events may be recorded
+ * concurrently, events that are overwritten while dumping are dropped.
+ *
+ * \param path [IN]             file path
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_trace_dump(const char *path);
+
+/**
+ * Disable tracing and free all thread buffers. No other thread may record
+ * events while calling this function.
+ */
+HG_UTIL_PUBLIC void
+hg_trace_finalize(void);
+
+/**
+ * Convert an event type to a string.
+ *
+ * \param type [IN]             event type
+ *
+ * \return string or NULL if type is not valid
+ */
+HG_UTIL_PUBLIC const char *
+hg_trace_type_name(hg_trace_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_TRACE_H */